@@ -0,0 +1,120 @@
+// xbohach00
+// Analyses the example machines, then a generated machine with many states with known
+// unreachable, dead and trap states and overlaps, checks the findings and reports the time
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+
+#include "../../src/headers/machine_file_handler.h"
+#include "../../src/headers/machine_analyzer.h"
+#include "../../src/headers/moore_machine.h"
+
+static std::string stateName(int i) {
+    return "S" + std::to_string(i);
+}
+
+int main(int argc, char* argv[]) {
+    int states = 100000;
+    int threads = 0;
+    std::vector<std::string> files;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "-s" && i + 1 < argc) {
+            states = std::stoi(argv[++i]);
+        } else if (arg == "-j" && i + 1 < argc) {
+            threads = std::stoi(argv[++i]);
+        } else {
+            files.push_back(arg);
+        }
+    }
+    if (states < 100) {
+        std::cerr << "Usage: " << argv[0] << " [fsm_file]... [-s states >= 100] [-j threads]" << std::endl;
+        return 1;
+    }
+
+    for (const std::string& filename : files) {
+        try {
+            MooreMachine machine = MachineFileHandler::loadFromFile(filename);
+            MachineAnalysis analysis = MachineAnalyzer(machine, threads).analyze();
+            std::cout << filename << ": " << analysis.states << " states, " << analysis.transitions << " transitions\n";
+            for (const std::string& warning : MachineAnalyzer::describe(analysis)) {
+                std::cout << "  " << warning << "\n";
+            }
+        } catch (const std::exception& e) {
+            std::cerr << filename << ": " << e.what() << std::endl;
+            return 1;
+        }
+    }
+
+    // A ring of states, each also jumping ahead, on inputs a and b of pointer in.
+    // Every 100th state is never entered, every 1000th has no transitions and
+    // every 1000th, offset by 500, only loops; every 10th state has a second
+    // transition on a, which overlaps its first one.
+    MooreMachine machine("Generated");
+    machine.reserveTransitions(static_cast<size_t>(states) * 3);
+    for (int i = 0; i < states; i++) {
+        machine.addState(State(stateName(i), stateName(i)));
+    }
+    machine.setInitialState(stateName(0));
+
+    size_t expectedUnreachable = 0, expectedDead = 0, expectedTraps = 0, expectedOverlaps = 0;
+    auto link = [&](int from, int to, const std::string& value) {
+        std::string id = stateName(from) + "->" + stateName(to);
+        machine.addTransition(Transition(id, stateName(from), stateName(to),
+                                         std::vector<InputCondition>{InputCondition(value, "in")}, 0));
+    };
+    for (int i = 0; i < states; i++) {
+        int next = (i + 1) % states;
+        int skip = (i + 2) % states;
+        if (next % 100 == 50) {
+            next = (next + 1) % states;
+        }
+        if (skip % 100 == 50) {
+            skip = (skip + 1) % states;
+        }
+
+        if (i % 100 == 50) {
+            expectedUnreachable++;
+        }
+        if (i % 1000 == 999) {
+            expectedDead++;
+            continue;
+        }
+        if (i % 1000 == 500) {
+            expectedTraps++;
+            link(i, i, "a");
+            continue;
+        }
+        link(i, next, "a");
+        link(i, skip, "b");
+        if (i % 10 == 3 && (i + 3) % 100 != 50) {
+            expectedOverlaps++;
+            link(i, (i + 3) % states, "a");
+        }
+    }
+
+    // The dead and trap states still get entered through the transitions of the state before them
+    MachineAnalyzer analyzer(machine, threads);
+    analyzer.analyze();
+    MachineAnalysis analysis = analyzer.analyze();
+    double best = analysis.seconds;
+    for (int run = 0; run < 4; run++) {
+        best = std::min(best, analyzer.analyze().seconds);
+    }
+
+    bool ok = analysis.unreachableStates.size() == expectedUnreachable &&
+              analysis.deadStates.size() == expectedDead &&
+              analysis.trapStates.size() == expectedTraps &&
+              analysis.overlaps.size() == expectedOverlaps;
+
+    std::cout << std::fixed << std::setprecision(2)
+              << "machine      " << analysis.states << " states, " << analysis.transitions << " transitions\n"
+              << "unreachable  " << analysis.unreachableStates.size() << " (expected " << expectedUnreachable << ")\n"
+              << "dead         " << analysis.deadStates.size() << " (expected " << expectedDead << ")\n"
+              << "trap         " << analysis.trapStates.size() << " (expected " << expectedTraps << ")\n"
+              << "overlaps     " << analysis.overlaps.size() << " (expected " << expectedOverlaps << ")\n"
+              << "analysis     " << best * 1000 << " ms (best of 5)\n"
+              << (ok ? "findings ok" : "FINDINGS DIFFER") << std::endl;
+    return ok ? 0 : 1;
+}
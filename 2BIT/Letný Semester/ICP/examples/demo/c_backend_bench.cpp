@@ -0,0 +1,298 @@
+// xbohach00
+// Checks the generated C machines against the simulator on random inputs in virtual time, then
+// compares the step latency of the C header with the generated C++ styles on the example machines
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <set>
+
+#include "../../src/headers/machine_clock.h"
+#include "../../src/headers/machine_file_handler.h"
+#include "../../src/headers/machine_simulator.h"
+#include "../../src/headers/moore_machine.h"
+
+#include "c_backend/counter_c.h"
+#include "c_backend/counter_callback.h"
+#include "c_backend/counter_goto.h"
+#include "c_backend/counter_typed.h"
+#include "c_backend/semaphore_c.h"
+#include "c_backend/semaphore_callback.h"
+#include "c_backend/semaphore_goto.h"
+#include "c_backend/semaphore_typed.h"
+#include "c_backend/complex_semaphore_c.h"
+#include "c_backend/complex_semaphore_callback.h"
+#include "c_backend/complex_semaphore_goto.h"
+#include "c_backend/complex_semaphore_typed.h"
+#include "c_backend/vending_machine_c.h"
+#include "c_backend/vending_machine_callback.h"
+#include "c_backend/vending_machine_goto.h"
+#include "c_backend/vending_machine_typed.h"
+
+using namespace std::chrono;
+
+// The C functions of a generated header behind one name, so the checks can be templates
+#define C_MACHINE(P)                                                                                     \
+    struct P##_api {                                                                                     \
+        using Machine = P;                                                                               \
+        static void init(P* fsm, uint32_t now) { P##_init(fsm, now); }                                   \
+        static void reset(P* fsm, uint32_t now) { P##_reset(fsm, now); }                                 \
+        static void setInput(P* fsm, int input, const char* text) { P##_set_input(fsm, input, text); }   \
+        static bool step(P* fsm, uint32_t now) { return P##_step(fsm, now); }                            \
+        static bool advance(P* fsm, uint32_t* clock, uint32_t limit) { return P##_advance(fsm, clock, limit); } \
+        static const char* stateName(const P* fsm) { return P##_state_name(fsm); }                      \
+        static int findInput(const char* name) { return P##_find_input(name); }                          \
+        static int outputs() { return P##_OUTPUTS; }                                                     \
+        static const char* outputName(int output) { return P##_output_names[output]; }                   \
+    }
+
+C_MACHINE(counter_c);
+C_MACHINE(semaphore_c);
+C_MACHINE(complex_semaphore_c);
+C_MACHINE(vending_machine_c);
+
+// An input set at a time in milliseconds
+struct Event {
+    uint32_t time;
+    std::string input;
+    std::string value;
+};
+
+// Random inputs on every pointer, mostly symbols some condition waits for, sometimes unknown or empty text
+static std::vector<Event> randomEvents(MooreMachine& machine, size_t count, unsigned seed) {
+    std::vector<std::string> inputs;
+    for (const std::string& input : machine.getInputPointers()) {
+        if (!input.empty()) {
+            inputs.push_back(input);
+        }
+    }
+    std::set<std::string> symbolSet = machine.getInputAlphabet();
+    int longest = 10;
+    for (State* state : machine.getAllStates()) {
+        for (Transition* transition : machine.getTransitionsFromState(state->getId())) {
+            longest = std::max(longest, transition->getTimeout());
+            for (const auto& condition : transition->getInputConditions()) {
+                if (!condition.isBooleanExpr) {
+                    symbolSet.insert(condition.value);
+                }
+            }
+        }
+    }
+    std::vector<std::string> symbols(symbolSet.begin(), symbolSet.end());
+    symbols.push_back("unknown");
+    symbols.push_back("");
+
+    std::mt19937 random(seed);
+    std::vector<Event> events;
+    uint32_t time = 0;
+    for (size_t i = 0; i < count && !inputs.empty(); i++) {
+        // Some inputs arrive together, others after the longest timeout ran out
+        time += random() % 4 == 0 ? 0 : random() % (longest * 3 / 2);
+        events.push_back(Event{time, inputs[random() % inputs.size()], symbols[random() % symbols.size()]});
+    }
+    return events;
+}
+
+// Runs the simulator and the C machine side by side, returns the number of mismatches
+template <typename Api>
+static size_t checkParity(const MooreMachine& original, const std::vector<Event>& events, std::string& first) {
+    MooreMachine machine = original;
+    VirtualClock clock;
+    machine.setClock(&clock);
+    machine.resetVariables();
+    MachineSimulator simulator(&machine);
+    const steady_clock::time_point start = clock.now();
+
+    typename Api::Machine fsm;
+    uint32_t now = 0;
+    simulator.reset(clock.now());
+    Api::init(&fsm, now);
+
+    size_t mismatches = 0;
+    auto mismatch = [&](const std::string& what) {
+        if (mismatches++ == 0) {
+            first = "at " + std::to_string(now) + " ms " + what;
+        }
+    };
+    auto compare = [&]() {
+        std::string state = simulator.getCurrentState()->getName();
+        if (state != Api::stateName(&fsm)) {
+            mismatch("state " + state + " against " + Api::stateName(&fsm));
+        }
+        for (int output = 0; output < Api::outputs(); output++) {
+            std::string expected = simulator.getOutput(Api::outputName(output));
+            if (expected != fsm.outputs[output]) {
+                mismatch(std::string("output ") + Api::outputName(output) + " \"" + expected + "\" against \"" +
+                         fsm.outputs[output] + "\"");
+            }
+        }
+        if (fsm.error) {
+            mismatch(std::string("error ") + fsm.error);
+        }
+    };
+
+    compare();
+    for (const Event& event : events) {
+        // Both have to make the same steps on the way to the input
+        for (;;) {
+            bool stepped = simulator.advance(start + milliseconds(event.time));
+            if (stepped != Api::advance(&fsm, &now, event.time)) {
+                mismatch(stepped ? "step of the simulator only" : "step of the C machine only");
+            }
+            now = static_cast<uint32_t>(duration_cast<milliseconds>(clock.now() - start).count());
+            compare();
+            if (!stepped) {
+                break;
+            }
+        }
+        clock.sleepUntil(start + milliseconds(event.time));
+        now = event.time;
+
+        simulator.setInput(event.input, event.value);
+        simulator.processInputs(clock.now());
+        Api::setInput(&fsm, Api::findInput(event.input.c_str()), event.value.c_str());
+        Api::step(&fsm, now);
+        compare();
+    }
+    return mismatches;
+}
+
+// Events the latency is measured over, resolved to C input indices up front
+struct Script {
+    std::vector<Event> events;
+    std::vector<int> inputs;
+};
+
+// Feeds the script to a generated C++ class over and over, returns nanoseconds per input
+template <typename FSM>
+static double measureCpp(const Script& script, int runs, std::string& finalState) {
+    FSM fsm;
+    auto start = steady_clock::now();
+    for (int run = 0; run < runs; run++) {
+        fsm.reset();
+        for (const Event& event : script.events) {
+            fsm.processInput(event.value, event.input);
+            fsm.tick();
+        }
+    }
+    duration<double, std::nano> elapsed = steady_clock::now() - start;
+    finalState = fsm.getCurrentStateName();
+    return elapsed.count() / (static_cast<double>(runs) * script.events.size());
+}
+
+// Same for the C machine, which is given the time instead of reading a clock
+template <typename Api>
+static double measureC(const Script& script, int runs, std::string& finalState) {
+    typename Api::Machine fsm;
+    Api::init(&fsm, 0);
+    auto start = steady_clock::now();
+    for (int run = 0; run < runs; run++) {
+        Api::reset(&fsm, 0);
+        for (size_t i = 0; i < script.events.size(); i++) {
+            Api::setInput(&fsm, script.inputs[i], script.events[i].value.c_str());
+            Api::step(&fsm, 0);
+            Api::step(&fsm, 0);
+        }
+    }
+    duration<double, std::nano> elapsed = steady_clock::now() - start;
+    finalState = Api::stateName(&fsm);
+    return elapsed.count() / (static_cast<double>(runs) * script.events.size());
+}
+
+// Same for the simulator the other styles are generated from
+static double measureSimulator(const MooreMachine& original, const Script& script, int runs, std::string& finalState) {
+    MooreMachine machine = original;
+    MachineSimulator simulator(&machine);
+    auto start = steady_clock::now();
+    for (int run = 0; run < runs; run++) {
+        simulator.reset();
+        for (const Event& event : script.events) {
+            simulator.setInput(event.input, event.value);
+            simulator.processInputs();
+            simulator.processInputs();
+        }
+    }
+    duration<double, std::nano> elapsed = steady_clock::now() - start;
+    finalState = simulator.getCurrentState()->getName();
+    return elapsed.count() / (static_cast<double>(runs) * script.events.size());
+}
+
+// Checks one machine and prints a row per style, returns false if anything disagrees
+template <typename Api, typename Callback, typename Goto, typename Typed>
+static bool benchMachine(const std::string& name, const std::string& path, size_t checkEvents, int runs) {
+    MooreMachine machine = MachineFileHandler::loadFromFile(path);
+
+    std::string first;
+    std::vector<Event> events = randomEvents(machine, checkEvents, 42);
+    size_t mismatches = checkParity<Api>(machine, events, first);
+    std::cout << name << ": " << events.size() << " random inputs, " << mismatches << " mismatches with the simulator"
+              << (mismatches ? ", first " + first : "") << "\n";
+
+    // Inputs all at one instant, so no timeout fires in any style
+    Script script;
+    script.events = randomEvents(machine, 64, 7);
+    for (const Event& event : script.events) {
+        script.inputs.push_back(Api::findInput(event.input.c_str()));
+    }
+    std::string simulatorState, callbackState, gotoState, typedState, cState;
+    double simulatorNs = measureSimulator(machine, script, runs / 4, simulatorState);
+    double callbackNs = measureCpp<Callback>(script, runs, callbackState);
+    double gotoNs = measureCpp<Goto>(script, runs, gotoState);
+    double typedNs = measureCpp<Typed>(script, runs, typedState);
+    double cNs = measureC<Api>(script, runs, cState);
+
+    auto report = [&](const std::string& style, double ns, const std::string& state) {
+        std::cout << "  " << std::left << std::setw(12) << style << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(10) << ns << std::setprecision(2) << std::setw(9) << callbackNs / ns << "x  " << state << "\n";
+    };
+    std::cout << "  " << std::left << std::setw(12) << "style" << std::right << std::setw(10) << "ns/input"
+              << std::setw(10) << "speedup" << "  final state\n";
+    report("simulator", simulatorNs, simulatorState);
+    report("callback", callbackNs, callbackState);
+    report("goto", gotoNs, gotoState);
+    report("typed", typedNs, typedState);
+    report("c", cNs, cState);
+
+    bool agree = callbackState == simulatorState && gotoState == simulatorState && typedState == simulatorState &&
+                 cState == simulatorState;
+    if (!agree) {
+        std::cerr << name << ": styles disagree on the final state" << std::endl;
+    }
+    return agree && mismatches == 0;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <examples_dir> [-e check_events] [-n runs]" << std::endl;
+        return 1;
+    }
+    std::string dir = argv[1];
+    size_t checkEvents = 20000;
+    int runs = 20000;
+    for (int i = 2; i + 1 < argc; i += 2) {
+        std::string arg = argv[i];
+        if (arg == "-e") {
+            checkEvents = std::stoul(argv[i + 1]);
+        } else if (arg == "-n") {
+            runs = std::stoi(argv[i + 1]);
+        }
+    }
+
+    try {
+        bool ok = benchMachine<counter_c_api, counter_callback, counter_goto, counter_typed>(
+            "counter", dir + "/counter.fsm", checkEvents, runs);
+        ok = benchMachine<semaphore_c_api, semaphore_callback, semaphore_goto, semaphore_typed>(
+            "semaphore", dir + "/semaphore.fsm", checkEvents, runs) && ok;
+        ok = benchMachine<complex_semaphore_c_api, complex_semaphore_callback, complex_semaphore_goto, complex_semaphore_typed>(
+            "complex_semaphore", dir + "/complex_semaphore.fsm", checkEvents, runs) && ok;
+        ok = benchMachine<vending_machine_c_api, vending_machine_callback, vending_machine_goto, vending_machine_typed>(
+            "vending_machine", dir + "/vending_machine.fsm", checkEvents, runs) && ok;
+        std::cout << (ok ? "c backend ok" : "C BACKEND FAILED") << std::endl;
+        return ok ? 0 : 1;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,24 @@
+/* xbohach00 */
+/* Compiles a generated C machine on its own, FSM names its prefix and FSM_HEADER its header */
+#include FSM_HEADER
+
+#define PASTE(prefix, name) prefix##name
+#define EXPAND(prefix, name) PASTE(prefix, name)
+#define API(name) EXPAND(FSM, name)
+
+/* The header is all static inline, these keep the code an application would call */
+void API(_unit_init)(FSM* fsm, uint32_t now) {
+    API(_init)(fsm, now);
+}
+
+void API(_unit_set_input)(FSM* fsm, int input, const char* text) {
+    API(_set_input)(fsm, input, text);
+}
+
+bool API(_unit_step)(FSM* fsm, uint32_t now) {
+    return API(_step)(fsm, now);
+}
+
+bool API(_unit_advance)(FSM* fsm, uint32_t* clock, uint32_t limit) {
+    return API(_advance)(fsm, clock, limit);
+}
@@ -0,0 +1,113 @@
+// xbohach00
+// Compares generated machines with a hundred thousand states against their minimized and
+// altered copies, checks the verdicts and traces and reports the time
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+
+#include "../../src/headers/machine_file_handler.h"
+#include "../../src/headers/machine_equivalence.h"
+#include "../../src/headers/machine_minimizer.h"
+#include "../../src/headers/moore_machine.h"
+
+// A ring counting ticks that outputs the count modulo the period and goes back to the start on reset
+static MooreMachine makeRing(int states, int period) {
+    MooreMachine machine("Ring");
+    machine.reserveTransitions(static_cast<size_t>(states) * 2);
+    for (int i = 0; i < states; i++) {
+        State state("S" + std::to_string(i), "S" + std::to_string(i));
+        state.addOutput(OutputCondition(std::to_string(i % period), "count"));
+        state.setPosition(Point(i * 10.0, 0));
+        machine.addState(state);
+    }
+    machine.setInitialState("S0");
+    for (int i = 0; i < states; i++) {
+        std::string source = "S" + std::to_string(i);
+        std::string next = "S" + std::to_string((i + 1) % states);
+        std::vector<InputCondition> tick{InputCondition("tick", "clock")};
+
+        // The last state ticks back to the start, one transition carries both inputs
+        if (i == states - 1) {
+            tick.push_back(InputCondition("reset", "clock"));
+        } else if (i != 0) {
+            machine.addTransition(Transition(source + "->S0", source, "S0",
+                                             std::vector<InputCondition>{InputCondition("reset", "clock")}, 0));
+        }
+        machine.addTransition(Transition(source + "->" + next, source, next, tick, 0));
+    }
+    return machine;
+}
+
+static void report(const std::string& name, const EquivalenceResult& result) {
+    std::cout << std::fixed << std::setprecision(1) << std::left << std::setw(22) << name
+              << (result.equivalent ? "equivalent" : "different ") << ", " << result.pairsVisited << " pairs, trace of "
+              << result.trace.size() << ", " << result.seconds * 1000 << " ms\n";
+}
+
+int main(int argc, char* argv[]) {
+    int states = 100000;
+    int period = 8;
+    std::string outputDir;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "-s" && i + 1 < argc) {
+            states = std::stoi(argv[++i]);
+        } else if (arg == "-p" && i + 1 < argc) {
+            period = std::stoi(argv[++i]);
+        } else if (arg == "-o" && i + 1 < argc) {
+            outputDir = argv[++i];
+        } else {
+            states = 0;
+        }
+    }
+    if (period <= 0 || states < 2 * period || states % period != 0) {
+        std::cerr << "Usage: " << argv[0] << " [-s states] [-p period dividing states] [-o output_dir]" << std::endl;
+        return 1;
+    }
+
+    MooreMachine ring = makeRing(states, period);
+    MooreMachine minimized = ring.minimize().machine;
+    std::cout << "machine               " << states << " states, minimized to "
+              << minimized.getAllStates().size() << "\n";
+
+    // Every pair of the ring with itself is visited before the search can stop
+    EquivalenceResult same = EquivalenceChecker(ring, ring).check();
+    report("ring vs itself", same);
+
+    EquivalenceResult reduced = EquivalenceChecker(ring, minimized).check();
+    report("ring vs minimized", reduced);
+
+    // Only the last state of the ring tells the copy apart, at the end of the longest path
+    MooreMachine altered = ring;
+    State* last = altered.getState("S" + std::to_string(states - 1));
+    last->clearOutputs();
+    last->addOutput(OutputCondition("x", "count"));
+    EquivalenceResult differs = EquivalenceChecker(minimized, altered).check();
+    report("minimized vs altered", differs);
+
+    // The first state already tells them apart
+    MooreMachine shifted = makeRing(states, period);
+    shifted.getState("S0")->clearOutputs();
+    shifted.getState("S0")->addOutput(OutputCondition("x", "count"));
+    EquivalenceResult early = EquivalenceChecker(ring, shifted).check();
+    report("ring vs shifted", early);
+
+    bool traceOk = differs.trace.size() == static_cast<size_t>(states - 1) &&
+                   differs.rightState == "S" + std::to_string(states - 1);
+    for (const EquivalenceStep& step : differs.trace) {
+        traceOk = traceOk && step.inputPtr == "clock" && step.value == "tick";
+    }
+    bool ok = same.equivalent && same.pairsVisited == static_cast<size_t>(states) &&
+              reduced.equivalent && !differs.equivalent && traceOk &&
+              !early.equivalent && early.pairsVisited == 1 && early.trace.empty();
+
+    if (!outputDir.empty()) {
+        ok = ok && MachineFileHandler::saveToFile(ring, outputDir + "/ring.fsm") &&
+             MachineFileHandler::saveToFile(minimized, outputDir + "/ring_minimized.fsm") &&
+             MachineFileHandler::saveToFile(altered, outputDir + "/ring_altered.fsm");
+    }
+
+    std::cout << (ok ? "equivalence ok" : "EQUIVALENCE FAILED") << std::endl;
+    return ok ? 0 : 1;
+}
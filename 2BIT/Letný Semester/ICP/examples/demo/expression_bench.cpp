@@ -0,0 +1,101 @@
+// xbohach00
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <stdexcept>
+
+#include "../../src/headers/machine_file_handler.h"
+#include "../../src/headers/expression_parser.h"
+#include "../../src/headers/moore_machine.h"
+#include "../../src/headers/string_utils.h"
+
+// Collects the arithmetic expressions a simulation of the machine evaluates
+static std::vector<std::string> collectExpressions(MooreMachine& machine) {
+    std::vector<std::string> expressions;
+    auto variables = machine.getVariables();
+
+    for (State* state : machine.getAllStates()) {
+        for (const auto& output : state->getOutputs()) {
+            size_t equalsPos = output.value.find('=');
+            if (output.target == "expression" && equalsPos != std::string::npos) {
+                std::string expression = trim(output.value.substr(equalsPos + 1));
+                if (expression.find("get ") != 0) {
+                    expressions.push_back(expression);
+                }
+            } else if (variables.find(output.value) != variables.end()) {
+                expressions.push_back(output.value);
+            }
+        }
+    }
+    return expressions;
+}
+
+// Runs fn over all expressions for the given number of rounds, returns evaluations per second
+template <typename Fn>
+static double measure(const std::vector<std::string>& expressions, int rounds, Fn fn) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < rounds; i++) {
+        for (const auto& expression : expressions) {
+            fn(expression);
+        }
+    }
+    std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - start;
+    return static_cast<double>(rounds) * expressions.size() / seconds.count();
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <fsm_file>... [-n rounds]" << std::endl;
+        return 1;
+    }
+
+    int rounds = 200000;
+    std::vector<std::string> files;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "-n" && i + 1 < argc) {
+            rounds = std::stoi(argv[++i]);
+        } else {
+            files.push_back(arg);
+        }
+    }
+
+    std::cout << std::left << std::setw(32) << "machine" << std::setw(8) << "exprs"
+              << std::right << std::setw(16) << "parsed eval/s" << std::setw(16) << "compiled eval/s"
+              << std::setw(10) << "speedup" << std::endl;
+
+    try {
+        for (const auto& file : files) {
+            MooreMachine machine = MachineFileHandler::loadFromFile(file);
+            std::vector<std::string> expressions = collectExpressions(machine);
+            if (expressions.empty()) {
+                std::cout << std::left << std::setw(32) << file << "no expressions" << std::endl;
+                continue;
+            }
+
+            // Before: every evaluation tokenizes and interprets the source text
+            ExpressionParser parser;
+            auto variables = machine.getVariables();
+            double parsed = measure(expressions, rounds, [&](const std::string& expression) {
+                parser.evaluateExpression(expression, variables, 0);
+            });
+
+            // After: the machine compiles each expression once and reruns the program
+            double compiled = measure(expressions, rounds, [&](const std::string& expression) {
+                machine.evaluateExpression(expression, 0);
+            });
+
+            std::cout << std::left << std::setw(32) << file << std::setw(8) << expressions.size()
+                      << std::right << std::fixed << std::setprecision(0)
+                      << std::setw(16) << parsed << std::setw(16) << compiled
+                      << std::setprecision(2) << std::setw(9) << compiled / parsed << "x" << std::endl;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
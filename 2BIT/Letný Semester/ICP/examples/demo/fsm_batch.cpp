@@ -0,0 +1,81 @@
+// xbohach00
+// Runs many instances of a machine over input traces in virtual time and reports the throughput
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <filesystem>
+#include <stdexcept>
+
+#include "../../src/headers/machine_file_handler.h"
+#include "../../src/headers/batch_simulator.h"
+#include "../../src/headers/moore_machine.h"
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " <fsm_file> <trace_file>... [-n instances] [-j threads]"
+                  << " [-t horizon_ms] [-o output_dir]" << std::endl;
+        return 1;
+    }
+
+    size_t instances = 0;
+    int threads = 0;
+    long long horizon = 0;
+    std::string outputDir;
+    std::vector<std::string> traceFiles;
+    for (int i = 2; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "-n" && i + 1 < argc) {
+            instances = std::stoul(argv[++i]);
+        } else if (arg == "-j" && i + 1 < argc) {
+            threads = std::stoi(argv[++i]);
+        } else if (arg == "-t" && i + 1 < argc) {
+            horizon = std::stoll(argv[++i]);
+        } else if (arg == "-o" && i + 1 < argc) {
+            outputDir = argv[++i];
+        } else {
+            traceFiles.push_back(arg);
+        }
+    }
+
+    try {
+        // Parse everything once, the workers only copy the result
+        MooreMachine machine = MachineFileHandler::loadFromFile(argv[1]);
+        std::vector<InputTrace> traces;
+        for (const auto& file : traceFiles) {
+            traces.push_back(BatchSimulator::loadTrace(file));
+        }
+        if (instances == 0) {
+            instances = traces.size();
+        }
+
+        BatchSimulator batch(machine, threads);
+        batch.setHorizon(horizon);
+        if (!outputDir.empty()) {
+            std::filesystem::create_directories(outputDir);
+            batch.setOutputDirectory(outputDir);
+        }
+
+        BatchStats stats = batch.run(traces, instances);
+
+        std::cout << argv[1] << ": " << stats.instances << " instances of " << traces.size() << " traces on "
+                  << stats.threadSteps.size() << " threads" << std::endl;
+        std::cout << std::fixed << std::setprecision(3) << stats.steps << " steps in " << stats.seconds << " s, "
+                  << std::setprecision(0) << stats.steps / stats.seconds << " steps/s, "
+                  << stats.steps / stats.seconds / stats.threadSteps.size() << " steps/s per core" << std::endl;
+        for (size_t i = 0; i < stats.threadSteps.size(); i++) {
+            double rate = stats.threadSeconds[i] > 0 ? stats.threadSteps[i] / stats.threadSeconds[i] : 0;
+            std::cout << "  thread " << i << ": " << stats.threadSteps[i] << " steps, " << rate << " steps/s" << std::endl;
+        }
+
+        if (stats.failed > 0) {
+            std::cerr << stats.failed << " instances failed, first: " << stats.firstError << std::endl;
+            return 1;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,46 @@
+// xbohach00
+// Checks whether two machine files behave the same and prints the first input trace telling them apart
+#include <iostream>
+#include <iomanip>
+#include <string>
+
+#include "../../src/headers/machine_file_handler.h"
+#include "../../src/headers/machine_equivalence.h"
+#include "../../src/headers/moore_machine.h"
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " <left_fsm_file> <right_fsm_file> [-l pair_limit]" << std::endl;
+        return 2;
+    }
+
+    size_t pairLimit = 0;
+    for (int i = 3; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "-l" && i + 1 < argc) {
+            pairLimit = std::stoul(argv[++i]);
+        } else {
+            std::cerr << "Unknown argument: " << arg << std::endl;
+            return 2;
+        }
+    }
+
+    try {
+        MooreMachine left = MachineFileHandler::loadFromFile(argv[1]);
+        MooreMachine right = MachineFileHandler::loadFromFile(argv[2]);
+        EquivalenceResult result = EquivalenceChecker(left, right, pairLimit).check();
+
+        std::cout << argv[1] << " vs " << argv[2] << std::endl;
+        for (const std::string& line : EquivalenceChecker::describe(result)) {
+            std::cout << line << "\n";
+        }
+        std::cout << std::fixed << std::setprecision(1) << "checked in " << result.seconds * 1000 << " ms"
+                  << std::endl;
+
+        // Like diff, 0 for the same behaviour, 1 for a difference or an unfinished search
+        return result.equivalent ? 0 : 1;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 2;
+    }
+}
@@ -0,0 +1,35 @@
+// xbohach00
+// Exports a machine as a program split into sources that compile in parallel,
+// printing every source as it is written and the build files at the end
+#include <iostream>
+#include <string>
+
+#include "../../src/headers/code_generator.h"
+#include "../../src/headers/machine_file_handler.h"
+#include "../../src/headers/moore_machine.h"
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " <fsm_file> <output_base> [-u unit_size]" << std::endl;
+        return 1;
+    }
+    size_t unitSize = CodeGenarator::UNIT_SIZE;
+    for (int i = 3; i + 1 < argc; i += 2) {
+        if (std::string(argv[i]) == "-u") {
+            unitSize = std::stoul(argv[i + 1]);
+        }
+    }
+
+    try {
+        MooreMachine machine = MachineFileHandler::loadFromFile(argv[1]);
+        GeneratedProgram program = CodeGenarator::generateCode(machine, argv[2], [](const std::string& source) {
+            std::cout << "written " << source << "\n";
+        }, unitSize);
+        std::cout << program.sources.size() << " sources including " << program.header << ", build "
+                  << program.executable << " with " << program.makefile << " or " << program.ninjaFile << std::endl;
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+}
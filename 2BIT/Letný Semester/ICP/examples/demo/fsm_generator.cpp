@@ -7,9 +7,48 @@
 #include "../../src/headers/includable_generator.h"
 #include "../../src/headers/moore_machine.h"
 
+// Generates a single style, used by the style benchmark
+static int generateStyle(const std::string& styleName, const std::string& fsmFile,
+                         const std::string& className, const std::string& baseName) {
+    CodeStyle style;
+    if (styleName == "callback") {
+        style = CodeStyle::CALLBACK;
+    } else if (styleName == "goto") {
+        style = CodeStyle::COMPUTED_GOTO;
+    } else if (styleName == "typed") {
+        style = CodeStyle::TYPED;
+    } else if (styleName == "c") {
+        style = CodeStyle::C_TABLE;
+    } else {
+        std::cerr << "Unknown style: " << styleName << std::endl;
+        return 1;
+    }
+    
+    try {
+        MooreMachine machine = MachineFileHandler::loadFromFile(fsmFile);
+        if (!IncludableGenerator::generateCode(machine, baseName, className, style)) {
+            std::cerr << "Failed to generate " << styleName << " style code!" << std::endl;
+            return 1;
+        }
+        if (style == CodeStyle::C_TABLE) {
+            std::cout << "Successfully generated " << baseName << ".h" << std::endl;
+        } else {
+            std::cout << "Successfully generated " << baseName << ".h and " << baseName << ".cpp" << std::endl;
+        }
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+}
+
 int main(int argc, char* argv[]) {
+    if (argc == 6 && std::string(argv[1]) == "--style") {
+        return generateStyle(argv[2], argv[3], argv[4], argv[5]);
+    }
     if (argc < 5) {
         std::cerr << "Usage: " << argv[0] << " <fsm_file> <class_name> <callback_base> <goto_base>" << std::endl;
+        std::cerr << "       " << argv[0] << " --style <callback|goto|typed|c> <fsm_file> <class_name> <base>" << std::endl;
         return 1;
     }
     
@@ -0,0 +1,50 @@
+// xbohach00
+// Replays a recorded trace on a machine file at full speed and prints where the outputs differ
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+
+#include "../../src/headers/machine_file_handler.h"
+#include "../../src/headers/moore_machine.h"
+#include "../../src/headers/trace_replayer.h"
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " <fsm_file> <trace_file>... [-m max_reported]" << std::endl;
+        return 2;
+    }
+
+    size_t maxReported = 20;
+    std::vector<std::string> traceFiles;
+    for (int i = 2; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "-m" && i + 1 < argc) {
+            maxReported = std::stoul(argv[++i]);
+        } else {
+            traceFiles.push_back(arg);
+        }
+    }
+
+    try {
+        MooreMachine machine = MachineFileHandler::loadFromFile(argv[1]);
+        TraceReplayer replayer(machine, maxReported);
+
+        bool same = true;
+        for (const std::string& file : traceFiles) {
+            ReplayResult result = replayer.replay(file);
+            std::cout << file << ": " << std::fixed << std::setprecision(1) << result.traceMicros / 1e6
+                      << " s replayed in " << result.seconds * 1000 << " ms\n";
+            for (const std::string& line : TraceReplayer::describe(result)) {
+                std::cout << "  " << line << "\n";
+            }
+            same = same && result.mismatchCount == 0;
+        }
+
+        // Like diff, 0 when every trace reproduced, 1 when one did not
+        return same ? 0 : 1;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 2;
+    }
+}
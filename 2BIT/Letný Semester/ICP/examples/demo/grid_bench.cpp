@@ -0,0 +1,100 @@
+// xbohach00
+// Places the states of a large diagram in a spatial grid, checks view sized queries find the same states
+// as scanning all of them, and compares the time of both while the states are dragged around
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../../src/headers/spatial_grid.h"
+
+static const double STATE_SIZE = 60;
+
+struct Box {
+    std::string id;
+    Point min;
+};
+
+static bool overlaps(const Box& box, const Point& min, const Point& max) {
+    return box.min.x <= max.x && box.min.x + STATE_SIZE >= min.x && box.min.y <= max.y && box.min.y + STATE_SIZE >= min.y;
+}
+
+static double elapsedMs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char* argv[]) {
+    size_t count = argc > 1 ? std::stoul(argv[1]) : 100000;
+    const int queries = 2000;
+    const double side = 80 * 400;
+
+    std::mt19937 random(25);
+    std::uniform_real_distribution<double> coordinate(0, side);
+    std::uniform_real_distribution<double> drag(-20, 20);
+
+    std::vector<Box> boxes;
+    SpatialGrid grid;
+    for (size_t i = 0; i < count; i++) {
+        Box box{"s" + std::to_string(i), Point(coordinate(random), coordinate(random))};
+        grid.insert(box.id, box.min, Point(box.min.x + STATE_SIZE, box.min.y + STATE_SIZE));
+        boxes.push_back(box);
+    }
+
+    // Drag states around, some of them across cells
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 1000000; i++) {
+        Box& box = boxes[random() % boxes.size()];
+        box.min = Point(box.min.x + drag(random), box.min.y + drag(random));
+        grid.move(box.id, box.min, Point(box.min.x + STATE_SIZE, box.min.y + STATE_SIZE));
+    }
+    double moveMs = elapsedMs(start);
+
+    // Remove and add back a tenth of them
+    for (size_t i = 0; i < count; i += 10) {
+        grid.remove(boxes[i].id);
+    }
+    for (size_t i = 0; i < count; i += 10) {
+        grid.insert(boxes[i].id, boxes[i].min, Point(boxes[i].min.x + STATE_SIZE, boxes[i].min.y + STATE_SIZE));
+    }
+
+    std::vector<std::pair<Point, Point>> areas;
+    for (int i = 0; i < queries; i++) {
+        Point min(coordinate(random), coordinate(random));
+        areas.emplace_back(min, Point(min.x + 1920 * 2, min.y + 1080 * 2));
+    }
+
+    size_t found = 0;
+    start = std::chrono::steady_clock::now();
+    std::vector<std::vector<std::string>> gridResults;
+    for (const auto& area : areas) {
+        gridResults.push_back(grid.query(area.first, area.second));
+        found += gridResults.back().size();
+    }
+    double gridMs = elapsedMs(start);
+
+    start = std::chrono::steady_clock::now();
+    std::vector<std::vector<std::string>> scanResults;
+    for (const auto& area : areas) {
+        scanResults.emplace_back();
+        for (const Box& box : boxes) {
+            if (overlaps(box, area.first, area.second)) {
+                scanResults.back().push_back(box.id);
+            }
+        }
+    }
+    double scanMs = elapsedMs(start);
+
+    int mismatches = 0;
+    for (int i = 0; i < queries; i++) {
+        std::sort(gridResults[i].begin(), gridResults[i].end());
+        std::sort(scanResults[i].begin(), scanResults[i].end());
+        mismatches += gridResults[i] != scanResults[i] ? 1 : 0;
+    }
+
+    std::cout << count << " states, " << grid.size() << " in the grid, 1000000 drags in " << moveMs << " ms" << std::endl;
+    std::cout << queries << " view queries finding " << found << " states: grid " << gridMs << " ms, scan " << scanMs
+              << " ms, " << mismatches << " mismatches" << std::endl;
+    return mismatches == 0 && grid.size() == count ? 0 : 1;
+}
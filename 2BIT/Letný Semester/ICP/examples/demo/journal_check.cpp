@@ -0,0 +1,244 @@
+// xbohach00
+// Makes random edits through the edit journal, checks undoing them all and redoing them all gives back
+// the same machine files, then measures undo and redo on machines of growing size
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../../src/headers/edit_journal.h"
+#include "../../src/headers/machine_file_handler.h"
+#include "../../src/headers/moore_machine.h"
+
+static std::string stateName(size_t i) {
+    return "s" + std::to_string(i);
+}
+
+// Builds a ring of states, each with a transition to the next one and one two states ahead
+static MooreMachine buildMachine(size_t states) {
+    MooreMachine machine("JournalCheck");
+    machine.addInputPointer("in");
+    machine.addOutputPointer("out");
+    machine.addVariable("int", "counter", "0");
+    // Transitions add their inputs to the alphabet and removing them keeps the symbols,
+    // so the symbols of the random edits are there from the start
+    for (const char* symbol : {"y", "z0", "z1", "z2", "z3", "z4"}) {
+        machine.addInputSymbol(symbol);
+    }
+    for (size_t i = 0; i < states; i++) {
+        State state(stateName(i), stateName(i));
+        state.setPosition(Point(static_cast<int>(i % 100) * 80, static_cast<int>(i / 100) * 80));
+        state.addOutput(OutputCondition("o" + std::to_string(i % 7), "out"));
+        machine.addState(state);
+    }
+    machine.setInitialState(stateName(0));
+    machine.reserveTransitions(states * 2);
+    for (size_t i = 0; i < states; i++) {
+        for (size_t step : {1, 2}) {
+            std::string target = stateName((i + step) % states);
+            Transition transition(stateName(i) + "->" + target, stateName(i), target,
+                                  {InputCondition("x" + std::to_string(step), "in")});
+            machine.addTransition(transition);
+        }
+    }
+    return machine;
+}
+
+// Saves the machine and reads the file back, with the variables sorted as they are saved in no particular order
+static std::string machineText(const MooreMachine& machine, const std::string& path) {
+    if (!MachineFileHandler::saveToFile(machine, path)) {
+        throw std::runtime_error("Cannot save " + path);
+    }
+    std::ifstream file(path);
+    std::string text;
+    std::vector<std::string> variables;
+    bool inVariables = false;
+    for (std::string line; std::getline(file, line);) {
+        if (line == "Variables are" || line == "States are") {
+            inVariables = line == "Variables are";
+            std::sort(variables.begin(), variables.end());
+            for (const std::string& variable : variables) {
+                text += variable + "\n";
+            }
+            variables.clear();
+        } else if (inVariables) {
+            variables.push_back(line);
+            continue;
+        }
+        text += line + "\n";
+    }
+    return text;
+}
+
+// Makes one random edit, returns whether the machine accepted it
+static bool randomEdit(EditJournal& journal, MooreMachine& machine, std::mt19937& random, size_t& nextState) {
+    std::vector<State*> states = machine.getAllStates();
+    auto pick = [&]() { return states[random() % states.size()]->getId(); };
+    switch (random() % 9) {
+        case 0: {
+            State state(stateName(nextState), stateName(nextState));
+            nextState++;
+            state.setIsInitial(random() % 4 == 0);
+            return journal.addState(machine, state);
+        }
+        case 1:
+            return states.size() > 2 && journal.removeState(machine, pick());
+        case 2:
+        case 3: {
+            std::string source = pick();
+            std::string target = pick();
+            Transition transition(source + "->" + target, source, target, {InputCondition("y", "in")});
+            return journal.addTransition(machine, transition);
+        }
+        case 4: {
+            std::vector<std::pair<Transition*, size_t>> incident = machine.getIncidentTransitions(pick());
+            return !incident.empty() &&
+                   journal.removeTransition(machine, incident[random() % incident.size()].first->getId());
+        }
+        case 5: {
+            std::vector<std::pair<Transition*, size_t>> incident = machine.getIncidentTransitions(pick());
+            if (incident.empty()) {
+                return false;
+            }
+            Transition updated = *incident[random() % incident.size()].first;
+            updated.setTimeout(static_cast<int>(random() % 1000));
+            updated.setInputConditions({InputCondition("z" + std::to_string(random() % 5), "in")});
+            return journal.replaceTransition(machine, updated);
+        }
+        case 6:
+            return journal.setInitialState(machine, pick());
+        case 7:
+            return journal.addVariable(machine, "int", "v" + std::to_string(random() % 4), std::to_string(random() % 100));
+        default:
+            return journal.removeVariable(machine, "v" + std::to_string(random() % 4));
+    }
+}
+
+// Undoes and redoes every edit, the machine files must match before and after
+static bool checkRoundTrip(const std::string& tempPath) {
+    MooreMachine machine = buildMachine(200);
+    EditJournal journal;
+    std::string before = machineText(machine, tempPath);
+
+    std::mt19937 random(24);
+    size_t nextState = 200;
+    size_t made = 0;
+    for (int i = 0; i < 3000; i++) {
+        made += randomEdit(journal, machine, random, nextState) ? 1 : 0;
+    }
+    std::string after = machineText(machine, tempPath);
+
+    size_t undone = 0;
+    while (journal.undo(machine)) {
+        undone++;
+    }
+    bool undoSame = machineText(machine, tempPath) == before;
+
+    size_t redone = 0;
+    while (journal.redo(machine)) {
+        redone++;
+    }
+    bool redoSame = machineText(machine, tempPath) == after;
+
+    std::cout << made << " edits made, " << undone << " undone: " << (undoSame ? "same" : "DIFFERENT")
+              << " as before, " << redone << " redone: " << (redoSame ? "same" : "DIFFERENT") << " as after"
+              << std::endl;
+    return undoSame && redoSame && undone == made && redone == made;
+}
+
+// A small bound must forget the oldest edits and keep the newest ones
+static bool checkCapacity() {
+    MooreMachine machine = buildMachine(50);
+    EditJournal journal(20);
+    for (size_t i = 0; i < 100; i++) {
+        journal.addVariable(machine, "int", "w" + std::to_string(i), "1");
+    }
+    size_t undone = 0;
+    while (journal.undo(machine)) {
+        undone++;
+    }
+    bool bounded = undone == 20 && machine.getVariable("w79") && !machine.getVariable("w80");
+    std::cout << "capacity 20: " << undone << " edits kept, " << (bounded ? "oldest forgotten" : "WRONG") << std::endl;
+    return bounded;
+}
+
+// Adding an initial state to a machine without one and undoing that must leave no state marked
+static bool checkFirstInitial(const std::string& tempPath) {
+    MooreMachine machine("JournalInitial");
+    machine.addState(State("a", "a"));
+    machine.addState(State("b", "b"));
+    EditJournal journal;
+    std::string before = machineText(machine, tempPath);
+
+    State initial("c", "c");
+    initial.setIsInitial(true);
+    journal.addState(machine, initial);
+    journal.undo(machine);
+    bool same = !machine.getInitialState() && machineText(machine, tempPath) == before;
+    std::cout << "first initial state undone: " << (same ? "no state marked" : "WRONG") << std::endl;
+    return same;
+}
+
+// Replacing the conditions of a transition must register their symbol and pointer, also when redone
+static bool checkReplacedConditions() {
+    MooreMachine machine = buildMachine(10);
+    EditJournal journal;
+    Transition updated = *machine.getTransition("s0->s1");
+    updated.setInputConditions({InputCondition("w", "in2")});
+    journal.replaceTransition(machine, updated);
+    journal.undo(machine);
+    journal.redo(machine);
+    bool registered = machine.getInputAlphabet().count("w") && machine.getInputPointers().count("in2") &&
+                      machine.getOutgoingPosition("s0->s1") == 0;
+    std::cout << "replaced conditions: " << (registered ? "symbol and pointer registered" : "NOT REGISTERED")
+              << std::endl;
+    return registered;
+}
+
+// Removes states with their transitions and undoes and redoes that, the time must not grow with the machine
+static void measure(size_t states) {
+    MooreMachine machine = buildMachine(states);
+    EditJournal journal;
+    const int edits = 1000;
+    for (int i = 0; i < edits; i++) {
+        journal.removeState(machine, stateName(1 + i * (states - 1) / edits));
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    while (journal.undo(machine)) {
+    }
+    auto undone = std::chrono::steady_clock::now();
+    while (journal.redo(machine)) {
+    }
+    auto redone = std::chrono::steady_clock::now();
+
+    auto perEdit = [&](std::chrono::steady_clock::duration time) {
+        return std::chrono::duration<double, std::micro>(time).count() / edits;
+    };
+    std::cout << states << " states: undo " << perEdit(undone - start) << " us, redo "
+              << perEdit(redone - undone) << " us per state removal, history of " << journal.getWeight()
+              << " elements" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    std::string tempPath = argc > 1 ? argv[1] : "journal_check.fsm";
+    try {
+        bool ok = checkRoundTrip(tempPath);
+        ok = checkCapacity() && ok;
+        ok = checkFirstInitial(tempPath) && ok;
+        ok = checkReplacedConditions() && ok;
+        for (size_t states : {1000, 10000, 100000}) {
+            measure(states);
+        }
+        std::remove(tempPath.c_str());
+        return ok ? 0 : 1;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+}
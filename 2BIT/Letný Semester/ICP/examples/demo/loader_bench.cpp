@@ -0,0 +1,154 @@
+// xbohach00
+// Writes a synthetic machine with many transitions and measures how fast MachineFileHandler loads it,
+// then how fast MachineSnapshot loads the same machine from a binary snapshot
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <string>
+#include <chrono>
+#include <cstdio>
+#include <stdexcept>
+
+#include "../../src/headers/machine_file_handler.h"
+#include "../../src/headers/machine_snapshot.h"
+#include "../../src/headers/moore_machine.h"
+
+// Counts the transitions of a machine
+static size_t countTransitions(MooreMachine& machine) {
+    size_t count = 0;
+    for (State* state : machine.getAllStates()) {
+        count += machine.getTransitionsFromState(state->getId()).size();
+    }
+    return count;
+}
+
+// Loads a machine runs times and returns the best time in seconds
+template <typename Load>
+static double timeLoad(int runs, size_t& loaded, Load load) {
+    double best = 0;
+    for (int run = 0; run < runs; run++) {
+        auto start = std::chrono::steady_clock::now();
+        MooreMachine machine = load();
+        std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - start;
+        if (run == 0 || seconds.count() < best) {
+            best = seconds.count();
+        }
+        loaded = countTransitions(machine);
+    }
+    return best;
+}
+
+// Writes a machine where every state has a transition to each of the next transitions/states states
+static void writeMachine(const std::string& path, int states, long transitions) {
+    std::ofstream file(path);
+    if (!file) {
+        throw std::runtime_error("Cannot write " + path);
+    }
+
+    file << "Name Synthetic\n";
+    file << "Input alphabet is a, b, c, d\n";
+    file << "Output alphabet is on, off\n";
+    file << "Input pointers are default, left, right\n";
+    file << "Output pointers are default, lamp\n";
+    file << "Variables are\n";
+    file << "\tint count = 0\n";
+    file << "\tstring mode = \"idle\"\n";
+    file << "States are\n";
+    for (int i = 0; i < states; i++) {
+        file << "\tS" << i << ": [output " << (i % 2 ? "on" : "off") << " to lamp; count = count + 1]\n";
+    }
+
+    file << "Transitions are\n";
+    long perState = transitions / states;
+    long written = 0;
+    for (int i = 0; i < states && written < transitions; i++) {
+        for (long k = 0; k < perState && written < transitions; k++, written++) {
+            long target = (i + k) % states;
+            file << "\tS" << i << "-[";
+            switch (k % 4) {
+                case 0: file << "got " << char('a' + k % 4) << " from left"; break;
+                case 1: file << "got b from right; timeout " << 100 + k; break;
+                case 2: file << "count != " << k; break;
+                default: file << "timeout " << 1000 + k; break;
+            }
+            file << "]->S" << target << "\n";
+        }
+    }
+    file << "Thanks\n";
+}
+
+int main(int argc, char* argv[]) {
+    long transitions = 1000000;
+    int states = 1000;
+    int runs = 3;
+    std::string path = "build/loader_bench.fsm";
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "-t" && i + 1 < argc) {
+            transitions = std::stol(argv[++i]);
+        } else if (arg == "-s" && i + 1 < argc) {
+            states = std::stoi(argv[++i]);
+        } else if (arg == "-r" && i + 1 < argc) {
+            runs = std::stoi(argv[++i]);
+        } else if (arg == "-o" && i + 1 < argc) {
+            path = argv[++i];
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [-t transitions] [-s states] [-r runs] [-o file]" << std::endl;
+            return 1;
+        }
+    }
+    if (states <= 0 || transitions / states > states) {
+        std::cerr << "Needs at least sqrt(transitions) states, transitions are unique per state pair" << std::endl;
+        return 1;
+    }
+
+    try {
+        writeMachine(path, states, transitions);
+        std::ifstream sizeCheck(path, std::ios::binary | std::ios::ate);
+        double megabytes = static_cast<double>(sizeCheck.tellg()) / (1024 * 1024);
+
+        size_t loaded = 0;
+        double best = timeLoad(runs, loaded, [&] { return MachineFileHandler::loadFromFile(path); });
+
+        std::string snapshotPath = path + ".snap";
+        if (!MachineSnapshot::saveToFile(MachineFileHandler::loadFromFile(path), snapshotPath)) {
+            throw std::runtime_error("Cannot write " + snapshotPath);
+        }
+        std::ifstream snapshotSizeCheck(snapshotPath, std::ios::binary | std::ios::ate);
+        double snapshotMegabytes = static_cast<double>(snapshotSizeCheck.tellg()) / (1024 * 1024);
+        size_t snapshotLoaded = 0;
+        double snapshotBest = timeLoad(runs, snapshotLoaded, [&] { return MachineSnapshot::loadFromFile(snapshotPath); });
+
+        // Runtimes can use the mapped snapshot in place instead of building a MooreMachine
+        auto viewStart = std::chrono::steady_clock::now();
+        SnapshotView view(snapshotPath);
+        size_t conditions = 0;
+        for (const SnapshotFormat::StateRecord& state : view.getStates()) {
+            for (const SnapshotFormat::TransitionRecord& transition : view.getTransitions(state)) {
+                conditions += view.getConditions(transition).size();
+            }
+        }
+        std::chrono::duration<double> viewSeconds = std::chrono::steady_clock::now() - viewStart;
+
+        std::cout << std::fixed << std::setprecision(1)
+                  << "file         " << megabytes << " MB, " << states << " states, " << transitions << " transitions\n"
+                  << "load         " << best * 1000 << " ms (best of " << runs << ")\n"
+                  << "throughput   " << megabytes / best << " MB/s, " << std::setprecision(0)
+                  << loaded / best << " transitions/s\n" << std::setprecision(1)
+                  << "snapshot     " << snapshotMegabytes << " MB, loaded in " << snapshotBest * 1000 << " ms, "
+                  << std::setprecision(0) << snapshotLoaded / snapshotBest << " transitions/s\n" << std::setprecision(1)
+                  << "mapped       " << view.getTransitions().size() << " transitions with " << conditions
+                  << " conditions walked in " << viewSeconds.count() * 1000 << " ms" << std::endl;
+
+        std::remove(snapshotPath.c_str());
+        std::remove(path.c_str());
+        if (loaded != static_cast<size_t>(transitions) || snapshotLoaded != loaded) {
+            std::cerr << "Loaded " << loaded << " and " << snapshotLoaded << " of " << transitions << " transitions" << std::endl;
+            return 1;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,151 @@
+// xbohach00
+// Builds a machine with many transitions through the MooreMachine API and reports
+// the memory it takes and the cost of looking states and transitions up
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdlib>
+#include <cstddef>
+#include <new>
+#include <random>
+
+#include "../../src/headers/moore_machine.h"
+
+// Every allocation carries its size in front of it, so live bytes can be counted
+static std::size_t liveBytes = 0;
+static constexpr std::size_t SIZE_PREFIX = alignof(std::max_align_t);
+
+void* operator new(std::size_t size) {
+    char* memory = static_cast<char*>(std::malloc(size + SIZE_PREFIX));
+    if (!memory) {
+        throw std::bad_alloc();
+    }
+    *reinterpret_cast<std::size_t*>(memory) = size;
+    liveBytes += size;
+    return memory + SIZE_PREFIX;
+}
+
+void operator delete(void* memory) noexcept {
+    if (memory) {
+        char* start = static_cast<char*>(memory) - SIZE_PREFIX;
+        liveBytes -= *reinterpret_cast<std::size_t*>(start);
+        std::free(start);
+    }
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+    operator delete(memory);
+}
+
+// Runs a lookup count times and returns nanoseconds per call
+template <typename Lookup>
+static double timePerCall(long count, Lookup lookup) {
+    auto start = std::chrono::steady_clock::now();
+    for (long i = 0; i < count; i++) {
+        lookup(i);
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / count;
+}
+
+int main(int argc, char* argv[]) {
+    long transitions = 1000000;
+    int states = 1000;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "-t" && i + 1 < argc) {
+            transitions = std::stol(argv[++i]);
+        } else if (arg == "-s" && i + 1 < argc) {
+            states = std::stoi(argv[++i]);
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [-t transitions] [-s states]" << std::endl;
+            return 1;
+        }
+    }
+    if (states <= 0 || transitions / states > states) {
+        std::cerr << "Needs at least sqrt(transitions) states, transitions are unique per state pair" << std::endl;
+        return 1;
+    }
+
+    std::size_t before = liveBytes;
+    auto buildStart = std::chrono::steady_clock::now();
+    MooreMachine machine("Synthetic");
+    for (int i = 0; i < states; i++) {
+        State state("S" + std::to_string(i), "S" + std::to_string(i));
+        state.addOutput(OutputCondition(i % 2 ? "on" : "off", "lamp"));
+        machine.addState(state);
+    }
+    machine.setInitialState("S0");
+    // Pointers taken before the machine grows must stay valid
+    State* firstState = machine.getState("S0");
+    Transition* firstTransition = nullptr;
+
+    long perState = transitions / states;
+    std::vector<std::string> transitionIds;
+    transitionIds.reserve(transitions);
+    for (int i = 0; i < states && static_cast<long>(transitionIds.size()) < transitions; i++) {
+        for (long k = 0; k < perState && static_cast<long>(transitionIds.size()) < transitions; k++) {
+            std::string source = "S" + std::to_string(i);
+            std::string target = "S" + std::to_string((i + k) % states);
+            std::string id = source + "->" + target;
+            machine.addTransition(Transition(id, source, target,
+                                             std::vector<InputCondition>{InputCondition(k % 2 ? "a" : "b", "left")},
+                                             k % 3 ? 0 : 100));
+            transitionIds.push_back(id);
+            firstTransition = firstTransition ? firstTransition : machine.getTransition(id);
+        }
+    }
+    std::chrono::duration<double> buildSeconds = std::chrono::steady_clock::now() - buildStart;
+    bool stable = firstState == machine.getState("S0") && firstTransition == machine.getTransition(transitionIds[0]);
+    std::size_t machineBytes = liveBytes - before;
+
+    std::vector<std::string> stateIds;
+    for (int i = 0; i < states; i++) {
+        stateIds.push_back("S" + std::to_string(i));
+    }
+    std::mt19937 random(42);
+    std::vector<int> stateOrder(1 << 16);
+    std::vector<long> transitionOrder(1 << 16);
+    for (size_t i = 0; i < stateOrder.size(); i++) {
+        stateOrder[i] = static_cast<int>(random() % states);
+        transitionOrder[i] = static_cast<long>(random() % transitionIds.size());
+    }
+    const size_t mask = stateOrder.size() - 1;
+
+    size_t sink = 0;
+    double getState = timePerCall(1000000, [&](long i) {
+        sink += machine.getState(stateIds[stateOrder[i & mask]]) != nullptr;
+    });
+    double getStateByName = timePerCall(20000, [&](long i) {
+        sink += machine.getStateByName(stateIds[stateOrder[i & mask]]) != nullptr;
+    });
+    double getTransition = timePerCall(1000000, [&](long i) {
+        sink += machine.getTransition(transitionIds[transitionOrder[i & mask]]) != nullptr;
+    });
+    machine.getOutgoingTransitions(stateIds[0]);
+    double getOutgoing = timePerCall(100000, [&](long i) {
+        sink += machine.getOutgoingTransitions(stateIds[stateOrder[i & mask]]).size();
+    });
+    double getFrom = timePerCall(10000, [&](long i) {
+        sink += machine.getTransitionsFromState(stateIds[stateOrder[i & mask]]).size();
+    });
+    double getTo = timePerCall(50, [&](long i) {
+        sink += machine.getTransitionsToState(stateIds[stateOrder[i & mask]]).size();
+    });
+
+    std::cout << std::fixed << std::setprecision(1)
+              << "machine                  " << states << " states, " << transitionIds.size() << " transitions\n"
+              << "build                    " << buildSeconds.count() * 1000 << " ms\n"
+              << "pointers                 " << (stable ? "stable" : "MOVED") << "\n"
+              << "memory                   " << machineBytes / (1024.0 * 1024.0) << " MB, "
+              << static_cast<double>(machineBytes) / transitionIds.size() << " bytes per transition\n"
+              << "getState                 " << getState << " ns\n"
+              << "getStateByName           " << getStateByName << " ns\n"
+              << "getTransition            " << getTransition << " ns\n"
+              << "getOutgoingTransitions   " << getOutgoing << " ns\n"
+              << "getTransitionsFromState  " << getFrom << " ns\n"
+              << "getTransitionsToState    " << getTo << " ns\n";
+    return sink == 0 || !stable;
+}
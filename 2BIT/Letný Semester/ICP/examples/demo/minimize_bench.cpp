@@ -0,0 +1,216 @@
+// xbohach00
+// Minimizes the example machines and a generated machine full of redundant states,
+// checks the minimized machines answer random inputs the same way, also with inputs latched
+// on several pointers at once, and reports the time
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <utility>
+
+#include "../../src/headers/machine_file_handler.h"
+#include "../../src/headers/machine_minimizer.h"
+#include "../../src/headers/machine_simulator.h"
+#include "../../src/headers/moore_machine.h"
+
+// Feeds the same random inputs to both machines and compares their outputs
+static bool sameAnswers(MooreMachine& original, MooreMachine& minimized, int steps) {
+    std::vector<std::pair<std::string, std::string>> inputs;
+    for (State* state : original.getAllStates()) {
+        for (Transition* transition : original.getTransitionsFromState(state->getId())) {
+            for (const InputCondition& input : transition->getInputConditions()) {
+                if (!input.isBooleanExpr) {
+                    inputs.push_back({input.value, input.source});
+                }
+            }
+        }
+    }
+    if (inputs.empty()) {
+        return true;
+    }
+
+    std::mt19937 random(7);
+    original.reset();
+    minimized.reset();
+    for (int step = 0; step < steps; step++) {
+        const auto& input = inputs[random() % inputs.size()];
+        if (original.processInputOnPointer(input.first, input.second) !=
+            minimized.processInputOnPointer(input.first, input.second)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Outputs of a simulator in a fixed order
+static std::vector<std::pair<std::string, std::string>> sortedOutputs(const MachineSimulator& simulator) {
+    std::vector<std::pair<std::string, std::string>> outputs = simulator.getAllOutputs();
+    std::sort(outputs.begin(), outputs.end());
+    return outputs;
+}
+
+// Latches the same inputs on both machines, a few pointers at a time, and compares the outputs after
+// every step, a firing transition clears the inputs of all its pointers
+static bool sameLatchedAnswers(MooreMachine& original, MooreMachine& minimized,
+                               const std::vector<std::vector<std::pair<std::string, std::string>>>& rounds) {
+    MachineSimulator left(&original);
+    MachineSimulator right(&minimized);
+    left.reset();
+    right.reset();
+    for (const auto& round : rounds) {
+        for (const auto& input : round) {
+            left.setInput(input.second, input.first);
+            right.setInput(input.second, input.first);
+        }
+        for (size_t step = 0; step <= round.size(); step++) {
+            left.processInputs();
+            right.processInputs();
+            if (sortedOutputs(left) != sortedOutputs(right)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Random rounds of latched inputs read by the transitions of a machine
+static std::vector<std::vector<std::pair<std::string, std::string>>> latchedRounds(MooreMachine& machine, int count) {
+    std::vector<std::pair<std::string, std::string>> inputs;
+    for (State* state : machine.getAllStates()) {
+        for (Transition* transition : machine.getTransitionsFromState(state->getId())) {
+            for (const InputCondition& input : transition->getInputConditions()) {
+                if (!input.isBooleanExpr) {
+                    inputs.push_back({input.value, input.source});
+                }
+            }
+        }
+    }
+    std::vector<std::vector<std::pair<std::string, std::string>>> rounds(inputs.empty() ? 0 : count);
+    std::mt19937 random(11);
+    for (auto& round : rounds) {
+        for (size_t i = random() % 3 + 1; i > 0; i--) {
+            round.push_back(inputs[random() % inputs.size()]);
+        }
+    }
+    return rounds;
+}
+
+// Two states with the same output are entered on inputs of different pointers, both latched at once.
+// Merging them must not merge the transitions entering them, a merged transition would clear both inputs
+static bool checkLatchedPointers() {
+    MooreMachine machine("Latched");
+    for (const char* id : {"S", "X1", "X2", "Y"}) {
+        State state(id, id);
+        state.addOutput(OutputCondition(id[0] == 'X' ? "x" : id, "out"));
+        machine.addState(state);
+    }
+    machine.setInitialState("S");
+    auto add = [&](const std::string& source, const std::string& target, const std::string& value,
+                   const std::string& pointer) {
+        machine.addTransition(Transition(source + "->" + target, source, target,
+                                         std::vector<InputCondition>{InputCondition(value, pointer)}, 0));
+    };
+    add("S", "X1", "a", "p1");
+    add("S", "X2", "b", "p2");
+    add("X1", "Y", "b", "p2");
+    add("X2", "Y", "b", "p2");
+
+    MinimizationResult result = machine.minimize();
+    bool same = sameLatchedAnswers(machine, result.machine, {{{"a", "p1"}, {"b", "p2"}}});
+    std::cout << "latched      " << result.removedStates << " removed, "
+              << (same ? "same answers" : "ANSWERS DIFFER") << "\n";
+    return same && result.removedStates == 1;
+}
+
+int main(int argc, char* argv[]) {
+    int states = 100000;
+    int period = 8;
+    std::vector<std::string> files;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "-s" && i + 1 < argc) {
+            states = std::stoi(argv[++i]);
+        } else if (arg == "-p" && i + 1 < argc) {
+            period = std::stoi(argv[++i]);
+        } else {
+            files.push_back(arg);
+        }
+    }
+    if (period <= 0 || states < period || states % period != 0) {
+        std::cerr << "Usage: " << argv[0] << " [fsm_file]... [-s states] [-p period dividing states]"
+                  << std::endl;
+        return 1;
+    }
+
+    bool ok = true;
+    for (const std::string& filename : files) {
+        try {
+            MooreMachine machine = MachineFileHandler::loadFromFile(filename);
+            MinimizationResult result = machine.minimize();
+            bool same = sameAnswers(machine, result.machine, 10000) &&
+                        sameLatchedAnswers(machine, result.machine, latchedRounds(machine, 1000));
+            ok = ok && same;
+            std::cout << filename << ": " << machine.getAllStates().size() << " states, "
+                      << result.removedStates << " removed" << (same ? "" : ", ANSWERS DIFFER") << "\n";
+            for (const auto& merged : result.mergedInto) {
+                std::cout << "  " << merged.first << " merged into " << merged.second << "\n";
+            }
+        } catch (const std::exception& e) {
+            std::cerr << filename << ": " << e.what() << std::endl;
+            return 1;
+        }
+    }
+
+    ok = checkLatchedPointers() && ok;
+
+    // A ring counting ticks that outputs the count modulo the period and goes back to the start
+    // on reset, all states a period apart are equivalent
+    MooreMachine machine("Ring");
+    machine.reserveTransitions(static_cast<size_t>(states) * 2);
+    for (int i = 0; i < states; i++) {
+        State state("S" + std::to_string(i), "S" + std::to_string(i));
+        state.addOutput(OutputCondition(std::to_string(i % period), "count"));
+        state.setPosition(Point(i * 10.0, 0));
+        machine.addState(state);
+    }
+    machine.setInitialState("S0");
+    for (int i = 0; i < states; i++) {
+        std::string source = "S" + std::to_string(i);
+        std::string next = "S" + std::to_string((i + 1) % states);
+        std::vector<InputCondition> tick{InputCondition("tick", "clock")};
+
+        // The last state ticks back to the start, one transition carries both inputs
+        if (i == states - 1) {
+            tick.push_back(InputCondition("reset", "clock"));
+        } else if (i != 0) {
+            machine.addTransition(Transition(source + "->S0", source, "S0",
+                                             std::vector<InputCondition>{InputCondition("reset", "clock")}, 0));
+        }
+        machine.addTransition(Transition(source + "->" + next, source, next, tick, 0));
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    MinimizationResult result = machine.minimize();
+    std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - start;
+
+    bool positionsKept = true;
+    for (State* state : result.machine.getAllStates()) {
+        State* before = machine.getState(state->getId());
+        positionsKept = positionsKept && before && before->getPosition().x == state->getPosition().x;
+    }
+    bool same = sameAnswers(machine, result.machine, 100000);
+    size_t expected = static_cast<size_t>(states - period);
+    ok = ok && same && positionsKept && result.removedStates == expected &&
+         result.machine.getValidationErrors().empty();
+
+    std::cout << std::fixed << std::setprecision(1)
+              << "machine      " << states << " states, period " << period << "\n"
+              << "removed      " << result.removedStates << " (expected " << expected << ")\n"
+              << "left         " << result.machine.getAllStates().size() << " states\n"
+              << "minimize     " << seconds.count() * 1000 << " ms\n"
+              << (ok ? "minimization ok" : "MINIMIZATION FAILED") << std::endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,161 @@
+// xbohach00
+// Records a machine running over an input trace into a binary trace, once from the start and once
+// joining halfway, replays both, checks they reproduce and that a tampered trace does not
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <filesystem>
+#include <memory>
+
+#include "../../src/headers/batch_simulator.h"
+#include "../../src/headers/machine_file_handler.h"
+#include "../../src/headers/machine_trace.h"
+#include "../../src/headers/moore_machine.h"
+#include "../../src/headers/trace_replayer.h"
+
+using namespace std::chrono;
+
+// Copies a trace, replacing the value of its n-th output record
+static void tamper(const std::string& from, const std::string& to, size_t output) {
+    const steady_clock::time_point epoch;
+    TraceReader reader(from);
+    TraceWriter writer(to);
+    TraceRecord record;
+    size_t outputs = 0;
+    while (reader.next(record)) {
+        steady_clock::time_point at = epoch + microseconds(record.time);
+        switch (record.type) {
+            case TraceFormat::RESET:
+                writer.recordReset(at);
+                break;
+            case TraceFormat::INPUT:
+                writer.recordInput(at, record.name, record.value);
+                break;
+            case TraceFormat::STATE:
+                writer.recordState(at, record.name);
+                break;
+            case TraceFormat::OUTPUT:
+                writer.recordOutput(at, record.name, outputs++ == output ? "tampered" : record.value);
+                break;
+            case TraceFormat::VARIABLE:
+                writer.recordVariable(at, record.name, record.value);
+                break;
+            case TraceFormat::SYNC:
+                throw std::runtime_error("Sync records are not copied");
+        }
+    }
+}
+
+static void report(const std::string& name, const ReplayResult& result) {
+    std::cout << name << ": " << std::fixed << std::setprecision(1) << result.seconds * 1000 << " ms for "
+              << result.traceMicros / 1e6 << " s of machine time\n";
+    for (const std::string& line : TraceReplayer::describe(result)) {
+        std::cout << "  " << line << "\n";
+    }
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " <fsm_file> <input_trace> [-r repeats] [-o output_dir]" << std::endl;
+        return 1;
+    }
+
+    int repeats = 1;
+    std::string outputDir = ".";
+    for (int i = 3; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "-r" && i + 1 < argc) {
+            repeats = std::stoi(argv[++i]);
+        } else if (arg == "-o" && i + 1 < argc) {
+            outputDir = argv[++i];
+        }
+    }
+
+    try {
+        MooreMachine original = MachineFileHandler::loadFromFile(argv[1]);
+        InputTrace inputs = BatchSimulator::loadTrace(argv[2]);
+        if (inputs.events.empty()) {
+            throw std::runtime_error("The input trace has no events");
+        }
+        std::string fullPath = outputDir + "/replay_full.fsmtrace";
+        std::string joinedPath = outputDir + "/replay_joined.fsmtrace";
+        std::string tamperedPath = outputDir + "/replay_tampered.fsmtrace";
+
+        // Run the inputs over and over, each round ten seconds after the previous one ended
+        MooreMachine machine = original;
+        VirtualClock clock;
+        machine.setClock(&clock);
+        MachineSimulator simulator(&machine);
+        const steady_clock::time_point epoch;
+        long long round = inputs.events.back().time + 10000;
+
+        size_t events = 0;
+        {
+            TraceWriter full(fullPath);
+            std::unique_ptr<TraceWriter> joined;
+            full.recordReset(clock.now());
+            full.recordChanges(clock.now(), simulator, machine);
+
+            auto recordChanges = [&]() {
+                full.recordChanges(clock.now(), simulator, machine);
+                if (joined) {
+                    joined->recordChanges(clock.now(), simulator, machine);
+                }
+            };
+
+            for (int r = 0; r < repeats; r++) {
+                for (const TraceEvent& event : inputs.events) {
+                    steady_clock::time_point at = epoch + milliseconds(r * round + event.time);
+                    while (simulator.advance(at)) {
+                        recordChanges();
+                    }
+                    clock.sleepUntil(at);
+
+                    // The second recording joins a machine already running halfway through
+                    if (!joined && events == inputs.events.size() * repeats / 2) {
+                        joined = std::make_unique<TraceWriter>(joinedPath);
+                        joined->recordSync(clock.now(), simulator, machine);
+                    }
+
+                    full.recordInput(clock.now(), event.inputPtr, event.value);
+                    if (joined) {
+                        joined->recordInput(clock.now(), event.inputPtr, event.value);
+                    }
+                    simulator.setInput(event.inputPtr, event.value);
+                    simulator.processInputs(clock.now());
+                    recordChanges();
+                    events++;
+                }
+            }
+            while (simulator.advance(epoch + milliseconds(repeats * round))) {
+                recordChanges();
+            }
+            std::cout << fullPath << ": " << full.getRecordCount() << " records, " << events << " inputs\n";
+        }
+        uintmax_t bytes = std::filesystem::file_size(fullPath);
+
+        TraceReplayer replayer(original, 5);
+        ReplayResult full = replayer.replay(fullPath);
+        report("full trace", full);
+        std::cout << "  " << bytes << " bytes, " << std::setprecision(2) << double(bytes) / full.records
+                  << " bytes per record, " << std::setprecision(0) << full.records / full.seconds << " records/s\n";
+
+        ReplayResult joined = replayer.replay(joinedPath);
+        report("joined trace", joined);
+
+        tamper(fullPath, tamperedPath, 3);
+        ReplayResult tampered = replayer.replay(tamperedPath);
+        report("tampered trace", tampered);
+
+        bool ok = full.mismatchCount == 0 && full.compared > 0 && full.inputs == events &&
+                  joined.mismatchCount == 0 && joined.compared > 0 &&
+                  tampered.mismatchCount > 0 && tampered.mismatches[0].expected == "tampered";
+        std::cout << (ok ? "replay ok" : "REPLAY FAILED") << std::endl;
+        return ok ? 0 : 1;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,162 @@
+// xbohach00
+// Times the editor scene updates on a large synthetic machine. The scene model is updated the way
+// the editor updates its items, once fully for the first load and then per frame after small edits,
+// and checks the model matches the machine after every frame
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../../src/headers/moore_machine.h"
+#include "../../src/headers/scene_model.h"
+
+static double elapsedMs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Applies the changes like AutomatonEditor::updateVisualization, returns the number of items touched
+static size_t applyChanges(SceneModel& scene, MooreMachine& machine, const SceneChanges& changes) {
+    for (const std::string& transitionId : changes.removedTransitions) {
+        scene.removeTransition(transitionId);
+    }
+    for (const std::string& stateId : changes.removedStates) {
+        scene.removeState(stateId);
+    }
+    for (const std::string& stateId : changes.addedStates) {
+        scene.setState(stateId, SceneModel::describeState(*machine.getState(stateId)));
+    }
+    for (const std::string& stateId : changes.changedStates) {
+        scene.setState(stateId, SceneModel::describeState(*machine.getState(stateId)));
+    }
+    for (const std::string& transitionId : changes.addedTransitions) {
+        scene.setTransition(transitionId, SceneModel::describeTransition(*machine.getTransition(transitionId)));
+    }
+    for (const std::string& transitionId : changes.changedTransitions) {
+        scene.setTransition(transitionId, SceneModel::describeTransition(*machine.getTransition(transitionId)));
+    }
+    return changes.size();
+}
+
+// What the editor did before, every item drawn again
+static size_t rebuild(SceneModel& scene, MooreMachine& machine) {
+    scene.clear();
+    size_t items = 0;
+    for (State* state : machine.getAllStates()) {
+        scene.setState(state->getId(), SceneModel::describeState(*state));
+        items++;
+    }
+    for (State* state : machine.getAllStates()) {
+        for (Transition* transition : machine.getTransitionsFromState(state->getId())) {
+            scene.setTransition(transition->getId(), SceneModel::describeTransition(*transition));
+            items++;
+        }
+    }
+    return items;
+}
+
+int main(int argc, char* argv[]) {
+    int states = argc > 1 ? std::stoi(argv[1]) : 5000;
+    const int perState = 2;
+    const int frames = 500;
+    if (states < 2) {
+        std::cerr << "Usage: " << argv[0] << " [states], at least 2" << std::endl;
+        return 1;
+    }
+
+    MooreMachine machine("Synthetic");
+    for (int i = 0; i < states; i++) {
+        State state("S" + std::to_string(i), "S" + std::to_string(i));
+        state.addOutput(OutputCondition(i % 7 ? "on" : "final", "lamp"));
+        state.setPosition(Point((i % 100) * 120, (i / 100) * 120));
+        machine.addState(state);
+    }
+    machine.setInitialState("S0");
+    for (int i = 0; i < states; i++) {
+        for (int k = 1; k <= perState; k++) {
+            std::string source = "S" + std::to_string(i);
+            std::string target = "S" + std::to_string((i + k) % states);
+            machine.addTransition(Transition(source + "->" + target, source, target,
+                                             std::vector<InputCondition>{InputCondition(k % 2 ? "a" : "b", "left")},
+                                             k == perState ? 2000 : 0));
+        }
+    }
+
+    // First load, every item is added
+    SceneModel scene;
+    auto start = std::chrono::steady_clock::now();
+    size_t loaded = applyChanges(scene, machine, scene.compare(machine));
+    double loadMs = elapsedMs(start);
+
+    // Update of an unchanged machine
+    start = std::chrono::steady_clock::now();
+    size_t unchanged = 0;
+    for (int i = 0; i < 20; i++) {
+        unchanged += scene.compare(machine).size();
+    }
+    double unchangedMs = elapsedMs(start) / 20;
+
+    // Frames after the edits the editor makes between two updates
+    std::mt19937 random(13);
+    std::vector<double> frameMs;
+    size_t touched = 0;
+    int mismatches = 0;
+    int extra = 0;
+    for (int frame = 0; frame < frames; frame++) {
+        std::string id = "S" + std::to_string(random() % states);
+        State* state = machine.getState(id);
+        switch (frame % 5) {
+            case 0:
+                state->setPosition(Point(state->getPosition().x + 15, state->getPosition().y - 5));
+                break;
+            case 1:
+                state->setName(state->getName() + "'");
+                break;
+            case 2: {
+                std::string target = "S" + std::to_string(random() % states);
+                machine.addTransition(Transition("X" + std::to_string(extra++), id, target,
+                                                 std::vector<InputCondition>{InputCondition("c", "left")}, 0));
+                break;
+            }
+            case 3:
+                if (extra > 0) {
+                    machine.removeTransition("X" + std::to_string(random() % extra));
+                }
+                break;
+            default:
+                machine.setInitialState(id);
+                break;
+        }
+
+        start = std::chrono::steady_clock::now();
+        touched += applyChanges(scene, machine, scene.compare(machine));
+        frameMs.push_back(elapsedMs(start));
+        mismatches += scene.compare(machine).size() != 0 ? 1 : 0;
+    }
+
+    // Baseline, the whole scene drawn again each frame
+    SceneModel rebuilt;
+    start = std::chrono::steady_clock::now();
+    size_t rebuiltItems = 0;
+    for (int i = 0; i < 20; i++) {
+        rebuiltItems = rebuild(rebuilt, machine);
+    }
+    double rebuildMs = elapsedMs(start) / 20;
+    mismatches += rebuilt.compare(machine).size() != 0 ? 1 : 0;
+
+    double averageMs = 0;
+    for (double ms : frameMs) {
+        averageMs += ms;
+    }
+    averageMs /= frameMs.size();
+    double maxMs = *std::max_element(frameMs.begin(), frameMs.end());
+
+    std::cout << states << " states, " << loaded - states << " transitions, first load of " << loaded << " items in "
+              << loadMs << " ms" << std::endl;
+    std::cout << "Unchanged machine: " << unchangedMs << " ms per update, " << unchanged << " items touched" << std::endl;
+    std::cout << frames << " edited frames: " << averageMs << " ms average, " << maxMs << " ms max, " << touched
+              << " items touched, " << mismatches << " mismatches" << std::endl;
+    std::cout << "Full rebuild of " << rebuiltItems << " items: " << rebuildMs << " ms per frame" << std::endl;
+    return mismatches == 0 && unchanged == 0 ? 0 : 1;
+}
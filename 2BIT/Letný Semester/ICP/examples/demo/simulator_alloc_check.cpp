@@ -0,0 +1,86 @@
+// xbohach00
+// Counts heap allocations made by MachineSimulator::processInputs once a machine has settled
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdlib>
+#include <new>
+
+#include "../../src/headers/machine_file_handler.h"
+#include "../../src/headers/machine_simulator.h"
+#include "../../src/headers/moore_machine.h"
+
+static std::size_t allocations = 0;
+
+void* operator new(std::size_t size) {
+    allocations++;
+    void* memory = std::malloc(size ? size : 1);
+    if (!memory) {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <fsm_file> [input_ptr=value]... [-n ticks]" << std::endl;
+        return 1;
+    }
+
+    int ticks = 100000;
+    std::vector<std::pair<std::string, std::string>> inputs;
+    for (int i = 2; i < argc; i++) {
+        std::string arg = argv[i];
+        size_t equalsPos = arg.find('=');
+        if (arg == "-n" && i + 1 < argc) {
+            ticks = std::stoi(argv[++i]);
+        } else if (equalsPos != std::string::npos) {
+            inputs.emplace_back(arg.substr(0, equalsPos), arg.substr(equalsPos + 1));
+        }
+    }
+
+    try {
+        MooreMachine machine = MachineFileHandler::loadFromFile(argv[1]);
+        MachineSimulator simulator(&machine);
+
+        // Warm up: feed the inputs and let the machine reach a state it stays in
+        for (const auto& input : inputs) {
+            simulator.setInput(input.first, input.second);
+        }
+        for (int i = 0; i < 100; i++) {
+            simulator.processInputs();
+        }
+
+        std::string settledState = simulator.getCurrentState()->getId();
+        size_t before = allocations;
+        auto start = std::chrono::steady_clock::now();
+
+        for (int i = 0; i < ticks; i++) {
+            simulator.processInputs();
+        }
+
+        std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - start;
+        size_t made = allocations - before;
+
+        if (simulator.getCurrentState()->getId() != settledState) {
+            std::cerr << argv[1] << ": left state " << settledState << " while measuring, use fewer ticks" << std::endl;
+            return 1;
+        }
+
+        std::cout << argv[1] << ": state " << settledState << ", " << ticks << " ticks, "
+                  << made << " allocations, " << static_cast<long>(ticks / seconds.count()) << " ticks/s" << std::endl;
+        return made == 0 ? 0 : 1;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,191 @@
+// xbohach00
+// Saves machines as binary snapshots, loads them back and checks nothing was lost on the way
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstdio>
+
+#include "../../src/headers/machine_file_handler.h"
+#include "../../src/headers/machine_snapshot.h"
+#include "../../src/headers/moore_machine.h"
+#include "../../src/headers/expression_parser.h"
+
+static int mismatches = 0;
+
+static void expect(bool same, const std::string& what) {
+    if (!same) {
+        std::cerr << "  mismatch: " << what << std::endl;
+        mismatches++;
+    }
+}
+
+static bool sameProgram(const ExpressionProgram& a, const ExpressionProgram& b) {
+    if (a.size() != b.size() || a.getConstantCount() != b.getConstantCount() ||
+        a.getSlotCount() != b.getSlotCount() || a.getErrorCount() != b.getErrorCount()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); i++) {
+        const Instruction& x = a.getInstructions()[i];
+        const Instruction& y = b.getInstructions()[i];
+        if (x.op != y.op || x.kind != y.kind || x.operation != y.operation || x.index != y.index) {
+            return false;
+        }
+    }
+    for (int i = 0; i < static_cast<int>(a.getConstantCount()); i++) {
+        if (a.getConstant(i).getType() != b.getConstant(i).getType() ||
+            a.getConstant(i).getValue() != b.getConstant(i).getValue()) {
+            return false;
+        }
+    }
+    for (int i = 0; i < static_cast<int>(a.getSlotCount()); i++) {
+        if (a.getSlotName(i) != b.getSlotName(i)) {
+            return false;
+        }
+    }
+    for (int i = 0; i < static_cast<int>(a.getErrorCount()); i++) {
+        if (a.getError(i) != b.getError(i)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void compareStates(MooreMachine& original, MooreMachine& loaded) {
+    ExpressionParser parser;
+    expect(original.getAllStates().size() == loaded.getAllStates().size(), "number of states");
+    for (State* state : original.getAllStates()) {
+        const std::string& id = state->getId();
+        State* copy = loaded.getState(id);
+        if (!copy) {
+            expect(false, "state " + id + " missing");
+            continue;
+        }
+        expect(copy->getName() == state->getName(), "name of state " + id);
+        expect(copy->getIsInitial() == state->getIsInitial(), "initial flag of state " + id);
+        expect(copy->getPosition().x == state->getPosition().x &&
+               copy->getPosition().y == state->getPosition().y, "position of state " + id);
+
+        const auto& outputs = state->getOutputs();
+        const auto& copiedOutputs = copy->getOutputs();
+        std::vector<CompiledOutput>& compiled = loaded.getCompiledOutputs(id);
+        expect(outputs.size() == copiedOutputs.size() && outputs.size() == compiled.size(), "outputs of state " + id);
+        for (size_t i = 0; i < outputs.size() && i < copiedOutputs.size() && i < compiled.size(); i++) {
+            expect(outputs[i].value == copiedOutputs[i].value && outputs[i].target == copiedOutputs[i].target &&
+                   outputs[i].inputPtr == copiedOutputs[i].inputPtr &&
+                   outputs[i].hasCondition == copiedOutputs[i].hasCondition, "output " + outputs[i].value);
+
+            CompiledOutput expected = parser.compileOutput(outputs[i]);
+            expect(expected.action == compiled[i].action && expected.target == compiled[i].target &&
+                   expected.source == compiled[i].source && expected.hasCondition == compiled[i].hasCondition &&
+                   expected.conditionPtr == compiled[i].conditionPtr &&
+                   sameProgram(expected.program, compiled[i].program), "compiled output " + outputs[i].value);
+        }
+    }
+}
+
+static void compareTransitions(MooreMachine& original, MooreMachine& loaded) {
+    for (State* state : original.getAllStates()) {
+        std::vector<Transition*> transitions = original.getTransitionsFromState(state->getId());
+        expect(transitions.size() == loaded.getTransitionsFromState(state->getId()).size(),
+               "transitions from state " + state->getId());
+
+        for (Transition* transition : transitions) {
+            Transition* copy = loaded.getTransition(transition->getId());
+            if (!copy) {
+                expect(false, "transition " + transition->getId() + " missing");
+                continue;
+            }
+            expect(copy->getSourceId() == transition->getSourceId() && copy->getTargetId() == transition->getTargetId(),
+                   "states of transition " + transition->getId());
+            expect(copy->getTimeout() == transition->getTimeout(), "timeout of transition " + transition->getId());
+
+            const auto& conditions = transition->getInputConditions();
+            const auto& copiedConditions = copy->getInputConditions();
+            bool same = conditions.size() == copiedConditions.size();
+            for (size_t i = 0; same && i < conditions.size(); i++) {
+                same = conditions[i].value == copiedConditions[i].value &&
+                       conditions[i].source == copiedConditions[i].source &&
+                       conditions[i].isBooleanExpr == copiedConditions[i].isBooleanExpr &&
+                       conditions[i].leftOperand == copiedConditions[i].leftOperand &&
+                       conditions[i].operation == copiedConditions[i].operation &&
+                       conditions[i].rightOperand == copiedConditions[i].rightOperand;
+            }
+            expect(same, "conditions of transition " + transition->getId());
+        }
+    }
+}
+
+static void compareMachines(MooreMachine& original, MooreMachine& loaded) {
+    expect(original.getName() == loaded.getName(), "name");
+    expect(original.getInputAlphabet() == loaded.getInputAlphabet(), "input alphabet");
+    expect(original.getOutputAlphabet() == loaded.getOutputAlphabet(), "output alphabet");
+    expect(original.getInputPointers() == loaded.getInputPointers(), "input pointers");
+    expect(original.getOutputPointers() == loaded.getOutputPointers(), "output pointers");
+
+    expect(original.getVariablesView().size() == loaded.getVariablesView().size(), "number of variables");
+    for (const auto& variable : original.getVariablesView()) {
+        MachineVariable* copy = loaded.getVariable(variable.first);
+        expect(copy && copy->getType() == variable.second.getType() &&
+               copy->getValueString() == variable.second.getValueString(), "variable " + variable.first);
+    }
+
+    compareStates(original, loaded);
+    compareTransitions(original, loaded);
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <fsm_file>... [-o snapshot]" << std::endl;
+        return 1;
+    }
+
+    std::string path = "build/snapshot_check.snap";
+    std::vector<std::string> files;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "-o" && i + 1 < argc) {
+            path = argv[++i];
+        } else {
+            files.push_back(arg);
+        }
+    }
+
+    for (const std::string& filename : files) {
+        int before = mismatches;
+        try {
+            MooreMachine original = MachineFileHandler::loadFromFile(filename);
+
+            // Machine files do not keep positions, give the states some to check
+            int index = 0;
+            for (State* state : original.getAllStates()) {
+                state->setPosition(Point(index * 120.5, index * -40.25));
+                index++;
+            }
+
+            if (!MachineSnapshot::saveToFile(original, path)) {
+                std::cerr << filename << ": cannot write " << path << std::endl;
+                return 1;
+            }
+            std::ifstream sizeCheck(path, std::ios::binary | std::ios::ate);
+            long bytes = static_cast<long>(sizeCheck.tellg());
+
+            MooreMachine loaded = MachineSnapshot::loadFromFile(path);
+            compareMachines(original, loaded);
+
+            size_t transitions = 0;
+            for (State* state : loaded.getAllStates()) {
+                transitions += loaded.getTransitionsFromState(state->getId()).size();
+            }
+            std::cout << filename << ": " << loaded.getAllStates().size() << " states, " << transitions
+                      << " transitions, " << bytes << " bytes, "
+                      << (mismatches == before ? "round trip ok" : "ROUND TRIP FAILED") << std::endl;
+        } catch (const std::exception& e) {
+            std::cerr << filename << ": " << e.what() << std::endl;
+            mismatches++;
+        }
+    }
+
+    std::remove(path.c_str());
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,75 @@
+// xbohach00
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <chrono>
+
+#include "counter_bench_callback.h"
+#include "counter_bench_goto.h"
+#include "counter_bench_typed.h"
+
+// Ticks made after each input, the first one only settles the entered state
+static const int ticksPerRun = 8;
+
+// Runs the counter from its initial state to Done over and over, returns steps per second
+template <typename FSM, typename Prepare>
+static double measure(FSM& fsm, int runs, Prepare prepare, std::string& finalState) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < runs; i++) {
+        // Entering Counting increments count to the limit, so the run ends in Done
+        prepare(fsm);
+        fsm.reset();
+        fsm.processInput("start");
+        for (int tick = 0; tick < ticksPerRun; tick++) {
+            fsm.tick();
+        }
+    }
+    std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - start;
+    finalState = fsm.getCurrentStateName();
+    return static_cast<double>(runs) * (ticksPerRun + 1) / seconds.count();
+}
+
+// Prints one row of the results
+static void report(const std::string& style, double steps, double baseline, const std::string& finalState) {
+    std::cout << std::left << std::setw(12) << style << std::right << std::fixed << std::setprecision(0)
+              << std::setw(16) << steps << std::setprecision(2) << std::setw(9) << steps / baseline << "x"
+              << "  " << finalState << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    int runs = 200000;
+    if (argc == 3 && std::string(argv[1]) == "-n") {
+        runs = std::stoi(argv[2]);
+    } else if (argc != 1) {
+        std::cerr << "Usage: " << argv[0] << " [-n runs]" << std::endl;
+        return 1;
+    }
+
+    CounterCallback callback;
+    CounterGoto computedGoto;
+    CounterTyped typed;
+    std::string callbackState, gotoState, typedState;
+
+    double callbackSteps = measure(callback, runs, [](CounterCallback& fsm) {
+        fsm.setVariable("count", 4);
+    }, callbackState);
+    double gotoSteps = measure(computedGoto, runs, [](CounterGoto& fsm) {
+        fsm.setVariable("count", 4);
+    }, gotoState);
+    double typedSteps = measure(typed, runs, [](CounterTyped& fsm) {
+        fsm.variables.count = 4;
+    }, typedState);
+
+    std::cout << std::left << std::setw(12) << "style" << std::right << std::setw(16) << "steps/s"
+              << std::setw(10) << "speedup" << "  final state" << std::endl;
+    report("callback", callbackSteps, callbackSteps, callbackState);
+    report("goto", gotoSteps, callbackSteps, gotoState);
+    report("typed", typedSteps, callbackSteps, typedState);
+
+    // Every style has to end where the simulator would
+    if (callbackState != "Done" || gotoState != "Done" || typedState != "Done") {
+        std::cerr << "Styles disagree on the final state" << std::endl;
+        return 1;
+    }
+    return 0;
+}
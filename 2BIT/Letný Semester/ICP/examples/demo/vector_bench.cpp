@@ -0,0 +1,232 @@
+// xbohach00
+// Runs the same traces through a MachineSimulator per instance and through the vector simulator's lanes,
+// checks every instance ends with the same state, outputs, variables and step count, and compares the throughput
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <set>
+#include <stdexcept>
+
+#include "../../src/headers/batch_simulator.h"
+#include "../../src/headers/machine_clock.h"
+#include "../../src/headers/machine_file_handler.h"
+#include "../../src/headers/machine_simulator.h"
+#include "../../src/headers/moore_machine.h"
+#include "../../src/headers/vector_simulator.h"
+
+using namespace std::chrono;
+
+// What an instance ended with
+struct Final {
+    bool failed;
+    unsigned long long steps;
+    std::string state;
+    std::vector<std::string> values;
+};
+
+// Random inputs on every pointer, mostly symbols some condition waits for, sometimes unknown or empty text
+static InputTrace randomTrace(MooreMachine& machine, size_t count, unsigned seed) {
+    std::vector<std::string> inputs;
+    for (const std::string& input : machine.getInputPointers()) {
+        if (!input.empty()) {
+            inputs.push_back(input);
+        }
+    }
+    std::set<std::string> symbolSet = machine.getInputAlphabet();
+    int longest = 10;
+    for (State* state : machine.getAllStates()) {
+        for (Transition* transition : machine.getTransitionsFromState(state->getId())) {
+            longest = std::max(longest, transition->getTimeout());
+            for (const auto& condition : transition->getInputConditions()) {
+                if (!condition.isBooleanExpr) {
+                    symbolSet.insert(condition.value);
+                }
+            }
+        }
+    }
+    std::vector<std::string> symbols(symbolSet.begin(), symbolSet.end());
+    symbols.push_back("unknown");
+    symbols.push_back("7");
+    symbols.push_back("");
+
+    std::mt19937 random(seed);
+    InputTrace trace;
+    trace.name = "random " + std::to_string(seed);
+    long long time = 0;
+    for (size_t i = 0; i < count && !inputs.empty(); i++) {
+        // Some inputs arrive together, others after the longest timeout ran out
+        time += random() % 4 == 0 ? 0 : random() % (longest * 3 / 2);
+        trace.events.push_back(TraceEvent{time, inputs[random() % inputs.size()], symbols[random() % symbols.size()]});
+    }
+    return trace;
+}
+
+// The loop BatchSimulator runs each instance with, keeping what every instance ended with
+static std::vector<Final> runSimulator(const MooreMachine& original, const std::vector<InputTrace>& traces,
+                                       size_t instances, long long horizon, const std::vector<std::string>& names,
+                                       const std::vector<std::string>& variables, double& seconds) {
+    MooreMachine machine = original;
+    VirtualClock clock;
+    machine.setClock(&clock);
+    MachineSimulator simulator(&machine);
+    const steady_clock::time_point epoch;
+    std::vector<Final> finals(instances);
+
+    auto start = steady_clock::now();
+    for (size_t i = 0; i < instances; i++) {
+        const InputTrace& trace = traces[i % traces.size()];
+        Final& final = finals[i];
+        int stepsAtInstant = 0;
+        steady_clock::time_point instant = epoch;
+        auto afterStep = [&]() {
+            final.steps++;
+            if (clock.now() != instant) {
+                instant = clock.now();
+                stepsAtInstant = 0;
+            }
+            if (++stepsAtInstant > 10000) {
+                throw std::runtime_error("No progress");
+            }
+        };
+
+        try {
+            clock.set(epoch);
+            machine.resetVariables();
+            simulator.reset();
+            long long endTime = 0;
+            for (const TraceEvent& event : trace.events) {
+                steady_clock::time_point at = epoch + milliseconds(event.time);
+                while (simulator.advance(at)) {
+                    afterStep();
+                }
+                clock.sleepUntil(at);
+                simulator.setInput(event.inputPtr, event.value);
+                simulator.processInputs();
+                afterStep();
+                endTime = event.time;
+            }
+            while (simulator.advance(epoch + milliseconds(endTime + horizon))) {
+                afterStep();
+            }
+        } catch (const std::exception&) {
+            final.failed = true;
+            continue;
+        }
+
+        final.state = simulator.getCurrentState()->getId();
+        for (const std::string& name : names) {
+            final.values.push_back(simulator.getOutput(name));
+        }
+        for (const std::string& name : variables) {
+            final.values.push_back(machine.getVariable(name)->getValueString());
+        }
+    }
+    seconds = duration<double>(steady_clock::now() - start).count();
+    return finals;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <fsm_file> [trace_file]... [-n instances] [-r random_traces]"
+                  << " [-e events] [-t horizon_ms]" << std::endl;
+        return 1;
+    }
+
+    size_t instances = 10000;
+    size_t randomTraces = 0;
+    size_t events = 200;
+    long long horizon = 0;
+    std::vector<std::string> traceFiles;
+    for (int i = 2; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "-n" && i + 1 < argc) {
+            instances = std::stoul(argv[++i]);
+        } else if (arg == "-r" && i + 1 < argc) {
+            randomTraces = std::stoul(argv[++i]);
+        } else if (arg == "-e" && i + 1 < argc) {
+            events = std::stoul(argv[++i]);
+        } else if (arg == "-t" && i + 1 < argc) {
+            horizon = std::stoll(argv[++i]);
+        } else {
+            traceFiles.push_back(arg);
+        }
+    }
+
+    try {
+        MooreMachine machine = MachineFileHandler::loadFromFile(argv[1]);
+        std::vector<InputTrace> traces;
+        for (const std::string& file : traceFiles) {
+            traces.push_back(BatchSimulator::loadTrace(file));
+        }
+        for (size_t i = 0; i < randomTraces; i++) {
+            traces.push_back(randomTrace(machine, events, static_cast<unsigned>(i + 1)));
+        }
+
+        std::set<std::string> outputPointers = machine.getOutputPointers();
+        std::vector<std::string> outputs(outputPointers.begin(), outputPointers.end());
+        std::vector<std::string> variables;
+        for (const auto& variable : machine.getVariablesView()) {
+            variables.push_back(variable.first);
+        }
+
+        VectorSimulator vector(machine);
+        vector.setHorizon(horizon);
+        BatchStats stats = vector.run(traces, instances);
+
+        double simulatorSeconds = 0;
+        std::vector<Final> expected = runSimulator(machine, traces, instances, horizon, outputs, variables,
+                                                   simulatorSeconds);
+
+        // Every instance has to end exactly where its MachineSimulator did
+        size_t mismatches = 0;
+        unsigned long long steps = 0;
+        size_t failed = 0;
+        std::string first;
+        for (size_t i = 0; i < instances; i++) {
+            Final actual{vector.hasFailed(i), vector.getSteps(i), vector.getState(i), {}};
+            for (const std::string& name : outputs) {
+                actual.values.push_back(vector.getOutput(i, name));
+            }
+            for (const std::string& name : variables) {
+                actual.values.push_back(vector.getVariable(i, name));
+            }
+
+            const Final& reference = expected[i];
+            failed += reference.failed;
+            steps += reference.failed ? 0 : reference.steps;
+            bool same = actual.failed == reference.failed &&
+                        (reference.failed || (actual.steps == reference.steps && actual.state == reference.state &&
+                                              actual.values == reference.values));
+            if (!same && mismatches++ == 0) {
+                first = "instance " + std::to_string(i) + " (" + traces[i % traces.size()].name + ") ended in " +
+                        actual.state + " after " + std::to_string(actual.steps) + " steps, the simulator in " +
+                        reference.state + " after " + std::to_string(reference.steps);
+            }
+        }
+        if (stats.steps != steps || stats.failed != failed) {
+            mismatches++;
+            first = first.empty() ? "totals differ" : first;
+        }
+
+        std::cout << argv[1] << ": " << instances << " instances over " << traces.size() << " traces, "
+                  << stats.steps << " steps, " << stats.failed << " failed, " << mismatches
+                  << " mismatches with the simulator" << (mismatches ? ", first " + first : "") << "\n";
+        if (!stats.firstError.empty()) {
+            std::cout << "  first error: " << stats.firstError << "\n";
+        }
+        std::cout << std::fixed << std::setprecision(3)
+                  << "  simulator  " << std::setw(9) << simulatorSeconds << " s  " << std::setprecision(0)
+                  << std::setw(12) << steps / simulatorSeconds << " steps/s\n"
+                  << std::setprecision(3) << "  vector     " << std::setw(9) << stats.seconds << " s  "
+                  << std::setprecision(0) << std::setw(12) << stats.steps / stats.seconds << " steps/s  "
+                  << std::setprecision(1) << simulatorSeconds / stats.seconds << "x, " << vector.getKernelName()
+                  << " dispatch" << std::endl;
+        return mismatches ? 1 : 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -54,6 +54,8 @@ SOURCES += \
     src/state.cpp \
     src/transition.cpp \
     src/machine_file_handler.cpp \
+    src/machine_file_parser.cpp \
+    src/machine_snapshot.cpp \
     src/expression_parser.cpp \
     src/state_ellipse_item.cpp \
     src/dialogaddbooleantransition.cpp \
@@ -62,7 +64,25 @@ SOURCES += \
     src/dialogedittransition.cpp \
     src/includable_generator.cpp \
     src/comm_bridge.cpp \
-    src/machine_connector.cpp
+    src/machine_connector.cpp \
+    src/wire_protocol.cpp \
+    src/transition_table.cpp \
+    src/expression_program.cpp \
+    src/timer_queue.cpp \
+    src/batch_simulator.cpp \
+    src/machine_analyzer.cpp \
+    src/machine_minimizer.cpp \
+    src/machine_equivalence.cpp \
+    src/machine_trace.cpp \
+    src/trace_replayer.cpp \
+    src/machine_clock.cpp \
+    src/action_translator.cpp \
+    src/vector_simulator.cpp \
+    src/code_buffer.cpp \
+    src/code_export_job.cpp \
+    src/edit_journal.cpp \
+    src/spatial_grid.cpp \
+    src/scene_model.cpp
 
 HEADERS += \
     headers/mainwindow.h \
@@ -75,6 +95,10 @@ HEADERS += \
     headers/state.h \
     headers/transition.h \
     headers/machine_file_handler.h \
+    headers/machine_file_parser.h \
+    headers/machine_snapshot.h \
+    headers/handle_index.h \
+    headers/slot_pool.h \
     headers/expression_parser.h \
     headers/machine_variable.h \
     headers/point.h \
@@ -86,7 +110,25 @@ HEADERS += \
     headers/dialogedittransition.h \
     headers/includable_generator.h \
     headers/comm_bridge.h \
-    headers/machine_connector.h
+    headers/machine_connector.h \
+    headers/wire_protocol.h \
+    headers/transition_table.h \
+    headers/expression_program.h \
+    headers/timer_queue.h \
+    headers/batch_simulator.h \
+    headers/machine_analyzer.h \
+    headers/machine_minimizer.h \
+    headers/machine_equivalence.h \
+    headers/machine_trace.h \
+    headers/trace_replayer.h \
+    headers/machine_clock.h \
+    headers/action_translator.h \
+    headers/vector_simulator.h \
+    headers/code_buffer.h \
+    headers/code_export_job.h \
+    headers/edit_journal.h \
+    headers/spatial_grid.h \
+    headers/scene_model.h
 
 FORMS += \
     forms/mainwindow.ui \
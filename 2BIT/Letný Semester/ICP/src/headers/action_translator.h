@@ -0,0 +1,451 @@
+/**
+ * @file action_translator.h
+ * @brief Declaration of the ActionTranslator and TypedActionTranslator classes
+ * @author Hugo Bohácsek (xbohach00)
+ */
+
+#ifndef ACTION_TRANSLATOR_H
+#define ACTION_TRANSLATOR_H
+
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "moore_machine.h"
+#include "expression_parser.h"
+
+/**
+ * @class ActionTranslator
+ * @brief Translates guards and state outputs of a machine into C++ statements
+ *
+ * The code generators use it to emit straight-line code, so the generated
+ * programs never tokenize or match guards and output statements at run time.
+ * Statements are compiled by ExpressionParser and mean the same as they do
+ * in MachineSimulator.
+ *
+ * The emitted statements expect these names in scope:
+ * - variables: map from variable name to a value of the value type
+ * - inputs: map from input pointer name to std::string
+ * - elapsedMs(): milliseconds spent in the current state
+ * - setOutput(name, value): stores an output value
+ * - reportVariable(name): called after a variable changes, if enabled
+ * - the helper functions returned by helperFunctions()
+ */
+class ActionTranslator {
+private:
+    const MooreMachine& machine;         /**< Machine the statements come from */
+    std::string valueType;               /**< C++ type of variable values in the generated code */
+    bool reportVariables;                /**< Whether reportVariable is called after assignments */
+    std::set<std::string> inputPointers; /**< Declared input pointers */
+
+public:
+    /**
+     * @brief Constructor
+     *
+     * @param machine Machine the statements come from, must outlive the translator
+     * @param valueType C++ type holding variable values, a std::variant<int, float, std::string>
+     * @param reportVariables Whether reportVariable(name) is called after a variable changes
+     */
+    ActionTranslator(const MooreMachine& machine, const std::string& valueType, bool reportVariables);
+
+    /**
+     * @brief Quotes text as a C++ string literal
+     *
+     * @param text Text to quote
+     * @return The literal including the quotes
+     */
+    static std::string literal(const std::string& text);
+
+    /**
+     * @brief Gets the helper functions the emitted statements call
+     *
+     * @return Definitions of textView, variantToString, applyOperation, assignText and assignValue
+     */
+    std::string helperFunctions() const;
+
+    /**
+     * @brief Translates an expression
+     *
+     * @param program Compiled expression
+     * @param indent Indentation of the statements
+     * @return Statements storing the value in a local variable named result
+     */
+    std::string expression(const ExpressionProgram& program, const std::string& indent) const;
+
+    /**
+     * @brief Translates the conditions of a transition
+     *
+     * Like Transition::isTriggered, the guard holds when any condition does.
+     *
+     * @param transition Transition to translate
+     * @param indent Indentation of the statements
+     * @return Statements returning true from the enclosing function if a condition holds
+     */
+    std::string guard(const Transition& transition, const std::string& indent) const;
+
+    /**
+     * @brief Translates clearing the inputs a transition was taken on
+     *
+     * @param transition Transition to translate
+     * @param indent Indentation of the statements
+     * @return Statements clearing the inputs, empty if the transition uses none
+     */
+    std::string consumedInputs(const Transition& transition, const std::string& indent) const;
+
+    /**
+     * @brief Translates the output statements of a state
+     *
+     * @param state State to translate
+     * @param indent Indentation of the statements
+     * @return Statements executing the outputs in order
+     */
+    std::string outputs(const State& state, const std::string& indent) const;
+};
+
+/**
+ * @class TypedActionTranslator
+ * @brief Translates guards and state outputs into statements on typed struct fields
+ *
+ * Every variable keeps the type it is declared with, so the type of each
+ * intermediate value is known while generating. Expressions become plain
+ * int, float and std::string arithmetic and nothing is looked up by name.
+ * The results match ActionTranslator and MachineSimulator.
+ *
+ * The emitted statements expect these names in scope:
+ * - variables, inputs, outputs: structs with one field per variable,
+ *   input pointer and output pointer, named by the field accessors
+ * - elapsedMs(): milliseconds spent in the current state
+ * - the helper functions returned by helperFunctions()
+ */
+class TypedActionTranslator {
+private:
+    /**
+     * @struct Value
+     * @brief Intermediate value of a translated expression
+     */
+    struct Value {
+        std::string code;  /**< C++ expression or local variable holding the value */
+        VariableType type; /**< Static type of the value */
+    };
+
+    const MooreMachine& machine;                       /**< Machine the statements come from */
+    std::map<std::string, std::string> variableFields; /**< Field by variable name */
+    std::map<std::string, std::string> inputFields;    /**< Field by input pointer name */
+    std::map<std::string, std::string> outputFields;   /**< Field by output pointer name, including undeclared targets */
+
+    /**
+     * @brief Translates an operand of an instruction
+     *
+     * @param program Program the instruction belongs to
+     * @param instruction Instruction with the operand
+     * @param operand Translated operand
+     * @return False if the operand names an unknown variable
+     */
+    bool operand(const ExpressionProgram& program, const Instruction& instruction, Value& operand) const;
+
+    /**
+     * @brief Translates an expression into local variables named value0, value1, ...
+     *
+     * @param program Compiled expression
+     * @param indent Indentation of the statements
+     * @param ss Stream receiving the statements
+     * @param result Variable holding the value when the statements complete
+     * @return False if the statements always throw and result must not be used
+     */
+    bool expression(const ExpressionProgram& program, const std::string& indent, std::stringstream& ss, Value& result) const;
+
+    /**
+     * @brief Translates storing a value in a variable, converting it like MachineSimulator
+     *
+     * @param variable Name of the assigned variable
+     * @param value Value to store
+     * @return The assignment statement without indentation
+     */
+    std::string assignment(const std::string& variable, const Value& value) const;
+
+public:
+    /**
+     * @brief Constructor, names a field for every variable and pointer
+     *
+     * @param machine Machine the statements come from, must outlive the translator
+     */
+    explicit TypedActionTranslator(const MooreMachine& machine);
+
+    /**
+     * @brief Turns a name into a C++ identifier
+     *
+     * Characters that cannot appear in identifiers become underscores,
+     * keywords and names starting with a digit are decorated.
+     *
+     * @param name Name from the machine
+     * @return A valid identifier
+     */
+    static std::string identifier(const std::string& name);
+
+    /**
+     * @brief Gets the fields of the variables
+     *
+     * @return Field name by variable name
+     */
+    const std::map<std::string, std::string>& getVariableFields() const;
+
+    /**
+     * @brief Gets the fields of the input pointers
+     *
+     * @return Field name by input pointer name
+     */
+    const std::map<std::string, std::string>& getInputFields() const;
+
+    /**
+     * @brief Gets the fields of the output pointers
+     *
+     * @return Field name by output pointer name
+     */
+    const std::map<std::string, std::string>& getOutputFields() const;
+
+    /**
+     * @brief Gets the C++ declaration of a variable field with its initial value
+     *
+     * @param variable Name of the variable
+     * @return Declaration such as "int count = 0;"
+     */
+    std::string variableDeclaration(const std::string& variable) const;
+
+    /**
+     * @brief Gets the helper functions the emitted statements call
+     *
+     * @return Definitions of textView, textOf, parseInt and parseFloat
+     */
+    std::string helperFunctions() const;
+
+    /**
+     * @brief Translates the conditions of a transition
+     *
+     * @param transition Transition to translate
+     * @param indent Indentation of the statements
+     * @return Statements returning true from the enclosing function if a condition holds
+     */
+    std::string guard(const Transition& transition, const std::string& indent) const;
+
+    /**
+     * @brief Translates clearing the inputs a transition was taken on
+     *
+     * @param transition Transition to translate
+     * @param indent Indentation of the statements
+     * @return Statements clearing the inputs, empty if the transition uses none
+     */
+    std::string consumedInputs(const Transition& transition, const std::string& indent) const;
+
+    /**
+     * @brief Translates the output statements of a state
+     *
+     * @param state State to translate
+     * @param indent Indentation of the statements
+     * @return Statements executing the outputs in order
+     */
+    std::string outputs(const State& state, const std::string& indent) const;
+};
+
+/**
+ * @class CActionTranslator
+ * @brief Translates guards and state outputs into C99 statements on fixed-size fields
+ *
+ * Like TypedActionTranslator every variable keeps its declared type, but text
+ * lives in char arrays of PREFIX_TEXT_CAPACITY bytes and numbers are printed
+ * and parsed by helpers of the generated header, so the statements need no
+ * heap and no C library. Text longer than the capacity is truncated.
+ *
+ * Input pointers hold the index of the symbol waiting on them. A failing
+ * statement returns its message instead of throwing.
+ *
+ * The emitted statements expect these names in scope:
+ * - fsm: pointer to the generated machine struct
+ * - the helper functions returned by helperFunctions()
+ */
+class CActionTranslator {
+private:
+    /**
+     * @struct Value
+     * @brief Intermediate value of a translated expression
+     */
+    struct Value {
+        std::string code;  /**< C expression or local variable holding the value */
+        VariableType type; /**< Static type of the value */
+    };
+
+    const MooreMachine& machine;                       /**< Machine the statements come from */
+    std::string prefix;                                /**< Prefix of every generated name */
+    std::map<std::string, std::string> variableFields; /**< Field by variable name */
+    std::map<std::string, std::string> inputFields;    /**< Enumerator suffix by input pointer name */
+    std::map<std::string, std::string> outputFields;   /**< Enumerator suffix by output pointer name, including undeclared targets */
+    std::map<std::string, std::string> symbolFields;   /**< Enumerator suffix by input symbol */
+    bool inputText;                                    /**< Whether any statement reads an input pointer as text */
+    bool outputText;                                   /**< Whether any statement writes computed text to an output */
+
+    /**
+     * @brief Translates an operand of an instruction
+     *
+     * @param program Program the instruction belongs to
+     * @param instruction Instruction with the operand
+     * @param operand Translated operand
+     * @return False if the operand names an unknown variable
+     */
+    bool operand(const ExpressionProgram& program, const Instruction& instruction, Value& operand) const;
+
+    /**
+     * @brief Translates an expression into local variables named value0, value1, ...
+     *
+     * @param program Compiled expression
+     * @param indent Indentation of the statements
+     * @param ss Stream receiving the statements
+     * @param result Variable holding the value when the statements complete
+     * @return False if the statements always return an error and result must not be used
+     */
+    bool expression(const ExpressionProgram& program, const std::string& indent, std::stringstream& ss, Value& result) const;
+
+    /**
+     * @brief Translates storing a value in a text buffer
+     *
+     * @param target Buffer of PREFIX_TEXT_CAPACITY bytes
+     * @param value Value to print
+     * @return The statement without indentation
+     */
+    std::string storeText(const std::string& target, const Value& value) const;
+
+    /**
+     * @brief Translates storing a value in a variable, converting it like MachineSimulator
+     *
+     * @param variable Name of the assigned variable
+     * @param value Value to store
+     * @param indent Indentation of the statements
+     * @return The statements
+     */
+    std::string assignment(const std::string& variable, const Value& value, const std::string& indent) const;
+
+    /**
+     * @brief Translates the text of a value for a comparison
+     *
+     * @param value Value to print
+     * @param buffer Local buffer a number is printed to
+     * @param ss Stream receiving the statement printing a number
+     * @param indent Indentation of the statement
+     * @return Expression of type const char* holding the text
+     */
+    std::string textOf(const Value& value, const std::string& buffer, std::stringstream& ss, const std::string& indent) const;
+
+public:
+    /**
+     * @brief Constructor, names an enumerator or field for every variable, pointer and symbol
+     *
+     * @param machine Machine the statements come from, must outlive the translator
+     * @param prefix Prefix of every generated name, a valid C identifier
+     */
+    CActionTranslator(const MooreMachine& machine, const std::string& prefix);
+
+    /**
+     * @brief Turns a name into a C identifier
+     *
+     * @param name Name from the machine
+     * @return A valid identifier
+     */
+    static std::string identifier(const std::string& name);
+
+    /**
+     * @brief Gets the fields of the variables
+     *
+     * @return Field name by variable name
+     */
+    const std::map<std::string, std::string>& getVariableFields() const;
+
+    /**
+     * @brief Gets the enumerators of the input pointers
+     *
+     * @return Suffix of PREFIX_INPUT_ by input pointer name, in the order of their values
+     */
+    const std::map<std::string, std::string>& getInputFields() const;
+
+    /**
+     * @brief Gets the enumerators of the output pointers
+     *
+     * @return Suffix of PREFIX_OUTPUT_ by output pointer name, in the order of their values
+     */
+    const std::map<std::string, std::string>& getOutputFields() const;
+
+    /**
+     * @brief Gets the enumerators of the input symbols
+     *
+     * Symbols are the input alphabet and every value an input condition
+     * expects. They are numbered from 1 in the order of the map, 0 means
+     * no symbol waits and the last value stands for any other text.
+     *
+     * @return Suffix of PREFIX_SYMBOL_ by symbol
+     */
+    const std::map<std::string, std::string>& getSymbolFields() const;
+
+    /**
+     * @brief Checks whether any statement reads an input pointer as text
+     *
+     * @return True if the machine struct has to keep the text of the inputs
+     */
+    bool readsInputText() const;
+
+    /**
+     * @brief Checks whether any statement writes computed text to an output
+     *
+     * @return True if the machine struct needs buffers for output text
+     */
+    bool writesOutputText() const;
+
+    /**
+     * @brief Gets the C declaration of a variable field
+     *
+     * @param variable Name of the variable
+     * @return Declaration such as "int count;"
+     */
+    std::string variableDeclaration(const std::string& variable) const;
+
+    /**
+     * @brief Gets the statement storing the initial value of a variable
+     *
+     * @param variable Name of the variable
+     * @return Statement without indentation
+     */
+    std::string variableInitialization(const std::string& variable) const;
+
+    /**
+     * @brief Gets the helper functions the emitted statements call
+     *
+     * @return Definitions of the text, print and parse helpers, all static inline
+     */
+    std::string helperFunctions() const;
+
+    /**
+     * @brief Gets the constant outputs of a state
+     *
+     * @param state State to inspect
+     * @param outputs Receives the literal written to each output pointer, the last one wins
+     * @return True if every statement of the state writes a literal to an output, unconditionally
+     */
+    bool constantOutputs(const State& state, std::map<std::string, std::string>& outputs) const;
+
+    /**
+     * @brief Translates the conditions of a transition
+     *
+     * @param transition Transition to translate
+     * @param indent Indentation of the statements
+     * @return Statements returning true from the enclosing function if a condition holds
+     */
+    std::string guard(const Transition& transition, const std::string& indent) const;
+
+    /**
+     * @brief Translates the output statements of a state
+     *
+     * @param state State to translate
+     * @param indent Indentation of the statements
+     * @return Statements executing the outputs in order, returning the message of a failure
+     */
+    std::string outputs(const State& state, const std::string& indent) const;
+};
+
+#endif // ACTION_TRANSLATOR_H
@@ -17,11 +17,14 @@
 #include "state_ellipse_item.h"
 #include "fsm_bridge.h"
 #include "code_generator.h"
+#include "spatial_grid.h"
+#include "scene_model.h"
 #include <QMainWindow>
 #include <QGraphicsScene>
 #include <QGraphicsEllipseItem>
 #include <QGraphicsTextItem>
 #include <QGraphicsPathItem>
+#include <QGraphicsLineItem>
 #include <QString>
 #include <QPoint>
 #include <QMap>
@@ -29,11 +32,15 @@
 #include <QMessageBox>
 #include <QFileDialog>
 #include <QTimer>
+#include <QProgressDialog>
+#include <QRectF>
 
 namespace Ui {
 class AutomatonEditor;
 }
 
+struct TransitionItem;
+
 /**
  * @struct StateItem
  * @brief Stores the state with all its attributes and graphics
@@ -46,6 +53,9 @@ struct StateItem {
     QPoint position;                        /** Position of the state in the scene */
     state_ellipse_item* ellipse = nullptr;  /** Pointer to the ellipse item representing the state in the scene */
     QGraphicsTextItem* label = nullptr;     /** Pointer to the state name text item in the scene */
+    QGraphicsEllipseItem* finalMark = nullptr; /** Inner circle of a final state, child of the ellipse */
+    QGraphicsLineItem* startMark = nullptr; /** Line pointing to the initial state, child of the ellipse */
+    QVector<TransitionItem*> transitions;   /** Transitions leaving or entering the state, a loop is listed once */
 };
 
 /**
@@ -60,6 +70,7 @@ struct TransitionItem {
     bool isBoolean = false;                 /** Whether the transition uses boolean input condition */
     QGraphicsPathItem* pathItem = nullptr;  /** Pointer to the path item (line representing the transition) in the scene */
     QGraphicsTextItem* labelItem = nullptr; /** Pointer to the transition label in the scene */
+    bool deferred = false;                  /** Whether the path is hidden and out of date because it was off the view */
 };
 
 /**
@@ -111,6 +122,15 @@ public:
      */
     void createNewState(const QString& name, int x, int y, bool isStart, bool isFinal);
 
+protected:
+    /**
+     * @brief Watch the graphics view for resizes to update the visible area
+     * @param watched Object receiving the event
+     * @param event The event
+     * @return False, the event is always passed on
+     */
+    bool eventFilter(QObject* watched, QEvent* event) override;
+
 private slots:
 
     /**
@@ -235,11 +255,37 @@ private slots:
      */
     void on_actionGenGoto_triggered();
 
+    /**
+     * @brief Generate includable file in code style Typed
+     */
+    void on_actionGenTyped_triggered();
+
+    /**
+     * @brief Generate includable file in code style C tables
+     */
+    void on_actionGenC_triggered();
+
     /**
      * @brief Connect to a running automaton
      */
     void on_actionConnect_triggered();
 
+    /**
+     * @brief Start or stop recording a trace of the simulation or the connected automaton
+     * @param checked true to start recording, false to stop
+     */
+    void on_actionRecordTrace_triggered(bool checked);
+
+    /**
+     * @brief Revert the last edit of the automaton
+     */
+    void on_actionUndo_triggered();
+
+    /**
+     * @brief Make the last undone edit of the automaton again
+     */
+    void on_actionRedo_triggered();
+
 private:
     /**
      * @brief Pointer to the UI elements defined in the automatoneditor.ui file.
@@ -264,6 +310,21 @@ private:
      */
     QMap<QString, TransitionItem> transitions;
 
+    /**
+     * @brief What the scene shows, compared with the machine to update only what differs
+     */
+    SceneModel sceneModel;
+
+    /**
+     * @brief Grid of the states in the scene, finds the states coming into the view
+     */
+    SpatialGrid stateGrid;
+
+    /**
+     * @brief Part of the scene the view shows, with a margin around it
+     */
+    QRectF visibleArea;
+
     /**
      * @brief Bridge connecting the frontend with the backend
      */
@@ -289,6 +350,11 @@ private:
      */
     bool connectionActive;
 
+    /**
+     * @brief Code export in progress, nullptr if there is none
+     */
+    CodeExportJob* codeExport;
+
     /** 
      * @brief ID of the last highlighted state
      */
@@ -298,6 +364,11 @@ private:
      * @brief Map of last output values printed to the log
      */
     QMap<QString, QString> lastOutputs;
+
+    /**
+     * @brief ID of the state currently highlighted in the scene
+     */
+    QString highlightedState;
     
     /**
      * @brief Set up the core UI components (menu, graphic scene and simulation controls) for the AutomatonEditor window
@@ -336,8 +407,8 @@ private:
     void saveToFile(const QString& filePath);
 
     /**
-     * @brief Save the current automaton to the file
-     * @param filePath Destination for the file to save
+     * @brief Generate and compile the code of the current automaton in the background
+     * @param filePath Destination for the generated code without an extension
      */
     void saveCodeToFile(const QString& filePath);
 
@@ -347,10 +418,98 @@ private:
     void clearVisualization();
 
     /**
-     * @brief Update the whole graphic scene with new visualisation
+     * @brief Update the graphic scene to match the machine
+     *
+     * Only the states and transitions that were added, removed or changed touch the scene
      */
     void updateVisualization();
 
+    /**
+     * @brief Create the graphics of a state and add them to the scene
+     *
+     * @param stateId ID of the state in the machine
+     * @param name State name
+     * @param position Top left corner of the state in the scene
+     * @param isStart If the state is initial
+     * @param isFinal If the state is final
+     * @return The stored state item
+     */
+    StateItem& addStateItem(const QString& stateId, const QString& name, const QPoint& position, bool isStart, bool isFinal);
+
+    /**
+     * @brief Center the name of a state inside its ellipse
+     * @param state The state item
+     */
+    void placeStateLabel(StateItem& state);
+
+    /**
+     * @brief Show or hide the initial line and the final inner circle of a state
+     *
+     * @param state The state item
+     * @param isStart If the state is initial
+     * @param isFinal If the state is final
+     */
+    void setStateMarks(StateItem& state, bool isStart, bool isFinal);
+
+    /**
+     * @brief Record the name, position and marks of a state item in the scene model
+     * @param state The state item
+     */
+    void recordState(const StateItem& state);
+
+    /**
+     * @brief Remove the graphics of a state and of its transitions from the scene
+     * @param stateId ID of the state
+     */
+    void removeStateItem(const QString& stateId);
+
+    /**
+     * @brief Bring the scene and the lists in line with the elements an undone or redone edit touched
+     * @param command The edit
+     */
+    void showEdit(const EditCommand& command);
+
+    /**
+     * @brief Create the graphics of a transition and add them to the scene
+     *
+     * @param transitionId ID of the transition in the machine
+     * @param fromId ID of the source state, must have its item already
+     * @param toId ID of the target state, must have its item already
+     * @param inputValue Label with the input conditions
+     * @param isBoolean Whether the transition uses boolean input condition
+     */
+    void addTransitionItem(const QString& transitionId, const QString& fromId, const QString& toId, const QString& inputValue, bool isBoolean);
+
+    /**
+     * @brief Recompute the path and the label position of a transition from its states
+     * @param transition The transition item
+     */
+    void layoutTransition(TransitionItem& transition);
+
+    /**
+     * @brief Lay out a transition if it can be seen, otherwise hide it until one of its states comes into the view
+     * @param transition The transition item
+     */
+    void routeTransition(TransitionItem& transition);
+
+    /**
+     * @brief Recompute the visible area and lay out the hidden transitions of the states that came into it
+     */
+    void updateVisibleArea();
+
+    /**
+     * @brief Remove the graphics of a transition from the scene
+     * @param transitionId ID of the transition
+     */
+    void removeTransitionItem(const QString& transitionId);
+
+    /**
+     * @brief Change the label of a transition in the scene
+     * @param transition The transition item
+     * @param inputValue Label with the input conditions
+     */
+    void setTransitionLabel(TransitionItem& transition, const QString& inputValue);
+
     /**
      * @brief Highlight/unhighlight the given state in the simulation
      * @param stateId ID of the state to highlight/unhighlight
@@ -358,6 +517,12 @@ private:
      */
     void highlightState(const QString& stateId, bool highlight);
 
+    /**
+     * @brief Move the simulation highlight to the given state
+     * @param stateId ID of the current state, empty to remove the highlight
+     */
+    void showCurrentState(const QString& stateId);
+
     /**
      * @brief Set up the simulation control panel UI
      */
@@ -397,11 +562,16 @@ private:
     /**
      * @brief Execute one step of the simulation cycle
      * 
-     * Invoked periodically by the QTimer to evaluate timeout or process condition-based transitions,
+     * Invoked by the QTimer when the next timeout is due or a new state has to be evaluated,
      * update the visual state, and log output changes
      */
     void simulationStep();
 
+    /**
+     * @brief Start the simulation timer for the next step the simulation needs
+     */
+    void scheduleSimulationStep();
+
     /**
      * @brief Handle given input symbol on pointer during simulation
      */
@@ -410,8 +580,9 @@ private:
     /**
      * @brief Connect/disconnect to/from a running automaton
      * @param active true to start the connection, false to end it
+     * @param instance ID of the automaton instance to connect to
      */
-    void toggleConnection(bool active);
+    void toggleConnection(bool active, quint32 instance = 0);
 
     /**
      * @brief Refresh data from remote running automaton
@@ -0,0 +1,142 @@
+/**
+ * @file batch_simulator.h
+ * @brief Declaration of the BatchSimulator class
+ * @author Hugo Bohácsek (xbohach00)
+ */
+
+#ifndef BATCH_SIMULATOR_H
+#define BATCH_SIMULATOR_H
+
+#include <string>
+#include <vector>
+#include <ostream>
+#include "moore_machine.h"
+#include "machine_simulator.h"
+
+/**
+ * @struct TraceEvent
+ * @brief Input value arriving on an input pointer at a point of virtual time
+ */
+struct TraceEvent {
+    long long time;       /**< Virtual time in milliseconds since the instance started */
+    std::string inputPtr; /**< Input pointer the value arrives on */
+    std::string value;    /**< The input value */
+};
+
+/**
+ * @struct InputTrace
+ * @brief Sequence of inputs fed to a simulated instance
+ */
+struct InputTrace {
+    std::string name;               /**< Where the trace was loaded from */
+    std::vector<TraceEvent> events; /**< Events ordered by time */
+};
+
+/**
+ * @struct BatchStats
+ * @brief Results of a batch run
+ */
+struct BatchStats {
+    size_t instances;                            /**< Number of instances simulated */
+    size_t failed;                               /**< Number of instances stopped by an error */
+    unsigned long long steps;                    /**< Simulation steps over all instances */
+    double seconds;                              /**< Wall clock time of the run */
+    std::vector<unsigned long long> threadSteps; /**< Simulation steps made by each thread */
+    std::vector<double> threadSeconds;           /**< Wall clock time each thread was busy */
+    std::string firstError;                      /**< Message of the first failed instance */
+};
+
+/**
+ * @class BatchSimulator
+ * @brief Headless engine running many instances of one machine in parallel
+ *
+ * The machine is loaded and parsed once and never modified. Every worker
+ * thread copies it once and runs a MachineSimulator on the copy, resetting
+ * it between instances, so instances do not share any mutable state.
+ *
+ * Instances run on a VirtualClock: the simulator steps exactly when an input
+ * arrives or a timeout expires, so a trace spanning hours of machine time
+ * runs as fast as the steps can be computed.
+ *
+ * Trace files contain one event per line, "<time_ms> <input_ptr> <value>",
+ * ordered by time. Empty lines and lines starting with # are ignored.
+ * Output traces use the same layout with "state <id>" and
+ * "output <ptr> <value>" records, written whenever they change.
+ */
+class BatchSimulator {
+private:
+    const MooreMachine& machine; /**< The loaded machine, only ever copied */
+    int threadCount;             /**< Number of worker threads */
+    long long horizon;           /**< Virtual time simulated after the last event of a trace */
+    int maxStepsPerInstant;      /**< Steps without time advancing before an instance is stopped */
+    std::string outputDirectory; /**< Where output traces are written, empty for none */
+
+    /**
+     * @brief Runs one instance through a trace
+     *
+     * @param instanceMachine Machine copy owned by the calling thread
+     * @param simulator Simulator of instanceMachine
+     * @param clock Virtual clock of instanceMachine
+     * @param trace Inputs fed to the instance
+     * @param out Output trace stream, or nullptr to record nothing
+     * @return Number of simulation steps made
+     * @throw std::runtime_error If the simulation fails or stops making progress
+     */
+    unsigned long long runInstance(MooreMachine& instanceMachine, MachineSimulator& simulator,
+                                   VirtualClock& clock, const InputTrace& trace, std::ostream* out) const;
+
+public:
+    /**
+     * @brief Constructor
+     *
+     * @param machine The machine to simulate, must outlive the batch simulator
+     * @param threadCount Number of worker threads, 0 for one per hardware thread
+     */
+    BatchSimulator(const MooreMachine& machine, int threadCount = 0);
+
+    /**
+     * @brief Sets how long instances keep running after their last input
+     *
+     * @param milliseconds Virtual time in milliseconds
+     */
+    void setHorizon(long long milliseconds);
+
+    /**
+     * @brief Sets where output traces are written
+     *
+     * Instance i writes "<directory>/<i>.trace".
+     *
+     * @param directory Existing directory, or an empty string to record nothing
+     */
+    void setOutputDirectory(const std::string& directory);
+
+    /**
+     * @brief Gets the number of worker threads
+     *
+     * @return Number of threads a run uses at most
+     */
+    int getThreadCount() const;
+
+    /**
+     * @brief Loads an input trace from a file
+     *
+     * @param filename Path to the trace file
+     * @return The loaded trace
+     * @throw std::runtime_error If the file cannot be read or a line is malformed
+     */
+    static InputTrace loadTrace(const std::string& filename);
+
+    /**
+     * @brief Runs the given number of instances
+     *
+     * Instance i is fed traces[i % traces.size()].
+     *
+     * @param traces Input traces to feed
+     * @param instances Number of instances to run
+     * @return Statistics of the run
+     * @throw std::runtime_error If no traces are given or the machine cannot be simulated
+     */
+    BatchStats run(const std::vector<InputTrace>& traces, size_t instances) const;
+};
+
+#endif // BATCH_SIMULATOR_H
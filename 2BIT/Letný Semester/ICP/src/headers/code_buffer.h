@@ -0,0 +1,85 @@
+/**
+ * @file code_buffer.h
+ * @brief Declaration of the CodeBuffer class
+ * @author Hugo Bohácsek (xbohach00)
+ */
+
+#ifndef CODE_BUFFER_H
+#define CODE_BUFFER_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+/**
+ * @class CodeBuffer
+ * @brief Append-only text buffer the code generators write files into
+ *
+ * Unlike a std::stringstream it has no locale or formatting state, numbers are
+ * written with std::to_chars and clear() keeps the allocated memory, so one buffer
+ * can be reused for every file of an export.
+ */
+class CodeBuffer {
+private:
+    std::string text; /**< Text written so far */
+
+    /**
+     * @brief Appends a signed number
+     *
+     * @param number Number to write in decimal
+     */
+    void appendNumber(long long number);
+
+    /**
+     * @brief Appends an unsigned number
+     *
+     * @param number Number to write in decimal
+     */
+    void appendNumber(unsigned long long number);
+
+public:
+    /**
+     * @brief Constructor
+     *
+     * @param capacity Number of characters reserved up front
+     */
+    explicit CodeBuffer(size_t capacity = 64 * 1024);
+
+    CodeBuffer& operator<<(std::string_view part) { text.append(part); return *this; }
+    CodeBuffer& operator<<(char character) { text.push_back(character); return *this; }
+    CodeBuffer& operator<<(int number) { appendNumber(static_cast<long long>(number)); return *this; }
+    CodeBuffer& operator<<(long number) { appendNumber(static_cast<long long>(number)); return *this; }
+    CodeBuffer& operator<<(long long number) { appendNumber(number); return *this; }
+    CodeBuffer& operator<<(unsigned number) { appendNumber(static_cast<unsigned long long>(number)); return *this; }
+    CodeBuffer& operator<<(unsigned long number) { appendNumber(static_cast<unsigned long long>(number)); return *this; }
+    CodeBuffer& operator<<(unsigned long long number) { appendNumber(number); return *this; }
+
+    /**
+     * @brief Empties the buffer, keeping its memory for the next file
+     */
+    void clear() { text.clear(); }
+
+    /**
+     * @brief Gets the text written so far
+     *
+     * @return View of the text, valid until the buffer changes
+     */
+    std::string_view view() const { return text; }
+
+    /**
+     * @brief Gets the number of characters written so far
+     *
+     * @return Size of the text
+     */
+    size_t size() const { return text.size(); }
+
+    /**
+     * @brief Writes the text to a file, replacing it
+     *
+     * @param path Path of the file
+     * @throws std::runtime_error If the file cannot be written
+     */
+    void writeTo(const std::string& path) const;
+};
+
+#endif // CODE_BUFFER_H
@@ -0,0 +1,143 @@
+/**
+ * @file code_export_job.h
+ * @brief Declaration of the CodeExportJob class
+ * @author Hugo Bohácsek (xbohach00)
+ */
+
+#ifndef CODE_EXPORT_JOB_H
+#define CODE_EXPORT_JOB_H
+
+#include <QObject>
+#include <QProcess>
+#include <QQueue>
+#include <QString>
+#include <QStringList>
+#include <atomic>
+#include <functional>
+#include <thread>
+#include "code_generator.h"
+#include "moore_machine.h"
+
+/**
+ * @class CodeExportJob
+ * @brief Generates and compiles an executable Moore machine without blocking the GUI
+ *
+ * The code is generated on a worker thread from a copy of the machine. Every source
+ * is handed to a compiler process as soon as it is written, up to one process per
+ * core at a time, and the objects are linked once all of them are compiled.
+ * The signals are emitted on the thread the job belongs to.
+ */
+class CodeExportJob : public QObject {
+    Q_OBJECT
+
+public:
+    /**
+     * @brief Constructor
+     * @param machine Machine to export, it is copied so it can be edited meanwhile
+     * @param filePath Path for the generated code without an extension
+     * @param parent Parent QObject, used for memory management
+     */
+    CodeExportJob(const MooreMachine& machine, const QString& filePath, QObject* parent = nullptr);
+
+    /**
+     * @brief Destructor
+     *
+     * Stops the compilers and waits for the generation to stop
+     */
+    ~CodeExportJob();
+
+    /**
+     * @brief Starts generating the code
+     */
+    void start();
+
+    /**
+     * @brief Stops the export, finished is emitted with the job failed
+     */
+    void cancel();
+
+    /**
+     * @brief Checks whether the export is still going on
+     * @return True until finished is emitted
+     */
+    bool isRunning() const;
+
+signals:
+    /**
+     * @brief Signal emitted whenever a step of the export is done
+     * @param done Number of steps done
+     * @param total Number of steps, 0 while the code is still being generated
+     * @param message Description of the step
+     */
+    void progress(int done, int total, const QString& message);
+
+    /**
+     * @brief Signal emitted once, when the executable is built or the export fails
+     * @param success Whether the executable was built
+     * @param message Path of the executable, or why the export failed
+     */
+    void finished(bool success, const QString& message);
+
+private:
+    MooreMachine machine; /**< Copy of the exported machine, only used by the generator thread */
+    QString filePath; /**< Path for the generated code without an extension */
+    std::thread generator; /**< Thread generating the code */
+    std::atomic<bool> cancelled; /**< Set to make the generator thread stop */
+    GeneratedProgram program; /**< Files of the program, known once generation finished */
+    QQueue<QString> pending; /**< Sources written but not compiled yet */
+    QList<QProcess*> compilers; /**< Compiler processes running */
+    int maxCompilers; /**< Number of compiler processes run at once */
+    int written; /**< Number of sources written */
+    int compiled; /**< Number of sources compiled */
+    bool generated; /**< Whether all sources are written */
+    bool running; /**< Whether the export is still going on */
+
+    /**
+     * @brief Generates the code, runs on the generator thread
+     */
+    void generate();
+
+    /**
+     * @brief Queues a source written by the generator thread for compilation
+     * @param sourcePath Path of the source
+     */
+    void sourceWritten(const QString& sourcePath);
+
+    /**
+     * @brief Takes over the files once the generator thread is done
+     * @param generatedProgram Files of the program
+     * @param error Why the generation failed, empty if it succeeded
+     */
+    void generationFinished(const GeneratedProgram& generatedProgram, const QString& error);
+
+    /**
+     * @brief Starts compilers for the queued sources while there are free slots, links when all are compiled
+     */
+    void startCompilers();
+
+    /**
+     * @brief Starts the compiler process
+     * @param arguments Options and files of the compiler
+     * @param onSuccess Called when the compiler exits successfully
+     */
+    void runCompiler(const QStringList& arguments, const std::function<void()>& onSuccess);
+
+    /**
+     * @brief Links the compiled objects into the executable
+     */
+    void link();
+
+    /**
+     * @brief Stops the export and reports it failed
+     * @param message Why the export failed
+     */
+    void fail(const QString& message);
+
+    /**
+     * @brief Gets the total number of steps of the export
+     * @return Number of steps, 0 while the code is still being generated
+     */
+    int totalSteps() const;
+};
+
+#endif // CODE_EXPORT_JOB_H
@@ -7,41 +7,113 @@
 
 #include "moore_machine.h"
 #include "machine_file_handler.h"
-#include <fstream>
-#include <iostream>
-#include <sstream>
-#include <QProcess>
-#include <QDebug>
+#include "action_translator.h"
+#include "code_buffer.h"
+#include <functional>
+#include <string>
+#include <vector>
+
+/**
+ * @struct GeneratedProgram
+ * @brief Paths of the files a generated program consists of
+ */
+struct GeneratedProgram {
+    std::string header; /**< Header every source includes */
+    std::vector<std::string> sources; /**< Sources in the order they were written */
+    std::string executable; /**< Executable the sources link to */
+    std::string makefile; /**< Makefile building the executable */
+    std::string ninjaFile; /**< Ninja file building the executable */
+};
 
 /**
  * @class CodeGenerator
- * @brief Generates and compiles executable Moore machine
+ * @brief Generates executable Moore machine
  */
 class CodeGenarator{
 private:
     static std::string generatedFileHeader; /**< Static C++ header code for generated code */
-    static std::string helperFunctions; /**< Static C++ code of helper functions */
-    static std::string transitionFunctions; /**< Static C++ code of transition handling */
     static std::string automatonEngineFunctions; /**< Static C++ code of the main automaton engine */
     static std::string networkFunctions; /**< Static C++ code of UDP networking functions */
 
     /**
-     * @brief Compiles the generated C++ code
+     * @brief Generates the guards of one unit's transitions
+     *
+     * @param out Buffer the code is appended to
+     * @param translator Translator of the machine the transitions belong to
+     * @param transitions Transitions in the order their guards are numbered
+     * @param unit Index of the unit, it holds the guards from unit * unitSize on
+     * @param unitSize Number of guards in a unit
+     */
+    static void generateGuards(CodeBuffer& out, const ActionTranslator& translator,
+                               const std::vector<Transition*>& transitions, size_t unit, size_t unitSize);
+
+    /**
+     * @brief Generates the output actions of one unit's states
      *
-     * @param sourcePath Path of the generated C++ file
-     * @param outputPath Path of the compiled executable
+     * @param out Buffer the code is appended to
+     * @param translator Translator of the machine the states belong to
+     * @param states States in the order they are numbered
+     * @param unit Index of the unit, it holds the states from unit * unitSize on
+     * @param unitSize Number of states in a unit
      */
-    static void compileGeneratedCode(const QString& sourcePath, const QString& outputPath);
+    static void generateOutputActions(CodeBuffer& out, const ActionTranslator& translator,
+                                      const std::vector<State*>& states, size_t unit, size_t unitSize);
+
+    /**
+     * @brief Generates the members that pass a guard or state on to the unit holding it
+     *
+     * @param out Buffer the code is appended to
+     * @param units Number of units
+     * @param unitSize Number of guards and states in a unit
+     */
+    static void generateDispatchers(CodeBuffer& out, size_t units, size_t unitSize);
+
+    /**
+     * @brief Writes a makefile and a ninja file building the generated sources in parallel
+     *
+     * @param out Buffer reused for the files
+     * @param program Files of the generated program
+     */
+    static void writeBuildFiles(CodeBuffer& out, const GeneratedProgram& program);
 
 public:
+    static constexpr size_t UNIT_SIZE = 256; /**< Default number of transitions and states in a unit */
+
     /**
      * @brief Generates C++ code from the internal representation of a Moore Machine
      *
      * @param machine Internal representation of a Moore Machine
-     * @param filename Path for the generated code
-     * @return True if generation is successful, false otherwise
+     * @param filename Path for the generated code without an extension
+     * @param sourceWritten Called with the path of each source once it is written, may be empty
+     * @param unitSize Number of transitions and states in a unit
+     * @return Paths of the generated files
+     * @throws std::runtime_error If a file cannot be written or an action cannot be translated
+     */
+    static GeneratedProgram generateCode(const MooreMachine& machine, const std::string& filename,
+                                         const std::function<void(const std::string&)>& sourceWritten = nullptr,
+                                         size_t unitSize = UNIT_SIZE);
+
+    /**
+     * @brief Gets the object file a generated source compiles to
+     *
+     * @param sourcePath Path of a generated .cpp file
+     * @return The same path ending with .o instead
+     */
+    static std::string objectPath(const std::string& sourcePath);
+
+    /**
+     * @brief Gets the compiler the generated sources are built with
+     *
+     * @return Name of the compiler executable
+     */
+    static std::string compilerName();
+
+    /**
+     * @brief Gets the options every generated source is compiled and linked with
+     *
+     * @return Compiler options
      */
-    static bool generateCode(const MooreMachine& machine, const std::string& filename);
+    static std::vector<std::string> compilerOptions();
 };
 
 #endif //CODE_GENERATOR_H
@@ -9,6 +9,8 @@
 #include <QUdpSocket>
 #include <QEventLoop>
 #include <QTimer>
+#include <string>
+#include "wire_protocol.h"
 
 /**
  * @class CommBridge
@@ -30,11 +32,29 @@ public:
      */
     ~CommBridge();
 
+    /**
+     * @brief Selects the automaton instance datagrams are exchanged with
+     * @param id ID of the instance in the running process
+     */
+    void setInstance(quint32 id);
+
+    /**
+     * @brief Retrieves the automaton instance datagrams are exchanged with
+     * @return ID of the instance
+     */
+    quint32 getInstance() const;
+
+    /**
+     * @brief Starts a datagram to the generated executable automaton
+     * @return Writer with the header, the instance and the next sequence number filled in
+     */
+    WireWriter createDatagram();
+
     /**
      * @brief Sends an UDP datagram to the generated executable automaton
-     * @param message Contents of the datagram being sent
+     * @param datagram Datagram built by a WireWriter
      */
-    void send(const QString& message);
+    void send(const WireWriter& datagram);
 
     /**
      * @brief Send initial hello message to the generated executable automaton
@@ -44,14 +64,15 @@ public:
 
     /**
      * @brief Correctly destroys connection between editor and generated executable automaton
+     * @param id ID of the automaton instance to disconnect from
      */
-    static void goodbye();
+    static void goodbye(quint32 id = 0);
 
 signals:
     /**
-     * @brief Signal indicating received message from UDP communication
+     * @brief Signal indicating received datagram from UDP communication
      */
-    void eventReceived(const QString& message);
+    void eventReceived(const std::string& datagram);
     /**
      * @brief Signal indicating successful establishment of connection with generated executable automaton
      */
@@ -67,6 +88,8 @@ private:
     QUdpSocket* sock; /**< An UDP socket */
     quint16 localPort = 56788; /**< Local port number */
     quint16 runtimePort = 56789; /**< Generated automaton port number */
+    quint32 sequence = 0; /**< Sequence number of the next datagram sent */
+    quint32 instance = 0; /**< ID of the automaton instance in the running process */
 };
 
 #endif //COMM_BRIDGE_H
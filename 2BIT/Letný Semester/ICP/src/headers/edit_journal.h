@@ -0,0 +1,260 @@
+/**
+ * @file edit_journal.h
+ * @brief Declaration of the EditJournal class
+ * @author Hugo Bohácsek (xbohach00)
+ */
+
+#ifndef EDIT_JOURNAL_H
+#define EDIT_JOURNAL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+#include "moore_machine.h"
+#include "state.h"
+#include "transition.h"
+
+/**
+ * @struct EditCommand
+ * @brief One edit of a machine, recorded as the elements it added, removed or replaced
+ *
+ * The recorded elements are shared and never changed, so undoing and redoing
+ * an edit moves pointers instead of copying states or transitions.
+ */
+struct EditCommand {
+    /**
+     * @enum Kind
+     * @brief What the edit did
+     */
+    enum Kind {
+        ADD_STATE,          /**< Added state */
+        REMOVE_STATE,       /**< Removed state together with its transitions */
+        ADD_TRANSITION,     /**< Added transition */
+        REMOVE_TRANSITION,  /**< Removed transition */
+        REPLACE_TRANSITION, /**< Changed conditions or timeout of a transition */
+        ADD_VARIABLE,       /**< Added variable, possibly replacing one with the same name */
+        REMOVE_VARIABLE,    /**< Removed variable */
+        SET_INITIAL         /**< Moved the initial mark to another state */
+    };
+
+    /**
+     * @struct PlacedTransition
+     * @brief Transition with its position among the transitions leaving its source state
+     */
+    struct PlacedTransition {
+        std::shared_ptr<const Transition> transition; /**< The transition */
+        size_t position;                              /**< Position it is tried at, SIZE_MAX for the end */
+    };
+
+    /**
+     * @struct Variable
+     * @brief Variable as it is passed to MooreMachine::addVariable
+     */
+    struct Variable {
+        std::string type;  /**< Type name, "int", "float" or "string" */
+        std::string name;  /**< Name of the variable */
+        std::string value; /**< Initial value */
+    };
+
+    Kind kind;                                      /**< What the edit did */
+    std::shared_ptr<const State> state;             /**< Added or removed state */
+    std::vector<PlacedTransition> transitions;      /**< Added or removed transitions, the old and the new one when replaced */
+    std::shared_ptr<const Variable> variable;       /**< Added or removed variable */
+    std::shared_ptr<const Variable> replaced;       /**< Variable the added one replaced */
+    std::string previousInitial;                    /**< Initial state the added or marked state took over from */
+    std::string initial;                            /**< State marked as initial */
+
+    /**
+     * @brief Gets the number of elements the command holds
+     *
+     * @return Number of states, transitions and variables recorded
+     */
+    size_t getWeight() const;
+};
+
+/**
+ * @class EditJournal
+ * @brief Undo and redo history of the edits of a machine
+ *
+ * Edits are made through the journal, which records what each of them changed
+ * instead of a copy of the machine. Undoing an edit applies the inverse change,
+ * so it costs as much as the edit did, no matter how big the machine is.
+ * Commands are undone and redone strictly in order, which gives the machine
+ * back the same state and transition slots and the same transition order.
+ *
+ * The history is bounded by the number of elements the commands hold,
+ * the oldest commands are forgotten first.
+ */
+class EditJournal {
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 100000; /**< Default bound of the recorded elements */
+
+    /**
+     * @brief Constructor
+     *
+     * @param capacity Number of states, transitions and variables the history may hold
+     */
+    explicit EditJournal(size_t capacity = DEFAULT_CAPACITY);
+
+    /**
+     * @brief Adds a state, making it the initial one if it is marked so
+     *
+     * @param machine Machine to edit
+     * @param state State to add
+     * @return True if the state was added
+     */
+    bool addState(MooreMachine& machine, const State& state);
+
+    /**
+     * @brief Removes a state with its transitions
+     *
+     * @param machine Machine to edit
+     * @param stateId ID of the state
+     * @return True if the state was removed
+     */
+    bool removeState(MooreMachine& machine, const std::string& stateId);
+
+    /**
+     * @brief Marks a state as the initial one
+     *
+     * @param machine Machine to edit
+     * @param stateId ID of the state
+     * @return True if the state was marked
+     */
+    bool setInitialState(MooreMachine& machine, const std::string& stateId);
+
+    /**
+     * @brief Adds a transition after the others leaving its source state
+     *
+     * @param machine Machine to edit
+     * @param transition Transition to add
+     * @return True if the transition was added
+     */
+    bool addTransition(MooreMachine& machine, const Transition& transition);
+
+    /**
+     * @brief Removes a transition
+     *
+     * @param machine Machine to edit
+     * @param transitionId ID of the transition
+     * @return True if the transition was removed
+     */
+    bool removeTransition(MooreMachine& machine, const std::string& transitionId);
+
+    /**
+     * @brief Replaces a transition with a changed copy, keeping its position
+     *
+     * @param machine Machine to edit
+     * @param transition Changed transition, with the same ID, source and target
+     * @return True if the transition was replaced
+     */
+    bool replaceTransition(MooreMachine& machine, const Transition& transition);
+
+    /**
+     * @brief Adds a variable, replacing one with the same name
+     *
+     * @param machine Machine to edit
+     * @param type Type name, "int", "float" or "string"
+     * @param name Name of the variable
+     * @param value Initial value
+     * @return True if the variable was added
+     */
+    bool addVariable(MooreMachine& machine, const std::string& type, const std::string& name, const std::string& value);
+
+    /**
+     * @brief Removes a variable
+     *
+     * @param machine Machine to edit
+     * @param name Name of the variable
+     * @return True if the variable was removed
+     */
+    bool removeVariable(MooreMachine& machine, const std::string& name);
+
+    /**
+     * @brief Reverts the last edit
+     *
+     * @param machine Machine the edits were made to
+     * @return The reverted command, nullptr if there is nothing to undo
+     */
+    const EditCommand* undo(MooreMachine& machine);
+
+    /**
+     * @brief Makes the last undone edit again
+     *
+     * @param machine Machine the edits were made to
+     * @return The repeated command, nullptr if there is nothing to redo
+     */
+    const EditCommand* redo(MooreMachine& machine);
+
+    /**
+     * @brief Checks whether there is an edit to undo
+     *
+     * @return True if undo() would revert something
+     */
+    bool canUndo() const;
+
+    /**
+     * @brief Checks whether there is an edit to redo
+     *
+     * @return True if redo() would repeat something
+     */
+    bool canRedo() const;
+
+    /**
+     * @brief Forgets the history, used when the machine is replaced
+     */
+    void clear();
+
+    /**
+     * @brief Gets the number of elements the history holds
+     *
+     * @return Number of states, transitions and variables recorded
+     */
+    size_t getWeight() const;
+
+private:
+    std::deque<EditCommand> commands; /**< Commands made, then the commands undone, oldest first */
+    size_t done;                      /**< Number of commands made and not undone */
+    size_t capacity;                  /**< Bound of the recorded elements */
+    size_t weight;                    /**< Elements the commands hold */
+
+    /**
+     * @brief Makes the edit of a command
+     *
+     * @param machine Machine to edit
+     * @param command Command to make
+     * @return True if the machine accepted the edit
+     */
+    static bool apply(MooreMachine& machine, const EditCommand& command);
+
+    /**
+     * @brief Reverts the edit of a command
+     *
+     * @param machine Machine to edit
+     * @param command Command to revert, the last one made
+     */
+    static void revert(MooreMachine& machine, const EditCommand& command);
+
+    /**
+     * @brief Puts a transition in place of the one with the same ID, keeping its position
+     *
+     * @param machine Machine to edit
+     * @param transition Transition to put in
+     * @return True if the transition was replaced
+     */
+    static bool swapTransition(MooreMachine& machine, const Transition& transition);
+
+    /**
+     * @brief Makes a new edit and records it, dropping the commands undone before
+     *
+     * @param machine Machine to edit
+     * @param command Command to make
+     * @return True if the machine accepted the edit
+     */
+    bool record(MooreMachine& machine, EditCommand command);
+};
+
+#endif // EDIT_JOURNAL_H
@@ -11,6 +11,8 @@
  #include <vector>
  #include <unordered_map>
  #include "machine_variable.h"
+ #include "expression_program.h"
+ #include "state.h"
  
  /**
   * @enum TokenType
@@ -122,6 +124,35 @@
         const std::string& expression,
         const std::unordered_map<std::string, MachineVariable>& variables,
         int elapsedTime);
+    
+    /**
+     * @brief Compiles an arithmetic expression into a reusable program
+     * 
+     * Errors are not reported here but compiled into the program, so they
+     * surface at the same point of evaluation as with evaluateExpression().
+     * 
+     * @param expression The arithmetic expression (e.g., "var + 5 * 3 - elapsed")
+     * @return The compiled program
+     */
+    ExpressionProgram compile(const std::string& expression);
+    
+    /**
+     * @brief Compiles an output expression
+     * @param expression The output expression (e.g., "output var + 5 to output1")
+     * @return OUTPUT_EXPRESSION statement, or INVALID if the format is wrong
+     */
+    CompiledOutput compileOutputExpression(const std::string& expression);
+    
+    /**
+     * @brief Compiles an output statement of a state
+     * 
+     * Mirrors the way MachineSimulator interprets the statement: assignments,
+     * output expressions and plain values, optionally guarded by a condition.
+     * 
+     * @param output The output statement
+     * @return The compiled statement
+     */
+    CompiledOutput compileOutput(const OutputCondition& output);
          
  private:
     /**
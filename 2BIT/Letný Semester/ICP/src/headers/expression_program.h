@@ -0,0 +1,225 @@
+/**
+ * @file expression_program.h
+ * @brief Declaration of the ExpressionProgram class and compiled output actions
+ * @author Hugo Bohácsek (xbohach00)
+ */
+
+#ifndef EXPRESSION_PROGRAM_H
+#define EXPRESSION_PROGRAM_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include "machine_variable.h"
+
+/**
+ * @enum OpCode
+ * @brief Instructions understood by ExpressionProgram
+ */
+enum class OpCode {
+    LOAD,  /**< Replace the accumulator with the operand */
+    APPLY, /**< Combine the accumulator with the operand */
+    FAIL   /**< Throw the error stored at the operand index */
+};
+
+/**
+ * @enum OperandKind
+ * @brief Where the operand of an instruction comes from
+ */
+enum class OperandKind {
+    CONSTANT, /**< Literal from the constant pool */
+    VARIABLE, /**< Machine variable from a resolved slot */
+    ELAPSED,  /**< The elapsed time keyword */
+    NONE      /**< No operand */
+};
+
+/**
+ * @struct Instruction
+ * @brief Single instruction of a compiled expression
+ */
+struct Instruction {
+    OpCode op;         /**< What to do */
+    OperandKind kind;  /**< Where the operand comes from */
+    char operation;    /**< Arithmetic operator for APPLY */
+    int index;         /**< Index into the constant pool, slot table or error list */
+};
+
+/**
+ * @class ExpressionProgram
+ * @brief Arithmetic expression compiled into bytecode
+ *
+ * Expressions have no precedence and are evaluated strictly left to right,
+ * so the program runs on a single accumulator instead of a general stack.
+ * Variable names are resolved to slots once per variable map, so running
+ * a program does not hash strings or allocate memory for numeric values.
+ */
+class ExpressionProgram {
+private:
+    std::vector<Instruction> code;                       /**< Instructions in execution order */
+    std::vector<MachineVariable> constants;              /**< Literal operands */
+    std::vector<std::string> slotNames;                  /**< Variable names by slot */
+    std::vector<const MachineVariable*> resolved;        /**< Resolved variables by slot */
+    std::vector<std::string> errors;                     /**< Messages raised by FAIL */
+    const std::unordered_map<std::string, MachineVariable>* boundVariables; /**< Map the slots were resolved against */
+    MachineVariable accumulator;                         /**< Result of the last run */
+    MachineVariable elapsedValue;                        /**< Operand for the elapsed keyword */
+
+public:
+    /**
+     * @brief Default constructor, creates an empty program
+     */
+    ExpressionProgram();
+
+    /**
+     * @brief Adds a literal to the constant pool
+     *
+     * @param constant The literal value
+     * @return Index of the constant
+     */
+    int addConstant(const MachineVariable& constant);
+
+    /**
+     * @brief Gets the slot of a variable, adding it if it is not referenced yet
+     *
+     * @param name Name of the variable
+     * @return Index of the slot
+     */
+    int addSlot(const std::string& name);
+
+    /**
+     * @brief Adds an error message for a FAIL instruction
+     *
+     * @param message The message to throw
+     * @return Index of the message
+     */
+    int addError(const std::string& message);
+
+    /**
+     * @brief Appends an instruction
+     *
+     * @param op What to do
+     * @param kind Where the operand comes from
+     * @param operation Arithmetic operator for APPLY ('+', '-', '*', '/')
+     * @param index Index of the operand or error message
+     */
+    void append(OpCode op, OperandKind kind, char operation, int index);
+
+    /**
+     * @brief Resolves variable slots against a variable map
+     *
+     * @param variables Map of variables available to the expression
+     */
+    void bind(const std::unordered_map<std::string, MachineVariable>& variables);
+
+    /**
+     * @brief Forgets resolved slots, forcing a bind on the next run
+     *
+     * Must be called when variables are added to or removed from the bound map.
+     */
+    void unbind();
+
+    /**
+     * @brief Runs the program
+     *
+     * The slots are resolved again if a different map is passed than last time.
+     *
+     * @param variables Map of variables available to the expression
+     * @param elapsedTime Current elapsed time in milliseconds
+     * @return Result of the evaluation, valid until the next run
+     * @throw std::runtime_error If the expression contains errors
+     */
+    const MachineVariable& evaluate(
+        const std::unordered_map<std::string, MachineVariable>& variables,
+        int elapsedTime);
+
+    /**
+     * @brief Gets the number of instructions
+     *
+     * @return Length of the program
+     */
+    size_t size() const;
+
+    /**
+     * @brief Gets the instructions, used to translate the program into other languages
+     *
+     * @return Instructions in execution order
+     */
+    const std::vector<Instruction>& getInstructions() const;
+
+    /**
+     * @brief Gets a literal from the constant pool
+     *
+     * @param index Index of the constant
+     * @return The literal value
+     */
+    const MachineVariable& getConstant(int index) const;
+
+    /**
+     * @brief Gets the size of the constant pool
+     *
+     * @return Number of literals
+     */
+    size_t getConstantCount() const;
+
+    /**
+     * @brief Gets the name of the variable referenced by a slot
+     *
+     * @param slot Index of the slot
+     * @return Name of the variable
+     */
+    const std::string& getSlotName(int slot) const;
+
+    /**
+     * @brief Gets the number of variable slots
+     *
+     * @return Number of referenced variables
+     */
+    size_t getSlotCount() const;
+
+    /**
+     * @brief Gets the message raised by a FAIL instruction
+     *
+     * @param index Index of the message
+     * @return The error message
+     */
+    const std::string& getError(int index) const;
+
+    /**
+     * @brief Gets the number of error messages
+     *
+     * @return Number of messages
+     */
+    size_t getErrorCount() const;
+};
+
+/**
+ * @enum OutputAction
+ * @brief Kind of statement attached to a state
+ */
+enum class OutputAction {
+    ASSIGN_INPUT,      /**< var = get input1 */
+    ASSIGN_EXPRESSION, /**< var = expression */
+    OUTPUT_EXPRESSION, /**< output expression to output1 */
+    VALUE,             /**< Plain value or variable sent to an output pointer */
+    INVALID            /**< Malformed statement, executing it throws */
+};
+
+/**
+ * @struct CompiledOutput
+ * @brief State output statement parsed ahead of time
+ */
+struct CompiledOutput {
+    OutputAction action;       /**< Kind of the statement */
+    std::string target;        /**< Assigned variable or output pointer */
+    std::string source;        /**< Input pointer for ASSIGN_INPUT, value for VALUE, message for INVALID */
+    bool hasCondition;         /**< Whether the statement is guarded by "if input is defined" */
+    std::string conditionPtr;  /**< Input pointer that has to be defined */
+    ExpressionProgram program; /**< Compiled expression for ASSIGN_EXPRESSION and OUTPUT_EXPRESSION */
+
+    /**
+     * @brief Default constructor, creates a statement that outputs nothing
+     */
+    CompiledOutput() : action(OutputAction::VALUE), hasCondition(false) {}
+};
+
+#endif // EXPRESSION_PROGRAM_H
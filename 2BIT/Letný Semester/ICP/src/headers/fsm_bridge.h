@@ -15,9 +15,14 @@
 #include "machine_simulator.h"
 #include "machine_file_handler.h"
 #include "code_generator.h"
+#include "code_export_job.h"
 #include "comm_bridge.h"
 #include "machine_connector.h"
 #include "includable_generator.h"
+#include "machine_analyzer.h"
+#include "machine_trace.h"
+#include "edit_journal.h"
+#include "scene_model.h"
 
 /**
  * @class FSMBridge
@@ -56,21 +61,51 @@ public:
     /**
      * @brief Loads a machine from a file
      * @param filePath Path to the file containing the machine definition
-     * @return True if loading succeeded, false otherwise
+     * @return True if loading succeeded, false otherwise, getLoadError() tells why
      */
     bool loadMachineFromFile(const QString &filePath);
 
+    /**
+     * @brief Gets why the last load failed
+     * @return Error message with the line and column of a format error, empty after a successful load
+     */
+    QString getLoadError() const;
+
     /**
      * @brief Connects to a running machine
+     * @param instance ID of the automaton instance in the running process
      * @return True if connecting succeeded, false otherwise
      */
-    bool connectToRunningMachine();
+    bool connectToRunningMachine(quint32 instance = 0);
 
     /**
      * @brief Disconnects from a running machine
      */
     void disconnectFromRunningMachine();
 
+    /**
+     * @brief Starts recording the simulation or the connected machine into a trace file
+     *
+     * Inputs, state entries, output changes and variable updates are
+     * recorded until stopRecording() is called. The recording starts from
+     * the current state and values.
+     *
+     * @param filePath Path of the trace file
+     * @return True if recording started, false if the file could not be created
+     */
+    bool startRecording(const QString &filePath);
+
+    /**
+     * @brief Stops recording and closes the trace file
+     */
+    void stopRecording();
+
+    /**
+     * @brief Checks whether a trace is being recorded
+     * @return True while recording
+     */
+    bool isRecording() const;
+
     /**
      * @brief Saves the current machine to a file
      * @param filePath Path to the file where the machine will be saved
@@ -79,12 +114,15 @@ public:
     bool saveMachineToFile(const QString &filePath);
 
     /**
-     * @brief Saves the generated code of the current machine to a file
+     * @brief Prepares generating and compiling the code of the current machine
      *
-     * @param filePath Path to the file where the code will be saved
-     * @return True if saving succeeded, false otherwise
+     * The job is not started, so its signals can be connected first. It works
+     * on a copy of the machine and belongs to the bridge.
+     *
+     * @param filePath Path for the generated code without an extension
+     * @return The export job, or nullptr if there is no machine
      */
-    bool saveCodeToFile(const QString &filePath);
+    CodeExportJob* exportCode(const QString &filePath);
     
     /**
      * @brief Adds a new state to the machine
@@ -215,6 +253,12 @@ public:
      */
     QStringList getValidationErrors() const;
     
+    /**
+     * @brief Analyses the machine for unreachable, dead and trap states and overlapping transitions
+     * @return QStringList containing one warning per finding
+     */
+    QStringList getAnalysisWarnings() const;
+    
     /**
      * @brief Gets the ID of the current active state during simulation
      * @return The ID of the current state
@@ -271,6 +315,13 @@ public:
      */
     void stepSimulation();
 
+    /**
+     * @brief Gets how long the simulation can sleep before the next step
+     * 
+     * @return Delay in milliseconds, or -1 if nothing happens until the next input
+     */
+    int getMsUntilNextStep() const;
+
     /**
      * @brief Returns the Transitions trigger condition a string
      * 
@@ -370,12 +421,39 @@ public:
      */
     void genIncludable(const QString &codeStyle);
 
+    /**
+     * @brief Checks whether there is an edit to undo
+     * @return True if undo() would revert something
+     */
+    bool canUndo() const;
+
+    /**
+     * @brief Checks whether there is an edit to redo
+     * @return True if redo() would repeat something
+     */
+    bool canRedo() const;
+
+    /**
+     * @brief Reverts the last edit of the machine
+     * @return The reverted edit, so the view can update only what it touched, nullptr if there was none
+     */
+    const EditCommand* undo();
+
+    /**
+     * @brief Makes the last undone edit of the machine again
+     * @return The repeated edit, nullptr if there was none
+     */
+    const EditCommand* redo();
+
 private:
     MooreMachine* machine;       /**< The underlying Moore machine */
     MachineSimulator* simulator; /**< Simulator for the machine */
     MachineConnector* connector; /**< Connector for the machine */
     CommBridge communicationsBridge; /**< Communication bridge between GUI and running machine */
     bool machineConnected; /**< Indicates whether there is a remote machine connected */
+    QString loadError; /**< Message of the last failed load */
+    TraceWriter* traceWriter; /**< Trace being recorded, nullptr when not recording */
+    EditJournal journal; /**< Undo and redo history of the edits */
 
     /**
      * @brief Converts a backend state ID to frontend representation
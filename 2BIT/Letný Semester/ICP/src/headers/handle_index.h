@@ -0,0 +1,182 @@
+/**
+ * @file handle_index.h
+ * @brief Declaration of the HandleIndex class looking up stored objects by a string key
+ * @author Hugo Bohácsek (xbohach00)
+ */
+
+#ifndef HANDLE_INDEX_H
+#define HANDLE_INDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @class HandleIndex
+ * @brief Open-addressing hash index from a string key to the handle of the object holding it
+ *
+ * The index stores only the hash and the handle of every object, the key
+ * itself stays in the object and is read back through a keyOf(handle)
+ * callback when entries are compared or moved. Holding no pointers, an
+ * index stays valid when the objects are copied or their storage grows.
+ */
+class HandleIndex {
+public:
+    static constexpr uint32_t NONE = 0xFFFFFFFF; /**< Returned when no object has the key */
+
+private:
+    static constexpr uint32_t REMOVED = 0xFFFFFFFE; /**< Handle of an erased entry */
+
+    /**
+     * @struct Entry
+     * @brief Slot of the table
+     */
+    struct Entry {
+        uint32_t hash;   /**< Low bits of the hash of the key */
+        uint32_t handle; /**< Handle of the object, NONE when free, REMOVED when erased */
+    };
+
+    std::vector<Entry> entries; /**< The table, its size is a power of two */
+    size_t live;                /**< Number of entries holding a handle */
+    size_t used;                /**< Number of entries holding a handle or erased */
+
+    /**
+     * @brief Hashes a key
+     *
+     * @param key The key
+     * @return The hash
+     */
+    static uint32_t hashKey(std::string_view key) {
+        return static_cast<uint32_t>(std::hash<std::string_view>()(key));
+    }
+
+    /**
+     * @brief Rebuilds the table with room for count entries, dropping erased ones
+     *
+     * @param count Number of entries to make room for
+     */
+    void rebuild(size_t count) {
+        size_t capacity = 8;
+        while (capacity * 7 / 10 < count) {
+            capacity *= 2;
+        }
+
+        std::vector<Entry> old(capacity, Entry{0, NONE});
+        old.swap(entries);
+        used = live;
+        size_t mask = entries.size() - 1;
+        for (const Entry& entry : old) {
+            if (entry.handle == NONE || entry.handle == REMOVED) {
+                continue;
+            }
+            size_t slot = entry.hash & mask;
+            while (entries[slot].handle != NONE) {
+                slot = (slot + 1) & mask;
+            }
+            entries[slot] = entry;
+        }
+    }
+
+public:
+    /**
+     * @brief Constructor, creates an empty index
+     */
+    HandleIndex() : live(0), used(0) {}
+
+    /**
+     * @brief Finds the object with a key
+     *
+     * @param key The key
+     * @param keyOf Callback returning the key of the object with a handle
+     * @return Handle of the object, or NONE
+     */
+    template <typename KeyOf>
+    uint32_t find(std::string_view key, KeyOf keyOf) const {
+        if (entries.empty()) {
+            return NONE;
+        }
+
+        uint32_t hash = hashKey(key);
+        size_t mask = entries.size() - 1;
+        for (size_t slot = hash & mask; entries[slot].handle != NONE; slot = (slot + 1) & mask) {
+            const Entry& entry = entries[slot];
+            if (entry.handle != REMOVED && entry.hash == hash && keyOf(entry.handle) == key) {
+                return entry.handle;
+            }
+        }
+        return NONE;
+    }
+
+    /**
+     * @brief Adds an object, the key must not be in the index yet
+     *
+     * @param key Key of the object
+     * @param handle Handle of the object
+     */
+    void insert(std::string_view key, uint32_t handle) {
+        if ((used + 1) * 10 > entries.size() * 7) {
+            rebuild(live + 1);
+        }
+
+        uint32_t hash = hashKey(key);
+        size_t mask = entries.size() - 1;
+        size_t slot = hash & mask;
+        while (entries[slot].handle != NONE && entries[slot].handle != REMOVED) {
+            slot = (slot + 1) & mask;
+        }
+        if (entries[slot].handle == NONE) {
+            used++;
+        }
+        entries[slot] = Entry{hash, handle};
+        live++;
+    }
+
+    /**
+     * @brief Removes an object
+     *
+     * @param key Key of the object
+     * @param handle Handle of the object
+     * @return True if the object was in the index
+     */
+    bool erase(std::string_view key, uint32_t handle) {
+        if (entries.empty()) {
+            return false;
+        }
+
+        uint32_t hash = hashKey(key);
+        size_t mask = entries.size() - 1;
+        for (size_t slot = hash & mask; entries[slot].handle != NONE; slot = (slot + 1) & mask) {
+            if (entries[slot].handle == handle) {
+                entries[slot].handle = REMOVED;
+                live--;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief Makes room for a number of objects
+     *
+     * @param count Expected number of objects
+     */
+    void reserve(size_t count) {
+        if (count * 10 > entries.size() * 7) {
+            rebuild(count);
+        }
+    }
+
+    /**
+     * @brief Gets the number of objects
+     *
+     * @return Number of objects in the index
+     */
+    size_t size() const {
+        return live;
+    }
+};
+
+#endif // HANDLE_INDEX_H
@@ -8,15 +8,19 @@
 #define INCLUDABLE_GENERATOR_H
 
 #include "moore_machine.h"
+#include "action_translator.h"
 #include <string>
+#include <vector>
 
 /**
  * @enum CodeStyle
  * @brief Defines the types of code style determined via compilers
  */
 enum class CodeStyle{
-    CALLBACK,
-    COMPUTED_GOTO
+    CALLBACK,      /**< Generic state and transition tables with std::function callbacks */
+    COMPUTED_GOTO, /**< Generic tables with labels registered for computed gotos */
+    TYPED,         /**< Typed structs for variables and pointers, enum class states, transitions as direct code */
+    C_TABLE        /**< Freestanding C99 header with const transition, dispatch and output tables */
 };
 
 /**
@@ -31,13 +35,89 @@ private:
     static std::string generateHeaderContent(const MooreMachine& machine, const std::string& className, CodeStyle style);
     static std::string generateSourceContent(const MooreMachine& machine, const std::string& className, const std::string& headerName, CodeStyle style);
     static std::string generateGotoImplementation(const MooreMachine& machine, const std::string& className, const std::string& headerName);
+
+    /**
+     * @brief Generates the members translated from the guards and outputs of the machine
+     *
+     * @param translator Translator of the machine
+     * @param className Name of the generated C++ class
+     * @param states States in the order of their indices
+     * @param transitions Transitions in the order of their indices
+     * @param withGuards Whether evaluateGuard and clearTriggeredInputs are generated
+     * @return Definitions of elapsedMs, executeOutputActions, evaluateGuard and clearTriggeredInputs
+     */
+    static std::string generateCompiledActions(const ActionTranslator& translator, const std::string& className,
+                                               const std::vector<State*>& states, const std::vector<Transition*>& transitions,
+                                               bool withGuards);
+
+    /**
+     * @brief Generates the dispatch loop of the computed goto style
+     *
+     * Every state gets a label that checks its timeouts and its guards inlined,
+     * a transition jumps straight to the label of its target. The GNU computed
+     * goto picks the label of the current state, other compilers use a switch.
+     *
+     * @param translator Translator of the machine
+     * @param className Name of the generated C++ class
+     * @param states States in the order of their indices
+     * @param transitions Transitions in the order of their indices
+     * @return Definition of dispatch
+     */
+    static std::string generateGotoDispatch(const ActionTranslator& translator, const std::string& className,
+                                            const std::vector<State*>& states, const std::vector<Transition*>& transitions);
+
+    /**
+     * @brief Generates the header of the typed style
+     *
+     * @param machine The Moore machine to convert to code
+     * @param className Name of the generated C++ class
+     * @param translator Translator of the machine, names the struct fields
+     * @param stateIds Enum value of each state, the initial state first
+     * @param guards Number of transitions with conditions, each gets a guard method
+     * @param timers Number of transitions with both conditions and a timeout
+     * @return Content of the header
+     */
+    static std::string generateTypedHeader(const MooreMachine& machine, const std::string& className,
+                                           const TypedActionTranslator& translator, const std::vector<std::string>& stateIds,
+                                           int guards, int timers);
+
+    /**
+     * @brief Generates the typed style, with no lookups by name when the machine runs
+     *
+     * @param machine The Moore machine to convert to code
+     * @param className Name of the generated C++ class
+     * @param headerName File name of the header to include
+     * @param header Receives the content of the header
+     * @return Content of the implementation file
+     * @throw std::runtime_error If the machine has no states
+     */
+    static std::string generateTypedImplementation(const MooreMachine& machine, const std::string& className,
+                                                   const std::string& headerName, std::string& header);
+
+    /**
+     * @brief Generates the C table style, a single header usable from C99 and C++
+     *
+     * Transitions, the first transition each input symbol fires in each state and
+     * constant state outputs become const tables, guards with variables and outputs
+     * that compute values become static inline functions. The header needs no heap
+     * and only the freestanding headers of the C library.
+     *
+     * @param machine The Moore machine to convert to code
+     * @param className Prefix of every generated name
+     * @return Content of the header
+     * @throw std::runtime_error If the machine has no states or exceeds the limits of the tables
+     */
+    static std::string generateCHeader(const MooreMachine& machine, const std::string& className);
 public:
     /**
      * @brief Generates includable C++ code from a Moore machine
      * 
+     * The C table style writes only baseName.h, the other styles a header and baseName.cpp.
+     * 
      * @param machine The Moore machine to convert to code
      * @param baseName Base name for the generated files (without extension)
      * @param className Name of the generated C++ class
+     * @param style Shape of the generated class
      * @return True if code generation succeeded, false otherwise
      */
     static bool generateCode(const MooreMachine& machine, 
@@ -0,0 +1,85 @@
+/**
+ * @file machine_analyzer.h
+ * @brief Declaration of the MachineAnalyzer class
+ * @author Hugo Bohácsek (xbohach00)
+ */
+
+#ifndef MACHINE_ANALYZER_H
+#define MACHINE_ANALYZER_H
+
+#include <string>
+#include <vector>
+#include "moore_machine.h"
+
+/**
+ * @struct TransitionOverlap
+ * @brief Two transitions leaving one state that the same input enables
+ */
+struct TransitionOverlap {
+    std::string stateId;      /**< State both transitions leave */
+    std::string inputPtr;     /**< Input pointer of the shared condition */
+    std::string value;        /**< Input value of the shared condition */
+    std::string firstId;      /**< Transition the simulator takes */
+    std::string secondId;     /**< Transition that is never taken on this input */
+};
+
+/**
+ * @struct MachineAnalysis
+ * @brief Results of analysing the graph of a machine
+ */
+struct MachineAnalysis {
+    size_t states;                              /**< Number of states analysed */
+    size_t transitions;                         /**< Number of transitions analysed */
+    std::vector<std::string> unreachableStates; /**< States no path from the initial state leads to */
+    std::vector<std::string> deadStates;        /**< States without outgoing transitions */
+    std::vector<std::string> trapStates;        /**< States whose transitions all lead back to themselves */
+    std::vector<TransitionOverlap> overlaps;    /**< Inputs enabling more than one transition of a state */
+    double seconds;                             /**< Wall clock time of the analysis */
+};
+
+/**
+ * @class MachineAnalyzer
+ * @brief Finds unreachable, dead and trap states and nondeterministic transitions
+ *
+ * The analysis runs on the compiled TransitionTable of the machine. States
+ * reached from the initial state are marked in a bitset by a depth-first
+ * walk over the dense target indices, every transition is assumed able to
+ * fire. The per-state checks are independent, so the states are split into
+ * contiguous ranges checked by worker threads and the findings are merged
+ * in state order.
+ *
+ * Two transitions overlap when they leave the same state and share an input
+ * condition, the simulator always takes the one added first. Boolean
+ * expression conditions depend on variable values and are not compared.
+ */
+class MachineAnalyzer {
+private:
+    MooreMachine& machine; /**< The machine analysed, its table is compiled on demand */
+    int threadCount;       /**< Number of worker threads */
+
+public:
+    /**
+     * @brief Constructor
+     *
+     * @param machine The machine to analyse, must outlive the analyzer
+     * @param threadCount Number of worker threads, 0 for one per hardware thread
+     */
+    MachineAnalyzer(MooreMachine& machine, int threadCount = 0);
+
+    /**
+     * @brief Analyses the machine
+     *
+     * @return Findings, each list in the order of MooreMachine::getStateHandles()
+     */
+    MachineAnalysis analyze() const;
+
+    /**
+     * @brief Describes the findings of an analysis
+     *
+     * @param analysis Results of analyze()
+     * @return One warning per finding, empty if there is nothing to report
+     */
+    static std::vector<std::string> describe(const MachineAnalysis& analysis);
+};
+
+#endif // MACHINE_ANALYZER_H
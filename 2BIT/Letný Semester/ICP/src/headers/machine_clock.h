@@ -0,0 +1,139 @@
+/**
+ * @file machine_clock.h
+ * @brief Declaration of the clocks driving machine time
+ * @author Hugo Bohácsek (xbohach00)
+ */
+
+#ifndef MACHINE_CLOCK_H
+#define MACHINE_CLOCK_H
+
+#include <chrono>
+
+/**
+ * @class MachineClock
+ * @brief Source of the time timeouts and the elapsed keyword are measured in
+ *
+ * MooreMachine and MachineSimulator never read the system clock directly,
+ * so a simulation can run on wall clock time or on a virtual time line.
+ */
+class MachineClock {
+public:
+    using TimePoint = std::chrono::steady_clock::time_point;
+
+    /**
+     * @brief Virtual destructor
+     */
+    virtual ~MachineClock() = default;
+
+    /**
+     * @brief Gets the current time
+     *
+     * @return Current time of the clock
+     */
+    virtual TimePoint now() const = 0;
+
+    /**
+     * @brief Waits until the given time
+     *
+     * @param deadline Time to wait for, returns immediately if it has passed
+     */
+    virtual void sleepUntil(TimePoint deadline) = 0;
+
+    /**
+     * @brief Checks whether the clock runs on virtual time
+     *
+     * @return True if waiting does not take any wall clock time
+     */
+    virtual bool isVirtual() const = 0;
+};
+
+/**
+ * @class SystemClock
+ * @brief Wall clock time from std::chrono::steady_clock
+ */
+class SystemClock : public MachineClock {
+public:
+    /**
+     * @brief Gets the shared instance used by default
+     *
+     * @return Reference to the system clock
+     */
+    static SystemClock& instance();
+
+    /**
+     * @brief Gets the current time
+     *
+     * @return Current steady clock time
+     */
+    TimePoint now() const override;
+
+    /**
+     * @brief Sleeps the calling thread until the given time
+     *
+     * @param deadline Time to wait for
+     */
+    void sleepUntil(TimePoint deadline) override;
+
+    /**
+     * @brief Checks whether the clock runs on virtual time
+     *
+     * @return Always false
+     */
+    bool isVirtual() const override;
+};
+
+/**
+ * @class VirtualClock
+ * @brief Discrete event time that only moves when it is told to
+ *
+ * Waiting jumps straight to the deadline, so a machine with minute long
+ * timeouts can be simulated as fast as its steps can be computed.
+ * The clock starts at the epoch of std::chrono::steady_clock.
+ */
+class VirtualClock : public MachineClock {
+private:
+    TimePoint current; /**< Current virtual time */
+
+public:
+    /**
+     * @brief Constructor, starts the clock at the epoch
+     */
+    VirtualClock();
+
+    /**
+     * @brief Gets the current time
+     *
+     * @return Current virtual time
+     */
+    TimePoint now() const override;
+
+    /**
+     * @brief Moves the clock forward to the given time
+     *
+     * @param deadline Time to move to, the clock never moves backwards
+     */
+    void sleepUntil(TimePoint deadline) override;
+
+    /**
+     * @brief Checks whether the clock runs on virtual time
+     *
+     * @return Always true
+     */
+    bool isVirtual() const override;
+
+    /**
+     * @brief Moves the clock forward by the given amount of time
+     *
+     * @param duration How far to move
+     */
+    void advance(std::chrono::milliseconds duration);
+
+    /**
+     * @brief Sets the clock to the given time, also backwards
+     *
+     * @param time New virtual time
+     */
+    void set(TimePoint time);
+};
+
+#endif // MACHINE_CLOCK_H
@@ -5,13 +5,16 @@
 #ifndef MACHINE_CONNECTOR_H
 #define MACHINE_CONNECTOR_H
 
+#include <cstdint>
 #include <string>
 #include <unordered_map>
-#include <regex>
+#include <vector>
 #include <QString>
 #include <QDebug>
 #include "moore_machine.h"
 #include "comm_bridge.h"
+#include "machine_clock.h"
+#include "machine_trace.h"
 
 class FSMBridge;
 
@@ -28,22 +31,42 @@ private:
     std::string currentStateId; /**< ID of the current state */
     std::unordered_map<std::string, std::string> inputValues; /**< Current input values by input pointer */
     std::unordered_map<std::string, std::string> outputValues; /**< Current output values by output pointer */
+    std::vector<std::string> stateSlots; /**< State names by slot, from the last snapshot */
+    std::vector<std::string> inputSlots; /**< Input pointers by slot, from the last snapshot */
+    std::vector<std::string> outputSlots; /**< Output pointers by slot, from the last snapshot */
+    std::vector<std::string> variableSlots; /**< Variable names by slot, from the last snapshot */
+    uint32_t expectedSequence; /**< Sequence number the next datagram should carry */
+    bool synchronized; /**< Whether a snapshot arrived and no datagram was missed since */
+    MachineClock::TimePoint lastResync; /**< When the last snapshot was requested */
+    static constexpr std::chrono::milliseconds RESYNC_INTERVAL{500}; /**< Shortest time between two snapshot requests */
+    TraceWriter* traceWriter; /**< Where inputs and received changes are recorded, nullptr for nowhere */
 
     /**
-     * @brief Parses values of all inputs from the initial information UDP message
-     * @param inputs Inputs information section of the initial information UDP message
+     * @brief Applies a snapshot, loading the automaton and all current values
+     * @param reader Reader positioned at the payload of a snapshot record
      */
-    void parseIncomingInputs(std::string inputs);
+    void applySnapshot(WireReader& reader);
+
+    /**
+     * @brief Reads a slot and looks it up
+     * @param reader Reader positioned at the slot
+     * @param names Names by slot
+     * @return Name stored in the slot
+     * @throw std::runtime_error If the slot is out of range
+     */
+    static const std::string& readSlot(WireReader& reader, const std::vector<std::string>& names);
+
     /**
-     * @brief Parses values of all outputs from the initial information UDP message
-     * @param outputs Outputs information section of the initial information UDP message
+     * @brief Stores the value of a variable of the machine
+     * @param name Name of the variable
+     * @param value New value of the variable as text
      */
-    void parseIncomingOutputs(std::string outputs);
+    void setVariable(const std::string& name, const std::string& value);
+
     /**
-     * @brief Parses values of all variables from the initial information UDP message
-     * @param outputs Variables information section of the initial information UDP message
+     * @brief Asks the generated executable automaton for a new snapshot
      */
-    void parseIncomingVariables(std::string variables);
+    void requestResync();
 
 public:
     /**
@@ -60,6 +83,15 @@ public:
      */
     void setNewMachine(MooreMachine* machine);
 
+    /**
+     * @brief Sets where inputs and received changes are recorded
+     *
+     * When already synchronized, the current values are recorded right away.
+     *
+     * @param writer Trace writer owned by the caller, nullptr to stop recording
+     */
+    void setTraceWriter(TraceWriter* writer);
+
     /**
      * @brief Sets the new value of an input and sends it to the generated executable automaton
      * @param inputPtr Name of the input
@@ -87,10 +119,15 @@ public:
     std::string getCurrentStateId() const;
 
     /**
-     * @brief Handles received UDP message from generated executable automaton
-     * @param msg Message from the generated executable automaton
+     * @brief Handles received UDP datagram from generated executable automaton
+     *
+     * Deltas are applied only while the sequence numbers follow each other.
+     * A gap or a malformed datagram drops the synchronization and requests
+     * a snapshot, deltas are ignored until it arrives.
+     *
+     * @param datagram Datagram from the generated executable automaton
      */
-    void handleReceivedMessage(const QString& msg);
+    void handleReceivedMessage(const std::string& datagram);
 };
 
 #endif //MACHINE_CONNECTOR_H
@@ -0,0 +1,88 @@
+/**
+ * @file machine_equivalence.h
+ * @brief Declaration of the EquivalenceChecker class
+ * @author Hugo Bohácsek (xbohach00)
+ */
+
+#ifndef MACHINE_EQUIVALENCE_H
+#define MACHINE_EQUIVALENCE_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "moore_machine.h"
+
+/**
+ * @struct EquivalenceStep
+ * @brief One input of a distinguishing trace
+ */
+struct EquivalenceStep {
+    std::string inputPtr; /**< Input pointer the value arrives on */
+    std::string value;    /**< Input value */
+};
+
+/**
+ * @struct EquivalenceResult
+ * @brief Outcome of comparing two machines
+ */
+struct EquivalenceResult {
+    bool equivalent;                    /**< Whether no input sequence tells the machines apart, false if unknown */
+    bool complete;                      /**< Whether every reachable pair was visited, false if the limit was hit */
+    std::vector<EquivalenceStep> trace; /**< Shortest input sequence after which the outputs differ */
+    std::string leftState;              /**< State of the left machine at the end of the trace */
+    std::string rightState;             /**< State of the right machine at the end of the trace */
+    size_t pairsVisited;                /**< Number of state pairs explored */
+    double seconds;                     /**< Wall clock time of the check */
+};
+
+/**
+ * @class EquivalenceChecker
+ * @brief Checks whether two machines answer every input sequence the same way
+ *
+ * The product of the two machines is explored breadth first from the pair of
+ * initial states. A pair is packed into one 64-bit number and kept in a flat
+ * open addressing set, the queue itself records how each pair was reached.
+ * The first pair whose states have different outputs ends the search and its
+ * path back to the start is a shortest distinguishing trace.
+ *
+ * The letters are the input pointer and value pairs read by either machine.
+ * A machine that has no transition on a letter stays where it is, just like
+ * MooreMachine::processInputOnPointer(). Expression guards and timed
+ * transitions are not followed. States have the same output when their output
+ * lists match, outputs reading variables or expressions are compared as
+ * written.
+ */
+class EquivalenceChecker {
+private:
+    MooreMachine& left;  /**< First machine, its table is compiled on demand */
+    MooreMachine& right; /**< Second machine, its table is compiled on demand */
+    size_t pairLimit;    /**< Number of pairs after which the search gives up, 0 for no limit */
+
+public:
+    /**
+     * @brief Constructor
+     *
+     * @param left First machine, must outlive the checker
+     * @param right Second machine, must outlive the checker
+     * @param pairLimit Number of pairs after which the search gives up, 0 for no limit
+     */
+    EquivalenceChecker(MooreMachine& left, MooreMachine& right, size_t pairLimit = 0);
+
+    /**
+     * @brief Compares the machines
+     *
+     * @return Whether they are equivalent, with a distinguishing trace if not
+     * @throws std::runtime_error If either machine has no initial state
+     */
+    EquivalenceResult check() const;
+
+    /**
+     * @brief Describes the outcome of a check
+     *
+     * @param result Results of check()
+     * @return One line per fact, the trace one input per line
+     */
+    static std::vector<std::string> describe(const EquivalenceResult& result);
+};
+
+#endif // MACHINE_EQUIVALENCE_H
@@ -33,21 +33,10 @@ public:
      * 
      * @param filename Path to the file containing the machine definition
      * @return Loaded MooreMachine object
-     * @throw std::runtime_error If loading fails or file format is invalid
+     * @throw std::runtime_error If loading fails or file format is invalid,
+     * a MachineFileError with the line and column for format errors
      */
     static MooreMachine loadFromFile(const std::string& filename);
-    
-private:
-    /**
-     * @brief Splits a string by a delimiter
-     * 
-     * Helper method used during file parsing
-     * 
-     * @param str String to split
-     * @param delimiter Character to split by
-     * @return Vector of substrings
-     */
-    static std::vector<std::string> split(const std::string& str, char delimiter);
 };
 
 #endif // MACHINE_FILE_HANDLER_H
\ No newline at end of file
@@ -0,0 +1,206 @@
+/**
+ * @file machine_file_parser.h
+ * @brief Declaration of the MachineFileParser class reading the .fsm format
+ * @author Hugo Bohácsek (xbohach00)
+ */
+
+#ifndef MACHINE_FILE_PARSER_H
+#define MACHINE_FILE_PARSER_H
+
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "moore_machine.h"
+
+/**
+ * @class MachineFileError
+ * @brief Error in a machine definition, with the place it was found at
+ *
+ * The message reads "file:line:column: description", lines and columns count from 1.
+ */
+class MachineFileError : public std::runtime_error {
+private:
+    size_t line;   /**< Line of the error */
+    size_t column; /**< Column of the error, in bytes */
+
+public:
+    /**
+     * @brief Constructor
+     *
+     * @param filename Name of the file shown in the message
+     * @param line Line of the error
+     * @param column Column of the error, in bytes
+     * @param message Description of the error
+     */
+    MachineFileError(const std::string& filename, size_t line, size_t column, const std::string& message);
+
+    /**
+     * @brief Gets the line of the error
+     *
+     * @return Line number, starting at 1
+     */
+    size_t getLine() const;
+
+    /**
+     * @brief Gets the column of the error
+     *
+     * @return Column in bytes, starting at 1
+     */
+    size_t getColumn() const;
+};
+
+/**
+ * @class MappedFile
+ * @brief Read-only view of a whole file
+ *
+ * The file is memory-mapped where the platform allows it, otherwise it is
+ * read into a buffer. The text stays valid while the object lives.
+ */
+class MappedFile {
+private:
+    const char* data;   /**< First byte of the file */
+    size_t size;        /**< Size of the file */
+    bool mapped;        /**< Whether data points to a mapping */
+    std::string buffer; /**< Contents when the file could not be mapped */
+
+public:
+    /**
+     * @brief Constructor, maps the file
+     *
+     * @param filename Path to the file
+     * @throw std::runtime_error If the file cannot be opened
+     */
+    explicit MappedFile(const std::string& filename);
+
+    /**
+     * @brief Destructor, unmaps the file
+     */
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /**
+     * @brief Gets the contents of the file
+     *
+     * @return View of the whole file
+     */
+    std::string_view getText() const;
+};
+
+/**
+ * @class MachineFileParser
+ * @brief Single-pass parser of the .fsm format
+ *
+ * Works on views of the text, nothing is copied until a name or value is
+ * stored in the machine. State names are interned, so transitions resolve
+ * their states by a hash lookup of the view instead of a scan of the machine.
+ * Lines it cannot make sense of are errors with their line and column,
+ * so a mistake in the file is never silently dropped.
+ */
+class MachineFileParser {
+private:
+    std::string_view text;   /**< Text being parsed */
+    std::string filename;    /**< Name of the file for messages */
+    size_t position;         /**< Start of the next line */
+    size_t lineNumber;       /**< Number of the current line */
+    std::string_view line;   /**< The current line without its line break */
+    std::unordered_map<std::string_view, std::string> stateIds; /**< State ID by interned state name */
+
+    /**
+     * @brief Moves to the next line
+     *
+     * @return False at the end of the text
+     */
+    bool nextLine();
+
+    /**
+     * @brief Throws an error pointing into the current line
+     *
+     * @param at Part of the current line the error is about
+     * @param message Description of the error
+     * @throw MachineFileError Always
+     */
+    [[noreturn]] void fail(std::string_view at, const std::string& message) const;
+
+    /**
+     * @brief Parses a comma separated list of the header
+     *
+     * @param list The list
+     * @return Non-empty trimmed items
+     */
+    static std::vector<std::string_view> parseList(std::string_view list);
+
+    /**
+     * @brief Parses a line of the header
+     *
+     * @param machine Machine to fill
+     * @param content The trimmed line
+     */
+    void parseHeader(MooreMachine& machine, std::string_view content);
+
+    /**
+     * @brief Parses a variable: {type} {name} = {value}
+     *
+     * @param machine Machine to fill
+     * @param content The trimmed line
+     */
+    void parseVariable(MooreMachine& machine, std::string_view content);
+
+    /**
+     * @brief Parses a state: {name}: [{output}; ...]
+     *
+     * @param machine Machine to fill
+     * @param content The trimmed line
+     * @param isInitial Whether this is the first state
+     * @return ID of the state
+     */
+    const std::string& parseState(MooreMachine& machine, std::string_view content, bool isInitial);
+
+    /**
+     * @brief Parses one output statement of a state
+     *
+     * @param state State to add the output to
+     * @param statement The trimmed statement
+     */
+    static void parseOutput(State& state, std::string_view statement);
+
+    /**
+     * @brief Parses a transition: {source}-[{condition}; ...]->{target}
+     *
+     * @param machine Machine to fill
+     * @param content The trimmed line
+     */
+    void parseTransition(MooreMachine& machine, std::string_view content);
+
+    /**
+     * @brief Looks up the ID of a state by its name
+     *
+     * @param name Trimmed name from the current line
+     * @return ID of the state
+     * @throw MachineFileError If no state has the name
+     */
+    const std::string& findState(std::string_view name) const;
+
+public:
+    /**
+     * @brief Constructor
+     *
+     * @param text Text of the machine definition, must outlive the parser
+     * @param filename Name of the file shown in error messages
+     */
+    MachineFileParser(std::string_view text, const std::string& filename);
+
+    /**
+     * @brief Parses the text into a machine
+     *
+     * @return The machine
+     * @throw MachineFileError If the text is not a valid machine definition
+     */
+    MooreMachine parse();
+};
+
+#endif // MACHINE_FILE_PARSER_H
@@ -0,0 +1,101 @@
+/**
+ * @file machine_minimizer.h
+ * @brief Declaration of the MachineMinimizer class
+ * @author Hugo Bohácsek (xbohach00)
+ */
+
+#ifndef MACHINE_MINIMIZER_H
+#define MACHINE_MINIMIZER_H
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "moore_machine.h"
+
+/**
+ * @struct MinimizationResult
+ * @brief Machine produced by the minimization pass
+ */
+struct MinimizationResult {
+    MooreMachine machine;                                   /**< The minimized machine */
+    size_t removedStates;                                   /**< Number of states merged into others */
+    std::unordered_map<std::string, std::string> mergedInto; /**< ID of the surviving state by ID of each removed one */
+};
+
+/**
+ * @class MachineMinimizer
+ * @brief Merges equivalent states of a machine by Hopcroft's partition refinement
+ *
+ * Every input pointer and value pair read by a transition is a letter. A
+ * state goes on a letter to the target of its first transition reading it
+ * and stays where it is otherwise, just like MooreMachine::processInput().
+ * States start out grouped by their outputs and the groups are split until
+ * all states of a group go to the same group on every letter, in
+ * O(k n log n) time for n states and k letters.
+ *
+ * States whose outputs read variables or evaluate expressions, states with
+ * expression guards or timed transitions, and the targets of those
+ * transitions are never merged. Equivalence is judged one input at a time;
+ * when inputs arrive on several pointers at once, the simulator may pick a
+ * different transition in the minimized machine.
+ *
+ * A firing transition clears the inputs of every pointer its conditions
+ * read, so states are only merged when they clear the same other pointers
+ * on every letter. Each group keeps one state, the initial state or else the
+ * state added first, with its ID, name, outputs and editor position. Its
+ * transitions keep their IDs, conditions and order and point to the
+ * surviving states.
+ */
+class MachineMinimizer {
+private:
+    MooreMachine& machine;       /**< The machine to minimize, only read */
+
+    std::vector<int> elements;   /**< States ordered so that each block is contiguous */
+    std::vector<int> location;   /**< Position of each state in elements */
+    std::vector<int> blockOf;    /**< Block of each state */
+    std::vector<int> blockFirst; /**< Position of the first state of each block */
+    std::vector<int> blockEnd;   /**< Position one past the last state of each block */
+    std::vector<int> blockMid;   /**< End of the marked states at the start of each block */
+    std::vector<int> touched;    /**< Blocks with marked states */
+
+    /**
+     * @brief Creates a block from the states in elements[first, end)
+     *
+     * @param first Position of the first state
+     * @param end Position one past the last state
+     * @return Index of the new block
+     */
+    int addBlock(int first, int end);
+
+    /**
+     * @brief Marks a state, moving it into the marked part of its block
+     *
+     * @param state Index of the state
+     */
+    void mark(int state);
+
+    /**
+     * @brief Splits the marked states off a block
+     *
+     * @param block Index of a block with marked states
+     * @return Index of the block of the marked states, or -1 if the whole block was marked
+     */
+    int splitMarked(int block);
+
+public:
+    /**
+     * @brief Constructor
+     *
+     * @param machine The machine to minimize, must outlive the minimizer
+     */
+    explicit MachineMinimizer(MooreMachine& machine);
+
+    /**
+     * @brief Minimizes the machine
+     *
+     * @return The minimized machine, the original is left unchanged
+     */
+    MinimizationResult run();
+};
+
+#endif // MACHINE_MINIMIZER_H
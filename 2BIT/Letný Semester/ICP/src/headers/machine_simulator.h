@@ -9,8 +9,10 @@
 
 #include <string>
 #include <chrono>
+#include <memory>
 #include <unordered_map>
 #include "moore_machine.h"
+#include "timer_queue.h"
 
 /**
  * @class MachineSimulator
@@ -28,13 +30,59 @@ private:
     std::string currentStateId;  /**< ID of the current state */
     std::chrono::time_point<std::chrono::steady_clock> lastTransitionTime; /**< Time of last state transition */
     
-    std::unordered_map<std::string, std::string> inputValues;  /**< Current input values by input pointer */
+    std::vector<std::pair<std::string, std::string>> inputs;   /**< Current input values, one slot per input pointer */
+    std::unordered_map<std::string, size_t> inputSlots;        /**< Index into inputs by input pointer */
     std::unordered_map<std::string, std::string> outputValues; /**< Current output values by output pointer */
-    std::unordered_map<std::string, std::chrono::time_point<std::chrono::steady_clock>> activeTimeouts; /**< Tracks timeouts */
 
     bool justEnteredState;  //**< Flag to indicate we just entered a state  */
-    std::unordered_map<std::string, bool> timeoutActive;  //**< Track which timeouts are active  */
-    std::unordered_map<std::string, std::chrono::time_point<std::chrono::steady_clock>> timeoutStartTimes;  //**< When each timeout started  */
+    bool settled;           /**< Transitions were evaluated since the last state entry or input */
+    TimerQueue timeouts;    /**< Armed timeouts keyed by transition index in timeoutTable */
+    std::shared_ptr<const TransitionTable> timeoutTable; /**< Table the timeout indices refer to */
+
+    /**
+     * @brief Gets the slot of an input pointer, creating an empty one on first use
+     * 
+     * @param inputPtr The input pointer name
+     * @return Reference to the value of the input
+     */
+    std::string& getInputSlot(const std::string& inputPtr);
+    
+    /**
+     * @brief Finds the value of an input pointer
+     * 
+     * @param inputPtr The input pointer name
+     * @return Pointer to the value, or nullptr if the input was never set
+     */
+    const std::string* findInput(const std::string& inputPtr) const;
+
+    /**
+     * @brief Moves to a state and processes its outputs
+     * 
+     * Cancels the timeouts of the state being left and arms the pure
+     * timeout transitions of the entered one.
+     * 
+     * @param stateId ID of the entered state
+     * @param now Time of the entry
+     */
+    void enterState(const std::string& stateId, std::chrono::steady_clock::time_point now);
+
+    /**
+     * @brief Arms the pure timeout transitions of the current state
+     * 
+     * Their deadlines are measured from the time the state was entered.
+     * Every other timeout is cancelled.
+     */
+    void armStateTimeouts();
+
+    /**
+     * @brief Gets the transition table the timeouts are keyed by
+     * 
+     * If the machine rebuilt its table since the timeouts were armed,
+     * the timeouts of the current state are armed again against the new one.
+     * 
+     * @return Reference to the current table
+     */
+    const TransitionTable& syncTimeouts();
 
 public:
     /**
@@ -51,6 +99,34 @@ public:
      * @throw std::runtime_error If the machine has no states or no initial state
      */
     void reset();
+
+    /**
+     * @brief Resets the simulation to initial state at the given time
+     * 
+     * Together with the other overloads taking a time this lets a driver
+     * run the simulation on its own, e.g. virtual, time line.
+     * 
+     * @param now Time the initial state is entered at
+     * @throw std::runtime_error If the machine has no states or no initial state
+     */
+    void reset(std::chrono::steady_clock::time_point now);
+
+    /**
+     * @brief Continues a simulation observed elsewhere
+     * 
+     * Unlike reset(), the outputs of the state are not processed again, the
+     * given inputs and outputs are taken as they are. Timeouts armed by inputs
+     * are armed again by the next step.
+     * 
+     * @param stateId ID of the current state
+     * @param enteredAt Time the state was entered, pure timeouts are measured from it
+     * @param inputs Current input values
+     * @param outputs Current output values
+     * @throw std::runtime_error If the machine has no such state
+     */
+    void restore(const std::string& stateId, std::chrono::steady_clock::time_point enteredAt,
+                 const std::vector<std::pair<std::string, std::string>>& inputs,
+                 const std::vector<std::pair<std::string, std::string>>& outputs);
     
     /**
      * @brief Sets an input value for a specific input pointer
@@ -97,9 +173,21 @@ public:
      * current input values, and if so, transitions to the target state
      * and processes outputs from that state.
      * 
+     * A step that does not change the state works on borrowed transitions,
+     * variables and input slots and does not allocate memory once every
+     * input pointer and timed transition has been seen.
+     * 
      * @throw std::runtime_error If the machine is in an invalid state
      */
     void processInputs();
+
+    /**
+     * @brief Processes current inputs at the given time
+     * 
+     * @param now Current time, must not go backwards between calls
+     * @throw std::runtime_error If the machine is in an invalid state
+     */
+    void processInputs(std::chrono::steady_clock::time_point now);
     
     /**
      * @brief Processes outputs from a state
@@ -138,6 +226,13 @@ public:
      * @return Pointer to the current state, or nullptr if not in a valid state
      */
     State* getCurrentState() const;
+
+    /**
+     * @brief Gets the time the current state was entered
+     * 
+     * @return Time of the last state entry
+     */
+    std::chrono::steady_clock::time_point getStateEntryTime() const;
     
     /**
      * @brief Checks for timeout transitions
@@ -149,6 +244,50 @@ public:
      */
     bool checkTimeouts();
 
+    /**
+     * @brief Checks for timeout transitions expired at the given time
+     * 
+     * @param now Current time
+     * @return True if a timeout transition was triggered, false otherwise
+     */
+    bool checkTimeouts(std::chrono::steady_clock::time_point now);
+
+    /**
+     * @brief Gets the time the simulation next has to be stepped
+     * 
+     * Lets a driver sleep until something can happen instead of polling.
+     * After a state entry or a new input the returned time is already due.
+     * Otherwise it is the deadline of the earliest armed timeout, or
+     * time_point::max() if nothing happens until the next input.
+     * 
+     * @return Time at which processInputs() should be called next
+     */
+    std::chrono::steady_clock::time_point nextDeadline() const;
+
+    /**
+     * @brief Waits on the machine's clock for the next pending step and makes it
+     * 
+     * On a virtual clock the wait jumps straight to the next timeout, so
+     * "while (simulator.advance(limit)) {}" replays any amount of machine
+     * time as fast as its steps can be computed.
+     * 
+     * @param limit Latest time to wait for
+     * @return True if a step was made, false if nothing is pending until limit
+     * @throw std::runtime_error If the machine is not in a valid state
+     */
+    bool advance(std::chrono::steady_clock::time_point limit = std::chrono::steady_clock::time_point::max());
+
+    /**
+     * @brief Sets the clock the simulation runs on
+     * 
+     * The simulator measures time with the clock of its machine, so this
+     * sets the machine's clock. Call reset() afterwards when switching
+     * between clocks with different time lines.
+     * 
+     * @param clock The clock, must outlive the simulator and the machine
+     */
+    void setClock(MachineClock* clock);
+
     /**
      * @brief Clears input values that triggered a transition
      * 
@@ -0,0 +1,377 @@
+/**
+ * @file machine_snapshot.h
+ * @brief Declaration of the binary snapshot format of a MooreMachine
+ * @author Hugo Bohácsek (xbohach00)
+ */
+
+#ifndef MACHINE_SNAPSHOT_H
+#define MACHINE_SNAPSHOT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include "moore_machine.h"
+#include "machine_file_parser.h"
+
+/**
+ * @namespace SnapshotFormat
+ * @brief Layout of a binary machine snapshot
+ *
+ * A snapshot is a header followed by sections, each an array of fixed-size
+ * records aligned to ALIGNMENT bytes. The header gives the offset and record
+ * count of every section, so a mapped snapshot is used in place without
+ * parsing. Integers are stored in the byte order of the machine that wrote
+ * the snapshot, BYTE_ORDER_MARK tells a reader whether it matches its own.
+ *
+ * Every string is stored once. Records refer to strings by their index in
+ * the STRINGS section, to states by their index in STATES and to runs of other
+ * records by a Range. Transitions are grouped by their source state, a state's
+ * Range points at its outgoing transitions. Output statements carry their
+ * compiled program next to the source text, so a runtime can execute them
+ * without an expression parser.
+ */
+namespace SnapshotFormat {
+    constexpr char MAGIC[4] = {'F', 'S', 'M', 'S'};  /**< First bytes of every snapshot */
+    constexpr uint32_t VERSION = 1;                  /**< Version of the layout */
+    constexpr uint32_t BYTE_ORDER_MARK = 0x01020304; /**< Reads back the same only in the writer's byte order */
+    constexpr size_t ALIGNMENT = 8;                  /**< Alignment of every section */
+
+    /**
+     * @enum Section
+     * @brief Sections of a snapshot, in the order they are written
+     */
+    enum Section : uint32_t {
+        STRINGS,      /**< StringRecord per interned string */
+        STRING_DATA,  /**< Bytes of the strings, each followed by a NUL */
+        STRING_LISTS, /**< String indices referred to by ranges of the header and of programs */
+        VARIABLES,    /**< VariableRecord per variable */
+        STATES,       /**< StateRecord per state */
+        OUTPUTS,      /**< OutputRecord per output statement of a state */
+        TRANSITIONS,  /**< TransitionRecord per transition, grouped by source state */
+        CONDITIONS,   /**< ConditionRecord per input condition of a transition */
+        INSTRUCTIONS, /**< InstructionRecord per instruction of a compiled program */
+        CONSTANTS,    /**< ConstantRecord per literal of a compiled program */
+        SECTION_COUNT /**< Number of sections */
+    };
+
+    // Bits of the flags of records, plain integers so they combine with 0 and each other
+    static constexpr uint32_t INITIAL = 0x1;            /**< StateRecord: the initial state */
+    static constexpr uint32_t HAS_CONDITION = 0x1;      /**< OutputRecord: the statement has an "if ... is defined" guard */
+    static constexpr uint32_t COMPILED_CONDITION = 0x2; /**< OutputRecord: the compiled statement checks conditionPtr */
+    static constexpr uint32_t BOOLEAN = 0x1;            /**< ConditionRecord: a comparison instead of an input */
+
+    /**
+     * @struct Range
+     * @brief Run of consecutive records of a section
+     */
+    struct Range {
+        uint32_t first; /**< Index of the first record */
+        uint32_t count; /**< Number of records */
+    };
+
+    /**
+     * @struct SectionEntry
+     * @brief Where a section is stored
+     */
+    struct SectionEntry {
+        uint64_t offset; /**< Offset from the start of the snapshot */
+        uint64_t count;  /**< Number of records */
+    };
+
+    /**
+     * @struct Header
+     * @brief Start of every snapshot
+     */
+    struct Header {
+        char magic[4];                         /**< MAGIC */
+        uint32_t version;                      /**< VERSION */
+        uint32_t byteOrder;                    /**< BYTE_ORDER_MARK as written */
+        uint32_t name;                         /**< Name of the machine */
+        uint64_t size;                         /**< Size of the whole snapshot */
+        Range inputAlphabet;                   /**< Input symbols in STRING_LISTS */
+        Range outputAlphabet;                  /**< Output symbols in STRING_LISTS */
+        Range inputPointers;                   /**< Input pointers in STRING_LISTS */
+        Range outputPointers;                  /**< Output pointers in STRING_LISTS */
+        SectionEntry sections[SECTION_COUNT];  /**< Sections by Section */
+    };
+
+    /**
+     * @struct StringRecord
+     * @brief Interned string
+     */
+    struct StringRecord {
+        uint32_t offset; /**< Offset of the first byte in STRING_DATA */
+        uint32_t length; /**< Length without the NUL */
+    };
+
+    /**
+     * @struct VariableRecord
+     * @brief Variable of the machine
+     */
+    struct VariableRecord {
+        uint32_t name;  /**< Name of the variable */
+        uint32_t type;  /**< VariableType */
+        uint32_t value; /**< Value as written in a machine file */
+    };
+
+    /**
+     * @struct StateRecord
+     * @brief State with its position in the editor
+     */
+    struct StateRecord {
+        double x;          /**< Horizontal position in the editor */
+        double y;          /**< Vertical position in the editor */
+        uint32_t id;       /**< ID of the state */
+        uint32_t name;     /**< Display name of the state */
+        Range outputs;     /**< Output statements in OUTPUTS */
+        Range transitions; /**< Outgoing transitions in TRANSITIONS */
+        uint32_t flags;    /**< INITIAL */
+        uint32_t reserved; /**< Zero */
+    };
+
+    /**
+     * @struct OutputRecord
+     * @brief Output statement of a state with its compiled form
+     */
+    struct OutputRecord {
+        uint32_t value;          /**< Source text of the statement */
+        uint32_t target;         /**< Output pointer of the statement */
+        uint32_t inputPtr;       /**< Input pointer of the guard */
+        uint32_t flags;          /**< HAS_CONDITION, COMPILED_CONDITION */
+        uint32_t action;         /**< OutputAction of the compiled statement */
+        uint32_t compiledTarget; /**< Assigned variable or output pointer */
+        uint32_t compiledSource; /**< Input pointer, value or error message, see CompiledOutput::source */
+        uint32_t conditionPtr;   /**< Input pointer the compiled guard checks */
+        Range code;              /**< Instructions in INSTRUCTIONS */
+        Range constants;         /**< Literals in CONSTANTS */
+        Range slots;             /**< Variable names in STRING_LISTS */
+        Range errors;            /**< Messages of FAIL instructions in STRING_LISTS */
+    };
+
+    /**
+     * @struct TransitionRecord
+     * @brief Transition between two states
+     */
+    struct TransitionRecord {
+        uint32_t id;      /**< ID of the transition */
+        uint32_t source;  /**< Index of the source state */
+        uint32_t target;  /**< Index of the target state */
+        int32_t timeout;  /**< Timeout in milliseconds, 0 for none */
+        Range conditions; /**< Input conditions in CONDITIONS */
+    };
+
+    /**
+     * @struct ConditionRecord
+     * @brief Input condition of a transition
+     */
+    struct ConditionRecord {
+        uint32_t flags;     /**< BOOLEAN */
+        uint32_t value;     /**< Expected input value */
+        uint32_t source;    /**< Input pointer */
+        uint32_t left;      /**< Left operand of a comparison */
+        uint32_t operation; /**< Operator of a comparison */
+        uint32_t right;     /**< Right operand of a comparison */
+    };
+
+    /**
+     * @struct InstructionRecord
+     * @brief Instruction of a compiled program, see Instruction
+     */
+    struct InstructionRecord {
+        uint8_t op;       /**< OpCode */
+        uint8_t kind;     /**< OperandKind */
+        char operation;   /**< Arithmetic operator for APPLY */
+        uint8_t reserved; /**< Zero */
+        int32_t index;    /**< Index of the operand or error message */
+    };
+
+    /**
+     * @struct ConstantRecord
+     * @brief Literal of a compiled program
+     */
+    struct ConstantRecord {
+        uint32_t type;  /**< VariableType */
+        uint32_t value; /**< Bits of an int or float, string index of a string */
+    };
+}
+
+/**
+ * @struct SnapshotSpan
+ * @brief Borrowed run of records of a mapped snapshot
+ */
+template <typename Record>
+struct SnapshotSpan {
+    const Record* first; /**< First record of the run */
+    const Record* last;  /**< One past the last record of the run */
+
+    const Record* begin() const { return first; }
+    const Record* end() const { return last; }
+    size_t size() const { return static_cast<size_t>(last - first); }
+    const Record& operator[](size_t index) const { return first[index]; }
+};
+
+/**
+ * @class SnapshotView
+ * @brief Mapped snapshot read in place
+ *
+ * The header and the bounds of every section are checked once when the
+ * snapshot is opened. Indices stored in records are checked by the
+ * accessors they are passed to, so a corrupted snapshot throws instead of
+ * reading outside the file.
+ */
+class SnapshotView {
+private:
+    MappedFile file;                       /**< The mapped snapshot */
+    const SnapshotFormat::Header* header;  /**< Header at the start of the file */
+
+    /**
+     * @brief Gets all records of a section
+     *
+     * @tparam Record Type of the records of the section
+     * @param section The section
+     * @return The records
+     */
+    template <typename Record>
+    SnapshotSpan<Record> section(SnapshotFormat::Section section) const;
+
+    /**
+     * @brief Gets a run of records of a section
+     *
+     * @tparam Record Type of the records of the section
+     * @param section The section
+     * @param range The run
+     * @return The records
+     * @throw std::runtime_error If the run does not lie in the section
+     */
+    template <typename Record>
+    SnapshotSpan<Record> slice(SnapshotFormat::Section section, SnapshotFormat::Range range) const;
+
+public:
+    /**
+     * @brief Constructor, maps the snapshot and checks its layout
+     *
+     * @param filename Path to the snapshot
+     * @throw std::runtime_error If the file cannot be opened or is not a snapshot of this version
+     */
+    explicit SnapshotView(const std::string& filename);
+
+    /**
+     * @brief Gets the header
+     *
+     * @return The header
+     */
+    const SnapshotFormat::Header& getHeader() const;
+
+    /**
+     * @brief Gets an interned string
+     *
+     * @param index Index of the string
+     * @return View of the string, valid while the view lives
+     * @throw std::runtime_error If there is no such string
+     */
+    std::string_view getString(uint32_t index) const;
+
+    /**
+     * @brief Gets a run of string indices
+     *
+     * @param range The run in STRING_LISTS
+     * @return The string indices
+     */
+    SnapshotSpan<uint32_t> getStringList(SnapshotFormat::Range range) const;
+
+    /**
+     * @brief Gets all variables
+     *
+     * @return The variables
+     */
+    SnapshotSpan<SnapshotFormat::VariableRecord> getVariables() const;
+
+    /**
+     * @brief Gets all states
+     *
+     * @return The states, indexed by state index
+     */
+    SnapshotSpan<SnapshotFormat::StateRecord> getStates() const;
+
+    /**
+     * @brief Gets the output statements of a state
+     *
+     * @param state The state
+     * @return The output statements
+     */
+    SnapshotSpan<SnapshotFormat::OutputRecord> getOutputs(const SnapshotFormat::StateRecord& state) const;
+
+    /**
+     * @brief Gets all transitions
+     *
+     * @return The transitions, grouped by source state
+     */
+    SnapshotSpan<SnapshotFormat::TransitionRecord> getTransitions() const;
+
+    /**
+     * @brief Gets the transitions leaving a state
+     *
+     * @param state The state
+     * @return The outgoing transitions
+     */
+    SnapshotSpan<SnapshotFormat::TransitionRecord> getTransitions(const SnapshotFormat::StateRecord& state) const;
+
+    /**
+     * @brief Gets the input conditions of a transition
+     *
+     * @param transition The transition
+     * @return The input conditions
+     */
+    SnapshotSpan<SnapshotFormat::ConditionRecord> getConditions(const SnapshotFormat::TransitionRecord& transition) const;
+
+    /**
+     * @brief Gets the instructions of a compiled output statement
+     *
+     * @param output The output statement
+     * @return The instructions
+     */
+    SnapshotSpan<SnapshotFormat::InstructionRecord> getInstructions(const SnapshotFormat::OutputRecord& output) const;
+
+    /**
+     * @brief Gets the literals of a compiled output statement
+     *
+     * @param output The output statement
+     * @return The literals
+     */
+    SnapshotSpan<SnapshotFormat::ConstantRecord> getConstants(const SnapshotFormat::OutputRecord& output) const;
+};
+
+/**
+ * @class MachineSnapshot
+ * @brief Saves and loads machines as binary snapshots
+ *
+ * A faster alternative to MachineFileHandler for very large machines and
+ * for shipping compiled machines to runtimes. Unlike a machine file, a
+ * snapshot keeps the positions of the states in the editor.
+ */
+class MachineSnapshot {
+public:
+    /**
+     * @brief Saves a machine as a snapshot
+     *
+     * @param machine The machine to save
+     * @param filename Path to the snapshot
+     * @return True if saving succeeded, false otherwise
+     */
+    static bool saveToFile(const MooreMachine& machine, const std::string& filename);
+
+    /**
+     * @brief Loads a machine from a snapshot
+     *
+     * The compiled output statements are taken over from the snapshot
+     * instead of being compiled again.
+     *
+     * @param filename Path to the snapshot
+     * @return Loaded MooreMachine object
+     * @throw std::runtime_error If the file cannot be read or is not a valid snapshot
+     */
+    static MooreMachine loadFromFile(const std::string& filename);
+};
+
+#endif // MACHINE_SNAPSHOT_H
@@ -0,0 +1,282 @@
+/**
+ * @file machine_trace.h
+ * @brief Declaration of the binary trace format recording a running machine
+ * @author Hugo Bohácsek (xbohach00)
+ */
+
+#ifndef MACHINE_TRACE_H
+#define MACHINE_TRACE_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "moore_machine.h"
+#include "machine_simulator.h"
+
+/**
+ * @namespace TraceFormat
+ * @brief Layout of a recorded trace
+ *
+ * A trace starts with the magic bytes "FSMT" and the version, records
+ * follow until the end of the file. A record is a type byte, the time since
+ * the previous record in microseconds and the payload. Integers are LEB128
+ * varints, so most times and references take a single byte.
+ *
+ * Strings are interned as they are written. A reference of 0 is followed by
+ * the length and bytes of a new string, which then gets the next index; a
+ * reference n > 0 stands for the string with index n - 1.
+ *
+ * RESET and INPUT records are what drove the machine, SYNC starts a trace
+ * from a machine that was already running. STATE, OUTPUT and VARIABLE
+ * records are what the machine did in response, each written only when the
+ * value changed.
+ */
+namespace TraceFormat {
+    constexpr char MAGIC[4] = {'F', 'S', 'M', 'T'}; /**< First bytes of every trace */
+    constexpr uint8_t VERSION = 1;                  /**< Version of the layout */
+
+    /**
+     * @enum RecordType
+     * @brief Types of records
+     */
+    enum RecordType : uint8_t {
+        RESET = 0x00,   /**< Simulation went back to the initial state, variables kept */
+        SYNC = 0x01,    /**< Running machine observed: state, microseconds spent in it, count of seed records */
+        INPUT = 0x02,   /**< Input set and processed: pointer, value */
+        STATE = 0x03,   /**< Current state changed: state ID */
+        OUTPUT = 0x04,  /**< Output changed: pointer, value */
+        VARIABLE = 0x05 /**< Variable changed: name, value */
+    };
+}
+
+/**
+ * @struct TraceRecord
+ * @brief One decoded record of a trace
+ *
+ * The seed records following a SYNC are INPUT, OUTPUT and VARIABLE records
+ * holding the values the machine had when it was observed.
+ */
+struct TraceRecord {
+    TraceFormat::RecordType type; /**< Type of the record */
+    long long time;               /**< Microseconds since the first record */
+    std::string name;             /**< State ID, input or output pointer or variable name */
+    std::string value;            /**< Value of the input, output or variable */
+    long long elapsed;            /**< SYNC: microseconds the machine had spent in the state */
+    size_t count;                 /**< SYNC: number of seed records that follow */
+};
+
+/**
+ * @class TraceWriter
+ * @brief Records what drives a machine and what it does into a trace file
+ *
+ * The writer works the same for the local simulator and for a remote
+ * automaton, it only needs the time each input was sent and each change was
+ * seen. Records are buffered and written in blocks.
+ */
+class TraceWriter {
+private:
+    std::ofstream file;                                            /**< The trace file */
+    std::string buffer;                                            /**< Encoded records not written yet */
+    std::unordered_map<std::string, uint64_t> strings;             /**< Index of every string written */
+    std::chrono::steady_clock::time_point origin;                  /**< Time of the first record */
+    long long lastTime;                                            /**< Time of the last record, -1 before the first */
+    size_t records;                                                /**< Number of records written */
+    std::string lastState;                                         /**< State written last */
+    std::unordered_map<std::string, std::string> lastOutputs;      /**< Output values written last */
+    std::unordered_map<std::string, std::string> lastVariables;    /**< Variable values written last */
+
+    /**
+     * @brief Starts a record
+     *
+     * @param type Type of the record
+     * @param now Time of the record, clamped so records never go back in time
+     */
+    void beginRecord(TraceFormat::RecordType type, std::chrono::steady_clock::time_point now);
+
+    /**
+     * @brief Appends a varint
+     *
+     * @param value The integer
+     */
+    void writeVarint(uint64_t value);
+
+    /**
+     * @brief Appends a string reference, and the string itself on its first use
+     *
+     * @param value The string
+     */
+    void writeString(const std::string& value);
+
+    /**
+     * @brief Writes a full buffer to the file
+     */
+    void flushIfFull();
+
+public:
+    /**
+     * @brief Constructor, creates the trace file and writes its header
+     *
+     * @param filename Path of the trace file
+     * @throw std::runtime_error If the file cannot be created
+     */
+    explicit TraceWriter(const std::string& filename);
+
+    /**
+     * @brief Destructor, writes what is left in the buffer
+     */
+    ~TraceWriter();
+
+    TraceWriter(const TraceWriter&) = delete;
+    TraceWriter& operator=(const TraceWriter&) = delete;
+
+    /**
+     * @brief Records that the simulation went back to the initial state
+     *
+     * @param now Time of the reset
+     */
+    void recordReset(std::chrono::steady_clock::time_point now);
+
+    /**
+     * @brief Records a machine that was already running when recording started
+     *
+     * @param now Time of the observation
+     * @param stateId Current state
+     * @param enteredAt Time the state was entered, now if not known
+     * @param inputs Current input values
+     * @param outputs Current output values
+     * @param variables Current variable values
+     */
+    void recordSync(std::chrono::steady_clock::time_point now, const std::string& stateId,
+                    std::chrono::steady_clock::time_point enteredAt,
+                    const std::vector<std::pair<std::string, std::string>>& inputs,
+                    const std::vector<std::pair<std::string, std::string>>& outputs,
+                    const std::vector<std::pair<std::string, std::string>>& variables);
+
+    /**
+     * @brief Records an input set and processed
+     *
+     * @param now Time of the input
+     * @param inputPtr Input pointer
+     * @param value Input value
+     */
+    void recordInput(std::chrono::steady_clock::time_point now, const std::string& inputPtr,
+                     const std::string& value);
+
+    /**
+     * @brief Records the current state, if it changed
+     *
+     * @param now Time of the change
+     * @param stateId Current state
+     */
+    void recordState(std::chrono::steady_clock::time_point now, const std::string& stateId);
+
+    /**
+     * @brief Records the value of an output, if it changed
+     *
+     * @param now Time of the change
+     * @param outputPtr Output pointer
+     * @param value Output value
+     */
+    void recordOutput(std::chrono::steady_clock::time_point now, const std::string& outputPtr,
+                      const std::string& value);
+
+    /**
+     * @brief Records the value of a variable, if it changed
+     *
+     * @param now Time of the change
+     * @param name Variable name
+     * @param value Variable value as text
+     */
+    void recordVariable(std::chrono::steady_clock::time_point now, const std::string& name,
+                        const std::string& value);
+
+    /**
+     * @brief Records the state, outputs and variables of a simulation that changed
+     *
+     * @param now Time of the observation
+     * @param simulator The simulator
+     * @param machine The machine it simulates
+     */
+    void recordChanges(std::chrono::steady_clock::time_point now, const MachineSimulator& simulator,
+                       const MooreMachine& machine);
+
+    /**
+     * @brief Records a simulation that was already running when recording started
+     *
+     * @param now Time of the observation
+     * @param simulator The simulator
+     * @param machine The machine it simulates
+     */
+    void recordSync(std::chrono::steady_clock::time_point now, const MachineSimulator& simulator,
+                    const MooreMachine& machine);
+
+    /**
+     * @brief Writes the buffered records to the file
+     *
+     * @throw std::runtime_error If writing fails
+     */
+    void flush();
+
+    /**
+     * @brief Gets the number of records written
+     *
+     * @return Number of records, seed records included
+     */
+    size_t getRecordCount() const;
+};
+
+/**
+ * @class TraceReader
+ * @brief Decodes the records of a trace file
+ *
+ * Reading past the end of the file or an unknown record type throws,
+ * so a truncated trace never yields partial records.
+ */
+class TraceReader {
+private:
+    std::string data;                 /**< Contents of the trace file */
+    size_t position;                  /**< Next byte to read */
+    std::vector<std::string> strings; /**< Strings by index */
+    long long time;                   /**< Time of the last record */
+
+    /**
+     * @brief Reads a varint
+     *
+     * @return The integer
+     * @throw std::runtime_error If the varint is truncated or too long
+     */
+    uint64_t readVarint();
+
+    /**
+     * @brief Reads a string reference, and the string itself on its first use
+     *
+     * @return The string
+     * @throw std::runtime_error If the reference is unknown or the string truncated
+     */
+    const std::string& readString();
+
+public:
+    /**
+     * @brief Constructor, reads the file and checks its header
+     *
+     * @param filename Path of the trace file
+     * @throw std::runtime_error If the file cannot be read or is not a trace
+     */
+    explicit TraceReader(const std::string& filename);
+
+    /**
+     * @brief Reads the next record
+     *
+     * @param record Where the record is stored
+     * @return False at the end of the trace
+     * @throw std::runtime_error If the record is truncated or of an unknown type
+     */
+    bool next(TraceRecord& record);
+};
+
+#endif // MACHINE_TRACE_H
@@ -12,9 +12,13 @@
 #define MACHINE_VARIABLE_H
 
 #include <string>
+#include <string_view>
 #include <variant>
 #include <stdexcept>
 #include <sstream>
+#include <cstdio>
+#include <cstring>
+#include <clocale>
 
 /**
  * @enum VariableType
@@ -131,6 +135,38 @@ public:
         return oss.str();
     }
     
+    /**
+     * @brief Get a view of the value as printed by getValueString()
+     * 
+     * Numbers are printed into the caller's buffer instead of a stream,
+     * so no memory is allocated
+     * 
+     * @param buffer Storage for a printed number
+     * @return View of the value, valid while both the variable and the buffer are
+     */
+    std::string_view getValueView(char (&buffer)[32]) const {
+        if (std::holds_alternative<std::string>(value)) {
+            return std::get<std::string>(value);
+        }
+        
+        if (std::holds_alternative<int>(value)) {
+            int length = std::snprintf(buffer, sizeof(buffer), "%d", std::get<int>(value));
+            return std::string_view(buffer, length);
+        }
+        
+        // Streams print floats like "%g" in the "C" locale, undo a localized decimal point
+        int length = std::snprintf(buffer, sizeof(buffer), "%g", static_cast<double>(std::get<float>(value)));
+        const char* point = std::localeconv()->decimal_point;
+        char* found = std::strcmp(point, ".") != 0 ? std::strstr(buffer, point) : nullptr;
+        if (found) {
+            size_t pointLength = std::strlen(point);
+            *found = '.';
+            std::memmove(found + 1, found + pointLength, std::strlen(found + pointLength) + 1);
+            length -= static_cast<int>(pointLength) - 1;
+        }
+        return std::string_view(buffer, length);
+    }
+    
     /**
      * @brief Get the raw variable value
      * 
@@ -177,20 +213,32 @@ public:
      * @throw std::runtime_error If the operation is invalid for the given types or division by zero
      */
     MachineVariable performOperation(const std::string& op, const MachineVariable& other) const {
-        MachineVariable result;
-        result.name = name;
-        result.type = type;
-        
+        MachineVariable result = *this;
+        result.applyOperation(op, other);
+        return result;
+    }
+    
+    /**
+     * @brief Perform an arithmetic operation with another variable in place
+     * 
+     * Same rules as performOperation(), but the result replaces the value of
+     * this variable, so no temporary variable has to be created
+     * 
+     * @param op The operation to perform ("+", "-", "*", "/")
+     * @param other The other variable to operate with
+     * @throw std::runtime_error If the operation is invalid for the given types or division by zero
+     */
+    void applyOperation(const std::string& op, const MachineVariable& other) {
         if (type == VariableType::INT && other.type == VariableType::INT) {
             int val1 = std::get<int>(value);
             int val2 = std::get<int>(other.value);
             
-            if (op == "+") result.value = val1 + val2;
-            else if (op == "-") result.value = val1 - val2;
-            else if (op == "*") result.value = val1 * val2;
+            if (op == "+") value = val1 + val2;
+            else if (op == "-") value = val1 - val2;
+            else if (op == "*") value = val1 * val2;
             else if (op == "/") {
                 if (val2 == 0) throw std::runtime_error("Division by zero");
-                result.value = val1 / val2;
+                value = val1 / val2;
             }
             else throw std::runtime_error("Unsupported operation: " + op);
         }
@@ -206,27 +254,47 @@ public:
                           std::get<float>(other.value) : 
                           static_cast<float>(std::get<int>(other.value));
             
-            result.type = VariableType::FLOAT;
-            
-            if (op == "+") result.value = val1 + val2;
-            else if (op == "-") result.value = val1 - val2;
-            else if (op == "*") result.value = val1 * val2;
+            if (op == "+") value = val1 + val2;
+            else if (op == "-") value = val1 - val2;
+            else if (op == "*") value = val1 * val2;
             else if (op == "/") {
                 if (val2 == 0) throw std::runtime_error("Division by zero");
-                result.value = val1 / val2;
+                value = val1 / val2;
             }
             else throw std::runtime_error("Unsupported operation: " + op);
+            
+            type = VariableType::FLOAT;
         }
         else if (type == VariableType::STRING && op == "+") {
-            std::string val1 = std::get<std::string>(value);
-            std::string val2 = other.getValueString();
-            result.value = val1 + val2;
+            if (other.type == VariableType::STRING) {
+                std::get<std::string>(value) += std::get<std::string>(other.value);
+            } else {
+                std::get<std::string>(value) += other.getValueString();
+            }
         }
         else {
             throw std::runtime_error("Incompatible types for operation " + op);
         }
-        
-        return result;
+    }
+    
+    /**
+     * @brief Turn the variable into an integer holding the given value
+     * 
+     * @param intValue The new value
+     */
+    void setIntValue(int intValue) {
+        type = VariableType::INT;
+        value = intValue;
+    }
+    
+    /**
+     * @brief Turn the variable into a float holding the given value
+     * 
+     * @param floatValue The new value
+     */
+    void setFloatValue(float floatValue) {
+        type = VariableType::FLOAT;
+        value = floatValue;
     }
     
     /**
@@ -7,16 +7,30 @@
 #ifndef MOORE_MACHINE_H
 #define MOORE_MACHINE_H
 
+#include <cstdint>
 #include <string>
 #include <unordered_map>
 #include <vector>
 #include <set>
 #include <chrono>
+#include <memory>
 #include "state.h"
 #include "transition.h"
+#include "transition_table.h"
+#include "handle_index.h"
+#include "slot_pool.h"
+#include "machine_clock.h"
 #include "../headers/machine_variable.h"
 #include "../headers/expression_parser.h"
 
+struct MinimizationResult;
+
+/** Handle of a state, stays the same until the state is removed */
+using StateHandle = uint32_t;
+
+/** Handle of a transition, stays the same until the transition is removed */
+using TransitionHandle = uint32_t;
+
 /**
  * @class MooreMachine
  * @brief Represents a Moore finite state machine
@@ -27,21 +41,90 @@
  * - Variables and expressions
  * - Timeouts
  * - Validation
+ *
+ * States and transitions are kept in slot pools and addressed by handles,
+ * their positions in the pools. IDs and state names are interned into
+ * handles by hash indexes, and every state lists the handles of the
+ * transitions leaving and entering it. The string API looks the handle up
+ * once, callers that keep handles skip hashing altogether. Slots of removed
+ * states and transitions are reused by later additions. The pools never
+ * move a slot, so pointers returned by getState() and getTransition() stay
+ * valid until that state or transition is removed, the same as when they
+ * were allocated one by one.
  */
 class MooreMachine {
+public:
+    static constexpr uint32_t NO_HANDLE = HandleIndex::NONE; /**< Handle returned for unknown IDs */
+
 private:
+    /**
+     * @struct StateSlot
+     * @brief Storage of a state with its adjacency lists
+     */
+    struct StateSlot {
+        State state;                            /**< The state */
+        std::vector<TransitionHandle> outgoing; /**< Transitions leaving the state, in the order they were added */
+        std::vector<TransitionHandle> incoming; /**< Transitions entering the state, in no particular order */
+        bool live;                              /**< False once the state is removed */
+    };
+
+    /**
+     * @struct TransitionSlot
+     * @brief Storage of a transition with the handles of its states
+     */
+    struct TransitionSlot {
+        Transition transition; /**< The transition */
+        StateHandle source;    /**< Handle of the source state */
+        StateHandle target;    /**< Handle of the target state */
+        uint32_t incomingIndex; /**< Position in the incoming list of the target state */
+        bool live;             /**< False once the transition is removed */
+    };
+
     std::string name;                                      /**< Name of the machine */
-    std::unordered_map<std::string, State> states;         /**< States indexed by ID */
-    std::unordered_map<std::string, Transition> transitions; /**< Transitions indexed by ID */
+    SlotPool<StateSlot> stateSlots;                        /**< States by handle, never moved */
+    SlotPool<TransitionSlot> transitionSlots;              /**< Transitions by handle, never moved */
+    std::vector<StateHandle> freeStates;                   /**< Slots of removed states */
+    std::vector<TransitionHandle> freeTransitions;         /**< Slots of removed transitions */
+    HandleIndex stateIndex;                                /**< State handles by ID */
+    HandleIndex stateNameIndex;                            /**< State handles by name, checked on use */
+    HandleIndex transitionIndex;                           /**< Transition handles by ID */
     std::set<std::string> inputAlphabet;                   /**< Set of valid input symbols */
     std::set<std::string> outputAlphabet;                  /**< Set of valid output symbols */
     std::set<std::string> inputPointers;                   /**< Set of input pointers */
     std::set<std::string> outputPointers;                  /**< Set of output pointers */
     std::unordered_map<std::string, MachineVariable> variables; /**< Variables indexed by name */
     std::string currentStateId;                            /**< Current state ID for simulation */
+    MachineClock* clock;                                   /**< Clock time is measured with, not owned */
     std::chrono::time_point<std::chrono::steady_clock> stateEntryTime; /**< Time when entered current state */
     ExpressionParser expressionParser;                     /**< Parser for expressions */
     std::unordered_map<std::string, std::string> initialVariableValues; //**< Store initial values for later reset */
+    std::shared_ptr<TransitionTable> transitionTable;      /**< Compiled transitions, built on demand */
+    std::unordered_map<std::string, ExpressionProgram> expressionPrograms; /**< Compiled expressions by source text */
+    std::unordered_map<std::string, CompiledOutput> outputExpressions;      /**< Compiled output expressions by source text */
+    std::unordered_map<std::string, std::vector<CompiledOutput>> stateOutputs; /**< Compiled state outputs by state ID */
+
+    /**
+     * @brief Follows a transition from the current state using the compiled table
+     *
+     * @param input Input symbol to process
+     * @param inputPtr Input pointer the symbol arrived on
+     * @return Output produced by the new state
+     */
+    std::string stepOnPointer(const std::string& input, const std::string& inputPtr);
+
+    /**
+     * @brief Makes all compiled expressions resolve their variables again
+     *
+     * Called whenever a variable is added or removed.
+     */
+    void unbindExpressions();
+
+    /**
+     * @brief Removes a transition by handle
+     *
+     * @param handle Handle of a live transition
+     */
+    void eraseTransition(TransitionHandle handle);
 
 public:
     /**
@@ -80,6 +163,9 @@ public:
     /**
      * @brief Gets a state by name
      * 
+     * Looked up in an index of names. A state renamed through the pointer
+     * returned by getState() is found by a scan of all states instead.
+     * 
      * @param name Name of the state to get
      * @return Pointer to the state, or nullptr if not found
      */
@@ -111,9 +197,38 @@ public:
      * @brief Adds a transition to the machine
      * 
      * @param transition The transition to add
+     * @param position Position among the transitions leaving the source state, the end by default
      * @return True if successful, false if a transition with the same ID already exists
      */
-    bool addTransition(const Transition& transition);
+    bool addTransition(const Transition& transition, size_t position = SIZE_MAX);
+
+    /**
+     * @brief Gets the position of a transition among the transitions leaving its source state
+     * 
+     * @param transitionId ID of the transition
+     * @return Position in the order the transitions are tried, SIZE_MAX if not found
+     */
+    size_t getOutgoingPosition(const std::string& transitionId) const;
+
+    /**
+     * @brief Gets the transitions leaving and entering a state with their positions
+     * 
+     * Reads the adjacency lists, the compiled table is not built. A loop is listed once.
+     * 
+     * @param stateId ID of the state
+     * @return Transitions paired with their positions among the transitions leaving their source states
+     */
+    std::vector<std::pair<Transition*, size_t>> getIncidentTransitions(const std::string& stateId);
+
+    /**
+     * @brief Reserves room for transitions about to be added
+     * 
+     * Loaders that know the size of a machine up front avoid rehashing
+     * the transition index.
+     * 
+     * @param count Expected number of transitions
+     */
+    void reserveTransitions(size_t count);
     
     /**
      * @brief Removes a transition from the machine
@@ -139,6 +254,14 @@ public:
      */
     std::vector<Transition*> getTransitionsFromState(const std::string& stateId);
     
+    /**
+     * @brief Gets the transitions from a state without copying them
+     * 
+     * @param stateId ID of the source state
+     * @return Range of transitions borrowed from the compiled table, valid until the machine is modified
+     */
+    TransitionSpan getOutgoingTransitions(const std::string& stateId);
+    
     /**
      * @brief Gets all transitions to a state
      * 
@@ -146,6 +269,122 @@ public:
      * @return Vector of pointers to transitions to the state
      */
     std::vector<Transition*> getTransitionsToState(const std::string& stateId);
+
+    /**
+     * @brief Gets the handle of a state
+     * 
+     * @param stateId ID of the state
+     * @return Handle of the state, or NO_HANDLE if not found
+     */
+    StateHandle getStateHandle(const std::string& stateId) const;
+
+    /**
+     * @brief Gets a state by handle
+     * 
+     * @param handle Handle of the state
+     * @return Pointer to the state, or nullptr if the handle is not live
+     */
+    State* getState(StateHandle handle);
+
+    /**
+     * @brief Gets the handles of all states
+     * 
+     * @return Handles in the order of getAllStates()
+     */
+    std::vector<StateHandle> getStateHandles() const;
+
+    /**
+     * @brief Gets the bound of state handles
+     * 
+     * Every state handle is below the bound, so arrays indexed by handle can be sized by it.
+     * 
+     * @return One more than the largest state handle in use
+     */
+    size_t getStateHandleBound() const;
+
+    /**
+     * @brief Gets the handle of a transition
+     * 
+     * @param transitionId ID of the transition
+     * @return Handle of the transition, or NO_HANDLE if not found
+     */
+    TransitionHandle getTransitionHandle(const std::string& transitionId) const;
+
+    /**
+     * @brief Gets a transition by handle
+     * 
+     * @param handle Handle of the transition
+     * @return Pointer to the transition, or nullptr if the handle is not live
+     */
+    Transition* getTransition(TransitionHandle handle);
+
+    /**
+     * @brief Gets the bound of transition handles
+     * 
+     * @return One more than the largest transition handle in use
+     */
+    size_t getTransitionHandleBound() const;
+
+    /**
+     * @brief Gets the handle of the source state of a transition
+     * 
+     * @param handle Handle of a live transition
+     * @return Handle of the source state
+     */
+    StateHandle getSourceHandle(TransitionHandle handle) const;
+
+    /**
+     * @brief Gets the handle of the target state of a transition
+     * 
+     * @param handle Handle of a live transition
+     * @return Handle of the target state
+     */
+    StateHandle getTargetHandle(TransitionHandle handle) const;
+
+    /**
+     * @brief Gets the transitions leaving a state
+     * 
+     * @param handle Handle of a live state
+     * @return Handles of the transitions, in the order they were added
+     */
+    const std::vector<TransitionHandle>& getOutgoingHandles(StateHandle handle) const;
+
+    /**
+     * @brief Gets the transitions entering a state
+     * 
+     * @param handle Handle of a live state
+     * @return Handles of the transitions, in no particular order
+     */
+    const std::vector<TransitionHandle>& getIncomingHandles(StateHandle handle) const;
+
+    /**
+     * @brief Gets the compiled transition table of the machine
+     *
+     * The table is rebuilt lazily after states or transitions are added or removed.
+     * It refers to the machine's transitions, so it must not be used after the
+     * machine is modified or destroyed.
+     *
+     * @return Shared pointer to the compiled table
+     */
+    std::shared_ptr<const TransitionTable> getTransitionTable();
+
+    /**
+     * @brief Gets the compiled transition table, rebuilding it if it is stale
+     *
+     * Cheaper than getTransitionTable() for callers that only need to check
+     * whether the table was rebuilt since they last looked at it.
+     * A table inherited from another machine by copying is treated as stale.
+     *
+     * @return Reference to the compiled table
+     */
+    const TransitionTable& getCompiledTransitions();
+
+    /**
+     * @brief Drops the compiled transition table
+     *
+     * Must be called after a transition obtained by getTransition() is modified in place.
+     */
+    void invalidateTransitionTable();
     
     /**
      * @brief Adds an input symbol to the alphabet
@@ -281,9 +520,26 @@ public:
      */
     std::unordered_map<std::string, MachineVariable> getVariables() const;
     
+    /**
+     * @brief Gets all variables without copying them
+     * 
+     * @return Reference to the map of variables indexed by name
+     */
+    const std::unordered_map<std::string, MachineVariable>& getVariablesView() const;
+
+    /**
+     * @brief Gets the value a variable is reset to
+     * 
+     * @param name Name of the variable
+     * @return The initial value, empty if the variable doesn't exist
+     */
+    std::string getInitialVariableValue(const std::string& name) const;
+    
     /**
      * @brief Evaluates an expression
      * 
+     * The expression is compiled once and the program is reused by later calls.
+     * 
      * @param expression The expression to evaluate
      * @param elapsedTime Current elapsed time in milliseconds
      * @return Result of the evaluation
@@ -298,6 +554,36 @@ public:
      * @return Pair of output pointer and value
      */
     std::pair<std::string, std::string> parseOutputExpression(const std::string& expression, int elapsedTime);
+
+    /**
+     * @brief Runs a compiled expression against the machine's variables
+     * 
+     * @param program The compiled expression
+     * @param elapsedTime Current elapsed time in milliseconds
+     * @return Result of the evaluation, valid until the program runs again
+     */
+    const MachineVariable& evaluateProgram(ExpressionProgram& program, int elapsedTime);
+    
+    /**
+     * @brief Gets the compiled output statements of a state
+     * 
+     * The statements are compiled on first use and kept until the state is removed.
+     * 
+     * @param stateId ID of the state
+     * @return Compiled statements in the order of the state's outputs
+     */
+    std::vector<CompiledOutput>& getCompiledOutputs(const std::string& stateId);
+
+    /**
+     * @brief Sets the compiled output statements of a state
+     * 
+     * Used by loaders that stored the statements already compiled.
+     * They are kept until the state is removed or replaced.
+     * 
+     * @param stateId ID of the state
+     * @param outputs Compiled statements in the order of the state's outputs
+     */
+    void setCompiledOutputs(const std::string& stateId, std::vector<CompiledOutput> outputs);
     
     /**
      * @brief Checks if the machine is valid
@@ -316,6 +602,15 @@ public:
      */
     std::vector<std::string> getValidationErrors() const;
     
+    /**
+     * @brief Merges equivalent states into a new machine
+     * 
+     * See MachineMinimizer for which states are considered equivalent.
+     * 
+     * @return The minimized machine and the states merged away, this machine is left unchanged
+     */
+    MinimizationResult minimize();
+    
     /**
      * @brief Processes an input through the machine
      * 
@@ -338,6 +633,23 @@ public:
      * @return Time in milliseconds since entering the current state
      */
     int getElapsedTimeInState() const;
+
+    /**
+     * @brief Sets the clock the machine measures time with
+     * 
+     * The system clock is used by default. Copies of the machine share the clock.
+     * Restarts the time spent in the current state.
+     * 
+     * @param clock The clock, must outlive the machine
+     */
+    void setClock(MachineClock* clock);
+
+    /**
+     * @brief Gets the clock the machine measures time with
+     * 
+     * @return Pointer to the clock
+     */
+    MachineClock* getClock() const;
     
     /**
      * @brief Gets the name of the machine
@@ -0,0 +1,173 @@
+/**
+ * @file scene_model.h
+ * @brief Declaration of the SceneModel class
+ * @author Hugo Bohácsek (xbohach00)
+ */
+
+#ifndef SCENE_MODEL_H
+#define SCENE_MODEL_H
+
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "moore_machine.h"
+#include "point.h"
+#include "state.h"
+#include "transition.h"
+
+/**
+ * @struct SceneState
+ * @brief How a state is drawn in the editor
+ */
+struct SceneState {
+    std::string name;       /**< Name shown in the ellipse */
+    Point position;         /**< Top left corner, in whole scene pixels */
+    bool isInitial = false; /**< Whether the initial mark is shown */
+    bool isFinal = false;   /**< Whether the final mark is shown */
+
+    /**
+     * @brief Compares two drawings of a state
+     *
+     * @param other The other drawing
+     * @return True if nothing differs
+     */
+    bool operator==(const SceneState& other) const;
+};
+
+/**
+ * @struct SceneTransition
+ * @brief How a transition is drawn in the editor
+ */
+struct SceneTransition {
+    std::string sourceId;   /**< ID of the state the line starts at */
+    std::string targetId;   /**< ID of the state the line ends at */
+    std::string label;      /**< Label with the input conditions, in UTF-8 */
+    bool isBoolean = false; /**< Whether the transition uses a boolean input condition */
+};
+
+/**
+ * @struct SceneChanges
+ * @brief Differences between the drawn scene and the machine, as IDs
+ *
+ * A transition moved to other states is both removed and added, its line
+ * has to be built for the new states.
+ */
+struct SceneChanges {
+    std::vector<std::string> addedStates;         /**< States of the machine not drawn */
+    std::vector<std::string> changedStates;       /**< States drawn with another name, mark or position */
+    std::vector<std::string> removedStates;       /**< States drawn but no longer in the machine */
+    std::vector<std::string> addedTransitions;    /**< Transitions of the machine not drawn */
+    std::vector<std::string> changedTransitions;  /**< Transitions drawn with another label or kind of condition */
+    std::vector<std::string> removedTransitions;  /**< Transitions drawn but no longer in the machine */
+
+    /**
+     * @brief Gets the number of changes
+     *
+     * @return Number of states and transitions to add, change or remove
+     */
+    size_t size() const;
+};
+
+/**
+ * @class SceneModel
+ * @brief What the editor scene shows, kept to find the few items an update has to touch
+ *
+ * The editor records every item it creates, changes or removes here. Comparing
+ * the model with the machine gives only the differences, so the scene is never
+ * rebuilt and an update of an unchanged machine touches no items at all.
+ * Nothing here depends on Qt, the editor turns the changes into graphics items.
+ */
+class SceneModel {
+private:
+    std::unordered_map<std::string, SceneState> states;           /**< Drawn states by ID */
+    std::unordered_map<std::string, SceneTransition> transitions; /**< Drawn transitions by ID */
+
+public:
+    /**
+     * @brief Gets the label of a transition, its input symbols and timeout
+     *
+     * @param transition The transition
+     * @return The label in UTF-8
+     */
+    static std::string transitionLabel(const Transition& transition);
+
+    /**
+     * @brief Gets how a state of the machine is drawn
+     *
+     * @param state The state
+     * @return Its drawing
+     */
+    static SceneState describeState(const State& state);
+
+    /**
+     * @brief Gets how a transition of the machine is drawn
+     *
+     * @param transition The transition
+     * @return Its drawing
+     */
+    static SceneTransition describeTransition(const Transition& transition);
+
+    /**
+     * @brief Finds what differs between the scene and the machine, the model is not changed
+     *
+     * @param machine The machine
+     * @return The differences
+     */
+    SceneChanges compare(MooreMachine& machine) const;
+
+    /**
+     * @brief Records a state as drawn
+     *
+     * @param stateId ID of the state
+     * @param state Its drawing
+     */
+    void setState(const std::string& stateId, const SceneState& state);
+
+    /**
+     * @brief Records a state is no longer drawn
+     *
+     * @param stateId ID of the state
+     * @return True if the state was drawn
+     */
+    bool removeState(const std::string& stateId);
+
+    /**
+     * @brief Records a transition as drawn
+     *
+     * @param transitionId ID of the transition
+     * @param transition Its drawing
+     */
+    void setTransition(const std::string& transitionId, const SceneTransition& transition);
+
+    /**
+     * @brief Records a transition is no longer drawn
+     *
+     * @param transitionId ID of the transition
+     * @return True if the transition was drawn
+     */
+    bool removeTransition(const std::string& transitionId);
+
+    /**
+     * @brief Gets how a state is drawn
+     *
+     * @param stateId ID of the state
+     * @return Its drawing, nullptr if it is not drawn
+     */
+    const SceneState* getState(const std::string& stateId) const;
+
+    /**
+     * @brief Gets how a transition is drawn
+     *
+     * @param transitionId ID of the transition
+     * @return Its drawing, nullptr if it is not drawn
+     */
+    const SceneTransition* getTransition(const std::string& transitionId) const;
+
+    /**
+     * @brief Records the scene was cleared
+     */
+    void clear();
+};
+
+#endif // SCENE_MODEL_H
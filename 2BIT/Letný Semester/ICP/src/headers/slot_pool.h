@@ -0,0 +1,182 @@
+/**
+ * @file slot_pool.h
+ * @brief Declaration of the SlotPool class storing objects that never move
+ * @author Hugo Bohácsek (xbohach00)
+ */
+
+#ifndef SLOT_POOL_H
+#define SLOT_POOL_H
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+/**
+ * @class SlotPool
+ * @brief Sequence of objects addressed by position, kept in fixed size chunks
+ *
+ * A chunk is allocated once with room for CHUNK_SIZE objects and is never
+ * reallocated, so growing the pool moves no object and pointers to them stay
+ * valid. Objects of a chunk are contiguous, so walking the pool in order is
+ * almost as cheap as walking a vector, and finding an object by position is
+ * a shift and a mask.
+ *
+ * @tparam T Type of the objects
+ */
+template <typename T>
+class SlotPool {
+public:
+    static constexpr size_t CHUNK_BITS = 8;                /**< Objects per chunk as a power of two */
+    static constexpr size_t CHUNK_SIZE = 1 << CHUNK_BITS;  /**< Objects per chunk */
+
+private:
+    std::vector<std::vector<T>> chunks; /**< Chunks, all of them full except the last one */
+    size_t count;                       /**< Number of objects */
+
+    /**
+     * @brief Copies the objects of another pool, the chunks keep their full room
+     *
+     * @param other The pool to copy
+     */
+    void copyFrom(const SlotPool& other) {
+        chunks.clear();
+        for (const std::vector<T>& chunk : other.chunks) {
+            chunks.emplace_back();
+            chunks.back().reserve(CHUNK_SIZE);
+            chunks.back().insert(chunks.back().end(), chunk.begin(), chunk.end());
+        }
+        count = other.count;
+    }
+
+public:
+    /**
+     * @class Iterator
+     * @brief Walks the objects of a pool in order of position
+     *
+     * @tparam Pool SlotPool or const SlotPool
+     * @tparam Value T or const T
+     */
+    template <typename Pool, typename Value>
+    class Iterator {
+    private:
+        Pool* pool;      /**< The pool walked */
+        size_t position; /**< Position of the current object */
+
+    public:
+        /**
+         * @brief Constructor
+         *
+         * @param pool The pool walked
+         * @param position Position of the current object
+         */
+        Iterator(Pool* pool, size_t position) : pool(pool), position(position) {}
+
+        Value& operator*() const { return (*pool)[position]; }
+        Value* operator->() const { return &(*pool)[position]; }
+        Iterator& operator++() { position++; return *this; }
+        bool operator==(const Iterator& other) const { return position == other.position; }
+        bool operator!=(const Iterator& other) const { return position != other.position; }
+    };
+
+    using iterator = Iterator<SlotPool, T>;
+    using const_iterator = Iterator<const SlotPool, const T>;
+
+    /**
+     * @brief Constructor, creates an empty pool
+     */
+    SlotPool() : count(0) {}
+
+    /**
+     * @brief Copy constructor
+     *
+     * @param other The pool to copy
+     */
+    SlotPool(const SlotPool& other) : count(0) { copyFrom(other); }
+
+    /**
+     * @brief Move constructor, the objects keep their addresses
+     *
+     * @param other The pool to move from, left empty
+     */
+    SlotPool(SlotPool&& other) noexcept : chunks(std::move(other.chunks)), count(other.count) {
+        other.chunks.clear();
+        other.count = 0;
+    }
+
+    /**
+     * @brief Copy assignment
+     *
+     * @param other The pool to copy
+     * @return This pool
+     */
+    SlotPool& operator=(const SlotPool& other) {
+        if (this != &other) {
+            copyFrom(other);
+        }
+        return *this;
+    }
+
+    /**
+     * @brief Move assignment, the objects keep their addresses
+     *
+     * @param other The pool to move from, left empty
+     * @return This pool
+     */
+    SlotPool& operator=(SlotPool&& other) noexcept {
+        chunks = std::move(other.chunks);
+        count = other.count;
+        other.chunks.clear();
+        other.count = 0;
+        return *this;
+    }
+
+    /**
+     * @brief Gets an object
+     *
+     * @param position Position of the object, less than size()
+     * @return The object
+     */
+    T& operator[](size_t position) {
+        return chunks[position >> CHUNK_BITS][position & (CHUNK_SIZE - 1)];
+    }
+
+    /**
+     * @brief Gets an object
+     *
+     * @param position Position of the object, less than size()
+     * @return The object
+     */
+    const T& operator[](size_t position) const {
+        return chunks[position >> CHUNK_BITS][position & (CHUNK_SIZE - 1)];
+    }
+
+    /**
+     * @brief Adds an object at the end, no other object moves
+     *
+     * @param value The object
+     */
+    void push_back(T value) {
+        if ((count & (CHUNK_SIZE - 1)) == 0) {
+            chunks.emplace_back();
+            chunks.back().reserve(CHUNK_SIZE);
+        }
+        chunks.back().push_back(std::move(value));
+        count++;
+    }
+
+    /**
+     * @brief Gets the number of objects
+     *
+     * @return Number of objects in the pool
+     */
+    size_t size() const {
+        return count;
+    }
+
+    iterator begin() { return iterator(this, 0); }
+    iterator end() { return iterator(this, count); }
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, count); }
+};
+
+#endif // SLOT_POOL_H
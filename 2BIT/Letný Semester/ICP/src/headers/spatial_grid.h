@@ -0,0 +1,138 @@
+/**
+ * @file spatial_grid.h
+ * @brief Declaration of the SpatialGrid class
+ * @author Hugo Bohácsek (xbohach00)
+ */
+
+#ifndef SPATIAL_GRID_H
+#define SPATIAL_GRID_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "point.h"
+
+/**
+ * @class SpatialGrid
+ * @brief Uniform grid of boxes, such as the states of a diagram, looked up by area
+ *
+ * Every box is kept in the one cell holding its top left corner, so moving
+ * a box touches at most two cells. A query widens the area by the largest
+ * box added so far to catch boxes reaching into it from the neighbouring
+ * cells, which keeps it proportional to the boxes near the area instead of
+ * to all of them.
+ */
+class SpatialGrid {
+public:
+    static constexpr double DEFAULT_CELL_SIZE = 256; /**< Default edge of a cell, a few states of the editor */
+
+private:
+    /**
+     * @struct Entry
+     * @brief Box stored in the grid
+     */
+    struct Entry {
+        std::string id; /**< ID of the box */
+        Point min;      /**< Top left corner */
+        Point max;      /**< Bottom right corner */
+        uint64_t cell;  /**< Key of the cell holding the box */
+    };
+
+    double cellSize;                                             /**< Edge of a cell */
+    double maxWidth;                                             /**< Width of the widest box added */
+    double maxHeight;                                            /**< Height of the highest box added */
+    std::vector<Entry> entries;                                  /**< Boxes, removed ones are replaced by the last one */
+    std::unordered_map<std::string, uint32_t> index;             /**< Position of each box in entries by ID */
+    std::unordered_map<uint64_t, std::vector<uint32_t>> cells;   /**< Positions of the boxes in each non-empty cell */
+
+    /**
+     * @brief Gets the coordinate of the cell holding a coordinate
+     *
+     * @param coordinate X or Y coordinate
+     * @return Column or row of the cell
+     */
+    int32_t cellOf(double coordinate) const;
+
+    /**
+     * @brief Gets the key of a cell
+     *
+     * @param column Column of the cell
+     * @param row Row of the cell
+     * @return Key of the cell in cells
+     */
+    static uint64_t cellKey(int32_t column, int32_t row);
+
+    /**
+     * @brief Removes a box from the list of its cell
+     *
+     * @param position Position of the box in entries
+     */
+    void unlink(uint32_t position);
+
+    /**
+     * @brief Adds a box to the list of the cell holding its top left corner
+     *
+     * @param position Position of the box in entries
+     */
+    void link(uint32_t position);
+
+public:
+    /**
+     * @brief Constructor
+     *
+     * @param cellSize Edge of a cell, best a few times the size of a box
+     */
+    explicit SpatialGrid(double cellSize = DEFAULT_CELL_SIZE);
+
+    /**
+     * @brief Adds a box, or moves it if the ID is already in the grid
+     *
+     * @param id ID of the box
+     * @param min Top left corner
+     * @param max Bottom right corner
+     */
+    void insert(const std::string& id, const Point& min, const Point& max);
+
+    /**
+     * @brief Moves a box
+     *
+     * @param id ID of the box
+     * @param min New top left corner
+     * @param max New bottom right corner
+     * @return True if the box was moved, false if it is not in the grid
+     */
+    bool move(const std::string& id, const Point& min, const Point& max);
+
+    /**
+     * @brief Removes a box
+     *
+     * @param id ID of the box
+     * @return True if the box was removed, false if it is not in the grid
+     */
+    bool remove(const std::string& id);
+
+    /**
+     * @brief Finds the boxes overlapping an area
+     *
+     * @param min Top left corner of the area
+     * @param max Bottom right corner of the area
+     * @return IDs of the boxes, in no particular order
+     */
+    std::vector<std::string> query(const Point& min, const Point& max) const;
+
+    /**
+     * @brief Removes all boxes
+     */
+    void clear();
+
+    /**
+     * @brief Gets the number of boxes
+     *
+     * @return Number of boxes in the grid
+     */
+    size_t size() const;
+};
+
+#endif // SPATIAL_GRID_H
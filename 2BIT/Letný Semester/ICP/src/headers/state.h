@@ -81,14 +81,14 @@ public:
      * 
      * @return The state ID
      */
-    std::string getId() const;
+    const std::string& getId() const;
     
     /**
      * @brief Gets the state name
      * 
      * @return The state name
      */
-    std::string getName() const;
+    const std::string& getName() const;
     
     /**
      * @brief Gets the state output (legacy)
@@ -102,7 +102,7 @@ public:
      * 
      * @return Vector of output conditions
      */
-    std::vector<OutputCondition> getOutputs() const;
+    const std::vector<OutputCondition>& getOutputs() const;
     
     /**
      * @brief Checks if this is the initial state
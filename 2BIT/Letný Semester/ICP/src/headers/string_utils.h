@@ -8,6 +8,7 @@
 #define STRING_UTILS_H
 
 #include <string>
+#include <string_view>
 #include <algorithm>
 
 /**
@@ -33,4 +34,32 @@ inline std::string trim(const std::string& str) {
     return std::string(start, end + 1);
 }
 
+/**
+ * @brief Checks whether a character is whitespace, like std::isspace in the C locale
+ * 
+ * @param c Character to check, may be any byte
+ * @return True for spaces, tabs and line breaks
+ */
+inline bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+}
+
+/**
+ * @brief Trims whitespace from both ends of a view without copying
+ * 
+ * @param str View to trim
+ * @return View of the trimmed part
+ */
+inline std::string_view trimView(std::string_view str) {
+    size_t start = 0;
+    while (start < str.size() && isSpace(str[start])) {
+        start++;
+    }
+    size_t end = str.size();
+    while (end > start && isSpace(str[end - 1])) {
+        end--;
+    }
+    return str.substr(start, end - start);
+}
+
 #endif // STRING_UTILS_H
\ No newline at end of file
@@ -0,0 +1,124 @@
+/**
+ * @file timer_queue.h
+ * @brief Declaration of the TimerQueue class
+ * @author Hugo Bohácsek (xbohach00)
+ */
+
+#ifndef TIMER_QUEUE_H
+#define TIMER_QUEUE_H
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @class TimerQueue
+ * @brief Min-heap of deadlines for a fixed set of numbered timers
+ *
+ * Timers are identified by dense integers, the simulator uses the index of
+ * a transition in its TransitionTable. Cancelling a timer only bumps its
+ * generation, stale heap entries are skipped once they reach the top, so
+ * arming and cancelling never search the heap.
+ */
+class TimerQueue {
+public:
+    using TimePoint = std::chrono::steady_clock::time_point;
+
+    static constexpr int NONE = -1; /**< Returned by popExpired when no timer has expired */
+
+private:
+    /**
+     * @struct Entry
+     * @brief Deadline of one arming of a timer
+     */
+    struct Entry {
+        TimePoint deadline;  /**< When the timer expires */
+        uint32_t generation; /**< Generation of the timer when it was armed */
+        int timer;           /**< Index of the timer */
+    };
+
+    std::vector<Entry> heap;            /**< Armed deadlines, earliest on top, may contain cancelled entries */
+    std::vector<uint32_t> generations;  /**< Current generation of each timer */
+    std::vector<bool> armed;            /**< Whether each timer is armed */
+    int armedCount;                     /**< Number of armed timers */
+
+    /**
+     * @brief Heap ordering, puts the earliest deadline on top
+     */
+    static bool later(const Entry& a, const Entry& b);
+
+    /**
+     * @brief Checks whether a heap entry still belongs to an armed timer
+     */
+    bool isCurrent(const Entry& entry) const;
+
+    /**
+     * @brief Pops cancelled entries off the top of the heap
+     */
+    void dropCancelled();
+
+public:
+    /**
+     * @brief Default constructor, creates a queue with no timers
+     */
+    TimerQueue();
+
+    /**
+     * @brief Sets the number of timers and cancels all of them
+     *
+     * @param timerCount Number of timers, valid indices are 0 to timerCount - 1
+     */
+    void resize(int timerCount);
+
+    /**
+     * @brief Arms a timer, replacing its previous deadline
+     *
+     * @param timer Index of the timer
+     * @param deadline When the timer expires
+     */
+    void arm(int timer, TimePoint deadline);
+
+    /**
+     * @brief Cancels a timer, does nothing if it is not armed
+     *
+     * @param timer Index of the timer
+     */
+    void cancel(int timer);
+
+    /**
+     * @brief Cancels all timers
+     */
+    void clear();
+
+    /**
+     * @brief Checks whether a timer is armed
+     *
+     * @param timer Index of the timer
+     * @return True if the timer is armed
+     */
+    bool isArmed(int timer) const;
+
+    /**
+     * @brief Checks whether any timer is armed
+     *
+     * @return True if no timer is armed
+     */
+    bool empty() const;
+
+    /**
+     * @brief Gets the earliest deadline
+     *
+     * @return Deadline of the first timer to expire, or TimePoint::max() if none is armed
+     */
+    TimePoint nextDeadline() const;
+
+    /**
+     * @brief Disarms and returns the first timer that expired
+     *
+     * @param now Current time
+     * @return Index of the timer with the earliest deadline not after now, or NONE
+     */
+    int popExpired(TimePoint now);
+};
+
+#endif // TIMER_QUEUE_H
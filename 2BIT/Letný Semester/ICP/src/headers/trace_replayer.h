@@ -0,0 +1,90 @@
+/**
+ * @file trace_replayer.h
+ * @brief Declaration of the TraceReplayer class
+ * @author Hugo Bohácsek (xbohach00)
+ */
+
+#ifndef TRACE_REPLAYER_H
+#define TRACE_REPLAYER_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "moore_machine.h"
+#include "machine_trace.h"
+
+/**
+ * @struct TraceMismatch
+ * @brief Recorded value the replay did not reproduce
+ */
+struct TraceMismatch {
+    long long time;               /**< Microseconds since the start of the trace */
+    TraceFormat::RecordType type; /**< STATE, OUTPUT or VARIABLE */
+    std::string name;             /**< Output pointer or variable name, empty for the state */
+    std::string expected;         /**< Value in the trace */
+    std::string actual;           /**< Value in the replay */
+};
+
+/**
+ * @struct ReplayResult
+ * @brief Outcome of replaying a trace
+ */
+struct ReplayResult {
+    size_t records;                        /**< Number of records read */
+    size_t inputs;                         /**< Number of inputs fed to the simulation */
+    size_t compared;                       /**< Number of recorded values compared */
+    size_t mismatchCount;                  /**< Number of recorded values not reproduced */
+    std::vector<TraceMismatch> mismatches; /**< The first mismatches, in trace order */
+    unsigned long long steps;              /**< Simulation steps made */
+    long long traceMicros;                 /**< Time the trace spans, in microseconds */
+    double seconds;                        /**< Wall clock time of the replay */
+};
+
+/**
+ * @class TraceReplayer
+ * @brief Feeds a recorded trace through a headless simulation and diffs the results
+ *
+ * The machine is copied and run by a MachineSimulator on a VirtualClock, so
+ * hours of recorded time replay as fast as the steps can be computed. RESET,
+ * SYNC and INPUT records drive the simulation at their recorded times, after
+ * every step due by then. A STATE, OUTPUT or VARIABLE record is compared once
+ * the replay holds the recorded value or has no more steps due by the record's
+ * time, so changes a live run made a little late still line up.
+ *
+ * Variables start from their initial values. A replay does not stop at a
+ * mismatch, the simulation keeps its own values.
+ */
+class TraceReplayer {
+private:
+    const MooreMachine& machine; /**< The machine to replay on, only ever copied */
+    size_t maxReported;          /**< Number of mismatches kept in the result */
+    int maxStepsPerInstant;      /**< Steps without time advancing before the replay is stopped */
+
+public:
+    /**
+     * @brief Constructor
+     *
+     * @param machine The machine to replay on, must outlive the replayer
+     * @param maxReported Number of mismatches kept in the result
+     */
+    TraceReplayer(const MooreMachine& machine, size_t maxReported = 100);
+
+    /**
+     * @brief Replays a trace file
+     *
+     * @param filename Path of the trace file
+     * @return Counts and the first mismatches
+     * @throw std::runtime_error If the trace is malformed or the machine cannot be simulated
+     */
+    ReplayResult replay(const std::string& filename) const;
+
+    /**
+     * @brief Describes the outcome of a replay
+     *
+     * @param result Results of replay()
+     * @return One line per fact, then one per reported mismatch
+     */
+    static std::vector<std::string> describe(const ReplayResult& result);
+};
+
+#endif // TRACE_REPLAYER_H
@@ -129,28 +129,28 @@ public:
      * 
      * @return The transition ID
      */
-    std::string getId() const;
+    const std::string& getId() const;
     
     /**
      * @brief Gets the source state ID
      * 
      * @return The source state ID
      */
-    std::string getSourceId() const;
+    const std::string& getSourceId() const;
     
     /**
      * @brief Gets the target state ID
      * 
      * @return The target state ID
      */
-    std::string getTargetId() const;
+    const std::string& getTargetId() const;
     
     /**
      * @brief Gets all input conditions
      * 
      * @return Vector of input conditions
      */
-    std::vector<InputCondition> getInputConditions() const;
+    const std::vector<InputCondition>& getInputConditions() const;
     
     /**
      * @brief Gets all input values (legacy)
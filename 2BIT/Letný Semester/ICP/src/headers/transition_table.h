@@ -0,0 +1,169 @@
+/**
+ * @file transition_table.h
+ * @brief Declaration of the TransitionTable class
+ * @author Hugo Bohácsek (xbohach00)
+ */
+
+#ifndef TRANSITION_TABLE_H
+#define TRANSITION_TABLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "state.h"
+#include "transition.h"
+
+class MooreMachine;
+
+/**
+ * @struct TransitionSpan
+ * @brief Borrowed range of transitions leaving a single state
+ */
+struct TransitionSpan {
+    Transition* const* first; /**< First transition of the range */
+    Transition* const* last;  /**< One past the last transition of the range */
+    int offset;               /**< Table index of the first transition, the i-th one has index offset + i */
+
+    Transition* const* begin() const { return first; }
+    Transition* const* end() const { return last; }
+    size_t size() const { return static_cast<size_t>(last - first); }
+    bool empty() const { return first == last; }
+};
+
+/**
+ * @class TransitionTable
+ * @brief Compiled, read-only form of the transition relation of a MooreMachine
+ *
+ * State IDs, input pointers and input symbols are interned to dense integers.
+ * A step of the machine then becomes a single lookup keyed by
+ * (state, pointer, symbol) instead of a scan over every transition.
+ * The table is built by MooreMachine on demand and dropped whenever
+ * its states or transitions change.
+ */
+class TransitionTable {
+private:
+    const MooreMachine* owner;                              /**< Machine the table was built for */
+    std::vector<std::string> stateIds;                      /**< State IDs indexed by state index */
+    std::unordered_map<std::string, int> stateIndices;      /**< State index by state ID */
+    std::unordered_map<std::string, int> pointerIndices;    /**< Input pointer index by name */
+    std::unordered_map<std::string, int> symbolIndices;     /**< Input symbol index by value */
+    std::unordered_map<uint64_t, int> dispatch;             /**< Target state by packed (state, pointer, symbol) key */
+    std::vector<int> outgoingOffsets;                       /**< Start of each state's range in outgoing */
+    std::vector<Transition*> outgoing;                      /**< Transitions grouped by source state */
+    std::vector<int> targets;                               /**< Target state index of each transition in outgoing */
+
+    /**
+     * @brief Packs a (state, pointer, symbol) triple into a dispatch key
+     *
+     * @param state State index
+     * @param pointer Input pointer index
+     * @param symbol Input symbol index
+     * @return Key unique for the triple
+     */
+    uint64_t makeKey(int state, int pointer, int symbol) const;
+
+public:
+    static constexpr int NONE = -1; /**< Returned for unknown names and missing transitions */
+
+    /**
+     * @brief Compiles the states and transitions of a machine
+     *
+     * States are numbered in the order of MooreMachine::getStateHandles() and
+     * each state's transitions are taken in the order they were added, so the
+     * first matching transition wins just like a linear scan would.
+     *
+     * @param owner Machine to compile
+     */
+    explicit TransitionTable(MooreMachine& owner);
+
+    /**
+     * @brief Gets the machine the table was built for
+     *
+     * @return Pointer to the owning machine
+     */
+    const MooreMachine* getOwner() const;
+
+    /**
+     * @brief Gets the number of interned states
+     *
+     * @return Number of states
+     */
+    int getStateCount() const;
+
+    /**
+     * @brief Gets the dense index of a state
+     *
+     * @param stateId ID of the state
+     * @return Index of the state, or NONE if not found
+     */
+    int getStateIndex(const std::string& stateId) const;
+
+    /**
+     * @brief Gets the ID of a state by its dense index
+     *
+     * @param index Index of the state
+     * @return ID of the state
+     */
+    const std::string& getStateId(int index) const;
+
+    /**
+     * @brief Gets the dense index of an input pointer
+     *
+     * @param pointer Name of the input pointer
+     * @return Index of the pointer, or NONE if no transition reads it
+     */
+    int getPointerIndex(const std::string& pointer) const;
+
+    /**
+     * @brief Gets the dense index of an input symbol
+     *
+     * @param symbol Input symbol
+     * @return Index of the symbol, or NONE if no transition expects it
+     */
+    int getSymbolIndex(const std::string& symbol) const;
+
+    /**
+     * @brief Looks up the target of a transition
+     *
+     * @param state Index of the source state
+     * @param pointer Index of the input pointer
+     * @param symbol Index of the input symbol
+     * @return Index of the target state, or NONE if no transition matches
+     */
+    int getNextState(int state, int pointer, int symbol) const;
+
+    /**
+     * @brief Gets the transitions leaving a state
+     *
+     * @param state Index of the source state
+     * @return Range of transitions, empty for an unknown state
+     */
+    TransitionSpan getOutgoing(int state) const;
+
+    /**
+     * @brief Gets the number of compiled transitions
+     *
+     * @return Number of transitions
+     */
+    int getTransitionCount() const;
+
+    /**
+     * @brief Gets a transition by its dense index
+     *
+     * @param index Index of the transition, see TransitionSpan::offset
+     * @return Pointer to the transition
+     */
+    Transition* getTransition(int index) const;
+
+    /**
+     * @brief Gets the target state of a transition by its dense index
+     *
+     * @param index Index of the transition, see TransitionSpan::offset
+     * @return Index of the target state
+     */
+    int getTarget(int index) const;
+};
+
+#endif // TRANSITION_TABLE_H
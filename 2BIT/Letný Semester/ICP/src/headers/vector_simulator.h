@@ -0,0 +1,462 @@
+/**
+ * @file vector_simulator.h
+ * @brief Declaration of the VectorSimulator class
+ * @author Hugo Bohácsek (xbohach00)
+ */
+
+#ifndef VECTOR_SIMULATOR_H
+#define VECTOR_SIMULATOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "batch_simulator.h"
+#include "expression_program.h"
+#include "machine_variable.h"
+#include "moore_machine.h"
+
+/**
+ * @class VectorSimulator
+ * @brief Runs many instances of one machine in lockstep over structure-of-arrays lanes
+ *
+ * Where BatchSimulator runs a MachineSimulator per instance, every instance
+ * here is a lane: its current state, pending inputs, variables, outputs and
+ * timers are one element of contiguous per-field arrays. Input values are
+ * interned once per run, so a lane only holds indices and numbers.
+ *
+ * The lanes advance one input column at a time, the k-th event of every
+ * trace together. The first triggered transition of each stepping lane is
+ * looked up in a dense [state][pointer][symbol] table built from the
+ * machine's TransitionTable, eight lanes at once with AVX2 gathers where the
+ * CPU supports them. Expired timers, boolean conditions, timed transitions
+ * and state outputs are then finished lane by lane.
+ *
+ * Steps, timeouts, the horizon and the step limit per instant follow
+ * BatchSimulator exactly, so both report the same results for the same
+ * traces. Only machines without string variables or string literals in
+ * expressions can be run, and expressions may not read the elapsed keyword.
+ * A condition waiting for an empty value never holds. Of timers expiring at
+ * the same time, the one of the earlier transition fires first.
+ */
+class VectorSimulator {
+private:
+    static constexpr int32_t NO_RANK = INT32_MAX; /**< Rank of a missing transition in the dispatch table */
+    static constexpr int MAX_TIMERS = 32;         /**< Timed transitions a state may have, one bit each */
+
+    /**
+     * @enum ValueKind
+     * @brief What an output or expression result holds
+     */
+    enum class ValueKind : uint8_t {
+        NONE,   /**< Nothing, an unset output or an empty expression */
+        INT,    /**< An int */
+        FLOAT,  /**< A float */
+        LITERAL /**< A literal of the machine, by index */
+    };
+
+    /**
+     * @struct Value
+     * @brief Output or expression result of one lane
+     */
+    struct Value {
+        ValueKind kind;   /**< What the value holds */
+        int intValue;     /**< The int, or the literal index */
+        float floatValue; /**< The float */
+    };
+
+    /**
+     * @struct Operation
+     * @brief Instruction of an expression, with its operand resolved
+     */
+    struct Operation {
+        OpCode op;         /**< LOAD, APPLY or FAIL */
+        char operation;    /**< Arithmetic operator for APPLY */
+        int variable;      /**< Index of the variable operand, -1 for a constant */
+        Value constant;    /**< The constant operand */
+        std::string error; /**< Message thrown by FAIL */
+    };
+
+    /**
+     * @struct Action
+     * @brief Output statement of a state, with its names resolved
+     */
+    struct Action {
+        OutputAction action;            /**< Kind of the statement */
+        int target;                     /**< Variable for assignments, output otherwise, -1 if missing */
+        int source;                     /**< Input pointer for ASSIGN_INPUT, variable or literal for VALUE */
+        bool sourceIsVariable;          /**< Whether source of VALUE is a variable */
+        int condition;                  /**< Input pointer that has to be defined, -1 for none */
+        std::vector<Operation> program; /**< Expression of ASSIGN_EXPRESSION and OUTPUT_EXPRESSION */
+        std::string error;              /**< Message thrown by INVALID */
+    };
+
+    /**
+     * @struct Guard
+     * @brief Boolean condition of a transition
+     */
+    struct Guard {
+        int left;            /**< Variable on the left, -1 if missing */
+        bool equal;          /**< True for ==, false for != */
+        int right;           /**< Variable on the right, -1 for a literal */
+        std::string literal; /**< Literal on the right */
+    };
+
+    /**
+     * @enum TransitionKind
+     * @brief How a transition is taken
+     */
+    enum class TransitionKind : uint8_t {
+        IMMEDIATE, /**< As soon as it is triggered */
+        TIMED,     /**< After being triggered for its timeout */
+        TIMEOUT    /**< After its timeout since the state was entered */
+    };
+
+    /**
+     * @struct LaneTransition
+     * @brief Transition compiled against the lane columns
+     */
+    struct LaneTransition {
+        int target;                                  /**< Index of the target state */
+        TransitionKind kind;                         /**< How the transition is taken */
+        int timer;                                   /**< Timer bit within the source state, -1 for IMMEDIATE */
+        int timeout;                                 /**< Timeout in milliseconds */
+        std::vector<std::pair<int, int>> conditions; /**< (pointer, symbol) pairs that trigger it */
+        std::vector<Guard> guards;                   /**< Boolean conditions that trigger it */
+        std::vector<int> consumed;                   /**< Input pointers cleared when it is taken */
+    };
+
+    /**
+     * @struct LaneState
+     * @brief State compiled against the lane columns
+     */
+    struct LaneState {
+        std::string id;              /**< ID of the state */
+        int first;                   /**< Index of the first outgoing transition */
+        int count;                   /**< Number of outgoing transitions */
+        uint32_t timeouts;           /**< Timer bits of the pure timeouts, armed on entry */
+        std::vector<int> timers;     /**< Transition index of each timer bit */
+        bool guarded;                /**< Whether an immediate transition has boolean conditions */
+        bool timed;                  /**< Whether a timed transition has to be armed or cancelled */
+        std::vector<Action> actions; /**< Output statements run on entry */
+    };
+
+    /**
+     * @struct LaneVariable
+     * @brief Variable of the machine, one column per variable
+     */
+    struct LaneVariable {
+        std::string name;   /**< Name of the variable */
+        VariableType type;  /**< INT or FLOAT */
+        int initialInt;     /**< Initial value of an int */
+        float initialFloat; /**< Initial value of a float */
+    };
+
+    /**
+     * @struct InputValue
+     * @brief Input value interned for a run
+     */
+    struct InputValue {
+        std::string text; /**< The value */
+        int symbol;       /**< Symbol index, or the none column of the dispatch table */
+        bool intValid;    /**< Whether an int variable can be set to it */
+        int intValue;     /**< The value as an int */
+        bool floatValid;  /**< Whether a float variable can be set to it */
+        float floatValue; /**< The value as a float */
+    };
+
+    /**
+     * @struct LaneEvent
+     * @brief Trace event with its input pointer and value interned
+     */
+    struct LaneEvent {
+        long long time; /**< Virtual time in milliseconds */
+        int pointer;    /**< Input pointer, -1 if the machine never reads it */
+        int value;      /**< Interned value */
+    };
+
+    // The machine, compiled once
+    std::vector<LaneState> states;                         /**< States by index */
+    std::vector<LaneTransition> transitions;               /**< Transitions grouped by source state */
+    std::vector<LaneVariable> variables;                   /**< Variables by column */
+    std::unordered_map<std::string, int> variableIndices;  /**< Variable column by name */
+    std::vector<std::string> outputNames;                  /**< Output pointers by column */
+    std::unordered_map<std::string, int> outputIndices;    /**< Output column by name */
+    std::vector<std::string> pointerNames;                 /**< Input pointers by column, dispatched ones first */
+    std::unordered_map<std::string, int> pointerIndices;   /**< Input pointer column by name */
+    std::unordered_map<std::string, int> symbolIndices;    /**< Symbol index by condition value */
+    std::vector<std::string> literals;                     /**< Literals sent to outputs */
+    std::vector<int32_t> ranks;                            /**< First immediate transition by [state][pointer][symbol] */
+    int dispatchedPointers;                                /**< Input pointers read by transitions */
+    int symbolStride;                                      /**< Symbols plus the none column */
+    int initialState;                                      /**< Index of the initial state */
+    bool avx2;                                             /**< Whether the dispatch uses AVX2 gathers */
+    long long horizon;                                     /**< Virtual time simulated after the last event of a trace */
+    int maxStepsPerInstant;                                /**< Steps without time advancing before a lane is stopped */
+
+    // Interned per run
+    std::vector<InputValue> values;                        /**< Input values by index, 0 is the empty value */
+    std::unordered_map<std::string, int> valueIds;         /**< Value index by text */
+    std::vector<std::vector<LaneEvent>> laneTraces;        /**< Interned traces, lane i runs laneTraces[i % size] */
+
+    // Lanes, one element per instance
+    size_t laneCount;                                      /**< Number of lanes */
+    std::vector<int32_t> laneStates;                       /**< Current state */
+    std::vector<uint8_t> justEntered;                      /**< Whether the next step only settles the entry */
+    std::vector<uint8_t> settled;                          /**< Whether nothing is due before a timer */
+    std::vector<uint8_t> failed;                           /**< Whether the lane was stopped by an error */
+    std::vector<long long> enteredAt;                      /**< Time the current state was entered */
+    std::vector<long long> laneNow;                        /**< Virtual clock */
+    std::vector<long long> nextDue;                        /**< Earliest armed timer, LLONG_MAX for none */
+    std::vector<uint32_t> armed;                           /**< Armed timer bits */
+    std::vector<long long> due;                            /**< Deadline by [timer][lane] */
+    std::vector<unsigned long long> laneSteps;             /**< Steps made */
+    std::vector<long long> instant;                        /**< Time of the last step */
+    std::vector<int> stepsAtInstant;                       /**< Steps made at that time */
+    std::vector<int32_t> symbols;                          /**< Pending symbol by [dispatched pointer][lane] */
+    std::vector<int32_t> inputs;                           /**< Pending value by [pointer][lane] */
+    std::vector<int> ints;                                 /**< Int variable by [variable][lane] */
+    std::vector<float> floats;                             /**< Float variable by [variable][lane] */
+    std::vector<Value> outputs;                            /**< Output by [output][lane] */
+    std::vector<int32_t> stepRanks;                        /**< Dispatch results of the lanes being stepped */
+    size_t firstErrorLane;                                 /**< Lowest failed lane */
+    std::string firstError;                                /**< Message of the lowest failed lane */
+
+    /**
+     * @brief Compiles an expression program against the variable columns
+     *
+     * @param program The program
+     * @return Operations in execution order
+     * @throw std::runtime_error If the program uses strings or the elapsed keyword
+     */
+    std::vector<Operation> compileProgram(const ExpressionProgram& program) const;
+
+    /**
+     * @brief Gets the column of an input pointer, adding it if it is new
+     *
+     * @param name Name of the input pointer
+     * @return Index of the column
+     */
+    int addPointer(const std::string& name);
+
+    /**
+     * @brief Interns an input value for the current run
+     *
+     * @param text The value
+     * @return Index of the value
+     */
+    int internValue(const std::string& text);
+
+    /**
+     * @brief Puts every lane into the initial state
+     *
+     * @param count Number of lanes
+     */
+    void resetLanes(size_t count);
+
+    /**
+     * @brief Moves a lane to a state, arms its timeouts and runs its outputs
+     *
+     * @param lane The lane
+     * @param state Index of the entered state
+     * @throw std::runtime_error If an output statement fails
+     */
+    void enterState(uint32_t lane, int state);
+
+    /**
+     * @brief Clears the inputs a transition consumed
+     *
+     * @param lane The lane
+     * @param transition The taken transition
+     */
+    void consume(uint32_t lane, const LaneTransition& transition);
+
+    /**
+     * @brief Recomputes the earliest armed timer of a lane
+     *
+     * @param lane The lane
+     */
+    void updateNextDue(uint32_t lane);
+
+    /**
+     * @brief Gets the time a lane has to be stepped next
+     *
+     * @param lane The lane
+     * @return Virtual time in milliseconds, LLONG_MAX if nothing is pending
+     */
+    long long deadline(uint32_t lane) const;
+
+    /**
+     * @brief Checks whether a transition is triggered in a lane
+     *
+     * @param transition The transition
+     * @param lane The lane
+     * @return True if any of its conditions holds
+     */
+    bool isTriggered(const LaneTransition& transition, uint32_t lane) const;
+
+    /**
+     * @brief Checks a boolean condition in a lane
+     *
+     * @param guard The condition
+     * @param lane The lane
+     * @return True if it holds
+     */
+    bool guardHolds(const Guard& guard, uint32_t lane) const;
+
+    /**
+     * @brief Prints a variable of a lane the way MachineVariable does
+     *
+     * @param variable Column of the variable
+     * @param lane The lane
+     * @param buffer Storage for the text
+     * @return The text, valid while buffer is
+     */
+    std::string_view variableText(int variable, uint32_t lane, char (&buffer)[32]) const;
+
+    /**
+     * @brief Evaluates an expression in a lane
+     *
+     * @param program The compiled expression
+     * @param lane The lane
+     * @return The result
+     * @throw std::runtime_error On division by zero or a FAIL instruction
+     */
+    Value evaluate(const std::vector<Operation>& program, uint32_t lane) const;
+
+    /**
+     * @brief Assigns a value to a variable of a lane through its text, like the simulator does
+     *
+     * @param variable Column of the variable
+     * @param lane The lane
+     * @param value The assigned value
+     * @throw std::runtime_error If the text cannot be parsed as the variable's type
+     */
+    void assign(int variable, uint32_t lane, const Value& value);
+
+    /**
+     * @brief Makes one step of every listed lane
+     *
+     * @param lanes Lanes to step, in ascending order
+     */
+    void stepLanes(const std::vector<uint32_t>& lanes);
+
+    /**
+     * @brief Makes one step of a lane, like MachineSimulator::processInputs()
+     *
+     * @param lane The lane
+     * @param rank Rank of its first triggered immediate transition without boolean conditions
+     * @throw std::runtime_error If an output statement fails
+     */
+    void stepLane(uint32_t lane, int32_t rank);
+
+    /**
+     * @brief Counts a step of a lane
+     *
+     * @param lane The lane
+     * @throw std::runtime_error If the lane keeps stepping without time advancing
+     */
+    void afterStep(uint32_t lane);
+
+    /**
+     * @brief Stops a lane
+     *
+     * @param lane The lane
+     * @param message What went wrong
+     */
+    void failLane(uint32_t lane, const std::string& message);
+
+    /**
+     * @brief Makes every step of the listed lanes that is due by their limit
+     *
+     * @param lanes Lanes to advance, replaced by scratch contents
+     * @param column Event whose time is the limit, or SIZE_MAX for the end of the trace plus the horizon
+     */
+    void catchUp(std::vector<uint32_t>& lanes, size_t column);
+
+public:
+    /**
+     * @brief Constructor, compiles the machine into lane tables
+     *
+     * The machine is only read, it does not have to outlive the simulator.
+     *
+     * @param machine The machine to simulate
+     * @throw std::runtime_error If the machine has no states, string variables,
+     *        string literals or elapsed in expressions, or a state with more
+     *        than 32 timed transitions
+     */
+    explicit VectorSimulator(const MooreMachine& machine);
+
+    /**
+     * @brief Sets how long instances keep running after their last input
+     *
+     * @param milliseconds Virtual time in milliseconds
+     */
+    void setHorizon(long long milliseconds);
+
+    /**
+     * @brief Gets how the first triggered transitions are looked up
+     *
+     * @return "avx2" or "scalar"
+     */
+    const char* getKernelName() const;
+
+    /**
+     * @brief Runs the given number of instances
+     *
+     * Instance i is fed traces[i % traces.size()] on lane i. The lanes keep
+     * their final values until the next run.
+     *
+     * @param traces Input traces to feed
+     * @param instances Number of instances to run
+     * @return Statistics of the run, with a single thread
+     * @throw std::runtime_error If no traces are given or there are too many instances
+     */
+    BatchStats run(const std::vector<InputTrace>& traces, size_t instances);
+
+    /**
+     * @brief Gets the current state of a lane
+     *
+     * @param lane Index of the lane
+     * @return ID of the state
+     */
+    const std::string& getState(size_t lane) const;
+
+    /**
+     * @brief Gets an output value of a lane
+     *
+     * @param lane Index of the lane
+     * @param outputPtr The output pointer name
+     * @return Current value, or empty string if not set
+     */
+    std::string getOutput(size_t lane, const std::string& outputPtr) const;
+
+    /**
+     * @brief Gets a variable of a lane as text
+     *
+     * @param lane Index of the lane
+     * @param name Name of the variable
+     * @return The value as MachineVariable::getValueString() prints it, or empty string if not found
+     */
+    std::string getVariable(size_t lane, const std::string& name) const;
+
+    /**
+     * @brief Gets the number of steps a lane made
+     *
+     * @param lane Index of the lane
+     * @return Number of steps
+     */
+    unsigned long long getSteps(size_t lane) const;
+
+    /**
+     * @brief Checks whether a lane was stopped by an error
+     *
+     * @param lane Index of the lane
+     * @return True if it failed
+     */
+    bool hasFailed(size_t lane) const;
+};
+
+#endif // VECTOR_SIMULATOR_H
@@ -0,0 +1,214 @@
+/**
+ * @file wire_protocol.h
+ * @brief Declaration of the binary protocol between the editor and generated automatons
+ * @author Hugo Bohácsek (xbohach00)
+ */
+
+#ifndef WIRE_PROTOCOL_H
+#define WIRE_PROTOCOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * @namespace WireProtocol
+ * @brief Layout of the UDP datagrams exchanged with a running automaton
+ *
+ * A datagram starts with a header of the magic byte 'F', the protocol
+ * version, the 32-bit ID of the automaton instance it is for or from and a
+ * 32-bit sequence number. One process can host many instances on one port,
+ * the ID tells them apart. Records follow, each made of a type
+ * byte, a 16-bit payload length and the payload. Integers are big-endian,
+ * strings are a 16-bit length followed by the bytes.
+ *
+ * Every instance numbers its datagrams. A snapshot lists the states, input
+ * pointers, output pointers and variables, and their positions in it are the
+ * slots later records refer to. Afterwards only values that changed are sent,
+ * coalesced into datagrams of at most MAX_DATAGRAM bytes. A receiver that sees
+ * a sequence number it did not expect asks for a new snapshot.
+ */
+namespace WireProtocol {
+    constexpr char MAGIC = 'F';              /**< First byte of every datagram */
+    constexpr uint8_t VERSION = 2;           /**< Version of the layout */
+    constexpr size_t HEADER_SIZE = 10;       /**< Magic, version, instance ID and sequence number */
+    constexpr size_t RECORD_HEADER_SIZE = 3; /**< Type and payload length */
+    constexpr size_t MAX_DATAGRAM = 1400;    /**< Coalesced updates stay below a typical MTU */
+    constexpr size_t MAX_RECEIVE = 65536;    /**< Largest datagram a snapshot can take */
+
+    /**
+     * @enum RecordType
+     * @brief Types of records
+     */
+    enum RecordType : uint8_t {
+        HELLO = 0x00,    /**< Editor connects, the automaton answers with a snapshot */
+        INPUT = 0x01,    /**< Editor sets an input: pointer name, value */
+        STOP = 0x02,     /**< Editor stops the automaton */
+        STATE = 0x03,    /**< Current state changed: state slot */
+        VARIABLE = 0x04, /**< Variable changed: variable slot, value */
+        OUTPUT = 0x05,   /**< Output changed: output slot, value */
+        SNAPSHOT = 0x06, /**< Definition path, slot names and all current values */
+        BYE = 0x07,      /**< Editor disconnects */
+        RESYNC = 0x08    /**< Editor missed a datagram and asks for a snapshot */
+    };
+}
+
+/**
+ * @class WireWriter
+ * @brief Builds one datagram of records
+ */
+class WireWriter {
+private:
+    std::string data;   /**< The datagram built so far */
+    size_t recordStart; /**< Where the open record starts */
+
+public:
+    /**
+     * @brief Constructor, writes the datagram header
+     *
+     * @param instance ID of the automaton instance
+     * @param sequence Sequence number of the datagram
+     */
+    WireWriter(uint32_t instance, uint32_t sequence);
+
+    /**
+     * @brief Starts a record, its payload follows
+     *
+     * @param type Type of the record
+     */
+    void beginRecord(WireProtocol::RecordType type);
+
+    /**
+     * @brief Ends the open record and fills in its length
+     *
+     * @throw std::runtime_error If the payload does not fit a record
+     */
+    void endRecord();
+
+    /**
+     * @brief Drops the open record
+     */
+    void cancelRecord();
+
+    /**
+     * @brief Appends a 16-bit integer
+     *
+     * @param value The integer
+     */
+    void writeU16(uint16_t value);
+
+    /**
+     * @brief Appends a 32-bit integer
+     *
+     * @param value The integer
+     */
+    void writeU32(uint32_t value);
+
+    /**
+     * @brief Appends a string with its length
+     *
+     * @param value The string, at most 65535 bytes
+     * @throw std::runtime_error If the string is too long
+     */
+    void writeString(const std::string& value);
+
+    /**
+     * @brief Gets the size of the datagram
+     *
+     * @return Number of bytes written
+     */
+    size_t size() const;
+
+    /**
+     * @brief Checks whether any record was written
+     *
+     * @return True if the datagram holds only the header
+     */
+    bool empty() const;
+
+    /**
+     * @brief Gets the datagram
+     *
+     * @return Bytes to send
+     */
+    const std::string& getData() const;
+};
+
+/**
+ * @class WireReader
+ * @brief Walks the records of a received datagram
+ *
+ * Reading past the end of the datagram or of the current record throws,
+ * so a truncated or corrupted datagram never yields partial values.
+ */
+class WireReader {
+private:
+    const std::string& data; /**< The datagram */
+    size_t position;         /**< Next byte to read */
+    size_t recordEnd;        /**< End of the current record */
+    uint32_t instance;       /**< Instance ID from the header */
+    uint32_t sequence;       /**< Sequence number from the header */
+
+    /**
+     * @brief Checks that the current record has enough bytes left
+     *
+     * @param count Number of bytes about to be read
+     * @throw std::runtime_error If the record is shorter
+     */
+    void require(size_t count) const;
+
+public:
+    /**
+     * @brief Constructor, reads the datagram header
+     *
+     * @param data The datagram, must outlive the reader
+     * @throw std::runtime_error If the header is missing or of another version
+     */
+    explicit WireReader(const std::string& data);
+
+    /**
+     * @brief Gets the ID of the automaton instance of the datagram
+     *
+     * @return Instance ID from the header
+     */
+    uint32_t getInstance() const;
+
+    /**
+     * @brief Gets the sequence number of the datagram
+     *
+     * @return Sequence number from the header
+     */
+    uint32_t getSequence() const;
+
+    /**
+     * @brief Moves to the next record, skipping what is left of the current one
+     *
+     * @param type Type of the record
+     * @return False when there are no more records
+     * @throw std::runtime_error If the record is truncated
+     */
+    bool nextRecord(WireProtocol::RecordType& type);
+
+    /**
+     * @brief Reads a 16-bit integer
+     *
+     * @return The integer
+     */
+    uint16_t readU16();
+
+    /**
+     * @brief Reads a 32-bit integer
+     *
+     * @return The integer
+     */
+    uint32_t readU32();
+
+    /**
+     * @brief Reads a string with its length
+     *
+     * @return The string
+     */
+    std::string readString();
+};
+
+#endif // WIRE_PROTOCOL_H
@@ -0,0 +1,1686 @@
+/**
+ * @file action_translator.cpp
+ * @brief Implementation of the ActionTranslator, TypedActionTranslator and CActionTranslator classes
+ * @author Hugo Bohácsek (xbohach00)
+ */
+
+#include "../headers/action_translator.h"
+#include <cctype>
+#include <cstdlib>
+#include <iomanip>
+
+/**
+ * @brief Helper functions of the generated code, Value names the value type
+ *
+ * They follow MachineVariable, so generated programs print, combine and convert
+ * values exactly like the simulator does.
+ */
+static const char* helperSource = R"===(
+// Prints a value without allocating, numbers go to the caller's buffer
+inline std::string_view textView(const Value& value, char (&buffer)[32]) {
+    if (std::holds_alternative<std::string>(value)) {
+        return std::get<std::string>(value);
+    }
+    int length;
+    if (std::holds_alternative<int>(value)) {
+        length = std::snprintf(buffer, sizeof(buffer), "%d", std::get<int>(value));
+    } else {
+        length = std::snprintf(buffer, sizeof(buffer), "%g", static_cast<double>(std::get<float>(value)));
+    }
+    return std::string_view(buffer, length);
+}
+
+inline std::string variantToString(const Value& value) {
+    char buffer[32];
+    return std::string(textView(value, buffer));
+}
+
+inline void applyOperation(Value& accumulator, char op, const Value& operand) {
+    if (std::holds_alternative<int>(accumulator) && std::holds_alternative<int>(operand)) {
+        int val1 = std::get<int>(accumulator);
+        int val2 = std::get<int>(operand);
+
+        if (op == '+') accumulator = val1 + val2;
+        else if (op == '-') accumulator = val1 - val2;
+        else if (op == '*') accumulator = val1 * val2;
+        else {
+            if (val2 == 0) throw std::runtime_error("Division by zero");
+            accumulator = val1 / val2;
+        }
+    } else if (!std::holds_alternative<std::string>(accumulator) && !std::holds_alternative<std::string>(operand)) {
+        float val1 = std::holds_alternative<float>(accumulator) ? std::get<float>(accumulator) : static_cast<float>(std::get<int>(accumulator));
+        float val2 = std::holds_alternative<float>(operand) ? std::get<float>(operand) : static_cast<float>(std::get<int>(operand));
+
+        if (op == '+') accumulator = val1 + val2;
+        else if (op == '-') accumulator = val1 - val2;
+        else if (op == '*') accumulator = val1 * val2;
+        else {
+            if (val2 == 0) throw std::runtime_error("Division by zero");
+            accumulator = val1 / val2;
+        }
+    } else if (std::holds_alternative<std::string>(accumulator) && op == '+') {
+        char buffer[32];
+        std::get<std::string>(accumulator) += textView(operand, buffer);
+    } else {
+        throw std::runtime_error(std::string("Incompatible types for operation ") + op);
+    }
+}
+
+// Stores text in a variable, converted to the type the variable already has
+inline void assignText(Value& variable, const std::string& text) {
+    try {
+        if (std::holds_alternative<int>(variable)) {
+            variable = std::stoi(text);
+        } else if (std::holds_alternative<float>(variable)) {
+            variable = std::stof(text);
+        } else {
+            variable = text;
+        }
+    } catch (const std::exception&) {
+        throw std::runtime_error("Failed to parse value: " + text);
+    }
+}
+
+inline void assignValue(Value& variable, const Value& value) {
+    if (variable.index() == value.index()) {
+        variable = value;
+    } else {
+        assignText(variable, variantToString(value));
+    }
+}
+)===";
+
+/**
+ * @brief Constructor
+ *
+ * @param machine Machine the statements come from, must outlive the translator
+ * @param valueType C++ type holding variable values, a std::variant<int, float, std::string>
+ * @param reportVariables Whether reportVariable(name) is called after a variable changes
+ */
+ActionTranslator::ActionTranslator(const MooreMachine& machine, const std::string& valueType, bool reportVariables)
+    : machine(machine), valueType(valueType), reportVariables(reportVariables),
+      inputPointers(machine.getInputPointers()) {}
+
+/**
+ * @brief Quotes text as a C++ string literal
+ *
+ * @param text Text to quote
+ * @return The literal including the quotes
+ */
+std::string ActionTranslator::literal(const std::string& text) {
+    std::string quoted = "\"";
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            quoted += '\\';
+        }
+        quoted += c;
+    }
+    return quoted + "\"";
+}
+
+/**
+ * @brief Gets the helper functions the emitted statements call
+ *
+ * The code needs <cstdio>, <stdexcept>, <string>, <string_view> and <variant>.
+ *
+ * @return Definitions of textView, variantToString, applyOperation, assignText and assignValue
+ */
+std::string ActionTranslator::helperFunctions() const {
+    return "using Value = " + valueType + ";\n" + helperSource;
+}
+
+/**
+ * @brief Translates an expression
+ *
+ * The expression is evaluated left to right into a local variable named result,
+ * the same way MachineSimulator evaluates it.
+ *
+ * @param program Compiled expression
+ * @param indent Indentation of the statements
+ * @return Statements storing the value in a local variable named result
+ */
+std::string ActionTranslator::expression(const ExpressionProgram& program, const std::string& indent) const {
+    std::stringstream ss;
+    const auto& variables = machine.getVariablesView();
+
+    ss << indent << valueType << " result;" << std::endl;
+    for (const Instruction& instruction : program.getInstructions()) {
+        if (instruction.op == OpCode::FAIL) {
+            ss << indent << "throw std::runtime_error(" << literal(program.getError(instruction.index)) << ");" << std::endl;
+            break;
+        }
+
+        std::string operand;
+        switch (instruction.kind) {
+            case OperandKind::CONSTANT: {
+                const MachineVariable& constant = program.getConstant(instruction.index);
+                if (constant.getType() == VariableType::FLOAT) {
+                    std::stringstream number;
+                    number << std::setprecision(9) << std::showpoint << std::get<float>(constant.getValue()) << "f";
+                    operand = valueType + "(" + number.str() + ")";
+                } else if (constant.getType() == VariableType::STRING) {
+                    operand = valueType + "(std::string(" + literal(constant.getValueString()) + "))";
+                } else {
+                    operand = valueType + "(" + constant.getValueString() + ")";
+                }
+                break;
+            }
+            case OperandKind::VARIABLE: {
+                const std::string& name = program.getSlotName(instruction.index);
+                if (variables.find(name) == variables.end()) {
+                    ss << indent << "throw std::runtime_error(" << literal("Unknown variable: " + name) << ");" << std::endl;
+                    return ss.str();
+                }
+                operand = "variables[" + literal(name) + "]";
+                break;
+            }
+            case OperandKind::ELAPSED:
+                operand = valueType + "(elapsedMs())";
+                break;
+            default:
+                continue;
+        }
+
+        if (instruction.op == OpCode::LOAD) {
+            ss << indent << "result = " << operand << ";" << std::endl;
+        } else {
+            ss << indent << "applyOperation(result, '" << instruction.operation << "', " << operand << ");" << std::endl;
+        }
+    }
+    return ss.str();
+}
+
+/**
+ * @brief Translates the conditions of a transition
+ *
+ * Values are compared as text. A condition on an unknown variable or an
+ * undeclared input pointer can never hold and is left out.
+ *
+ * @param transition Transition to translate
+ * @param indent Indentation of the statements
+ * @return Statements returning true from the enclosing function if a condition holds
+ */
+std::string ActionTranslator::guard(const Transition& transition, const std::string& indent) const {
+    std::stringstream ss;
+    const auto& variables = machine.getVariablesView();
+
+    for (const auto& condition : transition.getInputConditions()) {
+        if (condition.isBooleanExpr) {
+            if (variables.find(condition.leftOperand) == variables.end() ||
+                (condition.operation != "==" && condition.operation != "!=")) {
+                continue;
+            }
+            std::string right = literal(condition.rightOperand);
+            if (variables.find(condition.rightOperand) != variables.end()) {
+                right = "textView(variables[" + literal(condition.rightOperand) + "], right)";
+            }
+            ss << indent << "{" << std::endl
+               << indent << "    char left[32], right[32];" << std::endl
+               << indent << "    if (textView(variables[" << literal(condition.leftOperand) << "], left) "
+               << condition.operation << " " << right << ") return true;" << std::endl
+               << indent << "}" << std::endl;
+        } else if (inputPointers.count(condition.source)) {
+            ss << indent << "if (inputs[" << literal(condition.source) << "] == " << literal(condition.value) << ") return true;" << std::endl;
+        }
+    }
+    return ss.str();
+}
+
+/**
+ * @brief Translates clearing the inputs a transition was taken on
+ *
+ * Boolean conditions leave the inputs alone, like in MachineSimulator.
+ *
+ * @param transition Transition to translate
+ * @param indent Indentation of the statements
+ * @return Statements clearing the inputs, empty if the transition uses none
+ */
+std::string ActionTranslator::consumedInputs(const Transition& transition, const std::string& indent) const {
+    std::set<std::string> sources;
+    for (const auto& condition : transition.getInputConditions()) {
+        if (!condition.isBooleanExpr && inputPointers.count(condition.source)) {
+            sources.insert(condition.source);
+        }
+    }
+
+    std::stringstream ss;
+    for (const auto& source : sources) {
+        ss << indent << "inputs[" << literal(source) << "].clear();" << std::endl;
+    }
+    return ss.str();
+}
+
+/**
+ * @brief Translates the output statements of a state
+ *
+ * Statements guarded by an input pointer that is not declared can never run and are left out.
+ *
+ * @param state State to translate
+ * @param indent Indentation of the statements
+ * @return Statements executing the outputs in order
+ */
+std::string ActionTranslator::outputs(const State& state, const std::string& indent) const {
+    std::stringstream ss;
+    const auto& variables = machine.getVariablesView();
+    ExpressionParser parser;
+
+    for (const auto& output : state.getOutputs()) {
+        CompiledOutput compiled = parser.compileOutput(output);
+        if (compiled.hasCondition) {
+            if (!inputPointers.count(compiled.conditionPtr)) {
+                continue;
+            }
+            ss << indent << "if (!inputs[" << literal(compiled.conditionPtr) << "].empty()) {" << std::endl;
+        } else {
+            ss << indent << "{" << std::endl;
+        }
+        std::string inner = indent + "    ";
+
+        bool knownTarget = variables.find(compiled.target) != variables.end();
+        switch (compiled.action) {
+            case OutputAction::ASSIGN_INPUT:
+                if (knownTarget) {
+                    std::string source = inputPointers.count(compiled.source) ? "inputs[" + literal(compiled.source) + "]" : "std::string()";
+                    ss << inner << "assignText(variables[" << literal(compiled.target) << "], " << source << ");" << std::endl;
+                    if (reportVariables) {
+                        ss << inner << "reportVariable(" << literal(compiled.target) << ");" << std::endl;
+                    }
+                }
+                break;
+            case OutputAction::ASSIGN_EXPRESSION:
+                ss << expression(compiled.program, inner);
+                if (knownTarget) {
+                    ss << inner << "assignValue(variables[" << literal(compiled.target) << "], result);" << std::endl;
+                    if (reportVariables) {
+                        ss << inner << "reportVariable(" << literal(compiled.target) << ");" << std::endl;
+                    }
+                }
+                break;
+            case OutputAction::OUTPUT_EXPRESSION:
+                ss << expression(compiled.program, inner);
+                ss << inner << "setOutput(" << literal(compiled.target) << ", variantToString(result));" << std::endl;
+                break;
+            case OutputAction::VALUE:
+                if (variables.find(compiled.source) != variables.end()) {
+                    ss << inner << "setOutput(" << literal(compiled.target) << ", variantToString(variables[" << literal(compiled.source) << "]));" << std::endl;
+                } else {
+                    ss << inner << "setOutput(" << literal(compiled.target) << ", " << literal(compiled.source) << ");" << std::endl;
+                }
+                break;
+            case OutputAction::INVALID:
+                ss << inner << "throw std::runtime_error(" << literal(compiled.source) << ");" << std::endl;
+                break;
+        }
+        ss << indent << "}" << std::endl;
+    }
+    return ss.str();
+}
+
+/**
+ * @brief Helper functions of the typed generated code
+ */
+static const char* typedHelperSource = R"===(
+// Prints a value without allocating, numbers go to the caller's buffer
+inline std::string_view textView(int value, char (&buffer)[32]) {
+    return std::string_view(buffer, std::snprintf(buffer, sizeof(buffer), "%d", value));
+}
+
+inline std::string_view textView(float value, char (&buffer)[32]) {
+    return std::string_view(buffer, std::snprintf(buffer, sizeof(buffer), "%g", static_cast<double>(value)));
+}
+
+inline std::string_view textView(const std::string& value, char (&)[32]) {
+    return value;
+}
+
+inline std::string textOf(int value) {
+    char buffer[32];
+    return std::string(textView(value, buffer));
+}
+
+inline std::string textOf(float value) {
+    char buffer[32];
+    return std::string(textView(value, buffer));
+}
+
+inline const std::string& textOf(const std::string& value) {
+    return value;
+}
+
+// Converts text for a variable of another type
+inline int parseInt(const std::string& text) {
+    try {
+        return std::stoi(text);
+    } catch (const std::exception&) {
+        throw std::runtime_error("Failed to parse value: " + text);
+    }
+}
+
+inline float parseFloat(const std::string& text) {
+    try {
+        return std::stof(text);
+    } catch (const std::exception&) {
+        throw std::runtime_error("Failed to parse value: " + text);
+    }
+}
+)===";
+
+/**
+ * @brief Gets the C++ type holding values of a machine type
+ *
+ * @param type Machine type
+ * @return Name of the C++ type
+ */
+static std::string cppType(VariableType type) {
+    switch (type) {
+        case VariableType::INT: return "int";
+        case VariableType::FLOAT: return "float";
+        default: return "std::string";
+    }
+}
+
+/**
+ * @brief Gets the C++ literal of a float, exact when read back
+ *
+ * @param value The float
+ * @return Literal with the f suffix
+ */
+static std::string floatLiteral(float value) {
+    std::stringstream number;
+    number << std::setprecision(9) << std::showpoint << value << "f";
+    return number.str();
+}
+
+/**
+ * @brief Names a field for each name, making the identifiers unique
+ *
+ * @param names Names from the machine
+ * @param fields Receives the field by name
+ * @param identify Turns a name into an identifier of the generated language
+ * @param reserved Identifiers already taken by the generated code
+ */
+static void nameFields(const std::set<std::string>& names, std::map<std::string, std::string>& fields,
+                       std::string (*identify)(const std::string&) = TypedActionTranslator::identifier,
+                       const std::set<std::string>& reserved = {}) {
+    std::set<std::string> used = reserved;
+    for (const auto& name : names) {
+        std::string base = identify(name);
+        std::string field = base;
+        for (int suffix = 2; used.count(field); suffix++) {
+            field = base + "_" + std::to_string(suffix);
+        }
+        used.insert(field);
+        fields[name] = field;
+    }
+}
+
+/**
+ * @brief Constructor, names a field for every variable and pointer
+ *
+ * Outputs may be written to pointers the machine does not declare,
+ * those get a field as well.
+ *
+ * @param machine Machine the statements come from, must outlive the translator
+ */
+TypedActionTranslator::TypedActionTranslator(const MooreMachine& machine) : machine(machine) {
+    std::set<std::string> variableNames;
+    for (const auto& variable : machine.getVariablesView()) {
+        variableNames.insert(variable.first);
+    }
+    nameFields(variableNames, variableFields);
+    nameFields(machine.getInputPointers(), inputFields);
+
+    std::set<std::string> outputNames = machine.getOutputPointers();
+    ExpressionParser parser;
+    for (State* state : const_cast<MooreMachine&>(machine).getAllStates()) {
+        for (const auto& output : state->getOutputs()) {
+            CompiledOutput compiled = parser.compileOutput(output);
+            if (compiled.action == OutputAction::OUTPUT_EXPRESSION || compiled.action == OutputAction::VALUE) {
+                outputNames.insert(compiled.target);
+            }
+        }
+    }
+    nameFields(outputNames, outputFields);
+}
+
+/**
+ * @brief Turns a name into a C++ identifier
+ *
+ * @param name Name from the machine
+ * @return A valid identifier
+ */
+std::string TypedActionTranslator::identifier(const std::string& name) {
+    static const std::set<std::string> keywords = {
+        "alignas", "alignof", "and", "and_eq", "asm", "auto", "bitand", "bitor", "bool", "break",
+        "case", "catch", "char", "char16_t", "char32_t", "class", "compl", "const", "const_cast",
+        "constexpr", "continue", "decltype", "default", "delete", "do", "double", "dynamic_cast",
+        "else", "enum", "explicit", "export", "extern", "false", "float", "for", "friend", "goto",
+        "if", "inline", "int", "long", "mutable", "namespace", "new", "noexcept", "not", "not_eq",
+        "nullptr", "operator", "or", "or_eq", "private", "protected", "public", "register",
+        "reinterpret_cast", "return", "short", "signed", "sizeof", "static", "static_assert",
+        "static_cast", "struct", "switch", "template", "this", "thread_local", "throw", "true",
+        "try", "typedef", "typeid", "typename", "union", "unsigned", "using", "virtual", "void",
+        "volatile", "wchar_t", "while", "xor", "xor_eq"
+    };
+
+    std::string result;
+    for (char c : name) {
+        result += (std::isalnum(static_cast<unsigned char>(c)) || c == '_') ? c : '_';
+    }
+    if (result.empty() || std::isdigit(static_cast<unsigned char>(result[0]))) {
+        result = "_" + result;
+    }
+    if (keywords.count(result)) {
+        result += "_";
+    }
+    return result;
+}
+
+/**
+ * @brief Gets the fields of the variables
+ *
+ * @return Field name by variable name
+ */
+const std::map<std::string, std::string>& TypedActionTranslator::getVariableFields() const {
+    return variableFields;
+}
+
+/**
+ * @brief Gets the fields of the input pointers
+ *
+ * @return Field name by input pointer name
+ */
+const std::map<std::string, std::string>& TypedActionTranslator::getInputFields() const {
+    return inputFields;
+}
+
+/**
+ * @brief Gets the fields of the output pointers
+ *
+ * @return Field name by output pointer name
+ */
+const std::map<std::string, std::string>& TypedActionTranslator::getOutputFields() const {
+    return outputFields;
+}
+
+/**
+ * @brief Gets the C++ declaration of a variable field with its initial value
+ *
+ * @param variable Name of the variable
+ * @return Declaration such as "int count = 0;"
+ */
+std::string TypedActionTranslator::variableDeclaration(const std::string& variable) const {
+    const MachineVariable& value = machine.getVariablesView().at(variable);
+    std::string initial;
+    if (value.getType() == VariableType::INT) {
+        initial = value.getValueString();
+    } else if (value.getType() == VariableType::FLOAT) {
+        initial = floatLiteral(std::get<float>(value.getValue()));
+    } else {
+        initial = ActionTranslator::literal(value.getValueString());
+    }
+    return cppType(value.getType()) + " " + variableFields.at(variable) + " = " + initial + ";";
+}
+
+/**
+ * @brief Gets the helper functions the emitted statements call
+ *
+ * The code needs <cstdio>, <stdexcept>, <string> and <string_view>.
+ *
+ * @return Definitions of textView, textOf, parseInt and parseFloat
+ */
+std::string TypedActionTranslator::helperFunctions() const {
+    return typedHelperSource;
+}
+
+/**
+ * @brief Translates an operand of an instruction
+ *
+ * @param program Program the instruction belongs to
+ * @param instruction Instruction with the operand
+ * @param operand Translated operand
+ * @return False if the operand names an unknown variable
+ */
+bool TypedActionTranslator::operand(const ExpressionProgram& program, const Instruction& instruction, Value& operand) const {
+    switch (instruction.kind) {
+        case OperandKind::CONSTANT: {
+            const MachineVariable& constant = program.getConstant(instruction.index);
+            operand.type = constant.getType();
+            if (operand.type == VariableType::FLOAT) {
+                operand.code = floatLiteral(std::get<float>(constant.getValue()));
+            } else if (operand.type == VariableType::STRING) {
+                operand.code = "std::string(" + ActionTranslator::literal(constant.getValueString()) + ")";
+            } else {
+                operand.code = constant.getValueString();
+            }
+            return true;
+        }
+        case OperandKind::VARIABLE: {
+            auto it = variableFields.find(program.getSlotName(instruction.index));
+            if (it == variableFields.end()) {
+                return false;
+            }
+            operand.type = machine.getVariablesView().at(it->first).getType();
+            operand.code = "variables." + it->second;
+            return true;
+        }
+        default:
+            operand.type = VariableType::INT;
+            operand.code = "elapsedMs()";
+            return true;
+    }
+}
+
+/**
+ * @brief Translates an expression into local variables named value0, value1, ...
+ *
+ * Follows MachineVariable::applyOperation: int with int stays int, any other
+ * pair of numbers becomes float and a string on the left appends the text of
+ * the operand. A new local is only declared when the type changes.
+ *
+ * @param program Compiled expression
+ * @param indent Indentation of the statements
+ * @param ss Stream receiving the statements
+ * @param result Variable holding the value when the statements complete
+ * @return False if the statements always throw and result must not be used
+ */
+bool TypedActionTranslator::expression(const ExpressionProgram& program, const std::string& indent,
+                                       std::stringstream& ss, Value& result) const {
+    int locals = 0;
+    auto declare = [&](VariableType type, const std::string& initial) {
+        result.type = type;
+        result.code = "value" + std::to_string(locals++);
+        ss << indent << cppType(type) << " " << result.code << " = " << initial << ";" << std::endl;
+    };
+
+    for (const Instruction& instruction : program.getInstructions()) {
+        if (instruction.op == OpCode::FAIL) {
+            ss << indent << "throw std::runtime_error(" << ActionTranslator::literal(program.getError(instruction.index)) << ");" << std::endl;
+            return false;
+        }
+        if (instruction.kind == OperandKind::NONE) {
+            continue;
+        }
+
+        Value value;
+        if (!operand(program, instruction, value)) {
+            ss << indent << "throw std::runtime_error("
+               << ActionTranslator::literal("Unknown variable: " + program.getSlotName(instruction.index)) << ");" << std::endl;
+            return false;
+        }
+
+        if (instruction.op == OpCode::LOAD) {
+            declare(value.type, value.code);
+            continue;
+        }
+
+        // The accumulator of a program starting with an operation holds int 0
+        if (locals == 0) {
+            declare(VariableType::INT, "0");
+        }
+
+        char op = instruction.operation;
+        if (result.type == VariableType::STRING || value.type == VariableType::STRING) {
+            if (result.type != VariableType::STRING || op != '+') {
+                ss << indent << "throw std::runtime_error("
+                   << ActionTranslator::literal(std::string("Incompatible types for operation ") + op) << ");" << std::endl;
+                return false;
+            }
+            ss << indent << result.code << " += "
+               << (value.type == VariableType::STRING ? value.code : "textOf(" + value.code + ")") << ";" << std::endl;
+            continue;
+        }
+
+        // Mixing int with float promotes the accumulator
+        if (result.type == VariableType::INT && value.type == VariableType::FLOAT) {
+            declare(VariableType::FLOAT, "static_cast<float>(" + result.code + ")");
+        }
+        if (result.type == VariableType::FLOAT && value.type == VariableType::INT) {
+            value.code = "static_cast<float>(" + value.code + ")";
+        }
+
+        if (op == '/') {
+            ss << indent << "{" << std::endl
+               << indent << "    " << cppType(result.type) << " divisor = " << value.code << ";" << std::endl
+               << indent << "    if (divisor == 0) throw std::runtime_error(\"Division by zero\");" << std::endl
+               << indent << "    " << result.code << " /= divisor;" << std::endl
+               << indent << "}" << std::endl;
+        } else {
+            ss << indent << result.code << " " << op << "= " << value.code << ";" << std::endl;
+        }
+    }
+
+    // An empty program leaves the default value
+    if (locals == 0) {
+        declare(VariableType::INT, "0");
+    }
+    return true;
+}
+
+/**
+ * @brief Translates storing a value in a variable, converting it like MachineSimulator
+ *
+ * A value of another type is converted through its text, so a float
+ * stored in an int variable is truncated the same way the simulator does it.
+ *
+ * @param variable Name of the assigned variable
+ * @param value Value to store, a local variable of the translated expression
+ * @return The assignment statement without indentation
+ */
+std::string TypedActionTranslator::assignment(const std::string& variable, const Value& value) const {
+    VariableType type = machine.getVariablesView().at(variable).getType();
+    std::string target = "variables." + variableFields.at(variable);
+
+    if (type == value.type) {
+        return target + " = " + (type == VariableType::STRING ? "std::move(" + value.code + ")" : value.code) + ";";
+    }
+    std::string text = "textOf(" + value.code + ")";
+    if (type == VariableType::INT) {
+        return target + " = parseInt(" + text + ");";
+    }
+    if (type == VariableType::FLOAT) {
+        return target + " = parseFloat(" + text + ");";
+    }
+    return target + " = " + text + ";";
+}
+
+/**
+ * @brief Translates the conditions of a transition
+ *
+ * Values are compared as text, like Transition::isTriggered does. Where the
+ * types allow it the comparison is made on the values directly, and an int
+ * compared to text that no int prints as is decided while generating.
+ *
+ * @param transition Transition to translate
+ * @param indent Indentation of the statements
+ * @return Statements returning true from the enclosing function if a condition holds
+ */
+std::string TypedActionTranslator::guard(const Transition& transition, const std::string& indent) const {
+    std::stringstream ss;
+    const auto& variables = machine.getVariablesView();
+
+    for (const auto& condition : transition.getInputConditions()) {
+        if (!condition.isBooleanExpr) {
+            auto input = inputFields.find(condition.source);
+            if (input != inputFields.end()) {
+                ss << indent << "if (inputs." << input->second << " == " << ActionTranslator::literal(condition.value) << ") return true;" << std::endl;
+            }
+            continue;
+        }
+
+        auto left = variableFields.find(condition.leftOperand);
+        if (left == variableFields.end() || (condition.operation != "==" && condition.operation != "!=")) {
+            continue;
+        }
+        const std::string& op = condition.operation;
+        VariableType leftType = variables.at(left->first).getType();
+        std::string leftCode = "variables." + left->second;
+
+        auto right = variableFields.find(condition.rightOperand);
+        if (right != variableFields.end()) {
+            VariableType rightType = variables.at(right->first).getType();
+            std::string rightCode = "variables." + right->second;
+            if (leftType == rightType && leftType != VariableType::FLOAT) {
+                ss << indent << "if (" << leftCode << " " << op << " " << rightCode << ") return true;" << std::endl;
+            } else {
+                ss << indent << "{" << std::endl
+                   << indent << "    char left[32], right[32];" << std::endl
+                   << indent << "    if (textView(" << leftCode << ", left) " << op << " textView(" << rightCode << ", right)) return true;" << std::endl
+                   << indent << "}" << std::endl;
+            }
+            continue;
+        }
+
+        std::string text = condition.rightOperand;
+        if (leftType == VariableType::STRING) {
+            ss << indent << "if (" << leftCode << " " << op << " " << ActionTranslator::literal(text) << ") return true;" << std::endl;
+        } else if (leftType == VariableType::INT) {
+            // Only text an int prints as can equal it
+            char* end = nullptr;
+            long number = std::strtol(text.c_str(), &end, 10);
+            bool printable = !text.empty() && *end == '\0' && std::to_string(static_cast<int>(number)) == text;
+            if (printable) {
+                ss << indent << "if (" << leftCode << " " << op << " " << number << ") return true;" << std::endl;
+            } else if (op == "!=") {
+                ss << indent << "return true;" << std::endl;
+                break;
+            }
+        } else {
+            ss << indent << "{" << std::endl
+               << indent << "    char left[32];" << std::endl
+               << indent << "    if (textView(" << leftCode << ", left) " << op << " " << ActionTranslator::literal(text) << ") return true;" << std::endl
+               << indent << "}" << std::endl;
+        }
+    }
+    return ss.str();
+}
+
+/**
+ * @brief Translates clearing the inputs a transition was taken on
+ *
+ * @param transition Transition to translate
+ * @param indent Indentation of the statements
+ * @return Statements clearing the inputs, empty if the transition uses none
+ */
+std::string TypedActionTranslator::consumedInputs(const Transition& transition, const std::string& indent) const {
+    std::set<std::string> fields;
+    for (const auto& condition : transition.getInputConditions()) {
+        auto input = inputFields.find(condition.source);
+        if (!condition.isBooleanExpr && input != inputFields.end()) {
+            fields.insert(input->second);
+        }
+    }
+
+    std::stringstream ss;
+    for (const auto& field : fields) {
+        ss << indent << "inputs." << field << ".clear();" << std::endl;
+    }
+    return ss.str();
+}
+
+/**
+ * @brief Translates the output statements of a state
+ *
+ * @param state State to translate
+ * @param indent Indentation of the statements
+ * @return Statements executing the outputs in order
+ */
+std::string TypedActionTranslator::outputs(const State& state, const std::string& indent) const {
+    std::stringstream ss;
+    ExpressionParser parser;
+
+    for (const auto& output : state.getOutputs()) {
+        CompiledOutput compiled = parser.compileOutput(output);
+        if (compiled.hasCondition) {
+            auto input = inputFields.find(compiled.conditionPtr);
+            if (input == inputFields.end()) {
+                continue;
+            }
+            ss << indent << "if (!inputs." << input->second << ".empty()) {" << std::endl;
+        } else {
+            ss << indent << "{" << std::endl;
+        }
+        std::string inner = indent + "    ";
+
+        auto variable = variableFields.find(compiled.target);
+        Value value;
+        switch (compiled.action) {
+            case OutputAction::ASSIGN_INPUT:
+                if (variable != variableFields.end()) {
+                    auto input = inputFields.find(compiled.source);
+                    std::string source = input != inputFields.end() ? "inputs." + input->second : "std::string()";
+                    VariableType type = machine.getVariablesView().at(compiled.target).getType();
+                    if (type == VariableType::INT) {
+                        source = "parseInt(" + source + ")";
+                    } else if (type == VariableType::FLOAT) {
+                        source = "parseFloat(" + source + ")";
+                    }
+                    ss << inner << "variables." << variable->second << " = " << source << ";" << std::endl;
+                }
+                break;
+            case OutputAction::ASSIGN_EXPRESSION:
+                if (expression(compiled.program, inner, ss, value)) {
+                    if (variable != variableFields.end()) {
+                        ss << inner << assignment(compiled.target, value) << std::endl;
+                    } else {
+                        ss << inner << "static_cast<void>(" << value.code << ");" << std::endl;
+                    }
+                }
+                break;
+            case OutputAction::OUTPUT_EXPRESSION:
+                if (expression(compiled.program, inner, ss, value)) {
+                    ss << inner << "outputs." << outputFields.at(compiled.target) << " = "
+                       << (value.type == VariableType::STRING ? "std::move(" + value.code + ")" : "textOf(" + value.code + ")") << ";" << std::endl;
+                }
+                break;
+            case OutputAction::VALUE: {
+                auto source = variableFields.find(compiled.source);
+                ss << inner << "outputs." << outputFields.at(compiled.target) << " = "
+                   << (source != variableFields.end() ? "textOf(variables." + source->second + ")" : ActionTranslator::literal(compiled.source))
+                   << ";" << std::endl;
+                break;
+            }
+            case OutputAction::INVALID:
+                ss << inner << "throw std::runtime_error(" << ActionTranslator::literal(compiled.source) << ");" << std::endl;
+                break;
+        }
+        ss << indent << "}" << std::endl;
+    }
+    return ss.str();
+}
+
+/**
+ * @brief Helper functions of the generated C header, PREFIX names the machine
+ *
+ * They follow MachineVariable and the C++ library calls it makes: numbers are
+ * printed like "%d" and "%g" and parsed like std::stoi and std::stof, without
+ * the C library. Floats are printed and parsed through double arithmetic, so
+ * the last digit may differ from the C library in rare cases.
+ */
+static const char* cHelperSource = R"===(
+/* Text helpers, a buffer never gets more than PREFIX_TEXT_CAPACITY bytes including the terminator */
+static inline size_t PREFIX_length(const char* text) {
+    size_t length = 0;
+    while (text[length]) {
+        length++;
+    }
+    return length;
+}
+
+static inline bool PREFIX_text_equal(const char* left, const char* right) {
+    while (*left && *left == *right) {
+        left++;
+        right++;
+    }
+    return *left == *right;
+}
+
+static inline void PREFIX_append(char* to, const char* from) {
+    size_t length = PREFIX_length(to);
+    size_t count = PREFIX_length(from);
+    size_t i;
+    for (i = 0; i < count && length + 1 < PREFIX_TEXT_CAPACITY; i++) {
+        to[length++] = from[i];
+    }
+    to[length] = '\0';
+}
+
+static inline void PREFIX_copy(char* to, const char* from) {
+    if (to != from) {
+        to[0] = '\0';
+        PREFIX_append(to, from);
+    }
+}
+
+/* Prints an int like "%d" into at least 12 bytes */
+static inline int PREFIX_format_int(char* to, int value) {
+    char digits[12];
+    unsigned int magnitude = value < 0 ? 0u - (unsigned int)value : (unsigned int)value;
+    int count = 0;
+    int length = 0;
+    do {
+        digits[count++] = (char)('0' + magnitude % 10u);
+        magnitude /= 10u;
+    } while (magnitude);
+    if (value < 0) {
+        to[length++] = '-';
+    }
+    while (count) {
+        to[length++] = digits[--count];
+    }
+    to[length] = '\0';
+    return length;
+}
+
+/* Multiplies by 10 to a power, rounding once while the power is within 22 */
+static inline double PREFIX_scale(double value, int exponent) {
+    double power = 1.0;
+    double base = 10.0;
+    int remaining = exponent < 0 ? -exponent : exponent;
+    while (remaining) {
+        if (remaining & 1) {
+            power *= base;
+        }
+        base *= base;
+        remaining >>= 1;
+    }
+    return exponent < 0 ? value / power : value * power;
+}
+
+/* Prints a float like "%g" into at least 16 bytes: six significant digits, trailing zeros dropped */
+static inline int PREFIX_format_float(char* to, float value) {
+    union {
+        float number;
+        uint32_t bits;
+    } pun;
+    char digits[6];
+    double magnitude;
+    double scaled;
+    double whole;
+    uint32_t integer;
+    int exponent = 0;
+    int count = 6;
+    int length = 0;
+    int i;
+
+    pun.number = value;
+    if (pun.bits >> 31) {
+        to[length++] = '-';
+    }
+    if (((pun.bits >> 23) & 0xFFu) == 0xFFu) {
+        const char* word = (pun.bits & 0x7FFFFFu) ? "nan" : "inf";
+        while (*word) {
+            to[length++] = *word++;
+        }
+        to[length] = '\0';
+        return length;
+    }
+    magnitude = value < 0 ? -(double)value : (double)value;
+    if (magnitude == 0.0) {
+        to[length++] = '0';
+        to[length] = '\0';
+        return length;
+    }
+
+    /* Exponent of the leading digit, then six digits rounded half to even */
+    while (PREFIX_scale(magnitude, -exponent) >= 10.0) {
+        exponent++;
+    }
+    while (PREFIX_scale(magnitude, -exponent) < 1.0) {
+        exponent--;
+    }
+    scaled = PREFIX_scale(magnitude, 5 - exponent);
+    whole = (double)(uint32_t)scaled;
+    if (scaled - whole > 0.5 || (scaled - whole == 0.5 && ((uint32_t)whole & 1u))) {
+        whole += 1.0;
+    }
+    if (whole >= 1000000.0) {
+        whole = 100000.0;
+        exponent++;
+    }
+    integer = (uint32_t)whole;
+    for (i = 5; i >= 0; i--) {
+        digits[i] = (char)('0' + integer % 10u);
+        integer /= 10u;
+    }
+    while (count > 1 && digits[count - 1] == '0') {
+        count--;
+    }
+
+    if (exponent < -4 || exponent >= 6) {
+        to[length++] = digits[0];
+        if (count > 1) {
+            to[length++] = '.';
+            for (i = 1; i < count; i++) {
+                to[length++] = digits[i];
+            }
+        }
+        to[length++] = 'e';
+        to[length++] = exponent < 0 ? '-' : '+';
+        exponent = exponent < 0 ? -exponent : exponent;
+        to[length++] = (char)('0' + exponent / 10);
+        to[length++] = (char)('0' + exponent % 10);
+    } else if (exponent >= 0) {
+        for (i = 0; i <= exponent; i++) {
+            to[length++] = digits[i];
+        }
+        if (count > exponent + 1) {
+            to[length++] = '.';
+            for (i = exponent + 1; i < count; i++) {
+                to[length++] = digits[i];
+            }
+        }
+    } else {
+        to[length++] = '0';
+        to[length++] = '.';
+        for (i = -1; i > exponent; i--) {
+            to[length++] = '0';
+        }
+        for (i = 0; i < count; i++) {
+            to[length++] = digits[i];
+        }
+    }
+    to[length] = '\0';
+    return length;
+}
+
+static inline void PREFIX_store_int(char* to, int value) {
+    char text[16];
+    PREFIX_format_int(text, value);
+    PREFIX_copy(to, text);
+}
+
+static inline void PREFIX_store_float(char* to, float value) {
+    char text[16];
+    PREFIX_format_float(text, value);
+    PREFIX_copy(to, text);
+}
+
+static inline void PREFIX_append_int(char* to, int value) {
+    char text[16];
+    PREFIX_format_int(text, value);
+    PREFIX_append(to, text);
+}
+
+static inline void PREFIX_append_float(char* to, float value) {
+    char text[16];
+    PREFIX_format_float(text, value);
+    PREFIX_append(to, text);
+}
+
+/* Reads an int like std::stoi: leading space, a sign and decimal digits, the rest is ignored */
+static inline bool PREFIX_parse_int(const char* text, int* value) {
+    long long result = 0;
+    bool negative = false;
+    bool digits = false;
+    while (*text == ' ' || (*text >= '\t' && *text <= '\r')) {
+        text++;
+    }
+    if (*text == '+' || *text == '-') {
+        negative = *text++ == '-';
+    }
+    for (; *text >= '0' && *text <= '9'; text++) {
+        result = result * 10 + (*text - '0');
+        digits = true;
+        if (result > (long long)INT_MAX + 1) {
+            return false;
+        }
+    }
+    result = negative ? -result : result;
+    if (!digits || result > INT_MAX || result < INT_MIN) {
+        return false;
+    }
+    *value = (int)result;
+    return true;
+}
+
+/* Reads a float like std::stof from decimal text, hexadecimal, infinity and NaN are not recognised */
+static inline bool PREFIX_parse_float(const char* text, float* value) {
+    double mantissa = 0.0;
+    int exponent = 0;
+    int digits = 0;
+    bool negative = false;
+    while (*text == ' ' || (*text >= '\t' && *text <= '\r')) {
+        text++;
+    }
+    if (*text == '+' || *text == '-') {
+        negative = *text++ == '-';
+    }
+    for (; *text >= '0' && *text <= '9'; text++, digits++) {
+        mantissa = mantissa * 10.0 + (*text - '0');
+    }
+    if (*text == '.') {
+        for (text++; *text >= '0' && *text <= '9'; text++, digits++, exponent--) {
+            mantissa = mantissa * 10.0 + (*text - '0');
+        }
+    }
+    if (!digits) {
+        return false;
+    }
+    if (*text == 'e' || *text == 'E') {
+        const char* mark = text + 1;
+        bool negativePower = false;
+        int power = 0;
+        if (*mark == '+' || *mark == '-') {
+            negativePower = *mark++ == '-';
+        }
+        for (; *mark >= '0' && *mark <= '9'; mark++) {
+            power = power < 1000 ? power * 10 + (*mark - '0') : power;
+        }
+        if (mark > text + 1 && mark[-1] >= '0' && mark[-1] <= '9') {
+            exponent += negativePower ? -power : power;
+        }
+    }
+    if (mantissa != 0.0) {
+        mantissa = PREFIX_scale(mantissa, exponent);
+    }
+    /* Out of range, subnormal results included, like std::stof */
+    if (mantissa > FLT_MAX || (mantissa != 0.0 && mantissa < FLT_MIN)) {
+        return false;
+    }
+    *value = (float)(negative ? -mantissa : mantissa);
+    return true;
+}
+)===";
+
+/**
+ * @brief Replaces every PREFIX in a template with the prefix of the machine
+ *
+ * @param text Template
+ * @param prefix Prefix of the generated names
+ * @return The text with the prefix filled in
+ */
+static std::string withPrefix(std::string text, const std::string& prefix) {
+    static const std::string token = "PREFIX";
+    for (size_t at = text.find(token); at != std::string::npos; at = text.find(token, at + prefix.size())) {
+        text.replace(at, token.size(), prefix);
+    }
+    return text;
+}
+
+/**
+ * @brief Gets the C type holding values of a machine type, text lives in arrays
+ *
+ * @param type Machine type
+ * @return Name of the C type
+ */
+static std::string cType(VariableType type) {
+    switch (type) {
+        case VariableType::INT: return "int";
+        case VariableType::FLOAT: return "float";
+        default: return "char";
+    }
+}
+
+/**
+ * @brief Constructor, names an enumerator or field for every variable, pointer and symbol
+ *
+ * @param machine Machine the statements come from, must outlive the translator
+ * @param prefix Prefix of every generated name, a valid C identifier
+ */
+CActionTranslator::CActionTranslator(const MooreMachine& machine, const std::string& prefix)
+    : machine(machine), prefix(prefix), inputText(false), outputText(false) {
+    std::set<std::string> variableNames;
+    for (const auto& variable : machine.getVariablesView()) {
+        variableNames.insert(variable.first);
+    }
+    nameFields(variableNames, variableFields, identifier);
+    nameFields(machine.getInputPointers(), inputFields, identifier);
+
+    std::set<std::string> outputNames = machine.getOutputPointers();
+    std::set<std::string> symbols = machine.getInputAlphabet();
+    ExpressionParser parser;
+    for (State* state : const_cast<MooreMachine&>(machine).getAllStates()) {
+        for (const auto& output : state->getOutputs()) {
+            CompiledOutput compiled = parser.compileOutput(output);
+            if (compiled.action == OutputAction::OUTPUT_EXPRESSION || compiled.action == OutputAction::VALUE) {
+                outputNames.insert(compiled.target);
+            }
+            bool variableSource = variableNames.count(compiled.source) > 0;
+            outputText = outputText || compiled.action == OutputAction::OUTPUT_EXPRESSION ||
+                         (compiled.action == OutputAction::VALUE && variableSource);
+            inputText = inputText || compiled.action == OutputAction::ASSIGN_INPUT;
+        }
+        for (Transition* transition : const_cast<MooreMachine&>(machine).getTransitionsFromState(state->getId())) {
+            for (const auto& condition : transition->getInputConditions()) {
+                if (!condition.isBooleanExpr) {
+                    symbols.insert(condition.value);
+                }
+            }
+        }
+    }
+    nameFields(outputNames, outputFields, identifier);
+
+    // The empty value is what a pointer holds when no symbol waits on it
+    symbols.erase("");
+    nameFields(symbols, symbolFields, identifier, {"NONE", "OTHER"});
+}
+
+/**
+ * @brief Turns a name into a C identifier
+ *
+ * The C++ keywords cover the C ones, apart from a few C99 additions.
+ *
+ * @param name Name from the machine
+ * @return A valid identifier
+ */
+std::string CActionTranslator::identifier(const std::string& name) {
+    static const std::set<std::string> keywords = {"restrict", "_Bool", "_Complex", "_Imaginary"};
+    std::string result = TypedActionTranslator::identifier(name);
+    if (keywords.count(result)) {
+        result += "_";
+    }
+    return result;
+}
+
+/**
+ * @brief Gets the fields of the variables
+ *
+ * @return Field name by variable name
+ */
+const std::map<std::string, std::string>& CActionTranslator::getVariableFields() const {
+    return variableFields;
+}
+
+/**
+ * @brief Gets the enumerators of the input pointers
+ *
+ * @return Suffix of PREFIX_INPUT_ by input pointer name, in the order of their values
+ */
+const std::map<std::string, std::string>& CActionTranslator::getInputFields() const {
+    return inputFields;
+}
+
+/**
+ * @brief Gets the enumerators of the output pointers
+ *
+ * @return Suffix of PREFIX_OUTPUT_ by output pointer name, in the order of their values
+ */
+const std::map<std::string, std::string>& CActionTranslator::getOutputFields() const {
+    return outputFields;
+}
+
+/**
+ * @brief Gets the enumerators of the input symbols
+ *
+ * @return Suffix of PREFIX_SYMBOL_ by symbol
+ */
+const std::map<std::string, std::string>& CActionTranslator::getSymbolFields() const {
+    return symbolFields;
+}
+
+/**
+ * @brief Checks whether any statement reads an input pointer as text
+ *
+ * @return True if the machine struct has to keep the text of the inputs
+ */
+bool CActionTranslator::readsInputText() const {
+    return inputText;
+}
+
+/**
+ * @brief Checks whether any statement writes computed text to an output
+ *
+ * @return True if the machine struct needs buffers for output text
+ */
+bool CActionTranslator::writesOutputText() const {
+    return outputText;
+}
+
+/**
+ * @brief Gets the C declaration of a variable field
+ *
+ * @param variable Name of the variable
+ * @return Declaration such as "int count;"
+ */
+std::string CActionTranslator::variableDeclaration(const std::string& variable) const {
+    VariableType type = machine.getVariablesView().at(variable).getType();
+    std::string field = variableFields.at(variable);
+    if (type == VariableType::INT || type == VariableType::FLOAT) {
+        return cType(type) + " " + field + ";";
+    }
+    return "char " + field + "[" + prefix + "_TEXT_CAPACITY];";
+}
+
+/**
+ * @brief Gets the statement storing the initial value of a variable
+ *
+ * @param variable Name of the variable
+ * @return Statement without indentation
+ */
+std::string CActionTranslator::variableInitialization(const std::string& variable) const {
+    const MachineVariable& value = machine.getVariablesView().at(variable);
+    std::string target = "fsm->variables." + variableFields.at(variable);
+    if (value.getType() == VariableType::INT) {
+        return target + " = " + value.getValueString() + ";";
+    }
+    if (value.getType() == VariableType::FLOAT) {
+        return target + " = " + floatLiteral(std::get<float>(value.getValue())) + ";";
+    }
+    return prefix + "_copy(" + target + ", " + ActionTranslator::literal(value.getValueString()) + ");";
+}
+
+/**
+ * @brief Gets the helper functions the emitted statements call
+ *
+ * The code needs <float.h>, <limits.h>, <stdbool.h>, <stddef.h> and <stdint.h>,
+ * all available to freestanding programs.
+ *
+ * @return Definitions of the text, print and parse helpers, all static inline
+ */
+std::string CActionTranslator::helperFunctions() const {
+    return withPrefix(cHelperSource, prefix);
+}
+
+/**
+ * @brief Gets the constant outputs of a state
+ *
+ * @param state State to inspect
+ * @param outputs Receives the literal written to each output pointer, the last one wins
+ * @return True if every statement of the state writes a literal to an output, unconditionally
+ */
+bool CActionTranslator::constantOutputs(const State& state, std::map<std::string, std::string>& outputs) const {
+    ExpressionParser parser;
+    outputs.clear();
+    for (const auto& output : state.getOutputs()) {
+        CompiledOutput compiled = parser.compileOutput(output);
+        if (compiled.hasCondition || compiled.action != OutputAction::VALUE ||
+            variableFields.count(compiled.source)) {
+            return false;
+        }
+        outputs[compiled.target] = compiled.source;
+    }
+    return true;
+}
+
+/**
+ * @brief Translates an operand of an instruction
+ *
+ * @param program Program the instruction belongs to
+ * @param instruction Instruction with the operand
+ * @param operand Translated operand
+ * @return False if the operand names an unknown variable
+ */
+bool CActionTranslator::operand(const ExpressionProgram& program, const Instruction& instruction, Value& operand) const {
+    switch (instruction.kind) {
+        case OperandKind::CONSTANT: {
+            const MachineVariable& constant = program.getConstant(instruction.index);
+            operand.type = constant.getType();
+            if (operand.type == VariableType::FLOAT) {
+                operand.code = floatLiteral(std::get<float>(constant.getValue()));
+            } else if (operand.type == VariableType::STRING) {
+                operand.code = ActionTranslator::literal(constant.getValueString());
+            } else {
+                operand.code = constant.getValueString();
+            }
+            return true;
+        }
+        case OperandKind::VARIABLE: {
+            auto it = variableFields.find(program.getSlotName(instruction.index));
+            if (it == variableFields.end()) {
+                return false;
+            }
+            operand.type = machine.getVariablesView().at(it->first).getType();
+            operand.code = "fsm->variables." + it->second;
+            return true;
+        }
+        default:
+            operand.type = VariableType::INT;
+            operand.code = "(int)(fsm->now - fsm->entered_at)";
+            return true;
+    }
+}
+
+/**
+ * @brief Translates an expression into local variables named value0, value1, ...
+ *
+ * Same rules as TypedActionTranslator::expression, text is appended to a
+ * local buffer.
+ *
+ * @param program Compiled expression
+ * @param indent Indentation of the statements
+ * @param ss Stream receiving the statements
+ * @param result Variable holding the value when the statements complete
+ * @return False if the statements always return an error and result must not be used
+ */
+bool CActionTranslator::expression(const ExpressionProgram& program, const std::string& indent,
+                                   std::stringstream& ss, Value& result) const {
+    int locals = 0;
+    auto declare = [&](VariableType type, const std::string& initial) {
+        result.type = type;
+        result.code = "value" + std::to_string(locals++);
+        if (type == VariableType::STRING) {
+            ss << indent << "char " << result.code << "[" << prefix << "_TEXT_CAPACITY];" << std::endl
+               << indent << result.code << "[0] = '\\0';" << std::endl
+               << indent << prefix << "_append(" << result.code << ", " << initial << ");" << std::endl;
+        } else {
+            ss << indent << cType(type) << " " << result.code << " = " << initial << ";" << std::endl;
+        }
+    };
+
+    for (const Instruction& instruction : program.getInstructions()) {
+        if (instruction.op == OpCode::FAIL) {
+            ss << indent << "return " << ActionTranslator::literal(program.getError(instruction.index)) << ";" << std::endl;
+            return false;
+        }
+        if (instruction.kind == OperandKind::NONE) {
+            continue;
+        }
+
+        Value value;
+        if (!operand(program, instruction, value)) {
+            ss << indent << "return "
+               << ActionTranslator::literal("Unknown variable: " + program.getSlotName(instruction.index)) << ";" << std::endl;
+            return false;
+        }
+
+        if (instruction.op == OpCode::LOAD) {
+            declare(value.type, value.code);
+            continue;
+        }
+
+        // The accumulator of a program starting with an operation holds int 0
+        if (locals == 0) {
+            declare(VariableType::INT, "0");
+        }
+
+        char op = instruction.operation;
+        if (result.type == VariableType::STRING || value.type == VariableType::STRING) {
+            if (result.type != VariableType::STRING || op != '+') {
+                ss << indent << "return "
+                   << ActionTranslator::literal(std::string("Incompatible types for operation ") + op) << ";" << std::endl;
+                return false;
+            }
+            std::string append = value.type == VariableType::STRING ? "_append(" :
+                                 value.type == VariableType::FLOAT ? "_append_float(" : "_append_int(";
+            ss << indent << prefix << append << result.code << ", " << value.code << ");" << std::endl;
+            continue;
+        }
+
+        // Mixing int with float promotes the accumulator
+        if (result.type == VariableType::INT && value.type == VariableType::FLOAT) {
+            declare(VariableType::FLOAT, "(float)" + result.code);
+        }
+        if (result.type == VariableType::FLOAT && value.type == VariableType::INT) {
+            value.code = "(float)" + value.code;
+        }
+
+        if (op == '/') {
+            ss << indent << "{" << std::endl
+               << indent << "    " << cType(result.type) << " divisor = " << value.code << ";" << std::endl
+               << indent << "    if (divisor == 0) return \"Division by zero\";" << std::endl
+               << indent << "    " << result.code << " /= divisor;" << std::endl
+               << indent << "}" << std::endl;
+        } else {
+            ss << indent << result.code << " " << op << "= " << value.code << ";" << std::endl;
+        }
+    }
+
+    // An empty program leaves the default value
+    if (locals == 0) {
+        declare(VariableType::INT, "0");
+    }
+    return true;
+}
+
+/**
+ * @brief Translates storing a value in a text buffer
+ *
+ * @param target Buffer of PREFIX_TEXT_CAPACITY bytes
+ * @param value Value to print
+ * @return The statement without indentation
+ */
+std::string CActionTranslator::storeText(const std::string& target, const Value& value) const {
+    std::string store = value.type == VariableType::STRING ? "_copy(" :
+                        value.type == VariableType::FLOAT ? "_store_float(" : "_store_int(";
+    return prefix + store + target + ", " + value.code + ");";
+}
+
+/**
+ * @brief Translates storing a value in a variable, converting it like MachineSimulator
+ *
+ * The simulator stores every value through its text, so a float keeps six
+ * significant digits and a float stored in an int variable is truncated.
+ * Only an int stored in an int or float variable is stored directly.
+ *
+ * @param variable Name of the assigned variable
+ * @param value Value to store
+ * @param indent Indentation of the statements
+ * @return The statements
+ */
+std::string CActionTranslator::assignment(const std::string& variable, const Value& value, const std::string& indent) const {
+    VariableType type = machine.getVariablesView().at(variable).getType();
+    std::string target = "fsm->variables." + variableFields.at(variable);
+
+    if (type == VariableType::STRING) {
+        return indent + storeText(target, value) + "\n";
+    }
+    if (type == VariableType::INT && value.type == VariableType::INT) {
+        return indent + target + " = " + value.code + ";\n";
+    }
+    // An int is the nearest float to its own text
+    if (type == VariableType::FLOAT && value.type == VariableType::INT) {
+        return indent + target + " = (float)" + value.code + ";\n";
+    }
+
+    std::string parse = type == VariableType::INT ? "_parse_int(" : "_parse_float(";
+    if (value.type == VariableType::STRING) {
+        return indent + "if (!" + prefix + parse + value.code + ", &" + target + ")) return \"Failed to parse value\";\n";
+    }
+    return indent + "{\n" +
+           indent + "    char text[16];\n" +
+           indent + "    " + prefix + "_format_float(text, " + value.code + ");\n" +
+           indent + "    if (!" + prefix + parse + "text, &" + target + ")) return \"Failed to parse value\";\n" +
+           indent + "}\n";
+}
+
+/**
+ * @brief Translates the text of a value for a comparison
+ *
+ * @param value Value to print
+ * @param buffer Local buffer a number is printed to
+ * @param ss Stream receiving the statement printing a number
+ * @param indent Indentation of the statement
+ * @return Expression of type const char* holding the text
+ */
+std::string CActionTranslator::textOf(const Value& value, const std::string& buffer, std::stringstream& ss,
+                                      const std::string& indent) const {
+    if (value.type == VariableType::STRING) {
+        return value.code;
+    }
+    ss << indent << "char " << buffer << "[16];" << std::endl
+       << indent << prefix << (value.type == VariableType::FLOAT ? "_format_float(" : "_format_int(")
+       << buffer << ", " << value.code << ");" << std::endl;
+    return buffer;
+}
+
+/**
+ * @brief Translates the conditions of a transition
+ *
+ * Values are compared as text, like Transition::isTriggered does. Where the
+ * types allow it the comparison is made on the values directly.
+ *
+ * @param transition Transition to translate
+ * @param indent Indentation of the statements
+ * @return Statements returning true from the enclosing function if a condition holds
+ */
+std::string CActionTranslator::guard(const Transition& transition, const std::string& indent) const {
+    std::stringstream ss;
+    const auto& variables = machine.getVariablesView();
+
+    for (const auto& condition : transition.getInputConditions()) {
+        if (!condition.isBooleanExpr) {
+            auto input = inputFields.find(condition.source);
+            auto symbol = symbolFields.find(condition.value);
+            if (input != inputFields.end() && symbol != symbolFields.end()) {
+                ss << indent << "if (fsm->inputs[" << prefix << "_INPUT_" << input->second << "] == "
+                   << prefix << "_SYMBOL_" << symbol->second << ") return true;" << std::endl;
+            }
+            continue;
+        }
+
+        auto left = variableFields.find(condition.leftOperand);
+        if (left == variableFields.end() || (condition.operation != "==" && condition.operation != "!=")) {
+            continue;
+        }
+        const std::string& op = condition.operation;
+        Value leftValue{"fsm->variables." + left->second, variables.at(left->first).getType()};
+
+        auto right = variableFields.find(condition.rightOperand);
+        Value rightValue{ActionTranslator::literal(condition.rightOperand), VariableType::STRING};
+        if (right != variableFields.end()) {
+            rightValue = Value{"fsm->variables." + right->second, variables.at(right->first).getType()};
+        }
+
+        if (leftValue.type == VariableType::INT && rightValue.type == VariableType::INT) {
+            ss << indent << "if (" << leftValue.code << " " << op << " " << rightValue.code << ") return true;" << std::endl;
+            continue;
+        }
+        if (leftValue.type == VariableType::INT && right == variableFields.end()) {
+            // Only text an int prints as can equal it
+            const std::string& text = condition.rightOperand;
+            char* end = nullptr;
+            long number = std::strtol(text.c_str(), &end, 10);
+            bool printable = !text.empty() && *end == '\0' && std::to_string(static_cast<int>(number)) == text;
+            if (printable) {
+                ss << indent << "if (" << leftValue.code << " " << op << " " << number << ") return true;" << std::endl;
+            } else if (op == "!=") {
+                ss << indent << "return true;" << std::endl;
+                break;
+            }
+            continue;
+        }
+
+        std::stringstream texts;
+        std::string inner = indent + "    ";
+        std::string leftText = textOf(leftValue, "left", texts, inner);
+        std::string rightText = textOf(rightValue, "right", texts, inner);
+        std::string test = std::string(op == "==" ? "" : "!") + prefix + "_text_equal(" + leftText + ", " + rightText + ")";
+        if (texts.str().empty()) {
+            ss << indent << "if (" << test << ") return true;" << std::endl;
+        } else {
+            ss << indent << "{" << std::endl
+               << texts.str()
+               << inner << "if (" << test << ") return true;" << std::endl
+               << indent << "}" << std::endl;
+        }
+    }
+    return ss.str();
+}
+
+/**
+ * @brief Translates the output statements of a state
+ *
+ * A literal sent to an output is pointed to, computed text is printed to the
+ * output's buffer first.
+ *
+ * @param state State to translate
+ * @param indent Indentation of the statements
+ * @return Statements executing the outputs in order, returning the message of a failure
+ */
+std::string CActionTranslator::outputs(const State& state, const std::string& indent) const {
+    std::stringstream ss;
+    ExpressionParser parser;
+
+    for (const auto& output : state.getOutputs()) {
+        CompiledOutput compiled = parser.compileOutput(output);
+        if (compiled.hasCondition) {
+            auto input = inputFields.find(compiled.conditionPtr);
+            if (input == inputFields.end()) {
+                continue;
+            }
+            ss << indent << "if (fsm->inputs[" << prefix << "_INPUT_" << input->second << "] != " << prefix << "_SYMBOL_NONE) {" << std::endl;
+        } else {
+            ss << indent << "{" << std::endl;
+        }
+        std::string inner = indent + "    ";
+
+        auto variable = variableFields.find(compiled.target);
+        auto setOutput = [&](const Value& value) {
+            std::string index = prefix + "_OUTPUT_" + outputFields.at(compiled.target);
+            ss << inner << storeText("fsm->output_text[" + index + "]", value) << std::endl
+               << inner << "fsm->outputs[" << index << "] = fsm->output_text[" << index << "];" << std::endl;
+        };
+        Value value;
+        switch (compiled.action) {
+            case OutputAction::ASSIGN_INPUT:
+                if (variable != variableFields.end()) {
+                    auto input = inputFields.find(compiled.source);
+                    Value source{input != inputFields.end() ?
+                                 "fsm->input_text[" + prefix + "_INPUT_" + input->second + "]" : "\"\"",
+                                 VariableType::STRING};
+                    ss << assignment(compiled.target, source, inner);
+                }
+                break;
+            case OutputAction::ASSIGN_EXPRESSION:
+                if (expression(compiled.program, inner, ss, value)) {
+                    if (variable != variableFields.end()) {
+                        ss << assignment(compiled.target, value, inner);
+                    } else {
+                        ss << inner << "(void)" << value.code << ";" << std::endl;
+                    }
+                }
+                break;
+            case OutputAction::OUTPUT_EXPRESSION:
+                if (expression(compiled.program, inner, ss, value)) {
+                    setOutput(value);
+                }
+                break;
+            case OutputAction::VALUE: {
+                auto source = variableFields.find(compiled.source);
+                if (source != variableFields.end()) {
+                    setOutput(Value{"fsm->variables." + source->second, machine.getVariablesView().at(compiled.source).getType()});
+                } else {
+                    ss << inner << "fsm->outputs[" << prefix << "_OUTPUT_" << outputFields.at(compiled.target) << "] = "
+                       << ActionTranslator::literal(compiled.source) << ";" << std::endl;
+                }
+                break;
+            }
+            case OutputAction::INVALID:
+                ss << inner << "return " << ActionTranslator::literal(compiled.source) << ";" << std::endl;
+                break;
+        }
+        ss << indent << "}" << std::endl;
+    }
+    return ss.str();
+}
@@ -10,7 +10,11 @@
 #include <QGroupBox>
 #include <QComboBox>
 #include <QTime>
+#include <QPointer>
+#include <QEvent>
+#include <QScrollBar>
 #include <stdexcept>
+#include <climits>
 
 /**
  * @brief Construct a new Automaton Editor object
@@ -27,7 +31,8 @@ AutomatonEditor::AutomatonEditor(const QString &automatonName, QWidget *parent)
     simulationTimer(new QTimer(this)),
     connectionTimer(new QTimer(this)),
     simulationActive(false),
-    connectionActive(false)
+    connectionActive(false),
+    codeExport(nullptr)
 {
     ui->setupUi(this);
     setupUi();
@@ -59,7 +64,8 @@ AutomatonEditor::AutomatonEditor(const QString& filePath, bool loadFromFile, QWi
     simulationTimer(new QTimer(this)),
     connectionTimer(new QTimer(this)),
     simulationActive(false),
-    connectionActive(false)
+    connectionActive(false),
+    codeExport(nullptr)
 {
     ui->setupUi(this);
     setupUi();
@@ -97,6 +103,11 @@ void AutomatonEditor::setupUi()
     // Initialize scene
     scene = new QGraphicsScene(this);
     ui->graphicsView->setScene(scene);
+
+    // Transitions are laid out only in the part of the scene the view shows
+    ui->graphicsView->viewport()->installEventFilter(this);
+    connect(ui->graphicsView->horizontalScrollBar(), &QScrollBar::valueChanged, this, &AutomatonEditor::updateVisibleArea);
+    connect(ui->graphicsView->verticalScrollBar(), &QScrollBar::valueChanged, this, &AutomatonEditor::updateVisibleArea);
     
     // Add menu bar
     QMenu *fileMenu = menuBar()->addMenu("&File");
@@ -125,21 +136,48 @@ void AutomatonEditor::setupUi()
     connect(codeGenAction, &QAction::triggered, this, &AutomatonEditor::on_actionGenGoto_triggered);
     fileMenu->addAction(genGotoAction);
 
+    QAction *genTypedAction = new QAction("Generate &Typed structs", this);
+    connect(genTypedAction, &QAction::triggered, this, &AutomatonEditor::on_actionGenTyped_triggered);
+    fileMenu->addAction(genTypedAction);
+
+    QAction *genCAction = new QAction("Generate &C header", this);
+    connect(genCAction, &QAction::triggered, this, &AutomatonEditor::on_actionGenC_triggered);
+    fileMenu->addAction(genCAction);
+
     QAction *connectAction = new QAction("&Connect to a running automaton", this);
     connect(connectAction, &QAction::triggered, this, &AutomatonEditor::on_actionConnect_triggered);
     fileMenu->addAction(connectAction);
 
+    QAction *recordAction = new QAction("&Record trace", this);
+    recordAction->setCheckable(true);
+    connect(recordAction, &QAction::triggered, this, &AutomatonEditor::on_actionRecordTrace_triggered);
+    fileMenu->addAction(recordAction);
+
     fileMenu->addSeparator();
 
     QAction *exitAction = new QAction("E&xit", this);
     exitAction->setShortcut(QKeySequence::Quit);
     connect(exitAction, &QAction::triggered, this, &AutomatonEditor::on_actionExit_triggered);
     fileMenu->addAction(exitAction);
+
+    QMenu *editMenu = menuBar()->addMenu("&Edit");
+
+    QAction *undoAction = new QAction("&Undo", this);
+    undoAction->setShortcut(QKeySequence::Undo);
+    connect(undoAction, &QAction::triggered, this, &AutomatonEditor::on_actionUndo_triggered);
+    editMenu->addAction(undoAction);
+
+    QAction *redoAction = new QAction("&Redo", this);
+    redoAction->setShortcut(QKeySequence::Redo);
+    connect(redoAction, &QAction::triggered, this, &AutomatonEditor::on_actionRedo_triggered);
+    editMenu->addAction(redoAction);
     
     // Set up simulation controls
     setupSimulationControls();
     
-    // Connect the simulation timer
+    // Connect the simulation timer, it is rearmed after every step for the next deadline
+    simulationTimer->setSingleShot(true);
+    simulationTimer->setTimerType(Qt::PreciseTimer);
     connect(simulationTimer, &QTimer::timeout, this, &AutomatonEditor::simulationStep);
 
     // Connect the connection timer
@@ -224,48 +262,7 @@ void AutomatonEditor::createNewState(const QString& name, int x, int y, bool isS
     }
 
     // Add to visual representation
-    state_ellipse_item* stateEllipse = new state_ellipse_item(QRectF(x, y, 60, 60));
-    scene->addItem(stateEllipse);
-
-    connect(stateEllipse, &state_ellipse_item::stateMoved, this, [=]() {
-        updateTransitionsForState(stateId);
-    });
-
-    stateEllipse->setBrush(Qt::white);  // Fill the inside with white
-    stateEllipse->setZValue(1);
-    QGraphicsTextItem* label = scene->addText(name);
-    label->setZValue(3);
-    // Center label
-    QRectF ellipseRect = stateEllipse->rect();
-    QRectF textRect = label->boundingRect();
-
-    qreal labelX = x + ellipseRect.width() / 2 - textRect.width() / 2;
-    qreal labelY = y + ellipseRect.height() / 2 - textRect.height() / 2;
-    label->setPos(labelX, labelY);
-
-    if (isFinal) {
-        QGraphicsEllipseItem* innerEllipse = new QGraphicsEllipseItem(x + 5, y + 5, 50, 50, stateEllipse); // Bind it to the stateEllipse
-        scene->addItem(innerEllipse);
-        innerEllipse->setZValue(2);
-    }
-
-    if (isStart) {
-        QGraphicsLineItem* lineStart = new QGraphicsLineItem(x - 30, y + 30, x, y + 30, stateEllipse); // Line to the state
-        scene->addItem(lineStart);
-    }
-
-
-    // Store data in QMap
-    StateItem state;
-    state.id = stateId;
-    state.name = name;
-    state.isStart = isStart;
-    state.isFinal = isFinal;
-    state.position = QPoint(x, y);
-    state.ellipse = stateEllipse;
-    state.label = label;
-
-    states[stateId] = state;
+    addStateItem(stateId, name, QPoint(x, y), isStart, isFinal);
 
     addLog(QString("State %1 added successfully").arg(name));
 
@@ -394,22 +391,10 @@ void AutomatonEditor::on_pushButton_add_transition_clicked()
         return;
     }
 
-    // Get states for visual representation
-    StateItem* stateFrom = &states[fromId];
-    StateItem* stateTo = &states[toId];
-
     // Get the transition from backend
     Transition* backendTransition = fsmBridge->getMachine()->getTransition(transitionId.toStdString());
     QString inputLabel = backendTransition ? fsmBridge->getInputConditionsString(backendTransition) : "(?)";
 
-    // Create a visual representation of the transition
-    TransitionItem transition;
-    transition.id = transitionId;
-    transition.stateFrom = stateFrom;
-    transition.stateTo = stateTo;
-    transition.inputValue = inputLabel;
-    transition.isBoolean = false;
-
     // Add input symbols to the alphabet and update the tab widget list
     for (const QPair<QString, QString> &condition : inputConditions) {
         const QString &symbol = condition.first;
@@ -431,45 +416,8 @@ void AutomatonEditor::on_pushButton_add_transition_clicked()
         }
     }
 
-    // Handle self-transition
-    if (fromId == toId) {
-        QPainterPath path;
-
-        qreal radius = 20;
-        qreal loopRadius = 60;
-        qreal x = stateFrom->position.x() + loopRadius/2;
-        qreal y = stateFrom->position.y() + radius/2;
-
-        path.moveTo(x + radius, y); // Move
-        path.cubicTo(x + loopRadius, y - loopRadius,
-                     x - loopRadius, y - loopRadius,
-                     x - radius, y); // Create a loop
-
-        // Add to scene
-        transition.pathItem = scene->addPath(path, QPen(Qt::black));
-        transition.pathItem->setZValue(0); // make the line appear nehind the states
-        transition.labelItem = scene->addText(inputLabel);
-        transition.labelItem->setPos(x - 10, y - loopRadius - 10);
-    }
-    else { // Between two states
-        QPointF p1 = stateFrom->ellipse->sceneBoundingRect().center();
-        QPointF p2 = stateTo->ellipse->sceneBoundingRect().center();
-
-        QPainterPath path;
-        path.moveTo(p1);
-        path.lineTo(p2);
-
-        transition.pathItem = scene->addPath(path, QPen(Qt::black));
-        transition.pathItem->setZValue(0);
-
-        qreal midX = (p1.x() + p2.x()) / 2;
-        qreal midY = (p1.y() + p2.y()) / 2;
-
-        transition.labelItem = scene->addText(inputLabel);
-        transition.labelItem->setPos(midX, midY);
-    }
-
-    transitions[transitionId] = transition;
+    // Create a visual representation of the transition
+    addTransitionItem(transitionId, fromId, toId, inputLabel, false);
 
     // Add it to the list widget
     ui->listWidget_transitions->addItem(transitionId);
@@ -532,59 +480,9 @@ void AutomatonEditor::on_pushButton_add_bool_transition_clicked()
         return;
     }
 
-    // Get states for visual representation
-    StateItem* stateFrom = &states[fromId];
-    StateItem* stateTo = &states[toId];
-
-    QString inputLabel = QString("%1%2%3").arg(leftOp, op, rightOp);
-
     // Create a visual representation of the transition
-    TransitionItem transition;
-    transition.id = transitionId;
-    transition.stateFrom = stateFrom;
-    transition.stateTo = stateTo;
-    transition.inputValue = inputLabel;
-    transition.isBoolean = true;
-
-    // Handle self-transition
-    if (fromId == toId) {
-        QPainterPath path;
-
-        qreal radius = 20;
-        qreal loopRadius = 60;
-        qreal x = stateFrom->position.x() + loopRadius/2;
-        qreal y = stateFrom->position.y() + radius/2;
-
-        path.moveTo(x + radius, y); // Move
-        path.cubicTo(x + loopRadius, y - loopRadius,
-                     x - loopRadius, y - loopRadius,
-                     x - radius, y); // Create a loop
-
-        // Add to scene
-        transition.pathItem = scene->addPath(path, QPen(Qt::black));
-        transition.pathItem->setZValue(0); // make the line appear nehind the states
-        transition.labelItem = scene->addText(inputLabel);
-        transition.labelItem->setPos(x - 10, y - loopRadius - 10);
-    }
-    else { // Between two states
-        QPointF p1 = stateFrom->ellipse->sceneBoundingRect().center();
-        QPointF p2 = stateTo->ellipse->sceneBoundingRect().center();
-
-        QPainterPath path;
-        path.moveTo(p1);
-        path.lineTo(p2);
-
-        transition.pathItem = scene->addPath(path, QPen(Qt::black));
-        transition.pathItem->setZValue(0);
-
-        qreal midX = (p1.x() + p2.x()) / 2;
-        qreal midY = (p1.y() + p2.y()) / 2;
-
-        transition.labelItem = scene->addText(inputLabel);
-        transition.labelItem->setPos(midX, midY);
-    }
-
-    transitions[transitionId] = transition;
+    QString inputLabel = QString("%1%2%3").arg(leftOp, op, rightOp);
+    addTransitionItem(transitionId, fromId, toId, inputLabel, true);
 
     // Add it to the list widget
     ui->listWidget_transitions->addItem(transitionId);
@@ -670,10 +568,7 @@ void AutomatonEditor::on_pushButton_edit_transition_clicked()
     QString newLabel = fsmBridge->getInputConditionsString(
         fsmBridge->getMachine()->getTransition(transitionId.toStdString())
     );
-    t.inputValue = newLabel;
-    if (t.labelItem) {
-        t.labelItem->setPlainText(newLabel);
-    }
+    setTransitionLabel(t, newLabel);
 
     addLog(QString("Transition from %1 to %2 updated").arg(fromName, toName));
 }
@@ -712,40 +607,8 @@ void AutomatonEditor::on_pushButton_remove_state_clicked()
         return;
     }
 
-    // Remove visual representation
-    StateItem& state = states[stateId];
-    if (state.ellipse) {
-        scene->removeItem(state.ellipse);
-        delete state.ellipse;
-    }
-    if (state.label) {
-        scene->removeItem(state.label);
-        delete state.label;
-    }
-
-    // Remove associated transitions
-    QList<QString> transitionsToRemove;
-    for (auto it = transitions.begin(); it != transitions.end(); ++it) {
-        if (it.value().stateFrom->id == stateId || it.value().stateTo->id == stateId) {
-            if (it.value().pathItem) {
-                scene->removeItem(it.value().pathItem);
-                delete it.value().pathItem;
-            }
-            if (it.value().labelItem) {
-                scene->removeItem(it.value().labelItem);
-                delete it.value().labelItem;
-            }
-            transitionsToRemove.append(it.key());
-        }
-    }
-
-    // Remove transition items
-    for (const QString& transId : transitionsToRemove) {
-        transitions.remove(transId);
-    }
-
-    // Remove the state item
-    states.remove(stateId);
+    // Remove visual representation with the associated transitions
+    removeStateItem(stateId);
 
     if (states.isEmpty()) {
         //disable another buttons
@@ -809,17 +672,7 @@ void AutomatonEditor::on_pushButton_remove_transition_clicked()
         fsmBridge->removeTransition(transitionId);
 
         // Remove graphics
-        TransitionItem& t = transitions[transitionId];
-        if (t.pathItem) {
-            scene->removeItem(t.pathItem);
-            delete t.pathItem;
-        }
-        if (t.labelItem) {
-            scene->removeItem(t.labelItem);
-            delete t.labelItem;
-        }
-
-        transitions.remove(transitionId);
+        removeTransitionItem(transitionId);
     }
 
     delete selectedTransition;
@@ -863,7 +716,11 @@ void AutomatonEditor::on_pushButton_start_clicked()
 {
     if (!fsmBridge->isValid()) {
         QStringList errors = fsmBridge->getValidationErrors();
+        QStringList warnings = fsmBridge->getAnalysisWarnings();
         QString errorMsg = "The automaton is not valid:\n" + errors.join("\n");
+        if (!warnings.isEmpty()) {
+            errorMsg += "\n\nWarnings:\n" + warnings.join("\n");
+        }
         QMessageBox::warning(this, "Invalid Automaton", errorMsg);
         return;
     }
@@ -873,6 +730,13 @@ void AutomatonEditor::on_pushButton_start_clicked()
         return;
     }
 
+    // Report what the analysis found before starting, it does not stop the simulation
+    if (!simulationActive) {
+        for (const QString& warning : fsmBridge->getAnalysisWarnings()) {
+            addLog(QString("Warning: %1").arg(warning));
+        }
+    }
+
     // Toggle simulation state
     toggleSimulation(!simulationActive);
 }
@@ -889,7 +753,7 @@ void AutomatonEditor::toggleSimulation(bool active)
         // Start simulation
         addLog(QString("Simulation started"));
         fsmBridge->resetSimulation();
-        simulationTimer->start(100); // Check every 100 ms, fix later if needed
+        scheduleSimulationStep();
         
         // Update UI
         ui->pushButton_start->setText("Stop");
@@ -907,10 +771,7 @@ void AutomatonEditor::toggleSimulation(bool active)
         }
         
         // Highlight initial state
-        QString currentState = fsmBridge->getCurrentStateId();
-        if (!currentState.isEmpty()) {
-            highlightState(currentState, true);
-        }
+        showCurrentState(fsmBridge->getCurrentStateId());
         
         // Update status
         QLabel *statusLabel = findChild<QLabel*>("statusLabel");
@@ -938,10 +799,7 @@ void AutomatonEditor::toggleSimulation(bool active)
         }
         
         // Remove highlights
-        QString currentState = fsmBridge->getCurrentStateId();
-        if (!currentState.isEmpty()) {
-            highlightState(currentState, false);
-        }
+        showCurrentState(QString());
         
         // Update status
         QLabel *statusLabel = findChild<QLabel*>("statusLabel");
@@ -954,7 +812,7 @@ void AutomatonEditor::toggleSimulation(bool active)
 /**
  * @brief Execute one step of the simulation cycle
  * 
- * Invoked periodically by the QTimer to evaluate timeout or process condition-based transitions,
+ * Invoked by the QTimer when the next timeout is due or a new state has to be evaluated,
  * update the visual state, and log output changes
  */
 void AutomatonEditor::simulationStep()
@@ -967,11 +825,8 @@ void AutomatonEditor::simulationStep()
 
     //addLog(QString("Current state is %1").arg(currentState));
     
-    // Update visualization
-    for (auto it = states.begin(); it != states.end(); ++it) {
-        bool isCurrentState = (it.key() == currentState);
-        highlightState(it.key(), isCurrentState);
-    }
+    // Update visualization, only the previous and the new current state change
+    showCurrentState(currentState);
 
     // Log state transition
     if (currentState != lastLoggedState && !currentState.isEmpty()) {
@@ -996,6 +851,28 @@ void AutomatonEditor::simulationStep()
         addLog(QString("Outputs: %1").arg(outputLogs.join(", ")));
         lastOutputs = newOutputs;
     }
+
+    scheduleSimulationStep();
+}
+
+/**
+ * @brief Start the simulation timer for the next step the simulation needs
+ * 
+ * Sleeps until the next timeout instead of polling, and stops the timer
+ * while the simulation waits for an input
+ */
+void AutomatonEditor::scheduleSimulationStep()
+{
+    if (!simulationActive) {
+        return;
+    }
+
+    int delay = fsmBridge->getMsUntilNextStep();
+    if (delay < 0) {
+        simulationTimer->stop();
+        return;
+    }
+    simulationTimer->start(delay);
 }
 
 /**
@@ -1030,17 +907,12 @@ void AutomatonEditor::onInputEntered()
 
     // Clear the input field
     inputField->clear();
+
+    // The input may have started a timeout or moved to a new state
+    scheduleSimulationStep();
     
     // Highlight the new current state
-    QString previousState = fsmBridge->getCurrentStateId();
-    if (!previousState.isEmpty()) {
-        highlightState(previousState, false);
-    }
-    
-    QString currentState = fsmBridge->getCurrentStateId();
-    if (!currentState.isEmpty()) {
-        highlightState(currentState, true);
-    }
+    showCurrentState(fsmBridge->getCurrentStateId());
     
     // Show the output
     if (!output.isEmpty()) {
@@ -1073,20 +945,41 @@ void AutomatonEditor::highlightState(const QString& stateId, bool highlight)
     }
 }
 
+/**
+ * @brief Move the simulation highlight to the given state
+ *
+ * Only the previously highlighted state and the new one are touched,
+ * so a step costs the same no matter how many states the scene shows
+ *
+ * @param stateId ID of the current state, empty to remove the highlight
+ */
+void AutomatonEditor::showCurrentState(const QString& stateId)
+{
+    if (stateId == highlightedState) {
+        return;
+    }
+
+    if (!highlightedState.isEmpty()) {
+        highlightState(highlightedState, false);
+    }
+    if (!stateId.isEmpty()) {
+        highlightState(stateId, true);
+    }
+    highlightedState = stateId;
+}
+
 /**
  * @brief Connect/disconnect to/from a running automaton
  * @param active true to start the connection, false to end it
+ * @param instance ID of the automaton instance to connect to
  */
-void AutomatonEditor::toggleConnection(bool active)
+void AutomatonEditor::toggleConnection(bool active, quint32 instance)
 {
     connectionActive = active;
 
     if (connectionActive) {
-        // Clear existing visualization
-        clearVisualization();
-
         // Load the FSM from running automaton
-        if (!fsmBridge->connectToRunningMachine()) {
+        if (!fsmBridge->connectToRunningMachine(instance)) {
             QMessageBox::warning(this, "Error", "Failed to connect to running machine");
             return;
         }
@@ -1099,7 +992,7 @@ void AutomatonEditor::toggleConnection(bool active)
         // Update the window title
         setWindowTitle("Edit " + fsmBridge->getMachineName());
 
-        // Recreate visualization based on the loaded machine
+        // Bring the visualization in line with the loaded machine
         updateVisualization();
 
         // Load available input pointers
@@ -1186,10 +1079,7 @@ void AutomatonEditor::toggleConnection(bool active)
         }
 
         // Highlight initial state
-        QString currentState = fsmBridge->getCurrentStateId();
-        if (!currentState.isEmpty()) {
-            highlightState(currentState, true);
-        }
+        showCurrentState(fsmBridge->getCurrentStateId());
 
         // Update status
         QLabel *statusLabel = findChild<QLabel *>("statusLabel");
@@ -1216,10 +1106,7 @@ void AutomatonEditor::toggleConnection(bool active)
         }
 
         // Remove highlights
-        QString currentState = fsmBridge->getCurrentStateId();
-        if (!currentState.isEmpty()) {
-            highlightState(currentState, false);
-        }
+        showCurrentState(QString());
 
         // Update status
         QLabel *statusLabel = findChild<QLabel*>("statusLabel");
@@ -1243,11 +1130,8 @@ void AutomatonEditor::connectionStep()
 
     //addLog(QString("Current state is %1").arg(currentState));
 
-    // Update visualization
-    for (auto it = states.begin(); it != states.end(); ++it) {
-        bool isCurrentState = (it.key() == currentState);
-        highlightState(it.key(), isCurrentState);
-    }
+    // Update visualization, only the previous and the new current state change
+    showCurrentState(currentState);
 
     // Log state transition
     if (currentState != lastLoggedState && !currentState.isEmpty()) {
@@ -1313,6 +1197,10 @@ void AutomatonEditor::on_actionCodeGen_triggered()
         return;
     }
 
+    // The program consists of several files named after the chosen one
+    if (filePath.endsWith(".cpp")) {
+        filePath.chop(4);
+    }
     saveCodeToFile(filePath);
 }
 
@@ -1330,11 +1218,57 @@ void AutomatonEditor::on_actionGenGoto_triggered() {
     fsmBridge->genIncludable("goto");
 }
 
+/**
+ * @brief Generate includable file in code style Typed
+ */
+void AutomatonEditor::on_actionGenTyped_triggered() {
+    fsmBridge->genIncludable("typed");
+}
+
+/**
+ * @brief Generate includable file in code style C tables
+ */
+void AutomatonEditor::on_actionGenC_triggered() {
+    fsmBridge->genIncludable("c");
+}
+
 /**
  * @brief Connect to a running automaton
  */
 void AutomatonEditor::on_actionConnect_triggered() {
-    toggleConnection(true);
+    // One process may host many instances of the automaton, instance 0 is the only one otherwise
+    bool ok = false;
+    int instance = QInputDialog::getInt(this, "Connect", "Instance ID of the running automaton:", 0, 0, INT_MAX, 1, &ok);
+    if (!ok) {
+        return;
+    }
+    toggleConnection(true, quint32(instance));
+}
+
+/**
+ * @brief Start or stop recording a trace of the simulation or the connected automaton
+ * @param checked true to start recording, false to stop
+ */
+void AutomatonEditor::on_actionRecordTrace_triggered(bool checked) {
+    QAction *recordAction = qobject_cast<QAction*>(sender());
+
+    if (!checked) {
+        fsmBridge->stopRecording();
+        addLog("Trace recording stopped");
+        return;
+    }
+
+    QString filePath = QFileDialog::getSaveFileName(this, "Record Trace", QString(), "FSM Traces (*.fsmtrace);;All Files (*)");
+    if (filePath.isEmpty() || !fsmBridge->startRecording(filePath)) {
+        if (!filePath.isEmpty()) {
+            QMessageBox::warning(this, "Error", "Failed to create the trace file");
+        }
+        if (recordAction) {
+            recordAction->setChecked(false);
+        }
+        return;
+    }
+    addLog(QString("Recording trace to %1").arg(filePath));
 }
 
 /**
@@ -1345,6 +1279,48 @@ void AutomatonEditor::on_actionExit_triggered()
     close();
 }
 
+/**
+ * @brief Watch the graphics view for resizes to update the visible area
+ * @param watched Object receiving the event
+ * @param event The event
+ * @return False, the event is always passed on
+ */
+bool AutomatonEditor::eventFilter(QObject* watched, QEvent* event)
+{
+    if (event->type() == QEvent::Resize && watched == ui->graphicsView->viewport()) {
+        updateVisibleArea();
+    }
+    return QMainWindow::eventFilter(watched, event);
+}
+
+/**
+ * @brief Revert the last edit of the automaton
+ */
+void AutomatonEditor::on_actionUndo_triggered()
+{
+    const EditCommand* command = fsmBridge->undo();
+    if (!command) {
+        addLog("Nothing to undo");
+        return;
+    }
+    showEdit(*command);
+    addLog("Edit undone");
+}
+
+/**
+ * @brief Make the last undone edit of the automaton again
+ */
+void AutomatonEditor::on_actionRedo_triggered()
+{
+    const EditCommand* command = fsmBridge->redo();
+    if (!command) {
+        addLog("Nothing to redo");
+        return;
+    }
+    showEdit(*command);
+    addLog("Edit redone");
+}
+
 /**
  * @brief Save the current automaton to the file
  * @param filePath Destination for the file to save
@@ -1360,17 +1336,61 @@ void AutomatonEditor::saveToFile(const QString& filePath)
 }
 
 /**
- * @brief Save the current automaton to the file
- * @param filePath Destination for the file to save
+ * @brief Generate and compile the code of the current automaton in the background
+ *
+ * The editor stays usable meanwhile, a progress dialog shows the steps and can cancel the export.
+ *
+ * @param filePath Destination for the generated code without an extension
  */
 void AutomatonEditor::saveCodeToFile(const QString& filePath)
 {
-    if (!fsmBridge->saveCodeToFile(filePath)) {
+    if (codeExport) {
+        QMessageBox::warning(this, "Error", "The automaton code is still being exported");
+        return;
+    }
+    codeExport = fsmBridge->exportCode(filePath);
+    if (!codeExport) {
         QMessageBox::warning(this, "Error", "Failed to save automaton code to file");
         return;
     }
 
-    QMessageBox::information(this, "Success", "Automaton code saved successfully");
+    QPointer<QProgressDialog> dialog = new QProgressDialog("Generating code", "Cancel", 0, 0, this);
+    dialog->setWindowTitle("Exporting code");
+    dialog->setWindowModality(Qt::NonModal);
+    dialog->setAttribute(Qt::WA_DeleteOnClose);
+    dialog->setAutoClose(false);
+    dialog->setAutoReset(false);
+    dialog->setMinimumDuration(0);
+    connect(dialog, &QProgressDialog::canceled, codeExport, &CodeExportJob::cancel);
+
+    connect(codeExport, &CodeExportJob::progress, this, [dialog](int done, int total, const QString& message) {
+        if (dialog) {
+            dialog->setMaximum(total);
+            dialog->setValue(done);
+            dialog->setLabelText(message);
+        }
+    });
+    connect(codeExport, &CodeExportJob::finished, this, [this, dialog](bool success, const QString& message) {
+        bool canceled = !dialog || dialog->wasCanceled();
+        if (dialog) {
+            dialog->close();
+        }
+        codeExport->deleteLater();
+        codeExport = nullptr;
+
+        if (success) {
+            addLog(QString("Automaton code compiled to %1").arg(message));
+            QMessageBox::information(this, "Success", "Automaton code saved successfully");
+        } else if (canceled) {
+            addLog("Code export cancelled");
+        } else {
+            addLog("Code export failed");
+            QMessageBox::warning(this, "Error", "Failed to save automaton code to file:\n" + message);
+        }
+    });
+
+    addLog(QString("Exporting automaton code to %1").arg(filePath));
+    codeExport->start();
 }
 
 /**
@@ -1379,12 +1399,9 @@ void AutomatonEditor::saveCodeToFile(const QString& filePath)
  */
 void AutomatonEditor::loadFromFile(const QString& filePath)
 {
-    // Clear existing visualization
-    clearVisualization();
-
     // Load the FSM from file
     if (!fsmBridge->loadMachineFromFile(filePath)) {
-        QMessageBox::warning(this, "Error", "Failed to load automaton from file");
+        QMessageBox::warning(this, "Error", "Failed to load automaton from file:\n" + fsmBridge->getLoadError());
         return;
     }
 
@@ -1397,7 +1414,7 @@ void AutomatonEditor::loadFromFile(const QString& filePath)
     // Update the window title
     setWindowTitle("Edit " + fsmBridge->getMachineName());
     
-    // Recreate visualization based on the loaded machine
+    // Bring the visualization in line with the loaded machine
     updateVisualization();
 
     ui->pushButton_add_transition->setEnabled(true);
@@ -1483,217 +1500,499 @@ void AutomatonEditor::clearVisualization()
     // Clear data structures
     states.clear();
     transitions.clear();
+    sceneModel.clear();
+    stateGrid.clear();
+    highlightedState.clear();
 }
 
 /**
- * @brief Update the whole graphic scene with new visualisation
+ * @brief Update the graphic scene to match the machine
+ *
+ * The scene model is compared with the machine, only the states and
+ * transitions that were added, removed or changed touch the scene.
+ * Reloading the same machine costs no scene changes at all.
  */
 void AutomatonEditor::updateVisualization()
 {
-    // Create visual representations of all states
     MooreMachine* machine = fsmBridge->getMachine();
     if (!machine) {
         return;
     }
-    
-    // Get all states
-    for (State* state : machine->getAllStates()) {
-        std::string stateId = state->getId();
-        std::string stateName = state->getName();
-        bool isInitial = state->getIsInitial();
-        Point position = state->getPosition();
-        
-        // Check if this is a final state (has a "final" output)
-        bool isFinal = false;
-        for (const auto& output : state->getOutputs()) {
-            if (output.value == "final") {
-                isFinal = true;
-                break;
-            }
+
+    SceneChanges changes = sceneModel.compare(*machine);
+
+    // Removals go first, a reconnected transition is removed and added again
+    for (const std::string& transitionId : changes.removedTransitions) {
+        removeTransitionItem(QString::fromStdString(transitionId));
+    }
+    for (const std::string& stateId : changes.removedStates) {
+        removeStateItem(QString::fromStdString(stateId));
+    }
+
+    // States
+    for (const std::string& stateId : changes.addedStates) {
+        SceneState drawing = SceneModel::describeState(*machine->getState(stateId));
+        addStateItem(QString::fromStdString(stateId), QString::fromStdString(drawing.name),
+                     QPoint(static_cast<int>(drawing.position.x), static_cast<int>(drawing.position.y)),
+                     drawing.isInitial, drawing.isFinal);
+    }
+    for (const std::string& stateId : changes.changedStates) {
+        SceneState drawing = SceneModel::describeState(*machine->getState(stateId));
+        StateItem& item = states[QString::fromStdString(stateId)];
+
+        // Update only what differs
+        QString stateName = QString::fromStdString(drawing.name);
+        if (item.name != stateName) {
+            item.name = stateName;
+            item.label->setPlainText(stateName);
+            placeStateLabel(item);
+            recordState(item);
+        }
+        if (item.isStart != drawing.isInitial || item.isFinal != drawing.isFinal) {
+            setStateMarks(item, drawing.isInitial, drawing.isFinal);
         }
+        QPoint position(static_cast<int>(drawing.position.x), static_cast<int>(drawing.position.y));
+        if (item.position != position) {
+            item.ellipse->setPos(QPointF(position) - item.ellipse->rect().topLeft());
+            updateTransitionsForState(item.id);
+        }
+    }
 
-        // Create the visual representation
-        int x = position.x;
-        int y = position.y;
+    // Transitions
+    for (const std::string& transitionId : changes.addedTransitions) {
+        SceneTransition drawing = SceneModel::describeTransition(*machine->getTransition(transitionId));
+        addTransitionItem(QString::fromStdString(transitionId), QString::fromStdString(drawing.sourceId),
+                          QString::fromStdString(drawing.targetId), QString::fromStdString(drawing.label),
+                          drawing.isBoolean);
+    }
+    for (const std::string& transitionId : changes.changedTransitions) {
+        SceneTransition drawing = SceneModel::describeTransition(*machine->getTransition(transitionId));
+        TransitionItem& item = transitions[QString::fromStdString(transitionId)];
+        item.isBoolean = drawing.isBoolean;
+        setTransitionLabel(item, QString::fromStdString(drawing.label));
+    }
+}
 
-        state_ellipse_item* stateEllipse = new state_ellipse_item(QRectF(x, y, 60, 60));
-        scene->addItem(stateEllipse);
+/**
+ * @brief Create the graphics of a state and add them to the scene
+ *
+ * @param stateId ID of the state in the machine
+ * @param name State name
+ * @param position Top left corner of the state in the scene
+ * @param isStart If the state is initial
+ * @param isFinal If the state is final
+ * @return The stored state item
+ */
+StateItem& AutomatonEditor::addStateItem(const QString& stateId, const QString& name, const QPoint& position, bool isStart, bool isFinal)
+{
+    state_ellipse_item* stateEllipse = new state_ellipse_item(QRectF(position.x(), position.y(), 60, 60));
+    scene->addItem(stateEllipse);
 
-        connect(stateEllipse, &state_ellipse_item::stateMoved, this, [=]() {
-            updateTransitionsForState(QString::fromStdString(stateId));
-        });
+    connect(stateEllipse, &state_ellipse_item::stateMoved, this, [=]() {
+        updateTransitionsForState(stateId);
+    });
 
-        stateEllipse->setBrush(Qt::white);  // Fill the inside with white
-        stateEllipse->setZValue(1);
+    stateEllipse->setBrush(Qt::white);  // Fill the inside with white
+    stateEllipse->setZValue(1);
 
-        QGraphicsTextItem* label = scene->addText(QString::fromStdString(stateName));
-        label->setZValue(3);
+    QGraphicsTextItem* label = scene->addText(name);
+    label->setZValue(3);
 
-        // Center label
-        QRectF ellipseRect = stateEllipse->rect();
-        QRectF textRect = label->boundingRect();
+    // Store data in QMap
+    StateItem& state = states[stateId];
+    state.id = stateId;
+    state.name = name;
+    state.position = position;
+    state.ellipse = stateEllipse;
+    state.label = label;
 
-        qreal labelX = x + ellipseRect.width() / 2 - textRect.width() / 2;
-        qreal labelY = y + ellipseRect.height() / 2 - textRect.height() / 2;
-        label->setPos(labelX, labelY);
+    QRectF box = stateEllipse->sceneBoundingRect();
+    stateGrid.insert(stateId.toStdString(), Point(box.left(), box.top()), Point(box.right(), box.bottom()));
 
-        if (isFinal) {
-            QGraphicsEllipseItem* innerEllipse = new QGraphicsEllipseItem(x + 5, y + 5, 50, 50, stateEllipse);
-            scene->addItem(innerEllipse);
-            innerEllipse->setZValue(2);
-        }
+    placeStateLabel(state);
+    setStateMarks(state, isStart, isFinal);
 
-        if (isInitial) {
-            QGraphicsLineItem* lineStart = new QGraphicsLineItem(x - 30, y + 30, x, y + 30, stateEllipse); // Line to the state
-            scene->addItem(lineStart);
-        }
-        
-        // Store data
-        StateItem item;
-        item.id = QString::fromStdString(stateId);
-        item.name = QString::fromStdString(stateName);
-        item.isStart = isInitial;
-        item.isFinal = isFinal;
-        item.position = QPoint(x, y);
-        item.ellipse = stateEllipse;
-        item.label = label;
-        
-        states[item.id] = item;
+    return state;
+}
+
+/**
+ * @brief Center the name of a state inside its ellipse
+ * @param state The state item
+ */
+void AutomatonEditor::placeStateLabel(StateItem& state)
+{
+    QRectF ellipseRect = state.ellipse->rect();
+    QRectF textRect = state.label->boundingRect();
+
+    qreal labelX = state.position.x() + ellipseRect.width() / 2 - textRect.width() / 2;
+    qreal labelY = state.position.y() + ellipseRect.height() / 2 - textRect.height() / 2;
+    state.label->setPos(labelX, labelY);
+}
+
+/**
+ * @brief Show or hide the initial line and the final inner circle of a state
+ *
+ * @param state The state item
+ * @param isStart If the state is initial
+ * @param isFinal If the state is final
+ */
+void AutomatonEditor::setStateMarks(StateItem& state, bool isStart, bool isFinal)
+{
+    // The marks are children of the ellipse, so they use its coordinates and move with it
+    QRectF rect = state.ellipse->rect();
+
+    if (isFinal && !state.finalMark) {
+        state.finalMark = new QGraphicsEllipseItem(rect.x() + 5, rect.y() + 5, 50, 50, state.ellipse);
+        state.finalMark->setZValue(2);
+    } else if (!isFinal && state.finalMark) {
+        delete state.finalMark;
+        state.finalMark = nullptr;
     }
-    
-    // Create visual representations of all transitions
-    for (auto stateIt = states.begin(); stateIt != states.end(); ++stateIt) {
-        std::string sourceId = stateIt.key().toStdString();
-        
-        // Get all transitions from this state
-        std::vector<Transition*> outTransitions = machine->getTransitionsFromState(sourceId);
-        
-        for (Transition* transition : outTransitions) {
-            std::string targetId = transition->getTargetId();
-            QString qSourceId = QString::fromStdString(sourceId);
-            QString qTargetId = QString::fromStdString(targetId);
-            
-            // Get input condition
-            QString inputValue = fsmBridge->getInputConditionsString(transition);
-
-            // Skip if source or target state not found in our map
-            if (!states.contains(qSourceId) || !states.contains(qTargetId)) {
-                continue;
+
+    if (isStart && !state.startMark) {
+        state.startMark = new QGraphicsLineItem(rect.x() - 30, rect.y() + 30, rect.x(), rect.y() + 30, state.ellipse); // Line to the state
+    } else if (!isStart && state.startMark) {
+        delete state.startMark;
+        state.startMark = nullptr;
+    }
+
+    state.isStart = isStart;
+    state.isFinal = isFinal;
+    recordState(state);
+}
+
+/**
+ * @brief Record the name, position and marks of a state item in the scene model
+ * @param state The state item
+ */
+void AutomatonEditor::recordState(const StateItem& state)
+{
+    SceneState drawing;
+    drawing.name = state.name.toStdString();
+    drawing.position = Point(state.position.x(), state.position.y());
+    drawing.isInitial = state.isStart;
+    drawing.isFinal = state.isFinal;
+    sceneModel.setState(state.id.toStdString(), drawing);
+}
+
+/**
+ * @brief Remove the graphics of a state and of its transitions from the scene
+ * @param stateId ID of the state
+ */
+void AutomatonEditor::removeStateItem(const QString& stateId)
+{
+    auto it = states.find(stateId);
+    if (it == states.end()) {
+        return;
+    }
+
+    // Remove associated transitions, the list shrinks as they are removed
+    QStringList transitionsToRemove;
+    for (const TransitionItem* t : it->transitions) {
+        transitionsToRemove << t->id;
+    }
+    for (const QString& transitionId : transitionsToRemove) {
+        removeTransitionItem(transitionId);
+    }
+    stateGrid.remove(stateId.toStdString());
+    sceneModel.removeState(stateId.toStdString());
+
+    // Deleting the ellipse deletes the marks with it
+    delete it->ellipse;
+    delete it->label;
+
+    if (highlightedState == stateId) {
+        highlightedState.clear();
+    }
+    states.erase(it);
+}
+
+/**
+ * @brief Bring the scene and the lists in line with the elements an undone or redone edit touched
+ *
+ * Only the recorded state, transitions and variable are looked up in the machine,
+ * so this costs as much as the edit, not as much as the whole automaton.
+ *
+ * @param command The edit
+ */
+void AutomatonEditor::showEdit(const EditCommand& command)
+{
+    MooreMachine* machine = fsmBridge->getMachine();
+
+    // The state goes first, the transitions of a state brought back need its item
+    if (command.state) {
+        QString stateId = QString::fromStdString(command.state->getId());
+        State* state = machine->getState(command.state->getId());
+        if (state && !states.contains(stateId)) {
+            bool isFinal = false;
+            for (const auto& output : state->getOutputs()) {
+                isFinal = isFinal || output.value == "final";
             }
-            
-            // Get state items
-            StateItem* sourceItem = &states[qSourceId];
-            StateItem* targetItem = &states[qTargetId];
-            
-            // Create a visual representation
-            TransitionItem item;
-            item.id = QString::fromStdString(transition->getId());
-            item.stateFrom = sourceItem;
-            item.stateTo = targetItem;
-            item.inputValue = inputValue;
-            
-            // Handle self-transition
-            if (qSourceId == qTargetId) {
-                QPainterPath path;
-                
-                qreal radius = 20;
-                qreal loopRadius = 60;
-                qreal x = sourceItem->position.x() + loopRadius/2;
-                qreal y = sourceItem->position.y() + radius/2;
-                
-                path.moveTo(x + radius, y);
-                path.cubicTo(x + loopRadius, y - loopRadius,
-                             x - loopRadius, y - loopRadius,
-                             x - radius, y);
-                
-                item.pathItem = scene->addPath(path, QPen(Qt::black));
-                item.labelItem = scene->addText(item.inputValue);
-                item.labelItem->setPos(x - 10, y - loopRadius - 10);
+            Point position = state->getPosition();
+            QString name = QString::fromStdString(state->getName());
+            addStateItem(stateId, name, QPoint(position.x, position.y), state->getIsInitial(), isFinal);
+            ui->listWidget_states->addItem(name);
+        } else if (!state && states.contains(stateId)) {
+            QString name = states[stateId].name;
+            removeStateItem(stateId);
+            qDeleteAll(ui->listWidget_states->findItems(name, Qt::MatchExactly));
+        }
+    }
+
+    // Adding or removing the initial state moves the mark to another state, as does marking one
+    if ((command.state && command.state->getIsInitial()) || command.kind == EditCommand::SET_INITIAL) {
+        State* initial = machine->getInitialState();
+        QString initialId = initial ? QString::fromStdString(initial->getId()) : QString();
+        for (StateItem& item : states) {
+            if (item.isStart != (item.id == initialId)) {
+                setStateMarks(item, item.id == initialId, item.isFinal);
             }
-            else {
-                QPointF p1 = sourceItem->ellipse->sceneBoundingRect().center();
-                QPointF p2 = targetItem->ellipse->sceneBoundingRect().center();
-                
-                QPainterPath path;
-                path.moveTo(p1);
-                path.lineTo(p2);
-                
-                item.pathItem = scene->addPath(path, QPen(Qt::black));
-                
-                qreal midX = (p1.x() + p2.x()) / 2;
-                qreal midY = (p1.y() + p2.y()) / 2;
-                
-                item.labelItem = scene->addText(item.inputValue);
-                item.labelItem->setPos(midX, midY);
+        }
+    }
+
+    for (const EditCommand::PlacedTransition& placed : command.transitions) {
+        QString transitionId = QString::fromStdString(placed.transition->getId());
+        Transition* transition = machine->getTransition(placed.transition->getId());
+        if (!transition) {
+            removeTransitionItem(transitionId);
+            qDeleteAll(ui->listWidget_transitions->findItems(transitionId, Qt::MatchExactly));
+            continue;
+        }
+
+        QString inputValue = fsmBridge->getInputConditionsString(transition);
+        auto it = transitions.find(transitionId);
+        if (it != transitions.end()) {
+            setTransitionLabel(it.value(), inputValue);
+            continue;
+        }
+
+        bool isBoolean = false;
+        for (const InputCondition& condition : transition->getInputConditions()) {
+            isBoolean = isBoolean || condition.isBooleanExpr;
+        }
+        addTransitionItem(transitionId, QString::fromStdString(transition->getSourceId()),
+                          QString::fromStdString(transition->getTargetId()), inputValue, isBoolean);
+        ui->listWidget_transitions->addItem(transitionId);
+    }
+
+    if (command.variable) {
+        QString name = QString::fromStdString(command.variable->name);
+        QList<QListWidgetItem*> listed = ui->listWidget_vars->findItems(name, Qt::MatchExactly);
+        if (machine->getVariable(command.variable->name) && listed.isEmpty()) {
+            ui->listWidget_vars->addItem(name);
+        } else if (!machine->getVariable(command.variable->name)) {
+            qDeleteAll(listed);
+        }
+    }
+
+    // Enable or disable the buttons the same way adding and removing does
+    bool hasStates = !states.isEmpty();
+    ui->pushButton_add_transition->setEnabled(hasStates);
+    ui->pushButton_add_bool_transition->setEnabled(hasStates);
+    ui->pushButton_remove_state->setEnabled(hasStates);
+    ui->pushButton_edit_transition->setEnabled(!transitions.isEmpty());
+    ui->pushButton_remove_transition->setEnabled(!transitions.isEmpty());
+    if (!hasStates) {
+        ui->pushButton_start->setEnabled(false);
+    }
+}
+
+/**
+ * @brief Create the graphics of a transition and add them to the scene
+ *
+ * @param transitionId ID of the transition in the machine
+ * @param fromId ID of the source state, must have its item already
+ * @param toId ID of the target state, must have its item already
+ * @param inputValue Label with the input conditions
+ * @param isBoolean Whether the transition uses boolean input condition
+ */
+void AutomatonEditor::addTransitionItem(const QString& transitionId, const QString& fromId, const QString& toId, const QString& inputValue, bool isBoolean)
+{
+    TransitionItem& transition = transitions[transitionId];
+    transition.id = transitionId;
+    transition.stateFrom = &states[fromId];
+    transition.stateTo = &states[toId];
+    transition.inputValue = inputValue;
+    transition.isBoolean = isBoolean;
+
+    transition.pathItem = scene->addPath(QPainterPath(), QPen(Qt::black));
+    transition.pathItem->setZValue(0); // make the line appear nehind the states
+    transition.labelItem = scene->addText(inputValue);
+
+    SceneTransition drawing;
+    drawing.sourceId = fromId.toStdString();
+    drawing.targetId = toId.toStdString();
+    drawing.label = inputValue.toStdString();
+    drawing.isBoolean = isBoolean;
+    sceneModel.setTransition(transitionId.toStdString(), drawing);
+
+    transition.stateFrom->transitions.append(&transition);
+    if (transition.stateTo != transition.stateFrom) {
+        transition.stateTo->transitions.append(&transition);
+    }
+
+    routeTransition(transition);
+}
+
+/**
+ * @brief Recompute the path and the label position of a transition from its states
+ * @param transition The transition item
+ */
+void AutomatonEditor::layoutTransition(TransitionItem& transition)
+{
+    QPainterPath path;
+
+    // Handle self-transition
+    if (transition.stateFrom == transition.stateTo) {
+        qreal radius = 20;
+        qreal loopRadius = 60;
+        qreal x = transition.stateFrom->position.x() + loopRadius / 2;
+        qreal y = transition.stateFrom->position.y() + radius / 2;
+
+        path.moveTo(x + radius, y); // Move
+        path.cubicTo(x + loopRadius, y - loopRadius,
+                     x - loopRadius, y - loopRadius,
+                     x - radius, y); // Create a loop
+
+        transition.labelItem->setPos(x - 10, y - loopRadius - 10);
+    }
+    else { // Between two states
+        QPointF p1 = transition.stateFrom->ellipse->sceneBoundingRect().center();
+        QPointF p2 = transition.stateTo->ellipse->sceneBoundingRect().center();
+
+        path.moveTo(p1);
+        path.lineTo(p2);
+
+        qreal midX = (p1.x() + p2.x()) / 2;
+        qreal midY = (p1.y() + p2.y()) / 2;
+        transition.labelItem->setPos(midX, midY);
+    }
+
+    transition.pathItem->setPath(path);
+}
+
+/**
+ * @brief Lay out a transition if it can be seen, otherwise hide it until one of its states comes into the view
+ *
+ * A transition can be seen when the box around its line, widened by the size
+ * of a state to cover loops and labels, reaches into the visible area.
+ *
+ * @param transition The transition item
+ */
+void AutomatonEditor::routeTransition(TransitionItem& transition)
+{
+    QPointF from = transition.stateFrom->ellipse->sceneBoundingRect().center();
+    QPointF to = transition.stateTo->ellipse->sceneBoundingRect().center();
+    qreal margin = transition.stateFrom->ellipse->rect().width();
+
+    if (QRectF(from, to).normalized().adjusted(-margin, -margin, margin, margin).intersects(visibleArea)) {
+        if (transition.deferred) {
+            transition.deferred = false;
+            transition.pathItem->setVisible(true);
+            transition.labelItem->setVisible(true);
+        }
+        layoutTransition(transition);
+    } else if (!transition.deferred) {
+        transition.deferred = true;
+        transition.pathItem->setVisible(false);
+        transition.labelItem->setVisible(false);
+    }
+}
+
+/**
+ * @brief Recompute the visible area and lay out the hidden transitions of the states that came into it
+ *
+ * The area is the part of the scene the view shows with half of it added on
+ * every side, so scrolling a bit does not show missing transitions. Only the
+ * states in the area are looked at, found with the state grid.
+ */
+void AutomatonEditor::updateVisibleArea()
+{
+    QRectF shown = ui->graphicsView->mapToScene(ui->graphicsView->viewport()->rect()).boundingRect();
+    visibleArea = shown.adjusted(-shown.width() / 2, -shown.height() / 2, shown.width() / 2, shown.height() / 2);
+
+    std::vector<std::string> stateIds = stateGrid.query(Point(visibleArea.left(), visibleArea.top()),
+                                                        Point(visibleArea.right(), visibleArea.bottom()));
+    for (const std::string& stateId : stateIds) {
+        auto it = states.find(QString::fromStdString(stateId));
+        if (it == states.end()) {
+            continue;
+        }
+        for (TransitionItem* transition : it->transitions) {
+            if (transition->deferred) {
+                routeTransition(*transition);
             }
-            
-            transitions[item.id] = item;
         }
     }
 }
 
+/**
+ * @brief Remove the graphics of a transition from the scene
+ * @param transitionId ID of the transition
+ */
+void AutomatonEditor::removeTransitionItem(const QString& transitionId)
+{
+    auto it = transitions.find(transitionId);
+    if (it == transitions.end()) {
+        return;
+    }
+
+    it->stateFrom->transitions.removeOne(&it.value());
+    it->stateTo->transitions.removeOne(&it.value());
+
+    delete it->pathItem;
+    delete it->labelItem;
+    transitions.erase(it);
+    sceneModel.removeTransition(transitionId.toStdString());
+}
+
+/**
+ * @brief Change the label of a transition in the scene
+ * @param transition The transition item
+ * @param inputValue Label with the input conditions
+ */
+void AutomatonEditor::setTransitionLabel(TransitionItem& transition, const QString& inputValue)
+{
+    transition.inputValue = inputValue;
+    transition.labelItem->setPlainText(inputValue);
+
+    SceneTransition drawing;
+    drawing.sourceId = transition.stateFrom->id.toStdString();
+    drawing.targetId = transition.stateTo->id.toStdString();
+    drawing.label = inputValue.toStdString();
+    drawing.isBoolean = transition.isBoolean;
+    sceneModel.setTransition(transition.id.toStdString(), drawing);
+}
+
 /**
  * @brief Update the transition position and graphics if the state has been moved
  * 
  * If the state in the graphic scene was moved (dragged by a mouse),
- * upddate the transition item values
+ * upddate the transition item values. The existing items are moved,
+ * nothing is recreated. Only the transitions of the state are touched.
  * 
  * @param stateId ID of the moved state
  */
 void AutomatonEditor::updateTransitionsForState(const QString& stateId)
 {
-    if (!states.contains(stateId)) return;
-    StateItem& moved = states[stateId];
+    auto it = states.find(stateId);
+    if (it == states.end()) return;
+    StateItem& moved = it.value();
 
     // Update position
-    QPointF newPos = moved.ellipse->sceneBoundingRect().topLeft();
-    moved.position = newPos.toPoint();
+    moved.position = (moved.ellipse->rect().topLeft() + moved.ellipse->pos()).toPoint();
+
+    recordState(moved);
+
+    QRectF box = moved.ellipse->sceneBoundingRect();
+    stateGrid.insert(stateId.toStdString(), Point(box.left(), box.top()), Point(box.right(), box.bottom()));
 
     // Update label
-    QRectF textRect = moved.label->boundingRect();
-    qreal labelX = newPos.x() + 30 - textRect.width() / 2;
-    qreal labelY = newPos.y() + 30 - textRect.height() / 2;
-    moved.label->setPos(labelX, labelY);
+    placeStateLabel(moved);
 
     // Update transitions
-    for (auto& t : transitions) {
-        if (t.stateFrom->id != stateId && t.stateTo->id != stateId)
-            continue;
-
-        if (t.pathItem)
-            scene->removeItem(t.pathItem);
-        if (t.labelItem)
-            scene->removeItem(t.labelItem);
-
-        QPointF p1 = t.stateFrom->ellipse->sceneBoundingRect().center();
-        QPointF p2 = t.stateTo->ellipse->sceneBoundingRect().center();
-
-        QPainterPath path;
-        if (t.stateFrom->id == t.stateTo->id) {
-            qreal radius = 20;
-            qreal loopRadius = 60;
-            qreal x = moved.position.x() + loopRadius / 2;
-            qreal y = moved.position.y() + radius / 2;
-
-            path.moveTo(x + radius, y);
-            path.cubicTo(x + loopRadius, y - loopRadius,
-                         x - loopRadius, y - loopRadius,
-                         x - radius, y);
-
-            t.pathItem = scene->addPath(path, QPen(Qt::black));
-            t.pathItem->setZValue(0);
-            t.labelItem = scene->addText(t.inputValue);
-            t.labelItem->setPos(x - 10, y - loopRadius - 10);
-        } else {
-            path.moveTo(p1);
-            path.lineTo(p2);
-            t.pathItem = scene->addPath(path, QPen(Qt::black));
-            t.pathItem->setZValue(0);
-            qreal midX = (p1.x() + p2.x()) / 2;
-            qreal midY = (p1.y() + p2.y()) / 2;
-            t.labelItem = scene->addText(t.inputValue);
-            t.labelItem->setPos(midX, midY);
-        }
+    for (TransitionItem* t : moved.transitions) {
+        routeTransition(*t);
     }
 }
 
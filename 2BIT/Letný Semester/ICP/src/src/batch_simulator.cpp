@@ -0,0 +1,287 @@
+/**
+ * @file batch_simulator.cpp
+ * @brief Implementation of the BatchSimulator class
+ * @author Hugo Bohácsek (xbohach00)
+ */
+
+#include "../headers/batch_simulator.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+#include "../headers/string_utils.h"
+
+using namespace std::chrono;
+
+/**
+ * @brief Writes the state and outputs of an instance that changed since the last call
+ *
+ * @param out Output trace stream
+ * @param time Virtual time in milliseconds
+ * @param simulator Simulator of the instance
+ * @param lastState State written last
+ * @param lastOutputs Output values written last
+ */
+static void recordChanges(std::ostream& out, long long time, const MachineSimulator& simulator,
+                          std::string& lastState,
+                          std::unordered_map<std::string, std::string>& lastOutputs) {
+    State* state = simulator.getCurrentState();
+    if (state && state->getId() != lastState) {
+        lastState = state->getId();
+        out << time << " state " << lastState << "\n";
+    }
+
+    for (const auto& output : simulator.getAllOutputs()) {
+        auto it = lastOutputs.find(output.first);
+        if (it == lastOutputs.end() || it->second != output.second) {
+            lastOutputs[output.first] = output.second;
+            out << time << " output " << output.first << " " << output.second << "\n";
+        }
+    }
+}
+
+/**
+ * @brief Constructor
+ *
+ * @param machine The machine to simulate, must outlive the batch simulator
+ * @param threadCount Number of worker threads, 0 for one per hardware thread
+ */
+BatchSimulator::BatchSimulator(const MooreMachine& machine, int threadCount)
+    : machine(machine), threadCount(threadCount), horizon(0), maxStepsPerInstant(10000) {
+    if (this->threadCount <= 0) {
+        this->threadCount = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    }
+}
+
+/**
+ * @brief Sets how long instances keep running after their last input
+ *
+ * @param milliseconds Virtual time in milliseconds
+ */
+void BatchSimulator::setHorizon(long long milliseconds) {
+    horizon = milliseconds;
+}
+
+/**
+ * @brief Sets where output traces are written
+ *
+ * @param directory Existing directory, or an empty string to record nothing
+ */
+void BatchSimulator::setOutputDirectory(const std::string& directory) {
+    outputDirectory = directory;
+}
+
+/**
+ * @brief Gets the number of worker threads
+ *
+ * @return Number of threads a run uses at most
+ */
+int BatchSimulator::getThreadCount() const {
+    return threadCount;
+}
+
+/**
+ * @brief Loads an input trace from a file
+ *
+ * @param filename Path to the trace file
+ * @return The loaded trace
+ * @throw std::runtime_error If the file cannot be read or a line is malformed
+ */
+InputTrace BatchSimulator::loadTrace(const std::string& filename) {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        throw std::runtime_error("Could not open trace file: " + filename);
+    }
+
+    InputTrace trace;
+    trace.name = filename;
+
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(file, line)) {
+        lineNumber++;
+        if (line.empty()) {
+            continue;
+        }
+        line = trim(line);
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+
+        // <time_ms> <input_ptr> <value>, the value is the rest of the line
+        std::istringstream ss(line);
+        TraceEvent event;
+        if (!(ss >> event.time >> event.inputPtr) || event.time < 0) {
+            throw std::runtime_error(filename + ":" + std::to_string(lineNumber) +
+                                     ": expected \"<time_ms> <input_ptr> <value>\"");
+        }
+        std::getline(ss, event.value);
+        if (!event.value.empty()) {
+            event.value = trim(event.value);
+        }
+
+        if (!trace.events.empty() && event.time < trace.events.back().time) {
+            throw std::runtime_error(filename + ":" + std::to_string(lineNumber) +
+                                     ": events must be ordered by time");
+        }
+        trace.events.push_back(event);
+    }
+
+    return trace;
+}
+
+/**
+ * @brief Runs one instance through a trace
+ *
+ * @param instanceMachine Machine copy owned by the calling thread
+ * @param simulator Simulator of instanceMachine
+ * @param clock Virtual clock of instanceMachine
+ * @param trace Inputs fed to the instance
+ * @param out Output trace stream, or nullptr to record nothing
+ * @return Number of simulation steps made
+ * @throw std::runtime_error If the simulation fails or stops making progress
+ */
+unsigned long long BatchSimulator::runInstance(MooreMachine& instanceMachine, MachineSimulator& simulator,
+                                               VirtualClock& clock, const InputTrace& trace,
+                                               std::ostream* out) const {
+    // Every instance starts at the epoch of its virtual clock
+    const steady_clock::time_point epoch;
+    unsigned long long steps = 0;
+    int stepsAtInstant = 0;
+    steady_clock::time_point instant = epoch;
+
+    std::string lastState;
+    std::unordered_map<std::string, std::string> lastOutputs;
+
+    auto afterStep = [&]() {
+        steps++;
+        if (clock.now() != instant) {
+            instant = clock.now();
+            stepsAtInstant = 0;
+        }
+        if (++stepsAtInstant > maxStepsPerInstant) {
+            throw std::runtime_error("No progress after " + std::to_string(maxStepsPerInstant) +
+                                     " steps at " + std::to_string(duration_cast<milliseconds>(instant - epoch).count()) +
+                                     " ms, the machine keeps changing state");
+        }
+        if (out) {
+            recordChanges(*out, duration_cast<milliseconds>(clock.now() - epoch).count(), simulator, lastState, lastOutputs);
+        }
+    };
+
+    clock.set(epoch);
+    instanceMachine.setClock(&clock);
+    instanceMachine.resetVariables();
+    simulator.reset();
+    if (out) {
+        recordChanges(*out, 0, simulator, lastState, lastOutputs);
+    }
+
+    // Jump from one pending step to the next instead of waiting for them
+    long long endTime = 0;
+    for (const TraceEvent& event : trace.events) {
+        steady_clock::time_point at = epoch + milliseconds(event.time);
+        while (simulator.advance(at)) {
+            afterStep();
+        }
+        clock.sleepUntil(at);
+        simulator.setInput(event.inputPtr, event.value);
+        simulator.processInputs();
+        afterStep();
+        endTime = event.time;
+    }
+    while (simulator.advance(epoch + milliseconds(endTime + horizon))) {
+        afterStep();
+    }
+
+    return steps;
+}
+
+/**
+ * @brief Runs the given number of instances
+ *
+ * @param traces Input traces to feed
+ * @param instances Number of instances to run
+ * @return Statistics of the run
+ * @throw std::runtime_error If no traces are given or the machine cannot be simulated
+ */
+BatchStats BatchSimulator::run(const std::vector<InputTrace>& traces, size_t instances) const {
+    if (traces.empty()) {
+        throw std::runtime_error("No input traces given");
+    }
+    if (!outputDirectory.empty() && !std::filesystem::is_directory(outputDirectory)) {
+        throw std::runtime_error("Output directory does not exist: " + outputDirectory);
+    }
+
+    size_t workers = std::max<size_t>(1, std::min<size_t>(threadCount, instances));
+
+    // Each worker owns a copy of the machine, made here while nothing else reads the original
+    std::vector<MooreMachine> machines(workers, machine);
+    std::vector<VirtualClock> clocks(workers);
+    std::vector<MachineSimulator> simulators;
+    simulators.reserve(workers);
+    for (size_t id = 0; id < workers; id++) {
+        machines[id].setClock(&clocks[id]);
+        simulators.emplace_back(&machines[id]);
+    }
+
+    BatchStats stats{};
+    stats.instances = instances;
+    stats.threadSteps.assign(workers, 0);
+    stats.threadSeconds.assign(workers, 0.0);
+
+    std::atomic<size_t> nextInstance(0);
+    std::atomic<size_t> failed(0);
+    std::mutex errorMutex;
+
+    auto worker = [&](size_t id) {
+        auto begin = steady_clock::now();
+        for (size_t i = nextInstance++; i < instances; i = nextInstance++) {
+            const InputTrace& trace = traces[i % traces.size()];
+
+            std::ofstream file;
+            if (!outputDirectory.empty()) {
+                file.open(outputDirectory + "/" + std::to_string(i) + ".trace");
+                file << "# instance " << i << ", trace " << trace.name << "\n";
+            }
+
+            try {
+                stats.threadSteps[id] += runInstance(machines[id], simulators[id], clocks[id], trace,
+                                                     file.is_open() ? &file : nullptr);
+            } catch (const std::exception& e) {
+                failed++;
+                if (file.is_open()) {
+                    file << "# error: " << e.what() << "\n";
+                }
+                std::lock_guard<std::mutex> lock(errorMutex);
+                if (stats.firstError.empty()) {
+                    stats.firstError = "instance " + std::to_string(i) + ": " + e.what();
+                }
+            }
+        }
+        stats.threadSeconds[id] = duration<double>(steady_clock::now() - begin).count();
+    };
+
+    auto start = steady_clock::now();
+    std::vector<std::thread> threads;
+    for (size_t id = 1; id < workers; id++) {
+        threads.emplace_back(worker, id);
+    }
+    worker(0);
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    stats.seconds = duration<double>(steady_clock::now() - start).count();
+
+    stats.failed = failed;
+    for (unsigned long long threadSteps : stats.threadSteps) {
+        stats.steps += threadSteps;
+    }
+    return stats;
+}
@@ -0,0 +1,58 @@
+/**
+ * @file code_buffer.cpp
+ * @brief Implementation of the CodeBuffer class
+ * @author Hugo Bohácsek (xbohach00)
+ */
+
+#include "../headers/code_buffer.h"
+#include <charconv>
+#include <cstdio>
+#include <stdexcept>
+
+/**
+ * @brief Constructor
+ *
+ * @param capacity Number of characters reserved up front
+ */
+CodeBuffer::CodeBuffer(size_t capacity) {
+    text.reserve(capacity);
+}
+
+/**
+ * @brief Appends a signed number
+ *
+ * @param number Number to write in decimal
+ */
+void CodeBuffer::appendNumber(long long number) {
+    char digits[24];
+    auto result = std::to_chars(digits, digits + sizeof(digits), number);
+    text.append(digits, result.ptr);
+}
+
+/**
+ * @brief Appends an unsigned number
+ *
+ * @param number Number to write in decimal
+ */
+void CodeBuffer::appendNumber(unsigned long long number) {
+    char digits[24];
+    auto result = std::to_chars(digits, digits + sizeof(digits), number);
+    text.append(digits, result.ptr);
+}
+
+/**
+ * @brief Writes the text to a file, replacing it
+ *
+ * @param path Path of the file
+ * @throws std::runtime_error If the file cannot be written
+ */
+void CodeBuffer::writeTo(const std::string& path) const {
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        throw std::runtime_error("Cannot open " + path + " for writing");
+    }
+    bool written = std::fwrite(text.data(), 1, text.size(), file) == text.size();
+    if (std::fclose(file) != 0 || !written) {
+        throw std::runtime_error("Failed to write " + path);
+    }
+}
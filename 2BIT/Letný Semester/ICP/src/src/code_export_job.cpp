@@ -0,0 +1,232 @@
+/**
+ * @file code_export_job.cpp
+ * @brief Implementation of the CodeExportJob class
+ * @author Hugo Bohácsek (xbohach00)
+ */
+
+#include "../headers/code_export_job.h"
+#include <QFileInfo>
+#include <QThread>
+#include <algorithm>
+#include <stdexcept>
+
+/**
+ * @brief Constructor
+ * @param machine Machine to export, it is copied so it can be edited meanwhile
+ * @param filePath Path for the generated code without an extension
+ * @param parent Parent QObject, used for memory management
+ */
+CodeExportJob::CodeExportJob(const MooreMachine& machine, const QString& filePath, QObject* parent)
+    : QObject(parent), machine(machine), filePath(filePath), cancelled(false),
+      maxCompilers(std::max(1, QThread::idealThreadCount())), written(0), compiled(0), generated(false),
+      running(false) {}
+
+/**
+ * @brief Destructor
+ *
+ * Stops the compilers and waits for the generation to stop
+ */
+CodeExportJob::~CodeExportJob() {
+    cancelled = true;
+    if (generator.joinable()) {
+        generator.join();
+    }
+    // The compilers must not report back to a job being destroyed
+    for (QProcess* compiler : compilers) {
+        compiler->disconnect(this);
+        compiler->kill();
+        compiler->waitForFinished();
+    }
+}
+
+/**
+ * @brief Starts generating the code
+ */
+void CodeExportJob::start() {
+    if (running || generator.joinable()) {
+        return;
+    }
+    running = true;
+    emit progress(0, 0, "Generating code");
+    generator = std::thread(&CodeExportJob::generate, this);
+}
+
+/**
+ * @brief Stops the export, finished is emitted with the job failed
+ */
+void CodeExportJob::cancel() {
+    fail("Export cancelled");
+}
+
+/**
+ * @brief Checks whether the export is still going on
+ * @return True until finished is emitted
+ */
+bool CodeExportJob::isRunning() const {
+    return running;
+}
+
+/**
+ * @brief Generates the code, runs on the generator thread
+ *
+ * Only the machine copy and the path are read here, everything else is passed
+ * to the job's thread with queued calls.
+ */
+void CodeExportJob::generate() {
+    GeneratedProgram result;
+    QString error;
+    try {
+        result = CodeGenarator::generateCode(machine, filePath.toStdString(), [this](const std::string& source) {
+            if (cancelled) {
+                throw std::runtime_error("Export cancelled");
+            }
+            QString path = QString::fromStdString(source);
+            QMetaObject::invokeMethod(this, [this, path]() { sourceWritten(path); }, Qt::QueuedConnection);
+        });
+    } catch (const std::exception& e) {
+        error = QString::fromStdString(e.what());
+    }
+    QMetaObject::invokeMethod(this, [this, result, error]() { generationFinished(result, error); },
+                              Qt::QueuedConnection);
+}
+
+/**
+ * @brief Queues a source written by the generator thread for compilation
+ * @param sourcePath Path of the source
+ */
+void CodeExportJob::sourceWritten(const QString& sourcePath) {
+    if (!running) {
+        return;
+    }
+    written++;
+    pending.enqueue(sourcePath);
+    emit progress(compiled, totalSteps(), QString("Generated %1").arg(QFileInfo(sourcePath).fileName()));
+    startCompilers();
+}
+
+/**
+ * @brief Takes over the files once the generator thread is done
+ * @param generatedProgram Files of the program
+ * @param error Why the generation failed, empty if it succeeded
+ */
+void CodeExportJob::generationFinished(const GeneratedProgram& generatedProgram, const QString& error) {
+    generator.join();
+    if (!running) {
+        return;
+    }
+    if (!error.isEmpty()) {
+        fail(error);
+        return;
+    }
+    program = generatedProgram;
+    generated = true;
+    emit progress(compiled + 1, totalSteps(), QString("Generated %1 sources").arg(written));
+    startCompilers();
+}
+
+/**
+ * @brief Starts compilers for the queued sources while there are free slots, links when all are compiled
+ */
+void CodeExportJob::startCompilers() {
+    while (running && !pending.isEmpty() && compilers.size() < maxCompilers) {
+        QString source = pending.dequeue();
+        QStringList arguments;
+        for (const std::string& option : CodeGenarator::compilerOptions()) {
+            arguments << QString::fromStdString(option);
+        }
+        arguments << "-c" << source << "-o" << QString::fromStdString(CodeGenarator::objectPath(source.toStdString()));
+        runCompiler(arguments, [this, source]() {
+            compiled++;
+            emit progress(compiled + (generated ? 1 : 0), totalSteps(),
+                          QString("Compiled %1").arg(QFileInfo(source).fileName()));
+            startCompilers();
+        });
+    }
+    if (running && generated && compilers.isEmpty() && compiled == written) {
+        link();
+    }
+}
+
+/**
+ * @brief Starts the compiler process
+ * @param arguments Options and files of the compiler
+ * @param onSuccess Called when the compiler exits successfully
+ */
+void CodeExportJob::runCompiler(const QStringList& arguments, const std::function<void()>& onSuccess) {
+    QProcess* compiler = new QProcess(this);
+    compilers.append(compiler);
+
+    connect(compiler, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), this,
+            [this, compiler, onSuccess](int exitCode, QProcess::ExitStatus status) {
+        compilers.removeOne(compiler);
+        compiler->deleteLater();
+        if (!running) {
+            return;
+        }
+        if (status != QProcess::NormalExit || exitCode != 0) {
+            fail("Compilation failed:\n" + QString::fromLocal8Bit(compiler->readAllStandardError()));
+            return;
+        }
+        onSuccess();
+    });
+    connect(compiler, &QProcess::errorOccurred, this, [this, compiler](QProcess::ProcessError error) {
+        // A process that never started does not emit finished
+        if (error == QProcess::FailedToStart) {
+            compilers.removeOne(compiler);
+            compiler->deleteLater();
+            fail(QString("Cannot start the compiler %1").arg(QString::fromStdString(CodeGenarator::compilerName())));
+        }
+    });
+
+    compiler->start(QString::fromStdString(CodeGenarator::compilerName()), arguments);
+}
+
+/**
+ * @brief Links the compiled objects into the executable
+ */
+void CodeExportJob::link() {
+    QStringList arguments;
+    for (const std::string& option : CodeGenarator::compilerOptions()) {
+        arguments << QString::fromStdString(option);
+    }
+    for (const std::string& source : program.sources) {
+        arguments << QString::fromStdString(CodeGenarator::objectPath(source));
+    }
+    QString executable = QString::fromStdString(program.executable);
+    arguments << "-o" << executable;
+
+    emit progress(totalSteps() - 1, totalSteps(), QString("Linking %1").arg(QFileInfo(executable).fileName()));
+    runCompiler(arguments, [this, executable]() {
+        running = false;
+        emit progress(totalSteps(), totalSteps(), QString("Built %1").arg(executable));
+        emit finished(true, executable);
+    });
+}
+
+/**
+ * @brief Stops the export and reports it failed
+ * @param message Why the export failed
+ */
+void CodeExportJob::fail(const QString& message) {
+    if (!running) {
+        return;
+    }
+    running = false;
+    cancelled = true;
+    pending.clear();
+    for (QProcess* compiler : compilers) {
+        compiler->kill();
+    }
+    emit finished(false, message);
+}
+
+/**
+ * @brief Gets the total number of steps of the export
+ *
+ * Generating the code, compiling each source and linking are a step each.
+ *
+ * @return Number of steps, 0 while the code is still being generated
+ */
+int CodeExportJob::totalSteps() const {
+    return generated ? static_cast<int>(program.sources.size()) + 2 : 0;
+}
@@ -3,6 +3,7 @@
 */
 
 #include "../headers/code_generator.h"
+#include <algorithm>
 
 std::string CodeGenarator::generatedFileHeader = R"===(
 #ifndef GENERATED_AUTOMATON_H
@@ -12,12 +13,21 @@ std::string CodeGenarator::generatedFileHeader = R"===(
 #include <vector>
 #include <unordered_map>
 #include <chrono>
-#include <regex>
 #include <variant>
 #include <cstring>
+#include <cstdio>
 #include <iostream>
 #include <optional>
 #include <cstdint>
+#include <stdexcept>
+#include <string_view>
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <queue>
+#include <functional>
 
 #ifdef _WIN32
     #define WIN32_LEAN_AND_MEAN
@@ -31,63 +41,112 @@ std::string CodeGenarator::generatedFileHeader = R"===(
     #include <arpa/inet.h>
     #include <unistd.h>
     #include <fcntl.h>
+    #include <cerrno>
     #define INVALID_SOCKET -1
     #define SOCKET_ERROR   -1
     typedef int SOCKET;
 #endif
 
+#ifdef __linux__
+    #include <sys/epoll.h>
+    #include <sys/timerfd.h>
+    #include <sys/eventfd.h>
+#endif
+
+// Binary protocol shared with the editor, see wire_protocol.h of the editor
+namespace WireProtocol{
+    constexpr char MAGIC = 'F';
+    constexpr uint8_t VERSION = 2;
+    constexpr size_t HEADER_SIZE = 10;
+    constexpr size_t RECORD_HEADER_SIZE = 3;
+    constexpr size_t MAX_DATAGRAM = 1400;
+    constexpr size_t MAX_RECEIVE = 65536;
+
+    enum RecordType : uint8_t { HELLO = 0x00, INPUT = 0x01, STOP = 0x02, STATE = 0x03, VARIABLE = 0x04,
+                                OUTPUT = 0x05, SNAPSHOT = 0x06, BYE = 0x07, RESYNC = 0x08 };
+}
+
+class WireWriter{
+private:
+    std::string data;
+    size_t recordStart;
+
+public:
+    WireWriter(uint32_t instance, uint32_t sequence);
+    void beginRecord(WireProtocol::RecordType type);
+    void endRecord();
+    void writeU16(uint16_t value);
+    void writeU32(uint32_t value);
+    void writeString(const std::string& value);
+    size_t size() const{ return data.size(); }
+    bool empty() const{ return data.size() == WireProtocol::HEADER_SIZE; }
+    const std::string& getData() const{ return data; }
+};
+
+class WireReader{
+private:
+    const std::string& data;
+    size_t position;
+    size_t recordEnd;
+    uint32_t instance;
+    uint32_t sequence;
+
+    void require(size_t count) const;
+
+public:
+    explicit WireReader(const std::string& data);
+    uint32_t getInstance() const{ return instance; }
+    uint32_t getSequence() const{ return sequence; }
+    bool nextRecord(WireProtocol::RecordType& type);
+    uint16_t readU16();
+    uint32_t readU32();
+    std::string readString();
+};
+
+// The UDP socket all instances of the process share, any thread may send
 class IOComm{
 private:
     SOCKET sock;
     struct sockaddr_in localAddress;
-    struct sockaddr_in remoteAddress;
+    std::vector<char> buffer;
 
 public:
     IOComm(int port);
     ~IOComm();
 
-    bool editorConnected;
-
-    bool send(const std::string& message);
-    std::optional<std::string> receive(int timeout);
+    bool send(const std::string& message, const struct sockaddr_in& to);
+    std::optional<std::string> receive(struct sockaddr_in& from);
     bool setNonBlocking();
+    SOCKET getSocket() const{ return sock; }
 };
 
-enum class TokenType {
-    VARIABLE,        /**< Variable identifier */
-    NUMBER,          /**< Numeric literal */
-    OPERATOR,        /**< Mathematical operator */
-    FUNCTION,        /**< Function identifier */
-    SPECIAL_KEYWORD, /**< Special language keywords */
-    EQUALS,          /**< Assignment operator */
-    GET,             /**< 'get' keyword for input retrieval */
-    OUTPUT,          /**< 'output' keyword for output generation */
-    TO,              /**< 'to' keyword for output destination */
-    IF,              /**< 'if' keyword for condition */
-    IS,              /**< 'is' keyword for condition */
-    DEFINED,         /**< 'defined' keyword for checking defined inputs */
-    END              /**< End of expression marker */
-};
+typedef std::variant<int, float, std::string> variableType;
 
-struct Token {
-    TokenType type;      /**< The type of this token */
-    std::string value;   /**< The string value of this token */
+class Transition;
 
-    Token(TokenType type, const std::string& value) : type(type), value(value) {}
-};
+// Wall clock time, or virtual time that jumps straight to the next deadline
+class Clock{
+private:
+    bool virtualTime;
+    std::chrono::steady_clock::time_point current;
 
-typedef std::variant<int, float, std::string> variableType;
+public:
+    Clock(): virtualTime(false), current(){}
 
-class Transition;
+    void setVirtual(bool enabled){ virtualTime = enabled; current = std::chrono::steady_clock::time_point(); }
+    bool isVirtual() const{ return virtualTime; }
+    std::chrono::steady_clock::time_point now() const{ return virtualTime ? current : std::chrono::steady_clock::now(); }
+    void advanceTo(std::chrono::steady_clock::time_point time){ if (virtualTime && time > current) current = time; }
+};
 
 class State{
 public:
     std::string name;
-    std::string outputExpression;
+    int index;
     std::vector<Transition*> outgoing;
     std::chrono::steady_clock::time_point start;
 
-    State(std::string name, std::string outputExpression): name(name), outputExpression(outputExpression){}
+    State(std::string name, int index): name(name), index(index){}
 };
 
 class Timer{
@@ -103,217 +162,190 @@ class Transition{
 public:
     State* from;
     State* to;
-    std::string guardExpression;
-    std::string timeout;
+    int guard;
+    long long timeout;
     Timer* timeoutTimer;
 
-    Transition(State* from, State* to, std::string guardExpression, std::string timeout, Timer *timeoutTimer): from(from), to(to), guardExpression(guardExpression), timeout(timeout), timeoutTimer(timeoutTimer){}
+    Transition(State* from, State* to, int guard, long long timeout, Timer *timeoutTimer): from(from), to(to), guard(guard), timeout(timeout), timeoutTimer(timeoutTimer){}
+};
 
-    bool evaluateTransitionCondition(std::unordered_map<std::string, std::string> &inputs, std::unordered_map<std::string, variableType> &variables);
+// Values of one kind the editor refers to by slot, only changed slots are sent
+class SlotTable{
+public:
+    std::vector<std::string> names;
+    std::unordered_map<std::string, uint16_t> slots;
+    std::vector<std::string> sent;
+    std::vector<bool> dirty;
+    std::vector<uint16_t> changed;
+
+    bool add(const std::string& name);
+    void mark(const std::string& name);
+    void clearChanges();
 };
 
 class AutomatonEngine{
 private:
     std::unordered_map<std::string, State*> states;
+    std::vector<State*> stateList;
     std::unordered_map<std::string, std::string> inputs;
     std::unordered_map<std::string, std::string> outputs;
     std::unordered_map<std::string, variableType> variables;
     State* currentState;
-    IOComm comm;
-
-    void checkTimers();
+    uint32_t instance;
+    IOComm& comm;
+    bool editorConnected;
+    struct sockaddr_in editorAddress;
+    bool quiet;
+    bool tagged;
+    Clock clock;
+    std::vector<std::string> inputSlots;
+    SlotTable outputSlots;
+    SlotTable variableSlots;
+    int sentState;
+    bool layoutChanged;
+    uint32_t sequence;
+    bool running;
+    std::chrono::steady_clock::time_point wakeup;
+
+    bool checkTimers();
     void resetTimers();
+    std::chrono::steady_clock::time_point nextDeadline();
+    int elapsedMs();
+    bool evaluateGuard(int guard);
+    void consumeInputs(int guard);
     void executeOutputAction();
-    variableType evaluateExpression(std::string expr);
-    void tick();
-    void sendStateChange(std::string newState);
-    void sendVariableChange(std::string variableName, std::string value);
-    void sendOutputChange(std::string outputName, std::string value);
-    void sendInitialMessage();
+    // Guards and output actions are split into units compiled separately, these run one unit's share
+    template <int Unit> bool evaluateGuards(int guard);
+    template <int Unit> void consumeUnitInputs(int guard);
+    template <int Unit> void executeOutputActions(int state);
+    void reportVariable(const std::string& variableName);
+    void setOutput(const std::string& outputName, const std::string& value);
+    bool tick();
+    void sendDatagram(const WireWriter& datagram);
+    void sendSnapshot();
+    void flushChanges();
+    void handleMessage(const std::string& message);
+    std::ostream& log();
 
 public:
-    AutomatonEngine();
+    AutomatonEngine(uint32_t instance, IOComm& comm);
     ~AutomatonEngine();
 
-    void createState(std::string name, std::string outputExpression);
-    void createTransition(std::string from, std::string to, std::string expr, std::string timeout);
+    void createState(std::string name, int index);
+    void createTransition(std::string from, std::string to, int guard, long long timeout);
     void createInputPointer(std::string name);
     void createOutputPointer(std::string name);
     void createVariable(std::string name, variableType data);
-    void run();
+    void setVirtualTime(bool enabled);
+    void setLogging(bool quietLog, bool tagLines);
+
+    // Driven by EventLoop
+    void start();
+    void deliver(const std::string& datagram, const struct sockaddr_in& from);
+    void step();
+    void onWakeup();
+    uint32_t getInstance() const{ return instance; }
+    bool isRunning() const{ return running; }
+    bool isVirtualTime() const{ return clock.isVirtual(); }
+    std::chrono::steady_clock::time_point getWakeup() const{ return wakeup; }
 };
 
-#endif //GENERATED_AUTOMATON_H
-)===";
-
-std::string CodeGenarator::helperFunctions = R"===(
-
-std::string getDigits(const std::string& expr, size_t& pos) {
-    std::string number;
-    bool hasDecimal = false;
-
-    while (pos < expr.length() && (std::isdigit(expr[pos]) || (expr[pos] == '.' && !hasDecimal))) {
-        if (expr[pos] == '.') {
-            hasDecimal = true;
-        }
-        number += expr[pos++];
-    }
-
-    return number;
-}
-
-std::string getIdentifier(const std::string& expr, size_t& pos) {
-    std::string identifier;
-
-    while (pos < expr.length() && (std::isalnum(expr[pos]) || expr[pos] == '_')) {
-        identifier += expr[pos++];
-    }
+class Host;
 
-    return identifier;
-}
+// Waits for datagrams and transition deadlines of the engines of one worker thread.
+// Wakeups of all engines are kept in a heap and only the earliest one is waited
+// for: on Linux a single timerfd is armed at it and the loop sleeps in epoll,
+// elsewhere select times out at it. Engines on virtual time never wait.
+// The listening loop reads the shared socket and hands datagrams of other
+// workers' instances over through their inboxes.
+class EventLoop{
+private:
+    typedef std::chrono::steady_clock::time_point TimePoint;
+    typedef std::pair<TimePoint, size_t> Deadline;
+    struct Source{
+        AutomatonEngine* engine;
+        TimePoint scheduled;
+        bool removed;
+        bool delivered;
+    };
+    struct Delivery{
+        size_t source;
+        std::string datagram;
+        struct sockaddr_in from;
+    };
+    static constexpr uint64_t SOCKET_TAG = 0;
+    static constexpr uint64_t WAKE_TAG = 1;
+    static constexpr uint64_t TIMER_TAG = 2;
+    Host& host;
+    bool listening;
+    std::vector<Source> sources;
+    std::priority_queue<Deadline, std::vector<Deadline>, std::greater<Deadline>> deadlines;
+    std::vector<size_t> touched;
+    size_t active;
+    size_t virtualEngines;
+    std::mutex inboxLock;
+    std::vector<Delivery> inbox;
+#ifdef __linux__
+    int epollFd;
+    int wakeFd;
+    int timerFd;
+#endif
 
-std::vector<Token> tokenize(const std::string& expression) {
-    std::vector<Token> tokens;
-    std::string token;
+    void schedule(size_t index);
+    TimePoint nextDeadline();
+    void wakeDue(TimePoint now);
+    bool virtualPending() const;
+    void wakeVirtual();
+    void settle();
 
-    for (size_t i = 0; i < expression.length(); i++) {
-        char c = expression[i];
+public:
+    EventLoop(Host& host, bool listening);
+    ~EventLoop();
 
-        // Skip whitespace
-        if (std::isspace(c)) {
-            continue;
-        }
+    size_t add(AutomatonEngine* engine);
+    void deliver(size_t source, const std::string& datagram, const struct sockaddr_in& from);
+    void post(size_t source, std::string datagram, const struct sockaddr_in& from);
+    void wake();
+    void run();
+};
 
-        // Handle numbers
-        if (std::isdigit(c) || c == '.') {
-            std::string number = getDigits(expression, i);
-            i--;
-            tokens.emplace_back(TokenType::NUMBER, number);
-        }
-            // Handle identifiers (variables, keywords)
-        else if (std::isalpha(c) || c == '_') {
-            std::string identifier = getIdentifier(expression, i);
-            i--;
-
-            // Check for special keywords
-            if (identifier == "get") {
-                tokens.emplace_back(TokenType::GET, identifier);
-            } else if (identifier == "output") {
-                tokens.emplace_back(TokenType::OUTPUT, identifier);
-            } else if (identifier == "to") {
-                tokens.emplace_back(TokenType::TO, identifier);
-            } else if (identifier == "if") {
-                tokens.emplace_back(TokenType::IF, identifier);
-            } else if (identifier == "is") {
-                tokens.emplace_back(TokenType::IS, identifier);
-            } else if (identifier == "defined") {
-                tokens.emplace_back(TokenType::DEFINED, identifier);
-            } else if (identifier == "elapsed") {
-                tokens.emplace_back(TokenType::SPECIAL_KEYWORD, identifier);
-            } else {
-                tokens.emplace_back(TokenType::VARIABLE, identifier);
-            }
-        }
-            // Handle operators
-        else if (c == '+' ||c == '-' || c == '*' || c == '/' || c == '=') {
-            if (c == '=') {
-                tokens.emplace_back(TokenType::EQUALS, "=");
-            } else {
-                tokens.emplace_back(TokenType::OPERATOR, std::string(1, c));
-            }
-        }
-    }
+// Runs instances sharded across worker threads, instance i belongs to worker i % workers
+class Host{
+private:
+    IOComm& comm;
+    std::vector<std::unique_ptr<EventLoop>> loops;
+    std::vector<std::pair<EventLoop*, size_t>> routes;
+    std::atomic<size_t> active;
 
-    tokens.emplace_back(TokenType::END, "");
-    return tokens;
-}
+public:
+    Host(IOComm& comm, std::vector<std::unique_ptr<AutomatonEngine>>& engines, size_t workers);
 
-std::string variantToString(const variableType& value) {
-    return std::visit([](const auto& val) -> std::string {
-        if constexpr (std::is_same_v<std::decay_t<decltype(val)>, int>) {
-        return std::to_string(val);
-    } else if constexpr (std::is_same_v<std::decay_t<decltype(val)>, float>) {
-        return std::to_string(val);
-    } else if constexpr (std::is_same_v<std::decay_t<decltype(val)>, std::string>) {
-        return val;
-    }
-    }, value);
-}
-)===";
+    IOComm& getComm(){ return comm; }
+    bool isActive() const{ return active > 0; }
+    void route(const std::string& datagram, const struct sockaddr_in& from, EventLoop* caller);
+    void engineStopped();
+    void run();
+};
 
-std::string CodeGenarator::transitionFunctions = R"===(
-bool Transition::evaluateTransitionCondition(std::unordered_map <std::string, std::string> &inputs, std::unordered_map<std::string, variableType> &variables) {
-    size_t startpos = 0, endpos;
-    std::string expr;
-    bool result = false;
-    std::smatch match;
-    variableType leftValue, rightValue;
-    if (guardExpression == ""){
-		return true;
-	}
-    while ((endpos = guardExpression.find(";", startpos)) != std::string::npos) {
-        expr = guardExpression.substr(startpos, endpos - startpos);
-        if (std::regex_match(expr, match, std::regex("^(.+) ?(==|!=) ?(.+)$"))){
-            if (variables.find(match[1]) != variables.end()){
-                leftValue = variables[match[1]];
-            }else{
-                return false;
-            }
-            if (variables.find(match[3]) != variables.end()){
-                rightValue = variables[match[3]];
-            }else{
-                if (std::holds_alternative<int>(leftValue)){
-                    rightValue = std::stoi(match[3]);
-                }else if (std::holds_alternative<float>(leftValue)){
-                    rightValue = std::stof(match[3]);
-                }else{
-                    rightValue = match[3];
-                }
-            }
-            if (match[2] == "=="){
-                if (leftValue == rightValue){
-                    result = result || startpos == 0;
-                }else{
-                    return false;
-                }
-            }else{
-                if (leftValue != rightValue){
-                    result = result || startpos == 0;
-                }else{
-                    return false;
-                }
-            }
-        }else if (std::regex_match(expr, match, std::regex("^got (.+) from (.+)$"))) {
-            if (inputs.find(match[2]) != inputs.end()) {
-                if (match[1] == inputs[match[2]]) {
-                    result = result || startpos == 0;
-                }else{
-                    return false;
-                }
-            } else {
-                return false;
-            }
-        }else{
-            return false;
-        }
-        startpos = endpos + 1;
-    }
-    return result;
-}
+int runAutomata(int argc, char* argv[], void (*define)(AutomatonEngine&));
 )===";
 
 std::string CodeGenarator::automatonEngineFunctions = R"===(
-void AutomatonEngine::createState(std::string name, std::string outputExpression) {
-    State* state = new State(name, outputExpression);
+void AutomatonEngine::createState(std::string name, int index) {
+    State* state = new State(name, index);
     states[name] = state;
+    if (stateList.size() <= size_t(index)){
+        stateList.resize(index + 1);
+    }
+    stateList[index] = state;
     if (currentState == nullptr){
         currentState = state;
     }
 }
 
-void AutomatonEngine::createTransition(std::string from, std::string to, std::string expr, std::string timeout) {
-    Timer *timer = new Timer(std::chrono::milliseconds(std::stoll(timeout)));
-    states.at(from)->outgoing.push_back(new Transition(states[from], states[to], expr, timeout, timer));
+void AutomatonEngine::createTransition(std::string from, std::string to, int guard, long long timeout) {
+    Timer *timer = new Timer(std::chrono::milliseconds(timeout));
+    states.at(from)->outgoing.push_back(new Transition(states[from], states[to], guard, timeout, timer));
 }
 
 void AutomatonEngine::resetTimers() {
@@ -322,311 +354,693 @@ void AutomatonEngine::resetTimers() {
     }
 }
 
-void AutomatonEngine::checkTimers() {
-    auto now = std::chrono::steady_clock::now();
+bool AutomatonEngine::checkTimers() {
+    auto now = clock.now();
     for (auto t: currentState->outgoing) {
         if (t->timeoutTimer->active){
             auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - t->timeoutTimer->start);
             if (elapsed >= t->timeoutTimer->duration){
                 t->timeoutTimer->active = false;
+                // Like in the simulator, the inputs that armed the timer are used up
+                consumeInputs(t->guard);
                 if (t->to != t->from){
                     resetTimers();
-                    std::cout << "Action: State changed from " << t->from->name << " to " << t->to->name << std::endl;
-                    sendStateChange(t->to->name);
-                    currentState->start = std::chrono::steady_clock::now();
+                    log() << "Action: State changed from " << t->from->name << " to " << t->to->name << std::endl;
+                    t->to->start = now;
                 }
                 currentState = t->to;
                 executeOutputAction();
+                return true;
             }
         }
     }
+    return false;
+}
+
+std::chrono::steady_clock::time_point AutomatonEngine::nextDeadline() {
+    auto deadline = std::chrono::steady_clock::time_point::max();
+    for (auto t: currentState->outgoing) {
+        if (t->timeoutTimer->active && t->timeoutTimer->start + t->timeoutTimer->duration < deadline){
+            deadline = t->timeoutTimer->start + t->timeoutTimer->duration;
+        }
+    }
+    return deadline;
 }
 
-variableType AutomatonEngine::evaluateExpression(std::string expr) {
-    auto now = std::chrono::steady_clock::now();
-    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(currentState->start - now);
+int AutomatonEngine::elapsedMs() {
+    return static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(clock.now() - currentState->start).count());
+}
 
-    std::vector<Token> tokens = tokenize(expr);
-    int pos = 0;
+void AutomatonEngine::reportVariable(const std::string& variableName) {
+    if (variableSlots.add(variableName)){
+        layoutChanged = true;
+    }
+    variableSlots.mark(variableName);
+    log() << "Action: Variable " << variableName << " set to " << variantToString(variables[variableName]) << std::endl;
+}
 
-    bool firstVal = true;
-    variableType result;
-    variableType currentValue;
-    std::string currentOp = "+";
+void AutomatonEngine::setOutput(const std::string& outputName, const std::string& value) {
+    outputs[outputName] = value;
+    if (outputSlots.add(outputName)){
+        layoutChanged = true;
+    }
+    outputSlots.mark(outputName);
+    log() << "Action: Output " << outputName << " set to " << value << std::endl;
+}
 
-    while (pos < tokens.size() && tokens[pos].type != TokenType::END) {
-        Token token = tokens[pos++];
+bool AutomatonEngine::tick() {
+    // Like the simulator, at most one transition is taken per step
+    if (checkTimers()){
+        return true;
+    }
 
-        switch (token.type) {
-            case TokenType::VARIABLE: {
-                // Replace variable with its value
-                auto it = variables.find(token.value);
-                if (it != variables.end()) {
-                    currentValue = it->second;
-                } else {
-                    if (tokens.size() == 2){
-						currentValue = token.value;
-					}else{
-						throw std::runtime_error("Unknown variable: " + token.value);
-					}
+    for (Transition* t: currentState->outgoing) {
+        if (evaluateGuard(t->guard)){
+            if (t->timeout > 0){
+                if (!t->timeoutTimer->active){
+                    t->timeoutTimer->start = clock.now();
+                    t->timeoutTimer->active = true;
                 }
-                break;
+                continue;
             }
-            case TokenType::NUMBER: {
-                // Parse number
-                try {
-                    if (token.value.find('.') != std::string::npos) {
-                        currentValue = std::stof(token.value);
-                    } else {
-                        currentValue = std::stoi(token.value);
+            consumeInputs(t->guard);
+            if (t->to != t->from){
+                resetTimers();
+                log() << "Action: State changed from " << t->from->name << " to " << t->to->name << std::endl;
+                t->to->start = clock.now();
+            }
+            currentState = t->to;
+            executeOutputAction();
+            return true;
+        }
+    }
+    return false;
+}
+
+bool SlotTable::add(const std::string& name) {
+    if (slots.count(name)){
+        return false;
+    }
+    slots[name] = uint16_t(names.size());
+    names.push_back(name);
+    sent.emplace_back();
+    dirty.push_back(false);
+    return true;
+}
+
+void SlotTable::mark(const std::string& name) {
+    uint16_t slot = slots.at(name);
+    if (!dirty[slot]){
+        dirty[slot] = true;
+        changed.push_back(slot);
+    }
+}
+
+void SlotTable::clearChanges() {
+    for (uint16_t slot: changed){
+        dirty[slot] = false;
+    }
+    changed.clear();
+}
+
+void AutomatonEngine::sendDatagram(const WireWriter& datagram) {
+    if (!(comm.send(datagram.getData(), editorAddress))){
+        std::cerr << "Failed to send" << std::endl;
+        std::exit(1);
+    }
+    sequence++;
+}
+
+void AutomatonEngine::sendSnapshot() {
+    // Slots are positions in the snapshot, the values become the baseline of later deltas
+    WireWriter datagram(instance, sequence);
+    datagram.beginRecord(WireProtocol::SNAPSHOT);
+    datagram.writeString(FSM_DEFINITION_PATH);
+    datagram.writeU16(uint16_t(stateList.size()));
+    for (State* state: stateList){
+        datagram.writeString(state->name);
+    }
+    datagram.writeU16(uint16_t(currentState->index));
+    datagram.writeU16(uint16_t(inputSlots.size()));
+    for (const std::string& name: inputSlots){
+        datagram.writeString(name);
+        datagram.writeString(inputs[name]);
+    }
+    datagram.writeU16(uint16_t(outputSlots.names.size()));
+    for (size_t i = 0; i < outputSlots.names.size(); i++){
+        outputSlots.sent[i] = outputs[outputSlots.names[i]];
+        datagram.writeString(outputSlots.names[i]);
+        datagram.writeString(outputSlots.sent[i]);
+    }
+    datagram.writeU16(uint16_t(variableSlots.names.size()));
+    for (size_t i = 0; i < variableSlots.names.size(); i++){
+        variableSlots.sent[i] = variantToString(variables[variableSlots.names[i]]);
+        datagram.writeString(variableSlots.names[i]);
+        datagram.writeString(variableSlots.sent[i]);
+    }
+    datagram.endRecord();
+    sendDatagram(datagram);
+    sentState = currentState->index;
+    outputSlots.clearChanges();
+    variableSlots.clearChanges();
+    layoutChanged = false;
+}
+
+void AutomatonEngine::flushChanges() {
+    if (!editorConnected){
+        outputSlots.clearChanges();
+        variableSlots.clearChanges();
+        return;
+    }
+    // The editor cannot know slots created after its snapshot
+    if (layoutChanged){
+        sendSnapshot();
+        return;
+    }
+
+    // Records are coalesced until the next one would not fit a datagram
+    WireWriter datagram(instance, sequence);
+    auto append = [&](WireProtocol::RecordType type, uint16_t slot, const std::string* value){
+        size_t length = WireProtocol::RECORD_HEADER_SIZE + 2 + (value ? 2 + value->size() : 0);
+        if (!datagram.empty() && datagram.size() + length > WireProtocol::MAX_DATAGRAM){
+            sendDatagram(datagram);
+            datagram = WireWriter(instance, sequence);
+        }
+        datagram.beginRecord(type);
+        datagram.writeU16(slot);
+        if (value){
+            datagram.writeString(*value);
+        }
+        datagram.endRecord();
+    };
+
+    if (currentState->index != sentState){
+        sentState = currentState->index;
+        append(WireProtocol::STATE, uint16_t(sentState), nullptr);
+    }
+    for (uint16_t slot: outputSlots.changed){
+        const std::string& value = outputs[outputSlots.names[slot]];
+        if (value != outputSlots.sent[slot]){
+            outputSlots.sent[slot] = value;
+            append(WireProtocol::OUTPUT, slot, &value);
+        }
+    }
+    for (uint16_t slot: variableSlots.changed){
+        std::string value = variantToString(variables[variableSlots.names[slot]]);
+        if (value != variableSlots.sent[slot]){
+            variableSlots.sent[slot] = value;
+            append(WireProtocol::VARIABLE, slot, &value);
+        }
+    }
+    outputSlots.clearChanges();
+    variableSlots.clearChanges();
+    if (!datagram.empty()){
+        sendDatagram(datagram);
+    }
+}
+
+void AutomatonEngine::handleMessage(const std::string& message) {
+    WireReader reader(message);
+    WireProtocol::RecordType type;
+    while (running && reader.nextRecord(type)){
+        switch (type){
+            case WireProtocol::HELLO:
+                sendSnapshot();
+                log() << "Connection: Remote editor has established connection with this FSM" << std::endl;
+                break;
+            case WireProtocol::RESYNC:
+                sendSnapshot();
+                log() << "Connection: Remote editor missed updates, snapshot sent again" << std::endl;
+                break;
+            case WireProtocol::INPUT:
+                {
+                    std::string inputPtr = reader.readString();
+                    std::string value = reader.readString();
+                    auto input = inputs.find(inputPtr);
+                    if (input != inputs.end()){
+                        input->second = value;
+                        log() << "Input: got " << value << " from " << inputPtr << std::endl;
                     }
-                } catch (const std::exception& e) {
-                    throw std::runtime_error("Invalid number: " + token.value);
                 }
                 break;
-            }
-            case TokenType::SPECIAL_KEYWORD: {
-                // Handle kw "elapsed"
-                if (token.value == "elapsed") {
-                    currentValue = static_cast<int>(elapsed.count());
-                } else {
-                    throw std::runtime_error("Unknown keyword: " + token.value);
+            case WireProtocol::STOP:
+                running = false;
+                break;
+            case WireProtocol::BYE:
+                if (editorConnected){
+                    editorConnected = false;
+                    log() << "Connection: Remote editor has disconnected from this FSM" << std::endl;
                 }
                 break;
-            }
-            case TokenType::OPERATOR: {
-                // Store operator for next value
-                currentOp = token.value;
-                continue; // Skip to next token
-            }
             default:
-                throw std::runtime_error("Unexpected token: " + token.value);
+                break;
         }
+    }
+}
 
-        if (firstVal){
-            result = currentValue;
-            firstVal = false;
-        }else{
-            if (std::holds_alternative<int>(result) && std::holds_alternative<int>(currentValue)){
-                int val1 = std::get<int>(result);
-                int val2 = std::get<int>(currentValue);
-
-                if (currentOp == "+") result = val1 + val2;
-                else if (currentOp == "-") result = val1 - val2;
-                else if (currentOp == "*") result = val1 * val2;
-                else if (currentOp == "/") {
-                    if (val2 == 0) throw std::runtime_error("Division by zero");
-                    result = val1 / val2;
-                }
-                else throw std::runtime_error("Unsupported operator: " + currentOp);
-            }else if ((std::holds_alternative<float>(result) && (std::holds_alternative<int>(currentValue) || std::holds_alternative<float>(currentValue))) || (std::holds_alternative<int>(result) && std::holds_alternative<float>(currentValue))){
-                float val1 = (std::holds_alternative<float>(result)) ? std::get<float>(result) : static_cast<float>(std::get<int>(result));
-                float val2 = (std::holds_alternative<float>(currentValue)) ? std::get<float>(currentValue) : static_cast<float>(std::get<int>(currentValue));
-
-                if (currentOp == "+") result = val1 + val2;
-                else if (currentOp == "-") result = val1 - val2;
-                else if (currentOp == "*") result = val1 * val2;
-                else if (currentOp == "/") {
-                    if (val2 == 0) throw std::runtime_error("Division by zero");
-                    result = val1 / val2;
-                }
-                else throw std::runtime_error("Unsupported operator: " + currentOp);
-            }else if (std::holds_alternative<std::string>(result) && currentOp == "+"){
-                result = std::get<std::string>(result) + variantToString(currentValue);
-            }else{
-                throw std::runtime_error("Incompatible types for operation " + currentOp);
-            }
+void AutomatonEngine::step() {
+    bool fired = tick();
+    flushChanges();
+
+    // Wake up when the next timer expires, a fired transition may have enabled another one, so look again after the usual interval
+    wakeup = nextDeadline();
+    if (fired){
+        wakeup = std::min(wakeup, clock.now() + std::chrono::milliseconds(100));
+    }
+}
+
+std::ostream& AutomatonEngine::log() {
+    // Lines of many instances would be unreadable, they are tagged or dropped
+    thread_local std::ostream discard(nullptr);
+    if (quiet){
+        return discard;
+    }
+    if (tagged){
+        std::cout << "[" << instance << "] ";
+    }
+    return std::cout;
+}
+
+void AutomatonEngine::setLogging(bool quietLog, bool tagLines) {
+    quiet = quietLog;
+    tagged = tagLines;
+}
+
+void AutomatonEngine::start() {
+    log() << "Executing FSM " << FSM_NAME << "..." << std::endl;
+    log() << "Entry point: Entered state " << currentState->name << std::endl;
+    running = true;
+    currentState->start = clock.now();
+    executeOutputAction();
+    step();
+}
+
+void AutomatonEngine::deliver(const std::string& datagram, const struct sockaddr_in& from) {
+    // A hello, or any datagram but a goodbye while nobody is connected, makes its sender the editor
+    char first = datagram.size() > WireProtocol::HEADER_SIZE ? datagram[WireProtocol::HEADER_SIZE] : char(WireProtocol::BYE);
+    if (first == WireProtocol::HELLO || (!editorConnected && first != WireProtocol::BYE)){
+        editorAddress = from;
+        editorConnected = true;
+    }
+    try {
+        handleMessage(datagram);
+    } catch (const std::exception& e) {
+        std::cerr << "Connection: Ignoring datagram: " << e.what() << std::endl;
+    }
+}
+
+void AutomatonEngine::onWakeup() {
+    // Virtual time does not wait, it jumps straight to the wakeup
+    clock.advanceTo(wakeup);
+    step();
+}
+
+EventLoop::EventLoop(Host& host, bool listening): host(host), listening(listening), active(0), virtualEngines(0) {
+#ifdef __linux__
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (epollFd < 0 || wakeFd < 0 || timerFd < 0){
+        std::cerr << "Failed to create epoll instance" << std::endl;
+        std::exit(1);
+    }
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.u64 = WAKE_TAG;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &event);
+    event.data.u64 = TIMER_TAG;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, timerFd, &event);
+    if (listening){
+        event.data.u64 = SOCKET_TAG;
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, host.getComm().getSocket(), &event);
+    }
+#endif
+}
+
+size_t EventLoop::add(AutomatonEngine* engine) {
+    sources.push_back({engine, TimePoint::max(), false, false});
+    return sources.size() - 1;
+}
+
+void EventLoop::deliver(size_t source, const std::string& datagram, const struct sockaddr_in& from) {
+    Source& target = sources[source];
+    if (target.removed){
+        return;
+    }
+    target.engine->deliver(datagram, from);
+    // Everything that arrived is handled before the step, so a burst costs one step
+    if (!target.delivered){
+        target.delivered = true;
+        touched.push_back(source);
+    }
+}
+
+void EventLoop::post(size_t source, std::string datagram, const struct sockaddr_in& from) {
+    {
+        std::lock_guard<std::mutex> lock(inboxLock);
+        inbox.push_back({source, std::move(datagram), from});
+    }
+    wake();
+}
+
+// Pushes the wakeup of an engine on wall clock time unless it is already in the heap
+void EventLoop::schedule(size_t index) {
+    Source& source = sources[index];
+    TimePoint wakeup = source.engine->getWakeup();
+    if (source.engine->isVirtualTime() || wakeup == source.scheduled){
+        return;
+    }
+    source.scheduled = wakeup;
+    if (wakeup != TimePoint::max()){
+        deadlines.emplace(wakeup, index);
+    }
+}
+
+// Entries whose engine was rescheduled or removed since are dropped lazily
+EventLoop::TimePoint EventLoop::nextDeadline() {
+    while (!deadlines.empty()){
+        const Source& source = sources[deadlines.top().second];
+        if (!source.removed && source.scheduled == deadlines.top().first){
+            return deadlines.top().first;
         }
+        deadlines.pop();
     }
+    return TimePoint::max();
+}
 
-    return result;
+void EventLoop::wakeDue(TimePoint now) {
+    while (nextDeadline() <= now){
+        size_t index = deadlines.top().second;
+        deadlines.pop();
+        sources[index].scheduled = TimePoint::max();
+        sources[index].engine->onWakeup();
+        touched.push_back(index);
+    }
 }
 
-void AutomatonEngine::executeOutputAction() {
-    size_t startpos = 0, endpos;
-    std::string expr;
-    std::smatch match, match2;
-    variableType exprResult;
-    while ((endpos = currentState->outputExpression.find(";", startpos)) != std::string::npos){
-        expr = currentState->outputExpression.substr(startpos, endpos - startpos);
+// Engines on virtual time with a pending wakeup must not block
+bool EventLoop::virtualPending() const {
+    for (size_t i = 0; virtualEngines > 0 && i < sources.size(); i++){
+        const Source& source = sources[i];
+        if (!source.removed && source.engine->isVirtualTime() && source.engine->getWakeup() != TimePoint::max()){
+            return true;
+        }
+    }
+    return false;
+}
 
-        if(std::regex_match(expr, match, std::regex("^if (.+) is defined ?$"))){
-            if (!(inputs.find(match[1]) != inputs.end() && !inputs[match[1]].empty())){
-                return;
-            }
-        }else if (std::regex_match(expr, match, std::regex("^([^= ]+) ?= ?(.+)$"))){
-            if (variables.find(match[1]) != variables.end()){
-                std::string varExpression = match.str(2);
-                if (std::regex_match(varExpression, match2, std::regex("^ ?get +([^ ]+)$"))){
-                    if (inputs.find(match2[1]) != inputs.end()){
-                        variables[match[1]] = inputs[match2[1]];
-                        sendVariableChange(match[1], inputs[match2[1]]);
-                        std::cout << "Action: Variable " << match[1] << " set to " << inputs[match2[1]] << std::endl;
-                    }
-                }else {
-                    exprResult = evaluateExpression(match.str(2));
-                    variables[match[1]] = exprResult;
-                    sendVariableChange(match[1], variantToString(exprResult));
-                    std::cout << "Action: Variable " << match[1] << " set to " << variantToString(exprResult) << std::endl;
-                }
-            }
-        }else if (std::regex_match(expr, match, std::regex("^output ([^ ]+) to (.+)$"))){
-            if (outputs.find(match[2]) != outputs.end()){
-                exprResult = evaluateExpression(match.str(1));
-                outputs[match[2]] = variantToString(exprResult);
-                sendOutputChange(match[2], variantToString(exprResult));
-                std::cout << "Action: Output " << match[2] << " set to " << variantToString(exprResult) << std::endl;
+// Engines on virtual time jump to their wakeups once nothing else is pending
+void EventLoop::wakeVirtual() {
+    for (size_t i = 0; virtualEngines > 0 && i < sources.size(); i++){
+        const Source& source = sources[i];
+        if (!source.removed && source.engine->isVirtualTime() && source.engine->getWakeup() != TimePoint::max()){
+            source.engine->onWakeup();
+            touched.push_back(i);
+        }
+    }
+}
+
+// Steps engines that got datagrams, then retires stopped engines and schedules the rest
+void EventLoop::settle() {
+    for (size_t index: touched){
+        Source& source = sources[index];
+        if (source.removed){
+            continue;
+        }
+        if (source.delivered){
+            source.delivered = false;
+            if (source.engine->isRunning()){
+                source.engine->step();
             }
         }
+        if (!source.engine->isRunning()){
+            source.removed = true;
+            active--;
+            virtualEngines -= source.engine->isVirtualTime();
+            host.engineStopped();
+        }else{
+            schedule(index);
+        }
+    }
+    touched.clear();
+}
 
-        startpos = endpos + 1;
+#ifdef __linux__
+EventLoop::~EventLoop() {
+    close(timerFd);
+    close(wakeFd);
+    close(epollFd);
+}
+
+void EventLoop::wake() {
+    uint64_t one = 1;
+    if (write(wakeFd, &one, sizeof(one)) != sizeof(one)){
+        // The counter is already pending, the loop wakes up anyway
     }
 }
 
-void AutomatonEngine::tick() {
-    checkTimers();
+void EventLoop::run() {
+    for (size_t i = 0; i < sources.size(); i++){
+        sources[i].engine->start();
+        active++;
+        virtualEngines += sources[i].engine->isVirtualTime();
+        touched.push_back(i);
+    }
+    settle();
+
+    std::vector<epoll_event> events(64);
+    std::vector<Delivery> deliveries;
+    struct sockaddr_in from{};
+    TimePoint armed = TimePoint::min();
+    // The listening loop keeps routing until every instance of the process stopped
+    while (listening ? host.isActive() : active > 0){
+        // steady_clock is CLOCK_MONOTONIC, so the earliest wakeup is used as an absolute expiration
+        TimePoint deadline = nextDeadline();
+        if (deadline != armed){
+            itimerspec spec{};
+            if (deadline != TimePoint::max()){
+                long long ns = std::max(1LL, (long long)std::chrono::duration_cast<std::chrono::nanoseconds>(deadline.time_since_epoch()).count());
+                spec.it_value.tv_sec = ns / 1000000000;
+                spec.it_value.tv_nsec = ns % 1000000000;
+            }
+            timerfd_settime(timerFd, TFD_TIMER_ABSTIME, &spec, nullptr);
+            armed = deadline;
+        }
 
-    for (Transition* t: currentState->outgoing) {
-        if (t->evaluateTransitionCondition(inputs, variables)){
-            if (std::stoll(t->timeout) > 0){
-                if (!t->timeoutTimer->active){
-                    t->timeoutTimer->start = std::chrono::steady_clock::now();
-                    t->timeoutTimer->active = true;
-                }
+        int timeout = virtualPending() ? 0 : -1;
+        int ready = epoll_wait(epollFd, events.data(), int(events.size()), timeout);
+        if (ready < 0){
+            if (errno == EINTR){
                 continue;
             }
-            if (t->to != t->from){
-                resetTimers();
-                std::cout << "Action: State changed from " << t->from->name << " to " << t->to->name << std::endl;
-                sendStateChange(t->to->name);
-                currentState->start = std::chrono::steady_clock::now();
+            std::cerr << "Failed to wait for events" << std::endl;
+            std::exit(1);
+        }
+
+        for (int i = 0; i < ready; i++){
+            if (events[i].data.u64 == SOCKET_TAG){
+                while (std::optional<std::string> datagram = host.getComm().receive(from)){
+                    host.route(*datagram, from, this);
+                }
+            }else if (events[i].data.u64 == WAKE_TAG){
+                uint64_t count;
+                if (read(wakeFd, &count, sizeof(count)) != sizeof(count)){
+                    continue;
+                }
+                {
+                    std::lock_guard<std::mutex> lock(inboxLock);
+                    deliveries.swap(inbox);
+                }
+                for (const Delivery& delivery: deliveries){
+                    deliver(delivery.source, delivery.datagram, delivery.from);
+                }
+                deliveries.clear();
+            }else{
+                uint64_t expirations;
+                if (read(timerFd, &expirations, sizeof(expirations)) == sizeof(expirations)){
+                    armed = TimePoint::min();
+                }
             }
-            currentState = t->to;
-            executeOutputAction();
         }
+        wakeDue(std::chrono::steady_clock::now());
+        if (ready == 0 && timeout == 0){
+            wakeVirtual();
+        }
+        settle();
     }
 }
+#else
+EventLoop::~EventLoop() {}
 
-void AutomatonEngine::sendStateChange(std::string newState) {
-    std::string msg;
-    msg = {static_cast<char>(0x03)};
-    msg += "\r\n";
-    msg += newState + "\r\n";
-    if (!(comm.send(msg))){
-        std::cerr << "Failed to send" << std::endl;
-        std::exit(1);
+// Without Linux there is a single loop, nothing is ever posted to it
+void EventLoop::wake() {}
+
+void EventLoop::run() {
+    for (size_t i = 0; i < sources.size(); i++){
+        sources[i].engine->start();
+        active++;
+        virtualEngines += sources[i].engine->isVirtualTime();
+        touched.push_back(i);
+    }
+    settle();
+
+    SOCKET sock = host.getComm().getSocket();
+    struct sockaddr_in from{};
+    while (active > 0){
+        // Sleep until the earliest wakeup or until a datagram arrives, block if there is none
+        fd_set readfs;
+        FD_ZERO(&readfs);
+        FD_SET(sock, &readfs);
+        TimePoint deadline = nextDeadline();
+        timeval tv{};
+        timeval* timeout = nullptr;
+        if (virtualPending()){
+            timeout = &tv;
+        }else if (deadline != TimePoint::max()){
+            long long wait = std::max(0LL, (long long)std::chrono::ceil<std::chrono::microseconds>(deadline - std::chrono::steady_clock::now()).count());
+            tv.tv_sec = long(wait / 1000000);
+            tv.tv_usec = long(wait % 1000000);
+            timeout = &tv;
+        }
+        int ready = select(int(sock) + 1, &readfs, nullptr, nullptr, timeout);
+        if (ready < 0){
+            std::cerr << "Failed to wait for events" << std::endl;
+            std::exit(1);
+        }
+
+        if (ready > 0){
+            while (std::optional<std::string> datagram = host.getComm().receive(from)){
+                host.route(*datagram, from, this);
+            }
+        }
+        wakeDue(std::chrono::steady_clock::now());
+        if (ready == 0 && timeout == &tv && virtualPending()){
+            wakeVirtual();
+        }
+        settle();
     }
 }
+#endif
 
-void AutomatonEngine::sendVariableChange(std::string variableName, std::string value) {
-    std::string msg;
-    msg = {static_cast<char>(0x04)};
-    msg += "\r\n";
-    msg += variableName + "\r\n";
-    msg += value + "\r\n";
-    if (!(comm.send(msg))){
-        std::cerr << "Failed to send" << std::endl;
-        std::exit(1);
+Host::Host(IOComm& comm, std::vector<std::unique_ptr<AutomatonEngine>>& engines, size_t workers): comm(comm), active(engines.size()) {
+#ifndef __linux__
+    // Worker threads need the inboxes of the Linux loop
+    workers = 1;
+#endif
+    workers = std::max<size_t>(1, std::min(workers, engines.size()));
+    for (size_t i = 0; i < workers; i++){
+        loops.push_back(std::make_unique<EventLoop>(*this, i == 0));
+    }
+    for (size_t i = 0; i < engines.size(); i++){
+        EventLoop* loop = loops[i % workers].get();
+        routes.emplace_back(loop, loop->add(engines[i].get()));
     }
 }
 
-void AutomatonEngine::sendOutputChange(std::string outputName, std::string value) {
-    std::string msg;
-    msg = {static_cast<char>(0x05)};
-    msg += "\r\n";
-    msg += outputName + "\r\n";
-    msg += value + "\r\n";
-    if (!(comm.send(msg))){
-        std::cerr << "Failed to send" << std::endl;
-        std::exit(1);
+void Host::route(const std::string& datagram, const struct sockaddr_in& from, EventLoop* caller) {
+    // Only the header is checked here, the instance parses the records
+    if (datagram.size() < WireProtocol::HEADER_SIZE || datagram[0] != WireProtocol::MAGIC){
+        std::cerr << "Connection: Ignoring datagram: Not a datagram of the automaton protocol" << std::endl;
+        return;
+    }
+    uint32_t instance = (uint32_t(uint8_t(datagram[2])) << 24) | (uint32_t(uint8_t(datagram[3])) << 16)
+                      | (uint32_t(uint8_t(datagram[4])) << 8) | uint32_t(uint8_t(datagram[5]));
+    if (instance >= routes.size()){
+        std::cerr << "Connection: Ignoring datagram for unknown instance " << instance << std::endl;
+        return;
+    }
+    auto [loop, source] = routes[instance];
+    if (loop == caller){
+        loop->deliver(source, datagram, from);
+    }else{
+        loop->post(source, datagram, from);
     }
 }
 
-void AutomatonEngine::sendInitialMessage() {
-    std::string msg;
-    std::string inputsMsg;
-    std::string outputsMsg;
-    std::string variablesMsg;
-    msg += static_cast<char>(0x06);
-    msg += "\r\n";
-    msg += FSM_DEFINITION_PATH;
-    msg += "\r\n";
-    msg += currentState->name + "\r\n";
-    for (auto i: inputs){
-        inputsMsg += i.first + "\r\n" + i.second + "\r\n";
-    }
-    msg += std::to_string(uint16_t(inputsMsg.length())) + "\r\n";
-    msg += inputsMsg;
-    for (auto o: outputs){
-        outputsMsg += o.first + "\r\n" + o.second + "\r\n";
-    }
-    msg += std::to_string(uint16_t(outputsMsg.length())) + "\r\n";
-    msg += outputsMsg;
-    for (auto v: variables){
-        variablesMsg += v.first + "\r\n" + variantToString(v.second) + "\r\n";
-    }
-    msg += std::to_string(uint16_t(variablesMsg.length())) + "\r\n";
-    msg += variablesMsg + "\r\n";
-    if (!(comm.send(msg))){
-        std::cerr << "Failed to send" << std::endl;
-        std::exit(1);
+void Host::engineStopped() {
+    // The listening loop waits for the last instance anywhere in the process
+    if (--active == 0){
+        loops[0]->wake();
     }
 }
 
-void AutomatonEngine::run() {
-    std::cout << "Executing FSM " << FSM_NAME << "..." << std::endl;
-    std::cout << "Entry point: Entered state " << currentState->name << std::endl;
-    executeOutputAction();
-    bool cond = true;
-    while (cond) {
-        tick();
-        auto msg = comm.receive(100);
-        if (msg.has_value()){
-            switch (int((*msg)[0])){
-                case 0x00:
-                    sendInitialMessage();
-                    std::cout << "Connection: Remote editor has established connection with this FSM" << std::endl;
-                    break;
-                case 0x01:
-                    {
-                        size_t inputPtrNameEdge = (*msg).find("\r\n", 2);
-                        if (inputs.find((*msg).substr(3, inputPtrNameEdge - 3)) != inputs.end()){
-                            size_t inputValueEdge = (*msg).find("\r\n", inputPtrNameEdge + 2);
-                            inputs[(*msg).substr(3, inputPtrNameEdge -3)] = (*msg).substr(inputPtrNameEdge + 2, inputValueEdge - inputPtrNameEdge - 2);
-                            std::cout << "Input: got " << (*msg).substr(inputPtrNameEdge + 2, inputValueEdge - inputPtrNameEdge - 2) << " from " << (*msg).substr(3, inputPtrNameEdge - 3) << std::endl;
-                        }
-                    }
-                    break;
-                case 0x02:
-                    cond = false;
-                    break;
-                case 0x07:
-                    {
-                        if (comm.editorConnected){
-                            comm.editorConnected = false;
-                            std::cout << "Connection: Remote editor has disconnected from this FSM" << std::endl;
-                        }
-                    }
-                    break;
-            }
+void Host::run() {
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < loops.size(); i++){
+        EventLoop* loop = loops[i].get();
+        workers.emplace_back([loop](){ loop->run(); });
+    }
+    loops[0]->run();
+    for (std::thread& worker: workers){
+        worker.join();
+    }
+}
+
+int runAutomata(int argc, char* argv[], void (*define)(AutomatonEngine&)) {
+    bool virtualTime = false;
+    bool quiet = false;
+    long instances = 1;
+    long workers = 1;
+    long port = 56789;
+    for (int i = 1; i < argc; i++){
+        std::string arg = argv[i];
+        long* value = arg == "--instances" ? &instances : arg == "--workers" ? &workers : arg == "--port" ? &port : nullptr;
+        if (arg == "--virtual-time"){
+            virtualTime = true;
+        }else if (arg == "--quiet"){
+            quiet = true;
+        }else if (value && i + 1 < argc){
+            *value = std::strtol(argv[++i], nullptr, 10);
+        }else{
+            instances = 0;
         }
+        if (instances < 1 || workers < 1 || port < 0 || port > 65535){
+            std::cerr << "Usage: " << argv[0] << " [--virtual-time] [--quiet] [--instances n] [--workers n] [--port port]" << std::endl;
+            return 1;
+        }
+    }
+
+    IOComm comm(static_cast<int>(port));
+    comm.setNonBlocking();
+    std::vector<std::unique_ptr<AutomatonEngine>> engines;
+    for (long i = 0; i < instances; i++){
+        engines.push_back(std::make_unique<AutomatonEngine>(uint32_t(i), comm));
+        engines.back()->setLogging(quiet, instances > 1);
+        define(*engines.back());
+        engines.back()->setVirtualTime(virtualTime);
+    }
+    if (instances > 1){
+        std::cout << "Hosting " << instances << " instances on port " << port << " with " << std::min(workers, instances) << " workers" << std::endl;
     }
+    Host host(comm, engines, size_t(workers));
+    host.run();
+    return 0;
 }
 
 void AutomatonEngine::createInputPointer(std::string name) {
     inputs[name] = "";
+    inputSlots.push_back(name);
 }
 
 void AutomatonEngine::createOutputPointer(std::string name) {
     outputs[name] = "";
+    outputSlots.add(name);
 }
 
 void AutomatonEngine::createVariable(std::string name, variableType data) {
     variables[name] = data;
+    variableSlots.add(name);
 }
 
-AutomatonEngine::AutomatonEngine(): currentState(nullptr), comm(56789) {
-    comm.setNonBlocking();
+void AutomatonEngine::setVirtualTime(bool enabled) {
+    clock.setVirtual(enabled);
+    if (enabled){
+        log() << "Clock: Running on virtual time" << std::endl;
+    }
+}
+
+AutomatonEngine::AutomatonEngine(uint32_t instance, IOComm& comm): currentState(nullptr), instance(instance), comm(comm), editorConnected(false), editorAddress{},
+    quiet(false), tagged(false), sentState(-1), layoutChanged(false), sequence(0), running(false), wakeup(std::chrono::steady_clock::time_point::max()) {
 }
 
 AutomatonEngine::~AutomatonEngine() {
@@ -641,7 +1055,104 @@ AutomatonEngine::~AutomatonEngine() {
 )===";
 
 std::string CodeGenarator::networkFunctions = R"===(
-IOComm::IOComm(int port) {
+WireWriter::WireWriter(uint32_t instance, uint32_t sequence): recordStart(std::string::npos) {
+    data.reserve(WireProtocol::MAX_DATAGRAM);
+    data += WireProtocol::MAGIC;
+    data += static_cast<char>(WireProtocol::VERSION);
+    writeU32(instance);
+    writeU32(sequence);
+}
+
+void WireWriter::beginRecord(WireProtocol::RecordType type) {
+    recordStart = data.size();
+    data += static_cast<char>(type);
+    writeU16(0);
+}
+
+void WireWriter::endRecord() {
+    size_t length = data.size() - recordStart - WireProtocol::RECORD_HEADER_SIZE;
+    if (length > 0xFFFF){
+        throw std::runtime_error("Record too long: " + std::to_string(length) + " bytes");
+    }
+    data[recordStart + 1] = static_cast<char>(length >> 8);
+    data[recordStart + 2] = static_cast<char>(length & 0xFF);
+    recordStart = std::string::npos;
+}
+
+void WireWriter::writeU16(uint16_t value) {
+    data += static_cast<char>(value >> 8);
+    data += static_cast<char>(value & 0xFF);
+}
+
+void WireWriter::writeU32(uint32_t value) {
+    writeU16(static_cast<uint16_t>(value >> 16));
+    writeU16(static_cast<uint16_t>(value & 0xFFFF));
+}
+
+void WireWriter::writeString(const std::string& value) {
+    if (value.size() > 0xFFFF){
+        throw std::runtime_error("String too long: " + std::to_string(value.size()) + " bytes");
+    }
+    writeU16(static_cast<uint16_t>(value.size()));
+    data += value;
+}
+
+WireReader::WireReader(const std::string& data): data(data), position(0), recordEnd(0), instance(0), sequence(0) {
+    if (data.size() < WireProtocol::HEADER_SIZE || data[0] != WireProtocol::MAGIC){
+        throw std::runtime_error("Not a datagram of the automaton protocol");
+    }
+    if (static_cast<uint8_t>(data[1]) != WireProtocol::VERSION){
+        throw std::runtime_error("Unsupported protocol version " + std::to_string(static_cast<uint8_t>(data[1])));
+    }
+    position = 2;
+    recordEnd = WireProtocol::HEADER_SIZE;
+    instance = readU32();
+    sequence = readU32();
+}
+
+void WireReader::require(size_t count) const {
+    if (position + count > recordEnd){
+        throw std::runtime_error("Truncated record");
+    }
+}
+
+bool WireReader::nextRecord(WireProtocol::RecordType& type) {
+    position = recordEnd;
+    if (position == data.size()){
+        return false;
+    }
+    recordEnd = data.size();
+    require(WireProtocol::RECORD_HEADER_SIZE);
+    type = static_cast<WireProtocol::RecordType>(static_cast<uint8_t>(data[position++]));
+    size_t length = readU16();
+    recordEnd = position + length;
+    if (recordEnd > data.size()){
+        throw std::runtime_error("Truncated record");
+    }
+    return true;
+}
+
+uint16_t WireReader::readU16() {
+    require(2);
+    uint16_t value = static_cast<uint16_t>((static_cast<uint8_t>(data[position]) << 8) | static_cast<uint8_t>(data[position + 1]));
+    position += 2;
+    return value;
+}
+
+uint32_t WireReader::readU32() {
+    uint32_t high = readU16();
+    return (high << 16) | readU16();
+}
+
+std::string WireReader::readString() {
+    size_t length = readU16();
+    require(length);
+    std::string value = data.substr(position, length);
+    position += length;
+    return value;
+}
+
+IOComm::IOComm(int port): buffer(WireProtocol::MAX_RECEIVE) {
 #ifdef _WIN32
     WSDATA wsaData;
     WSAStartup(MAKEWORD(2, 2), &wsaData);
@@ -662,7 +1173,6 @@ IOComm::IOComm(int port) {
         std::cerr << "Bind failed" << std::endl;
         std::exit(1);
     }
-    editorConnected = false;
 }
 
 IOComm::~IOComm() {
@@ -684,32 +1194,21 @@ bool IOComm::setNonBlocking() {
 #endif
 }
 
-std::optional<std::string> IOComm::receive(int timeout) {
-    fd_set readfs;
-    FD_ZERO(&readfs);
-    FD_SET(sock, &readfs);
-
-    timeval tv{};
-    tv.tv_sec = timeout / 1000;
-    tv.tv_usec = (timeout % 1000) * 1000;
-
-    int ready = select(sock + 1, &readfs, nullptr, nullptr, &tv);
+std::optional<std::string> IOComm::receive(struct sockaddr_in& from) {
+    // The socket is non-blocking, the caller waits for it to become readable
+    socklen_t fromlen = sizeof(from);
 
-    if (ready > 0 && FD_ISSET(sock, &readfs)) {
-        char buffer[2048];
-        struct sockaddr_in fromAddr{};
-        socklen_t fromlen = sizeof(fromAddr);
+    int received = recvfrom(sock, buffer.data(), buffer.size(), 0, (struct sockaddr *) &from, &fromlen);
 
-        int received = recvfrom(sock, buffer, sizeof(buffer) - 1, 0, (struct sockaddr *) &fromAddr, &fromlen);
-
-        if (received > 0) {
-            if (!editorConnected && buffer[0] != 0x07){
-                remoteAddress = fromAddr;
-                editorConnected = true;
-            }
-            buffer[received] = '\0';
-            return std::string(buffer);
-        } else if (received < 0) {
+    if (received >= 0) {
+        return std::string(buffer.data(), received);
+    } else {
+#ifdef _WIN32
+        bool wouldBlock = WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+        bool wouldBlock = errno == EAGAIN || errno == EWOULDBLOCK;
+#endif
+        if (!wouldBlock){
             std::cerr << "Failed to receive" << std::endl;
             std::exit(1);
         }
@@ -717,207 +1216,371 @@ std::optional<std::string> IOComm::receive(int timeout) {
     return std::nullopt;
 }
 
-bool IOComm::send(const std::string &message) {
-    if (!editorConnected) return true;
-    int sent = sendto(sock, message.c_str(), message.size(), 0, (struct sockaddr*)&remoteAddress, sizeof(remoteAddress));
+bool IOComm::send(const std::string &message, const struct sockaddr_in& to) {
+    int sent = sendto(sock, message.c_str(), message.size(), 0, (struct sockaddr*)&to, sizeof(to));
     return sent != SOCKET_ERROR;
 }
 )===";
 
 
 /**
- * @brief Generates C++ code from the internal representation of a Moore Machine
+ * @brief Gets the file name part of a path
  *
- * @param machine Internal representation of a Moore Machine
- * @param filename Path for the generated code
- * @return True if generation is successful, false otherwise
+ * @param path Path of a generated file
+ * @return The path without its directories
  */
-bool CodeGenarator::generateCode(const MooreMachine &machine, const std::string &filename) {
-    // Save text form of generated automaton
-    MachineFileHandler::saveToFile(machine, filename + ".fsm");
-    // Open file for writing
-    std::string cppFilename = filename + ".cpp";
-    std::ofstream file(cppFilename);
-    if (!file.is_open()) {
-        return false;
-    }
-
-    // Write static blocks of code
-    file << generatedFileHeader << std::endl;
-    file << "#define FSM_NAME \"" << machine.getName() << "\"" << std::endl;
-    file << "#define FSM_DEFINITION_PATH \"" << filename << ".fsm" << "\"" << std::endl;
-    file << networkFunctions << std::endl;
-    file << helperFunctions << std::endl;
-    file << transitionFunctions << std::endl;
-    file << automatonEngineFunctions << std::endl;
-
-    // Write main function head
-    file << "int main(){" << std::endl;
-    file << "\t" << "AutomatonEngine ae;" << std::endl;
-
-    // Generate representation of all inputs
-    auto inputPointers = machine.getInputPointers();
-    for (const auto& pointer : inputPointers) {
-        file << "\t" << "ae.createInputPointer(\"" << pointer << "\");" << std::endl;
-    }
-
-    // Generate representation of all outputs
-    auto outputPointers = machine.getOutputPointers();
-    for (const auto& pointer : outputPointers) {
-        file << "\t" << "ae.createOutputPointer(\"" << pointer << "\");" << std::endl;
-    }
+static std::string baseName(const std::string& path) {
+    size_t slash = path.find_last_of("/\\");
+    return slash == std::string::npos ? path : path.substr(slash + 1);
+}
 
-    // Generate representation of all variables
-    auto variables = machine.getVariables();
-    for (const auto& varPair : variables) {
-        const auto &var = varPair.second;
-        file << "\t" << "ae.createVariable(\"" << var.getName() << "\", " << var.getValueString() << ");" << std::endl;
-    }
+/**
+ * @brief Gets the object file a generated source compiles to
+ *
+ * @param sourcePath Path of a generated .cpp file
+ * @return The same path ending with .o instead
+ */
+std::string CodeGenarator::objectPath(const std::string& sourcePath) {
+    return sourcePath.substr(0, sourcePath.size() - 4) + ".o";
+}
 
-    // Generate all states
-    State* initialState = const_cast<MooreMachine&>(machine).getInitialState();
+/**
+ * @brief Gets the compiler the generated sources are built with
+ *
+ * @return Name of the compiler executable
+ */
+std::string CodeGenarator::compilerName() {
+    // Select compiler according to the platform
+#ifdef _WIN32
+    return "g++.exe";
+#else
+    return "g++";
+#endif
+}
 
-    if (initialState) {
-        file << "\t" << "ae.createState(\"" << initialState->getName() << "\", \"";
-
-        auto outputs = initialState->getOutputs();
-        if (!outputs.empty()) {
-            for (const auto& output : outputs) {
-                // Check if this is a variable expression or regular output
-                if (output.value.find("=") != std::string::npos ||
-                    output.value.find("+") != std::string::npos ||
-                    output.value.find("-") != std::string::npos ||
-                    output.value.find("*") != std::string::npos ||
-                    output.value.find("/") != std::string::npos) {
-                    file << output.value;
-                } else {
-                    file << "output " << output.value << " to " << output.target;
-                }
-                // Add condition if present
-                if (output.hasCondition) {
-                    file << " if " << output.inputPtr << " is defined";
-                }
+/**
+ * @brief Gets the options every generated source is compiled and linked with
+ *
+ * @return Compiler options
+ */
+std::vector<std::string> CodeGenarator::compilerOptions() {
+    return {"-std=c++17", "-pthread"};
+}
 
-                file << ";";
-            }
+/**
+ * @brief Generates the guards of one unit's transitions
+ *
+ * A guard holds when any of its conditions does, like in MachineSimulator.
+ * A transition without conditions always holds, so its timeout starts right away.
+ *
+ * @param out Buffer the code is appended to
+ * @param translator Translator of the machine the transitions belong to
+ * @param transitions Transitions in the order their guards are numbered
+ * @param unit Index of the unit, it holds the guards from unit * unitSize on
+ * @param unitSize Number of guards in a unit
+ */
+void CodeGenarator::generateGuards(CodeBuffer& out, const ActionTranslator& translator,
+                                   const std::vector<Transition*>& transitions, size_t unit, size_t unitSize) {
+    size_t first = std::min(unit * unitSize, transitions.size());
+    size_t last = std::min(first + unitSize, transitions.size());
+
+    out << "template <> bool AutomatonEngine::evaluateGuards<" << unit << ">(int guard) {\n";
+    out << "    switch (guard) {\n";
+    for (size_t i = first; i < last; i++) {
+        out << "        case " << i << ": {\n";
+        if (transitions[i]->getInputConditions().empty()) {
+            out << "            return true;\n";
+        } else {
+            out << translator.guard(*transitions[i], "            ");
+            out << "            return false;\n";
         }
-        file << "\");" << std::endl;
+        out << "        }\n";
     }
-
-    for (State* state : const_cast<MooreMachine&>(machine).getAllStates()) {
-        // Skip the initial state (already written)
-        if (initialState && state->getId() == initialState->getId()) {
+    out << "    }\n";
+    out << "    return false;\n";
+    out << "}\n\n";
+
+    // Inputs a transition was taken on are used up
+    out << "template <> void AutomatonEngine::consumeUnitInputs<" << unit << ">(int guard) {\n";
+    out << "    switch (guard) {\n";
+    for (size_t i = first; i < last; i++) {
+        std::string statements = translator.consumedInputs(*transitions[i], "            ");
+        if (statements.empty()) {
             continue;
         }
-        file << "\t" << "ae.createState(\"" << state->getName() << "\", \"";
-        auto outputs = state->getOutputs();
-        if (!outputs.empty()) {
-            for (const auto& output : outputs) {
-                // Check if this is a variable expression or regular output
-                if (output.value.find("=") != std::string::npos ||
-                    output.value.find("+") != std::string::npos ||
-                    output.value.find("-") != std::string::npos ||
-                    output.value.find("*") != std::string::npos ||
-                    output.value.find("/") != std::string::npos) {
-                    file << output.value;
-                } else {
-                    file << "output " << output.value << " to " << output.target;
-                }
-                // Add condition if present
-                if (output.hasCondition) {
-                    file << " if " << output.inputPtr << " is defined";
-                }
-
-                file << ";";
-            }
-        }
-        file << "\");" << std::endl;
+        out << "        case " << i << ":\n";
+        out << statements;
+        out << "            break;\n";
     }
+    out << "        default:\n";
+    out << "            break;\n";
+    out << "    }\n";
+    out << "}\n";
+}
 
-    // Generate all transitions
-    for (State* sourceState : const_cast<MooreMachine&>(machine).getAllStates()) {
-        auto transitions = const_cast<MooreMachine&>(machine).getTransitionsFromState(sourceState->getId());
-
-        // Group transitions by target state
-        std::unordered_map<std::string, std::vector<Transition*>> transitionsByTarget;
-        for (Transition* transition : transitions) {
-            transitionsByTarget[transition->getTargetId()].push_back(transition);
-        }
-
-        // Write each target group
-        for (const auto& targetGroup : transitionsByTarget) {
-            State* targetState = const_cast<MooreMachine&>(machine).getState(targetGroup.first);
-            file << "\t" << "ae.createTransition(\"" << sourceState->getName() << "\", \"" << targetState->getName() << "\", \"";
-            for (Transition* transition : targetGroup.second) {
-                // Write all input conditions
-                for (const auto& inputCondition: transition->getInputConditions()) {
-                    if (inputCondition.isBooleanExpr) {
-                        file << inputCondition.leftOperand << " " << inputCondition.operation << " " << inputCondition.rightOperand;
-                    }else{
-                        file << "got " << inputCondition.value << " from " << inputCondition.source;
-                    }
-                    file << ";";
-                }
-                file << "\", \"";
-                if (transition->getTimeout() > 0) {
-                    file << transition->getTimeout() << "\");" << std::endl;
-                }else{
-                    file << "0\");" << std::endl;
-                }
-            }
-        }
+/**
+ * @brief Generates the output actions of one unit's states
+ *
+ * @param out Buffer the code is appended to
+ * @param translator Translator of the machine the states belong to
+ * @param states States in the order they are numbered
+ * @param unit Index of the unit, it holds the states from unit * unitSize on
+ * @param unitSize Number of states in a unit
+ */
+void CodeGenarator::generateOutputActions(CodeBuffer& out, const ActionTranslator& translator,
+                                          const std::vector<State*>& states, size_t unit, size_t unitSize) {
+    size_t first = std::min(unit * unitSize, states.size());
+    size_t last = std::min(first + unitSize, states.size());
+
+    out << "template <> void AutomatonEngine::executeOutputActions<" << unit << ">(int state) {\n";
+    out << "    switch (state) {\n";
+    for (size_t i = first; i < last; i++) {
+        out << "        case " << i << ": {\n";
+        out << translator.outputs(*states[i], "            ");
+        out << "            break;\n";
+        out << "        }\n";
     }
+    out << "    }\n";
+    out << "}\n";
+}
 
-    file << "\t" << "ae.run();" << std::endl;
-    file << "\t" <<"return 0;" << std::endl;
-    file << "}" << std::endl;
-
-    if (!file.good()){
-        return false;
+/**
+ * @brief Generates the members that pass a guard or state on to the unit holding it
+ *
+ * @param out Buffer the code is appended to
+ * @param units Number of units
+ * @param unitSize Number of guards and states in a unit
+ */
+void CodeGenarator::generateDispatchers(CodeBuffer& out, size_t units, size_t unitSize) {
+    // The units define these, they have to be declared before they are called
+    for (size_t unit = 0; unit < units; unit++) {
+        out << "template <> bool AutomatonEngine::evaluateGuards<" << unit << ">(int guard);\n";
+        out << "template <> void AutomatonEngine::consumeUnitInputs<" << unit << ">(int guard);\n";
+        out << "template <> void AutomatonEngine::executeOutputActions<" << unit << ">(int state);\n";
     }
-    file.close();
-    std::string outputFilename;
-
-    // Set executable name according to the target platform
-#ifdef _WIN32
-    outputFilename = filename + ".exe";
-#else
-    outputFilename = filename;
-#endif
 
-    compileGeneratedCode(QString::fromStdString(cppFilename), QString::fromStdString(outputFilename));
-    return true;
+    out << "\nbool AutomatonEngine::evaluateGuard(int guard) {\n";
+    out << "    switch (guard / " << unitSize << ") {\n";
+    for (size_t unit = 0; unit < units; unit++) {
+        out << "        case " << unit << ": return evaluateGuards<" << unit << ">(guard);\n";
+    }
+    out << "    }\n";
+    out << "    return false;\n";
+    out << "}\n\n";
+
+    out << "void AutomatonEngine::consumeInputs(int guard) {\n";
+    out << "    switch (guard / " << unitSize << ") {\n";
+    for (size_t unit = 0; unit < units; unit++) {
+        out << "        case " << unit << ": consumeUnitInputs<" << unit << ">(guard); break;\n";
+    }
+    out << "    }\n";
+    out << "}\n\n";
+
+    out << "void AutomatonEngine::executeOutputAction() {\n";
+    out << "    int state = currentState->index;\n";
+    out << "    switch (state / " << unitSize << ") {\n";
+    for (size_t unit = 0; unit < units; unit++) {
+        out << "        case " << unit << ": executeOutputActions<" << unit << ">(state); break;\n";
+    }
+    out << "    }\n";
+    out << "}\n";
 }
 
+/**
+ * @brief Writes a makefile and a ninja file building the generated sources in parallel
+ *
+ * Both use paths relative to their own directory and are run from it,
+ * with "make -f name.mk -j" or "ninja -f name.ninja".
+ *
+ * @param out Buffer reused for the files
+ * @param program Files of the generated program
+ */
+void CodeGenarator::writeBuildFiles(CodeBuffer& out, const GeneratedProgram& program) {
+    std::string options;
+    for (const std::string& option : compilerOptions()) {
+        options += (options.empty() ? "" : " ") + option;
+    }
+    std::string header = baseName(program.header);
+    std::string executable = baseName(program.executable);
+
+    out.clear();
+    out << "# Builds " << executable << ", run \"make -f " << baseName(program.makefile) << " -j\" in this directory\n";
+    out << "CXX = " << compilerName() << "\n";
+    out << "CXXFLAGS = " << options << "\n";
+    out << "OBJECTS =";
+    for (const std::string& source : program.sources) {
+        out << " " << baseName(objectPath(source));
+    }
+    out << "\n\n" << executable << ": $(OBJECTS)\n";
+    out << "\t$(CXX) $(CXXFLAGS) $(OBJECTS) -o $@\n\n";
+    out << "%.o: %.cpp " << header << "\n";
+    out << "\t$(CXX) $(CXXFLAGS) -c $< -o $@\n\n";
+    out << "clean:\n";
+    out << "\trm -f $(OBJECTS) " << executable << "\n\n";
+    out << ".PHONY: clean\n";
+    out.writeTo(program.makefile);
+
+    out.clear();
+    out << "# Builds " << executable << ", run \"ninja -f " << baseName(program.ninjaFile) << "\" in this directory\n";
+    out << "cxxflags = " << options << "\n\n";
+    out << "rule cxx\n";
+    out << "  command = " << compilerName() << " $cxxflags -c $in -o $out\n";
+    out << "  description = CXX $out\n\n";
+    out << "rule link\n";
+    out << "  command = " << compilerName() << " $cxxflags $in -o $out\n";
+    out << "  description = LINK $out\n\n";
+    for (const std::string& source : program.sources) {
+        out << "build " << baseName(objectPath(source)) << ": cxx " << baseName(source) << " | " << header << "\n";
+    }
+    out << "build " << executable << ": link";
+    for (const std::string& source : program.sources) {
+        out << " " << baseName(objectPath(source));
+    }
+    out << "\n\ndefault " << executable << "\n";
+    out.writeTo(program.ninjaFile);
+}
 
 /**
- * @brief Compiles the generated C++ code
+ * @brief Generates C++ code from the internal representation of a Moore Machine
+ *
+ * The program is split into a header every source includes, the runtime shared by all
+ * machines, the definition of the machine with main, and units of guards and output
+ * actions of at most unitSize transitions and states each, so the sources can be
+ * compiled in parallel. Every source is reported as soon as it is written, so its
+ * compilation can start while the rest is being generated.
  *
- * @param sourcePath Path of the generated C++ file
- * @param outputPath Path of the compiled executable
+ * @param machine Internal representation of a Moore Machine
+ * @param filename Path for the generated code without an extension
+ * @param sourceWritten Called with the path of each source once it is written, may be empty
+ * @param unitSize Number of transitions and states in a unit
+ * @return Paths of the generated files
+ * @throws std::runtime_error If a file cannot be written or an action cannot be translated
  */
-void CodeGenarator::compileGeneratedCode(const QString& sourcePath, const QString& outputPath) {
-    QProcess compiler;
-    // Select compiler according to the platform
+GeneratedProgram CodeGenarator::generateCode(const MooreMachine &machine, const std::string &filename,
+                                             const std::function<void(const std::string&)>& sourceWritten,
+                                             size_t unitSize) {
+    unitSize = std::max<size_t>(unitSize, 1);
+    GeneratedProgram program;
+    program.header = filename + ".h";
+    program.makefile = filename + ".mk";
+    program.ninjaFile = filename + ".ninja";
+
+    // Set executable name according to the target platform
 #ifdef _WIN32
-    QString compilerPath = "g++.exe";
+    program.executable = filename + ".exe";
 #else
-    QString compilerPath = "g++";
+    program.executable = filename;
 #endif
 
-    QStringList args;
-    args << sourcePath << "-std=c++17" << "-o" << outputPath;
+    auto written = [&](const std::string& path) {
+        program.sources.push_back(path);
+        if (sourceWritten) {
+            sourceWritten(path);
+        }
+    };
 
-    compiler.start(compilerPath, args);
-    compiler.waitForFinished();
+    // Save text form of generated automaton
+    if (!MachineFileHandler::saveToFile(machine, filename + ".fsm")) {
+        throw std::runtime_error("Cannot save " + filename + ".fsm");
+    }
 
-    QByteArray out = compiler.readAllStandardOutput();
-    QByteArray err = compiler.readAllStandardError();
-    int exitCode = compiler.exitCode();
+    // All states, the initial one first, numbered in the order they are created
+    std::vector<State*> states;
+    State* initialState = const_cast<MooreMachine&>(machine).getInitialState();
+    if (initialState) {
+        states.push_back(initialState);
+    }
+    for (State* state : const_cast<MooreMachine&>(machine).getAllStates()) {
+        if (state != initialState) {
+            states.push_back(state);
+        }
+    }
 
-    if (exitCode == 0) {
-        qDebug() << "Compilation successful.";
-    } else {
-        qWarning() << "Compilation failed:" << err;
+    // All transitions, each one gets its own guard
+    std::vector<std::pair<State*, Transition*>> transitionSources;
+    std::vector<Transition*> transitions;
+    for (State* sourceState : states) {
+        for (Transition* transition : const_cast<MooreMachine&>(machine).getTransitionsFromState(sourceState->getId())) {
+            if (const_cast<MooreMachine&>(machine).getState(transition->getTargetId())) {
+                transitionSources.emplace_back(sourceState, transition);
+                transitions.push_back(transition);
+            }
+        }
     }
+    size_t units = std::max<size_t>((std::max(states.size(), transitions.size()) + unitSize - 1) / unitSize, 1);
+
+    ActionTranslator translator(machine, "variableType", true);
+    std::string include = "#include \"" + baseName(program.header) + "\"\n";
+    CodeBuffer out;
+
+    // Declarations and the helpers the guards and actions call
+    out << generatedFileHeader << '\n';
+    out << translator.helperFunctions() << '\n';
+    out << "#endif //GENERATED_AUTOMATON_H\n";
+    out.writeTo(program.header);
+
+    // Runtime shared by all machines, the biggest source, so it is compiled first
+    out.clear();
+    out << include;
+    out << "#define FSM_NAME " << ActionTranslator::literal(machine.getName()) << '\n';
+    out << "#define FSM_DEFINITION_PATH " << ActionTranslator::literal(filename + ".fsm") << '\n';
+    out << networkFunctions << '\n';
+    out << automatonEngineFunctions;
+    out.writeTo(filename + "_runtime.cpp");
+    written(filename + "_runtime.cpp");
+
+    // Write the definition every instance is built from
+    out.clear();
+    out << include << '\n';
+    out << "static void defineAutomaton(AutomatonEngine& ae){\n";
+
+    // Generate representation of all inputs
+    for (const auto& pointer : machine.getInputPointers()) {
+        out << "\tae.createInputPointer(" << ActionTranslator::literal(pointer) << ");\n";
+    }
+
+    // Generate representation of all outputs
+    for (const auto& pointer : machine.getOutputPointers()) {
+        out << "\tae.createOutputPointer(" << ActionTranslator::literal(pointer) << ");\n";
+    }
+
+    // Generate representation of all variables
+    for (const auto& varPair : machine.getVariables()) {
+        const auto &var = varPair.second;
+        out << "\tae.createVariable(\"" << var.getName() << "\", " << var.getValueString() << ");\n";
+    }
+
+    for (size_t i = 0; i < states.size(); i++) {
+        out << "\tae.createState(" << ActionTranslator::literal(states[i]->getName()) << ", " << i << ");\n";
+    }
+    for (size_t i = 0; i < transitionSources.size(); i++) {
+        State* targetState = const_cast<MooreMachine&>(machine).getState(transitionSources[i].second->getTargetId());
+        out << "\tae.createTransition(" << ActionTranslator::literal(transitionSources[i].first->getName()) << ", "
+            << ActionTranslator::literal(targetState->getName()) << ", " << i << ", "
+            << std::max(0, transitionSources[i].second->getTimeout()) << ");\n";
+    }
+    out << "}\n\n";
+
+    // Options select the number of instances, worker threads and the port
+    out << "int main(int argc, char* argv[]){\n";
+    out << "\treturn runAutomata(argc, argv, defineAutomaton);\n";
+    out << "}\n\n";
+    generateDispatchers(out, units, unitSize);
+    out.writeTo(filename + ".cpp");
+    written(filename + ".cpp");
+
+    // Guards and output actions are translated here, the generated program does not parse them
+    for (size_t unit = 0; unit < units; unit++) {
+        std::string path = filename + "_actions_" + std::to_string(unit) + ".cpp";
+        out.clear();
+        out << include << '\n';
+        generateGuards(out, translator, transitions, unit, unitSize);
+        out << '\n';
+        generateOutputActions(out, translator, states, unit, unitSize);
+        out.writeTo(path);
+        written(path);
+    }
+
+    writeBuildFiles(out, program);
+    return program;
 }
@@ -3,6 +3,7 @@
 */
 
 #include "../headers/comm_bridge.h"
+#include <QDebug>
 
 /**
  * @brief Constructor
@@ -19,41 +20,67 @@ CommBridge::CommBridge(QObject *parent) : QObject(parent), sock(new QUdpSocket(t
  * Cleans up class objects
  */
 CommBridge::~CommBridge() {
-    goodbye();
+    goodbye(instance);
     sock->close();
 }
 
 
 /**
- * @brief Sends an UDP datagram to the generated executable automaton
- * @param message Contents of the datagram being sent
+ * @brief Correctly destroys connection between editor and generated executable automaton
+ * @param id ID of the automaton instance to disconnect from
  */
-void CommBridge::goodbye() {
+void CommBridge::goodbye(quint32 id) {
     QUdpSocket* byeSocket = new QUdpSocket(nullptr);
     byeSocket->bind(QHostAddress::LocalHost, 56787);
-    std::string endMsg;
-    endMsg += {static_cast<char>(0x07)};
-    endMsg += "\r\n";
-    QByteArray dgram = QString::fromStdString(endMsg).toUtf8();
-    byeSocket->writeDatagram(dgram, QHostAddress::LocalHost, 56789);
+    WireWriter bye(id, 0);
+    bye.beginRecord(WireProtocol::BYE);
+    bye.endRecord();
+    const std::string& dgram = bye.getData();
+    byeSocket->writeDatagram(dgram.data(), qint64(dgram.size()), QHostAddress::LocalHost, 56789);
 }
 
 /**
- * @brief Send initial hello message to the generated executable automaton
- * @return True if an executable automaton replied within timeout, False otherwise
+ * @brief Selects the automaton instance datagrams are exchanged with
+ * @param id ID of the instance in the running process
  */
-void CommBridge::send(const QString& message) {
-    QByteArray datagram = message.toUtf8();
-    sock->writeDatagram(datagram, QHostAddress::LocalHost, runtimePort);
+void CommBridge::setInstance(quint32 id) {
+    instance = id;
 }
 
 /**
- * @brief Correctly destroys connection between editor and generated executable automaton
+ * @brief Retrieves the automaton instance datagrams are exchanged with
+ * @return ID of the instance
+ */
+quint32 CommBridge::getInstance() const {
+    return instance;
+}
+
+/**
+ * @brief Starts a datagram to the generated executable automaton
+ * @return Writer with the header, the instance and the next sequence number filled in
+ */
+WireWriter CommBridge::createDatagram() {
+    return WireWriter(instance, sequence++);
+}
+
+/**
+ * @brief Sends an UDP datagram to the generated executable automaton
+ * @param datagram Datagram built by a WireWriter
+ */
+void CommBridge::send(const WireWriter& datagram) {
+    const std::string& data = datagram.getData();
+    sock->writeDatagram(data.data(), qint64(data.size()), QHostAddress::LocalHost, runtimePort);
+}
+
+/**
+ * @brief Send initial hello message to the generated executable automaton
+ * @return True if an executable automaton replied within timeout, False otherwise
  */
 bool CommBridge::establishConnection() {
-    std::string strMsg{static_cast<char>(0x00)};
-    strMsg += "\r\n";
-    send(QString::fromStdString(strMsg));
+    WireWriter hello = createDatagram();
+    hello.beginRecord(WireProtocol::HELLO);
+    hello.endRecord();
+    send(hello);
     QEventLoop loop;
     QTimer timeout;
     bool connected = false;
@@ -79,13 +106,27 @@ bool CommBridge::establishConnection() {
  */
 void CommBridge::onReadyRead() {
     while (sock->hasPendingDatagrams()) {
-        QByteArray buffer;
-        buffer.resize(int(sock->pendingDatagramSize()));
-        sock->readDatagram(buffer.data(), buffer.size());
-        QString msg = QString::fromUtf8(buffer);
-        if (msg.toStdString().at(0) == static_cast<char>(0x06)){
-            emit successfulConnection();
+        std::string datagram;
+        datagram.resize(size_t(sock->pendingDatagramSize()));
+        qint64 received = sock->readDatagram(datagram.data(), qint64(datagram.size()));
+        if (received < 0) {
+            continue;
+        }
+        datagram.resize(size_t(received));
+        try {
+            WireReader reader(datagram);
+            // Other instances of the same process share the port
+            if (reader.getInstance() != instance) {
+                continue;
+            }
+            WireProtocol::RecordType type;
+            if (reader.nextRecord(type) && type == WireProtocol::SNAPSHOT) {
+                emit successfulConnection();
+            }
+        } catch (const std::exception& e) {
+            qWarning() << "Ignoring datagram:" << e.what();
+            continue;
         }
-        emit eventReceived(msg);
+        emit eventReceived(datagram);
     }
 }
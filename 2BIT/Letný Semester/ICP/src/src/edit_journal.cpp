@@ -0,0 +1,388 @@
+/**
+ * @file edit_journal.cpp
+ * @brief Implementation of the EditJournal class
+ * @author Hugo Bohácsek (xbohach00)
+ */
+
+#include "../headers/edit_journal.h"
+#include <algorithm>
+#include <utility>
+
+/**
+ * @brief Gets the number of elements the command holds
+ *
+ * @return Number of states, transitions and variables recorded
+ */
+size_t EditCommand::getWeight() const {
+    return (state ? 1 : 0) + transitions.size() + (variable ? 1 : 0) + (replaced ? 1 : 0);
+}
+
+/**
+ * @brief Constructor
+ *
+ * @param capacity Number of states, transitions and variables the history may hold
+ */
+EditJournal::EditJournal(size_t capacity) : done(0), capacity(capacity), weight(0) {}
+
+/**
+ * @brief Adds a state, making it the initial one if it is marked so
+ *
+ * @param machine Machine to edit
+ * @param state State to add
+ * @return True if the state was added
+ */
+bool EditJournal::addState(MooreMachine& machine, const State& state) {
+    EditCommand command{EditCommand::ADD_STATE, std::make_shared<const State>(state), {}, nullptr, nullptr, "", ""};
+    // Only a new initial state takes the mark from another one, which undo gives back
+    if (state.getIsInitial()) {
+        if (State* initial = machine.getInitialState()) {
+            command.previousInitial = initial->getId();
+        }
+    }
+    return record(machine, std::move(command));
+}
+
+/**
+ * @brief Removes a state with its transitions
+ *
+ * The transitions are recorded with their positions, ordered so that adding
+ * them back one after another puts each at its old position.
+ *
+ * @param machine Machine to edit
+ * @param stateId ID of the state
+ * @return True if the state was removed
+ */
+bool EditJournal::removeState(MooreMachine& machine, const std::string& stateId) {
+    State* state = machine.getState(stateId);
+    if (!state) {
+        return false;
+    }
+
+    EditCommand command{EditCommand::REMOVE_STATE, std::make_shared<const State>(*state), {}, nullptr, nullptr, "", ""};
+    for (const auto& incident : machine.getIncidentTransitions(stateId)) {
+        command.transitions.push_back({std::make_shared<const Transition>(*incident.first), incident.second});
+    }
+    std::stable_sort(command.transitions.begin(), command.transitions.end(),
+                     [](const EditCommand::PlacedTransition& a, const EditCommand::PlacedTransition& b) {
+        return a.position < b.position;
+    });
+    return record(machine, std::move(command));
+}
+
+/**
+ * @brief Marks a state as the initial one
+ *
+ * @param machine Machine to edit
+ * @param stateId ID of the state
+ * @return True if the state was marked
+ */
+bool EditJournal::setInitialState(MooreMachine& machine, const std::string& stateId) {
+    EditCommand command{EditCommand::SET_INITIAL, nullptr, {}, nullptr, nullptr, "", stateId};
+    if (State* initial = machine.getInitialState()) {
+        command.previousInitial = initial->getId();
+    }
+    return record(machine, std::move(command));
+}
+
+/**
+ * @brief Adds a transition after the others leaving its source state
+ *
+ * @param machine Machine to edit
+ * @param transition Transition to add
+ * @return True if the transition was added
+ */
+bool EditJournal::addTransition(MooreMachine& machine, const Transition& transition) {
+    EditCommand command{EditCommand::ADD_TRANSITION, nullptr, {}, nullptr, nullptr, "", ""};
+    command.transitions.push_back({std::make_shared<const Transition>(transition), SIZE_MAX});
+    return record(machine, std::move(command));
+}
+
+/**
+ * @brief Removes a transition
+ *
+ * @param machine Machine to edit
+ * @param transitionId ID of the transition
+ * @return True if the transition was removed
+ */
+bool EditJournal::removeTransition(MooreMachine& machine, const std::string& transitionId) {
+    Transition* transition = machine.getTransition(transitionId);
+    if (!transition) {
+        return false;
+    }
+
+    EditCommand command{EditCommand::REMOVE_TRANSITION, nullptr, {}, nullptr, nullptr, "", ""};
+    command.transitions.push_back({std::make_shared<const Transition>(*transition),
+                                   machine.getOutgoingPosition(transitionId)});
+    return record(machine, std::move(command));
+}
+
+/**
+ * @brief Replaces a transition with a changed copy, keeping its position
+ *
+ * @param machine Machine to edit
+ * @param transition Changed transition, with the same ID, source and target
+ * @return True if the transition was replaced
+ */
+bool EditJournal::replaceTransition(MooreMachine& machine, const Transition& transition) {
+    Transition* old = machine.getTransition(transition.getId());
+    if (!old || old->getSourceId() != transition.getSourceId() || old->getTargetId() != transition.getTargetId()) {
+        return false;
+    }
+
+    EditCommand command{EditCommand::REPLACE_TRANSITION, nullptr, {}, nullptr, nullptr, "", ""};
+    command.transitions.push_back({std::make_shared<const Transition>(*old), SIZE_MAX});
+    command.transitions.push_back({std::make_shared<const Transition>(transition), SIZE_MAX});
+    return record(machine, std::move(command));
+}
+
+/**
+ * @brief Adds a variable, replacing one with the same name
+ *
+ * @param machine Machine to edit
+ * @param type Type name, "int", "float" or "string"
+ * @param name Name of the variable
+ * @param value Initial value
+ * @return True if the variable was added
+ */
+bool EditJournal::addVariable(MooreMachine& machine, const std::string& type, const std::string& name,
+                              const std::string& value) {
+    EditCommand command{EditCommand::ADD_VARIABLE, nullptr, {}, nullptr, nullptr, "", ""};
+    command.variable = std::make_shared<const EditCommand::Variable>(EditCommand::Variable{type, name, value});
+    if (MachineVariable* existing = machine.getVariable(name)) {
+        command.replaced = std::make_shared<const EditCommand::Variable>(
+            EditCommand::Variable{typeToString(existing->getType()), name, machine.getInitialVariableValue(name)});
+    }
+    return record(machine, std::move(command));
+}
+
+/**
+ * @brief Removes a variable
+ *
+ * @param machine Machine to edit
+ * @param name Name of the variable
+ * @return True if the variable was removed
+ */
+bool EditJournal::removeVariable(MooreMachine& machine, const std::string& name) {
+    MachineVariable* variable = machine.getVariable(name);
+    if (!variable) {
+        return false;
+    }
+
+    EditCommand command{EditCommand::REMOVE_VARIABLE, nullptr, {}, nullptr, nullptr, "", ""};
+    command.variable = std::make_shared<const EditCommand::Variable>(
+        EditCommand::Variable{typeToString(variable->getType()), name, machine.getInitialVariableValue(name)});
+    return record(machine, std::move(command));
+}
+
+/**
+ * @brief Reverts the last edit
+ *
+ * @param machine Machine the edits were made to
+ * @return The reverted command, nullptr if there is nothing to undo
+ */
+const EditCommand* EditJournal::undo(MooreMachine& machine) {
+    if (done == 0) {
+        return nullptr;
+    }
+    done--;
+    revert(machine, commands[done]);
+    return &commands[done];
+}
+
+/**
+ * @brief Makes the last undone edit again
+ *
+ * @param machine Machine the edits were made to
+ * @return The repeated command, nullptr if there is nothing to redo
+ */
+const EditCommand* EditJournal::redo(MooreMachine& machine) {
+    if (done == commands.size()) {
+        return nullptr;
+    }
+    if (!apply(machine, commands[done])) {
+        // The machine was changed behind the journal's back, the rest cannot be redone either
+        while (commands.size() > done) {
+            weight -= commands.back().getWeight();
+            commands.pop_back();
+        }
+        return nullptr;
+    }
+    return &commands[done++];
+}
+
+/**
+ * @brief Checks whether there is an edit to undo
+ *
+ * @return True if undo() would revert something
+ */
+bool EditJournal::canUndo() const {
+    return done > 0;
+}
+
+/**
+ * @brief Checks whether there is an edit to redo
+ *
+ * @return True if redo() would repeat something
+ */
+bool EditJournal::canRedo() const {
+    return done < commands.size();
+}
+
+/**
+ * @brief Forgets the history, used when the machine is replaced
+ */
+void EditJournal::clear() {
+    commands.clear();
+    done = 0;
+    weight = 0;
+}
+
+/**
+ * @brief Gets the number of elements the history holds
+ *
+ * @return Number of states, transitions and variables recorded
+ */
+size_t EditJournal::getWeight() const {
+    return weight;
+}
+
+/**
+ * @brief Makes the edit of a command
+ *
+ * @param machine Machine to edit
+ * @param command Command to make
+ * @return True if the machine accepted the edit
+ */
+bool EditJournal::apply(MooreMachine& machine, const EditCommand& command) {
+    switch (command.kind) {
+        case EditCommand::ADD_STATE:
+            if (!machine.addState(*command.state)) {
+                return false;
+            }
+            if (command.state->getIsInitial()) {
+                machine.setInitialState(command.state->getId());
+            }
+            return true;
+        case EditCommand::REMOVE_STATE:
+            return machine.removeState(command.state->getId());
+        case EditCommand::ADD_TRANSITION:
+            return machine.addTransition(*command.transitions[0].transition);
+        case EditCommand::REMOVE_TRANSITION:
+            return machine.removeTransition(command.transitions[0].transition->getId());
+        case EditCommand::REPLACE_TRANSITION:
+            return swapTransition(machine, *command.transitions[1].transition);
+        case EditCommand::ADD_VARIABLE:
+            return machine.addVariable(command.variable->type, command.variable->name, command.variable->value);
+        case EditCommand::REMOVE_VARIABLE:
+            return machine.removeVariable(command.variable->name);
+        case EditCommand::SET_INITIAL:
+            return machine.setInitialState(command.initial);
+    }
+    return false;
+}
+
+/**
+ * @brief Reverts the edit of a command
+ *
+ * @param machine Machine to edit
+ * @param command Command to revert, the last one made
+ */
+void EditJournal::revert(MooreMachine& machine, const EditCommand& command) {
+    switch (command.kind) {
+        case EditCommand::ADD_STATE:
+            machine.removeState(command.state->getId());
+            if (!command.previousInitial.empty()) {
+                machine.setInitialState(command.previousInitial);
+            } else if (command.state->getIsInitial()) {
+                // There was no initial state before, removing the added one passed the mark on
+                if (State* promoted = machine.getInitialState()) {
+                    promoted->setIsInitial(false);
+                }
+            }
+            break;
+        case EditCommand::REMOVE_STATE:
+            machine.addState(*command.state);
+            for (const EditCommand::PlacedTransition& placed : command.transitions) {
+                machine.addTransition(*placed.transition, placed.position);
+            }
+            // Removing the initial state passed the mark on to another one
+            if (command.state->getIsInitial()) {
+                machine.setInitialState(command.state->getId());
+            }
+            break;
+        case EditCommand::ADD_TRANSITION:
+            machine.removeTransition(command.transitions[0].transition->getId());
+            break;
+        case EditCommand::REMOVE_TRANSITION:
+            machine.addTransition(*command.transitions[0].transition, command.transitions[0].position);
+            break;
+        case EditCommand::REPLACE_TRANSITION:
+            swapTransition(machine, *command.transitions[0].transition);
+            break;
+        case EditCommand::ADD_VARIABLE:
+            if (command.replaced) {
+                machine.addVariable(command.replaced->type, command.replaced->name, command.replaced->value);
+            } else {
+                machine.removeVariable(command.variable->name);
+            }
+            break;
+        case EditCommand::REMOVE_VARIABLE:
+            machine.addVariable(command.variable->type, command.variable->name, command.variable->value);
+            break;
+        case EditCommand::SET_INITIAL:
+            if (!command.previousInitial.empty()) {
+                machine.setInitialState(command.previousInitial);
+            } else if (State* state = machine.getState(command.initial)) {
+                // There was no initial state before
+                state->setIsInitial(false);
+            }
+            break;
+    }
+}
+
+/**
+ * @brief Puts a transition in place of the one with the same ID, keeping its position
+ *
+ * The old transition is removed and the new one added, so the machine registers
+ * its input symbols and pointers. The freed slot is the one the new transition takes.
+ *
+ * @param machine Machine to edit
+ * @param transition Transition to put in
+ * @return True if the transition was replaced
+ */
+bool EditJournal::swapTransition(MooreMachine& machine, const Transition& transition) {
+    size_t position = machine.getOutgoingPosition(transition.getId());
+    if (position == SIZE_MAX || !machine.removeTransition(transition.getId())) {
+        return false;
+    }
+    return machine.addTransition(transition, position);
+}
+
+/**
+ * @brief Makes a new edit and records it, dropping the commands undone before
+ *
+ * @param machine Machine to edit
+ * @param command Command to make
+ * @return True if the machine accepted the edit
+ */
+bool EditJournal::record(MooreMachine& machine, EditCommand command) {
+    if (!apply(machine, command)) {
+        return false;
+    }
+
+    while (commands.size() > done) {
+        weight -= commands.back().getWeight();
+        commands.pop_back();
+    }
+    weight += command.getWeight();
+    commands.push_back(std::move(command));
+    done++;
+
+    // The last command is kept even when it alone is over the bound
+    while (weight > capacity && commands.size() > 1) {
+        weight -= commands.front().getWeight();
+        commands.pop_front();
+        done--;
+    }
+    return true;
+}
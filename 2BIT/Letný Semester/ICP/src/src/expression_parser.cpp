@@ -5,6 +5,7 @@
  */
 
 #include "../headers/expression_parser.h"
+#include "../headers/string_utils.h"
 #include <sstream>
 #include <stack>
 #include <cctype>
@@ -138,24 +139,15 @@ std::pair<std::string, std::string> ExpressionParser::parseOutput(
     const std::unordered_map<std::string, MachineVariable>& variables,
     int elapsedTime) {
     
-    // Find "output" and "to" keywords
-    size_t outputPos = expression.find("output ");
-    size_t toPos = expression.find(" to ");
-    
-    if (outputPos == std::string::npos || toPos == std::string::npos) {
-        throw std::runtime_error("Invalid output expression: " + expression);
+    CompiledOutput output = compileOutputExpression(expression);
+    if (output.action == OutputAction::INVALID) {
+        throw std::runtime_error(output.source);
     }
     
-    // Extract the expression between "output" and "to"
-    std::string valueExpr = expression.substr(outputPos + 7, toPos - (outputPos + 7));
-    
-    // Extract the output pointer after "to"
-    std::string outputPtr = expression.substr(toPos + 4);
-    
     // Evaluate the expression
-    MachineVariable result = evaluateExpression(valueExpr, variables, elapsedTime);
+    const MachineVariable& result = output.program.evaluate(variables, elapsedTime);
     
-    return {outputPtr, result.getValueString()};
+    return {output.target, result.getValueString()};
 }
 
 /**
@@ -207,68 +199,166 @@ MachineVariable ExpressionParser::evaluateExpression(
     const std::unordered_map<std::string, MachineVariable>& variables,
     int elapsedTime) {
     
-    // Simple expression evaluation without precedence
+    ExpressionProgram program = compile(expression);
+    return program.evaluate(variables, elapsedTime);
+}
+
+/**
+ * @brief Compiles an arithmetic expression into a reusable program
+ * 
+ * Expressions have no precedence, each value is combined with the result
+ * so far using the last operator seen before it.
+ * 
+ * @param expression The arithmetic expression (e.g., "var + 5 * 3 - elapsed")
+ * @return The compiled program
+ */
+ExpressionProgram ExpressionParser::compile(const std::string& expression) {
     tokens = tokenize(expression);
     position = 0;
     
-    MachineVariable result;
-    MachineVariable currentValue;
-    std::string currentOp = "+"; // Default operation is addition (for first term)
+    ExpressionProgram program;
+    bool first = true;
+    char currentOp = '+'; // Default operation is addition (for first term)
     
     while (position < tokens.size() && tokens[position].type != TokenType::END) {
-        Token token = tokens[position++];
+        const Token& token = tokens[position++];
+        OperandKind kind;
+        int index;
         
         switch (token.type) {
             case TokenType::VARIABLE: {
-                // Replace variable with its value
-                auto it = variables.find(token.value);
-                if (it != variables.end()) {
-                    currentValue = it->second;
-                } else {
-                    throw std::runtime_error("Unknown variable: " + token.value);
-                }
+                kind = OperandKind::VARIABLE;
+                index = program.addSlot(token.value);
                 break;
             }
             case TokenType::NUMBER: {
                 // Parse number
                 try {
                     if (token.value.find('.') != std::string::npos) {
-                        currentValue = MachineVariable("float", "temp", token.value);
+                        index = program.addConstant(MachineVariable("float", "temp", token.value));
                     } else {
-                        currentValue = MachineVariable("int", "temp", token.value);
+                        index = program.addConstant(MachineVariable("int", "temp", token.value));
                     }
+                    kind = OperandKind::CONSTANT;
                 } catch (const std::exception& e) {
-                    throw std::runtime_error("Invalid number: " + token.value);
+                    program.append(OpCode::FAIL, OperandKind::NONE, currentOp,
+                                 program.addError("Invalid number: " + token.value));
+                    return program;
                 }
                 break;
             }
             case TokenType::SPECIAL_KEYWORD: {
                 // Handle kw "elapsed"
-                if (token.value == "elapsed") {
-                    currentValue = MachineVariable("int", "elapsed", std::to_string(elapsedTime));
-                } else {
-                    throw std::runtime_error("Unknown keyword: " + token.value);
-                }
+                kind = OperandKind::ELAPSED;
+                index = 0;
                 break;
             }
             case TokenType::OPERATOR: {
                 // Store operator for next value
-                currentOp = token.value;
+                currentOp = token.value[0];
                 continue; // Skip to next token
             }
             default:
-                throw std::runtime_error("Unexpected token: " + token.value);
+                program.append(OpCode::FAIL, OperandKind::NONE, currentOp,
+                             program.addError("Unexpected token: " + token.value));
+                return program;
         }
         
         // First value or apply operation
-        if (result.getType() == VariableType::UNKNOWN) {
-            result = currentValue;
-        } else {
-            result = result.performOperation(currentOp, currentValue);
+        program.append(first ? OpCode::LOAD : OpCode::APPLY, kind, currentOp, index);
+        first = false;
+    }
+    
+    return program;
+}
+
+/**
+ * @brief Compiles an output expression
+ * @param expression The output expression (e.g., "output var + 5 to output1")
+ * @return OUTPUT_EXPRESSION statement, or INVALID if the format is wrong
+ */
+CompiledOutput ExpressionParser::compileOutputExpression(const std::string& expression) {
+    CompiledOutput output;
+    
+    // Find "output" and "to" keywords
+    size_t outputPos = expression.find("output ");
+    size_t toPos = expression.find(" to ");
+    
+    if (outputPos == std::string::npos || toPos == std::string::npos) {
+        output.action = OutputAction::INVALID;
+        output.source = "Invalid output expression: " + expression;
+        return output;
+    }
+    
+    // Extract the expression between "output" and "to", and the output pointer after "to"
+    output.action = OutputAction::OUTPUT_EXPRESSION;
+    output.program = compile(expression.substr(outputPos + 7, toPos - (outputPos + 7)));
+    output.target = expression.substr(toPos + 4);
+    return output;
+}
+
+/**
+ * @brief Compiles an output statement of a state
+ * 
+ * @param output The output statement
+ * @return The compiled statement
+ */
+CompiledOutput ExpressionParser::compileOutput(const OutputCondition& output) {
+    CompiledOutput compiled;
+    
+    // Handle variable assignments
+    if (output.value.find('=') != std::string::npos && output.target == "expression") {
+        size_t equalsPos = output.value.find('=');
+        std::string expression = trim(output.value.substr(equalsPos + 1));
+        
+        // Check if this is a "get" expression, format: var = get input_ptr
+        if (expression.find("get ") == 0) {
+            tokens = tokenize(output.value);
+            if (tokens.size() >= 4 && 
+                tokens[0].type == TokenType::VARIABLE &&
+                tokens[1].type == TokenType::EQUALS &&
+                tokens[2].type == TokenType::GET &&
+                tokens[3].type == TokenType::VARIABLE) {
+                compiled.action = OutputAction::ASSIGN_INPUT;
+                compiled.target = tokens[0].value;
+                compiled.source = tokens[3].value;
+            } else {
+                compiled.action = OutputAction::INVALID;
+                compiled.source = "Invalid assignment expression: " + output.value;
+            }
+        }
+        // Otherwise, evaluate as arithmetic expression
+        else {
+            compiled.action = OutputAction::ASSIGN_EXPRESSION;
+            compiled.target = trim(output.value.substr(0, equalsPos));
+            compiled.program = compile(expression);
+        }
+    }
+    // Handle output expressions
+    else if (output.value.find("output ") == 0) {
+        compiled = compileOutputExpression(output.value);
+    }
+    // Regular output
+    else {
+        compiled.action = OutputAction::VALUE;
+        compiled.target = output.target;
+        compiled.source = output.value;
+    }
+    
+    // Format of the condition: if input_ptr is defined, anything else always holds
+    if (output.hasCondition) {
+        tokens = tokenize("if " + output.inputPtr + " is defined");
+        if (tokens.size() >= 4 && 
+            tokens[0].type == TokenType::IF &&
+            tokens[1].type == TokenType::VARIABLE &&
+            tokens[2].type == TokenType::IS &&
+            tokens[3].type == TokenType::DEFINED) {
+            compiled.hasCondition = true;
+            compiled.conditionPtr = tokens[1].value;
         }
     }
     
-    return result;
+    return compiled;
 }
 
 /**
@@ -0,0 +1,227 @@
+/**
+ * @file expression_program.cpp
+ * @brief Implementation of the ExpressionProgram class
+ * @author Hugo Bohácsek (xbohach00)
+ */
+
+#include "../headers/expression_program.h"
+#include <stdexcept>
+
+/**
+ * @brief Default constructor, creates an empty program
+ */
+ExpressionProgram::ExpressionProgram()
+    : boundVariables(nullptr), elapsedValue("int", "elapsed", "0") {}
+
+/**
+ * @brief Adds a literal to the constant pool
+ *
+ * @param constant The literal value
+ * @return Index of the constant
+ */
+int ExpressionProgram::addConstant(const MachineVariable& constant) {
+    constants.push_back(constant);
+    return static_cast<int>(constants.size()) - 1;
+}
+
+/**
+ * @brief Gets the slot of a variable, adding it if it is not referenced yet
+ *
+ * @param name Name of the variable
+ * @return Index of the slot
+ */
+int ExpressionProgram::addSlot(const std::string& name) {
+    for (size_t i = 0; i < slotNames.size(); i++) {
+        if (slotNames[i] == name) {
+            return static_cast<int>(i);
+        }
+    }
+    slotNames.push_back(name);
+    resolved.push_back(nullptr);
+    boundVariables = nullptr;
+    return static_cast<int>(slotNames.size()) - 1;
+}
+
+/**
+ * @brief Adds an error message for a FAIL instruction
+ *
+ * @param message The message to throw
+ * @return Index of the message
+ */
+int ExpressionProgram::addError(const std::string& message) {
+    errors.push_back(message);
+    return static_cast<int>(errors.size()) - 1;
+}
+
+/**
+ * @brief Appends an instruction
+ *
+ * @param op What to do
+ * @param kind Where the operand comes from
+ * @param operation Arithmetic operator for APPLY ('+', '-', '*', '/')
+ * @param index Index of the operand or error message
+ */
+void ExpressionProgram::append(OpCode op, OperandKind kind, char operation, int index) {
+    code.push_back(Instruction{op, kind, operation, index});
+}
+
+/**
+ * @brief Resolves variable slots against a variable map
+ *
+ * @param variables Map of variables available to the expression
+ */
+void ExpressionProgram::bind(const std::unordered_map<std::string, MachineVariable>& variables) {
+    for (size_t i = 0; i < slotNames.size(); i++) {
+        auto it = variables.find(slotNames[i]);
+        resolved[i] = it != variables.end() ? &it->second : nullptr;
+    }
+    boundVariables = &variables;
+}
+
+/**
+ * @brief Forgets resolved slots, forcing a bind on the next run
+ */
+void ExpressionProgram::unbind() {
+    boundVariables = nullptr;
+}
+
+/**
+ * @brief Runs the program
+ *
+ * @param variables Map of variables available to the expression
+ * @param elapsedTime Current elapsed time in milliseconds
+ * @return Result of the evaluation, valid until the next run
+ * @throw std::runtime_error If the expression contains errors
+ */
+const MachineVariable& ExpressionProgram::evaluate(
+    const std::unordered_map<std::string, MachineVariable>& variables,
+    int elapsedTime) {
+
+    static const std::string operators[] = {"+", "-", "*", "/"};
+
+    if (boundVariables != &variables) {
+        bind(variables);
+    }
+
+    // Every non-empty program starts with LOAD, which overwrites the accumulator
+    if (code.empty()) {
+        accumulator = MachineVariable();
+    }
+
+    for (const Instruction& instruction : code) {
+        if (instruction.op == OpCode::FAIL) {
+            throw std::runtime_error(errors[instruction.index]);
+        }
+
+        // Fetch the operand
+        const MachineVariable* operand = nullptr;
+        switch (instruction.kind) {
+            case OperandKind::CONSTANT:
+                operand = &constants[instruction.index];
+                break;
+            case OperandKind::VARIABLE:
+                operand = resolved[instruction.index];
+                if (!operand) {
+                    throw std::runtime_error("Unknown variable: " + slotNames[instruction.index]);
+                }
+                break;
+            case OperandKind::ELAPSED:
+                elapsedValue.setIntValue(elapsedTime);
+                operand = &elapsedValue;
+                break;
+            default:
+                continue;
+        }
+
+        if (instruction.op == OpCode::LOAD) {
+            accumulator = *operand;
+            continue;
+        }
+
+        switch (instruction.operation) {
+            case '+': accumulator.applyOperation(operators[0], *operand); break;
+            case '-': accumulator.applyOperation(operators[1], *operand); break;
+            case '*': accumulator.applyOperation(operators[2], *operand); break;
+            case '/': accumulator.applyOperation(operators[3], *operand); break;
+            default:
+                throw std::runtime_error("Unsupported operation: " + std::string(1, instruction.operation));
+        }
+    }
+
+    return accumulator;
+}
+
+/**
+ * @brief Gets the number of instructions
+ *
+ * @return Length of the program
+ */
+size_t ExpressionProgram::size() const {
+    return code.size();
+}
+
+/**
+ * @brief Gets the instructions, used to translate the program into other languages
+ *
+ * @return Instructions in execution order
+ */
+const std::vector<Instruction>& ExpressionProgram::getInstructions() const {
+    return code;
+}
+
+/**
+ * @brief Gets a literal from the constant pool
+ *
+ * @param index Index of the constant
+ * @return The literal value
+ */
+const MachineVariable& ExpressionProgram::getConstant(int index) const {
+    return constants[index];
+}
+
+/**
+ * @brief Gets the size of the constant pool
+ *
+ * @return Number of literals
+ */
+size_t ExpressionProgram::getConstantCount() const {
+    return constants.size();
+}
+
+/**
+ * @brief Gets the name of the variable referenced by a slot
+ *
+ * @param slot Index of the slot
+ * @return Name of the variable
+ */
+const std::string& ExpressionProgram::getSlotName(int slot) const {
+    return slotNames[slot];
+}
+
+/**
+ * @brief Gets the number of variable slots
+ *
+ * @return Number of referenced variables
+ */
+size_t ExpressionProgram::getSlotCount() const {
+    return slotNames.size();
+}
+
+/**
+ * @brief Gets the message raised by a FAIL instruction
+ *
+ * @param index Index of the message
+ * @return The error message
+ */
+const std::string& ExpressionProgram::getError(int index) const {
+    return errors[index];
+}
+
+/**
+ * @brief Gets the number of error messages
+ *
+ * @return Number of messages
+ */
+size_t ExpressionProgram::getErrorCount() const {
+    return errors.size();
+}
@@ -13,7 +13,7 @@
  * 
  * @param parent Parent QObject, used for memory management
  */
-FSMBridge::FSMBridge(QObject *parent) : QObject(parent), machine(nullptr), simulator(nullptr), connector(nullptr), communicationsBridge(new CommBridge(this)), machineConnected(false) {
+FSMBridge::FSMBridge(QObject *parent) : QObject(parent), machine(nullptr), simulator(nullptr), connector(nullptr), communicationsBridge(new CommBridge(this)), machineConnected(false), traceWriter(nullptr) {
 }
 
 /**
@@ -22,6 +22,7 @@ FSMBridge::FSMBridge(QObject *parent) : QObject(parent), machine(nullptr), simul
  * Cleans up the machine and simulator objects
  */
 FSMBridge::~FSMBridge() {
+    stopRecording();
     delete simulator;
     delete machine;
     delete connector;
@@ -49,6 +50,7 @@ void FSMBridge::createNewMachine(const QString &name) {
 
     // only creates an placeholder before new state is created, the graphic scene is not defined here so its not visible
     addState("__dummy", false, false, 0, 0);
+    journal.clear();
 
     // Create a simulator for the machine
     simulator = new MachineSimulator(machine);
@@ -72,6 +74,7 @@ bool FSMBridge::loadMachineFromFile(const QString &filePath) {
         delete machine;
         
         machine = new MooreMachine(loadedMachine);
+        journal.clear();
 
         // Ensure there's an initial state
         State* initialState = machine->getInitialState();
@@ -90,23 +93,36 @@ bool FSMBridge::loadMachineFromFile(const QString &filePath) {
 
         simulator = new MachineSimulator(machine);
         
+        loadError.clear();
         return true;
     } catch (const std::exception &e) {
+        loadError = QString::fromStdString(e.what());
         return false;
     }
 }
 
+/**
+ * @brief Gets why the last load failed
+ * @return Error message with the line and column of a format error, empty after a successful load
+ */
+QString FSMBridge::getLoadError() const {
+    return loadError;
+}
+
 /**
  * @brief Connects to a running machine
  *
+ * @param instance ID of the automaton instance in the running process
  * @return True if connecting succeeded, false otherwise
  */
-bool FSMBridge::connectToRunningMachine() {
+bool FSMBridge::connectToRunningMachine(quint32 instance) {
     delete connector;
     machineConnected = true;
+    communicationsBridge.setInstance(instance);
     connector = new MachineConnector(machine, &communicationsBridge, this);
-    connect(&communicationsBridge, &CommBridge::eventReceived, [this](const QString& msg){
-        connector->handleReceivedMessage(msg);
+    connector->setTraceWriter(traceWriter);
+    connect(&communicationsBridge, &CommBridge::eventReceived, [this](const std::string& datagram){
+        connector->handleReceivedMessage(datagram);
     });
     if (!communicationsBridge.establishConnection()){
         return false;
@@ -119,7 +135,50 @@ bool FSMBridge::connectToRunningMachine() {
  */
 void FSMBridge::disconnectFromRunningMachine(){
     machineConnected = false;
-    communicationsBridge.goodbye();
+    communicationsBridge.goodbye(communicationsBridge.getInstance());
+}
+
+/**
+ * @brief Starts recording the simulation or the connected machine into a trace file
+ *
+ * @param filePath Path of the trace file
+ * @return True if recording started, false if the file could not be created
+ */
+bool FSMBridge::startRecording(const QString &filePath) {
+    stopRecording();
+    try {
+        traceWriter = new TraceWriter(filePath.toStdString());
+    } catch (const std::exception &e) {
+        qWarning() << "Could not start recording:" << e.what();
+        return false;
+    }
+
+    // A connected machine is recorded as its changes arrive
+    if (machineConnected && connector) {
+        connector->setTraceWriter(traceWriter);
+    } else if (simulator) {
+        traceWriter->recordSync(machine->getClock()->now(), *simulator, *machine);
+    }
+    return true;
+}
+
+/**
+ * @brief Stops recording and closes the trace file
+ */
+void FSMBridge::stopRecording() {
+    if (connector) {
+        connector->setTraceWriter(nullptr);
+    }
+    delete traceWriter;
+    traceWriter = nullptr;
+}
+
+/**
+ * @brief Checks whether a trace is being recorded
+ * @return True while recording
+ */
+bool FSMBridge::isRecording() const {
+    return traceWriter != nullptr;
 }
 
 /**
@@ -141,21 +200,19 @@ bool FSMBridge::saveMachineToFile(const QString &filePath) {
 }
 
 /**
- * @brief Saves the generated code of the current machine to a file
+ * @brief Prepares generating and compiling the code of the current machine
  *
- * @param filePath Path to the file where the code will be saved
- * @return True if saving succeeded, false otherwise
+ * The job is not started, so its signals can be connected first. It works
+ * on a copy of the machine and belongs to the bridge.
+ *
+ * @param filePath Path for the generated code without an extension
+ * @return The export job, or nullptr if there is no machine
  */
-bool FSMBridge::saveCodeToFile(const QString &filePath) {
+CodeExportJob* FSMBridge::exportCode(const QString &filePath) {
     if (!machine) {
-        return false;
-    }
-
-    try {
-        return CodeGenarator::generateCode(*machine, filePath.toStdString());
-    } catch (const std::exception &e) {
-        return false;
+        return nullptr;
     }
+    return new CodeExportJob(*machine, filePath, this);
 }
 
 /**
@@ -189,13 +246,8 @@ QString FSMBridge::addState(const QString &name, bool isInitial, bool isFinal, i
         state.addOutput(outputCondition);
     }
     
-    // Add the state to the machine
-    if (machine->addState(state)) {
-        // If this is the initial state, set it as such
-        if (isInitial) {
-            machine->setInitialState(stateId);
-        }
-        
+    // Add the state to the machine, the journal also makes it the initial one if it is marked so
+    if (journal.addState(*machine, state)) {
         return QString::fromStdString(stateId);
     }
     
@@ -213,7 +265,7 @@ bool FSMBridge::removeState(const QString &stateId) {
         return false;
     }
     
-    return machine->removeState(stateId.toStdString());
+    return journal.removeState(*machine, stateId.toStdString());
 }
 
 /**
@@ -227,7 +279,7 @@ bool FSMBridge::setInitialState(const QString &stateId) {
         return false;
     }
     
-    return machine->setInitialState(stateId.toStdString());
+    return journal.setInitialState(*machine, stateId.toStdString());
 }
 
 /**
@@ -270,7 +322,7 @@ QString FSMBridge::addTransition(const QString &sourceId, const QString &targetI
     }
     
     // Add the transition to the machine
-    if (machine->addTransition(transition)) {
+    if (journal.addTransition(*machine, transition)) {
         return QString::fromStdString(transitionId);
     }
     
@@ -288,7 +340,7 @@ bool FSMBridge::removeTransition(const QString &transitionId) {
         return false;
     }
     
-    return machine->removeTransition(transitionId.toStdString());
+    return journal.removeTransition(*machine, transitionId.toStdString());
 }
 
 /**
@@ -297,6 +349,11 @@ bool FSMBridge::removeTransition(const QString &transitionId) {
 void FSMBridge::resetSimulation() {
     if (simulator) {
         simulator->reset();
+        if (traceWriter && !machineConnected) {
+            auto now = machine->getClock()->now();
+            traceWriter->recordReset(now);
+            traceWriter->recordChanges(now, *simulator, *machine);
+        }
     }
 }
 
@@ -311,7 +368,15 @@ QString FSMBridge::processInput(const QString &input) {
         return QString();
     }
     
-    return QString::fromStdString(simulator->processSymbol(input.toStdString()));
+    // The input is recorded at the time the simulator sees it
+    if (traceWriter) {
+        traceWriter->recordInput(machine->getClock()->now(), "default", input.toStdString());
+    }
+    QString output = QString::fromStdString(simulator->processSymbol(input.toStdString()));
+    if (traceWriter) {
+        traceWriter->recordChanges(machine->getClock()->now(), *simulator, *machine);
+    }
+    return output;
 }
 
 /**
@@ -382,11 +447,19 @@ QString FSMBridge::processInputOnPointer(const QString &input, const QString &in
         return QString::fromStdString(connector->getOutput("default"));
     }
     
+    // The input is recorded at the time the simulator sees it
+    if (traceWriter) {
+        traceWriter->recordInput(machine->getClock()->now(), inputPtr.toStdString(), input.toStdString());
+    }
+
     // Set the input on the specific pointer
     simulator->setInput(inputPtr.toStdString(), input.toStdString());
     
     // Process the input
     simulator->processInputs();
+    if (traceWriter) {
+        traceWriter->recordChanges(machine->getClock()->now(), *simulator, *machine);
+    }
     
     // Get the output from the default output pointer
     return QString::fromStdString(simulator->getOutput("default"));
@@ -442,7 +515,7 @@ QString FSMBridge::addBooleanTransition(const QString &sourceId, const QString &
     transition.addBooleanCondition(leftOp.toStdString(), opSymbol.toStdString(), rightOp.toStdString());
 
     // Add the transition to the machine
-    if (machine->addTransition(transition)) {
+    if (journal.addTransition(*machine, transition)) {
     return QString::fromStdString(transitionId);
     }
 
@@ -631,6 +704,26 @@ QStringList FSMBridge::getValidationErrors() const {
     return errors;
 }
 
+/**
+ * @brief Analyses the machine for unreachable, dead and trap states and overlapping transitions
+ * 
+ * @return QStringList containing one warning per finding
+ */
+QStringList FSMBridge::getAnalysisWarnings() const {
+    QStringList warnings;
+    
+    if (!machine) {
+        return warnings;
+    }
+    
+    MachineAnalyzer analyzer(*machine);
+    for (const std::string &warning : MachineAnalyzer::describe(analyzer.analyze())) {
+        warnings.append(QString::fromStdString(warning));
+    }
+    
+    return warnings;
+}
+
 /**
  * @brief Gets the ID of the current active state during simulation
  * 
@@ -659,9 +752,32 @@ QString FSMBridge::getCurrentStateId() const {
 void FSMBridge::stepSimulation() {
     if (simulator) {
         simulator->processInputs();  // This handles both timeouts and input-triggered transitions
+        if (traceWriter && !machineConnected) {
+            traceWriter->recordChanges(machine->getClock()->now(), *simulator, *machine);
+        }
     }
 }
 
+/**
+ * @brief Gets how long the simulation can sleep before the next step
+ * 
+ * @return Delay in milliseconds, or -1 if nothing happens until the next input
+ */
+int FSMBridge::getMsUntilNextStep() const {
+    if (!simulator) {
+        return -1;
+    }
+
+    auto deadline = simulator->nextDeadline();
+    if (deadline == std::chrono::steady_clock::time_point::max()) {
+        return -1;
+    }
+
+    // Round up so the timer never fires before the deadline
+    auto remaining = std::chrono::ceil<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+    return remaining.count() > 0 ? static_cast<int>(remaining.count()) : 0;
+}
+
 /**
  * @brief Converts a backend state ID to frontend representation
  * 
@@ -712,21 +828,8 @@ QString FSMBridge::getInputConditionsString(const Transition *transition){
 
     if (!transition) return QString();
 
-    QStringList condValues;
-    const std::vector<InputCondition>& inputConditions = transition->getInputConditions();
-    for (const InputCondition& cond : inputConditions) {
-        if (!cond.isBooleanExpr && !cond.value.empty()) {
-            condValues << QString::fromStdString(cond.value);
-        }
-    }
-
-    // Optional: show timeout if it exists
-    if (transition->getTimeout() > 0) {
-        QString symbol = QChar(0x29D7);
-        condValues << QString("%1 %2 s").arg(symbol, QString::number(transition->getTimeout() / 1000));
-    }
-
-    return condValues.join(", ");
+    // The scene model compares labels made the same way
+    return QString::fromStdString(SceneModel::transitionLabel(*transition));
 }
 
 /**
@@ -864,7 +967,7 @@ bool FSMBridge::addVar(const QString &name, const QString &type, const QString &
         return false;
     }
 
-    return machine->addVariable(type.toStdString(), name.toStdString(), value.toStdString());
+    return journal.addVariable(*machine, type.toStdString(), name.toStdString(), value.toStdString());
 }
 
 /**
@@ -877,7 +980,7 @@ bool FSMBridge::removeVar(const QString &name) {
         return false;
     }
 
-    return machine->removeVariable(name.toStdString());
+    return journal.removeVariable(*machine, name.toStdString());
 }
 
 /**
@@ -915,10 +1018,10 @@ bool FSMBridge::removeCondition(const QString &transitionId, int conditionIndex)
         }
     }
     
-    // Update the transition with the new conditions
-    transition->setInputConditions(newConditions);
-    
-    return true;
+    // Replace the transition with a copy without the condition
+    Transition updated = *transition;
+    updated.setInputConditions(newConditions);
+    return journal.replaceTransition(*machine, updated);
 }
 
 /**
@@ -934,8 +1037,9 @@ bool FSMBridge::updateTransitionTimeout(const QString &transitionId, int timeout
     Transition* transition = machine->getTransition(transitionId.toStdString());
     if (!transition) return false;
 
-    transition->setTimeout(timeout);
-    return true;
+    Transition updated = *transition;
+    updated.setTimeout(timeout);
+    return journal.replaceTransition(*machine, updated);
 }
 
 /**
@@ -951,16 +1055,17 @@ bool FSMBridge::updateTransitionConditions(const QString &transitionId, const QL
     Transition* transition = machine->getTransition(transitionId.toStdString());
     if (!transition) return false;
 
-    std::vector<InputCondition> updated;
+    std::vector<InputCondition> inputs;
     for (const QPair<QString, QString> &pair : conditions) {
         if (!pair.first.isEmpty()) {
             machine->addInputSymbol(pair.first.toStdString());
-            updated.emplace_back(pair.first.toStdString(), pair.second.toStdString());
+            inputs.emplace_back(pair.first.toStdString(), pair.second.toStdString());
         }
     }
 
-    transition->setInputConditions(updated);
-    return true;
+    Transition updated = *transition;
+    updated.setInputConditions(inputs);
+    return journal.replaceTransition(*machine, updated);
 }
 
 /**
@@ -973,5 +1078,47 @@ void FSMBridge::genIncludable(const QString &codeStyle) {
         IncludableGenerator::generateCode(*machine, machine->getName(), "FSMAutomaton", CodeStyle::CALLBACK);
     } else if (codeStyle == "goto") {
         IncludableGenerator::generateCode(*machine, machine->getName(), "FSMAutomaton", CodeStyle::COMPUTED_GOTO);
+    } else if (codeStyle == "typed") {
+        IncludableGenerator::generateCode(*machine, machine->getName(), "FSMAutomaton", CodeStyle::TYPED);
+    } else if (codeStyle == "c") {
+        IncludableGenerator::generateCode(*machine, machine->getName(), "FSMAutomaton", CodeStyle::C_TABLE);
+    }
+}
+
+/**
+ * @brief Checks whether there is an edit to undo
+ * @return True if undo() would revert something
+ */
+bool FSMBridge::canUndo() const {
+    return machine && journal.canUndo();
+}
+
+/**
+ * @brief Checks whether there is an edit to redo
+ * @return True if redo() would repeat something
+ */
+bool FSMBridge::canRedo() const {
+    return machine && journal.canRedo();
+}
+
+/**
+ * @brief Reverts the last edit of the machine
+ * @return The reverted edit, so the view can update only what it touched, nullptr if there was none
+ */
+const EditCommand* FSMBridge::undo() {
+    if (!machine) {
+        return nullptr;
+    }
+    return journal.undo(*machine);
+}
+
+/**
+ * @brief Makes the last undone edit of the machine again
+ * @return The repeated edit, nullptr if there was none
+ */
+const EditCommand* FSMBridge::redo() {
+    if (!machine) {
+        return nullptr;
     }
+    return journal.redo(*machine);
 }
@@ -9,6 +9,27 @@
 #include <iostream>
 #include <sstream>
 #include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <set>
+#include <stdexcept>
+#include <filesystem>
+
+// The source is written next to its header, so it includes it without the directory
+static std::string includeName(const std::string& headerFileName) {
+    return std::filesystem::path(headerFileName).filename().string();
+}
+
+// C++ expression of the initial value of a variable, quoting text and keeping floats float
+static std::string initialValue(const MachineVariable& variable) {
+    if (variable.getType() == VariableType::STRING) {
+        return "std::string(" + ActionTranslator::literal(variable.getValueString()) + ")";
+    }
+    if (variable.getType() == VariableType::FLOAT) {
+        return "static_cast<float>(" + variable.getValueString() + ")";
+    }
+    return variable.getValueString();
+}
 
 bool IncludableGenerator::generateCode(const MooreMachine& machine, 
                                        const std::string& baseName, 
@@ -28,7 +49,7 @@ bool IncludableGenerator::generateCode(const MooreMachine& machine,
             std::ofstream sourceFile(sourceFileName);
             if (!sourceFile.is_open()) return false;
             
-            sourceFile << generateSourceContent(machine, className, headerFileName, CodeStyle::CALLBACK);
+            sourceFile << generateSourceContent(machine, className, includeName(headerFileName), CodeStyle::CALLBACK);
             sourceFile.close();
         }
         else if (style == CodeStyle::COMPUTED_GOTO) {
@@ -44,9 +65,34 @@ bool IncludableGenerator::generateCode(const MooreMachine& machine,
             std::ofstream sourceFile(sourceFileName);
             if (!sourceFile.is_open()) return false;
             
-            sourceFile << generateGotoImplementation(machine, className, headerFileName);
+            sourceFile << generateGotoImplementation(machine, className, includeName(headerFileName));
+            sourceFile.close();
+        }
+        else if (style == CodeStyle::TYPED) {
+            // Both files come from one pass, they share the state and guard numbering
+            std::string headerFileName = baseName + ".h";
+            std::string header;
+            std::string source = generateTypedImplementation(machine, className, includeName(headerFileName), header);
+            
+            std::ofstream headerFile(headerFileName);
+            if (!headerFile.is_open()) return false;
+            headerFile << header;
+            headerFile.close();
+            
+            std::ofstream sourceFile(baseName + ".cpp");
+            if (!sourceFile.is_open()) return false;
+            sourceFile << source;
             sourceFile.close();
         }
+        else if (style == CodeStyle::C_TABLE) {
+            // Everything is static inline, so the header is the whole machine
+            std::string header = generateCHeader(machine, className);
+            
+            std::ofstream headerFile(baseName + ".h");
+            if (!headerFile.is_open()) return false;
+            headerFile << header;
+            headerFile.close();
+        }
         
         return true;
     } catch (const std::exception& e) {
@@ -117,21 +163,21 @@ std::string IncludableGenerator::generateHeaderContent(const MooreMachine& machi
        << "     */\n"
        << "    struct State {\n"
        << "        std::string name;\n"
-       << "        std::string outputExpression;\n";
+       << "        int index; // Number of the state's output actions\n";
     
     if (style == CodeStyle::COMPUTED_GOTO) {
         ss << "        StateId id;\n";
     }
     
     ss << "\n"
-       << "        State(const std::string& name, const std::string& outputExpression";
+       << "        State(const std::string& name, int index";
     
     if (style == CodeStyle::COMPUTED_GOTO) {
         ss << ", StateId id";
     }
     
     ss << ")\n"
-       << "            : name(name), outputExpression(outputExpression)";
+       << "            : name(name), index(index)";
     
     if (style == CodeStyle::COMPUTED_GOTO) {
         ss << ", id(id)";
@@ -148,10 +194,11 @@ std::string IncludableGenerator::generateHeaderContent(const MooreMachine& machi
        << "    struct Transition {\n"
        << "        State* fromState;\n"
        << "        State* toState;\n"
-       << "        std::string guardExpression;\n"
+       << "        int index; // Number of the transition's guard\n"
+       << "        bool conditional; // Whether the guard has any conditions\n"
        << "        int timeout; // ms\n\n"
-       << "        Transition(State* from, State* to, const std::string& guard, int timeout)\n"
-       << "            : fromState(from), toState(to), guardExpression(guard), timeout(timeout) {}\n"
+       << "        Transition(State* from, State* to, int index, bool conditional, int timeout)\n"
+       << "            : fromState(from), toState(to), index(index), conditional(conditional), timeout(timeout) {}\n"
        << "    };\n\n";
     
     // Constructor and destructor
@@ -183,6 +230,14 @@ std::string IncludableGenerator::generateHeaderContent(const MooreMachine& machi
        << "     */\n"
        << "    std::string processInput(const std::string& input, const std::string& inputPtr = \"default\");\n\n"
        << "    /**\n"
+       << "     * @brief Get the time tick() has to be called next\n"
+       << "     * Lets the caller sleep until the next timeout instead of polling.\n"
+       << "     * Returns a time that is already due while a new state or input waits\n"
+       << "     * to be evaluated, and time_point::max() if nothing happens until the next input\n"
+       << "     * @return Time of the next step\n"
+       << "     */\n"
+       << "    std::chrono::steady_clock::time_point nextDeadline() const;\n\n"
+       << "    /**\n"
        << "     * @brief Get the current state name\n"
        << "     * @return Name of the current state\n"
        << "     */\n"
@@ -273,27 +328,13 @@ std::string IncludableGenerator::generateHeaderContent(const MooreMachine& machi
            << "    }\n"
            << "#endif\n\n"
            << "    /**\n"
-           << "     * @brief Run the state machine using computed gotos\n"
-           << "     * \n"
-           << "     * Example usage:\n"
-           << "     * @code\n"
-           << "     * fsm.runWithGotos();\n"
-           << "     * state_start:\n"
-           << "     *     // Code for start state\n"
-           << "     *     // ...\n"
-           << "     *     fsm.setStateTarget(FSMAutomaton::STATE_state1, &&state1);\n"
-           << "     *     // ...\n"
-           << "     *     if (condition) goto state1;\n"
-           << "     *     return;\n"
-           << "     * \n"
-           << "     * state1:\n"
-           << "     *     // Code for state1\n"
-           << "     *     // ...\n"
-           << "     *     // Return to caller when done\n"
-           << "     *     return;\n"
-           << "     * @endcode\n"
+           << "     * @brief Run steps until no transition can fire before the next input or timeout\n"
+           << "     * Jumps from state to state without returning, each state label checks\n"
+           << "     * its own timeouts and guards\n"
+           << "     * @param maxSteps Most steps to make, a machine that never settles stops here\n"
+           << "     * @return Number of steps made\n"
            << "     */\n"
-           << "    void runWithGotos();\n\n";
+           << "    int runWithGotos(int maxSteps = 10000);\n\n";
     }
     
     // Private members
@@ -306,9 +347,8 @@ std::string IncludableGenerator::generateHeaderContent(const MooreMachine& machi
        << "    State* currentState;\n"
        << "    std::chrono::steady_clock::time_point stateEntryTime;\n"
        << "    bool justEnteredState; // Flag to prevent immediate re-evaluation of transitions\n"
-       << "    std::unordered_map<std::string, bool> timeoutActive; // Track active timeouts\n"
-       << "    std::unordered_map<std::string, std::chrono::steady_clock::time_point> timeoutStartTimes; // When timeouts started\n"
-       << "    std::unordered_map<Transition*, std::chrono::steady_clock::time_point> activeTimeouts;\n\n";
+       << "    bool settled; // No transition can fire before the next input or timeout\n"
+       << "    std::unordered_map<Transition*, std::chrono::steady_clock::time_point> activeTimeouts; // When timeouts started\n\n";
     if (style == CodeStyle::CALLBACK) {
         ss << "    std::function<void(const std::string&)> stateChangeCallback;\n"
            << "    std::function<void(const std::string&, const std::string&)> outputChangeCallback;\n"
@@ -322,17 +362,96 @@ std::string IncludableGenerator::generateHeaderContent(const MooreMachine& machi
     
     // Private methods
     ss << "    void executeOutputActions();\n"
-       << "    bool evaluateTransition(Transition* transition);\n"
-       << "    VariableType evaluateExpression(const std::string& expression);\n"
-       << "    std::vector<std::string> tokenize(const std::string& expr);\n"
-       << "    bool checkTimeouts();\n"
-       << "    void clearTriggeredInputs(Transition* transition);\n"
-       << "};\n\n"
+       << "    void setOutput(const std::string& outputPtr, const std::string& value);\n"
+       << "    int elapsedMs() const;\n";
+    if (style == CodeStyle::CALLBACK) {
+        ss << "    bool evaluateTransition(Transition* transition);\n"
+           << "    bool evaluateGuard(int index);\n"
+           << "    bool checkTimeouts();\n"
+           << "    void clearTriggeredInputs(Transition* transition);\n";
+    } else { // Computed goto style
+        ss << "    void enterState(State* state, std::chrono::steady_clock::time_point now);\n"
+           << "    int dispatch(int maxSteps);\n";
+    }
+    ss << "};\n\n"
        << "#endif // " << className << "_H\n";
     
     return ss.str();
 }
 
+std::string IncludableGenerator::generateCompiledActions(const ActionTranslator& translator, const std::string& className,
+                                                         const std::vector<State*>& states, const std::vector<Transition*>& transitions,
+                                                         bool withGuards) {
+    std::stringstream ss;
+    
+    // Elapsed keyword
+    ss << "// Get the time spent in the current state\n"
+       << "int " << className << "::elapsedMs() const {\n"
+       << "    return static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(\n"
+       << "        std::chrono::steady_clock::now() - stateEntryTime).count());\n"
+       << "}\n\n";
+    
+    // Execute output actions
+    ss << "// Execute output actions for the current state\n"
+       << "void " << className << "::executeOutputActions() {\n"
+       << "    if (!currentState) return;\n"
+       << "    \n"
+       << "    switch (currentState->index) {\n";
+    for (size_t i = 0; i < states.size(); i++) {
+        ss << "        case " << i << ": { // " << states[i]->getName() << "\n"
+           << translator.outputs(*states[i], "            ")
+           << "            break;\n"
+           << "        }\n";
+    }
+    ss << "    }\n"
+       << "}\n\n";
+    
+    if (!withGuards) {
+        return ss.str();
+    }
+    
+    // Evaluate guards, transitions without conditions only fire on their timeout
+    ss << "// Check whether any condition of a transition holds\n"
+       << "bool " << className << "::evaluateGuard(int index) {\n"
+       << "    switch (index) {\n";
+    for (size_t i = 0; i < transitions.size(); i++) {
+        if (transitions[i]->getInputConditions().empty()) {
+            continue;
+        }
+        ss << "        case " << i << ": {\n"
+           << translator.guard(*transitions[i], "            ")
+           << "            return false;\n"
+           << "        }\n";
+    }
+    ss << "        default:\n"
+       << "            return false;\n"
+       << "    }\n"
+       << "}\n\n";
+    
+    // Clear triggered inputs
+    ss << "// Clear input values that triggered a transition\n"
+       << "void " << className << "::clearTriggeredInputs(Transition* transition) {\n"
+       << "    // Skip if there's no transition\n"
+       << "    if (!transition) return;\n"
+       << "    \n"
+       << "    switch (transition->index) {\n";
+    for (size_t i = 0; i < transitions.size(); i++) {
+        std::string statements = translator.consumedInputs(*transitions[i], "            ");
+        if (statements.empty()) {
+            continue;
+        }
+        ss << "        case " << i << ":\n"
+           << statements
+           << "            break;\n";
+    }
+    ss << "        default:\n"
+       << "            break;\n"
+       << "    }\n"
+       << "}\n\n";
+    
+    return ss.str();
+}
+
 std::string IncludableGenerator::generateSourceContent(const MooreMachine& machine, const std::string& className, const std::string& headerName, CodeStyle style) {
     if (style == CodeStyle::COMPUTED_GOTO) {
         return generateGotoImplementation(machine, className, headerName);
@@ -340,6 +459,7 @@ std::string IncludableGenerator::generateSourceContent(const MooreMachine& machi
     
     // Default implementation using callbacks (original version)
     std::stringstream ss;
+    ActionTranslator translator(machine, className + "::VariableType", false);
     
     ss << "/**\n"
        << " * @file Auto-generated FSM implementation\n"
@@ -348,11 +468,15 @@ std::string IncludableGenerator::generateSourceContent(const MooreMachine& machi
        << " */\n\n"
        << "#include \"" << headerName << "\"\n"
        << "#include <algorithm>\n"
-       << "#include <regex>\n"
-       << "#include <sstream>\n"
-       << "#include <iostream>\n\n"
+       << "#include <cstdio>\n"
+       << "#include <iostream>\n"
+       << "#include <stdexcept>\n"
+       << "#include <string_view>\n\n"
+       << "namespace {\n"
+       << translator.helperFunctions()
+       << "} // namespace\n\n"
        << "// Constructor - initializes the FSM\n"
-       << className << "::" << className << "() : currentState(nullptr), justEnteredState(true) {\n";
+       << className << "::" << className << "() : currentState(nullptr), justEnteredState(true), settled(false) {\n";
     
     // Create input pointers
     auto inputPointers = machine.getInputPointers();
@@ -371,14 +495,8 @@ std::string IncludableGenerator::generateSourceContent(const MooreMachine& machi
     for (const auto& varPair : variables) {
         const auto& var = varPair.second;
         
-        ss << "    // Variable: " << var.getName() << " (" << typeToString(var.getType()) << ")\n";
-        if (typeToString(var.getType()) == "string") {
-            ss << "    variables[\"" << var.getName() << "\"] = std::string(\"" << var.getValueString() << "\");\n";
-        } else if (typeToString(var.getType()) == "float") {
-            ss << "    variables[\"" << var.getName() << "\"] = " << var.getValueString() << "f;\n";
-        } else { // int
-            ss << "    variables[\"" << var.getName() << "\"] = " << var.getValueString() << ";\n";
-        }
+        ss << "    // Variable: " << var.getName() << " (" << typeToString(var.getType()) << ")\n"
+           << "    variables[" << ActionTranslator::literal(var.getName()) << "] = " << initialValue(var) << ";\n";
     }
     
     // Create states
@@ -400,47 +518,24 @@ std::string IncludableGenerator::generateSourceContent(const MooreMachine& machi
         }
     }
     
+    int stateIdx = 0;
     for (State* state : statesList) {
         std::string stateName = state->getName();
         
         ss << "\n    // Create state: " << stateName << "\n";
-        
-        // Format state outputs
-        std::string outputExpr;
-        auto outputs = state->getOutputs();
-        
-        if (!outputs.empty()) {
-            for (const auto& output : outputs) {
-                // Check if this is a variable expression or regular output
-                if (output.value.find("=") != std::string::npos ||
-                    output.value.find("+") != std::string::npos ||
-                    output.value.find("-") != std::string::npos ||
-                    output.value.find("*") != std::string::npos ||
-                    output.value.find("/") != std::string::npos) {
-                    outputExpr += output.value;
-                } else {
-                    outputExpr += "output " + output.value + " to " + output.target;
-                }
-                
-                // Add condition if present
-                if (output.hasCondition) {
-                    outputExpr += " if " + output.inputPtr + " is defined";
-                }
-                
-                outputExpr += ";";
-            }
-        }
-        
-        ss << "    states[\"" << stateName << "\"] = new State(\"" << stateName << "\", \"" << outputExpr << "\");\n";
+        ss << "    states[\"" << stateName << "\"] = new State(\"" << stateName << "\", " << stateIdx << ");\n";
         
         // Set initial state
         if (state->getIsInitial()) {
             ss << "    currentState = states[\"" << stateName << "\"];\n";
             ss << "    stateEntryTime = std::chrono::steady_clock::now();\n";
         }
+        
+        stateIdx++;
     }
     
     // Create transitions
+    std::vector<Transition*> transitionList;
     for (State* sourceState : statesList) {
         std::string sourceName = sourceState->getName();
         auto outTransitions = const_cast<MooreMachine&>(machine).getTransitionsFromState(sourceState->getId());
@@ -455,24 +550,14 @@ std::string IncludableGenerator::generateSourceContent(const MooreMachine& machi
             
             ss << "\n    // Transition from " << sourceName << " to " << targetName << "\n";
             
-            // Build guard expression
-            std::string guardExpr;
-            auto inputConditions = transition->getInputConditions();
-            
-            for (const auto& cond : inputConditions) {
-                if (cond.isBooleanExpr) {
-                    guardExpr += cond.leftOperand + " " + cond.operation + " " + cond.rightOperand + ";";
-                } else {
-                    guardExpr += "got " + cond.value + " from " + cond.source + ";";
-                }
-            }
-            
-            // Add the transition
+            // Add the transition, its guard is numbered by its position
             ss << "    transitions.push_back(new Transition(\n"
                << "        states[\"" << sourceName << "\"],\n"
                << "        states[\"" << targetName << "\"],\n"
-               << "        \"" << guardExpr << "\",\n"
+               << "        " << transitionList.size() << ",\n"
+               << "        " << (transition->getInputConditions().empty() ? "false" : "true") << ",\n"
                << "        " << transition->getTimeout() << "));\n";
+            transitionList.push_back(transition);
         }
     }
     
@@ -513,8 +598,8 @@ std::string IncludableGenerator::generateSourceContent(const MooreMachine& machi
        << "    \n"
        << "    stateEntryTime = std::chrono::steady_clock::now();\n"
        << "    justEnteredState = true;\n"
-       << "    timeoutActive.clear();\n"
-       << "    timeoutStartTimes.clear();\n"
+       << "    settled = false;\n"
+       << "    activeTimeouts.clear();\n"
        << "    \n"
        << "    // Clear inputs and outputs\n"
        << "    for (auto& pair : inputs) {\n"
@@ -534,6 +619,7 @@ std::string IncludableGenerator::generateSourceContent(const MooreMachine& machi
     // Process step method
     ss << "// Process a step in the FSM\n"
        << "void " << className << "::tick() {\n"
+       << "    settled = false;\n"
        << "    if (!currentState) {\n"
        << "        reset();\n"
        << "        return;\n"
@@ -551,22 +637,21 @@ std::string IncludableGenerator::generateSourceContent(const MooreMachine& machi
        << "        return; // Already transitioned due to timeout\n"
        << "    }\n"
        << "    \n"
-       << "    // Evaluate transitions\n"
+       << "    // Evaluate transitions, the machine is settled unless one of them fires\n"
+       << "    settled = true;\n"
        << "    for (Transition* transition : transitions) {\n"
        << "        if (transition->fromState == currentState && evaluateTransition(transition)) {\n"
        << "            // If transition has both input conditions and timeout\n"
        << "            if (transition->timeout > 0) {\n"
-       << "                std::string transId = transition->guardExpression;\n"
-       << "                \n"
        << "                // If timeout not already active, start it\n"
-       << "                if (!timeoutActive[transId]) {\n"
-       << "                    timeoutActive[transId] = true;\n"
-       << "                    timeoutStartTimes[transId] = std::chrono::steady_clock::now();\n"
+       << "                if (activeTimeouts.find(transition) == activeTimeouts.end()) {\n"
+       << "                    activeTimeouts[transition] = std::chrono::steady_clock::now();\n"
        << "                }\n"
        << "                continue; // Wait for timeout to expire\n"
        << "            }\n"
        << "            \n"
        << "            // Immediate transition (no timeout)\n"
+       << "            settled = false;\n"
        << "            State* oldState = currentState;\n"
        << "            currentState = transition->toState;\n"
        << "            \n"
@@ -577,8 +662,7 @@ std::string IncludableGenerator::generateSourceContent(const MooreMachine& machi
        << "            if (oldState != currentState) {\n"
        << "                stateEntryTime = std::chrono::steady_clock::now();\n"
        << "                justEnteredState = true;\n"
-       << "                timeoutActive.clear();\n"
-       << "                timeoutStartTimes.clear();\n"
+       << "                activeTimeouts.clear();\n"
        << "                \n"
        << "                // Execute output actions\n"
        << "                executeOutputActions();\n"
@@ -614,6 +698,38 @@ std::string IncludableGenerator::generateSourceContent(const MooreMachine& machi
        << "    return getOutput(\"default\");\n"
        << "}\n\n";
     
+    // Next deadline
+    ss << "// Get the time tick() has to be called next\n"
+       << "std::chrono::steady_clock::time_point " << className << "::nextDeadline() const {\n"
+       << "    // A new state or input is evaluated on the next step\n"
+       << "    if (!settled) {\n"
+       << "        return stateEntryTime;\n"
+       << "    }\n"
+       << "    \n"
+       << "    auto deadline = std::chrono::steady_clock::time_point::max();\n"
+       << "    for (Transition* transition : transitions) {\n"
+       << "        if (transition->fromState != currentState || transition->timeout <= 0) {\n"
+       << "            continue;\n"
+       << "        }\n"
+       << "        \n"
+       << "        // Pure timeouts run from the state entry, the others from when their inputs arrived\n"
+       << "        auto start = stateEntryTime;\n"
+       << "        if (transition->conditional) {\n"
+       << "            auto it = activeTimeouts.find(transition);\n"
+       << "            if (it == activeTimeouts.end()) {\n"
+       << "                continue;\n"
+       << "            }\n"
+       << "            start = it->second;\n"
+       << "        }\n"
+       << "        \n"
+       << "        auto expires = start + std::chrono::milliseconds(transition->timeout);\n"
+       << "        if (expires < deadline) {\n"
+       << "            deadline = expires;\n"
+       << "        }\n"
+       << "    }\n"
+       << "    return deadline;\n"
+       << "}\n\n";
+    
     // Get current state name
     ss << "// Get the current state name\n"
        << "std::string " << className << "::getCurrentStateName() const {\n"
@@ -636,400 +752,29 @@ std::string IncludableGenerator::generateSourceContent(const MooreMachine& machi
        << "    return \"\";\n"
        << "}\n\n";
     
-    // Execute output actions
-    ss << "// Execute output actions for the current state\n"
-       << "void " << className << "::executeOutputActions() {\n"
-       << "    if (!currentState) return;\n"
-       << "    \n"
-       << "    std::string expr = currentState->outputExpression;\n"
-       << "    size_t pos = 0, end;\n"
+    // Set an output
+    ss << "// Set an output and report the change\n"
+       << "void " << className << "::setOutput(const std::string& outputPtr, const std::string& value) {\n"
+       << "    std::string& output = outputs[outputPtr];\n"
+       << "    if (output == value) {\n"
+       << "        return;\n"
+       << "    }\n"
+       << "    output = value;\n"
        << "    \n"
-       << "    while ((end = expr.find(';', pos)) != std::string::npos) {\n"
-       << "        std::string action = expr.substr(pos, end - pos);\n"
-       << "        pos = end + 1;\n"
-       << "        \n"
-       << "        // Skip empty actions\n"
-       << "        if (action.empty()) continue;\n"
-       << "        \n"
-       << "        // Handle conditional actions (if inputPtr is defined)\n"
-       << "        std::regex ifPattern(\"(.+) if (.+) is defined\");\n"
-       << "        std::smatch ifMatch;\n"
-       << "        \n"
-       << "        if (std::regex_match(action, ifMatch, ifPattern)) {\n"
-       << "            std::string actualAction = ifMatch[1];\n"
-       << "            std::string inputPtr = ifMatch[2];\n"
-       << "            \n"
-       << "            // Check if input is defined\n"
-       << "            auto inputIt = inputs.find(inputPtr);\n"
-       << "            if (inputIt == inputs.end() || inputIt->second.empty()) {\n"
-       << "                continue; // Skip this action\n"
-       << "            }\n"
-       << "            \n"
-       << "            // Replace action with actual action\n"
-       << "            action = actualAction;\n"
-       << "        }\n"
-       << "        \n"
-       << "        // Handle variable assignments (var = ...)\n"
-       << "        std::regex assignPattern(\"([^=]+)=(.+)\");\n"
-       << "        std::smatch assignMatch;\n"
-       << "        \n"
-       << "        if (std::regex_match(action, assignMatch, assignPattern)) {\n"
-       << "            std::string varName = assignMatch[1];\n"
-       << "            std::string valueExpr = assignMatch[2];\n"
-       << "            \n"
-       << "            // Trim whitespace\n"
-       << "            varName.erase(0, varName.find_first_not_of(\" \\t\\r\\n\"));\n"
-       << "            varName.erase(varName.find_last_not_of(\" \\t\\r\\n\") + 1);\n"
-       << "            valueExpr.erase(0, valueExpr.find_first_not_of(\" \\t\\r\\n\"));\n"
-       << "            valueExpr.erase(valueExpr.find_last_not_of(\" \\t\\r\\n\") + 1);\n"
-       << "            \n"
-       << "            // Check for 'get' expression\n"
-       << "            std::regex getPattern(\"get ([^\\\\s]+)\");\n"
-       << "            std::smatch getMatch;\n"
-       << "            \n"
-       << "            if (std::regex_match(valueExpr, getMatch, getPattern)) {\n"
-       << "                std::string inputPtr = getMatch[1];\n"
-       << "                auto inputIt = inputs.find(inputPtr);\n"
-       << "                \n"
-       << "                if (inputIt != inputs.end()) {\n"
-       << "                    // Find variable type\n"
-       << "                    auto varIt = variables.find(varName);\n"
-       << "                    if (varIt != variables.end()) {\n"
-       << "                        if (std::holds_alternative<int>(varIt->second)) {\n"
-       << "                            try {\n"
-       << "                                variables[varName] = std::stoi(inputIt->second);\n"
-       << "                            } catch (...) {\n"
-       << "                                variables[varName] = 0;\n"
-       << "                            }\n"
-       << "                        } else if (std::holds_alternative<float>(varIt->second)) {\n"
-       << "                            try {\n"
-       << "                                variables[varName] = std::stof(inputIt->second);\n"
-       << "                            } catch (...) {\n"
-       << "                                variables[varName] = 0.0f;\n"
-       << "                            }\n"
-       << "                        } else {\n"
-       << "                            variables[varName] = inputIt->second;\n"
-       << "                        }\n"
-       << "                    } else {\n"
-       << "                        // Default to string\n"
-       << "                        variables[varName] = inputIt->second;\n"
-       << "                    }\n"
-       << "                }\n"
-       << "            } else {\n"
-       << "                // Evaluate expression\n"
-       << "                variables[varName] = evaluateExpression(valueExpr);\n"
-       << "            }\n"
-       << "            \n"
-       << "            continue;\n"
-       << "        }\n"
-       << "        \n"
-       << "        // Handle output expressions (output value to target)\n"
-       << "        std::regex outputPattern(\"output (.+) to (.+)\");\n"
-       << "        std::smatch outputMatch;\n"
-       << "        \n"
-       << "        if (std::regex_match(action, outputMatch, outputPattern)) {\n"
-       << "            std::string value = outputMatch[1];\n"
-       << "            std::string target = outputMatch[2];\n"
-       << "            \n"
-       << "            // Trim whitespace\n"
-       << "            value.erase(0, value.find_first_not_of(\" \\t\\r\\n\"));\n"
-       << "            value.erase(value.find_last_not_of(\" \\t\\r\\n\") + 1);\n"
-       << "            target.erase(0, target.find_first_not_of(\" \\t\\r\\n\"));\n"
-       << "            target.erase(target.find_last_not_of(\" \\t\\r\\n\") + 1);\n"
-       << "            \n"
-       << "            // Evaluate the value if it's an expression\n"
-       << "            if (value.find_first_of(\"+-*/\") != std::string::npos) {\n"
-       << "                auto result = evaluateExpression(value);\n"
-       << "                std::string strResult;\n"
-       << "                \n"
-       << "                if (std::holds_alternative<int>(result)) {\n"
-       << "                    strResult = std::to_string(std::get<int>(result));\n"
-       << "                } else if (std::holds_alternative<float>(result)) {\n"
-       << "                    strResult = std::to_string(std::get<float>(result));\n"
-       << "                } else {\n"
-       << "                    strResult = std::get<std::string>(result);\n"
-       << "                }\n"
-       << "                \n"
-       << "                value = strResult;\n"
-       << "            }\n"
-       << "            \n"
-       << "            // Check if output already exists\n"
-       << "            std::string oldValue = outputs[target];\n"
-       << "            outputs[target] = value;\n"
-       << "            \n"
-       << "            // Call output change callback if registered and value changed\n"
-       << "            if (outputChangeCallback && oldValue != value) {\n"
-       << "                outputChangeCallback(target, value);\n"
-       << "            }\n"
-       << "        }\n"
+       << "    // Call output change callback if registered\n"
+       << "    if (outputChangeCallback) {\n"
+       << "        outputChangeCallback(outputPtr, value);\n"
        << "    }\n"
        << "}\n\n";
     
     // Evaluate transition
     ss << "// Evaluate if a transition should be triggered\n"
        << "bool " << className << "::evaluateTransition(Transition* transition) {\n"
-       << "    std::string expr = transition->guardExpression;\n"
-       << "    if (expr.empty()) {\n"
-       << "        return false;\n"
-       << "    }\n"
-       << "    \n"
-       << "    size_t pos = 0, end;\n"
-       << "    bool result = false;\n"
-       << "    \n"
-       << "    while ((end = expr.find(';', pos)) != std::string::npos) {\n"
-       << "        std::string condition = expr.substr(pos, end - pos);\n"
-       << "        pos = end + 1;\n"
-       << "        \n"
-       << "        // Skip empty conditions\n"
-       << "        if (condition.empty()) continue;\n"
-       << "        \n"
-       << "        // Handle boolean expressions (var == value or var != value)\n"
-       << "        std::regex boolPattern(\"(.+) ?(==|!=) ?(.+)\");\n"
-       << "        std::smatch boolMatch;\n"
-       << "        \n"
-       << "        if (std::regex_match(condition, boolMatch, boolPattern)) {\n"
-       << "            std::string leftOp = boolMatch[1];\n"
-       << "            std::string op = boolMatch[2];\n"
-       << "            std::string rightOp = boolMatch[3];\n"
-       << "            \n"
-       << "            // Trim whitespace\n"
-       << "            leftOp.erase(0, leftOp.find_first_not_of(\" \\t\\r\\n\"));\n"
-       << "            leftOp.erase(leftOp.find_last_not_of(\" \\t\\r\\n\") + 1);\n"
-       << "            rightOp.erase(0, rightOp.find_first_not_of(\" \\t\\r\\n\"));\n"
-       << "            rightOp.erase(rightOp.find_last_not_of(\" \\t\\r\\n\") + 1);\n"
-       << "            \n"
-       << "            // Get left operand value\n"
-       << "            auto leftIt = variables.find(leftOp);\n"
-       << "            if (leftIt == variables.end()) {\n"
-       << "                continue; // Skip this condition if variable not found\n"
-       << "            }\n"
-       << "            \n"
-       << "            // Get right operand value\n"
-       << "            VariableType rightValue;\n"
-       << "            auto rightIt = variables.find(rightOp);\n"
-       << "            \n"
-       << "            if (rightIt != variables.end()) {\n"
-       << "                rightValue = rightIt->second;\n"
-       << "            } else {\n"
-       << "                // Try to parse as literal based on left operand type\n"
-       << "                if (std::holds_alternative<int>(leftIt->second)) {\n"
-       << "                    try {\n"
-       << "                        rightValue = std::stoi(rightOp);\n"
-       << "                    } catch (...) {\n"
-       << "                        continue; // Invalid conversion\n"
-       << "                    }\n"
-       << "                } else if (std::holds_alternative<float>(leftIt->second)) {\n"
-       << "                    try {\n"
-       << "                        rightValue = std::stof(rightOp);\n"
-       << "                    } catch (...) {\n"
-       << "                        continue; // Invalid conversion\n"
-       << "                    }\n"
-       << "                } else {\n"
-       << "                    rightValue = rightOp; // String literal\n"
-       << "                }\n"
-       << "            }\n"
-       << "            \n"
-       << "            // Compare values\n"
-       << "            bool conditionMet = false;\n"
-       << "            \n"
-       << "            if (op == \"==\") {\n"
-       << "                conditionMet = (leftIt->second == rightValue);\n"
-       << "            } else { // op == \"!=\"\n"
-       << "                conditionMet = (leftIt->second != rightValue);\n"
-       << "            }\n"
-       << "            \n"
-       << "            result = conditionMet;\n"
-       << "            if (!result) {\n"
-       << "                return false; // If any condition fails, the whole transition fails\n"
-       << "            }\n"
-       << "        }\n"
-       << "        \n"
-       << "        // Handle input conditions (got value from source)\n"
-       << "        std::regex inputPattern(\"got (.+) from (.+)\");\n"
-       << "        std::smatch inputMatch;\n"
-       << "        \n"
-       << "        if (std::regex_match(condition, inputMatch, inputPattern)) {\n"
-       << "            std::string value = inputMatch[1];\n"
-       << "            std::string source = inputMatch[2];\n"
-       << "            \n"
-       << "            // Trim whitespace\n"
-       << "            value.erase(0, value.find_first_not_of(\" \\t\\r\\n\"));\n"
-       << "            value.erase(value.find_last_not_of(\" \\t\\r\\n\") + 1);\n"
-       << "            source.erase(0, source.find_first_not_of(\" \\t\\r\\n\"));\n"
-       << "            source.erase(source.find_last_not_of(\" \\t\\r\\n\") + 1);\n"
-       << "            \n"
-       << "            // Check if input matches\n"
-       << "            auto inputIt = inputs.find(source);\n"
-       << "            if (inputIt != inputs.end() && inputIt->second == value) {\n"
-       << "                result = true;\n"
-       << "            } else {\n"
-       << "                return false; // If any condition fails, the whole transition fails\n"
-       << "            }\n"
-       << "        }\n"
-       << "    }\n"
-       << "    \n"
-       << "    return result;\n"
-       << "}\n\n";
-    
-    // Evaluate expression
-    ss << "// Evaluate a simple arithmetic expression\n"
-       << className << "::VariableType " << className << "::evaluateExpression(const std::string& expression) {\n"
-       << "    // Simple expression evaluation (no precedence)\n"
-       << "    std::vector<std::string> tokens = tokenize(expression);\n"
-       << "    \n"
-       << "    if (tokens.empty()) {\n"
-       << "        return std::string(\"\");\n"
-       << "    }\n"
-       << "    \n"
-       << "    VariableType result;\n"
-       << "    std::string currentOp = \"+\"; // Default operation\n"
-       << "    bool firstToken = true;\n"
-       << "    \n"
-       << "    for (size_t i = 0; i < tokens.size(); i++) {\n"
-       << "        const std::string& token = tokens[i];\n"
-       << "        \n"
-       << "        // Skip empty tokens\n"
-       << "        if (token.empty()) continue;\n"
-       << "        \n"
-       << "        // Handle operators\n"
-       << "        if (token == \"+\" || token == \"-\" || token == \"*\" || token == \"/\") {\n"
-       << "            currentOp = token;\n"
-       << "            continue;\n"
-       << "        }\n"
-       << "        \n"
-       << "        // Get token value\n"
-       << "        VariableType tokenValue;\n"
-       << "        \n"
-       << "        // Check if token is a variable\n"
-       << "        auto varIt = variables.find(token);\n"
-       << "        if (varIt != variables.end()) {\n"
-       << "            tokenValue = varIt->second;\n"
-       << "        }\n"
-       << "        // Check if token is 'elapsed' keyword\n"
-       << "        else if (token == \"elapsed\") {\n"
-       << "            auto now = std::chrono::steady_clock::now();\n"
-       << "            auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - stateEntryTime).count();\n"
-       << "            tokenValue = static_cast<int>(elapsed);\n"
-       << "        }\n"
-       << "        // Try to parse as number\n"
-       << "        else {\n"
-       << "            try {\n"
-       << "                // Check if it's a floating point number\n"
-       << "                if (token.find('.') != std::string::npos) {\n"
-       << "                    tokenValue = std::stof(token);\n"
-       << "                } else {\n"
-       << "                    tokenValue = std::stoi(token);\n"
-       << "                }\n"
-       << "            } catch (...) {\n"
-       << "                // Default to string\n"
-       << "                tokenValue = token;\n"
-       << "            }\n"
-       << "        }\n"
-       << "        \n"
-       << "        // Set initial result or apply operation\n"
-       << "        if (firstToken) {\n"
-       << "            result = tokenValue;\n"
-       << "            firstToken = false;\n"
-       << "        } else {\n"
-       << "            // Integer operations\n"
-       << "            if (std::holds_alternative<int>(result) && std::holds_alternative<int>(tokenValue)) {\n"
-       << "                int val1 = std::get<int>(result);\n"
-       << "                int val2 = std::get<int>(tokenValue);\n"
-       << "                \n"
-       << "                if (currentOp == \"+\") result = val1 + val2;\n"
-       << "                else if (currentOp == \"-\") result = val1 - val2;\n"
-       << "                else if (currentOp == \"*\") result = val1 * val2;\n"
-       << "                else if (currentOp == \"/\") {\n"
-       << "                    if (val2 == 0) result = 0; // Prevent division by zero\n"
-       << "                    else result = val1 / val2;\n"
-       << "                }\n"
-       << "            }\n"
-       << "            // Float operations (at least one operand is float)\n"
-       << "            else if ((std::holds_alternative<float>(result) || std::holds_alternative<int>(result)) &&\n"
-       << "                     (std::holds_alternative<float>(tokenValue) || std::holds_alternative<int>(tokenValue))) {\n"
-       << "                \n"
-       << "                float val1 = std::holds_alternative<float>(result) ?\n"
-       << "                            std::get<float>(result) : static_cast<float>(std::get<int>(result));\n"
-       << "                            \n"
-       << "                float val2 = std::holds_alternative<float>(tokenValue) ?\n"
-       << "                            std::get<float>(tokenValue) : static_cast<float>(std::get<int>(tokenValue));\n"
-       << "                \n"
-       << "                if (currentOp == \"+\") result = val1 + val2;\n"
-       << "                else if (currentOp == \"-\") result = val1 - val2;\n"
-       << "                else if (currentOp == \"*\") result = val1 * val2;\n"
-       << "                else if (currentOp == \"/\") {\n"
-       << "                    if (val2 == 0.0f) result = 0.0f; // Prevent division by zero\n"
-       << "                    else result = val1 / val2;\n"
-       << "                }\n"
-       << "            }\n"
-       << "            // String concatenation\n"
-       << "            else if (currentOp == \"+\") {\n"
-       << "                // Convert both values to strings\n"
-       << "                std::string val1;\n"
-       << "                if (std::holds_alternative<int>(result)) {\n"
-       << "                    val1 = std::to_string(std::get<int>(result));\n"
-       << "                } else if (std::holds_alternative<float>(result)) {\n"
-       << "                    val1 = std::to_string(std::get<float>(result));\n"
-       << "                } else {\n"
-       << "                    val1 = std::get<std::string>(result);\n"
-       << "                }\n"
-       << "                \n"
-       << "                std::string val2;\n"
-       << "                if (std::holds_alternative<int>(tokenValue)) {\n"
-       << "                    val2 = std::to_string(std::get<int>(tokenValue));\n"
-       << "                } else if (std::holds_alternative<float>(tokenValue)) {\n"
-       << "                    val2 = std::to_string(std::get<float>(tokenValue));\n"
-       << "                } else {\n"
-       << "                    val2 = std::get<std::string>(tokenValue);\n"
-       << "                }\n"
-       << "                \n"
-       << "                result = val1 + val2;\n"
-       << "            }\n"
-       << "        }\n"
-       << "    }\n"
-       << "    \n"
-       << "    return result;\n"
+       << "    return evaluateGuard(transition->index);\n"
        << "}\n\n";
     
-    // Tokenize helper
-    ss << "// Split an expression into tokens\n"
-       << "std::vector<std::string> " << className << "::tokenize(const std::string& expr) {\n"
-       << "    std::vector<std::string> tokens;\n"
-       << "    std::string currentToken;\n"
-       << "    \n"
-       << "    for (size_t i = 0; i < expr.length(); i++) {\n"
-       << "        char c = expr[i];\n"
-       << "        \n"
-       << "        // Skip whitespace\n"
-       << "        if (std::isspace(c)) {\n"
-       << "            if (!currentToken.empty()) {\n"
-       << "                tokens.push_back(currentToken);\n"
-       << "                currentToken.clear();\n"
-       << "            }\n"
-       << "            continue;\n"
-       << "        }\n"
-       << "        \n"
-       << "        // Handle operators\n"
-       << "        if (c == '+' || c == '-' || c == '*' || c == '/') {\n"
-       << "            if (!currentToken.empty()) {\n"
-       << "                tokens.push_back(currentToken);\n"
-       << "                currentToken.clear();\n"
-       << "            }\n"
-       << "            tokens.push_back(std::string(1, c));\n"
-       << "            continue;\n"
-       << "        }\n"
-       << "        \n"
-       << "        // Handle numbers and identifiers\n"
-       << "        currentToken += c;\n"
-       << "    }\n"
-       << "    \n"
-       << "    // Add the last token if any\n"
-       << "    if (!currentToken.empty()) {\n"
-       << "        tokens.push_back(currentToken);\n"
-       << "    }\n"
-       << "    \n"
-       << "    return tokens;\n"
-       << "}\n\n";
+    // Output actions, guards and input clearing translated from the machine
+    ss << generateCompiledActions(translator, className, statesList, transitionList, true);
     
     // Check timeouts
     ss << "// Check for timeout transitions\n"
@@ -1037,32 +782,14 @@ std::string IncludableGenerator::generateSourceContent(const MooreMachine& machi
        << "    auto now = std::chrono::steady_clock::now();\n"
        << "    \n"
        << "    // First check transitions with both input conditions and timeouts\n"
-       << "    for (auto it = timeoutActive.begin(); it != timeoutActive.end(); ) {\n"
-       << "        if (!it->second) {\n"
-       << "            ++it;\n"
-       << "            continue; // Skip inactive timeouts\n"
-       << "        }\n"
-       << "        \n"
-       << "        std::string transitionId = it->first;\n"
-       << "        // Find the transition with this ID\n"
-       << "        Transition* transition = nullptr;\n"
-       << "        for (auto* t : transitions) {\n"
-       << "            if (t->guardExpression == transitionId && t->fromState == currentState) {\n"
-       << "                transition = t;\n"
-       << "                break;\n"
-       << "            }\n"
-       << "        }\n"
-       << "        \n"
-       << "        if (!transition) {\n"
-       << "            // Invalid or not from current state\n"
-       << "            it = timeoutActive.erase(it);\n"
-       << "            timeoutStartTimes.erase(transitionId);\n"
-       << "            continue;\n"
+       << "    for (const auto& pair : activeTimeouts) {\n"
+       << "        Transition* transition = pair.first;\n"
+       << "        if (transition->fromState != currentState) {\n"
+       << "            continue; // Armed in a state the machine has left\n"
        << "        }\n"
        << "        \n"
        << "        // Check if timeout has expired\n"
-       << "        auto startTime = timeoutStartTimes[transitionId];\n"
-       << "        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - startTime).count();\n"
+       << "        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - pair.second).count();\n"
        << "        \n"
        << "        if (elapsed >= transition->timeout) {\n"
        << "            // Timeout expired - make the transition\n"
@@ -1075,8 +802,7 @@ std::string IncludableGenerator::generateSourceContent(const MooreMachine& machi
        << "            // Reset timer, mark state entry, clear timeouts\n"
        << "            stateEntryTime = now;\n"
        << "            justEnteredState = true;\n"
-       << "            timeoutActive.clear();\n"
-       << "            timeoutStartTimes.clear();\n"
+       << "            activeTimeouts.clear();\n"
        << "            \n"
        << "            // Process outputs from new state\n"
        << "            executeOutputActions();\n"
@@ -1093,15 +819,13 @@ std::string IncludableGenerator::generateSourceContent(const MooreMachine& machi
        << "            \n"
        << "            return true; // We made a transition\n"
        << "        }\n"
-       << "        \n"
-       << "        ++it;\n"
        << "    }\n"
        << "    \n"
        << "    // Then check pure timeout transitions (no input conditions)\n"
        << "    for (Transition* transition : transitions) {\n"
        << "        if (transition->fromState != currentState || \n"
        << "            transition->timeout <= 0 || \n"
-       << "            !transition->guardExpression.empty()) {\n"
+       << "            transition->conditional) {\n"
        << "            continue; // Skip non-timeout transitions or those with input conditions\n"
        << "        }\n"
        << "        \n"
@@ -1116,8 +840,7 @@ std::string IncludableGenerator::generateSourceContent(const MooreMachine& machi
        << "            // Reset timer, mark state entry, clear timeouts\n"
        << "            stateEntryTime = now;\n"
        << "            justEnteredState = true;\n"
-       << "            timeoutActive.clear();\n"
-       << "            timeoutStartTimes.clear();\n"
+       << "            activeTimeouts.clear();\n"
        << "            \n"
        << "            // Process outputs from new state\n"
        << "            executeOutputActions();\n"
@@ -1139,43 +862,12 @@ std::string IncludableGenerator::generateSourceContent(const MooreMachine& machi
        << "    return false; // No timeout transitions triggered\n"
        << "}\n\n";
     
-    // Clear triggered inputs
-    ss << "// Clear input values that triggered a transition\n"
-       << "void " << className << "::clearTriggeredInputs(Transition* transition) {\n"
-       << "    // Skip if there's no transition\n"
-       << "    if (!transition) return;\n"
-       << "    \n"
-       << "    std::string expr = transition->guardExpression;\n"
-       << "    size_t pos = 0, end;\n"
-       << "    \n"
-       << "    while ((end = expr.find(';', pos)) != std::string::npos) {\n"
-       << "        std::string condition = expr.substr(pos, end - pos);\n"
-       << "        pos = end + 1;\n"
-       << "        \n"
-       << "        // Skip empty conditions\n"
-       << "        if (condition.empty()) continue;\n"
-       << "        \n"
-       << "        // Only handle regular input conditions (got value from source)\n"
-       << "        std::regex inputPattern(\"got (.+) from (.+)\");\n"
-       << "        std::smatch inputMatch;\n"
-       << "        \n"
-       << "        if (std::regex_match(condition, inputMatch, inputPattern)) {\n"
-       << "            std::string source = inputMatch[2];\n"
-       << "            // Trim whitespace\n"
-       << "            source.erase(0, source.find_first_not_of(\" \\t\\r\\n\"));\n"
-       << "            source.erase(source.find_last_not_of(\" \\t\\r\\n\") + 1);\n"
-       << "            \n"
-       << "            // Clear the input\n"
-       << "            inputs[source] = \"\";\n"
-       << "        }\n"
-       << "    }\n"
-       << "}\n";
-    
     return ss.str();
 }
 
 std::string IncludableGenerator::generateGotoImplementation(const MooreMachine& machine, const std::string& className, const std::string& headerName) {
     std::stringstream ss;
+    ActionTranslator translator(machine, className + "::VariableType", false);
     
     ss << "/**\n"
        << " * @file Auto-generated FSM implementation\n"
@@ -1184,11 +876,15 @@ std::string IncludableGenerator::generateGotoImplementation(const MooreMachine&
        << " */\n\n"
        << "#include \"" << headerName << "\"\n"
        << "#include <algorithm>\n"
-       << "#include <regex>\n"
-       << "#include <sstream>\n"
-       << "#include <iostream>\n\n"
+       << "#include <cstdio>\n"
+       << "#include <iostream>\n"
+       << "#include <stdexcept>\n"
+       << "#include <string_view>\n\n"
+       << "namespace {\n"
+       << translator.helperFunctions()
+       << "} // namespace\n\n"
        << "// Constructor - initializes the FSM\n"
-       << className << "::" << className << "() : currentState(nullptr), justEnteredState(true) {\n";
+       << className << "::" << className << "() : currentState(nullptr), justEnteredState(true), settled(false) {\n";
     
     // Create input pointers
     auto inputPointers = machine.getInputPointers();
@@ -1207,14 +903,8 @@ std::string IncludableGenerator::generateGotoImplementation(const MooreMachine&
     for (const auto& varPair : variables) {
         const auto& var = varPair.second;
         
-        ss << "    // Variable: " << var.getName() << " (" << typeToString(var.getType()) << ")\n";
-        if (typeToString(var.getType()) == "string") {
-            ss << "    variables[\"" << var.getName() << "\"] = std::string(\"" << var.getValueString() << "\");\n";
-        } else if (typeToString(var.getType()) == "float") {
-            ss << "    variables[\"" << var.getName() << "\"] = " << var.getValueString() << "f;\n";
-        } else { // int
-            ss << "    variables[\"" << var.getName() << "\"] = " << var.getValueString() << ";\n";
-        }
+        ss << "    // Variable: " << var.getName() << " (" << typeToString(var.getType()) << ")\n"
+           << "    variables[" << ActionTranslator::literal(var.getName()) << "] = " << initialValue(var) << ";\n";
     }
     
     // Create states
@@ -1241,35 +931,8 @@ std::string IncludableGenerator::generateGotoImplementation(const MooreMachine&
         std::string stateName = state->getName();
         
         ss << "\n    // Create state: " << stateName << "\n";
-        
-        // Format state outputs
-        std::string outputExpr;
-        auto outputs = state->getOutputs();
-        
-        if (!outputs.empty()) {
-            for (const auto& output : outputs) {
-                // Check if this is a variable expression or regular output
-                if (output.value.find("=") != std::string::npos ||
-                    output.value.find("+") != std::string::npos ||
-                    output.value.find("-") != std::string::npos ||
-                    output.value.find("*") != std::string::npos ||
-                    output.value.find("/") != std::string::npos) {
-                    outputExpr += output.value;
-                } else {
-                    outputExpr += "output " + output.value + " to " + output.target;
-                }
-                
-                // Add condition if present
-                if (output.hasCondition) {
-                    outputExpr += " if " + output.inputPtr + " is defined";
-                }
-                
-                outputExpr += ";";
-            }
-        }
-        
         ss << "    states[\"" << stateName << "\"] = new State(\"" << stateName 
-           << "\", \"" << outputExpr << "\", STATE_" << stateName << ");\n";
+           << "\", " << stateIdx << ", STATE_" << stateName << ");\n";
         
         // Set initial state
         if (state->getIsInitial()) {
@@ -1293,6 +956,7 @@ std::string IncludableGenerator::generateGotoImplementation(const MooreMachine&
     
     
     // Create transitions
+    std::vector<Transition*> transitionList;
     for (State* sourceState : statesList) {
         std::string sourceName = sourceState->getName();
         auto outTransitions = const_cast<MooreMachine&>(machine).getTransitionsFromState(sourceState->getId());
@@ -1307,24 +971,14 @@ std::string IncludableGenerator::generateGotoImplementation(const MooreMachine&
             
             ss << "\n    // Transition from " << sourceName << " to " << targetName << "\n";
             
-            // Build guard expression
-            std::string guardExpr;
-            auto inputConditions = transition->getInputConditions();
-            
-            for (const auto& cond : inputConditions) {
-                if (cond.isBooleanExpr) {
-                    guardExpr += cond.leftOperand + " " + cond.operation + " " + cond.rightOperand + ";";
-                } else {
-                    guardExpr += "got " + cond.value + " from " + cond.source + ";";
-                }
-            }
-            
-            // Add the transition
+            // Add the transition, its guard is numbered by its position
             ss << "    transitions.push_back(new Transition(\n"
                << "        states[\"" << sourceName << "\"],\n"
                << "        states[\"" << targetName << "\"],\n"
-               << "        \"" << guardExpr << "\",\n"
+               << "        " << transitionList.size() << ",\n"
+               << "        " << (transition->getInputConditions().empty() ? "false" : "true") << ",\n"
                << "        " << transition->getTimeout() << "));\n";
+            transitionList.push_back(transition);
         }
     }
     
@@ -1365,6 +1019,7 @@ std::string IncludableGenerator::generateGotoImplementation(const MooreMachine&
        << "    \n"
        << "    stateEntryTime = std::chrono::steady_clock::now();\n"
        << "    justEnteredState = true;\n"
+       << "    settled = false;\n"
        << "    activeTimeouts.clear();\n"
        << "    \n"
        << "    // Clear inputs and outputs\n"
@@ -1385,57 +1040,25 @@ std::string IncludableGenerator::generateGotoImplementation(const MooreMachine&
     // Process step method
     ss << "// Process a step in the FSM\n"
        << "void " << className << "::tick() {\n"
-       << "    if (!currentState) {\n"
-       << "        reset();\n"
-       << "        return;\n"
-       << "    }\n"
-       << "    \n"
-       << "    // If we just entered this state, skip immediate transition evaluation\n"
-       << "    if (justEnteredState) {\n"
-       << "        justEnteredState = false;\n"
-       << "        return;\n"
-       << "    }\n"
-       << "    \n"
-       << "    // Check timeouts first\n"
-       << "    bool timeoutTriggered = checkTimeouts();\n"
-       << "    if (timeoutTriggered) {\n"
-       << "        return; // Already transitioned due to timeout\n"
-       << "    }\n"
-       << "    \n"
-       << "    // Evaluate transitions\n"
-       << "    for (Transition* transition : transitions) {\n"
-       << "        if (transition->fromState == currentState && evaluateTransition(transition)) {\n"
-       << "            // If transition has both input conditions and timeout\n"
-       << "            if (transition->timeout > 0) {\n"
-       << "                if (activeTimeouts.find(transition) == activeTimeouts.end()) {\n"
-       << "                    activeTimeouts[transition] = std::chrono::steady_clock::now();\n"
-       << "                }\n"
-       << "                continue; // Wait for timeout to expire\n"
-       << "            }\n"
-       << "            \n"
-       << "            // Immediate transition (no timeout)\n"
-       << "            State* oldState = currentState;\n"
-       << "            currentState = transition->toState;\n"
-       << "            \n"
-       << "            // Clear inputs that triggered this transition\n"
-       << "            clearTriggeredInputs(transition);\n"
-       << "            \n"
-       << "            // Reset state entry time if state changed\n"
-       << "            if (oldState != currentState) {\n"
-       << "                stateEntryTime = std::chrono::steady_clock::now();\n"
-       << "                justEnteredState = true;\n"
-       << "                timeoutActive.clear();\n"
-       << "                timeoutStartTimes.clear();\n"
-       << "                \n"
-       << "                // Execute output actions\n"
-       << "                executeOutputActions();\n"
-       << "            }\n"
-       << "            \n"
-       << "            break;\n"
-       << "        }\n"
-       << "    }\n"
+       << "    dispatch(1);\n"
+       << "}\n\n"
+       << "// Run steps until the machine settles\n"
+       << "int " << className << "::runWithGotos(int maxSteps) {\n"
+       << "    return dispatch(maxSteps);\n"
        << "}\n\n";
     
+    // Enter a state
+    ss << "// Enter a state and execute its outputs\n"
+       << "void " << className << "::enterState(State* state, std::chrono::steady_clock::time_point now) {\n"
+       << "    currentState = state;\n"
+       << "    stateEntryTime = now;\n"
+       << "    justEnteredState = true;\n"
+       << "    activeTimeouts.clear();\n"
+       << "    executeOutputActions();\n"
+       << "}\n\n";
+    
+    ss << generateGotoDispatch(translator, className, statesList, transitionList);
+    
     // Process input method
     ss << "// Process an input through the machine\n"
        << "std::string " << className << "::processInput(const std::string& input, const std::string& inputPtr) {\n"
@@ -1450,6 +1073,38 @@ std::string IncludableGenerator::generateGotoImplementation(const MooreMachine&
        << "    return getOutput(\"default\");\n"
        << "}\n\n";
     
+    // Next deadline
+    ss << "// Get the time tick() has to be called next\n"
+       << "std::chrono::steady_clock::time_point " << className << "::nextDeadline() const {\n"
+       << "    // A new state or input is evaluated on the next step\n"
+       << "    if (!settled) {\n"
+       << "        return stateEntryTime;\n"
+       << "    }\n"
+       << "    \n"
+       << "    auto deadline = std::chrono::steady_clock::time_point::max();\n"
+       << "    for (Transition* transition : transitions) {\n"
+       << "        if (transition->fromState != currentState || transition->timeout <= 0) {\n"
+       << "            continue;\n"
+       << "        }\n"
+       << "        \n"
+       << "        // Pure timeouts run from the state entry, the others from when their inputs arrived\n"
+       << "        auto start = stateEntryTime;\n"
+       << "        if (transition->conditional) {\n"
+       << "            auto it = activeTimeouts.find(transition);\n"
+       << "            if (it == activeTimeouts.end()) {\n"
+       << "                continue;\n"
+       << "            }\n"
+       << "            start = it->second;\n"
+       << "        }\n"
+       << "        \n"
+       << "        auto expires = start + std::chrono::milliseconds(transition->timeout);\n"
+       << "        if (expires < deadline) {\n"
+       << "            deadline = expires;\n"
+       << "        }\n"
+       << "    }\n"
+       << "    return deadline;\n"
+       << "}\n\n";
+    
     // Get current state name
     ss << "// Get the current state name\n"
        << "std::string " << className << "::getCurrentStateName() const {\n"
@@ -1478,512 +1133,1179 @@ std::string IncludableGenerator::generateGotoImplementation(const MooreMachine&
        << "    return \"\";\n"
        << "}\n\n";
     
-    // Execute output actions
-    ss << "// Execute output actions for the current state\n"
-       << "void " << className << "::executeOutputActions() {\n"
-       << "    if (!currentState) return;\n"
+    // Set an output
+    ss << "// Set an output\n"
+       << "void " << className << "::setOutput(const std::string& outputPtr, const std::string& value) {\n"
+       << "    outputs[outputPtr] = value;\n"
+       << "}\n\n";
+    
+    // Output actions translated from the machine, the guards are inlined in dispatch
+    ss << generateCompiledActions(translator, className, statesList, transitionList, false);
+    
+    ss << "// Get the label registered for a state\n"
+       << "void* " << className << "::getStateTarget(StateId id) const {\n"
+       << "#if USE_COMPUTED_GOTO\n"
+       << "    auto it = stateTargets.find(id);\n"
+       << "    if (it != stateTargets.end()) {\n"
+       << "        return it->second;\n"
+       << "    }\n"
+       << "#endif\n"
+       << "    return nullptr;\n"
+       << "}\n\n";
+    
+    return ss.str();
+}
+
+std::string IncludableGenerator::generateGotoDispatch(const ActionTranslator& translator, const std::string& className,
+                                                      const std::vector<State*>& states, const std::vector<Transition*>& transitions) {
+    std::stringstream ss;
+    
+    auto stateIndex = [&](const std::string& id) {
+        for (size_t i = 0; i < states.size(); i++) {
+            if (states[i]->getId() == id) {
+                return i;
+            }
+        }
+        return states.size();
+    };
+    
+    ss << "// Run steps from the current state, jumping from one state label to the next\n"
+       << "#if USE_COMPUTED_GOTO\n"
+       << "#pragma GCC diagnostic push\n"
+       << "#pragma GCC diagnostic ignored \"-Wpedantic\"\n"
+       << "#endif\n"
+       << "int " << className << "::dispatch(int maxSteps) {\n"
+       << "    int steps = 0;\n"
+       << "    if (!currentState) {\n"
+       << "        reset();\n"
+       << "        return steps;\n"
+       << "    }\n"
+       << "    \n"
+       << "#if USE_COMPUTED_GOTO\n"
+       << "    static void* const entered[] = {";
+    for (size_t i = 0; i < states.size(); i++) {
+        ss << (i ? ", " : "") << "&&entered_" << i;
+    }
+    ss << "};\n"
+       << "    static void* const ready[] = {";
+    for (size_t i = 0; i < states.size(); i++) {
+        ss << (i ? ", " : "") << "&&state_" << i;
+    }
+    ss << "};\n"
+       << "    goto *(justEnteredState ? entered : ready)[currentState->index];\n"
+       << "#else\n"
+       << "    switch (currentState->index) {\n";
+    for (size_t i = 0; i < states.size(); i++) {
+        ss << "        case " << i << ":\n"
+           << "            if (justEnteredState) goto entered_" << i << ";\n"
+           << "            goto state_" << i << ";\n";
+    }
+    ss << "        default:\n"
+       << "            return steps;\n"
+       << "    }\n"
+       << "#endif\n";
+    
+    for (size_t i = 0; i < states.size(); i++) {
+        std::vector<size_t> outgoing;
+        bool timed = false;
+        for (size_t k = 0; k < transitions.size(); k++) {
+            if (transitions[k]->getSourceId() == states[i]->getId()) {
+                outgoing.push_back(k);
+                timed = timed || transitions[k]->getTimeout() > 0;
+            }
+        }
+        
+        ss << "\n"
+           << "    // " << states[i]->getName() << "\n"
+           << "entered_" << i << ":\n"
+           << "    // The step after entering a state only settles it\n"
+           << "    if (steps == maxSteps) return steps;\n"
+           << "    steps++;\n"
+           << "    settled = false;\n"
+           << "    justEnteredState = false;\n"
+           << "state_" << i << ":\n"
+           << "    if (steps == maxSteps) return steps;\n"
+           << "    steps++;\n"
+           << "    settled = false;\n"
+           << "    {\n";
+        if (timed) {
+            ss << "        auto now = std::chrono::steady_clock::now();\n";
+        }
+        
+        // Expired timeouts first, armed ones before the pure ones
+        for (size_t k : outgoing) {
+            const Transition& transition = *transitions[k];
+            if (transition.getTimeout() <= 0 || transition.getInputConditions().empty()) {
+                continue;
+            }
+            ss << "        {\n"
+               << "            auto armed = activeTimeouts.find(transitions[" << k << "]);\n"
+               << "            if (armed != activeTimeouts.end() && now - armed->second >= std::chrono::milliseconds(" << transition.getTimeout() << ")) {\n"
+               << translator.consumedInputs(transition, "                ")
+               << "                enterState(transitions[" << k << "]->toState, now);\n"
+               << "                goto entered_" << stateIndex(transition.getTargetId()) << ";\n"
+               << "            }\n"
+               << "        }\n";
+        }
+        for (size_t k : outgoing) {
+            const Transition& transition = *transitions[k];
+            if (transition.getTimeout() <= 0 || !transition.getInputConditions().empty()) {
+                continue;
+            }
+            ss << "        if (now - stateEntryTime >= std::chrono::milliseconds(" << transition.getTimeout() << ")) {\n"
+               << "            enterState(transitions[" << k << "]->toState, now);\n"
+               << "            goto entered_" << stateIndex(transition.getTargetId()) << ";\n"
+               << "        }\n";
+        }
+        
+        // Then the guards in order, the first one holding fires
+        ss << "        settled = true;\n";
+        for (size_t k : outgoing) {
+            const Transition& transition = *transitions[k];
+            if (transition.getInputConditions().empty()) {
+                continue;
+            }
+            size_t target = stateIndex(transition.getTargetId());
+            ss << "        if ([this]() -> bool {\n"
+               << translator.guard(transition, "                ")
+               << "                return false;\n"
+               << "            }()) {\n";
+            if (transition.getTimeout() > 0) {
+                // The timer starts when the guard first holds
+                ss << "            activeTimeouts.emplace(transitions[" << k << "], std::chrono::steady_clock::now());\n"
+                   << "        }\n";
+                continue;
+            }
+            ss << "            settled = false;\n"
+               << translator.consumedInputs(transition, "            ");
+            if (target == i) {
+                ss << "            goto state_" << i << ";\n";
+            } else {
+                ss << "            enterState(transitions[" << k << "]->toState, std::chrono::steady_clock::now());\n"
+                   << "            goto entered_" << target << ";\n";
+            }
+            ss << "        }\n";
+        }
+        ss << "    }\n"
+           << "    return steps;\n";
+    }
+    
+    ss << "}\n"
+       << "#if USE_COMPUTED_GOTO\n"
+       << "#pragma GCC diagnostic pop\n"
+       << "#endif\n\n";
+    
+    return ss.str();
+}
+
+std::string IncludableGenerator::generateTypedHeader(const MooreMachine& machine, const std::string& className,
+                                                     const TypedActionTranslator& translator, const std::vector<std::string>& stateIds,
+                                                     int guards, int timers) {
+    std::stringstream ss;
+    
+    ss << "/**\n"
+       << " * @file Auto-generated FSM header\n"
+       << " * @brief Defines the " << className << " class, generated from a Moore machine\n"
+       << " * @warning This file is auto-generated. Do not modify manually.\n"
+       << " */\n\n"
+       << "#ifndef " << className << "_H\n"
+       << "#define " << className << "_H\n\n"
+       << "#include <chrono>\n"
+       << "#include <string>\n\n"
+       << "/**\n"
+       << " * @class " << className << "\n"
+       << " * @brief FSM implementation generated from \"" << machine.getName() << "\"\n"
+       << " *\n"
+       << " * Variables and pointers are typed struct fields and states an enum class,\n"
+       << " * nothing is looked up by name while the machine runs.\n"
+       << " */\n"
+       << "class " << className << " {\n"
+       << "public:\n";
+    
+    // States
+    ss << "    /**\n"
+       << "     * @enum StateId\n"
+       << "     * @brief States of the machine\n"
+       << "     */\n"
+       << "    enum class StateId {\n";
+    for (size_t i = 0; i < stateIds.size(); i++) {
+        ss << "        " << stateIds[i] << (i + 1 < stateIds.size() ? "," : "") << "\n";
+    }
+    ss << "    };\n\n";
+    
+    // Pointers and variables
+    ss << "    /**\n"
+       << "     * @struct Inputs\n"
+       << "     * @brief Last value received on each input pointer, cleared when a transition consumes it\n"
+       << "     */\n"
+       << "    struct Inputs {\n";
+    for (const auto& field : translator.getInputFields()) {
+        ss << "        std::string " << field.second << "; // " << field.first << "\n";
+    }
+    ss << "    };\n\n"
+       << "    /**\n"
+       << "     * @struct Outputs\n"
+       << "     * @brief Value written to each output pointer\n"
+       << "     */\n"
+       << "    struct Outputs {\n";
+    for (const auto& field : translator.getOutputFields()) {
+        ss << "        std::string " << field.second << "; // " << field.first << "\n";
+    }
+    ss << "    };\n\n"
+       << "    /**\n"
+       << "     * @struct Variables\n"
+       << "     * @brief Machine variables with their declared types and initial values\n"
+       << "     */\n"
+       << "    struct Variables {\n";
+    for (const auto& field : translator.getVariableFields()) {
+        ss << "        " << translator.variableDeclaration(field.first) << " // " << field.first << "\n";
+    }
+    ss << "    };\n\n"
+       << "    Inputs inputs;       // Set fields directly or through processInput\n"
+       << "    Outputs outputs;     // Read after each step\n"
+       << "    Variables variables; // Kept across reset()\n\n";
+    
+    // Methods
+    ss << "    /**\n"
+       << "     * @brief Constructor\n"
+       << "     */\n"
+       << "    " << className << "();\n\n"
+       << "    /**\n"
+       << "     * @brief Reset the FSM to its initial state\n"
+       << "     */\n"
+       << "    void reset();\n\n"
+       << "    /**\n"
+       << "     * @brief Process a step in the FSM\n"
+       << "     * Fires the first expired timeout, or else the first transition whose guard holds\n"
+       << "     */\n"
+       << "    void tick();\n\n"
+       << "    /**\n"
+       << "     * @brief Process an input through the machine\n"
+       << "     * @param input Input symbol to process\n"
+       << "     * @param inputPtr Input pointer to use (default is \"default\")\n"
+       << "     * @return Output produced by the new state\n"
+       << "     */\n"
+       << "    std::string processInput(const std::string& input, const std::string& inputPtr = \"default\");\n\n"
+       << "    /**\n"
+       << "     * @brief Get the time tick() has to be called next\n"
+       << "     * Returns a time that is already due while a new state or input waits\n"
+       << "     * to be evaluated, and time_point::max() if nothing happens until the next input\n"
+       << "     * @return Time of the next step\n"
+       << "     */\n"
+       << "    std::chrono::steady_clock::time_point nextDeadline() const;\n\n"
+       << "    /**\n"
+       << "     * @brief Get the current state ID\n"
+       << "     * @return ID of the current state\n"
+       << "     */\n"
+       << "    StateId getCurrentStateId() const;\n\n"
+       << "    /**\n"
+       << "     * @brief Get the current state name\n"
+       << "     * @return Name of the current state\n"
+       << "     */\n"
+       << "    std::string getCurrentStateName() const;\n\n";
+    
+    // Private members
+    ss << "private:\n"
+       << "    StateId currentState;\n"
+       << "    std::chrono::steady_clock::time_point stateEntryTime;\n"
+       << "    bool justEnteredState; // Flag to prevent immediate re-evaluation of transitions\n"
+       << "    bool settled; // No transition can fire before the next input or timeout\n";
+    if (timers > 0) {
+        ss << "    bool timerArmed[" << timers << "]; // Whether the guard of a timed transition has held\n"
+           << "    std::chrono::steady_clock::time_point timerStart[" << timers << "]; // When it first held\n";
+    }
+    ss << "\n"
+       << "    void enterState(StateId state, std::chrono::steady_clock::time_point now);\n"
+       << "    void executeOutputActions();\n"
+       << "    int elapsedMs() const;\n";
+    for (int i = 0; i < guards; i++) {
+        ss << "    bool guard" << i << "() const;\n";
+    }
+    ss << "};\n\n"
+       << "#endif // " << className << "_H\n";
+    
+    return ss.str();
+}
+
+std::string IncludableGenerator::generateTypedImplementation(const MooreMachine& machine, const std::string& className,
+                                                             const std::string& headerName, std::string& header) {
+    MooreMachine& source = const_cast<MooreMachine&>(machine);
+    TypedActionTranslator translator(machine);
+    
+    // Initial state first, like the other styles
+    std::vector<State*> statesList = source.getAllStates();
+    if (statesList.empty()) {
+        throw std::runtime_error("Machine has no states");
+    }
+    auto initial = std::find_if(statesList.begin(), statesList.end(), [](State* state) { return state->getIsInitial(); });
+    if (initial != statesList.end()) {
+        std::iter_swap(statesList.begin(), initial);
+    }
+    
+    std::vector<std::string> stateIds;
+    std::set<std::string> usedIds;
+    for (State* state : statesList) {
+        std::string base = TypedActionTranslator::identifier(state->getName());
+        std::string id = base;
+        for (int suffix = 2; usedIds.count(id); suffix++) {
+            id = base + "_" + std::to_string(suffix);
+        }
+        usedIds.insert(id);
+        stateIds.push_back(id);
+    }
+    auto stateId = [&](const std::string& id) {
+        for (size_t i = 0; i < statesList.size(); i++) {
+            if (statesList[i]->getId() == id) {
+                return "StateId::" + stateIds[i];
+            }
+        }
+        return std::string();
+    };
+    
+    std::stringstream ss;
+    std::stringstream guards;
+    std::stringstream ticks;
+    std::stringstream deadlines;
+    int guardCount = 0;
+    int timerCount = 0;
+    
+    // Each state becomes a case of tick() that checks its transitions in place
+    for (size_t i = 0; i < statesList.size(); i++) {
+        std::string current = "StateId::" + stateIds[i];
+        std::vector<Transition*> outgoing;
+        bool timed = false;
+        for (Transition* transition : source.getTransitionsFromState(statesList[i]->getId())) {
+            if (!stateId(transition->getTargetId()).empty()) {
+                outgoing.push_back(transition);
+                timed = timed || transition->getTimeout() > 0;
+            }
+        }
+        
+        std::stringstream timeouts;
+        std::stringstream conditions;
+        std::stringstream stateDeadlines;
+        for (Transition* transition : outgoing) {
+            std::string target = stateId(transition->getTargetId());
+            int timeout = transition->getTimeout();
+            std::string consumed = translator.consumedInputs(*transition, "                ");
+            
+            if (transition->getInputConditions().empty()) {
+                // Transitions without conditions only fire on their timeout
+                if (timeout > 0) {
+                    timeouts << "            if (now - stateEntryTime >= std::chrono::milliseconds(" << timeout << ")) {\n"
+                             << "                enterState(" << target << ", now);\n"
+                             << "                return;\n"
+                             << "            }\n";
+                    stateDeadlines << "            deadline = std::min(deadline, stateEntryTime + std::chrono::milliseconds(" << timeout << "));\n";
+                }
+                continue;
+            }
+            
+            int guard = guardCount++;
+            guards << "// Guard of " << statesList[i]->getName() << " -> " << source.getState(transition->getTargetId())->getName() << "\n"
+                   << "bool " << className << "::guard" << guard << "() const {\n"
+                   << translator.guard(*transition, "    ")
+                   << "    return false;\n"
+                   << "}\n\n";
+            
+            if (timeout > 0) {
+                // The timer starts when the guard first holds
+                int timer = timerCount++;
+                timeouts << "            if (timerArmed[" << timer << "] && now - timerStart[" << timer << "] >= std::chrono::milliseconds(" << timeout << ")) {\n"
+                         << consumed
+                         << "                enterState(" << target << ", now);\n"
+                         << "                return;\n"
+                         << "            }\n";
+                conditions << "            if (!timerArmed[" << timer << "] && guard" << guard << "()) {\n"
+                           << "                timerArmed[" << timer << "] = true;\n"
+                           << "                timerStart[" << timer << "] = now;\n"
+                           << "            }\n";
+                stateDeadlines << "            if (timerArmed[" << timer << "]) {\n"
+                               << "                deadline = std::min(deadline, timerStart[" << timer << "] + std::chrono::milliseconds(" << timeout << "));\n"
+                               << "            }\n";
+                continue;
+            }
+            
+            conditions << "            if (guard" << guard << "()) {\n"
+                       << "                settled = false;\n"
+                       << consumed;
+            if (target != current) {
+                conditions << "                enterState(" << target << ", std::chrono::steady_clock::now());\n";
+            }
+            conditions << "                return;\n"
+                       << "            }\n";
+        }
+        
+        ticks << "        case " << current << ": {\n";
+        if (timed) {
+            ticks << "            auto now = std::chrono::steady_clock::now();\n";
+        }
+        ticks << timeouts.str()
+              << "            settled = true;\n"
+              << conditions.str()
+              << "            break;\n"
+              << "        }\n";
+        
+        if (!stateDeadlines.str().empty()) {
+            deadlines << "        case " << current << ":\n"
+                      << stateDeadlines.str()
+                      << "            break;\n";
+        }
+    }
+    
+    header = generateTypedHeader(machine, className, translator, stateIds, guardCount, timerCount);
+    
+    ss << "/**\n"
+       << " * @file Auto-generated FSM implementation\n"
+       << " * @brief Implements the " << className << " class with typed fields and direct transitions\n"
+       << " * @warning This file is auto-generated. Do not modify manually.\n"
+       << " */\n\n"
+       << "#include \"" << headerName << "\"\n"
+       << "#include <algorithm>\n"
+       << "#include <cstdio>\n"
+       << "#include <iterator>\n"
+       << "#include <stdexcept>\n"
+       << "#include <string_view>\n\n"
+       << "namespace {\n"
+       << translator.helperFunctions()
+       << "} // namespace\n\n";
+    
+    // Constructor
+    ss << "// Constructor - initializes the FSM\n"
+       << className << "::" << className << "()\n"
+       << "    : currentState(StateId::" << stateIds[0] << "), stateEntryTime(std::chrono::steady_clock::now()),\n"
+       << "      justEnteredState(true), settled(false)" << (timerCount > 0 ? ", timerArmed{}" : "") << " {\n"
+       << "}\n\n";
+    
+    // Reset method
+    ss << "// Reset the FSM to its initial state\n"
+       << "void " << className << "::reset() {\n";
+    for (const auto& field : translator.getInputFields()) {
+        ss << "    inputs." << field.second << ".clear();\n";
+    }
+    for (const auto& field : translator.getOutputFields()) {
+        ss << "    outputs." << field.second << ".clear();\n";
+    }
+    ss << "    enterState(StateId::" << stateIds[0] << ", std::chrono::steady_clock::now());\n"
+       << "    settled = false;\n"
+       << "}\n\n";
+    
+    // Enter a state
+    ss << "// Enter a state and execute its outputs\n"
+       << "void " << className << "::enterState(StateId state, std::chrono::steady_clock::time_point now) {\n"
+       << "    currentState = state;\n"
+       << "    stateEntryTime = now;\n"
+       << "    justEnteredState = true;\n";
+    if (timerCount > 0) {
+        ss << "    std::fill(std::begin(timerArmed), std::end(timerArmed), false);\n";
+    }
+    ss << "    executeOutputActions();\n"
+       << "}\n\n";
+    
+    // Process step method
+    ss << "// Process a step in the FSM\n"
+       << "void " << className << "::tick() {\n"
+       << "    settled = false;\n"
        << "    \n"
-       << "    std::string expr = currentState->outputExpression;\n"
-       << "    size_t pos = 0, end;\n"
+       << "    // If we just entered this state, skip immediate transition evaluation\n"
+       << "    if (justEnteredState) {\n"
+       << "        justEnteredState = false;\n"
+       << "        return;\n"
+       << "    }\n"
        << "    \n"
-       << "    while ((end = expr.find(';', pos)) != std::string::npos) {\n"
-       << "        std::string action = expr.substr(pos, end - pos);\n"
-       << "        pos = end + 1;\n"
-       << "        \n"
-       << "        // Skip empty actions\n"
-       << "        if (action.empty()) continue;\n"
-       << "        \n"
-       << "        // Handle conditional actions (if inputPtr is defined)\n"
-       << "        std::regex ifPattern(\"(.+) if (.+) is defined\");\n"
-       << "        std::smatch ifMatch;\n"
-       << "        \n"
-       << "        if (std::regex_match(action, ifMatch, ifPattern)) {\n"
-       << "            std::string actualAction = ifMatch[1];\n"
-       << "            std::string inputPtr = ifMatch[2];\n"
-       << "            \n"
-       << "            // Check if input is defined\n"
-       << "            auto inputIt = inputs.find(inputPtr);\n"
-       << "            if (inputIt == inputs.end() || inputIt->second.empty()) {\n"
-       << "                continue; // Skip this action\n"
-       << "            }\n"
-       << "            \n"
-       << "            // Replace action with actual action\n"
-       << "            action = actualAction;\n"
-       << "        }\n"
-       << "        \n"
-       << "        // Handle variable assignments (var = ...)\n"
-       << "        std::regex assignPattern(\"([^=]+)=(.+)\");\n"
-       << "        std::smatch assignMatch;\n"
-       << "        \n"
-       << "        if (std::regex_match(action, assignMatch, assignPattern)) {\n"
-       << "            std::string varName = assignMatch[1];\n"
-       << "            std::string valueExpr = assignMatch[2];\n"
-       << "            \n"
-       << "            // Trim whitespace\n"
-       << "            varName.erase(0, varName.find_first_not_of(\" \\t\\r\\n\"));\n"
-       << "            varName.erase(varName.find_last_not_of(\" \\t\\r\\n\") + 1);\n"
-       << "            valueExpr.erase(0, valueExpr.find_first_not_of(\" \\t\\r\\n\"));\n"
-       << "            valueExpr.erase(valueExpr.find_last_not_of(\" \\t\\r\\n\") + 1);\n"
-       << "            \n"
-       << "            // Check for 'get' expression\n"
-       << "            std::regex getPattern(\"get ([^\\\\s]+)\");\n"
-       << "            std::smatch getMatch;\n"
-       << "            \n"
-       << "            if (std::regex_match(valueExpr, getMatch, getPattern)) {\n"
-       << "                std::string inputPtr = getMatch[1];\n"
-       << "                auto inputIt = inputs.find(inputPtr);\n"
-       << "                \n"
-       << "                if (inputIt != inputs.end()) {\n"
-       << "                    // Find variable type\n"
-       << "                    auto varIt = variables.find(varName);\n"
-       << "                    if (varIt != variables.end()) {\n"
-       << "                        if (std::holds_alternative<int>(varIt->second)) {\n"
-       << "                            try {\n"
-       << "                                variables[varName] = std::stoi(inputIt->second);\n"
-       << "                            } catch (...) {\n"
-       << "                                variables[varName] = 0;\n"
-       << "                            }\n"
-       << "                        } else if (std::holds_alternative<float>(varIt->second)) {\n"
-       << "                            try {\n"
-       << "                                variables[varName] = std::stof(inputIt->second);\n"
-       << "                            } catch (...) {\n"
-       << "                                variables[varName] = 0.0f;\n"
-       << "                            }\n"
-       << "                        } else {\n"
-       << "                            variables[varName] = inputIt->second;\n"
-       << "                        }\n"
-       << "                    } else {\n"
-       << "                        // Default to string\n"
-       << "                        variables[varName] = inputIt->second;\n"
-       << "                    }\n"
-       << "                }\n"
-       << "            } else {\n"
-       << "                // Evaluate expression\n"
-       << "                variables[varName] = evaluateExpression(valueExpr);\n"
-       << "            }\n"
-       << "            \n"
-       << "            continue;\n"
-       << "        }\n"
-       << "        \n"
-       << "        // Handle output expressions (output value to target)\n"
-       << "        std::regex outputPattern(\"output (.+) to (.+)\");\n"
-       << "        std::smatch outputMatch;\n"
-       << "        \n"
-       << "        if (std::regex_match(action, outputMatch, outputPattern)) {\n"
-       << "            std::string value = outputMatch[1];\n"
-       << "            std::string target = outputMatch[2];\n"
-       << "            \n"
-       << "            // Trim whitespace\n"
-       << "            value.erase(0, value.find_first_not_of(\" \\t\\r\\n\"));\n"
-       << "            value.erase(value.find_last_not_of(\" \\t\\r\\n\") + 1);\n"
-       << "            target.erase(0, target.find_first_not_of(\" \\t\\r\\n\"));\n"
-       << "            target.erase(target.find_last_not_of(\" \\t\\r\\n\") + 1);\n"
-       << "            \n"
-       << "            // Evaluate the value if it's an expression\n"
-       << "            if (value.find_first_of(\"+-*/\") != std::string::npos) {\n"
-       << "                auto result = evaluateExpression(value);\n"
-       << "                std::string strResult;\n"
-       << "                \n"
-       << "                if (std::holds_alternative<int>(result)) {\n"
-       << "                    strResult = std::to_string(std::get<int>(result));\n"
-       << "                } else if (std::holds_alternative<float>(result)) {\n"
-       << "                    strResult = std::to_string(std::get<float>(result));\n"
-       << "                } else {\n"
-       << "                    strResult = std::get<std::string>(result);\n"
-       << "                }\n"
-       << "                \n"
-       << "                value = strResult;\n"
-       << "            }\n"
-       << "            \n"
-       << "            outputs[target] = value;\n"
-       << "        }\n"
+       << "    // Expired timeouts first, then the guards in order\n"
+       << "    switch (currentState) {\n"
+       << ticks.str()
        << "    }\n"
        << "}\n\n";
     
-    // Evaluate transition
-ss << "// Evaluate if a transition should be triggered\n"
-   << "bool " << className << "::evaluateTransition(Transition* transition) {\n"
-   << "    // For timeout transitions, check if the timeout is active\n"
-   << "    if (transition->timeout > 0) {\n"
-   << "        // Start the timer if not already started\n"
-   << "        if (activeTimeouts.find(transition) == activeTimeouts.end()) {\n"
-   << "            activeTimeouts[transition] = std::chrono::steady_clock::now();\n"
-   << "            return false; // Wait for timeout\n"
-   << "        }\n"
-   << "    }\n"
-   << "    \n"
-   << "    std::string expr = transition->guardExpression;\n"
-   << "    if (expr.empty()) {\n"
-   << "        return false;\n"
-   << "    }\n"
-   << "    \n"
-   << "    size_t pos = 0, end;\n"
-   << "    bool result = false;\n"
-   << "    \n"
-   << "    while ((end = expr.find(';', pos)) != std::string::npos) {\n"
-   << "        std::string condition = expr.substr(pos, end - pos);\n"
-   << "        pos = end + 1;\n"
-   << "        \n"
-   << "        // Skip empty conditions\n"
-   << "        if (condition.empty()) continue;\n"
-   << "        \n"
-   << "        // Handle boolean expressions (var == value or var != value)\n"
-   << "        std::regex boolPattern(\"(.+) ?(==|!=) ?(.+)\");\n"
-   << "        std::smatch boolMatch;\n"
-   << "        \n"
-   << "        if (std::regex_match(condition, boolMatch, boolPattern)) {\n"
-   << "            std::string leftOp = boolMatch[1];\n"
-   << "            std::string op = boolMatch[2];\n"
-   << "            std::string rightOp = boolMatch[3];\n"
-   << "            \n"
-   << "            // Trim whitespace\n"
-   << "            leftOp.erase(0, leftOp.find_first_not_of(\" \\t\\r\\n\"));\n"
-   << "            leftOp.erase(leftOp.find_last_not_of(\" \\t\\r\\n\") + 1);\n"
-   << "            rightOp.erase(0, rightOp.find_first_not_of(\" \\t\\r\\n\"));\n"
-   << "            rightOp.erase(rightOp.find_last_not_of(\" \\t\\r\\n\") + 1);\n"
-   << "            \n"
-   << "            // Get left operand value\n"
-   << "            auto leftIt = variables.find(leftOp);\n"
-   << "            if (leftIt == variables.end()) {\n"
-   << "                continue; // Skip this condition if variable not found\n"
-   << "            }\n"
-   << "            \n"
-   << "            // Get right operand value\n"
-   << "            VariableType rightValue;\n"
-   << "            auto rightIt = variables.find(rightOp);\n"
-   << "            \n"
-   << "            if (rightIt != variables.end()) {\n"
-   << "                rightValue = rightIt->second;\n"
-   << "            } else {\n"
-   << "                // Try to parse as literal based on left operand type\n"
-   << "                if (std::holds_alternative<int>(leftIt->second)) {\n"
-   << "                    try {\n"
-   << "                        rightValue = std::stoi(rightOp);\n"
-   << "                    } catch (...) {\n"
-   << "                        continue; // Invalid conversion\n"
-   << "                    }\n"
-   << "                } else if (std::holds_alternative<float>(leftIt->second)) {\n"
-   << "                    try {\n"
-   << "                        rightValue = std::stof(rightOp);\n"
-   << "                    } catch (...) {\n"
-   << "                        continue; // Invalid conversion\n"
-   << "                    }\n"
-   << "                } else {\n"
-   << "                    rightValue = rightOp; // String literal\n"
-   << "                }\n"
-   << "            }\n"
-   << "            \n"
-   << "            // Compare values\n"
-   << "            bool conditionMet = false;\n"
-   << "            \n"
-   << "            if (op == \"==\") {\n"
-   << "                conditionMet = (leftIt->second == rightValue);\n"
-   << "            } else { // op == \"!=\"\n"
-   << "                conditionMet = (leftIt->second != rightValue);\n"
-   << "            }\n"
-   << "            \n"
-   << "            result = conditionMet;\n"
-   << "            if (!result) {\n"
-   << "                return false; // If any condition fails, the whole transition fails\n"
-   << "            }\n"
-   << "        }\n"
-   << "        \n"
-   << "        // Handle input conditions (got value from source)\n"
-   << "        std::regex inputPattern(\"got (.+) from (.+)\");\n"
-   << "        std::smatch inputMatch;\n"
-   << "        \n"
-   << "        if (std::regex_match(condition, inputMatch, inputPattern)) {\n"
-   << "            std::string value = inputMatch[1];\n"
-   << "            std::string source = inputMatch[2];\n"
-   << "            \n"
-   << "            // Trim whitespace\n"
-   << "            value.erase(0, value.find_first_not_of(\" \\t\\r\\n\"));\n"
-   << "            value.erase(value.find_last_not_of(\" \\t\\r\\n\") + 1);\n"
-   << "            source.erase(0, source.find_first_not_of(\" \\t\\r\\n\"));\n"
-   << "            source.erase(source.find_last_not_of(\" \\t\\r\\n\") + 1);\n"
-   << "            \n"
-   << "            // Check if input matches\n"
-   << "            auto inputIt = inputs.find(source);\n"
-   << "            if (inputIt != inputs.end() && inputIt->second == value) {\n"
-   << "                result = true;\n"
-   << "            } else {\n"
-   << "                return false; // If any condition fails, the whole transition fails\n"
-   << "            }\n"
-   << "        }\n"
-   << "    }\n"
-   << "    \n"
-   << "    return result;\n"
-   << "}\n\n";
+    // Process input method
+    ss << "// Process an input through the machine\n"
+       << "std::string " << className << "::processInput(const std::string& input, const std::string& inputPtr) {\n";
+    bool first = true;
+    for (const auto& field : translator.getInputFields()) {
+        ss << "    " << (first ? "if" : "} else if") << " (inputPtr == " << ActionTranslator::literal(field.first) << ") {\n"
+           << "        inputs." << field.second << " = input;\n";
+        first = false;
+    }
+    if (!first) {
+        ss << "    }\n";
+    }
+    auto defaultOutput = translator.getOutputFields().find("default");
+    ss << "    justEnteredState = false; // Allow transitions to be evaluated\n"
+       << "    tick();\n"
+       << "    return " << (defaultOutput != translator.getOutputFields().end() ? "outputs." + defaultOutput->second : "std::string()") << ";\n"
+       << "}\n\n";
+    
+    // Next deadline
+    ss << "// Get the time tick() has to be called next\n"
+       << "std::chrono::steady_clock::time_point " << className << "::nextDeadline() const {\n"
+       << "    // A new state or input is evaluated on the next step\n"
+       << "    if (!settled) {\n"
+       << "        return stateEntryTime;\n"
+       << "    }\n"
+       << "    \n"
+       << "    auto deadline = std::chrono::steady_clock::time_point::max();\n"
+       << "    switch (currentState) {\n"
+       << deadlines.str()
+       << "        default:\n"
+       << "            break;\n"
+       << "    }\n"
+       << "    return deadline;\n"
+       << "}\n\n";
+    
+    // State accessors
+    ss << "// Get the current state ID\n"
+       << className << "::StateId " << className << "::getCurrentStateId() const {\n"
+       << "    return currentState;\n"
+       << "}\n\n"
+       << "// Get the current state name\n"
+       << "std::string " << className << "::getCurrentStateName() const {\n"
+       << "    switch (currentState) {\n";
+    for (size_t i = 0; i < statesList.size(); i++) {
+        ss << "        case StateId::" << stateIds[i] << ": return " << ActionTranslator::literal(statesList[i]->getName()) << ";\n";
+    }
+    ss << "    }\n"
+       << "    return \"\";\n"
+       << "}\n\n";
+    
+    // Elapsed keyword
+    ss << "// Get the time spent in the current state\n"
+       << "int " << className << "::elapsedMs() const {\n"
+       << "    return static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(\n"
+       << "        std::chrono::steady_clock::now() - stateEntryTime).count());\n"
+       << "}\n\n";
+    
+    // Output actions
+    ss << "// Execute output actions for the current state\n"
+       << "void " << className << "::executeOutputActions() {\n"
+       << "    switch (currentState) {\n";
+    for (size_t i = 0; i < statesList.size(); i++) {
+        ss << "        case StateId::" << stateIds[i] << ": {\n"
+           << translator.outputs(*statesList[i], "            ")
+           << "            break;\n"
+           << "        }\n";
+    }
+    ss << "    }\n"
+       << "}\n\n"
+       << guards.str();
+    
+    return ss.str();
+}
+
+std::string IncludableGenerator::generateCHeader(const MooreMachine& machine, const std::string& className) {
+    MooreMachine& source = const_cast<MooreMachine&>(machine);
+    const std::string& prefix = className;
+    CActionTranslator translator(machine, prefix);
+    
+    // Initial state first, it is the one reset enters
+    std::vector<State*> statesList = source.getAllStates();
+    if (statesList.empty()) {
+        throw std::runtime_error("Machine has no states");
+    }
+    if (statesList.size() > 0xFFFF) {
+        throw std::runtime_error("The C tables hold at most 65535 states");
+    }
+    auto initial = std::find_if(statesList.begin(), statesList.end(), [](State* state) { return state->getIsInitial(); });
+    if (initial != statesList.end()) {
+        std::iter_swap(statesList.begin(), initial);
+    }
+    
+    std::vector<std::string> stateIds;
+    std::set<std::string> usedIds;
+    std::map<std::string, size_t> stateIndex;
+    for (State* state : statesList) {
+        std::string base = CActionTranslator::identifier(state->getName());
+        std::string id = base;
+        for (int suffix = 2; usedIds.count(id); suffix++) {
+            id = base + "_" + std::to_string(suffix);
+        }
+        usedIds.insert(id);
+        stateIndex[state->getId()] = stateIds.size();
+        stateIds.push_back(id);
+    }
+    
+    // Pointers and symbols are numbered in the order of their enumerators
+    std::map<std::string, size_t> inputIndex;
+    for (const auto& field : translator.getInputFields()) {
+        inputIndex.emplace(field.first, inputIndex.size());
+    }
+    if (inputIndex.size() > 32) {
+        throw std::runtime_error("The C tables hold at most 32 input pointers");
+    }
+    std::map<std::string, size_t> outputIndex;
+    for (const auto& field : translator.getOutputFields()) {
+        outputIndex.emplace(field.first, outputIndex.size());
+    }
+    std::map<std::string, size_t> symbolIndex;
+    for (const auto& field : translator.getSymbolFields()) {
+        symbolIndex.emplace(field.first, symbolIndex.size() + 1);
+    }
+    size_t inputs = inputIndex.size();
+    size_t outputs = outputIndex.size();
+    size_t symbols = symbolIndex.size() + 2;
+    std::string symbolType = symbols <= 0x100 ? "uint8_t" : "uint16_t";
+    
+    auto mask = [](uint32_t value) {
+        std::stringstream hex;
+        hex << "0x" << std::uppercase << std::hex << value << "u";
+        return hex.str();
+    };
+    auto bit = [](size_t index) {
+        return static_cast<uint32_t>(1) << index;
+    };
+    
+    std::stringstream transitionRows;
+    std::stringstream stateRows;
+    std::stringstream functions;
+    std::vector<std::vector<std::string>> outputRows(statesList.size(), std::vector<std::string>(std::max<size_t>(outputs, 1), "NULL"));
+    std::vector<std::vector<size_t>> dispatch(statesList.size() * std::max<size_t>(inputs, 1), std::vector<size_t>(symbols, SIZE_MAX));
+    size_t transitionCount = 0;
+    size_t maxCount = 0;
+    size_t maxTimers = 0;
+    int guardCount = 0;
+    
+    for (size_t i = 0; i < statesList.size(); i++) {
+        State* state = statesList[i];
+        size_t first = transitionCount;
+        size_t count = 0;
+        size_t timers = 0;
+        uint32_t timeouts = 0;
+        bool guarded = false;
+        bool timed = false;
+        
+        for (Transition* transition : source.getTransitionsFromState(state->getId())) {
+            auto target = stateIndex.find(transition->getTargetId());
+            if (target == stateIndex.end()) {
+                continue;
+            }
+            const auto& conditions = transition->getInputConditions();
+            int timeout = transition->getTimeout();
+            size_t rank = count++;
+            
+            // Pure timeouts and timed guards each get a timer slot of the state
+            size_t timer = 0;
+            if (timeout > 0) {
+                timer = timers++;
+                if (timers > 32) {
+                    throw std::runtime_error("State " + state->getName() + " has more than 32 timed transitions");
+                }
+            }
+            
+            uint32_t consumed = 0;
+            bool boolean = false;
+            for (const auto& condition : conditions) {
+                boolean = boolean || condition.isBooleanExpr;
+                auto input = inputIndex.find(condition.source);
+                if (!condition.isBooleanExpr && input != inputIndex.end()) {
+                    consumed |= bit(input->second);
+                }
+            }
+            
+            std::string kind;
+            if (conditions.empty()) {
+                kind = timeout > 0 ? "TIMEOUT" : "NEVER";
+                if (timeout > 0) {
+                    timeouts |= bit(timer);
+                }
+            } else {
+                kind = timeout > 0 ? "TIMED" : "IMMEDIATE";
+                timed = timed || timeout > 0;
+            }
+            
+            // The dispatch table finds the first immediate transition a symbol fires
+            if (kind == "IMMEDIATE") {
+                for (const auto& condition : conditions) {
+                    auto input = inputIndex.find(condition.source);
+                    auto symbol = symbolIndex.find(condition.value);
+                    if (condition.isBooleanExpr || input == inputIndex.end() || symbol == symbolIndex.end()) {
+                        continue;
+                    }
+                    size_t& entry = dispatch[i * std::max<size_t>(inputs, 1) + input->second][symbol->second];
+                    entry = std::min(entry, rank);
+                }
+            }
+            
+            // Conditions on variables, and timed transitions which arm on any condition, need a guard call
+            std::string guard = "NULL";
+            if (kind == "TIMED" || (kind == "IMMEDIATE" && boolean)) {
+                guarded = guarded || kind == "IMMEDIATE";
+                guard = prefix + "_guard_" + std::to_string(guardCount++);
+                std::string body = translator.guard(*transition, "    ");
+                functions << "/* Guard of " << state->getName() << " -> " << statesList[target->second]->getName() << " */\n"
+                          << "static inline bool " << guard << "(const " << prefix << "* fsm) {\n"
+                          << (body.empty() ? "    (void)fsm;\n" : body)
+                          << "    return false;\n"
+                          << "}\n\n";
+            }
+            
+            transitionRows << "    {" << target->second << ", " << prefix << "_KIND_" << kind << ", " << timer << ", "
+                           << std::max(timeout, 0) << "u, " << mask(consumed) << ", " << guard << "}, /* "
+                           << state->getName() << " -> " << statesList[target->second]->getName() << " */\n";
+        }
+        transitionCount += count;
+        if (transitionCount > 0xFFFF) {
+            throw std::runtime_error("The C tables hold at most 65535 transitions");
+        }
+        maxCount = std::max(maxCount, count);
+        maxTimers = std::max(maxTimers, timers);
+        
+        // Constant outputs go to the output table, the others to an entry function
+        std::string enter = "NULL";
+        std::map<std::string, std::string> constant;
+        if (translator.constantOutputs(*state, constant)) {
+            for (const auto& output : constant) {
+                outputRows[i][outputIndex.at(output.first)] = ActionTranslator::literal(output.second);
+            }
+        } else {
+            enter = prefix + "_enter_" + std::to_string(i);
+            std::string body = translator.outputs(*state, "    ");
+            functions << "/* Outputs of " << state->getName() << " */\n"
+                      << "static inline const char* " << enter << "(" << prefix << "* fsm) {\n"
+                      << (body.empty() ? "    (void)fsm;\n" : body)
+                      << "    return NULL;\n"
+                      << "}\n\n";
+        }
+        
+        stateRows << "    {" << first << ", " << count << ", " << mask(timeouts) << ", " << (guarded ? "true" : "false") << ", "
+                  << (timed ? "true" : "false") << ", " << enter << "}, /* " << state->getName() << " */\n";
+    }
+    
+    bool wideRanks = maxCount >= 0xFF;
+    std::string rankType = wideRanks ? "uint16_t" : "uint8_t";
+    std::string noRank = wideRanks ? "0xFFFFu" : "0xFFu";
+    std::string P = prefix;
+    std::string guardName = P + "_H";
+    std::transform(guardName.begin(), guardName.end(), guardName.begin(), [](unsigned char c) { return std::toupper(c); });
+    
+    std::stringstream ss;
+    ss << "/**\n"
+       << " * @file Auto-generated FSM header\n"
+       << " * @brief Defines the " << P << " machine, generated from a Moore machine\n"
+       << " *\n"
+       << " * Freestanding C99, also valid C++. Declare a " << P << ", call " << P << "_init, then\n"
+       << " * " << P << "_set_input and " << P << "_step for every input and " << P << "_advance to run\n"
+       << " * timeouts. Times are milliseconds of any clock that wraps around at 2^32.\n"
+       << " * Every function is static inline, so the header holds the whole machine.\n"
+       << " * @warning This file is auto-generated. Do not modify manually.\n"
+       << " */\n\n"
+       << "#ifndef " << guardName << "\n"
+       << "#define " << guardName << "\n\n"
+       << "#include <float.h>\n"
+       << "#include <limits.h>\n"
+       << "#include <stdbool.h>\n"
+       << "#include <stddef.h>\n"
+       << "#include <stdint.h>\n\n"
+       << "/* Bytes of every text buffer, longer text is cut */\n"
+       << "#ifndef " << P << "_TEXT_CAPACITY\n"
+       << "#define " << P << "_TEXT_CAPACITY 64\n"
+       << "#endif\n\n";
+    
+    // Counts and enumerators
+    ss << "#define " << P << "_STATES " << statesList.size() << "\n"
+       << "#define " << P << "_INPUTS " << inputs << "\n"
+       << "#define " << P << "_OUTPUTS " << outputs << "\n"
+       << "#define " << P << "_SYMBOLS " << symbols << "\n"
+       << "#define " << P << "_TIMERS " << std::max<size_t>(maxTimers, 1) << "\n"
+       << "#define " << P << "_NO_RANK " << noRank << "\n\n"
+       << "/* States, the initial state first */\n"
+       << "enum {\n";
+    for (size_t i = 0; i < stateIds.size(); i++) {
+        ss << "    " << P << "_STATE_" << stateIds[i] << (i + 1 < stateIds.size() ? "," : "") << "\n";
+    }
+    ss << "};\n\n";
+    if (inputs > 0) {
+        ss << "/* Input pointers */\n"
+           << "enum {\n";
+        size_t i = 0;
+        for (const auto& field : translator.getInputFields()) {
+            ss << "    " << P << "_INPUT_" << field.second << (++i < inputs ? "," : "") << " /* " << field.first << " */\n";
+        }
+        ss << "};\n\n";
+    }
+    if (outputs > 0) {
+        ss << "/* Output pointers */\n"
+           << "enum {\n";
+        size_t i = 0;
+        for (const auto& field : translator.getOutputFields()) {
+            ss << "    " << P << "_OUTPUT_" << field.second << (++i < outputs ? "," : "") << " /* " << field.first << " */\n";
+        }
+        ss << "};\n\n";
+    }
+    ss << "/* Input symbols, NONE for an empty pointer and OTHER for text no condition waits for */\n"
+       << "enum {\n"
+       << "    " << P << "_SYMBOL_NONE,\n";
+    for (const auto& field : translator.getSymbolFields()) {
+        ss << "    " << P << "_SYMBOL_" << field.second << ", /* " << field.first << " */\n";
+    }
+    ss << "    " << P << "_SYMBOL_OTHER\n"
+       << "};\n\n"
+       << "/* Kinds of transitions */\n"
+       << "enum {\n"
+       << "    " << P << "_KIND_NEVER,     /* No conditions and no timeout */\n"
+       << "    " << P << "_KIND_TIMEOUT,   /* Fires a fixed time after the state is entered */\n"
+       << "    " << P << "_KIND_IMMEDIATE, /* Fires as soon as a condition holds */\n"
+       << "    " << P << "_KIND_TIMED      /* Fires once a condition held for the timeout */\n"
+       << "};\n\n";
+    
+    // Types
+    ss << "typedef " << symbolType << " " << P << "_symbol;\n"
+       << "typedef " << rankType << " " << P << "_rank;\n\n"
+       << "/* Machine variables, kept across " << P << "_reset */\n"
+       << "typedef struct " << P << "_variables {\n";
+    for (const auto& field : translator.getVariableFields()) {
+        ss << "    " << translator.variableDeclaration(field.first) << " /* " << field.first << " */\n";
+    }
+    if (translator.getVariableFields().empty()) {
+        ss << "    char unused;\n";
+    }
+    ss << "} " << P << "_variables;\n\n"
+       << "/* A running machine, all fields but inputs and variables are read only */\n"
+       << "typedef struct " << P << " {\n"
+       << "    uint16_t state;              /* Current state, one of " << P << "_STATE_ */\n"
+       << "    bool just_entered;           /* The next step only completes the entry */\n"
+       << "    bool settled;                /* Nothing fires before an input or a timer */\n"
+       << "    uint32_t now;                /* Time of the last step */\n"
+       << "    uint32_t entered_at;         /* Time the state was entered */\n"
+       << "    uint32_t armed;              /* Timer slots of the state that are running */\n"
+       << "    uint32_t due[" << P << "_TIMERS];     /* Expiry of each running timer */\n"
+       << "    " << P << "_symbol inputs[" << std::max<size_t>(inputs, 1) << "]; /* Symbol waiting on each input pointer */\n";
+    if (translator.readsInputText()) {
+        ss << "    char input_text[" << std::max<size_t>(inputs, 1) << "][" << P << "_TEXT_CAPACITY]; /* Text waiting on each input pointer */\n";
+    }
+    ss << "    const char* outputs[" << std::max<size_t>(outputs, 1) << "]; /* Text of each output pointer */\n";
+    if (translator.writesOutputText()) {
+        ss << "    char output_text[" << std::max<size_t>(outputs, 1) << "][" << P << "_TEXT_CAPACITY]; /* Computed output text */\n";
+    }
+    ss << "    " << P << "_variables variables;\n"
+       << "    const char* error;           /* First failed output statement since reset, or NULL */\n"
+       << "} " << P << ";\n\n"
+       << "/* A transition, those of a state are consecutive and in the order they are checked */\n"
+       << "typedef struct " << P << "_transition {\n"
+       << "    uint16_t target;   /* Entered state */\n"
+       << "    uint8_t kind;      /* One of " << P << "_KIND_ */\n"
+       << "    uint8_t timer;     /* Timer slot of TIMEOUT and TIMED transitions */\n"
+       << "    uint32_t timeout;  /* Milliseconds */\n"
+       << "    uint32_t consumed; /* Input pointers cleared when it fires */\n"
+       << "    bool (*guard)(const struct " << P << "* fsm); /* Conditions the dispatch table cannot decide, or NULL */\n"
+       << "} " << P << "_transition;\n\n"
+       << "/* A state */\n"
+       << "typedef struct " << P << "_state_info {\n"
+       << "    uint16_t first;    /* Index of its first transition */\n"
+       << "    uint16_t count;    /* Number of its transitions */\n"
+       << "    uint32_t timeouts; /* Timer slots armed on entry */\n"
+       << "    bool guarded;      /* Some immediate transition has a guard */\n"
+       << "    bool timed;        /* Some transition is TIMED */\n"
+       << "    const char* (*enter)(struct " << P << "* fsm); /* Computed outputs, or NULL for the output table */\n"
+       << "} " << P << "_state_info;\n\n";
+    
+    ss << translator.helperFunctions() << "\n"
+       << "/* Guards and outputs */\n\n"
+       << functions.str();
+    
+    // Tables
+    ss << "static const " << P << "_transition " << P << "_transitions[" << std::max<size_t>(transitionCount, 1) << "] = {\n"
+       << (transitionCount > 0 ? transitionRows.str() : "    {0, " + P + "_KIND_NEVER, 0, 0u, 0x0u, NULL}\n")
+       << "};\n\n"
+       << "static const " << P << "_state_info " << P << "_states[" << P << "_STATES] = {\n"
+       << stateRows.str()
+       << "};\n\n"
+       << "/* Rank of the first immediate transition a symbol on an input fires, by state */\n"
+       << "static const " << P << "_rank " << P << "_dispatch[" << P << "_STATES][" << std::max<size_t>(inputs, 1) << "]["
+       << P << "_SYMBOLS] = {\n";
+    for (size_t i = 0; i < statesList.size(); i++) {
+        ss << "    {";
+        for (size_t input = 0; input < std::max<size_t>(inputs, 1); input++) {
+            ss << (input ? ", " : "") << "{";
+            const std::vector<size_t>& row = dispatch[i * std::max<size_t>(inputs, 1) + input];
+            for (size_t symbol = 0; symbol < symbols; symbol++) {
+                ss << (symbol ? ", " : "") << (row[symbol] == SIZE_MAX ? noRank : std::to_string(row[symbol]));
+            }
+            ss << "}";
+        }
+        ss << "}" << (i + 1 < statesList.size() ? "," : "") << " /* " << statesList[i]->getName() << " */\n";
+    }
+    ss << "};\n\n"
+       << "/* Literal each state writes to each output pointer on entry, or NULL */\n"
+       << "static const char* const " << P << "_output_table[" << P << "_STATES][" << std::max<size_t>(outputs, 1) << "] = {\n";
+    for (size_t i = 0; i < statesList.size(); i++) {
+        ss << "    {";
+        for (size_t output = 0; output < outputRows[i].size(); output++) {
+            ss << (output ? ", " : "") << outputRows[i][output];
+        }
+        ss << "}" << (i + 1 < statesList.size() ? "," : "") << "\n";
+    }
+    ss << "};\n\n"
+       << "static const char* const " << P << "_state_names[" << P << "_STATES] = {\n";
+    for (size_t i = 0; i < statesList.size(); i++) {
+        ss << "    " << ActionTranslator::literal(statesList[i]->getName()) << (i + 1 < statesList.size() ? "," : "") << "\n";
+    }
+    auto nameTable = [&](const std::string& name, const std::map<std::string, std::string>& fields) {
+        ss << "static const char* const " << P << name << "[" << std::max<size_t>(fields.size(), 1) << "] = {";
+        if (fields.empty()) {
+            ss << "\"\"";
+        }
+        size_t i = 0;
+        for (const auto& field : fields) {
+            ss << (i++ ? ", " : "") << ActionTranslator::literal(field.first);
+        }
+        ss << "};\n\n";
+    };
+    ss << "};\n\n";
+    nameTable("_input_names", translator.getInputFields());
+    nameTable("_output_names", translator.getOutputFields());
+    ss << "static const char* const " << P << "_symbol_names[" << P << "_SYMBOLS] = {\"\"";
+    for (const auto& field : translator.getSymbolFields()) {
+        ss << ", " << ActionTranslator::literal(field.first);
+    }
+    ss << ", \"\"};\n\n";
+    
+    // Functions running the tables
+    std::string api = R"===(/* Clears the input pointers a transition consumed */
+static inline void PREFIX_consume(PREFIX* fsm, uint32_t consumed) {
+    int i;
+    for (i = 0; i < PREFIX_INPUTS; i++) {
+        if ((consumed >> i) & 1u) {
+            fsm->inputs[i] = PREFIX_SYMBOL_NONE;
+INPUT_TEXT            fsm->input_text[i][0] = '\0';
+        }
+    }
+}
+
+/* Enters a state at the time of the last step: arms its timeouts and writes its outputs */
+static inline void PREFIX_enter(PREFIX* fsm, uint16_t state) {
+    const PREFIX_state_info* info = &PREFIX_states[state];
+    int i;
+    fsm->state = state;
+    fsm->entered_at = fsm->now;
+    fsm->just_entered = true;
+    fsm->settled = false;
+    fsm->armed = info->timeouts;
+    for (i = 0; i < info->count; i++) {
+        const PREFIX_transition* transition = &PREFIX_transitions[info->first + i];
+        if (transition->kind == PREFIX_KIND_TIMEOUT) {
+            fsm->due[transition->timer] = fsm->now + transition->timeout;
+        }
+    }
+    if (info->enter) {
+        const char* error = info->enter(fsm);
+        if (error && !fsm->error) {
+            fsm->error = error;
+        }
+    } else {
+        for (i = 0; i < PREFIX_OUTPUTS; i++) {
+            if (PREFIX_output_table[state][i]) {
+                fsm->outputs[i] = PREFIX_output_table[state][i];
+            }
+        }
+    }
+}
+
+/* Clears the inputs and outputs and enters the initial state, variables are kept */
+static inline void PREFIX_reset(PREFIX* fsm, uint32_t now) {
+    int i;
+    for (i = 0; i < PREFIX_INPUTS; i++) {
+        fsm->inputs[i] = PREFIX_SYMBOL_NONE;
+INPUT_TEXT        fsm->input_text[i][0] = '\0';
+    }
+    for (i = 0; i < PREFIX_OUTPUTS; i++) {
+        fsm->outputs[i] = "";
+    }
+    fsm->error = NULL;
+    fsm->now = now;
+    PREFIX_enter(fsm, 0);
+}
+
+/* Sets the variables to their initial values and resets the machine */
+static inline void PREFIX_init(PREFIX* fsm, uint32_t now) {
+VARIABLES    PREFIX_reset(fsm, now);
+}
+
+/* Sets the symbol waiting on an input pointer, the text of OTHER is not kept */
+static inline void PREFIX_set_symbol(PREFIX* fsm, int input, int symbol) {
+    fsm->inputs[input] = (PREFIX_symbol)symbol;
+INPUT_TEXT    PREFIX_copy(fsm->input_text[input], PREFIX_symbol_names[symbol]);
+    fsm->just_entered = false;
+    fsm->settled = false;
+}
+
+/* Sets the text waiting on an input pointer, an empty text clears it */
+static inline void PREFIX_set_input(PREFIX* fsm, int input, const char* text) {
+    int symbol = text[0] ? PREFIX_SYMBOL_OTHER : PREFIX_SYMBOL_NONE;
+    int i;
+    for (i = 1; i < PREFIX_SYMBOL_OTHER; i++) {
+        if (PREFIX_text_equal(PREFIX_symbol_names[i], text)) {
+            symbol = i;
+            break;
+        }
+    }
+    fsm->inputs[input] = (PREFIX_symbol)symbol;
+INPUT_TEXT    PREFIX_copy(fsm->input_text[input], text);
+    fsm->just_entered = false;
+    fsm->settled = false;
+}
+
+/*
+ * Makes a step at the given time, like MachineSimulator::processInputs:
+ * the earliest expired timer fires, or else the first immediate transition
+ * whose condition holds, or else the timed transitions arm and disarm.
+ * Returns true if a state was entered.
+ */
+static inline bool PREFIX_step(PREFIX* fsm, uint32_t now) {
+    const PREFIX_state_info* info = &PREFIX_states[fsm->state];
+    const PREFIX_transition* transitions = &PREFIX_transitions[info->first];
+    unsigned int best = PREFIX_NO_RANK;
+    int expired = -1;
+    int i;
+    fsm->now = now;
+    if (fsm->just_entered) {
+        fsm->just_entered = false;
+        return false;
+    }
+
+    for (i = 0; fsm->armed && i < info->count; i++) {
+        const PREFIX_transition* transition = &transitions[i];
+        uint32_t due = fsm->due[transition->timer];
+        if ((transition->kind == PREFIX_KIND_TIMEOUT || transition->kind == PREFIX_KIND_TIMED) &&
+            ((fsm->armed >> transition->timer) & 1u) && (int32_t)(now - due) >= 0 &&
+            (expired < 0 || (int32_t)(due - fsm->due[transitions[expired].timer]) < 0)) {
+            expired = i;
+        }
+    }
+    if (expired >= 0) {
+        PREFIX_consume(fsm, transitions[expired].consumed);
+        PREFIX_enter(fsm, transitions[expired].target);
+        return true;
+    }
 
-// Evaluate expression
-ss << "// Evaluate a simple arithmetic expression\n"
-   << className << "::VariableType " << className << "::evaluateExpression(const std::string& expression) {\n"
-   << "    // Simple expression evaluation (no precedence)\n"
-   << "    std::vector<std::string> tokens = tokenize(expression);\n"
-   << "    \n"
-   << "    if (tokens.empty()) {\n"
-   << "        return std::string(\"\");\n"
-   << "    }\n"
-   << "    \n"
-   << "    VariableType result;\n"
-   << "    std::string currentOp = \"+\"; // Default operation\n"
-   << "    bool firstToken = true;\n"
-   << "    \n"
-   << "    for (size_t i = 0; i < tokens.size(); i++) {\n"
-   << "        const std::string& token = tokens[i];\n"
-   << "        \n"
-   << "        // Skip empty tokens\n"
-   << "        if (token.empty()) continue;\n"
-   << "        \n"
-   << "        // Handle operators\n"
-   << "        if (token == \"+\" || token == \"-\" || token == \"*\" || token == \"/\") {\n"
-   << "            currentOp = token;\n"
-   << "            continue;\n"
-   << "        }\n"
-   << "        \n"
-   << "        // Get token value\n"
-   << "        VariableType tokenValue;\n"
-   << "        \n"
-   << "        // Check if token is a variable\n"
-   << "        auto varIt = variables.find(token);\n"
-   << "        if (varIt != variables.end()) {\n"
-   << "            tokenValue = varIt->second;\n"
-   << "        }\n"
-   << "        // Check if token is 'elapsed' keyword\n"
-   << "        else if (token == \"elapsed\") {\n"
-   << "            auto now = std::chrono::steady_clock::now();\n"
-   << "            auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - stateEntryTime).count();\n"
-   << "            tokenValue = static_cast<int>(elapsed);\n"
-   << "        }\n"
-   << "        // Try to parse as number\n"
-   << "        else {\n"
-   << "            try {\n"
-   << "                // Check if it's a floating point number\n"
-   << "                if (token.find('.') != std::string::npos) {\n"
-   << "                    tokenValue = std::stof(token);\n"
-   << "                } else {\n"
-   << "                    tokenValue = std::stoi(token);\n"
-   << "                }\n"
-   << "            } catch (...) {\n"
-   << "                // Default to string\n"
-   << "                tokenValue = token;\n"
-   << "            }\n"
-   << "        }\n"
-   << "        \n"
-   << "        // Set initial result or apply operation\n"
-   << "        if (firstToken) {\n"
-   << "            result = tokenValue;\n"
-   << "            firstToken = false;\n"
-   << "        } else {\n"
-   << "            // Integer operations\n"
-   << "            if (std::holds_alternative<int>(result) && std::holds_alternative<int>(tokenValue)) {\n"
-   << "                int val1 = std::get<int>(result);\n"
-   << "                int val2 = std::get<int>(tokenValue);\n"
-   << "                \n"
-   << "                if (currentOp == \"+\") result = val1 + val2;\n"
-   << "                else if (currentOp == \"-\") result = val1 - val2;\n"
-   << "                else if (currentOp == \"*\") result = val1 * val2;\n"
-   << "                else if (currentOp == \"/\") {\n"
-   << "                    if (val2 == 0) result = 0; // Prevent division by zero\n"
-   << "                    else result = val1 / val2;\n"
-   << "                }\n"
-   << "            }\n"
-   << "            // Float operations (at least one operand is float)\n"
-   << "            else if ((std::holds_alternative<float>(result) || std::holds_alternative<int>(result)) &&\n"
-   << "                     (std::holds_alternative<float>(tokenValue) || std::holds_alternative<int>(tokenValue))) {\n"
-   << "                \n"
-   << "                float val1 = std::holds_alternative<float>(result) ?\n"
-   << "                            std::get<float>(result) : static_cast<float>(std::get<int>(result));\n"
-   << "                            \n"
-   << "                float val2 = std::holds_alternative<float>(tokenValue) ?\n"
-   << "                            std::get<float>(tokenValue) : static_cast<float>(std::get<int>(tokenValue));\n"
-   << "                \n"
-   << "                if (currentOp == \"+\") result = val1 + val2;\n"
-   << "                else if (currentOp == \"-\") result = val1 - val2;\n"
-   << "                else if (currentOp == \"*\") result = val1 * val2;\n"
-   << "                else if (currentOp == \"/\") {\n"
-   << "                    if (val2 == 0.0f) result = 0.0f; // Prevent division by zero\n"
-   << "                    else result = val1 / val2;\n"
-   << "                }\n"
-   << "            }\n"
-   << "            // String concatenation\n"
-   << "            else if (currentOp == \"+\") {\n"
-   << "                // Convert both values to strings\n"
-   << "                std::string val1;\n"
-   << "                if (std::holds_alternative<int>(result)) {\n"
-   << "                    val1 = std::to_string(std::get<int>(result));\n"
-   << "                } else if (std::holds_alternative<float>(result)) {\n"
-   << "                    val1 = std::to_string(std::get<float>(result));\n"
-   << "                } else {\n"
-   << "                    val1 = std::get<std::string>(result);\n"
-   << "                }\n"
-   << "                \n"
-   << "                std::string val2;\n"
-   << "                if (std::holds_alternative<int>(tokenValue)) {\n"
-   << "                    val2 = std::to_string(std::get<int>(tokenValue));\n"
-   << "                } else if (std::holds_alternative<float>(tokenValue)) {\n"
-   << "                    val2 = std::to_string(std::get<float>(tokenValue));\n"
-   << "                } else {\n"
-   << "                    val2 = std::get<std::string>(tokenValue);\n"
-   << "                }\n"
-   << "                \n"
-   << "                result = val1 + val2;\n"
-   << "            }\n"
-   << "        }\n"
-   << "    }\n"
-   << "    \n"
-   << "    return result;\n"
-   << "}\n\n";
+    for (i = 0; i < PREFIX_INPUTS; i++) {
+        unsigned int rank = PREFIX_dispatch[fsm->state][i][fsm->inputs[i]];
+        if (rank < best) {
+            best = rank;
+        }
+    }
+    for (i = 0; info->guarded && i < info->count && (unsigned int)i < best; i++) {
+        if (transitions[i].kind == PREFIX_KIND_IMMEDIATE && transitions[i].guard && transitions[i].guard(fsm)) {
+            best = (unsigned int)i;
+        }
+    }
+    if (best != PREFIX_NO_RANK) {
+        PREFIX_consume(fsm, transitions[best].consumed);
+        PREFIX_enter(fsm, transitions[best].target);
+        return true;
+    }
 
-// Tokenize helper
-ss << "// Split an expression into tokens\n"
-   << "std::vector<std::string> " << className << "::tokenize(const std::string& expr) {\n"
-   << "    std::vector<std::string> tokens;\n"
-   << "    std::string currentToken;\n"
-   << "    \n"
-   << "    for (size_t i = 0; i < expr.length(); i++) {\n"
-   << "        char c = expr[i];\n"
-   << "        \n"
-   << "        // Skip whitespace\n"
-   << "        if (std::isspace(c)) {\n"
-   << "            if (!currentToken.empty()) {\n"
-   << "                tokens.push_back(currentToken);\n"
-   << "                currentToken.clear();\n"
-   << "            }\n"
-   << "            continue;\n"
-   << "        }\n"
-   << "        \n"
-   << "        // Handle operators\n"
-   << "        if (c == '+' || c == '-' || c == '*' || c == '/') {\n"
-   << "            if (!currentToken.empty()) {\n"
-   << "                tokens.push_back(currentToken);\n"
-   << "                currentToken.clear();\n"
-   << "            }\n"
-   << "            tokens.push_back(std::string(1, c));\n"
-   << "            continue;\n"
-   << "        }\n"
-   << "        \n"
-   << "        // Handle numbers and identifiers\n"
-   << "        currentToken += c;\n"
-   << "    }\n"
-   << "    \n"
-   << "    // Add the last token if any\n"
-   << "    if (!currentToken.empty()) {\n"
-   << "        tokens.push_back(currentToken);\n"
-   << "    }\n"
-   << "    \n"
-   << "    return tokens;\n"
-   << "}\n\n";
+    for (i = 0; info->timed && i < info->count; i++) {
+        const PREFIX_transition* transition = &transitions[i];
+        uint32_t slot = (uint32_t)1 << transition->timer;
+        if (transition->kind != PREFIX_KIND_TIMED) {
+            continue;
+        }
+        if (!transition->guard(fsm)) {
+            fsm->armed &= ~slot;
+        } else if (!(fsm->armed & slot)) {
+            fsm->armed |= slot;
+            fsm->due[transition->timer] = now + transition->timeout;
+        }
+    }
+    fsm->settled = true;
+    return false;
+}
+
+/* Gets the time of the next step, false if nothing happens before the next input */
+static inline bool PREFIX_next_deadline(const PREFIX* fsm, uint32_t* deadline) {
+    const PREFIX_state_info* info = &PREFIX_states[fsm->state];
+    bool found = false;
+    int i;
+    if (!fsm->settled) {
+        *deadline = fsm->now;
+        return true;
+    }
+    for (i = 0; fsm->armed && i < info->count; i++) {
+        const PREFIX_transition* transition = &PREFIX_transitions[info->first + i];
+        uint32_t due = fsm->due[transition->timer];
+        if ((transition->kind == PREFIX_KIND_TIMEOUT || transition->kind == PREFIX_KIND_TIMED) &&
+            ((fsm->armed >> transition->timer) & 1u) && (!found || (int32_t)(due - *deadline) < 0)) {
+            *deadline = due;
+            found = true;
+        }
+    }
+    return found;
+}
 
-// Check timeouts
-ss << "// Check for timeout transitions\n"
-   << "bool " << className << "::checkTimeouts() {\n"
-   << "    auto now = std::chrono::steady_clock::now();\n"
-   << "    bool transitionOccurred = false;\n"
-   << "    \n"
-   << "    for (Transition* transition : transitions) {\n"
-   << "        if (transition->fromState != currentState) {\n"
-   << "            continue;\n"
-   << "        }\n"
-   << "        \n"
-   << "        if (transition->timeout > 0) {\n"
-   << "            auto it = activeTimeouts.find(transition);\n"
-   << "            if (it != activeTimeouts.end()) {\n"
-   << "                auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - it->second).count();\n"
-   << "                \n"
-   << "                if (elapsed >= transition->timeout) {\n"
-   << "                    // Timeout triggered - transition to target state\n"
-   << "                    State* oldState = currentState;\n"
-   << "                    currentState = transition->toState;\n"
-   << "                    \n"
-   << "                    stateEntryTime = now;\n"
-   << "                    activeTimeouts.clear();\n"
-   << "                    \n"
-   << "                    // Execute output actions\n"
-   << "                    executeOutputActions();\n"
-   << "                    transitionOccurred = true;\n"
-   << "                    \n"
-   << "                    break;\n"
-   << "                }\n"
-   << "            }\n"
-   << "        }\n"
-   << "    }\n"
-   << "    \n"
-   << "    return transitionOccurred;\n"
-   << "}\n\n";
+/* Moves the clock to the next step and makes it, false if none is due by the limit */
+static inline bool PREFIX_advance(PREFIX* fsm, uint32_t* clock, uint32_t limit) {
+    uint32_t deadline = 0;
+    if (!PREFIX_next_deadline(fsm, &deadline) || (int32_t)(deadline - limit) > 0) {
+        return false;
+    }
+    if ((int32_t)(deadline - *clock) > 0) {
+        *clock = deadline;
+    }
+    PREFIX_step(fsm, *clock);
+    return true;
+}
 
-// Run with gotos - the main function for computed goto style
-ss << "// Run the state machine using the GNU computed goto extension\n"
-   << "void " << className << "::runWithGotos() {\n"
-   << "#if USE_COMPUTED_GOTO\n"
-   << "    if (!currentState) {\n"
-   << "        reset();\n"
-   << "        return;\n"
-   << "    }\n"
-   << "    \n"
-   << "    // Dispatch based on current state\n"
-   << "    StateId stateId = currentState->id;\n"
-   << "    \n"
-   << "    // Use direct access with check\n"
-   << "    try {\n"
-   << "        void* target = stateTargets.at(stateId);\n"
-   << "        if (target != nullptr) {\n"
-   << "            // Jump to the registered label\n"
-   << "            goto *target;\n"
-   << "            return;\n"
-   << "        }\n"
-   << "    } catch (const std::exception&) {\n"
-   << "        // Handle missing state targets safely\n"
-   << "    }\n"
-   << "    \n"
-   << "    // Default behavior if no target is registered or exception occurred\n"
-   << "    tick();\n"
-   << "#else\n"
-   << "    // Fallback for compilers without computed goto support\n"
-   << "    tick();\n"
-   << "#endif\n"
-   << "}\n";
+/* Gets the milliseconds spent in the current state at the last step */
+static inline int PREFIX_elapsed(const PREFIX* fsm) {
+    return (int)(fsm->now - fsm->entered_at);
+}
 
-   ss << "// Clear inputs that triggered a transition\n"
-   << "void " << className << "::clearTriggeredInputs(Transition* transition) {\n"
-   << "    if (!transition) return;\n"
-   << "    \n"
-   << "    // Iterate through all input conditions in the transition\n"
-   << "    std::string expr = transition->guardExpression;\n"
-   << "    size_t pos = 0, end;\n"
-   << "    \n"
-   << "    while ((end = expr.find(';', pos)) != std::string::npos) {\n"
-   << "        std::string condition = expr.substr(pos, end - pos);\n"
-   << "        pos = end + 1;\n"
-   << "        \n"
-   << "        // Skip empty conditions\n"
-   << "        if (condition.empty()) continue;\n"
-   << "        \n"
-   << "        // Only clear non-boolean inputs (got X from Y conditions)\n"
-   << "        std::regex inputPattern(\"got (.+) from (.+)\");\n"
-   << "        std::smatch inputMatch;\n"
-   << "        \n"
-   << "        if (std::regex_match(condition, inputMatch, inputPattern)) {\n"
-   << "            std::string value = inputMatch[1];\n"
-   << "            std::string source = inputMatch[2];\n"
-   << "            \n"
-   << "            // Trim whitespace\n"
-   << "            source.erase(0, source.find_first_not_of(\" \\t\\r\\n\"));\n"
-   << "            source.erase(source.find_last_not_of(\" \\t\\r\\n\") + 1);\n"
-   << "            \n"
-   << "            // Clear the input that triggered this transition\n"
-   << "            inputs[source] = \"\";\n"
-   << "        }\n"
-   << "    }\n"
-   << "}\n\n";
+/* Gets the name of the current state */
+static inline const char* PREFIX_state_name(const PREFIX* fsm) {
+    return PREFIX_state_names[fsm->state];
+}
 
-   ss << "void* CounterFSM::getStateTarget(StateId id) const {\n"
-      << "    auto it = stateTargets.find(id);\n"
-      << "    if (it != stateTargets.end()) {\n"
-      << "        return it->second;\n"
-      << "    }\n"
-      << "    return nullptr;\n"
-      << "}\n\n";
+/* Finds an input pointer by name, -1 if there is none */
+static inline int PREFIX_find_input(const char* name) {
+    int i;
+    for (i = 0; i < PREFIX_INPUTS; i++) {
+        if (PREFIX_text_equal(PREFIX_input_names[i], name)) {
+            return i;
+        }
+    }
+    return -1;
+}
 
-   return ss.str();
-}
\ No newline at end of file
+/* Finds an output pointer by name, -1 if there is none */
+static inline int PREFIX_find_output(const char* name) {
+    int i;
+    for (i = 0; i < PREFIX_OUTPUTS; i++) {
+        if (PREFIX_text_equal(PREFIX_output_names[i], name)) {
+            return i;
+        }
+    }
+    return -1;
+}
+)===";
+    
+    // Lines only some machines need are marked in the template
+    std::stringstream variables;
+    for (const auto& field : translator.getVariableFields()) {
+        variables << "    " << translator.variableInitialization(field.first) << "\n";
+    }
+    auto fill = [](std::string text, const std::string& token, const std::string& value) {
+        for (size_t at = text.find(token); at != std::string::npos; at = text.find(token, at + value.size())) {
+            text.replace(at, token.size(), value);
+        }
+        return text;
+    };
+    api = fill(api, "PREFIX", P);
+    if (translator.readsInputText()) {
+        api = fill(api, "INPUT_TEXT", "");
+    } else {
+        std::stringstream kept;
+        std::istringstream lines(api);
+        for (std::string line; std::getline(lines, line);) {
+            if (line.rfind("INPUT_TEXT", 0) != 0) {
+                kept << line << "\n";
+            }
+        }
+        api = kept.str();
+    }
+    api = fill(api, "VARIABLES", variables.str());
+    ss << api << "\n"
+       << "#endif /* " << guardName << " */\n";
+    
+    return ss.str();
+}
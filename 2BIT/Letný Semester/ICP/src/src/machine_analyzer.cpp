@@ -0,0 +1,221 @@
+/**
+ * @file machine_analyzer.cpp
+ * @brief Implementation of the MachineAnalyzer class
+ * @author Hugo Bohácsek (xbohach00)
+ */
+
+#include "../headers/machine_analyzer.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <utility>
+#include "../headers/transition_table.h"
+
+using namespace std::chrono;
+
+/** Number of states below which a worker thread is not worth starting */
+static constexpr int STATES_PER_WORKER = 4096;
+
+/**
+ * @struct RangeFindings
+ * @brief Findings of one worker over its range of states
+ */
+struct RangeFindings {
+    std::vector<int> deadStates;             /**< Indices of dead states */
+    std::vector<int> trapStates;             /**< Indices of trap states */
+    std::vector<TransitionOverlap> overlaps; /**< Overlapping transitions */
+};
+
+/**
+ * @brief Marks the states reachable from a state in a bitset
+ *
+ * @param table Compiled transitions of the machine
+ * @param start Index of the initial state
+ * @return One bit per state, set for reachable states
+ */
+static std::vector<uint64_t> markReachable(const TransitionTable& table, int start) {
+    std::vector<uint64_t> reached((table.getStateCount() + 63) / 64, 0);
+    std::vector<int> pending{start};
+    reached[start / 64] |= uint64_t(1) << (start % 64);
+
+    while (!pending.empty()) {
+        int state = pending.back();
+        pending.pop_back();
+
+        TransitionSpan outgoing = table.getOutgoing(state);
+        for (size_t i = 0; i < outgoing.size(); i++) {
+            int target = table.getTarget(outgoing.offset + static_cast<int>(i));
+            uint64_t bit = uint64_t(1) << (target % 64);
+            if (!(reached[target / 64] & bit)) {
+                reached[target / 64] |= bit;
+                pending.push_back(target);
+            }
+        }
+    }
+    return reached;
+}
+
+/**
+ * @brief Checks a range of states for dead and trap states and overlaps
+ *
+ * @param table Compiled transitions of the machine
+ * @param begin Index of the first state of the range
+ * @param end One past the index of the last state of the range
+ * @param findings Where the findings are added
+ */
+static void checkStates(const TransitionTable& table, int begin, int end, RangeFindings& findings) {
+    // (pointer, symbol) key, transition index and condition index of every condition of a state
+    std::vector<std::pair<uint64_t, std::pair<int, int>>> conditions;
+
+    for (int state = begin; state < end; state++) {
+        TransitionSpan outgoing = table.getOutgoing(state);
+        if (outgoing.empty()) {
+            findings.deadStates.push_back(state);
+            continue;
+        }
+
+        bool onlyLoops = true;
+        conditions.clear();
+        for (size_t i = 0; i < outgoing.size(); i++) {
+            int transition = outgoing.offset + static_cast<int>(i);
+            onlyLoops = onlyLoops && table.getTarget(transition) == state;
+
+            const auto& inputs = outgoing.first[i]->getInputConditions();
+            for (size_t k = 0; k < inputs.size(); k++) {
+                if (inputs[k].isBooleanExpr) {
+                    continue;
+                }
+                uint64_t key = static_cast<uint64_t>(table.getPointerIndex(inputs[k].source)) << 32 |
+                               static_cast<uint32_t>(table.getSymbolIndex(inputs[k].value));
+                conditions.push_back({key, {transition, static_cast<int>(k)}});
+            }
+        }
+        if (onlyLoops) {
+            findings.trapStates.push_back(state);
+        }
+
+        // Equal keys end up next to each other, ordered by transition
+        std::sort(conditions.begin(), conditions.end());
+        for (size_t i = 0; i < conditions.size();) {
+            size_t groupEnd = i + 1;
+            while (groupEnd < conditions.size() && conditions[groupEnd].first == conditions[i].first) {
+                groupEnd++;
+            }
+
+            // A transition may list the same condition twice, look for another transition
+            size_t other = i + 1;
+            while (other < groupEnd && conditions[other].second.first == conditions[i].second.first) {
+                other++;
+            }
+            if (other < groupEnd) {
+                const Transition* first = table.getTransition(conditions[i].second.first);
+                const Transition* second = table.getTransition(conditions[other].second.first);
+                const InputCondition& input = first->getInputConditions()[conditions[i].second.second];
+                findings.overlaps.push_back(TransitionOverlap{table.getStateId(state), input.source, input.value,
+                                                              first->getId(), second->getId()});
+            }
+            i = groupEnd;
+        }
+    }
+}
+
+/**
+ * @brief Constructor
+ *
+ * @param machine The machine to analyse, must outlive the analyzer
+ * @param threadCount Number of worker threads, 0 for one per hardware thread
+ */
+MachineAnalyzer::MachineAnalyzer(MooreMachine& machine, int threadCount)
+    : machine(machine), threadCount(threadCount) {
+    if (this->threadCount <= 0) {
+        this->threadCount = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    }
+}
+
+/**
+ * @brief Analyses the machine
+ *
+ * @return Findings, each list in the order of MooreMachine::getStateHandles()
+ */
+MachineAnalysis MachineAnalyzer::analyze() const {
+    auto start = steady_clock::now();
+    MachineAnalysis analysis{};
+
+    // Hold the table so the workers can read it without going through the machine
+    std::shared_ptr<const TransitionTable> table = machine.getTransitionTable();
+    int states = table->getStateCount();
+    analysis.states = static_cast<size_t>(states);
+    analysis.transitions = static_cast<size_t>(table->getTransitionCount());
+
+    // Without an initial state nothing is reachable
+    State* initial = machine.getInitialState();
+    std::vector<uint64_t> reached((states + 63) / 64, 0);
+    if (initial) {
+        reached = markReachable(*table, table->getStateIndex(initial->getId()));
+    }
+    for (int state = 0; state < states; state++) {
+        if (!(reached[state / 64] & (uint64_t(1) << (state % 64)))) {
+            analysis.unreachableStates.push_back(table->getStateId(state));
+        }
+    }
+
+    // Split the states into contiguous ranges, one per worker
+    int workers = std::max(1, std::min(threadCount, states / STATES_PER_WORKER));
+    std::vector<RangeFindings> findings(workers);
+    auto worker = [&](int id) {
+        int begin = static_cast<int>(static_cast<long long>(states) * id / workers);
+        int end = static_cast<int>(static_cast<long long>(states) * (id + 1) / workers);
+        checkStates(*table, begin, end, findings[id]);
+    };
+
+    std::vector<std::thread> threads;
+    for (int id = 1; id < workers; id++) {
+        threads.emplace_back(worker, id);
+    }
+    worker(0);
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    for (RangeFindings& range : findings) {
+        for (int state : range.deadStates) {
+            analysis.deadStates.push_back(table->getStateId(state));
+        }
+        for (int state : range.trapStates) {
+            analysis.trapStates.push_back(table->getStateId(state));
+        }
+        for (TransitionOverlap& overlap : range.overlaps) {
+            analysis.overlaps.push_back(std::move(overlap));
+        }
+    }
+
+    analysis.seconds = duration<double>(steady_clock::now() - start).count();
+    return analysis;
+}
+
+/**
+ * @brief Describes the findings of an analysis
+ *
+ * @param analysis Results of analyze()
+ * @return One warning per finding, empty if there is nothing to report
+ */
+std::vector<std::string> MachineAnalyzer::describe(const MachineAnalysis& analysis) {
+    std::vector<std::string> warnings;
+    for (const std::string& state : analysis.unreachableStates) {
+        warnings.push_back("State " + state + " is unreachable from the initial state");
+    }
+    for (const std::string& state : analysis.deadStates) {
+        warnings.push_back("State " + state + " has no outgoing transitions");
+    }
+    for (const std::string& state : analysis.trapStates) {
+        warnings.push_back("State " + state + " only has transitions back to itself");
+    }
+    for (const TransitionOverlap& overlap : analysis.overlaps) {
+        warnings.push_back("Input " + overlap.value + " on " + overlap.inputPtr + " in state " + overlap.stateId +
+                           " enables both " + overlap.firstId + " and " + overlap.secondId +
+                           ", only " + overlap.firstId + " is taken");
+    }
+    return warnings;
+}
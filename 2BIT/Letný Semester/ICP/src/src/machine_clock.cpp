@@ -0,0 +1,97 @@
+/**
+ * @file machine_clock.cpp
+ * @brief Implementation of the clocks driving machine time
+ * @author Hugo Bohácsek (xbohach00)
+ */
+
+#include "../headers/machine_clock.h"
+#include <thread>
+
+/**
+ * @brief Gets the shared instance used by default
+ *
+ * @return Reference to the system clock
+ */
+SystemClock& SystemClock::instance() {
+    static SystemClock clock;
+    return clock;
+}
+
+/**
+ * @brief Gets the current time
+ *
+ * @return Current steady clock time
+ */
+MachineClock::TimePoint SystemClock::now() const {
+    return std::chrono::steady_clock::now();
+}
+
+/**
+ * @brief Sleeps the calling thread until the given time
+ *
+ * @param deadline Time to wait for
+ */
+void SystemClock::sleepUntil(TimePoint deadline) {
+    std::this_thread::sleep_until(deadline);
+}
+
+/**
+ * @brief Checks whether the clock runs on virtual time
+ *
+ * @return Always false
+ */
+bool SystemClock::isVirtual() const {
+    return false;
+}
+
+/**
+ * @brief Constructor, starts the clock at the epoch
+ */
+VirtualClock::VirtualClock() : current() {}
+
+/**
+ * @brief Gets the current time
+ *
+ * @return Current virtual time
+ */
+MachineClock::TimePoint VirtualClock::now() const {
+    return current;
+}
+
+/**
+ * @brief Moves the clock forward to the given time
+ *
+ * @param deadline Time to move to, the clock never moves backwards
+ */
+void VirtualClock::sleepUntil(TimePoint deadline) {
+    if (deadline > current) {
+        current = deadline;
+    }
+}
+
+/**
+ * @brief Checks whether the clock runs on virtual time
+ *
+ * @return Always true
+ */
+bool VirtualClock::isVirtual() const {
+    return true;
+}
+
+/**
+ * @brief Moves the clock forward by the given amount of time
+ *
+ * @param duration How far to move
+ */
+void VirtualClock::advance(std::chrono::milliseconds duration) {
+    current += duration;
+}
+
+/**
+ * @brief Sets the clock to the given time, also backwards
+ *
+ * @param time New virtual time
+ */
+void VirtualClock::set(TimePoint time) {
+    current = time;
+}
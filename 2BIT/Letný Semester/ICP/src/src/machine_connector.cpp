@@ -4,6 +4,7 @@
 
 #include "../headers/machine_connector.h"
 #include "../headers/fsm_bridge.h"
+#include "../headers/machine_clock.h"
 
 /**
  * @brief Constructor
@@ -11,7 +12,7 @@
  * @param comm Pointer to the UDP Communication bridge class
  * @param fsmBridge Pointer to the parent FSMBridge class
  */
-MachineConnector::MachineConnector(MooreMachine* machine, CommBridge* comm, FSMBridge* fsmBridge) : machine(machine), comm(comm), fsmBridge(fsmBridge), currentStateId("") {}
+MachineConnector::MachineConnector(MooreMachine* machine, CommBridge* comm, FSMBridge* fsmBridge) : machine(machine), comm(comm), fsmBridge(fsmBridge), currentStateId(""), expectedSequence(0), synchronized(false), lastResync(), traceWriter(nullptr) {}
 
 /**
  * @brief Sets new pointer to the internal representation of a Moore Machine
@@ -21,6 +22,29 @@ void MachineConnector::setNewMachine(MooreMachine *machinePtr) {
     machine = machinePtr;
 }
 
+/**
+ * @brief Sets where inputs and received changes are recorded
+ * @param writer Trace writer owned by the caller, nullptr to stop recording
+ */
+void MachineConnector::setTraceWriter(TraceWriter* writer) {
+    traceWriter = writer;
+    if (!traceWriter || !synchronized) {
+        return;
+    }
+
+    // How long the automaton has been in its state is not sent, count from now
+    auto now = SystemClock::instance().now();
+    std::vector<std::pair<std::string, std::string>> inputs(inputValues.begin(), inputValues.end());
+    std::vector<std::pair<std::string, std::string>> outputs(outputValues.begin(), outputValues.end());
+    std::vector<std::pair<std::string, std::string>> variables;
+    if (machine) {
+        for (const auto& [name, variable] : machine->getVariablesView()) {
+            variables.emplace_back(name, variable.getValueString());
+        }
+    }
+    traceWriter->recordSync(now, currentStateId, now, inputs, outputs, variables);
+}
+
 /**
  * @brief Sets the new value of an input and sends it to the generated executable automaton
  * @param inputPtr Name of the input
@@ -28,11 +52,15 @@ void MachineConnector::setNewMachine(MooreMachine *machinePtr) {
  */
 void MachineConnector::setInput(const std::string &inputPtr, const std::string &value) {
     inputValues[inputPtr] = value;
-    std::string msg = {static_cast<char>(0x01)};
-    msg += "\r\n";
-    msg += inputPtr + "\r\n";
-    msg += value + "\r\n";
-    comm->send(QString::fromStdString(msg));
+    if (traceWriter) {
+        traceWriter->recordInput(SystemClock::instance().now(), inputPtr, value);
+    }
+    WireWriter datagram = comm->createDatagram();
+    datagram.beginRecord(WireProtocol::INPUT);
+    datagram.writeString(inputPtr);
+    datagram.writeString(value);
+    datagram.endRecord();
+    comm->send(datagram);
 }
 
 /**
@@ -68,119 +96,170 @@ std::string MachineConnector::getCurrentStateId() const {
 }
 
 /**
- * @brief Handles received UDP message from generated executable automaton
- * @param msg Message from the generated executable automaton
+ * @brief Handles received UDP datagram from generated executable automaton
+ *
+ * Deltas are applied only while the sequence numbers follow each other.
+ * A gap or a malformed datagram drops the synchronization and requests
+ * a snapshot, deltas are ignored until it arrives. A delta arriving while
+ * unsynchronized repeats the request, at most once per RESYNC_INTERVAL.
+ *
+ * @param datagram Datagram from the generated executable automaton
  */
-void MachineConnector::handleReceivedMessage(const QString& msg) {
-    std::string msgStr = msg.toStdString();
-    switch (msgStr[0]){
-        // Changed state message
-        case 0x03: {
-            std::string newStateId = msgStr.substr(3, msgStr.find("\r\n", 2) - 3);
-            currentStateId = newStateId;
+void MachineConnector::handleReceivedMessage(const std::string& datagram) {
+    try {
+        WireReader reader(datagram);
+        WireProtocol::RecordType type;
+        bool first = true;
+        while (reader.nextRecord(type)) {
+            // A snapshot restarts the numbering, it always comes alone
+            if (first && type == WireProtocol::SNAPSHOT) {
+                applySnapshot(reader);
+                expectedSequence = reader.getSequence() + 1;
+                synchronized = true;
+                return;
             }
-            break;
-        // Changed variable value message
-        case 0x04: {
-            auto delimiter = msgStr.find("\r\n", 2);
-            std::string variableName = msgStr.substr(3, delimiter - 3);
-            auto valueEnd = msgStr.find("\r\n", delimiter + 2);
-            std::string value = msgStr.substr(delimiter + 2, valueEnd - delimiter - 2);
+            if (first) {
+                if (!synchronized) {
+                    // The request or the snapshot may have been lost, ask again while deltas keep coming
+                    if (SystemClock::instance().now() - lastResync >= RESYNC_INTERVAL) {
+                        requestResync();
+                    }
+                    return;
+                }
+                if (reader.getSequence() != expectedSequence) {
+                    qWarning() << "Missed datagrams" << expectedSequence << "to" << reader.getSequence() - 1 << ", resynchronizing";
+                    requestResync();
+                    return;
+                }
+                expectedSequence++;
+                first = false;
             }
-            break;
-        // Changed output value message
-        case 0x05: {
-            auto delimiter = msgStr.find("\r\n", 2);
-            std::string outputPtr = msgStr.substr(3, delimiter - 3);
-            auto valueEnd = msgStr.find("\r\n", delimiter + 2);
-            std::string value = msgStr.substr(delimiter + 2, valueEnd - delimiter - 2);
-            outputValues[outputPtr] = value;
+            switch (type) {
+                // Changed state record
+                case WireProtocol::STATE:
+                    currentStateId = readSlot(reader, stateSlots);
+                    if (traceWriter) {
+                        traceWriter->recordState(SystemClock::instance().now(), currentStateId);
+                    }
+                    break;
+                // Changed variable value record
+                case WireProtocol::VARIABLE: {
+                    const std::string& name = readSlot(reader, variableSlots);
+                    std::string value = reader.readString();
+                    setVariable(name, value);
+                    if (traceWriter) {
+                        traceWriter->recordVariable(SystemClock::instance().now(), name, value);
+                    }
+                    }
+                    break;
+                // Changed output value record
+                case WireProtocol::OUTPUT: {
+                    const std::string& outputPtr = readSlot(reader, outputSlots);
+                    outputValues[outputPtr] = reader.readString();
+                    if (traceWriter) {
+                        traceWriter->recordOutput(SystemClock::instance().now(), outputPtr, outputValues[outputPtr]);
+                    }
+                    }
+                    break;
+                default:
+                    break;
             }
-            break;
-        // Initial information message
-        case 0x06: {
-            // Retrieve path of the text representation of the generated automaton
-            auto pathEnd = msgStr.find("\r\n", 2);
-            std::string fsmDefinitionPath = msgStr.substr(3, pathEnd - 3);
-            // Load automaton representation
-            fsmBridge->loadMachineFromFile(QString::fromStdString(fsmDefinitionPath));
-            // Retrieve information about the current state
-            auto currentStateEnd = msgStr.find("\r\n", pathEnd + 2);
-            std::string currentStateIdStr = msgStr.substr(pathEnd + 2, currentStateEnd - pathEnd - 2);
-            currentStateId = currentStateIdStr;
-            // Retrieve information about current input values
-            auto inputsLenEnd = msgStr.find("\r\n", currentStateEnd + 2);
-            int inputsLen = std::stoi(msgStr.substr(currentStateEnd + 2, inputsLenEnd - currentStateEnd - 2));
-            std::string inputs = msgStr.substr(inputsLenEnd + 2, inputsLen);
-            parseIncomingInputs(inputs);
-            // Retrieve information about current output values
-            auto outputsLenEnd = msgStr.find("\r\n", inputsLenEnd + 2 + inputsLen);
-            int outputsLen = std::stoi(msgStr.substr(inputsLenEnd + 2 + inputsLen, outputsLenEnd - inputsLenEnd + inputsLen));
-            std::string outputs = msgStr.substr(outputsLenEnd + 2, outputsLen);
-            parseIncomingOutputs(outputs);
-            // Retrieve information about current variable values
-            auto variablesLenEnd = msgStr.find("\r\n", outputsLenEnd + 2 + outputsLen);
-            int variablesLen = std::stoi(msgStr.substr(outputsLenEnd+ 2 + outputsLen, variablesLenEnd - outputsLenEnd + outputsLen));
-            std::string variables = msgStr.substr(variablesLenEnd + 2, variablesLen);
-            parseIncomingVariables(variables);
-            }
-            break;
+        }
+    } catch (const std::exception& e) {
+        qWarning() << "Malformed datagram:" << e.what();
+        requestResync();
     }
 }
 
 /**
- * @brief Parses values of all inputs from the initial information UDP message
- * @param inputs Inputs information section of the initial information UDP message
+ * @brief Applies a snapshot, loading the automaton and all current values
+ * @param reader Reader positioned at the payload of a snapshot record
  */
-void MachineConnector::parseIncomingInputs(std::string inputs) {
-    size_t startpos = 0, endpos, valpos, valendpos;
-    std::string inputPtr, value;
-    while ((endpos = inputs.find("\r\n", startpos)) != std::string::npos){
-        inputPtr = inputs.substr(startpos, endpos - startpos);
-        valpos = endpos + 2;
-        valendpos = inputs.find("\r\n", valpos);
-        value = inputs.substr(valpos, valendpos - valpos);
-        startpos = valendpos + 2;
+void MachineConnector::applySnapshot(WireReader& reader) {
+    // Retrieve path of the text representation of the generated automaton
+    std::string fsmDefinitionPath = reader.readString();
+    // Slots of the states, the current state follows
+    stateSlots.assign(reader.readU16(), "");
+    for (std::string& name : stateSlots) {
+        name = reader.readString();
+    }
+    std::string currentStateName = readSlot(reader, stateSlots);
+    // Inputs, outputs and variables come as name and value pairs in slot order
+    std::vector<std::pair<std::string, std::string>> inputs, outputs, variables;
+    for (auto* section : {&inputs, &outputs, &variables}) {
+        section->resize(reader.readU16());
+        for (auto& [name, value] : *section) {
+            name = reader.readString();
+            value = reader.readString();
+        }
+    }
+
+    // Load automaton representation once the whole snapshot is known to be valid
+    fsmBridge->loadMachineFromFile(QString::fromStdString(fsmDefinitionPath));
+    currentStateId = currentStateName;
+    inputSlots.clear();
+    for (const auto& [inputPtr, value] : inputs) {
+        inputSlots.push_back(inputPtr);
         inputValues[inputPtr] = value;
     }
+    outputSlots.clear();
+    for (const auto& [outputPtr, value] : outputs) {
+        outputSlots.push_back(outputPtr);
+        outputValues[outputPtr] = value;
+    }
+    variableSlots.clear();
+    for (const auto& [name, value] : variables) {
+        variableSlots.push_back(name);
+        setVariable(name, value);
+    }
+
+    // Changes may have been missed, so the recording starts over from the snapshot
+    if (traceWriter) {
+        auto now = SystemClock::instance().now();
+        traceWriter->recordSync(now, currentStateId, now, inputs, outputs, variables);
+    }
 }
 
 /**
- * @brief Parses values of all outputs from the initial information UDP message
- * @param outputs Outputs information section of the initial information UDP message
+ * @brief Reads a slot and looks it up
+ * @param reader Reader positioned at the slot
+ * @param names Names by slot
+ * @return Name stored in the slot
+ * @throw std::runtime_error If the slot is out of range
  */
-void MachineConnector::parseIncomingOutputs(std::string outputs) {
-    size_t startpos = 0, endpos, valpos, valendpos;
-    std::string outputPtr, value;
-    while ((endpos = outputs.find("\r\n", startpos)) != std::string::npos){
-        outputPtr = outputs.substr(startpos, endpos - startpos);
-        valpos = endpos + 2;
-        valendpos = outputs.find("\r\n", valpos);
-        value = outputs.substr(valpos, valendpos - valpos);
-        startpos = valendpos + 2;
-        outputValues[outputPtr] = value;
+const std::string& MachineConnector::readSlot(WireReader& reader, const std::vector<std::string>& names) {
+    uint16_t slot = reader.readU16();
+    if (slot >= names.size()) {
+        throw std::runtime_error("Unknown slot " + std::to_string(slot));
     }
+    return names[slot];
 }
 
 /**
- * @brief Parses values of all variables from the initial information UDP message
- * @param outputs Variables information section of the initial information UDP message
+ * @brief Stores the value of a variable of the machine
+ * @param name Name of the variable
+ * @param value New value of the variable as text
  */
-void MachineConnector::parseIncomingVariables(std::string variables) {
-    size_t startpos = 0, endpos, valpos, valendpos;
-    std::string variablePtr, value;
-    while ((endpos = variables.find("\r\n", startpos)) != std::string::npos){
-        variablePtr = variables.substr(startpos, endpos - startpos);
-        valpos = endpos + 2;
-        valendpos = variables.find("\r\n", valpos);
-        value = variables.substr(valpos, valendpos - valpos);
-        startpos = valendpos + 2;
-        if (std::regex_match(value, std::regex("^[+-]?([0-9]*[.])[0-9]*$"))){
-            machine->getVariable(variablePtr)->setValue(value);
-        }else if (std::regex_match(value, std::regex("^[+-]?([0-9]*)$"))){
-            machine->getVariable(variablePtr)->setValue(value);
-        }else{
-            machine->getVariable(variablePtr)->setValue(value);
-        }
+void MachineConnector::setVariable(const std::string& name, const std::string& value) {
+    MachineVariable* variable = machine ? machine->getVariable(name) : nullptr;
+    if (!variable) {
+        return;
+    }
+    try {
+        variable->setValue(value);
+    } catch (const std::exception& e) {
+        qWarning() << "Invalid value of variable" << QString::fromStdString(name) << ":" << e.what();
     }
 }
+
+/**
+ * @brief Asks the generated executable automaton for a new snapshot
+ */
+void MachineConnector::requestResync() {
+    synchronized = false;
+    lastResync = SystemClock::instance().now();
+    WireWriter datagram = comm->createDatagram();
+    datagram.beginRecord(WireProtocol::RESYNC);
+    datagram.endRecord();
+    comm->send(datagram);
+}
@@ -0,0 +1,266 @@
+/**
+ * @file machine_equivalence.cpp
+ * @brief Implementation of the EquivalenceChecker class
+ * @author Hugo Bohácsek (xbohach00)
+ */
+
+#include "../headers/machine_equivalence.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include "../headers/transition_table.h"
+
+using namespace std::chrono;
+
+/**
+ * @class PairSet
+ * @brief Open addressing set of packed state pairs
+ */
+class PairSet {
+private:
+    static constexpr uint64_t EMPTY = ~uint64_t(0); /**< Marks a free slot, no pair packs to it */
+
+    std::vector<uint64_t> slots; /**< Pairs by hash, linear probing */
+    size_t count = 0;            /**< Number of pairs stored */
+
+    /**
+     * @brief Spreads the bits of a pair over the whole word
+     *
+     * @param pair Packed pair
+     * @return Hash of the pair
+     */
+    static uint64_t hash(uint64_t pair) {
+        pair ^= pair >> 33;
+        pair *= 0xff51afd7ed558ccdULL;
+        pair ^= pair >> 33;
+        return pair;
+    }
+
+    /**
+     * @brief Doubles the number of slots and puts the pairs back
+     */
+    void grow() {
+        std::vector<uint64_t> old(slots.size() * 2, EMPTY);
+        old.swap(slots);
+        size_t mask = slots.size() - 1;
+        for (uint64_t pair : old) {
+            if (pair == EMPTY) {
+                continue;
+            }
+            size_t slot = hash(pair) & mask;
+            while (slots[slot] != EMPTY) {
+                slot = (slot + 1) & mask;
+            }
+            slots[slot] = pair;
+        }
+    }
+
+public:
+    PairSet() : slots(1024, EMPTY) {}
+
+    /**
+     * @brief Adds a pair
+     *
+     * @param pair Packed pair
+     * @return True if the pair was not in the set yet
+     */
+    bool insert(uint64_t pair) {
+        // Keep the set at most half full so probe runs stay short
+        if ((count + 1) * 2 > slots.size()) {
+            grow();
+        }
+        size_t mask = slots.size() - 1;
+        size_t slot = hash(pair) & mask;
+        while (slots[slot] != EMPTY) {
+            if (slots[slot] == pair) {
+                return false;
+            }
+            slot = (slot + 1) & mask;
+        }
+        slots[slot] = pair;
+        count++;
+        return true;
+    }
+};
+
+/**
+ * @struct PairNode
+ * @brief Entry of the search queue
+ */
+struct PairNode {
+    int left;   /**< State index in the left machine */
+    int right;  /**< State index in the right machine */
+    int parent; /**< Queue position of the pair this one was reached from, -1 for the start */
+    int letter; /**< Letter leading here from the parent */
+};
+
+/**
+ * @struct LetterIndices
+ * @brief Pointer and symbol indices of a letter in one machine's table
+ */
+struct LetterIndices {
+    int pointer; /**< Input pointer index, TransitionTable::NONE if the machine never reads it */
+    int symbol;  /**< Input symbol index, TransitionTable::NONE if the machine never expects it */
+};
+
+/**
+ * @brief Assigns each state of a machine the class of its output list
+ *
+ * @param machine The machine
+ * @param table Compiled transitions of the machine
+ * @param classes Class by output signature, shared by both machines
+ * @return Output class of each state index
+ */
+static std::vector<int> classifyOutputs(MooreMachine& machine, const TransitionTable& table,
+                                        std::unordered_map<std::string, int>& classes) {
+    std::vector<int> outputClass(table.getStateCount());
+    std::string signature;
+    for (int state = 0; state < table.getStateCount(); state++) {
+        signature.clear();
+        for (const OutputCondition& output : machine.getState(table.getStateId(state))->getOutputs()) {
+            signature += output.value + '\x1f' + output.target + '\x1f' + output.inputPtr + '\x1f' +
+                         (output.hasCondition ? '1' : '0') + '\x1f';
+        }
+        outputClass[state] = classes.emplace(signature, static_cast<int>(classes.size())).first->second;
+    }
+    return outputClass;
+}
+
+/**
+ * @brief Constructor
+ *
+ * @param left First machine, must outlive the checker
+ * @param right Second machine, must outlive the checker
+ * @param pairLimit Number of pairs after which the search gives up, 0 for no limit
+ */
+EquivalenceChecker::EquivalenceChecker(MooreMachine& left, MooreMachine& right, size_t pairLimit)
+    : left(left), right(right), pairLimit(pairLimit) {}
+
+/**
+ * @brief Compares the machines
+ *
+ * @return Whether they are equivalent, with a distinguishing trace if not
+ * @throws std::runtime_error If either machine has no initial state
+ */
+EquivalenceResult EquivalenceChecker::check() const {
+    auto start = steady_clock::now();
+    EquivalenceResult result{true, true, {}, "", "", 0, 0};
+
+    State* leftInitial = left.getInitialState();
+    State* rightInitial = right.getInitialState();
+    if (!leftInitial || !rightInitial) {
+        throw std::runtime_error("Cannot compare a machine without an initial state");
+    }
+
+    std::shared_ptr<const TransitionTable> leftTable = left.getTransitionTable();
+    std::shared_ptr<const TransitionTable> rightTable = right.getTransitionTable();
+
+    // Intern the input pointer and value pairs read by either machine as letters
+    std::unordered_map<std::string, int> letterIndices;
+    std::vector<EquivalenceStep> letters;
+    for (const TransitionTable* table : {leftTable.get(), rightTable.get()}) {
+        for (int transition = 0; transition < table->getTransitionCount(); transition++) {
+            for (const auto& input : table->getTransition(transition)->getInputConditions()) {
+                if (input.isBooleanExpr) {
+                    continue;
+                }
+                if (letterIndices.emplace(input.source + '\x1f' + input.value,
+                                          static_cast<int>(letters.size())).second) {
+                    letters.push_back(EquivalenceStep{input.source, input.value});
+                }
+            }
+        }
+    }
+    std::vector<LetterIndices> leftLetters, rightLetters;
+    for (const EquivalenceStep& letter : letters) {
+        leftLetters.push_back({leftTable->getPointerIndex(letter.inputPtr), leftTable->getSymbolIndex(letter.value)});
+        rightLetters.push_back({rightTable->getPointerIndex(letter.inputPtr), rightTable->getSymbolIndex(letter.value)});
+    }
+
+    std::unordered_map<std::string, int> classes;
+    std::vector<int> leftOutput = classifyOutputs(left, *leftTable, classes);
+    std::vector<int> rightOutput = classifyOutputs(right, *rightTable, classes);
+
+    // Pairs pack into one number, dense over the right machine's states
+    uint64_t rightStates = static_cast<uint64_t>(rightTable->getStateCount());
+    auto pack = [rightStates](int l, int r) {
+        return static_cast<uint64_t>(l) * rightStates + static_cast<uint64_t>(r);
+    };
+
+    PairSet visited;
+    std::vector<PairNode> queue;
+    int leftStart = leftTable->getStateIndex(leftInitial->getId());
+    int rightStart = rightTable->getStateIndex(rightInitial->getId());
+    visited.insert(pack(leftStart, rightStart));
+    queue.push_back(PairNode{leftStart, rightStart, -1, -1});
+
+    int differing = -1;
+    for (size_t head = 0; head < queue.size(); head++) {
+        PairNode node = queue[head];
+        if (leftOutput[node.left] != rightOutput[node.right]) {
+            differing = static_cast<int>(head);
+            break;
+        }
+        if (pairLimit > 0 && queue.size() >= pairLimit) {
+            result.complete = false;
+            continue;
+        }
+
+        for (int letter = 0; letter < static_cast<int>(letters.size()); letter++) {
+            int l = leftTable->getNextState(node.left, leftLetters[letter].pointer, leftLetters[letter].symbol);
+            int r = rightTable->getNextState(node.right, rightLetters[letter].pointer, rightLetters[letter].symbol);
+            l = l == TransitionTable::NONE ? node.left : l;
+            r = r == TransitionTable::NONE ? node.right : r;
+            if (visited.insert(pack(l, r))) {
+                queue.push_back(PairNode{l, r, static_cast<int>(head), letter});
+            }
+        }
+    }
+    result.pairsVisited = differing >= 0 ? static_cast<size_t>(differing) + 1 : queue.size();
+
+    // Walk back from the differing pair to recover the inputs leading to it
+    if (differing >= 0) {
+        result.equivalent = false;
+        result.leftState = leftTable->getStateId(queue[differing].left);
+        result.rightState = rightTable->getStateId(queue[differing].right);
+        for (int node = differing; queue[node].parent >= 0; node = queue[node].parent) {
+            result.trace.push_back(letters[queue[node].letter]);
+        }
+        std::reverse(result.trace.begin(), result.trace.end());
+    } else if (!result.complete) {
+        result.equivalent = false;
+    }
+
+    result.seconds = duration<double>(steady_clock::now() - start).count();
+    return result;
+}
+
+/**
+ * @brief Describes the outcome of a check
+ *
+ * @param result Results of check()
+ * @return One line per fact, the trace one input per line
+ */
+std::vector<std::string> EquivalenceChecker::describe(const EquivalenceResult& result) {
+    std::vector<std::string> lines;
+    if (result.equivalent) {
+        lines.push_back("Equivalent, " + std::to_string(result.pairsVisited) + " state pairs visited");
+        return lines;
+    }
+    if (result.leftState.empty()) {
+        lines.push_back("Unknown, gave up after " + std::to_string(result.pairsVisited) +
+                        " state pairs without finding a difference");
+        return lines;
+    }
+
+    lines.push_back("Not equivalent, outputs of " + result.leftState + " and " + result.rightState + " differ after " +
+                    std::to_string(result.trace.size()) + " inputs");
+    for (const EquivalenceStep& step : result.trace) {
+        lines.push_back("  " + step.inputPtr + "=" + step.value);
+    }
+    return lines;
+}
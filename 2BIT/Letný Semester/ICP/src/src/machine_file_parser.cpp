@@ -0,0 +1,532 @@
+/**
+ * @file machine_file_parser.cpp
+ * @brief Implementation of the MachineFileParser class
+ * @author Hugo Bohácsek (xbohach00)
+ */
+
+#include "../headers/machine_file_parser.h"
+#include "../headers/string_utils.h"
+#include <algorithm>
+#include <charconv>
+#include <fstream>
+#include <sstream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define MACHINE_FILE_MMAP
+#endif
+
+/**
+ * @brief Checks whether a view starts with a prefix
+ *
+ * @param text The view
+ * @param prefix The prefix
+ * @return True if text starts with prefix
+ */
+static bool startsWith(std::string_view text, std::string_view prefix) {
+    return text.substr(0, prefix.size()) == prefix;
+}
+
+/**
+ * @brief Constructor
+ *
+ * @param filename Name of the file shown in the message
+ * @param line Line of the error
+ * @param column Column of the error, in bytes
+ * @param message Description of the error
+ */
+MachineFileError::MachineFileError(const std::string& filename, size_t line, size_t column, const std::string& message)
+    : std::runtime_error(filename + ":" + std::to_string(line) + ":" + std::to_string(column) + ": " + message),
+      line(line), column(column) {}
+
+/**
+ * @brief Gets the line of the error
+ *
+ * @return Line number, starting at 1
+ */
+size_t MachineFileError::getLine() const {
+    return line;
+}
+
+/**
+ * @brief Gets the column of the error
+ *
+ * @return Column in bytes, starting at 1
+ */
+size_t MachineFileError::getColumn() const {
+    return column;
+}
+
+/**
+ * @brief Constructor, maps the file
+ *
+ * @param filename Path to the file
+ * @throw std::runtime_error If the file cannot be opened
+ */
+MappedFile::MappedFile(const std::string& filename) : data(nullptr), size(0), mapped(false) {
+#ifdef MACHINE_FILE_MMAP
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open file: " + filename);
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+        void* address = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (address != MAP_FAILED) {
+            // The parser reads the file front to back once
+            madvise(address, static_cast<size_t>(info.st_size), MADV_SEQUENTIAL);
+            data = static_cast<const char*>(address);
+            size = static_cast<size_t>(info.st_size);
+            mapped = true;
+        }
+    }
+    close(fd);
+    if (mapped) {
+        return;
+    }
+#endif
+
+    // Empty files, pipes and platforms without mmap are read instead
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Cannot open file: " + filename);
+    }
+    std::stringstream contents;
+    contents << file.rdbuf();
+    buffer = contents.str();
+    data = buffer.data();
+    size = buffer.size();
+}
+
+/**
+ * @brief Destructor, unmaps the file
+ */
+MappedFile::~MappedFile() {
+#ifdef MACHINE_FILE_MMAP
+    if (mapped) {
+        munmap(const_cast<char*>(data), size);
+    }
+#endif
+}
+
+/**
+ * @brief Gets the contents of the file
+ *
+ * @return View of the whole file
+ */
+std::string_view MappedFile::getText() const {
+    return std::string_view(data, size);
+}
+
+/**
+ * @brief Constructor
+ *
+ * @param text Text of the machine definition, must outlive the parser
+ * @param filename Name of the file shown in error messages
+ */
+MachineFileParser::MachineFileParser(std::string_view text, const std::string& filename)
+    : text(text), filename(filename), position(0), lineNumber(0) {}
+
+/**
+ * @brief Moves to the next line
+ *
+ * @return False at the end of the text
+ */
+bool MachineFileParser::nextLine() {
+    if (position >= text.size()) {
+        return false;
+    }
+
+    size_t end = text.find('\n', position);
+    if (end == std::string_view::npos) {
+        end = text.size();
+    }
+    line = text.substr(position, end - position);
+    position = end + 1;
+    lineNumber++;
+    return true;
+}
+
+/**
+ * @brief Throws an error pointing into the current line
+ *
+ * @param at Part of the current line the error is about
+ * @param message Description of the error
+ * @throw MachineFileError Always
+ */
+void MachineFileParser::fail(std::string_view at, const std::string& message) const {
+    throw MachineFileError(filename, lineNumber, static_cast<size_t>(at.data() - line.data()) + 1, message);
+}
+
+/**
+ * @brief Parses a comma separated list of the header
+ *
+ * @param list The list
+ * @return Non-empty trimmed items
+ */
+std::vector<std::string_view> MachineFileParser::parseList(std::string_view list) {
+    std::vector<std::string_view> items;
+    while (!list.empty()) {
+        size_t comma = list.find(',');
+        std::string_view item = trimView(list.substr(0, comma));
+        if (!item.empty()) {
+            items.push_back(item);
+        }
+        if (comma == std::string_view::npos) {
+            break;
+        }
+        list.remove_prefix(comma + 1);
+    }
+    return items;
+}
+
+/**
+ * @brief Parses a line of the header
+ *
+ * @param machine Machine to fill
+ * @param content The trimmed line
+ */
+void MachineFileParser::parseHeader(MooreMachine& machine, std::string_view content) {
+    if (startsWith(content, "Input alphabet is")) {
+        for (std::string_view symbol : parseList(content.substr(17))) {
+            machine.addInputSymbol(std::string(symbol));
+        }
+    } else if (startsWith(content, "Output alphabet is")) {
+        for (std::string_view symbol : parseList(content.substr(18))) {
+            machine.addOutputSymbol(std::string(symbol));
+        }
+    } else if (startsWith(content, "Input pointers are")) {
+        for (std::string_view pointer : parseList(content.substr(18))) {
+            machine.addInputPointer(std::string(pointer));
+        }
+    } else if (startsWith(content, "Output pointers are")) {
+        for (std::string_view pointer : parseList(content.substr(19))) {
+            machine.addOutputPointer(std::string(pointer));
+        }
+    } else {
+        fail(content, "Expected an alphabet, a list of pointers or 'Variables are'");
+    }
+}
+
+/**
+ * @brief Parses a variable: {type} {name} = {value}
+ *
+ * @param machine Machine to fill
+ * @param content The trimmed line
+ */
+void MachineFileParser::parseVariable(MooreMachine& machine, std::string_view content) {
+    size_t typeEnd = 0;
+    while (typeEnd < content.size() && !isSpace(content[typeEnd]) && content[typeEnd] != '=') {
+        typeEnd++;
+    }
+    std::string_view type = content.substr(0, typeEnd);
+    std::string_view rest = content.substr(typeEnd);
+
+    size_t equals = rest.find('=');
+    if (type.empty() || equals == std::string_view::npos) {
+        fail(content, "Expected '{type} {name} = {value}'");
+    }
+
+    std::string_view name = trimView(rest.substr(0, equals));
+    std::string_view value = trimView(rest.substr(equals + 1));
+    if (name.empty() || std::find_if(name.begin(), name.end(), isSpace) != name.end()) {
+        fail(name.empty() ? rest : name, "Expected a variable name before '='");
+    }
+    if (value.empty()) {
+        fail(rest.substr(equals), "Expected a value after '='");
+    }
+
+    if (!machine.addVariable(std::string(type), std::string(name), std::string(value))) {
+        fail(type, "Invalid variable '" + std::string(name) + "' of type '" + std::string(type) +
+                   "' with value '" + std::string(value) + "'");
+    }
+}
+
+/**
+ * @brief Parses a state: {name}: [{output}; ...]
+ *
+ * @param machine Machine to fill
+ * @param content The trimmed line
+ * @param isInitial Whether this is the first state
+ * @return ID of the state
+ */
+const std::string& MachineFileParser::parseState(MooreMachine& machine, std::string_view content, bool isInitial) {
+    size_t colon = content.find(':');
+    if (colon == std::string_view::npos) {
+        fail(content, "Expected '{state name}: [{outputs}]'");
+    }
+
+    std::string_view name = trimView(content.substr(0, colon));
+    std::string_view outputs = trimView(content.substr(colon + 1));
+    if (name.empty()) {
+        fail(content, "Expected a state name before ':'");
+    }
+
+    // The name is the ID of the state, later lines refer to it through the view
+    auto interned = stateIds.emplace(name, std::string(name));
+    if (!interned.second) {
+        fail(name, "Duplicate state '" + std::string(name) + "'");
+    }
+    const std::string& stateId = interned.first->second;
+
+    State state(stateId, stateId);
+    state.setIsInitial(isInitial);
+
+    if (!outputs.empty()) {
+        if (outputs.front() != '[' || outputs.back() != ']') {
+            fail(outputs, "Expected the outputs in '[' and ']'");
+        }
+
+        std::string_view statements = outputs.substr(1, outputs.size() - 2);
+        while (!statements.empty()) {
+            size_t semicolon = statements.find(';');
+            parseOutput(state, trimView(statements.substr(0, semicolon)));
+            if (semicolon == std::string_view::npos) {
+                break;
+            }
+            statements.remove_prefix(semicolon + 1);
+        }
+    }
+
+    machine.addState(state);
+    return stateId;
+}
+
+/**
+ * @brief Parses one output statement of a state
+ *
+ * A statement with '=' is an assignment kept as a whole. Otherwise it is
+ * "output {value} to {pointer}", optionally followed by "if {pointer} is defined".
+ * Like the files written by MachineFileHandler::saveToFile, statements matching
+ * neither are left out.
+ *
+ * @param state State to add the output to
+ * @param statement The trimmed statement
+ */
+void MachineFileParser::parseOutput(State& state, std::string_view statement) {
+    if (statement.empty()) {
+        return;
+    }
+
+    // Check for variable assignments (contains '=')
+    if (statement.find('=') != std::string_view::npos) {
+        state.addOutput(OutputCondition(std::string(statement), "expression"));
+        return;
+    }
+
+    // Split into at most the eight words of the longest form
+    std::string_view words[8];
+    size_t count = 0;
+    size_t index = 0;
+    while (count < 8) {
+        while (index < statement.size() && isSpace(statement[index])) {
+            index++;
+        }
+        size_t start = index;
+        while (index < statement.size() && !isSpace(statement[index])) {
+            index++;
+        }
+        if (start == index) {
+            break;
+        }
+        words[count++] = statement.substr(start, index - start);
+    }
+
+    if (count >= 4 && words[0] == "output" && words[2] == "to") {
+        // The condition is "if {pointer} is defined", the fifth to eighth word
+        bool hasCondition = count == 8 && words[4] == "if" && words[6] == "is" && words[7] == "defined";
+        state.addOutput(OutputCondition(std::string(words[1]), std::string(words[3]),
+                                        hasCondition ? std::string(words[5]) : "", hasCondition));
+    } else if (startsWith(statement, "output ")) {
+        state.addOutput(OutputCondition(std::string(trimView(statement.substr(7))), "default"));
+    }
+}
+
+/**
+ * @brief Looks up the ID of a state by its name
+ *
+ * @param name Trimmed name from the current line
+ * @return ID of the state
+ * @throw MachineFileError If no state has the name
+ */
+const std::string& MachineFileParser::findState(std::string_view name) const {
+    auto it = stateIds.find(name);
+    if (it == stateIds.end()) {
+        fail(name, "Unknown state '" + std::string(name) + "'");
+    }
+    return it->second;
+}
+
+/**
+ * @brief Parses a transition: {source}-[{condition}; ...]->{target}
+ *
+ * @param machine Machine to fill
+ * @param content The trimmed line
+ */
+void MachineFileParser::parseTransition(MooreMachine& machine, std::string_view content) {
+    size_t dash = content.find('-');
+    size_t close = content.rfind("]->");
+    if (dash == 0 || dash == std::string_view::npos || dash + 1 >= content.size() || content[dash + 1] != '[' ||
+        close == std::string_view::npos || close < dash + 2) {
+        fail(content, "Expected '{source}-[{conditions}]->{target}'");
+    }
+
+    const std::string& sourceId = findState(trimView(content.substr(0, dash)));
+    std::string_view targetName = trimView(content.substr(close + 3));
+    if (targetName.empty()) {
+        fail(content.substr(close), "Expected a target state after '->'");
+    }
+    const std::string& targetId = findState(targetName);
+
+    std::vector<InputCondition> inputs;
+    int timeout = 0;
+
+    std::string_view conditions = content.substr(dash + 2, close - dash - 2);
+    while (!conditions.empty()) {
+        size_t semicolon = conditions.find(';');
+        std::string_view condition = trimView(conditions.substr(0, semicolon));
+
+        if (condition.empty()) {
+            // Nothing between two semicolons
+        }
+        // Parse timeout
+        else if (startsWith(condition, "timeout ")) {
+            std::string_view number = trimView(condition.substr(8));
+            auto result = std::from_chars(number.data(), number.data() + number.size(), timeout);
+            if (result.ec != std::errc() || result.ptr != number.data() + number.size()) {
+                fail(number, "Invalid timeout '" + std::string(number) + "'");
+            }
+        }
+        // Parse boolean expression
+        else if (condition.find("==") != std::string_view::npos || condition.find("!=") != std::string_view::npos) {
+            size_t opPos = condition.find("==");
+            std::string op = "==";
+            if (opPos == std::string_view::npos) {
+                opPos = condition.find("!=");
+                op = "!=";
+            }
+
+            inputs.emplace_back(std::string(trimView(condition.substr(0, opPos))), op,
+                                std::string(trimView(condition.substr(opPos + 2))));
+        }
+        // Parse input condition, "got {value} from {pointer}" or the legacy "got {value}"
+        else if (startsWith(condition, "got ")) {
+            std::string_view inputPart = trimView(condition.substr(4));
+            size_t fromPos = inputPart.find(" from ");
+            if (fromPos != std::string_view::npos) {
+                inputs.emplace_back(std::string(trimView(inputPart.substr(0, fromPos))),
+                                    std::string(trimView(inputPart.substr(fromPos + 6))));
+            } else {
+                inputs.emplace_back(std::string(inputPart), "default");
+            }
+        } else {
+            fail(condition, "Expected 'got {value} from {pointer}', a comparison or 'timeout {ms}'");
+        }
+
+        if (semicolon == std::string_view::npos) {
+            break;
+        }
+        conditions.remove_prefix(semicolon + 1);
+    }
+
+    if (inputs.empty() && timeout <= 0) {
+        return;
+    }
+
+    std::string transitionId;
+    transitionId.reserve(sourceId.size() + 2 + targetId.size());
+    transitionId += sourceId;
+    transitionId += "->";
+    transitionId += targetId;
+    if (!machine.addTransition(Transition(transitionId, sourceId, targetId, inputs, timeout))) {
+        fail(content, "Duplicate transition from '" + sourceId + "' to '" + targetId + "'");
+    }
+}
+
+/**
+ * @brief Parses the text into a machine
+ *
+ * @return The machine
+ * @throw MachineFileError If the text is not a valid machine definition
+ */
+MooreMachine MachineFileParser::parse() {
+    // First line must be the machine name
+    if (!nextLine()) {
+        throw MachineFileError(filename, 1, 1, "Empty file");
+    }
+    std::string_view content = trimView(line);
+    if (!startsWith(content, "Name") || content.size() <= 4 || !isSpace(content[4])) {
+        fail(content, "Expected 'Name {Machine name}' on the first line");
+    }
+    MooreMachine machine{std::string(trimView(content.substr(4)))};
+
+    // Every transition takes a line, so the line count bounds them
+    machine.reserveTransitions(static_cast<size_t>(std::count(text.begin(), text.end(), '\n')) + 1);
+
+    enum class Section {
+        HEADER,
+        VARIABLES,
+        STATES,
+        TRANSITIONS
+    };
+
+    Section section = Section::HEADER;
+    std::string firstStateId; // Keep track of the first state
+
+    while (nextLine()) {
+        // Skip comments
+        if (startsWith(line, "voices")) {
+            continue;
+        }
+
+        content = trimView(line);
+        if (content.empty()) {
+            continue;
+        }
+
+        // Check for section markers
+        if (content == "Variables are") {
+            section = Section::VARIABLES;
+            continue;
+        } else if (content == "States are") {
+            section = Section::STATES;
+            continue;
+        } else if (content == "Transitions are") {
+            section = Section::TRANSITIONS;
+            continue;
+        } else if (content == "Thanks") {
+            break;
+        }
+
+        switch (section) {
+            case Section::HEADER:
+                parseHeader(machine, content);
+                break;
+            case Section::VARIABLES:
+                parseVariable(machine, content);
+                break;
+            case Section::STATES:
+            {
+                const std::string& stateId = parseState(machine, content, firstStateId.empty());
+                if (firstStateId.empty()) {
+                    firstStateId = stateId;
+                }
+                break;
+            }
+            case Section::TRANSITIONS:
+                parseTransition(machine, content);
+                break;
+        }
+    }
+
+    // The first state is the initial state
+    if (!firstStateId.empty()) {
+        machine.setInitialState(firstStateId);
+    }
+
+    return machine;
+}
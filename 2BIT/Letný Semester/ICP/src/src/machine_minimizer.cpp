@@ -0,0 +1,368 @@
+/**
+ * @file machine_minimizer.cpp
+ * @brief Implementation of the MachineMinimizer class
+ * @author Hugo Bohácsek (xbohach00)
+ */
+
+#include "../headers/machine_minimizer.h"
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include "../headers/transition_table.h"
+
+/**
+ * @brief Checks if a transition fires on inputs alone
+ *
+ * @param transition The transition
+ * @return True if it has input conditions, no expression guards and no timeout
+ */
+static bool isPlain(const Transition& transition) {
+    if (transition.getTimeout() > 0 || transition.getInputConditions().empty()) {
+        return false;
+    }
+    for (const auto& input : transition.getInputConditions()) {
+        if (input.isBooleanExpr) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Constructor
+ *
+ * @param machine The machine to minimize, must outlive the minimizer
+ */
+MachineMinimizer::MachineMinimizer(MooreMachine& machine) : machine(machine) {}
+
+/**
+ * @brief Creates a block from the states in elements[first, end)
+ *
+ * @param first Position of the first state
+ * @param end Position one past the last state
+ * @return Index of the new block
+ */
+int MachineMinimizer::addBlock(int first, int end) {
+    int block = static_cast<int>(blockFirst.size());
+    blockFirst.push_back(first);
+    blockEnd.push_back(end);
+    blockMid.push_back(first);
+    for (int i = first; i < end; i++) {
+        blockOf[elements[i]] = block;
+    }
+    return block;
+}
+
+/**
+ * @brief Marks a state, moving it into the marked part of its block
+ *
+ * @param state Index of the state
+ */
+void MachineMinimizer::mark(int state) {
+    int block = blockOf[state];
+    int position = location[state];
+    int mid = blockMid[block];
+    if (position < mid) {
+        return;
+    }
+
+    std::swap(elements[position], elements[mid]);
+    location[elements[position]] = position;
+    location[state] = mid;
+    if (mid == blockFirst[block]) {
+        touched.push_back(block);
+    }
+    blockMid[block]++;
+}
+
+/**
+ * @brief Splits the marked states off a block
+ *
+ * @param block Index of a block with marked states
+ * @return Index of the block of the marked states, or -1 if the whole block was marked
+ */
+int MachineMinimizer::splitMarked(int block) {
+    int first = blockFirst[block];
+    int mid = blockMid[block];
+    if (mid == blockEnd[block]) {
+        blockMid[block] = first;
+        return -1;
+    }
+
+    blockFirst[block] = mid;
+    return addBlock(first, mid);
+}
+
+/**
+ * @brief Minimizes the machine
+ *
+ * @return The minimized machine, the original is left unchanged
+ */
+MinimizationResult MachineMinimizer::run() {
+    std::shared_ptr<const TransitionTable> table = machine.getTransitionTable();
+    int states = table->getStateCount();
+
+    // Intern the input pointer and value pairs read by transitions as letters
+    std::unordered_map<uint64_t, int> letterIndices;
+    std::vector<int> conditionLetters;
+    for (int transition = 0; transition < table->getTransitionCount(); transition++) {
+        for (const auto& input : table->getTransition(transition)->getInputConditions()) {
+            if (input.isBooleanExpr) {
+                continue;
+            }
+            uint64_t key = static_cast<uint64_t>(table->getPointerIndex(input.source)) << 32 |
+                           static_cast<uint32_t>(table->getSymbolIndex(input.value));
+            auto it = letterIndices.emplace(key, static_cast<int>(letterIndices.size())).first;
+            conditionLetters.push_back(it->second);
+        }
+    }
+    int letters = static_cast<int>(letterIndices.size());
+    std::vector<int> letterPointer(letters);
+    for (const auto& letter : letterIndices) {
+        letterPointer[letter.second] = static_cast<int>(letter.first >> 32);
+    }
+
+    // Where each state goes on each letter, the first transition reading it wins
+    std::vector<int> next(static_cast<size_t>(states) * letters, -1);
+    std::vector<const Transition*> firing(static_cast<size_t>(states) * letters, nullptr);
+    std::vector<char> pinned(states, 0);
+    std::vector<char> verbatim(states, 0);
+    size_t condition = 0;
+    for (int state = 0; state < states; state++) {
+        TransitionSpan outgoing = table->getOutgoing(state);
+        for (size_t i = 0; i < outgoing.size(); i++) {
+            int target = table->getTarget(outgoing.offset + static_cast<int>(i));
+            verbatim[state] = verbatim[state] || !isPlain(*outgoing.first[i]);
+            for (const auto& input : outgoing.first[i]->getInputConditions()) {
+                if (input.isBooleanExpr) {
+                    continue;
+                }
+                size_t index = static_cast<size_t>(state) * letters + conditionLetters[condition++];
+                if (next[index] < 0) {
+                    next[index] = target;
+                    firing[index] = outgoing.first[i];
+                }
+            }
+        }
+        for (int letter = 0; letter < letters; letter++) {
+            int& entry = next[static_cast<size_t>(state) * letters + letter];
+            if (entry < 0) {
+                entry = state;
+            }
+        }
+    }
+
+    // States with guards or timers keep their transitions, so they and their targets stay alone
+    for (int state = 0; state < states; state++) {
+        if (!verbatim[state]) {
+            continue;
+        }
+        pinned[state] = 1;
+        TransitionSpan outgoing = table->getOutgoing(state);
+        for (size_t i = 0; i < outgoing.size(); i++) {
+            pinned[table->getTarget(outgoing.offset + static_cast<int>(i))] = 1;
+        }
+    }
+
+    // Group the states by their outputs, states whose outputs depend on variables stay alone
+    std::unordered_map<std::string, int> groupIndices;
+    std::vector<int> groupOf(states);
+    for (int state = 0; state < states; state++) {
+        const std::string& id = table->getStateId(state);
+        for (const CompiledOutput& output : machine.getCompiledOutputs(id)) {
+            if (output.action != OutputAction::VALUE || machine.getVariable(output.source)) {
+                pinned[state] = 1;
+            }
+        }
+
+        std::string signature;
+        if (pinned[state]) {
+            signature = "\x1e" + id;
+        } else {
+            for (const OutputCondition& output : machine.getState(id)->getOutputs()) {
+                signature += output.value + '\x1f' + output.target + '\x1f' + output.inputPtr + '\x1f' +
+                             (output.hasCondition ? '1' : '0') + '\x1f';
+            }
+            // A firing transition clears every pointer it reads, merged states have to clear the same
+            // pointers besides the one of the letter
+            signature += '\x1e';
+            for (int letter = 0; letter < letters; letter++) {
+                const Transition* transition = firing[static_cast<size_t>(state) * letters + letter];
+                if (!transition) {
+                    continue;
+                }
+                std::vector<int> cleared;
+                for (const auto& input : transition->getInputConditions()) {
+                    int pointer = table->getPointerIndex(input.source);
+                    if (pointer != letterPointer[letter]) {
+                        cleared.push_back(pointer);
+                    }
+                }
+                if (cleared.empty()) {
+                    continue;
+                }
+                std::sort(cleared.begin(), cleared.end());
+                cleared.erase(std::unique(cleared.begin(), cleared.end()), cleared.end());
+                signature += std::to_string(letter) + ':';
+                for (int pointer : cleared) {
+                    signature += std::to_string(pointer) + ',';
+                }
+                signature += '\x1f';
+            }
+        }
+        groupOf[state] = groupIndices.emplace(signature, static_cast<int>(groupIndices.size())).first->second;
+    }
+
+    // Lay the groups out as the initial blocks
+    std::vector<int> groupStart(groupIndices.size() + 1, 0);
+    for (int state = 0; state < states; state++) {
+        groupStart[groupOf[state] + 1]++;
+    }
+    for (size_t group = 0; group < groupIndices.size(); group++) {
+        groupStart[group + 1] += groupStart[group];
+    }
+    elements.assign(states, 0);
+    location.assign(states, 0);
+    blockOf.assign(states, 0);
+    blockFirst.clear();
+    blockEnd.clear();
+    blockMid.clear();
+    touched.clear();
+    std::vector<int> fill(groupStart.begin(), groupStart.end() - 1);
+    for (int state = 0; state < states; state++) {
+        location[state] = fill[groupOf[state]]++;
+        elements[location[state]] = state;
+    }
+    for (size_t group = 0; group < groupIndices.size(); group++) {
+        addBlock(groupStart[group], groupStart[group + 1]);
+    }
+
+    // Predecessors of each state on each letter
+    std::vector<int> previousOffsets(static_cast<size_t>(letters) * states + 1, 0);
+    std::vector<int> previous(static_cast<size_t>(letters) * states);
+    for (int state = 0; state < states; state++) {
+        for (int letter = 0; letter < letters; letter++) {
+            int target = next[static_cast<size_t>(state) * letters + letter];
+            previousOffsets[static_cast<size_t>(letter) * states + target + 1]++;
+        }
+    }
+    for (size_t i = 1; i < previousOffsets.size(); i++) {
+        previousOffsets[i] += previousOffsets[i - 1];
+    }
+    std::vector<int> slot(previousOffsets.begin(), previousOffsets.end() - 1);
+    for (int state = 0; state < states; state++) {
+        for (int letter = 0; letter < letters; letter++) {
+            int target = next[static_cast<size_t>(state) * letters + letter];
+            previous[slot[static_cast<size_t>(letter) * states + target]++] = state;
+        }
+    }
+
+    // Every block but the largest splits the others on every letter
+    std::vector<std::pair<int, int>> pending;
+    std::vector<char> isPending;
+    auto addSplitter = [&](int block, int letter) {
+        size_t index = static_cast<size_t>(block) * letters + letter;
+        if (isPending.size() <= index) {
+            isPending.resize(blockFirst.size() * letters, 0);
+        }
+        if (!isPending[index]) {
+            isPending[index] = 1;
+            pending.push_back({block, letter});
+        }
+    };
+    auto blockSize = [&](int block) { return blockEnd[block] - blockFirst[block]; };
+
+    int largest = 0;
+    for (int block = 1; block < static_cast<int>(blockFirst.size()); block++) {
+        if (blockSize(block) > blockSize(largest)) {
+            largest = block;
+        }
+    }
+    for (int block = 0; block < static_cast<int>(blockFirst.size()); block++) {
+        for (int letter = 0; block != largest && letter < letters; letter++) {
+            addSplitter(block, letter);
+        }
+    }
+
+    std::vector<int> splitter;
+    std::vector<int> split;
+    while (!pending.empty()) {
+        auto [block, letter] = pending.back();
+        pending.pop_back();
+        isPending[static_cast<size_t>(block) * letters + letter] = 0;
+
+        // Marking reorders the states of the splitter itself, so walk a copy
+        splitter.assign(elements.begin() + blockFirst[block], elements.begin() + blockEnd[block]);
+        for (int state : splitter) {
+            size_t index = static_cast<size_t>(letter) * states + state;
+            for (int i = previousOffsets[index]; i < previousOffsets[index + 1]; i++) {
+                mark(previous[i]);
+            }
+        }
+
+        split.swap(touched);
+        touched.clear();
+        for (int rest : split) {
+            int marked = splitMarked(rest);
+            if (marked < 0) {
+                continue;
+            }
+            for (int other = 0; other < letters; other++) {
+                bool restPending = isPending.size() > static_cast<size_t>(rest) * letters + other &&
+                                   isPending[static_cast<size_t>(rest) * letters + other];
+                addSplitter(restPending || blockSize(marked) <= blockSize(rest) ? marked : rest, other);
+            }
+        }
+        split.clear();
+    }
+
+    // The initial state or else the state added first survives in each block
+    State* initial = machine.getInitialState();
+    int initialIndex = initial ? table->getStateIndex(initial->getId()) : TransitionTable::NONE;
+    std::vector<int> survivor(blockFirst.size(), -1);
+    for (int state = 0; state < states; state++) {
+        int& kept = survivor[blockOf[state]];
+        if (kept < 0 || state == initialIndex) {
+            kept = state;
+        }
+    }
+
+    MinimizationResult result{machine, 0, {}};
+    MooreMachine& minimized = result.machine;
+    for (int state = 0; state < states; state++) {
+        int kept = survivor[blockOf[state]];
+        if (kept != state) {
+            result.mergedInto.emplace(table->getStateId(state), table->getStateId(kept));
+            minimized.removeState(table->getStateId(state));
+        }
+    }
+    result.removedStates = result.mergedInto.size();
+
+    // Rebuild the transitions of the survivors, one per original transition, pointing to the surviving states
+    for (int state = 0; state < states; state++) {
+        if (survivor[blockOf[state]] != state || verbatim[state]) {
+            continue;
+        }
+
+        const std::string& id = table->getStateId(state);
+        std::vector<std::string> stale;
+        for (TransitionHandle transition : minimized.getOutgoingHandles(minimized.getStateHandle(id))) {
+            stale.push_back(minimized.getTransition(transition)->getId());
+        }
+        for (const std::string& transitionId : stale) {
+            minimized.removeTransition(transitionId);
+        }
+
+        // Conditions are kept as they are, a firing transition clears the pointers of all of them
+        TransitionSpan outgoing = table->getOutgoing(state);
+        for (size_t i = 0; i < outgoing.size(); i++) {
+            const Transition& original = *outgoing.first[i];
+            int targetBlock = blockOf[table->getTarget(outgoing.offset + static_cast<int>(i))];
+            minimized.addTransition(Transition(original.getId(), id, table->getStateId(survivor[targetBlock]),
+                                               original.getInputConditions(), 0));
+        }
+    }
+
+    return result;
+}
@@ -23,8 +23,8 @@ using namespace std::chrono;
  */
 MachineSimulator::MachineSimulator(MooreMachine* machine) 
     : machine(machine), currentStateId(""),
-      lastTransitionTime(steady_clock::now()),
-      justEnteredState(true) {
+      lastTransitionTime(),
+      justEnteredState(true), settled(false) {
     reset();
 }
 
@@ -39,6 +39,19 @@ void MachineSimulator::reset() {
     if (!machine) {
         throw std::runtime_error("No machine assigned to simulator");
     }
+    reset(machine->getClock()->now());
+}
+
+/**
+ * @brief Resets the simulation to initial state at the given time
+ * 
+ * @param now Time the initial state is entered at
+ * @throw std::runtime_error If the machine has no states or no initial state
+ */
+void MachineSimulator::reset(steady_clock::time_point now) {
+    if (!machine) {
+        throw std::runtime_error("No machine assigned to simulator");
+    }
     
     // Find the initial state
     State* initialState = machine->getInitialState();
@@ -53,20 +66,47 @@ void MachineSimulator::reset() {
         }
     }
     
-    currentStateId = initialState->getId();
-    lastTransitionTime = steady_clock::now();
-    justEnteredState = true;  // We just entered the initial state
-    
-    // Clear all inputs, outputs, timeouts
-    inputValues.clear();
+    // Clear all inputs and outputs
+    inputs.clear();
+    inputSlots.clear();
     outputValues.clear();
-    timeoutActive.clear();
-    timeoutStartTimes.clear();
     
-    // Process initial state outputs
-    if (initialState) {
-        processStateOutputs(initialState);
+    // Enter the initial state, which arms its timeouts and processes its outputs
+    enterState(initialState->getId(), now);
+}
+
+/**
+ * @brief Continues a simulation observed elsewhere
+ * 
+ * @param stateId ID of the current state
+ * @param enteredAt Time the state was entered, pure timeouts are measured from it
+ * @param inputs Current input values
+ * @param outputs Current output values
+ * @throw std::runtime_error If the machine has no such state
+ */
+void MachineSimulator::restore(const std::string& stateId, steady_clock::time_point enteredAt,
+                               const std::vector<std::pair<std::string, std::string>>& inputs,
+                               const std::vector<std::pair<std::string, std::string>>& outputs) {
+    if (!machine || !machine->getState(stateId)) {
+        throw std::runtime_error("Cannot restore unknown state: " + stateId);
+    }
+
+    this->inputs.clear();
+    inputSlots.clear();
+    for (const auto& input : inputs) {
+        getInputSlot(input.first) = input.second;
+    }
+    outputValues.clear();
+    for (const auto& output : outputs) {
+        outputValues[output.first] = output.second;
     }
+
+    // The outputs are already there, the next step evaluates the transitions
+    currentStateId = stateId;
+    lastTransitionTime = enteredAt;
+    justEnteredState = false;
+    settled = false;
+    armStateTimeouts();
 }
 
 /**
@@ -76,8 +116,9 @@ void MachineSimulator::reset() {
  * @param value The value to set
  */
 void MachineSimulator::setInput(const std::string& inputPtr, const std::string& value) {
-    inputValues[inputPtr] = value;
+    getInputSlot(inputPtr) = value;
     justEnteredState = false;
+    settled = false;
 }
 
 /**
@@ -87,9 +128,9 @@ void MachineSimulator::setInput(const std::string& inputPtr, const std::string&
  * @return Current value, or empty string if not set
  */
 std::string MachineSimulator::getInput(const std::string& inputPtr) const {
-    auto it = inputValues.find(inputPtr);
-    if (it != inputValues.end()) {
-        return it->second;
+    const std::string* value = findInput(inputPtr);
+    if (value) {
+        return *value;
     }
     return "";
 }
@@ -100,11 +141,103 @@ std::string MachineSimulator::getInput(const std::string& inputPtr) const {
  * @return Vector of input pointer/value pairs
  */
 std::vector<std::pair<std::string, std::string>> MachineSimulator::getAllInputs() const {
-    std::vector<std::pair<std::string, std::string>> result;
-    for (const auto& input : inputValues) {
-        result.emplace_back(input.first, input.second);
+    return inputs;
+}
+
+/**
+ * @brief Gets the slot of an input pointer, creating an empty one on first use
+ * 
+ * @param inputPtr The input pointer name
+ * @return Reference to the value of the input
+ */
+std::string& MachineSimulator::getInputSlot(const std::string& inputPtr) {
+    auto it = inputSlots.find(inputPtr);
+    if (it != inputSlots.end()) {
+        return inputs[it->second].second;
     }
-    return result;
+    inputSlots.emplace(inputPtr, inputs.size());
+    inputs.emplace_back(inputPtr, "");
+    return inputs.back().second;
+}
+
+/**
+ * @brief Finds the value of an input pointer
+ * 
+ * @param inputPtr The input pointer name
+ * @return Pointer to the value, or nullptr if the input was never set
+ */
+const std::string* MachineSimulator::findInput(const std::string& inputPtr) const {
+    auto it = inputSlots.find(inputPtr);
+    if (it != inputSlots.end()) {
+        return &inputs[it->second].second;
+    }
+    return nullptr;
+}
+
+/**
+ * @brief Moves to a state and processes its outputs
+ * 
+ * Cancels the timeouts of the state being left and arms the pure
+ * timeout transitions of the entered one.
+ * 
+ * @param stateId ID of the entered state
+ * @param now Time of the entry
+ */
+void MachineSimulator::enterState(const std::string& stateId, steady_clock::time_point now) {
+    currentStateId = stateId;
+    
+    // Reset timer and mark that we just entered a new state
+    lastTransitionTime = now;
+    justEnteredState = true;
+    settled = false;
+    armStateTimeouts();
+    
+    // Get the new state and process its outputs
+    State* newState = machine->getState(currentStateId);
+    if (newState) {
+        processStateOutputs(newState);
+    }
+}
+
+/**
+ * @brief Arms the pure timeout transitions of the current state
+ * 
+ * Their deadlines are measured from the time the state was entered.
+ * Every other timeout is cancelled.
+ */
+void MachineSimulator::armStateTimeouts() {
+    const TransitionTable& table = machine->getCompiledTransitions();
+    if (&table != timeoutTable.get()) {
+        // Holding the old table keeps its address from being reused by a new one
+        timeoutTable = machine->getTransitionTable();
+        timeouts.resize(table.getTransitionCount());
+    } else {
+        timeouts.clear();
+    }
+    
+    TransitionSpan transitions = table.getOutgoing(table.getStateIndex(currentStateId));
+    for (size_t i = 0; i < transitions.size(); i++) {
+        const Transition* transition = transitions.first[i];
+        if (transition->getTimeout() > 0 && transition->getInputConditions().empty()) {
+            timeouts.arm(transitions.offset + static_cast<int>(i),
+                         lastTransitionTime + milliseconds(transition->getTimeout()));
+        }
+    }
+}
+
+/**
+ * @brief Gets the transition table the timeouts are keyed by
+ * 
+ * If the machine rebuilt its table since the timeouts were armed,
+ * the timeouts of the current state are armed again against the new one.
+ * 
+ * @return Reference to the current table
+ */
+const TransitionTable& MachineSimulator::syncTimeouts() {
+    if (&machine->getCompiledTransitions() != timeoutTable.get()) {
+        armStateTimeouts();
+    }
+    return *timeoutTable;
 }
 
 /**
@@ -147,6 +280,19 @@ void MachineSimulator::processInputs() {
     if (!machine) {
         throw std::runtime_error("No machine assigned to simulator");
     }
+    processInputs(machine->getClock()->now());
+}
+
+/**
+ * @brief Processes current inputs at the given time
+ * 
+ * @param now Current time, must not go backwards between calls
+ * @throw std::runtime_error If the machine is not in a valid state
+ */
+void MachineSimulator::processInputs(steady_clock::time_point now) {
+    if (!machine) {
+        throw std::runtime_error("No machine assigned to simulator");
+    }
     
     // Get the current state
     State* currentState = machine->getState(currentStateId);
@@ -162,83 +308,70 @@ void MachineSimulator::processInputs() {
     }
     
     // Check and process any expired timeouts first
-    bool timeoutTriggered = checkTimeouts();
+    bool timeoutTriggered = checkTimeouts(now);
     if (timeoutTriggered) {
         return; // Already transitioned due to timeout
     }
     
-    // Get all transitions from the current state
-    std::vector<Transition*> transitions = machine->getTransitionsFromState(currentStateId);
-    auto variables = machine->getVariables();
+    // Borrow the transitions and variables instead of copying them
+    const TransitionTable& table = syncTimeouts();
+    TransitionSpan transitions = table.getOutgoing(table.getStateIndex(currentStateId));
+    const auto& variables = machine->getVariablesView();
     
     // First, check for transitions with boolean conditions or input conditions
-    for (Transition* transition : transitions) {
-        // Skip timeout transitions - they're handled in checkTimeouts
+    for (size_t i = 0; i < transitions.size(); i++) {
+        Transition* transition = transitions.first[i];
+        int timer = transitions.offset + static_cast<int>(i);
+        
+        // Skip timeout transitions - they're armed on state entry
         if (transition->getTimeout() > 0 && transition->getInputConditions().empty()) {
             continue;
         }
         
         // Check if this transition is triggered by condition
-        if (transition->isTriggered(getAllInputs(), variables)) {
+        if (transition->isTriggered(inputs, variables)) {
             // If transition has both input conditions and timeout
             if (transition->getTimeout() > 0) {
-                std::string transId = transition->getId();
-                
                 // If timeout not already active, start it
-                if (!timeoutActive[transId]) {
-                    timeoutActive[transId] = true;
-                    timeoutStartTimes[transId] = steady_clock::now();
+                if (!timeouts.isArmed(timer)) {
+                    timeouts.arm(timer, now + milliseconds(transition->getTimeout()));
                 }
                 continue; // Wait for timeout to expire
             }
             
             // Immediate transition (no timeout)
-            // Transition to the target state
-            std::string oldStateId = currentStateId;
-            currentStateId = transition->getTargetId();
-            
             // Clear inputs that triggered this transition
             clearTriggeredInputs(transition);
             
-            // Reset timer and mark that we just entered a new state
-            lastTransitionTime = steady_clock::now();
-            justEnteredState = true;
-            
-            // Clear all timeouts when changing states
-            timeoutActive.clear();
-            timeoutStartTimes.clear();
-            
-            // Get the new state and process its outputs
-            State* newState = machine->getState(currentStateId);
-            if (newState) {
-                processStateOutputs(newState);
-            }
-            
+            // Transition to the target state
+            enterState(transition->getTargetId(), now);
             return;
         }
     }
     
     // Now check for transitions with input conditions that need timeouts
-    for (Transition* transition : transitions) {
+    for (size_t i = 0; i < transitions.size(); i++) {
+        Transition* transition = transitions.first[i];
+        int timer = transitions.offset + static_cast<int>(i);
         int timeout = transition->getTimeout();
-        if (timeout <= 0) continue;
+        if (timeout <= 0 || transition->getInputConditions().empty()) continue;
         
         // If this transition has input conditions that are met
-        if (transition->isTriggered(getAllInputs(), variables)) {
-            std::string transId = transition->getId();
-            
+        if (transition->isTriggered(inputs, variables)) {
             // If timeout not already active, start it
-            if (!timeoutActive[transId]) {
-                timeoutActive[transId] = true;
-                timeoutStartTimes[transId] = steady_clock::now();
+            if (!timeouts.isArmed(timer)) {
+                timeouts.arm(timer, now + milliseconds(timeout));
             }
             // Timeout is active but not yet expired - continue waiting
         }
         else {
             // Input conditions not met, deactivate any existing timeout
-            timeoutActive[transition->getId()] = false;
+            timeouts.cancel(timer);
         }
     }
+    
+    // Nothing changes from here on until an input arrives or a timeout expires
+    settled = true;
 }
 
 /**
@@ -260,66 +393,57 @@ void MachineSimulator::processStateOutputs(State* state) {
     // Calculate elapsed time in this state
     int elapsedTime = machine->getElapsedTimeInState(); // elapsed kw
     
-    // Get all output expressions from the state
-    auto outputs = state->getOutputs();
-    ExpressionParser parser;
-    
-    for (const auto& output : outputs) {
+    // Output statements are compiled once per state and reused on every entry
+    for (CompiledOutput& output : machine->getCompiledOutputs(state->getId())) {
         // Skip if there's a condition and it's not satisfied
         if (output.hasCondition) {
-            bool conditionMet = parser.parseCondition("if " + output.inputPtr + " is defined", inputValues);
-            if (!conditionMet) {
+            const std::string* value = findInput(output.conditionPtr);
+            if (!value || value->empty()) {
                 continue;
             }
         }
         
-        // Handle variable assignments
-        if (output.value.find('=') != std::string::npos && output.target == "expression") {
-            // Extract assignment
-            size_t equalsPos = output.value.find('=');
-            if (equalsPos == std::string::npos) continue;
-            
-            std::string varName = trim(output.value.substr(0, equalsPos));
-            std::string expression = trim(output.value.substr(equalsPos + 1));
-            
-            // Check if this is a "get" expression
-            if (expression.find("get ") == 0) {
-                auto result = parser.parseAssignment(output.value, inputValues);
+        switch (output.action) {
+            // Handle "get" assignments
+            case OutputAction::ASSIGN_INPUT: {
+                const std::string* value = findInput(output.source);
                 
                 // Update the variable in the machine
-                MachineVariable* var = machine->getVariable(result.first);
+                MachineVariable* var = machine->getVariable(output.target);
                 if (var) {
-                    var->setValue(result.second);
+                    var->setValue(value ? *value : "");
                 }
+                break;
             }
-            // Otherwise, evaluate as arithmetic expression
-            else {
-                // Evaluate the right side of the assignment
-                MachineVariable result = machine->evaluateExpression(expression, elapsedTime);
+            // Evaluate the right side of the assignment
+            case OutputAction::ASSIGN_EXPRESSION: {
+                const MachineVariable& result = machine->evaluateProgram(output.program, elapsedTime);
                 
                 // Update the variable in the machine
-                MachineVariable* var = machine->getVariable(varName);
+                MachineVariable* var = machine->getVariable(output.target);
                 if (var) {
                     var->setValue(result.getValueString());
                 }
+                break;
             }
-        }
-        // Handle output expressions
-        else if (output.value.find("output ") == 0) {
-            // Parse the output expression
-            auto result = machine->parseOutputExpression(output.value, elapsedTime);
-            
-            // Update the output value
-            outputValues[result.first] = result.second;
-        }
-        // Regular output
-        else {
-            MachineVariable* var = machine->getVariable(output.value);
-            if (var) {
-                outputValues[output.target] = var->getValueString();
-            } else {
-                outputValues[output.target] = output.value;
+            // Handle output expressions
+            case OutputAction::OUTPUT_EXPRESSION: {
+                const MachineVariable& result = machine->evaluateProgram(output.program, elapsedTime);
+                outputValues[output.target] = result.getValueString();
+                break;
             }
+            // Regular output
+            case OutputAction::VALUE: {
+                MachineVariable* var = machine->getVariable(output.source);
+                if (var) {
+                    outputValues[output.target] = var->getValueString();
+                } else {
+                    outputValues[output.target] = output.source;
+                }
+                break;
+            }
+            case OutputAction::INVALID:
+                throw std::runtime_error(output.source);
         }
     }
 }
@@ -382,97 +506,95 @@ State* MachineSimulator::getCurrentState() const {
     return machine->getState(currentStateId);
 }
 
+/**
+ * @brief Gets the time the current state was entered
+ * 
+ * @return Time of the last state entry
+ */
+steady_clock::time_point MachineSimulator::getStateEntryTime() const {
+    return lastTransitionTime;
+}
+
 /**
  * @brief Checks for timeout transitions
  * 
- * Checks if any timeout transition from the current state has expired,
- * and if so, performs the transition. Also evaluates boolean expressions.
+ * Pops the earliest expired timeout of the current state, if any,
+ * and performs its transition.
  * 
  * @return True if a timeout transition was triggered, false otherwise
  */
 bool MachineSimulator::checkTimeouts() {
-    auto now = steady_clock::now();
-    
-    // First check transitions with both input conditions and timeouts
-    for (auto it = timeoutActive.begin(); it != timeoutActive.end(); ) {
-        if (!it->second) {
-            ++it;
-            continue; // Skip inactive timeouts
-        }
-        
-        std::string transitionId = it->first;
-        Transition* transition = machine->getTransition(transitionId);
-        
-        if (!transition || transition->getSourceId() != currentStateId) {
-            // Invalid or not from current state
-            it = timeoutActive.erase(it);
-            timeoutStartTimes.erase(transitionId);
-            continue;
-        }
-        
-        // Check if timeout has expired
-        auto startTime = timeoutStartTimes[transitionId];
-        auto elapsed = duration_cast<milliseconds>(now - startTime).count();
-        
-        if (elapsed >= transition->getTimeout()) {
-            // Timeout expired - make the transition
-            std::string oldStateId = currentStateId;
-            currentStateId = transition->getTargetId();
-            
-            // Clear inputs that triggered this transition
-            clearTriggeredInputs(transition);
-            
-            // Reset timer, mark that we just entered state, clear timeout data
-            lastTransitionTime = now;
-            justEnteredState = true;
-            timeoutActive.clear();
-            timeoutStartTimes.clear();
-            
-            // Process outputs from new state
-            State* newState = machine->getState(currentStateId);
-            if (newState) {
-                processStateOutputs(newState);
-            }
-            
-            return true; // We made a transition
-        }
-        
-        ++it;
+    if (!machine) {
+        return false;
+    }
+    return checkTimeouts(machine->getClock()->now());
+}
+
+/**
+ * @brief Checks for timeout transitions expired at the given time
+ * 
+ * @param now Current time
+ * @return True if a timeout transition was triggered, false otherwise
+ */
+bool MachineSimulator::checkTimeouts(steady_clock::time_point now) {
+    const TransitionTable& table = syncTimeouts();
+    int timer = timeouts.popExpired(now);
+    if (timer == TimerQueue::NONE) {
+        return false; // No timeout transitions triggered
     }
     
-    // Then check pure timeout transitions (no input conditions)
-    std::vector<Transition*> transitions = machine->getTransitionsFromState(currentStateId);
-    for (Transition* transition : transitions) {
-        int timeout = transition->getTimeout();
-        if (timeout <= 0 || !transition->getInputConditions().empty()) {
-            continue; // Skip non-timeout transitions or those with input conditions
-        }
-        
-        // Calculate elapsed time since entering this state
-        auto elapsed = duration_cast<milliseconds>(now - lastTransitionTime).count();
-        
-        if (elapsed >= timeout) {
-            // Timeout triggered, transition to target state
-            std::string oldStateId = currentStateId;
-            currentStateId = transition->getTargetId();
-            
-            // Reset timer, mark state entry, clear timeouts
-            lastTransitionTime = now;
-            justEnteredState = true;
-            timeoutActive.clear();
-            timeoutStartTimes.clear();
-            
-            // Process outputs from new state
-            State* newState = machine->getState(currentStateId);
-            if (newState) {
-                processStateOutputs(newState);
-            }
-            
-            return true; // We made a transition
-        }
+    // Timeout expired - clear the inputs that armed it (none for pure timeouts)
+    Transition* transition = table.getTransition(timer);
+    clearTriggeredInputs(transition);
+    
+    // Make the transition, which also cancels the other timeouts
+    enterState(transition->getTargetId(), now);
+    return true; // We made a transition
+}
+
+/**
+ * @brief Gets the time the simulation next has to be stepped
+ * 
+ * @return Time at which processInputs() should be called next
+ */
+steady_clock::time_point MachineSimulator::nextDeadline() const {
+    // A new state or input has to be evaluated right away
+    if (!settled) {
+        return lastTransitionTime;
+    }
+    return timeouts.nextDeadline();
+}
+
+/**
+ * @brief Waits on the machine's clock for the next pending step and makes it
+ * 
+ * On a virtual clock the wait jumps straight to the next timeout.
+ * 
+ * @param limit Latest time to wait for
+ * @return True if a step was made, false if nothing is pending until limit
+ * @throw std::runtime_error If the machine is not in a valid state
+ */
+bool MachineSimulator::advance(steady_clock::time_point limit) {
+    steady_clock::time_point deadline = nextDeadline();
+    if (!machine || deadline == steady_clock::time_point::max() || deadline > limit) {
+        return false;
     }
     
-    return false; // No timeout transitions triggered
+    MachineClock* clock = machine->getClock();
+    clock->sleepUntil(deadline);
+    processInputs(clock->now());
+    return true;
+}
+
+/**
+ * @brief Sets the clock the simulation runs on
+ * 
+ * @param clock The clock, must outlive the simulator and the machine
+ */
+void MachineSimulator::setClock(MachineClock* clock) {
+    if (machine) {
+        machine->setClock(clock);
+    }
 }
 
 /**
@@ -495,7 +617,7 @@ void MachineSimulator::clearTriggeredInputs(const Transition* transition) {
     for (const auto& inputCondition : transition->getInputConditions()) {
         // Only clear non-boolean inputs (we don't want to clear regular inputs for boolean expressions)
         if (!inputCondition.isBooleanExpr) {
-            inputValues[inputCondition.source] = ""; // Clear the input
+            getInputSlot(inputCondition.source).clear(); // Clear the input
         }
     }
 }
\ No newline at end of file
@@ -0,0 +1,615 @@
+/**
+ * @file machine_snapshot.cpp
+ * @brief Implementation of the SnapshotView and MachineSnapshot classes
+ * @author Hugo Bohácsek (xbohach00)
+ */
+
+#include "../headers/machine_snapshot.h"
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+using namespace SnapshotFormat;
+
+// The layout is shared with other processes, keep the records free of padding
+static_assert(sizeof(Header) == 56 + 16 * SECTION_COUNT, "Unexpected Header layout");
+static_assert(sizeof(StringRecord) == 8, "Unexpected StringRecord layout");
+static_assert(sizeof(VariableRecord) == 12, "Unexpected VariableRecord layout");
+static_assert(sizeof(StateRecord) == 48, "Unexpected StateRecord layout");
+static_assert(sizeof(OutputRecord) == 64, "Unexpected OutputRecord layout");
+static_assert(sizeof(TransitionRecord) == 24, "Unexpected TransitionRecord layout");
+static_assert(sizeof(ConditionRecord) == 24, "Unexpected ConditionRecord layout");
+static_assert(sizeof(InstructionRecord) == 8, "Unexpected InstructionRecord layout");
+static_assert(sizeof(ConstantRecord) == 8, "Unexpected ConstantRecord layout");
+static_assert(sizeof(float) == sizeof(uint32_t), "Float constants are stored in 32 bits");
+
+/** Size of a record of each section, indexed by Section */
+static const size_t RECORD_SIZES[SECTION_COUNT] = {
+    sizeof(StringRecord),
+    1,
+    sizeof(uint32_t),
+    sizeof(VariableRecord),
+    sizeof(StateRecord),
+    sizeof(OutputRecord),
+    sizeof(TransitionRecord),
+    sizeof(ConditionRecord),
+    sizeof(InstructionRecord),
+    sizeof(ConstantRecord)
+};
+
+/**
+ * @struct SnapshotBuilder
+ * @brief Sections of a snapshot being written
+ */
+struct SnapshotBuilder {
+    std::vector<StringRecord> strings;                       /**< STRINGS */
+    std::string stringData;                                  /**< STRING_DATA */
+    std::unordered_map<std::string, uint32_t> stringIndices; /**< Index of every interned string */
+    std::vector<uint32_t> stringLists;                       /**< STRING_LISTS */
+    std::vector<VariableRecord> variables;                   /**< VARIABLES */
+    std::vector<StateRecord> states;                         /**< STATES */
+    std::vector<OutputRecord> outputs;                       /**< OUTPUTS */
+    std::vector<TransitionRecord> transitions;               /**< TRANSITIONS */
+    std::vector<ConditionRecord> conditions;                 /**< CONDITIONS */
+    std::vector<InstructionRecord> instructions;             /**< INSTRUCTIONS */
+    std::vector<ConstantRecord> constants;                   /**< CONSTANTS */
+
+    /**
+     * @brief Gets the index of a string, storing it on first use
+     *
+     * @param text The string
+     * @return Index of the string
+     */
+    uint32_t intern(const std::string& text) {
+        auto it = stringIndices.find(text);
+        if (it != stringIndices.end()) {
+            return it->second;
+        }
+
+        uint32_t index = static_cast<uint32_t>(strings.size());
+        strings.push_back(StringRecord{static_cast<uint32_t>(stringData.size()), static_cast<uint32_t>(text.size())});
+        stringData += text;
+        stringData += '\0';
+        stringIndices.emplace(text, index);
+        return index;
+    }
+
+    /**
+     * @brief Appends a list of strings to STRING_LISTS
+     *
+     * @param items The strings
+     * @return Where the list is stored
+     */
+    template <typename Strings>
+    Range addList(const Strings& items) {
+        Range range{static_cast<uint32_t>(stringLists.size()), 0};
+        for (const std::string& item : items) {
+            stringLists.push_back(intern(item));
+            range.count++;
+        }
+        return range;
+    }
+
+    /**
+     * @brief Appends a compiled program to INSTRUCTIONS, CONSTANTS and STRING_LISTS
+     *
+     * @param program The program
+     * @param record Output statement the program belongs to
+     */
+    void addProgram(const ExpressionProgram& program, OutputRecord& record) {
+        record.code = Range{static_cast<uint32_t>(instructions.size()), static_cast<uint32_t>(program.size())};
+        for (const Instruction& instruction : program.getInstructions()) {
+            InstructionRecord stored{};
+            stored.op = static_cast<uint8_t>(instruction.op);
+            stored.kind = static_cast<uint8_t>(instruction.kind);
+            stored.operation = instruction.operation;
+            stored.index = instruction.index;
+            instructions.push_back(stored);
+        }
+
+        record.constants = Range{static_cast<uint32_t>(constants.size()), static_cast<uint32_t>(program.getConstantCount())};
+        for (size_t i = 0; i < program.getConstantCount(); i++) {
+            const MachineVariable& constant = program.getConstant(static_cast<int>(i));
+            ConstantRecord stored{static_cast<uint32_t>(constant.getType()), 0};
+            VariableValue value = constant.getValue();
+            if (std::holds_alternative<int>(value)) {
+                stored.value = static_cast<uint32_t>(std::get<int>(value));
+            } else if (std::holds_alternative<float>(value)) {
+                float number = std::get<float>(value);
+                std::memcpy(&stored.value, &number, sizeof(number));
+            } else {
+                stored.value = intern(std::get<std::string>(value));
+            }
+            constants.push_back(stored);
+        }
+
+        record.slots = Range{static_cast<uint32_t>(stringLists.size()), static_cast<uint32_t>(program.getSlotCount())};
+        for (size_t i = 0; i < program.getSlotCount(); i++) {
+            stringLists.push_back(intern(program.getSlotName(static_cast<int>(i))));
+        }
+
+        record.errors = Range{static_cast<uint32_t>(stringLists.size()), static_cast<uint32_t>(program.getErrorCount())};
+        for (size_t i = 0; i < program.getErrorCount(); i++) {
+            stringLists.push_back(intern(program.getError(static_cast<int>(i))));
+        }
+    }
+};
+
+/**
+ * @brief Writes a section padded to the alignment of the next one
+ *
+ * @param file File to write to
+ * @param records Records of the section
+ */
+template <typename Container>
+static void writeSection(std::ofstream& file, const Container& records) {
+    static const char padding[ALIGNMENT] = {};
+    size_t bytes = records.size() * sizeof(records[0]);
+    file.write(reinterpret_cast<const char*>(records.data()), static_cast<std::streamsize>(bytes));
+    file.write(padding, static_cast<std::streamsize>((ALIGNMENT - bytes % ALIGNMENT) % ALIGNMENT));
+}
+
+/**
+ * @brief Constructor, maps the snapshot and checks its layout
+ *
+ * @param filename Path to the snapshot
+ * @throw std::runtime_error If the file cannot be opened or is not a snapshot of this version
+ */
+SnapshotView::SnapshotView(const std::string& filename) : file(filename), header(nullptr) {
+    std::string_view bytes = file.getText();
+    if (bytes.size() < sizeof(Header) || std::memcmp(bytes.data(), MAGIC, sizeof(MAGIC)) != 0) {
+        throw std::runtime_error("Not a machine snapshot: " + filename);
+    }
+    if (reinterpret_cast<uintptr_t>(bytes.data()) % alignof(Header) != 0) {
+        throw std::runtime_error("Snapshot is not aligned in memory: " + filename);
+    }
+
+    header = reinterpret_cast<const Header*>(bytes.data());
+    if (header->byteOrder != BYTE_ORDER_MARK) {
+        throw std::runtime_error("Snapshot was written with another byte order: " + filename);
+    }
+    if (header->version != VERSION) {
+        throw std::runtime_error("Unsupported snapshot version " + std::to_string(header->version) + ": " + filename);
+    }
+    if (header->size != bytes.size()) {
+        throw std::runtime_error("Truncated snapshot: " + filename);
+    }
+
+    for (uint32_t i = 0; i < SECTION_COUNT; i++) {
+        const SectionEntry& entry = header->sections[i];
+        if (entry.offset % ALIGNMENT != 0 || entry.offset < sizeof(Header) || entry.offset > bytes.size() ||
+            entry.count > (bytes.size() - entry.offset) / RECORD_SIZES[i]) {
+            throw std::runtime_error("Corrupted snapshot section " + std::to_string(i) + ": " + filename);
+        }
+    }
+}
+
+/**
+ * @brief Gets all records of a section
+ *
+ * @param section The section
+ * @return The records
+ */
+template <typename Record>
+SnapshotSpan<Record> SnapshotView::section(Section section) const {
+    const SectionEntry& entry = header->sections[section];
+    const Record* first = reinterpret_cast<const Record*>(file.getText().data() + entry.offset);
+    return SnapshotSpan<Record>{first, first + entry.count};
+}
+
+/**
+ * @brief Gets a run of records of a section
+ *
+ * @param section The section
+ * @param range The run
+ * @return The records
+ * @throw std::runtime_error If the run does not lie in the section
+ */
+template <typename Record>
+SnapshotSpan<Record> SnapshotView::slice(Section section, Range range) const {
+    SnapshotSpan<Record> records = this->section<Record>(section);
+    if (static_cast<uint64_t>(range.first) + range.count > records.size()) {
+        throw std::runtime_error("Corrupted snapshot: range outside of section " + std::to_string(section));
+    }
+    return SnapshotSpan<Record>{records.first + range.first, records.first + range.first + range.count};
+}
+
+/**
+ * @brief Gets the header
+ *
+ * @return The header
+ */
+const Header& SnapshotView::getHeader() const {
+    return *header;
+}
+
+/**
+ * @brief Gets an interned string
+ *
+ * @param index Index of the string
+ * @return View of the string, valid while the view lives
+ * @throw std::runtime_error If there is no such string
+ */
+std::string_view SnapshotView::getString(uint32_t index) const {
+    SnapshotSpan<StringRecord> strings = section<StringRecord>(STRINGS);
+    SnapshotSpan<char> data = section<char>(STRING_DATA);
+    if (index >= strings.size() ||
+        static_cast<uint64_t>(strings[index].offset) + strings[index].length >= data.size()) {
+        throw std::runtime_error("Corrupted snapshot: string " + std::to_string(index) + " out of range");
+    }
+    return std::string_view(data.first + strings[index].offset, strings[index].length);
+}
+
+/**
+ * @brief Gets a run of string indices
+ *
+ * @param range The run in STRING_LISTS
+ * @return The string indices
+ */
+SnapshotSpan<uint32_t> SnapshotView::getStringList(Range range) const {
+    return slice<uint32_t>(STRING_LISTS, range);
+}
+
+/**
+ * @brief Gets all variables
+ *
+ * @return The variables
+ */
+SnapshotSpan<VariableRecord> SnapshotView::getVariables() const {
+    return section<VariableRecord>(VARIABLES);
+}
+
+/**
+ * @brief Gets all states
+ *
+ * @return The states, indexed by state index
+ */
+SnapshotSpan<StateRecord> SnapshotView::getStates() const {
+    return section<StateRecord>(STATES);
+}
+
+/**
+ * @brief Gets the output statements of a state
+ *
+ * @param state The state
+ * @return The output statements
+ */
+SnapshotSpan<OutputRecord> SnapshotView::getOutputs(const StateRecord& state) const {
+    return slice<OutputRecord>(OUTPUTS, state.outputs);
+}
+
+/**
+ * @brief Gets all transitions
+ *
+ * @return The transitions, grouped by source state
+ */
+SnapshotSpan<TransitionRecord> SnapshotView::getTransitions() const {
+    return section<TransitionRecord>(TRANSITIONS);
+}
+
+/**
+ * @brief Gets the transitions leaving a state
+ *
+ * @param state The state
+ * @return The outgoing transitions
+ */
+SnapshotSpan<TransitionRecord> SnapshotView::getTransitions(const StateRecord& state) const {
+    return slice<TransitionRecord>(TRANSITIONS, state.transitions);
+}
+
+/**
+ * @brief Gets the input conditions of a transition
+ *
+ * @param transition The transition
+ * @return The input conditions
+ */
+SnapshotSpan<ConditionRecord> SnapshotView::getConditions(const TransitionRecord& transition) const {
+    return slice<ConditionRecord>(CONDITIONS, transition.conditions);
+}
+
+/**
+ * @brief Gets the instructions of a compiled output statement
+ *
+ * @param output The output statement
+ * @return The instructions
+ */
+SnapshotSpan<InstructionRecord> SnapshotView::getInstructions(const OutputRecord& output) const {
+    return slice<InstructionRecord>(INSTRUCTIONS, output.code);
+}
+
+/**
+ * @brief Gets the literals of a compiled output statement
+ *
+ * @param output The output statement
+ * @return The literals
+ */
+SnapshotSpan<ConstantRecord> SnapshotView::getConstants(const OutputRecord& output) const {
+    return slice<ConstantRecord>(CONSTANTS, output.constants);
+}
+
+/**
+ * @brief Saves a machine as a snapshot
+ *
+ * States are stored in the order of MooreMachine::getAllStates(), each
+ * followed in TRANSITIONS by its outgoing transitions. Output statements are
+ * compiled while saving.
+ *
+ * @param machine The machine to save
+ * @param filename Path to the snapshot
+ * @return True if saving succeeded, false otherwise
+ */
+bool MachineSnapshot::saveToFile(const MooreMachine& machine, const std::string& filename) {
+    MooreMachine& source = const_cast<MooreMachine&>(machine);
+    SnapshotBuilder builder;
+    ExpressionParser parser;
+
+    Header header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.byteOrder = BYTE_ORDER_MARK;
+    header.name = builder.intern(machine.getName());
+    header.inputAlphabet = builder.addList(machine.getInputAlphabet());
+    header.outputAlphabet = builder.addList(machine.getOutputAlphabet());
+    header.inputPointers = builder.addList(machine.getInputPointers());
+    header.outputPointers = builder.addList(machine.getOutputPointers());
+
+    for (const auto& variablePair : machine.getVariablesView()) {
+        const MachineVariable& variable = variablePair.second;
+        builder.variables.push_back(VariableRecord{builder.intern(variablePair.first),
+                                                   static_cast<uint32_t>(variable.getType()),
+                                                   builder.intern(variable.getValueString())});
+    }
+
+    std::vector<State*> states = source.getAllStates();
+    std::unordered_map<std::string, uint32_t> stateIndices;
+    stateIndices.reserve(states.size());
+    for (State* state : states) {
+        stateIndices.emplace(state->getId(), static_cast<uint32_t>(stateIndices.size()));
+    }
+
+    for (State* state : states) {
+        StateRecord record{};
+        record.x = state->getPosition().x;
+        record.y = state->getPosition().y;
+        record.id = builder.intern(state->getId());
+        record.name = builder.intern(state->getName());
+        record.flags = state->getIsInitial() ? INITIAL : 0u;
+
+        record.outputs = Range{static_cast<uint32_t>(builder.outputs.size()), static_cast<uint32_t>(state->getOutputs().size())};
+        for (const OutputCondition& output : state->getOutputs()) {
+            CompiledOutput compiled = parser.compileOutput(output);
+            OutputRecord stored{};
+            stored.value = builder.intern(output.value);
+            stored.target = builder.intern(output.target);
+            stored.inputPtr = builder.intern(output.inputPtr);
+            stored.flags = (output.hasCondition ? HAS_CONDITION : 0u) | (compiled.hasCondition ? COMPILED_CONDITION : 0u);
+            stored.action = static_cast<uint32_t>(compiled.action);
+            stored.compiledTarget = builder.intern(compiled.target);
+            stored.compiledSource = builder.intern(compiled.source);
+            stored.conditionPtr = builder.intern(compiled.conditionPtr);
+            builder.addProgram(compiled.program, stored);
+            builder.outputs.push_back(stored);
+        }
+
+        TransitionSpan outgoing = source.getOutgoingTransitions(state->getId());
+        record.transitions = Range{static_cast<uint32_t>(builder.transitions.size()), static_cast<uint32_t>(outgoing.size())};
+        for (Transition* transition : outgoing) {
+            TransitionRecord stored{};
+            stored.id = builder.intern(transition->getId());
+            stored.source = stateIndices.at(transition->getSourceId());
+            stored.target = stateIndices.at(transition->getTargetId());
+            stored.timeout = transition->getTimeout();
+            stored.conditions = Range{static_cast<uint32_t>(builder.conditions.size()),
+                                      static_cast<uint32_t>(transition->getInputConditions().size())};
+            for (const InputCondition& condition : transition->getInputConditions()) {
+                builder.conditions.push_back(ConditionRecord{condition.isBooleanExpr ? BOOLEAN : 0u,
+                                                             builder.intern(condition.value),
+                                                             builder.intern(condition.source),
+                                                             builder.intern(condition.leftOperand),
+                                                             builder.intern(condition.operation),
+                                                             builder.intern(condition.rightOperand)});
+            }
+            builder.transitions.push_back(stored);
+        }
+        builder.states.push_back(record);
+    }
+
+    // Indices and offsets are 32-bit
+    if (builder.stringData.size() > std::numeric_limits<uint32_t>::max() ||
+        builder.stringLists.size() > std::numeric_limits<uint32_t>::max() ||
+        builder.conditions.size() > std::numeric_limits<uint32_t>::max() ||
+        builder.instructions.size() > std::numeric_limits<uint32_t>::max()) {
+        return false;
+    }
+
+    const size_t counts[SECTION_COUNT] = {
+        builder.strings.size(), builder.stringData.size(), builder.stringLists.size(),
+        builder.variables.size(), builder.states.size(), builder.outputs.size(),
+        builder.transitions.size(), builder.conditions.size(), builder.instructions.size(),
+        builder.constants.size()
+    };
+    uint64_t offset = sizeof(Header);
+    for (uint32_t i = 0; i < SECTION_COUNT; i++) {
+        header.sections[i] = SectionEntry{offset, counts[i]};
+        offset += (counts[i] * RECORD_SIZES[i] + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+    }
+    header.size = offset;
+
+    std::ofstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    writeSection(file, builder.strings);
+    writeSection(file, builder.stringData);
+    writeSection(file, builder.stringLists);
+    writeSection(file, builder.variables);
+    writeSection(file, builder.states);
+    writeSection(file, builder.outputs);
+    writeSection(file, builder.transitions);
+    writeSection(file, builder.conditions);
+    writeSection(file, builder.instructions);
+    writeSection(file, builder.constants);
+    return file.good();
+}
+
+/**
+ * @brief Rebuilds a compiled output statement stored in a snapshot
+ *
+ * @param view The snapshot
+ * @param record The stored statement
+ * @return The compiled statement
+ * @throw std::runtime_error If the statement refers outside of the snapshot
+ */
+static CompiledOutput loadCompiledOutput(const SnapshotView& view, const OutputRecord& record) {
+    if (record.action > static_cast<uint32_t>(OutputAction::INVALID)) {
+        throw std::runtime_error("Corrupted snapshot: unknown output action " + std::to_string(record.action));
+    }
+
+    CompiledOutput compiled;
+    compiled.action = static_cast<OutputAction>(record.action);
+    compiled.target = std::string(view.getString(record.compiledTarget));
+    compiled.source = std::string(view.getString(record.compiledSource));
+    compiled.hasCondition = (record.flags & COMPILED_CONDITION) != 0;
+    compiled.conditionPtr = std::string(view.getString(record.conditionPtr));
+
+    ExpressionProgram& program = compiled.program;
+    for (const ConstantRecord& constant : view.getConstants(record)) {
+        MachineVariable value("int", "temp", "0");
+        if (constant.type == static_cast<uint32_t>(VariableType::FLOAT)) {
+            float number;
+            std::memcpy(&number, &constant.value, sizeof(number));
+            value.setFloatValue(number);
+        } else if (constant.type == static_cast<uint32_t>(VariableType::STRING)) {
+            value = MachineVariable("string", "temp", std::string(view.getString(constant.value)));
+        } else if (constant.type == static_cast<uint32_t>(VariableType::INT)) {
+            value.setIntValue(static_cast<int>(constant.value));
+        } else {
+            throw std::runtime_error("Corrupted snapshot: unknown constant type " + std::to_string(constant.type));
+        }
+        program.addConstant(value);
+    }
+    for (uint32_t name : view.getStringList(record.slots)) {
+        program.addSlot(std::string(view.getString(name)));
+    }
+    for (uint32_t message : view.getStringList(record.errors)) {
+        program.addError(std::string(view.getString(message)));
+    }
+
+    // Instructions index the pools directly, check them once here instead of on every run
+    for (const InstructionRecord& instruction : view.getInstructions(record)) {
+        OpCode op = static_cast<OpCode>(instruction.op);
+        OperandKind kind = static_cast<OperandKind>(instruction.kind);
+        size_t limit = 1;
+        if (op == OpCode::FAIL) {
+            limit = record.errors.count;
+        } else if (kind == OperandKind::CONSTANT) {
+            limit = record.constants.count;
+        } else if (kind == OperandKind::VARIABLE) {
+            limit = record.slots.count;
+        }
+        if (instruction.op > static_cast<uint8_t>(OpCode::FAIL) ||
+            instruction.kind > static_cast<uint8_t>(OperandKind::NONE) ||
+            instruction.index < 0 || static_cast<size_t>(instruction.index) >= limit) {
+            throw std::runtime_error("Corrupted snapshot: invalid instruction");
+        }
+        program.append(op, kind, instruction.operation, instruction.index);
+    }
+    return compiled;
+}
+
+/**
+ * @brief Loads a machine from a snapshot
+ *
+ * @param filename Path to the snapshot
+ * @return Loaded MooreMachine object
+ * @throw std::runtime_error If the file cannot be read or is not a valid snapshot
+ */
+MooreMachine MachineSnapshot::loadFromFile(const std::string& filename) {
+    SnapshotView view(filename);
+    const Header& header = view.getHeader();
+    MooreMachine machine{std::string(view.getString(header.name))};
+
+    for (uint32_t symbol : view.getStringList(header.inputAlphabet)) {
+        machine.addInputSymbol(std::string(view.getString(symbol)));
+    }
+    for (uint32_t symbol : view.getStringList(header.outputAlphabet)) {
+        machine.addOutputSymbol(std::string(view.getString(symbol)));
+    }
+    for (uint32_t pointer : view.getStringList(header.inputPointers)) {
+        machine.addInputPointer(std::string(view.getString(pointer)));
+    }
+    for (uint32_t pointer : view.getStringList(header.outputPointers)) {
+        machine.addOutputPointer(std::string(view.getString(pointer)));
+    }
+
+    for (const VariableRecord& variable : view.getVariables()) {
+        std::string name(view.getString(variable.name));
+        std::string type = typeToString(static_cast<VariableType>(variable.type));
+        if (!machine.addVariable(type, name, std::string(view.getString(variable.value)))) {
+            throw std::runtime_error("Corrupted snapshot: invalid value of variable " + name);
+        }
+    }
+
+    SnapshotSpan<StateRecord> states = view.getStates();
+    std::vector<std::string> stateIds;
+    stateIds.reserve(states.size());
+    std::string initialStateId;
+    for (const StateRecord& record : states) {
+        State state(std::string(view.getString(record.id)), std::string(view.getString(record.name)));
+        state.setPosition(Point(record.x, record.y));
+
+        std::vector<CompiledOutput> compiled;
+        for (const OutputRecord& output : view.getOutputs(record)) {
+            state.addOutput(OutputCondition(std::string(view.getString(output.value)),
+                                            std::string(view.getString(output.target)),
+                                            std::string(view.getString(output.inputPtr)),
+                                            (output.flags & HAS_CONDITION) != 0));
+            compiled.push_back(loadCompiledOutput(view, output));
+        }
+
+        if (!machine.addState(state)) {
+            throw std::runtime_error("Corrupted snapshot: duplicate state " + state.getId());
+        }
+        machine.setCompiledOutputs(state.getId(), std::move(compiled));
+        if (record.flags & INITIAL) {
+            initialStateId = state.getId();
+        }
+        stateIds.push_back(state.getId());
+    }
+    if (!initialStateId.empty()) {
+        machine.setInitialState(initialStateId);
+    }
+
+    SnapshotSpan<TransitionRecord> transitions = view.getTransitions();
+    machine.reserveTransitions(transitions.size());
+    std::vector<InputCondition> conditions;
+    for (const TransitionRecord& record : transitions) {
+        if (record.source >= stateIds.size() || record.target >= stateIds.size()) {
+            throw std::runtime_error("Corrupted snapshot: transition to an unknown state");
+        }
+
+        conditions.clear();
+        for (const ConditionRecord& stored : view.getConditions(record)) {
+            InputCondition condition;
+            condition.isBooleanExpr = (stored.flags & BOOLEAN) != 0;
+            condition.value = std::string(view.getString(stored.value));
+            condition.source = std::string(view.getString(stored.source));
+            condition.leftOperand = std::string(view.getString(stored.left));
+            condition.operation = std::string(view.getString(stored.operation));
+            condition.rightOperand = std::string(view.getString(stored.right));
+            conditions.push_back(std::move(condition));
+        }
+
+        Transition transition(std::string(view.getString(record.id)), stateIds[record.source],
+                              stateIds[record.target], conditions, record.timeout);
+        if (!machine.addTransition(transition)) {
+            throw std::runtime_error("Corrupted snapshot: duplicate transition " + transition.getId());
+        }
+    }
+
+    return machine;
+}
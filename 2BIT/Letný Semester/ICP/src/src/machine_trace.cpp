@@ -0,0 +1,397 @@
+/**
+ * @file machine_trace.cpp
+ * @brief Implementation of the TraceWriter and TraceReader classes
+ * @author Hugo Bohácsek (xbohach00)
+ */
+
+#include "../headers/machine_trace.h"
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+
+using namespace std::chrono;
+
+/** Size at which the buffered records are written out */
+static constexpr size_t FLUSH_SIZE = 64 * 1024;
+
+/**
+ * @brief Constructor, creates the trace file and writes its header
+ *
+ * @param filename Path of the trace file
+ * @throw std::runtime_error If the file cannot be created
+ */
+TraceWriter::TraceWriter(const std::string& filename)
+    : file(filename, std::ios::binary | std::ios::trunc), lastTime(-1), records(0) {
+    if (!file.is_open()) {
+        throw std::runtime_error("Could not create trace file: " + filename);
+    }
+    buffer.reserve(FLUSH_SIZE);
+    buffer.append(TraceFormat::MAGIC, sizeof(TraceFormat::MAGIC));
+    buffer += static_cast<char>(TraceFormat::VERSION);
+}
+
+/**
+ * @brief Destructor, writes what is left in the buffer
+ */
+TraceWriter::~TraceWriter() {
+    try {
+        flush();
+    } catch (const std::exception&) {
+        // Nothing to report a failure to from here
+    }
+}
+
+/**
+ * @brief Starts a record
+ *
+ * @param type Type of the record
+ * @param now Time of the record, clamped so records never go back in time
+ */
+void TraceWriter::beginRecord(TraceFormat::RecordType type, steady_clock::time_point now) {
+    if (lastTime < 0) {
+        origin = now;
+        lastTime = 0;
+    }
+    long long time = std::max(lastTime, static_cast<long long>(duration_cast<microseconds>(now - origin).count()));
+
+    buffer += static_cast<char>(type);
+    writeVarint(static_cast<uint64_t>(time - lastTime));
+    lastTime = time;
+    records++;
+}
+
+/**
+ * @brief Appends a varint
+ *
+ * @param value The integer
+ */
+void TraceWriter::writeVarint(uint64_t value) {
+    while (value >= 0x80) {
+        buffer += static_cast<char>((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    buffer += static_cast<char>(value);
+}
+
+/**
+ * @brief Appends a string reference, and the string itself on its first use
+ *
+ * @param value The string
+ */
+void TraceWriter::writeString(const std::string& value) {
+    auto it = strings.find(value);
+    if (it != strings.end()) {
+        writeVarint(it->second + 1);
+        return;
+    }
+    strings.emplace(value, strings.size());
+    writeVarint(0);
+    writeVarint(value.size());
+    buffer += value;
+}
+
+/**
+ * @brief Writes a full buffer to the file
+ */
+void TraceWriter::flushIfFull() {
+    if (buffer.size() >= FLUSH_SIZE) {
+        flush();
+    }
+}
+
+/**
+ * @brief Writes the buffered records to the file
+ *
+ * @throw std::runtime_error If writing fails
+ */
+void TraceWriter::flush() {
+    file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    file.flush();
+    buffer.clear();
+    if (!file) {
+        throw std::runtime_error("Could not write the trace file");
+    }
+}
+
+/**
+ * @brief Records that the simulation went back to the initial state
+ *
+ * @param now Time of the reset
+ */
+void TraceWriter::recordReset(steady_clock::time_point now) {
+    beginRecord(TraceFormat::RESET, now);
+    flushIfFull();
+}
+
+/**
+ * @brief Records a machine that was already running when recording started
+ *
+ * @param now Time of the observation
+ * @param stateId Current state
+ * @param enteredAt Time the state was entered, now if not known
+ * @param inputs Current input values
+ * @param outputs Current output values
+ * @param variables Current variable values
+ */
+void TraceWriter::recordSync(steady_clock::time_point now, const std::string& stateId,
+                             steady_clock::time_point enteredAt,
+                             const std::vector<std::pair<std::string, std::string>>& inputs,
+                             const std::vector<std::pair<std::string, std::string>>& outputs,
+                             const std::vector<std::pair<std::string, std::string>>& variables) {
+    beginRecord(TraceFormat::SYNC, now);
+    writeString(stateId);
+    writeVarint(static_cast<uint64_t>(std::max<long long>(0, duration_cast<microseconds>(now - enteredAt).count())));
+    writeVarint(inputs.size() + outputs.size() + variables.size());
+    lastState = stateId;
+
+    // Seed records carry every value, even ones written before
+    for (const auto& [inputPtr, value] : inputs) {
+        beginRecord(TraceFormat::INPUT, now);
+        writeString(inputPtr);
+        writeString(value);
+    }
+    for (const auto& [outputPtr, value] : outputs) {
+        beginRecord(TraceFormat::OUTPUT, now);
+        writeString(outputPtr);
+        writeString(value);
+        lastOutputs[outputPtr] = value;
+    }
+    for (const auto& [name, value] : variables) {
+        beginRecord(TraceFormat::VARIABLE, now);
+        writeString(name);
+        writeString(value);
+        lastVariables[name] = value;
+    }
+    flushIfFull();
+}
+
+/**
+ * @brief Records an input set and processed
+ *
+ * @param now Time of the input
+ * @param inputPtr Input pointer
+ * @param value Input value
+ */
+void TraceWriter::recordInput(steady_clock::time_point now, const std::string& inputPtr, const std::string& value) {
+    beginRecord(TraceFormat::INPUT, now);
+    writeString(inputPtr);
+    writeString(value);
+    flushIfFull();
+}
+
+/**
+ * @brief Records the current state, if it changed
+ *
+ * @param now Time of the change
+ * @param stateId Current state
+ */
+void TraceWriter::recordState(steady_clock::time_point now, const std::string& stateId) {
+    if (stateId == lastState) {
+        return;
+    }
+    lastState = stateId;
+    beginRecord(TraceFormat::STATE, now);
+    writeString(stateId);
+    flushIfFull();
+}
+
+/**
+ * @brief Records the value of an output, if it changed
+ *
+ * @param now Time of the change
+ * @param outputPtr Output pointer
+ * @param value Output value
+ */
+void TraceWriter::recordOutput(steady_clock::time_point now, const std::string& outputPtr, const std::string& value) {
+    auto it = lastOutputs.find(outputPtr);
+    if (it != lastOutputs.end() && it->second == value) {
+        return;
+    }
+    lastOutputs[outputPtr] = value;
+    beginRecord(TraceFormat::OUTPUT, now);
+    writeString(outputPtr);
+    writeString(value);
+    flushIfFull();
+}
+
+/**
+ * @brief Records the value of a variable, if it changed
+ *
+ * @param now Time of the change
+ * @param name Variable name
+ * @param value Variable value as text
+ */
+void TraceWriter::recordVariable(steady_clock::time_point now, const std::string& name, const std::string& value) {
+    auto it = lastVariables.find(name);
+    if (it != lastVariables.end() && it->second == value) {
+        return;
+    }
+    lastVariables[name] = value;
+    beginRecord(TraceFormat::VARIABLE, now);
+    writeString(name);
+    writeString(value);
+    flushIfFull();
+}
+
+/**
+ * @brief Records the state, outputs and variables of a simulation that changed
+ *
+ * @param now Time of the observation
+ * @param simulator The simulator
+ * @param machine The machine it simulates
+ */
+void TraceWriter::recordChanges(steady_clock::time_point now, const MachineSimulator& simulator,
+                                const MooreMachine& machine) {
+    State* state = simulator.getCurrentState();
+    if (state) {
+        recordState(now, state->getId());
+    }
+    for (const auto& [outputPtr, value] : simulator.getAllOutputs()) {
+        recordOutput(now, outputPtr, value);
+    }
+    for (const auto& [name, variable] : machine.getVariablesView()) {
+        recordVariable(now, name, variable.getValueString());
+    }
+}
+
+/**
+ * @brief Records a simulation that was already running when recording started
+ *
+ * @param now Time of the observation
+ * @param simulator The simulator
+ * @param machine The machine it simulates
+ */
+void TraceWriter::recordSync(steady_clock::time_point now, const MachineSimulator& simulator,
+                             const MooreMachine& machine) {
+    State* state = simulator.getCurrentState();
+    if (!state) {
+        return;
+    }
+    std::vector<std::pair<std::string, std::string>> variables;
+    for (const auto& [name, variable] : machine.getVariablesView()) {
+        variables.emplace_back(name, variable.getValueString());
+    }
+    recordSync(now, state->getId(), simulator.getStateEntryTime(), simulator.getAllInputs(),
+               simulator.getAllOutputs(), variables);
+}
+
+/**
+ * @brief Gets the number of records written
+ *
+ * @return Number of records, seed records included
+ */
+size_t TraceWriter::getRecordCount() const {
+    return records;
+}
+
+/**
+ * @brief Constructor, reads the file and checks its header
+ *
+ * @param filename Path of the trace file
+ * @throw std::runtime_error If the file cannot be read or is not a trace
+ */
+TraceReader::TraceReader(const std::string& filename) : position(0), time(0) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Could not open trace file: " + filename);
+    }
+    data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+
+    if (data.size() < sizeof(TraceFormat::MAGIC) + 1 ||
+        !std::equal(TraceFormat::MAGIC, TraceFormat::MAGIC + sizeof(TraceFormat::MAGIC), data.begin())) {
+        throw std::runtime_error("Not a trace file: " + filename);
+    }
+    if (static_cast<uint8_t>(data[sizeof(TraceFormat::MAGIC)]) != TraceFormat::VERSION) {
+        throw std::runtime_error("Unsupported trace version in " + filename);
+    }
+    position = sizeof(TraceFormat::MAGIC) + 1;
+}
+
+/**
+ * @brief Reads a varint
+ *
+ * @return The integer
+ * @throw std::runtime_error If the varint is truncated or too long
+ */
+uint64_t TraceReader::readVarint() {
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (position >= data.size()) {
+            throw std::runtime_error("Truncated trace");
+        }
+        uint8_t byte = static_cast<uint8_t>(data[position++]);
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            return value;
+        }
+    }
+    throw std::runtime_error("Malformed number in trace");
+}
+
+/**
+ * @brief Reads a string reference, and the string itself on its first use
+ *
+ * @return The string
+ * @throw std::runtime_error If the reference is unknown or the string truncated
+ */
+const std::string& TraceReader::readString() {
+    uint64_t reference = readVarint();
+    if (reference > 0) {
+        if (reference > strings.size()) {
+            throw std::runtime_error("Unknown string " + std::to_string(reference) + " in trace");
+        }
+        return strings[reference - 1];
+    }
+
+    uint64_t length = readVarint();
+    if (length > data.size() - position) {
+        throw std::runtime_error("Truncated trace");
+    }
+    strings.emplace_back(data, position, length);
+    position += length;
+    return strings.back();
+}
+
+/**
+ * @brief Reads the next record
+ *
+ * @param record Where the record is stored
+ * @return False at the end of the trace
+ * @throw std::runtime_error If the record is truncated or of an unknown type
+ */
+bool TraceReader::next(TraceRecord& record) {
+    if (position >= data.size()) {
+        return false;
+    }
+
+    uint8_t type = static_cast<uint8_t>(data[position++]);
+    time += static_cast<long long>(readVarint());
+    record.type = static_cast<TraceFormat::RecordType>(type);
+    record.time = time;
+    record.name.clear();
+    record.value.clear();
+    record.elapsed = 0;
+    record.count = 0;
+
+    switch (type) {
+        case TraceFormat::RESET:
+            break;
+        case TraceFormat::SYNC:
+            record.name = readString();
+            record.elapsed = static_cast<long long>(readVarint());
+            record.count = readVarint();
+            break;
+        case TraceFormat::STATE:
+            record.name = readString();
+            break;
+        case TraceFormat::INPUT:
+        case TraceFormat::OUTPUT:
+        case TraceFormat::VARIABLE:
+            record.name = readString();
+            record.value = readString();
+            break;
+        default:
+            throw std::runtime_error("Unknown record type " + std::to_string(type) + " in trace");
+    }
+    return true;
+}
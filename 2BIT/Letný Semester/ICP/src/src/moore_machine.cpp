@@ -5,6 +5,7 @@
  */
 
 #include "../headers/moore_machine.h"
+#include "../headers/machine_minimizer.h"
 #include <algorithm>
 #include <stdexcept>
 #include <chrono>
@@ -20,21 +21,43 @@ using namespace std::chrono;
  */
 MooreMachine::MooreMachine(const std::string& name) 
     : name(name), currentStateId(""), 
-    stateEntryTime(steady_clock::now()) {}
+    clock(&SystemClock::instance()), stateEntryTime(clock->now()) {}
 
 /**
  * @brief Adds a state to the machine
  * 
+ * The state takes the slot of a removed state if there is one.
+ * 
  * @param state The state to add
  * @return True if the state was added successfully, false if a state with the same ID already exists
  */
 bool MooreMachine::addState(const State& state) {
     // Check if state with same ID already exists
-    if (states.find(state.getId()) != states.end()) {
+    if (getStateHandle(state.getId()) != NO_HANDLE) {
         return false;
     }
 
-    states[state.getId()] = state;
+    StateHandle handle;
+    if (!freeStates.empty()) {
+        handle = freeStates.back();
+        freeStates.pop_back();
+        stateSlots[handle].state = state;
+        stateSlots[handle].live = true;
+    } else {
+        handle = static_cast<StateHandle>(stateSlots.size());
+        stateSlots.push_back(StateSlot{state, {}, {}, true});
+    }
+    stateIndex.insert(state.getId(), handle);
+
+    // The first state with a name is the one found by it
+    StateHandle sameName = stateNameIndex.find(state.getName(), [this](uint32_t h) -> const std::string& {
+        return stateSlots[h].state.getName();
+    });
+    if (sameName == NO_HANDLE) {
+        stateNameIndex.insert(state.getName(), handle);
+    }
+    stateOutputs.erase(state.getId());
+    invalidateTransitionTable();
 
     // Add outputs to the output alphabet
     for (const auto& output : state.getOutputs()) {
@@ -51,45 +74,49 @@ bool MooreMachine::addState(const State& state) {
 /**
  * @brief Removes a state from the machine
  * 
- * Also removes all transitions to and from this state
+ * Also removes all transitions to and from this state, found through its adjacency lists
  * 
  * @param stateId ID of the state to remove
  * @return True if the state was removed successfully, false if it doesn't exist
  */
 bool MooreMachine::removeState(const std::string& stateId) {
     // Check if state exists
-    auto stateIt = states.find(stateId);
-    if (stateIt == states.end()) {
+    StateHandle handle = getStateHandle(stateId);
+    if (handle == NO_HANDLE) {
         return false;
     }
+    StateSlot& slot = stateSlots[handle];
     
     // Check if this is the initial state
-    bool isInitial = stateIt->second.getIsInitial();
+    bool isInitial = slot.state.getIsInitial();
     
-    // Remove all transitions to and from this state
-    std::vector<std::string> transitionsToRemove;
-    for (const auto& transition : transitions) {
-        if (transition.second.getSourceId() == stateId ||
-            transition.second.getTargetId() == stateId) {
-            transitionsToRemove.push_back(transition.first);
-        }
+    // Remove all transitions to and from this state, a loop is on both lists
+    while (!slot.outgoing.empty()) {
+        eraseTransition(slot.outgoing.back());
     }
-    
-    for (const auto& transitionId : transitionsToRemove) {
-        transitions.erase(transitionId);
+    while (!slot.incoming.empty()) {
+        eraseTransition(slot.incoming.back());
     }
     
-    // Remove the state
-    states.erase(stateId);
+    // Remove the state, its slot is reused by the next state added
+    stateIndex.erase(stateId, handle);
+    stateNameIndex.erase(slot.state.getName(), handle);
+    stateOutputs.erase(stateId);
+    slot.state = State();
+    slot.outgoing.shrink_to_fit();
+    slot.incoming.shrink_to_fit();
+    slot.live = false;
+    freeStates.push_back(handle);
+    invalidateTransitionTable();
     
     // If we removed the initial state, try to set a new one - could be handled differently
-    if (isInitial && !states.empty()) {
-        auto newInitialState = states.begin();
-        newInitialState->second.setIsInitial(true);
-        currentStateId = newInitialState->first;
-        stateEntryTime = steady_clock::now();
-    } else if (states.empty()) {
+    if (stateIndex.size() == 0) {
         currentStateId = "";
+    } else if (isInitial) {
+        State& newInitialState = stateSlots[getStateHandles().front()].state;
+        newInitialState.setIsInitial(true);
+        currentStateId = newInitialState.getId();
+        stateEntryTime = clock->now();
     }
     
     return true;
@@ -102,11 +129,7 @@ bool MooreMachine::removeState(const std::string& stateId) {
  * @return Pointer to the state, or nullptr if not found
  */
 State* MooreMachine::getState(const std::string& stateId) {
-    auto it = states.find(stateId);
-    if (it != states.end()) {
-        return &(it->second);
-    }
-    return nullptr;
+    return getState(getStateHandle(stateId));
 }
 
 /**
@@ -116,9 +139,17 @@ State* MooreMachine::getState(const std::string& stateId) {
  * @return Pointer to the state, or nullptr if not found
  */
 State* MooreMachine::getStateByName(const std::string& name) {
-    for (auto& statePair : states) {
-        if (statePair.second.getName() == name) {
-            return &(statePair.second);
+    StateHandle handle = stateNameIndex.find(name, [this](uint32_t h) -> const std::string& {
+        return stateSlots[h].state.getName();
+    });
+    if (handle != NO_HANDLE) {
+        return &stateSlots[handle].state;
+    }
+
+    // States renamed in place are not in the index under their new name
+    for (StateSlot& slot : stateSlots) {
+        if (slot.live && slot.state.getName() == name) {
+            return &slot.state;
         }
     }
     return nullptr;
@@ -131,8 +162,11 @@ State* MooreMachine::getStateByName(const std::string& name) {
  */
 std::vector<State*> MooreMachine::getAllStates() {
     std::vector<State*> result;
-    for (auto& statePair : states) {
-        result.push_back(&statePair.second);
+    result.reserve(stateIndex.size());
+    for (StateSlot& slot : stateSlots) {
+        if (slot.live) {
+            result.push_back(&slot.state);
+        }
     }
     return result;
 }
@@ -143,9 +177,9 @@ std::vector<State*> MooreMachine::getAllStates() {
  * @return Pointer to the initial state, or nullptr if not set
  */
 State* MooreMachine::getInitialState() {
-    for (auto& statePair : states) {
-        if (statePair.second.getIsInitial()) {
-            return &statePair.second;
+    for (StateSlot& slot : stateSlots) {
+        if (slot.live && slot.state.getIsInitial()) {
+            return &slot.state;
         }
     }
     return nullptr;
@@ -159,20 +193,20 @@ State* MooreMachine::getInitialState() {
  */
 bool MooreMachine::setInitialState(const std::string& stateId) {
     // Check if state exists
-    auto stateIt = states.find(stateId);
-    if (stateIt == states.end()) {
+    StateHandle handle = getStateHandle(stateId);
+    if (handle == NO_HANDLE) {
         return false;
     }
     
     // Clear the initial flag from all states
-    for (auto& statePair : states) {
-        statePair.second.setIsInitial(false);
+    for (StateSlot& slot : stateSlots) {
+        slot.state.setIsInitial(false);
     }
     
     // Set the new initial state
-    stateIt->second.setIsInitial(true);
+    stateSlots[handle].state.setIsInitial(true);
     currentStateId = stateId;
-    stateEntryTime = steady_clock::now();
+    stateEntryTime = clock->now();
     
     return true;
 }
@@ -180,25 +214,45 @@ bool MooreMachine::setInitialState(const std::string& stateId) {
 /**
  * @brief Adds a transition to the machine
  * 
+ * The transition takes the slot of a removed transition if there is one.
+ * 
  * @param transition The transition to add
+ * @param position Position among the transitions leaving the source state, the end by default
  * @return True if successful, false if a transition with the same ID already exists
  */
-bool MooreMachine::addTransition(const Transition& transition) {
-    // Check if transition with same ID already exists
-    if (transitions.find(transition.getId()) != transitions.end()) {
+bool MooreMachine::addTransition(const Transition& transition, size_t position) {
+    // Check if source and target states exist
+    StateHandle source = getStateHandle(transition.getSourceId());
+    StateHandle target = getStateHandle(transition.getTargetId());
+    if (source == NO_HANDLE || target == NO_HANDLE) {
         return false;
     }
     
-    // Check if source and target states exist
-    if (states.find(transition.getSourceId()) == states.end() ||
-        states.find(transition.getTargetId()) == states.end()) {
+    // Check if transition with same ID already exists
+    if (getTransitionHandle(transition.getId()) != NO_HANDLE) {
         return false;
     }
-    
-    transitions[transition.getId()] = transition;
+
+    // Copied before a slot is taken, the argument may be a transition of this machine
+    TransitionSlot stored{transition, source, target, static_cast<uint32_t>(stateSlots[target].incoming.size()), true};
+    TransitionHandle handle;
+    if (!freeTransitions.empty()) {
+        handle = freeTransitions.back();
+        freeTransitions.pop_back();
+        transitionSlots[handle] = std::move(stored);
+    } else {
+        handle = static_cast<TransitionHandle>(transitionSlots.size());
+        transitionSlots.push_back(std::move(stored));
+    }
+    const Transition& added = transitionSlots[handle].transition;
+    transitionIndex.insert(added.getId(), handle);
+    std::vector<TransitionHandle>& outgoing = stateSlots[source].outgoing;
+    outgoing.insert(outgoing.begin() + std::min(position, outgoing.size()), handle);
+    stateSlots[target].incoming.push_back(handle);
+    invalidateTransitionTable();
     
     // Add the inputs to the input alphabet and input pointers
-    for (const auto& input : transition.getInputConditions()) {
+    for (const auto& input : added.getInputConditions()) {
         inputAlphabet.insert(input.value);
         inputPointers.insert(input.source);
     }
@@ -206,6 +260,40 @@ bool MooreMachine::addTransition(const Transition& transition) {
     return true;
 }
 
+/**
+ * @brief Reserves room for transitions about to be added
+ * 
+ * @param count Expected number of transitions
+ */
+void MooreMachine::reserveTransitions(size_t count) {
+    transitionIndex.reserve(count);
+}
+
+/**
+ * @brief Removes a transition by handle
+ * 
+ * @param handle Handle of a live transition
+ */
+void MooreMachine::eraseTransition(TransitionHandle handle) {
+    TransitionSlot& slot = transitionSlots[handle];
+
+    // Outgoing transitions keep their order, they are mostly removed from the back
+    std::vector<TransitionHandle>& outgoing = stateSlots[slot.source].outgoing;
+    outgoing.erase(std::find(outgoing.rbegin(), outgoing.rend(), handle).base() - 1);
+
+    // The last incoming transition takes the place of the removed one
+    std::vector<TransitionHandle>& incoming = stateSlots[slot.target].incoming;
+    incoming[slot.incomingIndex] = incoming.back();
+    transitionSlots[incoming.back()].incomingIndex = slot.incomingIndex;
+    incoming.pop_back();
+
+    transitionIndex.erase(slot.transition.getId(), handle);
+    slot.transition = Transition();
+    slot.live = false;
+    freeTransitions.push_back(handle);
+    invalidateTransitionTable();
+}
+
 /**
  * @brief Removes a transition from the machine
  * 
@@ -214,11 +302,12 @@ bool MooreMachine::addTransition(const Transition& transition) {
  */
 bool MooreMachine::removeTransition(const std::string& transitionId) {
     // Check if transition exists
-    if (transitions.find(transitionId) == transitions.end()) {
+    TransitionHandle handle = getTransitionHandle(transitionId);
+    if (handle == NO_HANDLE) {
         return false;
     }
     
-    transitions.erase(transitionId);
+    eraseTransition(handle);
     return true;
 }
 
@@ -229,11 +318,7 @@ bool MooreMachine::removeTransition(const std::string& transitionId) {
  * @return Pointer to the transition, or nullptr if not found
  */
 Transition* MooreMachine::getTransition(const std::string& transitionId) {
-    auto it = transitions.find(transitionId);
-    if (it != transitions.end()) {
-        return &(it->second);
-    }
-    return nullptr;
+    return getTransition(getTransitionHandle(transitionId));
 }
 
 /**
@@ -243,10 +328,61 @@ Transition* MooreMachine::getTransition(const std::string& transitionId) {
  * @return Vector of pointers to transitions from the state
  */
 std::vector<Transition*> MooreMachine::getTransitionsFromState(const std::string& stateId) {
-    std::vector<Transition*> result;
-    for (auto& transitionPair : transitions) {
-        if (transitionPair.second.getSourceId() == stateId) {
-            result.push_back(&transitionPair.second);
+    TransitionSpan outgoing = getOutgoingTransitions(stateId);
+    return std::vector<Transition*>(outgoing.begin(), outgoing.end());
+}
+
+/**
+ * @brief Gets the transitions from a state without copying them
+ * 
+ * @param stateId ID of the source state
+ * @return Range of transitions borrowed from the compiled table, valid until the machine is modified
+ */
+TransitionSpan MooreMachine::getOutgoingTransitions(const std::string& stateId) {
+    const TransitionTable& table = getCompiledTransitions();
+    return table.getOutgoing(table.getStateIndex(stateId));
+}
+
+/**
+ * @brief Gets the position of a transition among the transitions leaving its source state
+ * 
+ * @param transitionId ID of the transition
+ * @return Position in the order the transitions are tried, SIZE_MAX if not found
+ */
+size_t MooreMachine::getOutgoingPosition(const std::string& transitionId) const {
+    TransitionHandle handle = getTransitionHandle(transitionId);
+    if (handle == NO_HANDLE) {
+        return SIZE_MAX;
+    }
+    const std::vector<TransitionHandle>& outgoing = stateSlots[transitionSlots[handle].source].outgoing;
+    return static_cast<size_t>(std::find(outgoing.begin(), outgoing.end(), handle) - outgoing.begin());
+}
+
+/**
+ * @brief Gets the transitions leaving and entering a state with their positions
+ * 
+ * Reads the adjacency lists, the compiled table is not built. A loop is listed once.
+ * 
+ * @param stateId ID of the state
+ * @return Transitions paired with their positions among the transitions leaving their source states
+ */
+std::vector<std::pair<Transition*, size_t>> MooreMachine::getIncidentTransitions(const std::string& stateId) {
+    std::vector<std::pair<Transition*, size_t>> result;
+    StateHandle handle = getStateHandle(stateId);
+    if (handle == NO_HANDLE) {
+        return result;
+    }
+    const StateSlot& slot = stateSlots[handle];
+    result.reserve(slot.outgoing.size() + slot.incoming.size());
+    for (size_t i = 0; i < slot.outgoing.size(); i++) {
+        result.emplace_back(&transitionSlots[slot.outgoing[i]].transition, i);
+    }
+    for (TransitionHandle transition : slot.incoming) {
+        const TransitionSlot& incoming = transitionSlots[transition];
+        if (incoming.source != handle) {
+            const std::vector<TransitionHandle>& outgoing = stateSlots[incoming.source].outgoing;
+            size_t position = static_cast<size_t>(std::find(outgoing.begin(), outgoing.end(), transition) - outgoing.begin());
+            result.emplace_back(&transitionSlots[transition].transition, position);
         }
     }
     return result;
@@ -260,14 +396,170 @@ std::vector<Transition*> MooreMachine::getTransitionsFromState(const std::string
  */
 std::vector<Transition*> MooreMachine::getTransitionsToState(const std::string& stateId) {
     std::vector<Transition*> result;
-    for (auto& transitionPair : transitions) {
-        if (transitionPair.second.getTargetId() == stateId) {
-            result.push_back(&transitionPair.second);
+    StateHandle handle = getStateHandle(stateId);
+    if (handle != NO_HANDLE) {
+        result.reserve(stateSlots[handle].incoming.size());
+        for (TransitionHandle transition : stateSlots[handle].incoming) {
+            result.push_back(&transitionSlots[transition].transition);
         }
     }
     return result;
 }
 
+/**
+ * @brief Gets the handle of a state
+ * 
+ * @param stateId ID of the state
+ * @return Handle of the state, or NO_HANDLE if not found
+ */
+StateHandle MooreMachine::getStateHandle(const std::string& stateId) const {
+    return stateIndex.find(stateId, [this](uint32_t h) -> const std::string& {
+        return stateSlots[h].state.getId();
+    });
+}
+
+/**
+ * @brief Gets a state by handle
+ * 
+ * @param handle Handle of the state
+ * @return Pointer to the state, or nullptr if the handle is not live
+ */
+State* MooreMachine::getState(StateHandle handle) {
+    if (handle >= stateSlots.size() || !stateSlots[handle].live) {
+        return nullptr;
+    }
+    return &stateSlots[handle].state;
+}
+
+/**
+ * @brief Gets the handles of all states
+ * 
+ * @return Handles in the order of getAllStates()
+ */
+std::vector<StateHandle> MooreMachine::getStateHandles() const {
+    std::vector<StateHandle> handles;
+    handles.reserve(stateIndex.size());
+    for (size_t i = 0; i < stateSlots.size(); i++) {
+        if (stateSlots[i].live) {
+            handles.push_back(static_cast<StateHandle>(i));
+        }
+    }
+    return handles;
+}
+
+/**
+ * @brief Gets the bound of state handles
+ * 
+ * @return One more than the largest state handle in use
+ */
+size_t MooreMachine::getStateHandleBound() const {
+    return stateSlots.size();
+}
+
+/**
+ * @brief Gets the handle of a transition
+ * 
+ * @param transitionId ID of the transition
+ * @return Handle of the transition, or NO_HANDLE if not found
+ */
+TransitionHandle MooreMachine::getTransitionHandle(const std::string& transitionId) const {
+    return transitionIndex.find(transitionId, [this](uint32_t h) -> const std::string& {
+        return transitionSlots[h].transition.getId();
+    });
+}
+
+/**
+ * @brief Gets a transition by handle
+ * 
+ * @param handle Handle of the transition
+ * @return Pointer to the transition, or nullptr if the handle is not live
+ */
+Transition* MooreMachine::getTransition(TransitionHandle handle) {
+    if (handle >= transitionSlots.size() || !transitionSlots[handle].live) {
+        return nullptr;
+    }
+    return &transitionSlots[handle].transition;
+}
+
+/**
+ * @brief Gets the bound of transition handles
+ * 
+ * @return One more than the largest transition handle in use
+ */
+size_t MooreMachine::getTransitionHandleBound() const {
+    return transitionSlots.size();
+}
+
+/**
+ * @brief Gets the handle of the source state of a transition
+ * 
+ * @param handle Handle of a live transition
+ * @return Handle of the source state
+ */
+StateHandle MooreMachine::getSourceHandle(TransitionHandle handle) const {
+    return transitionSlots[handle].source;
+}
+
+/**
+ * @brief Gets the handle of the target state of a transition
+ * 
+ * @param handle Handle of a live transition
+ * @return Handle of the target state
+ */
+StateHandle MooreMachine::getTargetHandle(TransitionHandle handle) const {
+    return transitionSlots[handle].target;
+}
+
+/**
+ * @brief Gets the transitions leaving a state
+ * 
+ * @param handle Handle of a live state
+ * @return Handles of the transitions, in the order they were added
+ */
+const std::vector<TransitionHandle>& MooreMachine::getOutgoingHandles(StateHandle handle) const {
+    return stateSlots[handle].outgoing;
+}
+
+/**
+ * @brief Gets the transitions entering a state
+ * 
+ * @param handle Handle of a live state
+ * @return Handles of the transitions, in no particular order
+ */
+const std::vector<TransitionHandle>& MooreMachine::getIncomingHandles(StateHandle handle) const {
+    return stateSlots[handle].incoming;
+}
+
+/**
+ * @brief Gets the compiled transition table of the machine
+ *
+ * @return Shared pointer to the compiled table
+ */
+std::shared_ptr<const TransitionTable> MooreMachine::getTransitionTable() {
+    getCompiledTransitions();
+    return transitionTable;
+}
+
+/**
+ * @brief Drops the compiled transition table
+ */
+void MooreMachine::invalidateTransitionTable() {
+    transitionTable.reset();
+}
+
+/**
+ * @brief Gets the compiled transition table, rebuilding it if it is stale
+ *
+ * @return Reference to the compiled table
+ */
+const TransitionTable& MooreMachine::getCompiledTransitions() {
+    // A copied machine shares the table of its source, which points to the source's transitions
+    if (!transitionTable || transitionTable->getOwner() != this) {
+        transitionTable = std::make_shared<TransitionTable>(*this);
+    }
+    return *transitionTable;
+}
+
 /**
  * @brief Adds an input symbol to the alphabet
  * 
@@ -287,8 +579,8 @@ bool MooreMachine::addInputSymbol(const std::string& symbol) {
  */
 bool MooreMachine::removeInputSymbol(const std::string& symbol) {
     // Check if the symbol is in use
-    for (const auto& transition : transitions) {
-        for (const auto& input : transition.second.getInputConditions()) {
+    for (const TransitionSlot& slot : transitionSlots) {
+        for (const auto& input : slot.transition.getInputConditions()) {
             if (input.value == symbol) {
                 return false;
             }
@@ -318,8 +610,8 @@ bool MooreMachine::addOutputSymbol(const std::string& symbol) {
  */
 bool MooreMachine::removeOutputSymbol(const std::string& symbol) {
     // Check if the symbol is in use
-    for (const auto& state : states) {
-        for (const auto& output : state.second.getOutputs()) {
+    for (const StateSlot& slot : stateSlots) {
+        for (const auto& output : slot.state.getOutputs()) {
             if (output.value == symbol) {
                 return false;
             }
@@ -367,8 +659,8 @@ bool MooreMachine::addInputPointer(const std::string& pointer) {
  */
 bool MooreMachine::removeInputPointer(const std::string& pointer) {
     // Check if the pointer is in use
-    for (const auto& transition : transitions) {
-        for (const auto& input : transition.second.getInputConditions()) {
+    for (const TransitionSlot& slot : transitionSlots) {
+        for (const auto& input : slot.transition.getInputConditions()) {
             if (input.source == pointer) {
                 return false;
             }
@@ -398,8 +690,8 @@ bool MooreMachine::addOutputPointer(const std::string& pointer) {
  */
 bool MooreMachine::removeOutputPointer(const std::string& pointer) {
     // Check if the pointer is in use
-    for (const auto& state : states) {
-        for (const auto& output : state.second.getOutputs()) {
+    for (const StateSlot& slot : stateSlots) {
+        for (const auto& output : slot.state.getOutputs()) {
             if (output.target == pointer) {
                 return false;
             }
@@ -440,6 +732,7 @@ bool MooreMachine::addVariable(const std::string& type, const std::string& name,
     try {
         variables[name] = MachineVariable(type, name, value);
         initialVariableValues[name] = value;
+        unbindExpressions();
         return true;
     } catch (const std::exception& e) {
         return false;
@@ -455,7 +748,11 @@ bool MooreMachine::addVariable(const std::string& type, const std::string& name,
  * @return True if successful, false if the variable couldn't be created
  */
 void MooreMachine::setVariable(const std::string& type, const std::string& name, const std::string& value) {
+    bool isNew = variables.find(name) == variables.end();
     variables[name] = MachineVariable(type, name, value);
+    if (isNew) {
+        unbindExpressions();
+    }
 }
 
 /**
@@ -465,7 +762,11 @@ void MooreMachine::setVariable(const std::string& type, const std::string& name,
  * @return True if successful, false if the variable doesn't exist
  */
 bool MooreMachine::removeVariable(const std::string& name) {
-    return variables.erase(name) > 0;
+    if (variables.erase(name) == 0) {
+        return false;
+    }
+    unbindExpressions();
+    return true;
 }
 
 /**
@@ -491,6 +792,26 @@ std::unordered_map<std::string, MachineVariable> MooreMachine::getVariables() co
     return variables;
 }
 
+/**
+ * @brief Gets all variables without copying them
+ * 
+ * @return Reference to the map of variables indexed by name
+ */
+const std::unordered_map<std::string, MachineVariable>& MooreMachine::getVariablesView() const {
+    return variables;
+}
+
+/**
+ * @brief Gets the value a variable is reset to
+ * 
+ * @param name Name of the variable
+ * @return The initial value, empty if the variable doesn't exist
+ */
+std::string MooreMachine::getInitialVariableValue(const std::string& name) const {
+    auto it = initialVariableValues.find(name);
+    return it != initialVariableValues.end() && variables.count(name) ? it->second : std::string();
+}
+
 /**
  * @brief Evaluates an expression
  * 
@@ -499,7 +820,11 @@ std::unordered_map<std::string, MachineVariable> MooreMachine::getVariables() co
  * @return Result of the evaluation
  */
 MachineVariable MooreMachine::evaluateExpression(const std::string& expression, int elapsedTime) {
-    return expressionParser.evaluateExpression(expression, variables, elapsedTime);
+    auto it = expressionPrograms.find(expression);
+    if (it == expressionPrograms.end()) {
+        it = expressionPrograms.emplace(expression, expressionParser.compile(expression)).first;
+    }
+    return it->second.evaluate(variables, elapsedTime);
 }
 
 /**
@@ -510,7 +835,76 @@ MachineVariable MooreMachine::evaluateExpression(const std::string& expression,
  * @return Pair of output pointer and value
  */
 std::pair<std::string, std::string> MooreMachine::parseOutputExpression(const std::string& expression, int elapsedTime) {
-    return expressionParser.parseOutput(expression, variables, elapsedTime);
+    auto it = outputExpressions.find(expression);
+    if (it == outputExpressions.end()) {
+        it = outputExpressions.emplace(expression, expressionParser.compileOutputExpression(expression)).first;
+    }
+    
+    CompiledOutput& output = it->second;
+    if (output.action == OutputAction::INVALID) {
+        throw std::runtime_error(output.source);
+    }
+    return {output.target, output.program.evaluate(variables, elapsedTime).getValueString()};
+}
+
+/**
+ * @brief Runs a compiled expression against the machine's variables
+ * 
+ * @param program The compiled expression
+ * @param elapsedTime Current elapsed time in milliseconds
+ * @return Result of the evaluation, valid until the program runs again
+ */
+const MachineVariable& MooreMachine::evaluateProgram(ExpressionProgram& program, int elapsedTime) {
+    return program.evaluate(variables, elapsedTime);
+}
+
+/**
+ * @brief Gets the compiled output statements of a state
+ * 
+ * @param stateId ID of the state
+ * @return Compiled statements in the order of the state's outputs
+ */
+std::vector<CompiledOutput>& MooreMachine::getCompiledOutputs(const std::string& stateId) {
+    auto it = stateOutputs.find(stateId);
+    if (it != stateOutputs.end()) {
+        return it->second;
+    }
+    
+    std::vector<CompiledOutput> compiled;
+    StateHandle handle = getStateHandle(stateId);
+    if (handle != NO_HANDLE) {
+        for (const auto& output : stateSlots[handle].state.getOutputs()) {
+            compiled.push_back(expressionParser.compileOutput(output));
+        }
+    }
+    return stateOutputs.emplace(stateId, std::move(compiled)).first->second;
+}
+
+/**
+ * @brief Sets the compiled output statements of a state
+ * 
+ * @param stateId ID of the state
+ * @param outputs Compiled statements in the order of the state's outputs
+ */
+void MooreMachine::setCompiledOutputs(const std::string& stateId, std::vector<CompiledOutput> outputs) {
+    stateOutputs[stateId] = std::move(outputs);
+}
+
+/**
+ * @brief Makes all compiled expressions resolve their variables again
+ */
+void MooreMachine::unbindExpressions() {
+    for (auto& program : expressionPrograms) {
+        program.second.unbind();
+    }
+    for (auto& output : outputExpressions) {
+        output.second.program.unbind();
+    }
+    for (auto& outputs : stateOutputs) {
+        for (auto& output : outputs.second) {
+            output.program.unbind();
+        }
+    }
 }
 
 /**
@@ -531,51 +925,54 @@ std::vector<std::string> MooreMachine::getValidationErrors() const {
     std::vector<std::string> errors;
     
     // Check if there's at least one state
-    if (states.empty()) {
+    if (stateIndex.size() == 0) {
         errors.push_back("Machine has no states");
     }
     
     // Check if there's an initial state
     bool hasInitial = false;
-    for (const auto& state : states) {
-        if (state.second.getIsInitial()) {
+    for (const StateSlot& slot : stateSlots) {
+        if (slot.live && slot.state.getIsInitial()) {
             hasInitial = true;
             break;
         }
     }
     
-    if (!hasInitial && !states.empty()) {
+    if (!hasInitial && stateIndex.size() != 0) {
         errors.push_back("Machine has no initial state");
     }
     
     // Check if all transitions are valid
-    for (const auto& transition : transitions) {
-        if (states.find(transition.second.getSourceId()) == states.end()) {
-            errors.push_back("Transition " + transition.first + 
-                            " has invalid source state: " + transition.second.getSourceId());
+    for (const TransitionSlot& slot : transitionSlots) {
+        if (!slot.live) {
+            continue;
+        }
+        if (getStateHandle(slot.transition.getSourceId()) == NO_HANDLE) {
+            errors.push_back("Transition " + slot.transition.getId() + 
+                            " has invalid source state: " + slot.transition.getSourceId());
         }
         
-        if (states.find(transition.second.getTargetId()) == states.end()) {
-            errors.push_back("Transition " + transition.first + 
-                            " has invalid target state: " + transition.second.getTargetId());
+        if (getStateHandle(slot.transition.getTargetId()) == NO_HANDLE) {
+            errors.push_back("Transition " + slot.transition.getId() + 
+                            " has invalid target state: " + slot.transition.getTargetId());
         }
     }
     
     // Check if all input pointers are declared
-    for (const auto& transition : transitions) {
-        for (const auto& input : transition.second.getInputConditions()) {
+    for (const TransitionSlot& slot : transitionSlots) {
+        for (const auto& input : slot.transition.getInputConditions()) {
             if (inputPointers.find(input.source) == inputPointers.end()) {
-                errors.push_back("Transition " + transition.first + 
+                errors.push_back("Transition " + slot.transition.getId() + 
                                " uses undeclared input pointer: " + input.source);
             }
         }
     }
     
     // Check if all output pointers are declared
-    for (const auto& state : states) {
-        for (const auto& output : state.second.getOutputs()) {
+    for (const StateSlot& slot : stateSlots) {
+        for (const auto& output : slot.state.getOutputs()) {
             if (outputPointers.find(output.target) == outputPointers.end()) {
-                errors.push_back("State " + state.first + 
+                errors.push_back("State " + slot.state.getId() + 
                                " uses undeclared output pointer: " + output.target);
             }
         }
@@ -584,6 +981,15 @@ std::vector<std::string> MooreMachine::getValidationErrors() const {
     return errors;
 }
 
+/**
+ * @brief Merges equivalent states into a new machine
+ * 
+ * @return The minimized machine and the states merged away, this machine is left unchanged
+ */
+MinimizationResult MooreMachine::minimize() {
+    return MachineMinimizer(*this).run();
+}
+
 /**
  * @brief Processes an input through the machine
  * 
@@ -593,35 +999,11 @@ std::vector<std::string> MooreMachine::getValidationErrors() const {
  */
 std::string MooreMachine::processInput(const std::string& input) {
     // Translate simple inputs
-    if (currentStateId.empty() || states.find(currentStateId) == states.end()) {
+    if (currentStateId.empty() || getStateHandle(currentStateId) == NO_HANDLE) {
         throw std::runtime_error("Machine is not in a valid state");
     }
     
-    // Find a transition from the current state with the given input
-    for (const auto& transitionPair : transitions) {
-        if (transitionPair.second.getSourceId() == currentStateId) {
-            for (const auto& inputCondition : transitionPair.second.getInputConditions()) {
-                if (inputCondition.source == "default" && inputCondition.value == input) {
-                    // Record old state for comparing
-                    std::string oldStateId = currentStateId;
-                    
-                    // Transition to the next state
-                    currentStateId = transitionPair.second.getTargetId();
-                    
-                    // If we changed state, reset the timer
-                    if (oldStateId != currentStateId) {
-                        stateEntryTime = steady_clock::now();
-                    }
-                    
-                    // Return the output of the new state
-                    return states[currentStateId].getOutput();
-                }
-            }
-        }
-    }
-    
-    // If no transition found, stay in the current state
-    return states[currentStateId].getOutput();
+    return stepOnPointer(input, "default");
 }
 
 /**
@@ -629,12 +1011,10 @@ std::string MooreMachine::processInput(const std::string& input) {
  */
 void MooreMachine::reset() {
     // Reset to the initial state
-    for (const auto& statePair : states) {
-        if (statePair.second.getIsInitial()) {
-            currentStateId = statePair.first;
-            stateEntryTime = steady_clock::now();
-            return;
-        }
+    if (State* initial = getInitialState()) {
+        currentStateId = initial->getId();
+        stateEntryTime = clock->now();
+        return;
     }
     
     // If no initial state found, set to empty
@@ -651,10 +1031,29 @@ int MooreMachine::getElapsedTimeInState() const {
         return 0;
     }
     
-    auto now = steady_clock::now();
+    auto now = clock->now();
     return duration_cast<milliseconds>(now - stateEntryTime).count();
 }
 
+/**
+ * @brief Sets the clock the machine measures time with
+ * 
+ * @param clock The clock, must outlive the machine
+ */
+void MooreMachine::setClock(MachineClock* clock) {
+    this->clock = clock;
+    stateEntryTime = clock->now();
+}
+
+/**
+ * @brief Gets the clock the machine measures time with
+ * 
+ * @return Pointer to the clock
+ */
+MachineClock* MooreMachine::getClock() const {
+    return clock;
+}
+
 /**
  * @brief Gets the name of the machine
  * 
@@ -683,7 +1082,7 @@ void MooreMachine::setName(const std::string& name) {
  */
 std::string MooreMachine::processInputOnPointer(const std::string& input, const std::string& inputPtr) {
     // Check if the machine is in a valid state
-    if (currentStateId.empty() || states.find(currentStateId) == states.end()) {
+    if (currentStateId.empty() || getStateHandle(currentStateId) == NO_HANDLE) {
         throw std::runtime_error("Machine is not in a valid state");
     }
     
@@ -692,31 +1091,31 @@ std::string MooreMachine::processInputOnPointer(const std::string& input, const
         throw std::runtime_error("Invalid input pointer: " + inputPtr);
     }
     
-    // Find a transition from the current state with the given input on the given pointer
-    for (const auto& transitionPair : transitions) {
-        if (transitionPair.second.getSourceId() == currentStateId) {
-            for (const auto& inputCondition : transitionPair.second.getInputConditions()) {
-                if (inputCondition.source == inputPtr && inputCondition.value == input) {
-                    // Record old state for comparing
-                    std::string oldStateId = currentStateId;
-                    
-                    // Transition to the next state
-                    currentStateId = transitionPair.second.getTargetId();
-                    
-                    // If we changed state, reset the timer
-                    if (oldStateId != currentStateId) {
-                        stateEntryTime = std::chrono::steady_clock::now();
-                    }
-                    
-                    // Return the output of the new state
-                    return states[currentStateId].getOutput();
-                }
-            }
-        }
-    }
-    
+    return stepOnPointer(input, inputPtr);
+}
+
+/**
+ * @brief Follows a transition from the current state using the compiled table
+ *
+ * @param input Input symbol to process
+ * @param inputPtr Input pointer the symbol arrived on
+ * @return Output produced by the new state
+ */
+std::string MooreMachine::stepOnPointer(const std::string& input, const std::string& inputPtr) {
+    const TransitionTable& table = getCompiledTransitions();
+    int next = table.getNextState(table.getStateIndex(currentStateId),
+                                  table.getPointerIndex(inputPtr),
+                                  table.getSymbolIndex(input));
+
     // If no transition found, stay in the current state
-    return states[currentStateId].getOutput();
+    if (next != TransitionTable::NONE && table.getStateId(next) != currentStateId) {
+        // Transition to the next state and reset the timer
+        currentStateId = table.getStateId(next);
+        stateEntryTime = clock->now();
+    }
+
+    // Return the output of the new state
+    return getState(currentStateId)->getOutput();
 }
 
 /**
@@ -0,0 +1,231 @@
+/**
+ * @file scene_model.cpp
+ * @brief Implementation of the SceneModel class
+ * @author Hugo Bohácsek (xbohach00)
+ */
+
+#include "../headers/scene_model.h"
+
+/**
+ * @brief Compares two drawings of a state
+ *
+ * @param other The other drawing
+ * @return True if nothing differs
+ */
+bool SceneState::operator==(const SceneState& other) const {
+    return name == other.name && position.x == other.position.x && position.y == other.position.y &&
+           isInitial == other.isInitial && isFinal == other.isFinal;
+}
+
+/**
+ * @brief Gets the number of changes
+ *
+ * @return Number of states and transitions to add, change or remove
+ */
+size_t SceneChanges::size() const {
+    return addedStates.size() + changedStates.size() + removedStates.size() + addedTransitions.size() +
+           changedTransitions.size() + removedTransitions.size();
+}
+
+/**
+ * @brief Gets the label of a transition, its input symbols and timeout
+ *
+ * Boolean conditions are left out, the timeout is shown in whole seconds
+ * after an hourglass.
+ *
+ * @param transition The transition
+ * @return The label in UTF-8
+ */
+std::string SceneModel::transitionLabel(const Transition& transition) {
+    std::string label;
+    for (const InputCondition& condition : transition.getInputConditions()) {
+        if (!condition.isBooleanExpr && !condition.value.empty()) {
+            label += label.empty() ? "" : ", ";
+            label += condition.value;
+        }
+    }
+    if (transition.getTimeout() > 0) {
+        label += label.empty() ? "" : ", ";
+        label += "⧗ " + std::to_string(transition.getTimeout() / 1000) + " s";
+    }
+    return label;
+}
+
+/**
+ * @brief Gets how a state of the machine is drawn
+ *
+ * The position is cut to whole pixels like the editor places items.
+ *
+ * @param state The state
+ * @return Its drawing
+ */
+SceneState SceneModel::describeState(const State& state) {
+    SceneState drawing;
+    drawing.name = state.getName();
+    drawing.position = Point(static_cast<int>(state.getPosition().x), static_cast<int>(state.getPosition().y));
+    drawing.isInitial = state.getIsInitial();
+    // A final state has a "final" output
+    for (const OutputCondition& output : state.getOutputs()) {
+        drawing.isFinal = drawing.isFinal || output.value == "final";
+    }
+    return drawing;
+}
+
+/**
+ * @brief Gets how a transition of the machine is drawn
+ *
+ * @param transition The transition
+ * @return Its drawing
+ */
+SceneTransition SceneModel::describeTransition(const Transition& transition) {
+    SceneTransition drawing;
+    drawing.sourceId = transition.getSourceId();
+    drawing.targetId = transition.getTargetId();
+    drawing.label = transitionLabel(transition);
+    for (const InputCondition& condition : transition.getInputConditions()) {
+        drawing.isBoolean = drawing.isBoolean || condition.isBooleanExpr;
+    }
+    return drawing;
+}
+
+/**
+ * @brief Finds what differs between the scene and the machine, the model is not changed
+ *
+ * Transitions whose states are not in the machine are left out, the editor
+ * cannot draw a line without both ends. The drawn items are only looked up
+ * in the machine when fewer of them were matched than are drawn, so an
+ * update without removals walks the machine once.
+ *
+ * @param machine The machine
+ * @return The differences
+ */
+SceneChanges SceneModel::compare(MooreMachine& machine) const {
+    SceneChanges changes;
+
+    std::vector<State*> machineStates = machine.getAllStates();
+    size_t matchedStates = 0;
+    for (State* state : machineStates) {
+        auto it = states.find(state->getId());
+        if (it == states.end()) {
+            changes.addedStates.push_back(state->getId());
+            continue;
+        }
+        matchedStates++;
+        if (!(it->second == describeState(*state))) {
+            changes.changedStates.push_back(state->getId());
+        }
+    }
+
+    size_t matchedTransitions = 0;
+    for (State* state : machineStates) {
+        for (Transition* transition : machine.getOutgoingTransitions(state->getId())) {
+            if (!machine.getState(transition->getTargetId())) {
+                continue;
+            }
+            auto it = transitions.find(transition->getId());
+            if (it == transitions.end()) {
+                changes.addedTransitions.push_back(transition->getId());
+                continue;
+            }
+            matchedTransitions++;
+
+            const SceneTransition& drawn = it->second;
+            SceneTransition current = describeTransition(*transition);
+            if (drawn.sourceId != current.sourceId || drawn.targetId != current.targetId) {
+                // Reconnected, the line has to be built for the new states
+                changes.removedTransitions.push_back(transition->getId());
+                changes.addedTransitions.push_back(transition->getId());
+            } else if (drawn.label != current.label || drawn.isBoolean != current.isBoolean) {
+                changes.changedTransitions.push_back(transition->getId());
+            }
+        }
+    }
+
+    // Every drawn item was matched, nothing to remove
+    if (matchedTransitions < transitions.size()) {
+        for (const auto& transition : transitions) {
+            Transition* current = machine.getTransition(transition.first);
+            if (!current || !machine.getState(current->getSourceId()) || !machine.getState(current->getTargetId())) {
+                changes.removedTransitions.push_back(transition.first);
+            }
+        }
+    }
+    if (matchedStates < states.size()) {
+        for (const auto& state : states) {
+            if (!machine.getState(state.first)) {
+                changes.removedStates.push_back(state.first);
+            }
+        }
+    }
+    return changes;
+}
+
+/**
+ * @brief Records a state as drawn
+ *
+ * @param stateId ID of the state
+ * @param state Its drawing
+ */
+void SceneModel::setState(const std::string& stateId, const SceneState& state) {
+    states[stateId] = state;
+}
+
+/**
+ * @brief Records a state is no longer drawn
+ *
+ * @param stateId ID of the state
+ * @return True if the state was drawn
+ */
+bool SceneModel::removeState(const std::string& stateId) {
+    return states.erase(stateId) > 0;
+}
+
+/**
+ * @brief Records a transition as drawn
+ *
+ * @param transitionId ID of the transition
+ * @param transition Its drawing
+ */
+void SceneModel::setTransition(const std::string& transitionId, const SceneTransition& transition) {
+    transitions[transitionId] = transition;
+}
+
+/**
+ * @brief Records a transition is no longer drawn
+ *
+ * @param transitionId ID of the transition
+ * @return True if the transition was drawn
+ */
+bool SceneModel::removeTransition(const std::string& transitionId) {
+    return transitions.erase(transitionId) > 0;
+}
+
+/**
+ * @brief Gets how a state is drawn
+ *
+ * @param stateId ID of the state
+ * @return Its drawing, nullptr if it is not drawn
+ */
+const SceneState* SceneModel::getState(const std::string& stateId) const {
+    auto it = states.find(stateId);
+    return it != states.end() ? &it->second : nullptr;
+}
+
+/**
+ * @brief Gets how a transition is drawn
+ *
+ * @param transitionId ID of the transition
+ * @return Its drawing, nullptr if it is not drawn
+ */
+const SceneTransition* SceneModel::getTransition(const std::string& transitionId) const {
+    auto it = transitions.find(transitionId);
+    return it != transitions.end() ? &it->second : nullptr;
+}
+
+/**
+ * @brief Records the scene was cleared
+ */
+void SceneModel::clear() {
+    states.clear();
+    transitions.clear();
+}
@@ -0,0 +1,214 @@
+/**
+ * @file spatial_grid.cpp
+ * @brief Implementation of the SpatialGrid class
+ * @author Hugo Bohácsek (xbohach00)
+ */
+
+#include "../headers/spatial_grid.h"
+#include <algorithm>
+#include <cmath>
+
+/**
+ * @brief Constructor
+ *
+ * @param cellSize Edge of a cell, best a few times the size of a box
+ */
+SpatialGrid::SpatialGrid(double cellSize)
+    : cellSize(cellSize > 0 ? cellSize : DEFAULT_CELL_SIZE), maxWidth(0), maxHeight(0) {}
+
+/**
+ * @brief Gets the coordinate of the cell holding a coordinate
+ *
+ * @param coordinate X or Y coordinate
+ * @return Column or row of the cell
+ */
+int32_t SpatialGrid::cellOf(double coordinate) const {
+    double cell = std::floor(coordinate / cellSize);
+    // Far away coordinates share the outermost cells
+    cell = std::max(cell, static_cast<double>(INT32_MIN));
+    cell = std::min(cell, static_cast<double>(INT32_MAX));
+    return static_cast<int32_t>(cell);
+}
+
+/**
+ * @brief Gets the key of a cell
+ *
+ * @param column Column of the cell
+ * @param row Row of the cell
+ * @return Key of the cell in cells
+ */
+uint64_t SpatialGrid::cellKey(int32_t column, int32_t row) {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(column)) << 32) | static_cast<uint32_t>(row);
+}
+
+/**
+ * @brief Removes a box from the list of its cell
+ *
+ * @param position Position of the box in entries
+ */
+void SpatialGrid::unlink(uint32_t position) {
+    auto cell = cells.find(entries[position].cell);
+    std::vector<uint32_t>& list = cell->second;
+    *std::find(list.begin(), list.end(), position) = list.back();
+    list.pop_back();
+    if (list.empty()) {
+        cells.erase(cell);
+    }
+}
+
+/**
+ * @brief Adds a box to the list of the cell holding its top left corner
+ *
+ * @param position Position of the box in entries
+ */
+void SpatialGrid::link(uint32_t position) {
+    Entry& entry = entries[position];
+    entry.cell = cellKey(cellOf(entry.min.x), cellOf(entry.min.y));
+    cells[entry.cell].push_back(position);
+    maxWidth = std::max(maxWidth, entry.max.x - entry.min.x);
+    maxHeight = std::max(maxHeight, entry.max.y - entry.min.y);
+}
+
+/**
+ * @brief Adds a box, or moves it if the ID is already in the grid
+ *
+ * @param id ID of the box
+ * @param min Top left corner
+ * @param max Bottom right corner
+ */
+void SpatialGrid::insert(const std::string& id, const Point& min, const Point& max) {
+    if (move(id, min, max)) {
+        return;
+    }
+    uint32_t position = static_cast<uint32_t>(entries.size());
+    entries.push_back(Entry{id, min, max, 0});
+    index.emplace(id, position);
+    link(position);
+}
+
+/**
+ * @brief Moves a box
+ *
+ * @param id ID of the box
+ * @param min New top left corner
+ * @param max New bottom right corner
+ * @return True if the box was moved, false if it is not in the grid
+ */
+bool SpatialGrid::move(const std::string& id, const Point& min, const Point& max) {
+    auto it = index.find(id);
+    if (it == index.end()) {
+        return false;
+    }
+    Entry& entry = entries[it->second];
+    entry.min = min;
+    entry.max = max;
+    // Most moves stay in the cell
+    if (entry.cell != cellKey(cellOf(min.x), cellOf(min.y))) {
+        unlink(it->second);
+        link(it->second);
+    } else {
+        maxWidth = std::max(maxWidth, max.x - min.x);
+        maxHeight = std::max(maxHeight, max.y - min.y);
+    }
+    return true;
+}
+
+/**
+ * @brief Removes a box
+ *
+ * The last box takes the place of the removed one, so entries stay dense.
+ *
+ * @param id ID of the box
+ * @return True if the box was removed, false if it is not in the grid
+ */
+bool SpatialGrid::remove(const std::string& id) {
+    auto it = index.find(id);
+    if (it == index.end()) {
+        return false;
+    }
+    uint32_t position = it->second;
+    uint32_t last = static_cast<uint32_t>(entries.size() - 1);
+    unlink(position);
+    index.erase(it);
+
+    if (position != last) {
+        std::vector<uint32_t>& list = cells[entries[last].cell];
+        *std::find(list.begin(), list.end(), last) = position;
+        index[entries[last].id] = position;
+        entries[position] = std::move(entries[last]);
+    }
+    entries.pop_back();
+    return true;
+}
+
+/**
+ * @brief Finds the boxes overlapping an area
+ *
+ * @param min Top left corner of the area
+ * @param max Bottom right corner of the area
+ * @return IDs of the boxes, in no particular order
+ */
+std::vector<std::string> SpatialGrid::query(const Point& min, const Point& max) const {
+    std::vector<std::string> result;
+    if (entries.empty() || max.x < min.x || max.y < min.y) {
+        return result;
+    }
+
+    // A box overlapping the area has its corner at most one box size before it
+    int32_t firstColumn = cellOf(min.x - maxWidth);
+    int32_t firstRow = cellOf(min.y - maxHeight);
+    int32_t lastColumn = cellOf(max.x);
+    int32_t lastRow = cellOf(max.y);
+
+    auto overlaps = [&](const Entry& entry) {
+        return entry.min.x <= max.x && entry.max.x >= min.x && entry.min.y <= max.y && entry.max.y >= min.y;
+    };
+
+    // A large area holds more cells than there are boxes, checking the boxes directly is cheaper then
+    double area = (static_cast<double>(lastColumn) - firstColumn + 1) * (static_cast<double>(lastRow) - firstRow + 1);
+    if (area > static_cast<double>(cells.size())) {
+        for (const auto& cell : cells) {
+            for (uint32_t position : cell.second) {
+                if (overlaps(entries[position])) {
+                    result.push_back(entries[position].id);
+                }
+            }
+        }
+        return result;
+    }
+
+    for (int64_t column = firstColumn; column <= lastColumn; column++) {
+        for (int64_t row = firstRow; row <= lastRow; row++) {
+            auto cell = cells.find(cellKey(static_cast<int32_t>(column), static_cast<int32_t>(row)));
+            if (cell == cells.end()) {
+                continue;
+            }
+            for (uint32_t position : cell->second) {
+                if (overlaps(entries[position])) {
+                    result.push_back(entries[position].id);
+                }
+            }
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief Removes all boxes
+ */
+void SpatialGrid::clear() {
+    entries.clear();
+    index.clear();
+    cells.clear();
+    maxWidth = 0;
+    maxHeight = 0;
+}
+
+/**
+ * @brief Gets the number of boxes
+ *
+ * @return Number of boxes in the grid
+ */
+size_t SpatialGrid::size() const {
+    return entries.size();
+}
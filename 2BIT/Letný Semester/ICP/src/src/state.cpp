@@ -36,7 +36,7 @@ State::State(const std::string& id, const std::string& name, const std::string&
  * 
  * @return The state ID
  */
-std::string State::getId() const {
+const std::string& State::getId() const {
     return id;
 }
 
@@ -45,7 +45,7 @@ std::string State::getId() const {
  * 
  * @return The state name
  */
-std::string State::getName() const {
+const std::string& State::getName() const {
     return name;
 }
 
@@ -64,7 +64,7 @@ std::string State::getOutput() const {
  * 
  * @return Vector of output conditions
  */
-std::vector<OutputCondition> State::getOutputs() const {
+const std::vector<OutputCondition>& State::getOutputs() const {
     return outputs;
 }
 
@@ -0,0 +1,150 @@
+/**
+ * @file timer_queue.cpp
+ * @brief Implementation of the TimerQueue class
+ * @author Hugo Bohácsek (xbohach00)
+ */
+
+#include "../headers/timer_queue.h"
+#include <algorithm>
+
+/**
+ * @brief Default constructor, creates a queue with no timers
+ */
+TimerQueue::TimerQueue() : armedCount(0) {}
+
+/**
+ * @brief Heap ordering, puts the earliest deadline on top
+ */
+bool TimerQueue::later(const Entry& a, const Entry& b) {
+    return a.deadline > b.deadline;
+}
+
+/**
+ * @brief Checks whether a heap entry still belongs to an armed timer
+ */
+bool TimerQueue::isCurrent(const Entry& entry) const {
+    return armed[entry.timer] && generations[entry.timer] == entry.generation;
+}
+
+/**
+ * @brief Pops cancelled entries off the top of the heap
+ */
+void TimerQueue::dropCancelled() {
+    while (!heap.empty() && !isCurrent(heap.front())) {
+        std::pop_heap(heap.begin(), heap.end(), later);
+        heap.pop_back();
+    }
+}
+
+/**
+ * @brief Sets the number of timers and cancels all of them
+ *
+ * @param timerCount Number of timers, valid indices are 0 to timerCount - 1
+ */
+void TimerQueue::resize(int timerCount) {
+    heap.clear();
+    generations.assign(timerCount, 0);
+    armed.assign(timerCount, false);
+    armedCount = 0;
+}
+
+/**
+ * @brief Arms a timer, replacing its previous deadline
+ *
+ * @param timer Index of the timer
+ * @param deadline When the timer expires
+ */
+void TimerQueue::arm(int timer, TimePoint deadline) {
+    cancel(timer);
+
+    // Cancelled entries buried in the heap are only dropped when they surface,
+    // compact it before it grows well past the number of armed timers
+    if (heap.size() >= 2 * static_cast<size_t>(armedCount) + 8) {
+        heap.erase(std::remove_if(heap.begin(), heap.end(),
+                                  [this](const Entry& entry) { return !isCurrent(entry); }),
+                   heap.end());
+        std::make_heap(heap.begin(), heap.end(), later);
+    }
+
+    armed[timer] = true;
+    armedCount++;
+    heap.push_back(Entry{deadline, generations[timer], timer});
+    std::push_heap(heap.begin(), heap.end(), later);
+}
+
+/**
+ * @brief Cancels a timer, does nothing if it is not armed
+ *
+ * @param timer Index of the timer
+ */
+void TimerQueue::cancel(int timer) {
+    if (!armed[timer]) {
+        return;
+    }
+    armed[timer] = false;
+    generations[timer]++;
+    armedCount--;
+    dropCancelled();
+}
+
+/**
+ * @brief Cancels all timers
+ */
+void TimerQueue::clear() {
+    for (const Entry& entry : heap) {
+        if (armed[entry.timer]) {
+            armed[entry.timer] = false;
+            generations[entry.timer]++;
+        }
+    }
+    heap.clear();
+    armedCount = 0;
+}
+
+/**
+ * @brief Checks whether a timer is armed
+ *
+ * @param timer Index of the timer
+ * @return True if the timer is armed
+ */
+bool TimerQueue::isArmed(int timer) const {
+    return armed[timer];
+}
+
+/**
+ * @brief Checks whether any timer is armed
+ *
+ * @return True if no timer is armed
+ */
+bool TimerQueue::empty() const {
+    return armedCount == 0;
+}
+
+/**
+ * @brief Gets the earliest deadline
+ *
+ * Cancelled entries never stay on top of the heap, so the top is always current.
+ *
+ * @return Deadline of the first timer to expire, or TimePoint::max() if none is armed
+ */
+TimerQueue::TimePoint TimerQueue::nextDeadline() const {
+    if (heap.empty()) {
+        return TimePoint::max();
+    }
+    return heap.front().deadline;
+}
+
+/**
+ * @brief Disarms and returns the first timer that expired
+ *
+ * @param now Current time
+ * @return Index of the timer with the earliest deadline not after now, or NONE
+ */
+int TimerQueue::popExpired(TimePoint now) {
+    if (heap.empty() || heap.front().deadline > now) {
+        return NONE;
+    }
+    int timer = heap.front().timer;
+    cancel(timer);
+    return timer;
+}
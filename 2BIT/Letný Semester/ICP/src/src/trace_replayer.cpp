@@ -0,0 +1,184 @@
+/**
+ * @file trace_replayer.cpp
+ * @brief Implementation of the TraceReplayer class
+ * @author Hugo Bohácsek (xbohach00)
+ */
+
+#include "../headers/trace_replayer.h"
+#include <chrono>
+#include <functional>
+#include <stdexcept>
+#include "../headers/machine_clock.h"
+#include "../headers/machine_simulator.h"
+
+using namespace std::chrono;
+
+/**
+ * @brief Constructor
+ *
+ * @param machine The machine to replay on, must outlive the replayer
+ * @param maxReported Number of mismatches kept in the result
+ */
+TraceReplayer::TraceReplayer(const MooreMachine& machine, size_t maxReported)
+    : machine(machine), maxReported(maxReported), maxStepsPerInstant(10000) {}
+
+/**
+ * @brief Replays a trace file
+ *
+ * @param filename Path of the trace file
+ * @return Counts and the first mismatches
+ * @throw std::runtime_error If the trace is malformed or the machine cannot be simulated
+ */
+ReplayResult TraceReplayer::replay(const std::string& filename) const {
+    auto start = steady_clock::now();
+    ReplayResult result{};
+    TraceReader reader(filename);
+
+    // The copy keeps the caller's machine and its variables untouched
+    MooreMachine replayed = machine;
+    VirtualClock clock;
+    replayed.setClock(&clock);
+    replayed.resetVariables();
+    MachineSimulator simulator(&replayed);
+
+    const steady_clock::time_point epoch;
+    int stepsAtInstant = 0;
+    steady_clock::time_point instant = epoch;
+    auto afterStep = [&]() {
+        result.steps++;
+        if (clock.now() != instant) {
+            instant = clock.now();
+            stepsAtInstant = 0;
+        }
+        if (++stepsAtInstant > maxStepsPerInstant) {
+            throw std::runtime_error("No progress after " + std::to_string(maxStepsPerInstant) + " steps at " +
+                                     std::to_string(duration_cast<milliseconds>(instant - epoch).count()) +
+                                     " ms, the machine keeps changing state");
+        }
+    };
+
+    // Make every step due by an input's time before feeding it
+    auto catchUp = [&](long long time) {
+        steady_clock::time_point at = epoch + microseconds(time);
+        while (simulator.advance(at)) {
+            afterStep();
+        }
+        clock.sleepUntil(at);
+    };
+
+    // Steps one at a time so values a live run passed through within one instant are seen too
+    auto compare = [&](const TraceRecord& record, const std::string& name, const std::string& expected,
+                       const std::function<std::string()>& actual) {
+        steady_clock::time_point at = epoch + microseconds(record.time);
+        std::string value = actual();
+        while (value != expected && simulator.advance(at)) {
+            afterStep();
+            value = actual();
+        }
+
+        result.compared++;
+        if (value == expected) {
+            return;
+        }
+        result.mismatchCount++;
+        if (result.mismatches.size() < maxReported) {
+            result.mismatches.push_back(TraceMismatch{record.time, record.type, name, expected, value});
+        }
+    };
+
+    TraceRecord record;
+    while (reader.next(record)) {
+        result.records++;
+        result.traceMicros = record.time;
+
+        switch (record.type) {
+            case TraceFormat::RESET:
+                catchUp(record.time);
+                simulator.reset(clock.now());
+                afterStep();
+                break;
+
+            case TraceFormat::SYNC: {
+                // The seed records that follow hold the values the machine was observed with
+                catchUp(record.time);
+                std::vector<std::pair<std::string, std::string>> inputs, outputs;
+                std::string stateId = record.name;
+                steady_clock::time_point enteredAt = clock.now() - microseconds(record.elapsed);
+                for (size_t i = record.count; i > 0; i--) {
+                    if (!reader.next(record)) {
+                        throw std::runtime_error("Trace ends inside the values of a sync record");
+                    }
+                    result.records++;
+                    if (record.type == TraceFormat::INPUT) {
+                        inputs.emplace_back(record.name, record.value);
+                    } else if (record.type == TraceFormat::OUTPUT) {
+                        outputs.emplace_back(record.name, record.value);
+                    } else if (record.type == TraceFormat::VARIABLE) {
+                        MachineVariable* variable = replayed.getVariable(record.name);
+                        if (variable) {
+                            variable->setValue(record.value);
+                        }
+                    } else {
+                        throw std::runtime_error("Unexpected record inside the values of a sync record");
+                    }
+                }
+                simulator.restore(stateId, enteredAt, inputs, outputs);
+                break;
+            }
+
+            case TraceFormat::INPUT:
+                catchUp(record.time);
+                result.inputs++;
+                simulator.setInput(record.name, record.value);
+                simulator.processInputs(clock.now());
+                afterStep();
+                break;
+
+            case TraceFormat::STATE:
+                compare(record, "", record.name, [&]() {
+                    State* state = simulator.getCurrentState();
+                    return state ? state->getId() : std::string();
+                });
+                break;
+
+            case TraceFormat::OUTPUT:
+                compare(record, record.name, record.value, [&]() { return simulator.getOutput(record.name); });
+                break;
+
+            case TraceFormat::VARIABLE:
+                compare(record, record.name, record.value, [&]() {
+                    MachineVariable* variable = replayed.getVariable(record.name);
+                    return variable ? variable->getValueString() : std::string();
+                });
+                break;
+        }
+    }
+
+    result.seconds = duration<double>(steady_clock::now() - start).count();
+    return result;
+}
+
+/**
+ * @brief Describes the outcome of a replay
+ *
+ * @param result Results of replay()
+ * @return One line per fact, then one per reported mismatch
+ */
+std::vector<std::string> TraceReplayer::describe(const ReplayResult& result) {
+    std::vector<std::string> lines;
+    lines.push_back(std::to_string(result.records) + " records, " + std::to_string(result.inputs) + " inputs, " +
+                    std::to_string(result.compared) + " values compared, " + std::to_string(result.mismatchCount) +
+                    " mismatches");
+
+    for (const TraceMismatch& mismatch : result.mismatches) {
+        std::string what = mismatch.type == TraceFormat::STATE ? "state" :
+                           mismatch.type == TraceFormat::OUTPUT ? "output " + mismatch.name :
+                           "variable " + mismatch.name;
+        lines.push_back("  at " + std::to_string(mismatch.time / 1000) + " ms " + what + ": recorded \"" +
+                        mismatch.expected + "\", replayed \"" + mismatch.actual + "\"");
+    }
+    if (result.mismatchCount > result.mismatches.size()) {
+        lines.push_back("  " + std::to_string(result.mismatchCount - result.mismatches.size()) + " more not shown");
+    }
+    return lines;
+}
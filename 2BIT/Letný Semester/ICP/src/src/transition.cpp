@@ -58,7 +58,7 @@ Transition::Transition(const std::string& id, const std::string& sourceId,
  * 
  * @return The transition ID
  */
-std::string Transition::getId() const {
+const std::string& Transition::getId() const {
     return id;
 }
 
@@ -67,7 +67,7 @@ std::string Transition::getId() const {
  * 
  * @return The source state ID
  */
-std::string Transition::getSourceId() const {
+const std::string& Transition::getSourceId() const {
     return sourceId;
 }
 
@@ -76,7 +76,7 @@ std::string Transition::getSourceId() const {
  * 
  * @return The target state ID
  */
-std::string Transition::getTargetId() const {
+const std::string& Transition::getTargetId() const {
     return targetId;
 }
 
@@ -85,7 +85,7 @@ std::string Transition::getTargetId() const {
  * 
  * @return Vector of input conditions
  */
-std::vector<InputCondition> Transition::getInputConditions() const {
+const std::vector<InputCondition>& Transition::getInputConditions() const {
     return inputs;
 }
 
@@ -192,13 +192,16 @@ bool Transition::isTriggered(
                 continue; // Variable not found, condition not met
             }
             
-            std::string leftValue = leftVarIt->second.getValueString();
+            // Values are compared as text, printed without allocating
+            char leftBuffer[32];
+            char rightBuffer[32];
+            std::string_view leftValue = leftVarIt->second.getValueView(leftBuffer);
             
             // Get the right operand value (could be a literal or a variable)
-            std::string rightValue = inputCondition.rightOperand;
+            std::string_view rightValue = inputCondition.rightOperand;
             auto rightVarIt = variables.find(inputCondition.rightOperand);
             if (rightVarIt != variables.end()) {
-                rightValue = rightVarIt->second.getValueString();
+                rightValue = rightVarIt->second.getValueView(rightBuffer);
             }
             
             // Evaluate the expression
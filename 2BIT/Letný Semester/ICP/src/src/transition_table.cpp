@@ -0,0 +1,198 @@
+/**
+ * @file transition_table.cpp
+ * @brief Implementation of the TransitionTable class
+ * @author Hugo Bohácsek (xbohach00)
+ */
+
+#include "../headers/transition_table.h"
+#include "../headers/moore_machine.h"
+
+/**
+ * @brief Compiles the states and transitions of a machine
+ *
+ * States are numbered in the order of MooreMachine::getStateHandles() and
+ * each state's transitions are taken in the order they were added, so the
+ * first matching transition wins just like a linear scan would.
+ *
+ * @param owner Machine to compile
+ */
+TransitionTable::TransitionTable(MooreMachine& owner) : owner(&owner) {
+    // Intern the states, the machine's handles may have gaps left by removed states
+    std::vector<StateHandle> handles = owner.getStateHandles();
+    std::vector<int> indexByHandle(owner.getStateHandleBound(), NONE);
+    stateIds.reserve(handles.size());
+    stateIndices.reserve(handles.size());
+    for (StateHandle handle : handles) {
+        const std::string& id = owner.getState(handle)->getId();
+        indexByHandle[handle] = static_cast<int>(stateIds.size());
+        stateIndices.emplace(id, static_cast<int>(stateIds.size()));
+        stateIds.push_back(id);
+    }
+
+    // Lay the transitions out grouped by source state, interning pointers and symbols
+    outgoingOffsets.assign(stateIds.size() + 1, 0);
+    for (size_t i = 0; i < handles.size(); i++) {
+        const std::vector<TransitionHandle>& leaving = owner.getOutgoingHandles(handles[i]);
+        outgoingOffsets[i + 1] = outgoingOffsets[i] + static_cast<int>(leaving.size());
+        for (TransitionHandle transition : leaving) {
+            outgoing.push_back(owner.getTransition(transition));
+            targets.push_back(indexByHandle[owner.getTargetHandle(transition)]);
+            for (const auto& input : outgoing.back()->getInputConditions()) {
+                if (input.isBooleanExpr) {
+                    continue;
+                }
+                pointerIndices.emplace(input.source, static_cast<int>(pointerIndices.size()));
+                symbolIndices.emplace(input.value, static_cast<int>(symbolIndices.size()));
+            }
+        }
+    }
+
+    // Fill the dispatch table, the first transition seen for a key wins
+    for (size_t i = 0; i < handles.size(); i++) {
+        for (int transition = outgoingOffsets[i]; transition < outgoingOffsets[i + 1]; transition++) {
+            for (const auto& input : outgoing[transition]->getInputConditions()) {
+                if (input.isBooleanExpr) {
+                    continue;
+                }
+                uint64_t key = makeKey(static_cast<int>(i),
+                                       pointerIndices.at(input.source),
+                                       symbolIndices.at(input.value));
+                dispatch.emplace(key, targets[transition]);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Packs a (state, pointer, symbol) triple into a dispatch key
+ *
+ * @param state State index
+ * @param pointer Input pointer index
+ * @param symbol Input symbol index
+ * @return Key unique for the triple
+ */
+uint64_t TransitionTable::makeKey(int state, int pointer, int symbol) const {
+    return (static_cast<uint64_t>(state) * pointerIndices.size() + static_cast<uint64_t>(pointer))
+           * symbolIndices.size() + static_cast<uint64_t>(symbol);
+}
+
+/**
+ * @brief Gets the machine the table was built for
+ *
+ * @return Pointer to the owning machine
+ */
+const MooreMachine* TransitionTable::getOwner() const {
+    return owner;
+}
+
+/**
+ * @brief Gets the number of interned states
+ *
+ * @return Number of states
+ */
+int TransitionTable::getStateCount() const {
+    return static_cast<int>(stateIds.size());
+}
+
+/**
+ * @brief Gets the dense index of a state
+ *
+ * @param stateId ID of the state
+ * @return Index of the state, or NONE if not found
+ */
+int TransitionTable::getStateIndex(const std::string& stateId) const {
+    auto it = stateIndices.find(stateId);
+    return it != stateIndices.end() ? it->second : NONE;
+}
+
+/**
+ * @brief Gets the ID of a state by its dense index
+ *
+ * @param index Index of the state
+ * @return ID of the state
+ */
+const std::string& TransitionTable::getStateId(int index) const {
+    return stateIds[index];
+}
+
+/**
+ * @brief Gets the dense index of an input pointer
+ *
+ * @param pointer Name of the input pointer
+ * @return Index of the pointer, or NONE if no transition reads it
+ */
+int TransitionTable::getPointerIndex(const std::string& pointer) const {
+    auto it = pointerIndices.find(pointer);
+    return it != pointerIndices.end() ? it->second : NONE;
+}
+
+/**
+ * @brief Gets the dense index of an input symbol
+ *
+ * @param symbol Input symbol
+ * @return Index of the symbol, or NONE if no transition expects it
+ */
+int TransitionTable::getSymbolIndex(const std::string& symbol) const {
+    auto it = symbolIndices.find(symbol);
+    return it != symbolIndices.end() ? it->second : NONE;
+}
+
+/**
+ * @brief Looks up the target of a transition
+ *
+ * @param state Index of the source state
+ * @param pointer Index of the input pointer
+ * @param symbol Index of the input symbol
+ * @return Index of the target state, or NONE if no transition matches
+ */
+int TransitionTable::getNextState(int state, int pointer, int symbol) const {
+    if (state == NONE || pointer == NONE || symbol == NONE) {
+        return NONE;
+    }
+    auto it = dispatch.find(makeKey(state, pointer, symbol));
+    return it != dispatch.end() ? it->second : NONE;
+}
+
+/**
+ * @brief Gets the transitions leaving a state
+ *
+ * @param state Index of the source state
+ * @return Range of transitions, empty for an unknown state
+ */
+TransitionSpan TransitionTable::getOutgoing(int state) const {
+    if (state < 0 || state >= getStateCount()) {
+        return TransitionSpan{nullptr, nullptr, 0};
+    }
+    return TransitionSpan{outgoing.data() + outgoingOffsets[state],
+                          outgoing.data() + outgoingOffsets[state + 1],
+                          outgoingOffsets[state]};
+}
+
+/**
+ * @brief Gets the number of compiled transitions
+ *
+ * @return Number of transitions
+ */
+int TransitionTable::getTransitionCount() const {
+    return static_cast<int>(outgoing.size());
+}
+
+/**
+ * @brief Gets a transition by its dense index
+ *
+ * @param index Index of the transition, see TransitionSpan::offset
+ * @return Pointer to the transition
+ */
+Transition* TransitionTable::getTransition(int index) const {
+    return outgoing[index];
+}
+
+/**
+ * @brief Gets the target state of a transition by its dense index
+ *
+ * @param index Index of the transition, see TransitionSpan::offset
+ * @return Index of the target state
+ */
+int TransitionTable::getTarget(int index) const {
+    return targets[index];
+}
@@ -0,0 +1,1085 @@
+/**
+ * @file vector_simulator.cpp
+ * @brief Implementation of the VectorSimulator class
+ * @author Hugo Bohácsek (xbohach00)
+ */
+
+#include "../headers/vector_simulator.h"
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstdio>
+#include <stdexcept>
+#include "../headers/transition_table.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define VECTOR_SIMULATOR_AVX2
+#include <immintrin.h>
+#endif
+
+using namespace std::chrono;
+
+/**
+ * @brief Looks up the first triggered transition of each listed lane
+ *
+ * @param lanes Lanes to look up
+ * @param count Number of lanes
+ * @param states Current state by lane
+ * @param symbols Pending symbol by [pointer][lane]
+ * @param laneCount Number of lanes in the columns
+ * @param pointers Number of dispatched input pointers
+ * @param stride Number of symbols plus the none column
+ * @param ranks First immediate transition by [state][pointer][symbol]
+ * @param best Receives the lowest rank of each listed lane
+ */
+static void findRanksScalar(const uint32_t* lanes, size_t count, const int32_t* states, const int32_t* symbols,
+                            size_t laneCount, int pointers, int stride, const int32_t* ranks, int32_t* best) {
+    for (size_t i = 0; i < count; i++) {
+        uint32_t lane = lanes[i];
+        int32_t row = states[lane] * pointers;
+        int32_t rank = INT32_MAX;
+        for (int pointer = 0; pointer < pointers; pointer++) {
+            rank = std::min(rank, ranks[(row + pointer) * stride + symbols[pointer * laneCount + lane]]);
+        }
+        best[i] = rank;
+    }
+}
+
+#ifdef VECTOR_SIMULATOR_AVX2
+/**
+ * @brief Same as findRanksScalar(), eight lanes at a time with AVX2 gathers
+ *
+ * @param lanes Lanes to look up
+ * @param count Number of lanes
+ * @param states Current state by lane
+ * @param symbols Pending symbol by [pointer][lane]
+ * @param laneCount Number of lanes in the columns
+ * @param pointers Number of dispatched input pointers
+ * @param stride Number of symbols plus the none column
+ * @param ranks First immediate transition by [state][pointer][symbol]
+ * @param best Receives the lowest rank of each listed lane
+ */
+__attribute__((target("avx2")))
+static void findRanksAvx2(const uint32_t* lanes, size_t count, const int32_t* states, const int32_t* symbols,
+                          size_t laneCount, int pointers, int stride, const int32_t* ranks, int32_t* best) {
+    const int* stateBase = reinterpret_cast<const int*>(states);
+    const int* rankBase = reinterpret_cast<const int*>(ranks);
+    const __m256i pointerCount = _mm256_set1_epi32(pointers);
+    const __m256i symbolCount = _mm256_set1_epi32(stride);
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i lane = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lanes + i));
+        __m256i row = _mm256_mullo_epi32(_mm256_i32gather_epi32(stateBase, lane, 4), pointerCount);
+        __m256i rank = _mm256_set1_epi32(INT32_MAX);
+        for (int pointer = 0; pointer < pointers; pointer++) {
+            const int* column = reinterpret_cast<const int*>(symbols + pointer * laneCount);
+            __m256i symbol = _mm256_i32gather_epi32(column, lane, 4);
+            __m256i key = _mm256_add_epi32(
+                _mm256_mullo_epi32(_mm256_add_epi32(row, _mm256_set1_epi32(pointer)), symbolCount), symbol);
+            rank = _mm256_min_epi32(rank, _mm256_i32gather_epi32(rankBase, key, 4));
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(best + i), rank);
+    }
+    findRanksScalar(lanes + i, count - i, states, symbols, laneCount, pointers, stride, ranks, best + i);
+}
+#endif
+
+/**
+ * @brief Gets the index of the lowest set bit
+ *
+ * @param bits Non-zero bit set
+ * @return Index of its lowest bit
+ */
+static inline int lowestBit(uint32_t bits) {
+#ifdef __GNUC__
+    return __builtin_ctz(bits);
+#else
+    int index = 0;
+    while (!(bits & 1u)) {
+        bits >>= 1;
+        index++;
+    }
+    return index;
+#endif
+}
+
+/**
+ * @brief Parses text the way a variable of the given type is set
+ *
+ * @param type INT or FLOAT
+ * @param text The text
+ * @return Variable holding the parsed value
+ * @throw std::runtime_error If the text cannot be parsed
+ */
+static MachineVariable parseAs(VariableType type, const std::string& text) {
+    MachineVariable variable(type == VariableType::INT ? "int" : "float", "", "0");
+    variable.setValue(text);
+    return variable;
+}
+
+/**
+ * @brief Prints a float the way MachineVariable does
+ *
+ * @param value The float
+ * @param buffer Storage for the text
+ * @return The text, valid while buffer is
+ */
+static std::string_view floatText(float value, char (&buffer)[32]) {
+    MachineVariable variable;
+    variable.setFloatValue(value);
+    return variable.getValueView(buffer);
+}
+
+/**
+ * @brief Constructor, compiles the machine into lane tables
+ *
+ * @param machine The machine to simulate
+ * @throw std::runtime_error If the machine has no states, string variables,
+ *        string literals or elapsed in expressions, or a state with more
+ *        than 32 timed transitions
+ */
+VectorSimulator::VectorSimulator(const MooreMachine& machine)
+    : dispatchedPointers(0), symbolStride(1), initialState(0), avx2(false), horizon(0),
+      maxStepsPerInstant(10000), laneCount(0), firstErrorLane(SIZE_MAX) {
+    // Compiled outputs and the transition table are built on demand, so work on a copy
+    MooreMachine compiled = machine;
+    compiled.resetVariables();
+    const TransitionTable& table = compiled.getCompiledTransitions();
+    if (table.getStateCount() == 0) {
+        throw std::runtime_error("Machine has no states");
+    }
+
+    // Variables get one column each, in name order so runs do not depend on hashing
+    std::vector<std::string> names;
+    for (const auto& entry : compiled.getVariablesView()) {
+        if (entry.second.getType() != VariableType::INT && entry.second.getType() != VariableType::FLOAT) {
+            throw std::runtime_error("Variable " + entry.first +
+                                     " is not a number, vector simulation supports int and float variables only");
+        }
+        names.push_back(entry.first);
+    }
+    std::sort(names.begin(), names.end());
+    for (const std::string& name : names) {
+        const MachineVariable& variable = compiled.getVariablesView().at(name);
+        LaneVariable column{name, variable.getType(), 0, 0.0f};
+        if (column.type == VariableType::INT) {
+            column.initialInt = std::get<int>(variable.getValue());
+        } else {
+            column.initialFloat = std::get<float>(variable.getValue());
+        }
+        variableIndices.emplace(name, static_cast<int>(variables.size()));
+        variables.push_back(column);
+    }
+
+    // Pointers and symbols keep the indices the transition table interned them with
+    std::vector<std::string> symbolNames;
+    for (int transition = 0; transition < table.getTransitionCount(); transition++) {
+        for (const auto& input : table.getTransition(transition)->getInputConditions()) {
+            if (input.isBooleanExpr) {
+                continue;
+            }
+            size_t pointer = static_cast<size_t>(table.getPointerIndex(input.source));
+            size_t symbol = static_cast<size_t>(table.getSymbolIndex(input.value));
+            pointerNames.resize(std::max(pointerNames.size(), pointer + 1));
+            pointerNames[pointer] = input.source;
+            symbolNames.resize(std::max(symbolNames.size(), symbol + 1));
+            symbolNames[symbol] = input.value;
+        }
+    }
+    for (size_t i = 0; i < pointerNames.size(); i++) {
+        pointerIndices.emplace(pointerNames[i], static_cast<int>(i));
+    }
+    for (size_t i = 0; i < symbolNames.size(); i++) {
+        if (!symbolNames[i].empty()) {
+            symbolIndices.emplace(symbolNames[i], static_cast<int>(i));
+        }
+    }
+    dispatchedPointers = static_cast<int>(pointerNames.size());
+    symbolStride = static_cast<int>(symbolNames.size()) + 1;
+
+    size_t tableSize = static_cast<size_t>(table.getStateCount()) * dispatchedPointers * symbolStride;
+    if (tableSize > static_cast<size_t>(INT32_MAX)) {
+        throw std::runtime_error("Dispatch table of " + std::to_string(tableSize) + " entries is too large");
+    }
+    ranks.assign(tableSize, NO_RANK);
+
+    for (const std::string& output : compiled.getOutputPointers()) {
+        outputIndices.emplace(output, static_cast<int>(outputNames.size()));
+        outputNames.push_back(output);
+    }
+
+    for (int index = 0; index < table.getStateCount(); index++) {
+        TransitionSpan outgoing = table.getOutgoing(index);
+        LaneState state{table.getStateId(index), outgoing.offset, static_cast<int>(outgoing.size()), 0, {}, false,
+                        false, {}};
+
+        for (size_t rank = 0; rank < outgoing.size(); rank++) {
+            const Transition* source = outgoing.first[rank];
+            LaneTransition transition{table.getTarget(outgoing.offset + static_cast<int>(rank)),
+                                      TransitionKind::IMMEDIATE, -1, source->getTimeout(), {}, {}, {}};
+            if (source->getTimeout() > 0) {
+                transition.kind = source->getInputConditions().empty() ? TransitionKind::TIMEOUT : TransitionKind::TIMED;
+                if (state.timers.size() == static_cast<size_t>(MAX_TIMERS)) {
+                    throw std::runtime_error("State " + state.id + " has more than " + std::to_string(MAX_TIMERS) +
+                                             " timed transitions");
+                }
+                transition.timer = static_cast<int>(state.timers.size());
+                state.timers.push_back(outgoing.offset + static_cast<int>(rank));
+            }
+
+            for (const auto& input : source->getInputConditions()) {
+                if (input.isBooleanExpr) {
+                    auto left = variableIndices.find(input.leftOperand);
+                    auto right = variableIndices.find(input.rightOperand);
+                    Guard guard{left != variableIndices.end() ? left->second : -1, input.operation == "==",
+                                right != variableIndices.end() ? right->second : -1, input.rightOperand};
+                    if (input.operation != "==" && input.operation != "!=") {
+                        guard.left = -1;
+                    }
+                    transition.guards.push_back(guard);
+                    continue;
+                }
+
+                int pointer = pointerIndices.at(input.source);
+                transition.consumed.push_back(pointer);
+                auto symbol = symbolIndices.find(input.value);
+                if (symbol == symbolIndices.end()) {
+                    continue;
+                }
+                transition.conditions.emplace_back(pointer, symbol->second);
+                if (transition.kind == TransitionKind::IMMEDIATE) {
+                    int32_t& entry = ranks[(static_cast<size_t>(index) * dispatchedPointers + pointer) * symbolStride +
+                                           symbol->second];
+                    entry = std::min(entry, static_cast<int32_t>(rank));
+                }
+            }
+
+            if (transition.kind == TransitionKind::TIMEOUT) {
+                state.timeouts |= 1u << transition.timer;
+            } else if (transition.kind == TransitionKind::TIMED) {
+                state.timed = true;
+            } else if (!transition.guards.empty()) {
+                state.guarded = true;
+            }
+            transitions.push_back(transition);
+        }
+
+        for (CompiledOutput& output : compiled.getCompiledOutputs(state.id)) {
+            Action action{output.action, -1, -1, false, -1, {}, {}};
+            if (output.hasCondition) {
+                action.condition = addPointer(output.conditionPtr);
+            }
+            switch (output.action) {
+                case OutputAction::ASSIGN_INPUT:
+                    action.source = addPointer(output.source);
+                    [[fallthrough]];
+                case OutputAction::ASSIGN_EXPRESSION: {
+                    auto variable = variableIndices.find(output.target);
+                    action.target = variable != variableIndices.end() ? variable->second : -1;
+                    break;
+                }
+                case OutputAction::OUTPUT_EXPRESSION:
+                case OutputAction::VALUE:
+                    if (outputIndices.find(output.target) == outputIndices.end()) {
+                        outputIndices.emplace(output.target, static_cast<int>(outputNames.size()));
+                        outputNames.push_back(output.target);
+                    }
+                    action.target = outputIndices.at(output.target);
+                    break;
+                case OutputAction::INVALID:
+                    action.error = output.source;
+                    break;
+            }
+            if (output.action == OutputAction::VALUE) {
+                auto variable = variableIndices.find(output.source);
+                action.sourceIsVariable = variable != variableIndices.end();
+                if (action.sourceIsVariable) {
+                    action.source = variable->second;
+                } else {
+                    auto literal = std::find(literals.begin(), literals.end(), output.source);
+                    action.source = static_cast<int>(literal - literals.begin());
+                    if (literal == literals.end()) {
+                        literals.push_back(output.source);
+                    }
+                }
+            } else if (output.action == OutputAction::ASSIGN_EXPRESSION ||
+                       output.action == OutputAction::OUTPUT_EXPRESSION) {
+                action.program = compileProgram(output.program);
+            }
+            state.actions.push_back(std::move(action));
+        }
+        states.push_back(std::move(state));
+    }
+
+    State* initial = compiled.getInitialState();
+    initialState = initial ? table.getStateIndex(initial->getId()) : 0;
+
+#ifdef VECTOR_SIMULATOR_AVX2
+    avx2 = __builtin_cpu_supports("avx2");
+#endif
+}
+
+/**
+ * @brief Compiles an expression program against the variable columns
+ *
+ * @param program The program
+ * @return Operations in execution order
+ * @throw std::runtime_error If the program uses strings or the elapsed keyword
+ */
+std::vector<VectorSimulator::Operation> VectorSimulator::compileProgram(const ExpressionProgram& program) const {
+    std::vector<Operation> operations;
+    for (const Instruction& instruction : program.getInstructions()) {
+        Operation operation{instruction.op, instruction.operation, -1, Value{ValueKind::NONE, 0, 0.0f}, {}};
+        if (instruction.op == OpCode::FAIL) {
+            operation.error = program.getError(instruction.index);
+            operations.push_back(operation);
+            continue;
+        }
+
+        switch (instruction.kind) {
+            case OperandKind::CONSTANT: {
+                const MachineVariable& constant = program.getConstant(instruction.index);
+                if (constant.getType() == VariableType::INT) {
+                    operation.constant = Value{ValueKind::INT, std::get<int>(constant.getValue()), 0.0f};
+                } else if (constant.getType() == VariableType::FLOAT) {
+                    operation.constant = Value{ValueKind::FLOAT, 0, std::get<float>(constant.getValue())};
+                } else {
+                    throw std::runtime_error("String literal \"" + constant.getValueString() +
+                                             "\" in an expression, vector simulation supports numbers only");
+                }
+                break;
+            }
+            case OperandKind::VARIABLE: {
+                const std::string& name = program.getSlotName(instruction.index);
+                auto variable = variableIndices.find(name);
+                if (variable == variableIndices.end()) {
+                    // Fails when it runs, like an unresolved slot does
+                    operation.op = OpCode::FAIL;
+                    operation.error = "Unknown variable: " + name;
+                } else {
+                    operation.variable = variable->second;
+                }
+                break;
+            }
+            case OperandKind::ELAPSED:
+                throw std::runtime_error("Expression reads elapsed, which lanes do not keep");
+            case OperandKind::NONE:
+                continue;
+        }
+        operations.push_back(operation);
+    }
+    return operations;
+}
+
+/**
+ * @brief Gets the column of an input pointer, adding it if it is new
+ *
+ * @param name Name of the input pointer
+ * @return Index of the column
+ */
+int VectorSimulator::addPointer(const std::string& name) {
+    auto it = pointerIndices.find(name);
+    if (it != pointerIndices.end()) {
+        return it->second;
+    }
+    pointerIndices.emplace(name, static_cast<int>(pointerNames.size()));
+    pointerNames.push_back(name);
+    return static_cast<int>(pointerNames.size()) - 1;
+}
+
+/**
+ * @brief Sets how long instances keep running after their last input
+ *
+ * @param milliseconds Virtual time in milliseconds
+ */
+void VectorSimulator::setHorizon(long long milliseconds) {
+    horizon = milliseconds;
+}
+
+/**
+ * @brief Gets how the first triggered transitions are looked up
+ *
+ * @return "avx2" or "scalar"
+ */
+const char* VectorSimulator::getKernelName() const {
+    return avx2 ? "avx2" : "scalar";
+}
+
+/**
+ * @brief Interns an input value for the current run
+ *
+ * @param text The value
+ * @return Index of the value
+ */
+int VectorSimulator::internValue(const std::string& text) {
+    auto it = valueIds.find(text);
+    if (it != valueIds.end()) {
+        return it->second;
+    }
+
+    auto symbol = symbolIndices.find(text);
+    InputValue value{text, symbol != symbolIndices.end() ? symbol->second : symbolStride - 1, false, 0, false, 0.0f};
+    try {
+        value.intValue = std::get<int>(parseAs(VariableType::INT, text).getValue());
+        value.intValid = true;
+    } catch (const std::exception&) {
+    }
+    try {
+        value.floatValue = std::get<float>(parseAs(VariableType::FLOAT, text).getValue());
+        value.floatValid = true;
+    } catch (const std::exception&) {
+    }
+
+    valueIds.emplace(text, static_cast<int>(values.size()));
+    values.push_back(value);
+    return static_cast<int>(values.size()) - 1;
+}
+
+/**
+ * @brief Puts every lane into the initial state
+ *
+ * @param count Number of lanes
+ */
+void VectorSimulator::resetLanes(size_t count) {
+    laneCount = count;
+    laneStates.assign(count, initialState);
+    justEntered.assign(count, 0);
+    settled.assign(count, 0);
+    failed.assign(count, 0);
+    enteredAt.assign(count, 0);
+    laneNow.assign(count, 0);
+    nextDue.assign(count, LLONG_MAX);
+    armed.assign(count, 0);
+    size_t timers = 0;
+    for (const LaneState& state : states) {
+        timers = std::max(timers, state.timers.size());
+    }
+    due.assign(timers * count, 0);
+    laneSteps.assign(count, 0);
+    instant.assign(count, 0);
+    stepsAtInstant.assign(count, 0);
+    symbols.assign(dispatchedPointers * count, symbolStride - 1);
+    inputs.assign(pointerNames.size() * count, 0);
+    ints.assign(variables.size() * count, 0);
+    floats.assign(variables.size() * count, 0.0f);
+    outputs.assign(outputNames.size() * count, Value{ValueKind::NONE, 0, 0.0f});
+    firstErrorLane = SIZE_MAX;
+    firstError.clear();
+
+    for (size_t variable = 0; variable < variables.size(); variable++) {
+        std::fill_n(ints.begin() + variable * count, count, variables[variable].initialInt);
+        std::fill_n(floats.begin() + variable * count, count, variables[variable].initialFloat);
+    }
+
+    for (uint32_t lane = 0; lane < count; lane++) {
+        try {
+            enterState(lane, initialState);
+        } catch (const std::exception& e) {
+            failLane(lane, e.what());
+        }
+    }
+}
+
+/**
+ * @brief Moves a lane to a state, arms its timeouts and runs its outputs
+ *
+ * @param lane The lane
+ * @param state Index of the entered state
+ * @throw std::runtime_error If an output statement fails
+ */
+void VectorSimulator::enterState(uint32_t lane, int state) {
+    const LaneState& entered = states[state];
+    long long now = laneNow[lane];
+    laneStates[lane] = state;
+    enteredAt[lane] = now;
+    justEntered[lane] = 1;
+    settled[lane] = 0;
+
+    armed[lane] = entered.timeouts;
+    for (uint32_t bits = entered.timeouts; bits; bits &= bits - 1) {
+        int timer = lowestBit(bits);
+        due[timer * laneCount + lane] = now + transitions[entered.timers[timer]].timeout;
+    }
+    updateNextDue(lane);
+
+    for (const Action& action : entered.actions) {
+        if (action.condition >= 0 && inputs[action.condition * laneCount + lane] == 0) {
+            continue;
+        }
+
+        switch (action.action) {
+            case OutputAction::ASSIGN_INPUT: {
+                if (action.target < 0) {
+                    break;
+                }
+                const InputValue& value = values[inputs[action.source * laneCount + lane]];
+                const LaneVariable& variable = variables[action.target];
+                bool valid = variable.type == VariableType::INT ? value.intValid : value.floatValid;
+                if (!valid) {
+                    parseAs(variable.type, value.text);
+                }
+                if (variable.type == VariableType::INT) {
+                    ints[action.target * laneCount + lane] = value.intValue;
+                } else {
+                    floats[action.target * laneCount + lane] = value.floatValue;
+                }
+                break;
+            }
+            case OutputAction::ASSIGN_EXPRESSION: {
+                Value result = evaluate(action.program, lane);
+                if (action.target >= 0) {
+                    assign(action.target, lane, result);
+                }
+                break;
+            }
+            case OutputAction::OUTPUT_EXPRESSION:
+                outputs[action.target * laneCount + lane] = evaluate(action.program, lane);
+                break;
+            case OutputAction::VALUE:
+                if (!action.sourceIsVariable) {
+                    outputs[action.target * laneCount + lane] = Value{ValueKind::LITERAL, action.source, 0.0f};
+                } else if (variables[action.source].type == VariableType::INT) {
+                    outputs[action.target * laneCount + lane] =
+                        Value{ValueKind::INT, ints[action.source * laneCount + lane], 0.0f};
+                } else {
+                    outputs[action.target * laneCount + lane] =
+                        Value{ValueKind::FLOAT, 0, floats[action.source * laneCount + lane]};
+                }
+                break;
+            case OutputAction::INVALID:
+                throw std::runtime_error(action.error);
+        }
+    }
+}
+
+/**
+ * @brief Clears the inputs a transition consumed
+ *
+ * @param lane The lane
+ * @param transition The taken transition
+ */
+void VectorSimulator::consume(uint32_t lane, const LaneTransition& transition) {
+    for (int pointer : transition.consumed) {
+        inputs[pointer * laneCount + lane] = 0;
+        symbols[pointer * laneCount + lane] = symbolStride - 1;
+    }
+}
+
+/**
+ * @brief Recomputes the earliest armed timer of a lane
+ *
+ * @param lane The lane
+ */
+void VectorSimulator::updateNextDue(uint32_t lane) {
+    long long earliest = LLONG_MAX;
+    for (uint32_t bits = armed[lane]; bits; bits &= bits - 1) {
+        earliest = std::min(earliest, due[lowestBit(bits) * laneCount + lane]);
+    }
+    nextDue[lane] = earliest;
+}
+
+/**
+ * @brief Gets the time a lane has to be stepped next
+ *
+ * @param lane The lane
+ * @return Virtual time in milliseconds, LLONG_MAX if nothing is pending
+ */
+long long VectorSimulator::deadline(uint32_t lane) const {
+    // A new state or input has to be evaluated right away
+    return settled[lane] ? nextDue[lane] : enteredAt[lane];
+}
+
+/**
+ * @brief Checks whether a transition is triggered in a lane
+ *
+ * @param transition The transition
+ * @param lane The lane
+ * @return True if any of its conditions holds
+ */
+bool VectorSimulator::isTriggered(const LaneTransition& transition, uint32_t lane) const {
+    for (const auto& condition : transition.conditions) {
+        if (symbols[condition.first * laneCount + lane] == condition.second) {
+            return true;
+        }
+    }
+    for (const Guard& guard : transition.guards) {
+        if (guardHolds(guard, lane)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Checks a boolean condition in a lane
+ *
+ * @param guard The condition
+ * @param lane The lane
+ * @return True if it holds
+ */
+bool VectorSimulator::guardHolds(const Guard& guard, uint32_t lane) const {
+    if (guard.left < 0) {
+        return false;
+    }
+
+    // Two ints print the same exactly when they are equal
+    if (guard.right >= 0 && variables[guard.left].type == VariableType::INT &&
+        variables[guard.right].type == VariableType::INT) {
+        bool same = ints[guard.left * laneCount + lane] == ints[guard.right * laneCount + lane];
+        return same == guard.equal;
+    }
+
+    // Anything else is compared as text, like Transition::isTriggered() does
+    char leftBuffer[32];
+    char rightBuffer[32];
+    std::string_view left = variableText(guard.left, lane, leftBuffer);
+    std::string_view right = guard.right >= 0 ? variableText(guard.right, lane, rightBuffer)
+                                              : std::string_view(guard.literal);
+    return (left == right) == guard.equal;
+}
+
+/**
+ * @brief Prints a variable of a lane the way MachineVariable does
+ *
+ * @param variable Column of the variable
+ * @param lane The lane
+ * @param buffer Storage for the text
+ * @return The text, valid while buffer is
+ */
+std::string_view VectorSimulator::variableText(int variable, uint32_t lane, char (&buffer)[32]) const {
+    if (variables[variable].type == VariableType::FLOAT) {
+        return floatText(floats[variable * laneCount + lane], buffer);
+    }
+    int length = std::snprintf(buffer, sizeof(buffer), "%d", ints[variable * laneCount + lane]);
+    return std::string_view(buffer, length);
+}
+
+/**
+ * @brief Evaluates an expression in a lane
+ *
+ * @param program The compiled expression
+ * @param lane The lane
+ * @return The result
+ * @throw std::runtime_error On division by zero or a FAIL instruction
+ */
+VectorSimulator::Value VectorSimulator::evaluate(const std::vector<Operation>& program, uint32_t lane) const {
+    Value accumulator{ValueKind::NONE, 0, 0.0f};
+    for (const Operation& operation : program) {
+        if (operation.op == OpCode::FAIL) {
+            throw std::runtime_error(operation.error);
+        }
+
+        Value operand = operation.constant;
+        if (operation.variable >= 0) {
+            if (variables[operation.variable].type == VariableType::INT) {
+                operand = Value{ValueKind::INT, ints[operation.variable * laneCount + lane], 0.0f};
+            } else {
+                operand = Value{ValueKind::FLOAT, 0, floats[operation.variable * laneCount + lane]};
+            }
+        }
+        if (operation.op == OpCode::LOAD) {
+            accumulator = operand;
+            continue;
+        }
+
+        // Same promotions as MachineVariable::applyOperation()
+        if (accumulator.kind == ValueKind::INT && operand.kind == ValueKind::INT) {
+            int left = accumulator.intValue;
+            int right = operand.intValue;
+            switch (operation.operation) {
+                case '+': accumulator.intValue = left + right; break;
+                case '-': accumulator.intValue = left - right; break;
+                case '*': accumulator.intValue = left * right; break;
+                case '/':
+                    if (right == 0) throw std::runtime_error("Division by zero");
+                    accumulator.intValue = left / right;
+                    break;
+                default:
+                    throw std::runtime_error("Unsupported operation: " + std::string(1, operation.operation));
+            }
+            continue;
+        }
+        if (accumulator.kind == ValueKind::NONE || operand.kind == ValueKind::NONE) {
+            throw std::runtime_error("Incompatible types for operation " + std::string(1, operation.operation));
+        }
+
+        float left = accumulator.kind == ValueKind::FLOAT ? accumulator.floatValue
+                                                          : static_cast<float>(accumulator.intValue);
+        float right = operand.kind == ValueKind::FLOAT ? operand.floatValue : static_cast<float>(operand.intValue);
+        switch (operation.operation) {
+            case '+': accumulator.floatValue = left + right; break;
+            case '-': accumulator.floatValue = left - right; break;
+            case '*': accumulator.floatValue = left * right; break;
+            case '/':
+                if (right == 0) throw std::runtime_error("Division by zero");
+                accumulator.floatValue = left / right;
+                break;
+            default:
+                throw std::runtime_error("Unsupported operation: " + std::string(1, operation.operation));
+        }
+        accumulator.kind = ValueKind::FLOAT;
+    }
+    return accumulator;
+}
+
+/**
+ * @brief Assigns a value to a variable of a lane through its text, like the simulator does
+ *
+ * @param variable Column of the variable
+ * @param lane The lane
+ * @param value The assigned value
+ * @throw std::runtime_error If the text cannot be parsed as the variable's type
+ */
+void VectorSimulator::assign(int variable, uint32_t lane, const Value& value) {
+    VariableType type = variables[variable].type;
+
+    // An int survives the round trip through its text unchanged
+    if (value.kind == ValueKind::INT) {
+        if (type == VariableType::INT) {
+            ints[variable * laneCount + lane] = value.intValue;
+        } else {
+            floats[variable * laneCount + lane] = static_cast<float>(value.intValue);
+        }
+        return;
+    }
+
+    // A float is cut to the precision it prints with, an empty result does not parse at all
+    char buffer[32];
+    std::string text = value.kind == ValueKind::FLOAT ? std::string(floatText(value.floatValue, buffer)) : "";
+    MachineVariable parsed = parseAs(type, text);
+    if (type == VariableType::INT) {
+        ints[variable * laneCount + lane] = std::get<int>(parsed.getValue());
+    } else {
+        floats[variable * laneCount + lane] = std::get<float>(parsed.getValue());
+    }
+}
+
+/**
+ * @brief Makes one step of every listed lane
+ *
+ * @param lanes Lanes to step, in ascending order
+ */
+void VectorSimulator::stepLanes(const std::vector<uint32_t>& lanes) {
+    stepRanks.resize(lanes.size());
+#ifdef VECTOR_SIMULATOR_AVX2
+    if (avx2) {
+        findRanksAvx2(lanes.data(), lanes.size(), laneStates.data(), symbols.data(), laneCount, dispatchedPointers,
+                      symbolStride, ranks.data(), stepRanks.data());
+    } else
+#endif
+    {
+        findRanksScalar(lanes.data(), lanes.size(), laneStates.data(), symbols.data(), laneCount, dispatchedPointers,
+                        symbolStride, ranks.data(), stepRanks.data());
+    }
+
+    for (size_t i = 0; i < lanes.size(); i++) {
+        try {
+            stepLane(lanes[i], stepRanks[i]);
+            afterStep(lanes[i]);
+        } catch (const std::exception& e) {
+            failLane(lanes[i], e.what());
+        }
+    }
+}
+
+/**
+ * @brief Makes one step of a lane, like MachineSimulator::processInputs()
+ *
+ * @param lane The lane
+ * @param rank Rank of its first triggered immediate transition without boolean conditions
+ * @throw std::runtime_error If an output statement fails
+ */
+void VectorSimulator::stepLane(uint32_t lane, int32_t rank) {
+    // The outputs of a new state already ran, transitions wait for the next step
+    if (justEntered[lane]) {
+        justEntered[lane] = 0;
+        return;
+    }
+
+    const LaneState& state = states[laneStates[lane]];
+    long long now = laneNow[lane];
+
+    // The earliest expired timer goes first
+    if (nextDue[lane] <= now) {
+        int expired = -1;
+        for (uint32_t bits = armed[lane]; bits; bits &= bits - 1) {
+            int timer = lowestBit(bits);
+            if (expired < 0 || due[timer * laneCount + lane] < due[expired * laneCount + lane]) {
+                expired = timer;
+            }
+        }
+        const LaneTransition& transition = transitions[state.timers[expired]];
+        consume(lane, transition);
+        enterState(lane, transition.target);
+        return;
+    }
+
+    // Boolean conditions can only make an earlier transition win than the table found
+    if (state.guarded) {
+        for (int32_t i = 0; i < std::min(rank, state.count); i++) {
+            const LaneTransition& transition = transitions[state.first + i];
+            if (transition.kind != TransitionKind::IMMEDIATE || transition.guards.empty()) {
+                continue;
+            }
+            if (std::any_of(transition.guards.begin(), transition.guards.end(),
+                            [&](const Guard& guard) { return guardHolds(guard, lane); })) {
+                rank = i;
+                break;
+            }
+        }
+    }
+    if (rank < state.count) {
+        const LaneTransition& transition = transitions[state.first + rank];
+        consume(lane, transition);
+        enterState(lane, transition.target);
+        return;
+    }
+
+    // Timed transitions run while they stay triggered
+    if (state.timed) {
+        for (int i = 0; i < state.count; i++) {
+            const LaneTransition& transition = transitions[state.first + i];
+            if (transition.kind != TransitionKind::TIMED) {
+                continue;
+            }
+            uint32_t bit = 1u << transition.timer;
+            if (!isTriggered(transition, lane)) {
+                armed[lane] &= ~bit;
+            } else if (!(armed[lane] & bit)) {
+                armed[lane] |= bit;
+                due[transition.timer * laneCount + lane] = now + transition.timeout;
+            }
+        }
+        updateNextDue(lane);
+    }
+
+    settled[lane] = 1;
+}
+
+/**
+ * @brief Counts a step of a lane
+ *
+ * @param lane The lane
+ * @throw std::runtime_error If the lane keeps stepping without time advancing
+ */
+void VectorSimulator::afterStep(uint32_t lane) {
+    laneSteps[lane]++;
+    if (laneNow[lane] != instant[lane]) {
+        instant[lane] = laneNow[lane];
+        stepsAtInstant[lane] = 0;
+    }
+    if (++stepsAtInstant[lane] > maxStepsPerInstant) {
+        throw std::runtime_error("No progress after " + std::to_string(maxStepsPerInstant) + " steps at " +
+                                 std::to_string(instant[lane]) + " ms, the machine keeps changing state");
+    }
+}
+
+/**
+ * @brief Stops a lane
+ *
+ * @param lane The lane
+ * @param message What went wrong
+ */
+void VectorSimulator::failLane(uint32_t lane, const std::string& message) {
+    failed[lane] = 1;
+    if (lane < firstErrorLane) {
+        firstErrorLane = lane;
+        firstError = "instance " + std::to_string(lane) + ": " + message;
+    }
+}
+
+/**
+ * @brief Makes every step of the listed lanes that is due by their limit
+ *
+ * @param lanes Lanes to advance, replaced by scratch contents
+ * @param column Event whose time is the limit, or SIZE_MAX for the end of the trace plus the horizon
+ */
+void VectorSimulator::catchUp(std::vector<uint32_t>& lanes, size_t column) {
+    std::vector<uint32_t> stepping;
+    stepping.reserve(lanes.size());
+    while (!lanes.empty()) {
+        // Jump every lane to its next pending step, like MachineSimulator::advance() does
+        stepping.clear();
+        for (uint32_t lane : lanes) {
+            const std::vector<LaneEvent>& trace = laneTraces[lane % laneTraces.size()];
+            long long limit = column != SIZE_MAX ? trace[column].time
+                                                 : (trace.empty() ? 0 : trace.back().time) + horizon;
+            long long next = deadline(lane);
+            if (!failed[lane] && next <= limit) {
+                laneNow[lane] = std::max(laneNow[lane], next);
+                stepping.push_back(lane);
+            }
+        }
+        stepLanes(stepping);
+        lanes.swap(stepping);
+    }
+}
+
+/**
+ * @brief Runs the given number of instances
+ *
+ * @param traces Input traces to feed
+ * @param instances Number of instances to run
+ * @return Statistics of the run, with a single thread
+ * @throw std::runtime_error If no traces are given or there are too many instances
+ */
+BatchStats VectorSimulator::run(const std::vector<InputTrace>& traces, size_t instances) {
+    if (traces.empty()) {
+        throw std::runtime_error("No input traces given");
+    }
+    if (instances > static_cast<size_t>(INT32_MAX)) {
+        throw std::runtime_error("Too many instances for one run: " + std::to_string(instances));
+    }
+    auto start = steady_clock::now();
+
+    // Lanes only ever hold interned values, the empty one is index 0
+    values.clear();
+    valueIds.clear();
+    internValue("");
+    laneTraces.assign(traces.size(), {});
+    size_t columns = 0;
+    for (size_t i = 0; i < traces.size(); i++) {
+        for (const TraceEvent& event : traces[i].events) {
+            auto pointer = pointerIndices.find(event.inputPtr);
+            laneTraces[i].push_back(LaneEvent{event.time, pointer != pointerIndices.end() ? pointer->second : -1,
+                                              internValue(event.value)});
+        }
+        columns = std::max(columns, laneTraces[i].size());
+    }
+
+    resetLanes(instances);
+
+    std::vector<uint32_t> active(instances);
+    for (uint32_t lane = 0; lane < instances; lane++) {
+        active[lane] = lane;
+    }
+
+    // Column k holds the k-th event of every trace that has one
+    std::vector<uint32_t> lanes;
+    for (size_t column = 0; column < columns; column++) {
+        active.erase(std::remove_if(active.begin(), active.end(),
+                                    [&](uint32_t lane) {
+                                        return failed[lane] || laneTraces[lane % laneTraces.size()].size() <= column;
+                                    }),
+                     active.end());
+        lanes = active;
+        catchUp(lanes, column);
+
+        lanes.clear();
+        for (uint32_t lane : active) {
+            if (failed[lane]) {
+                continue;
+            }
+            const LaneEvent& event = laneTraces[lane % laneTraces.size()][column];
+            laneNow[lane] = std::max(laneNow[lane], event.time);
+            if (event.pointer >= 0) {
+                inputs[event.pointer * laneCount + lane] = event.value;
+                if (event.pointer < dispatchedPointers) {
+                    symbols[event.pointer * laneCount + lane] = values[event.value].symbol;
+                }
+            }
+            justEntered[lane] = 0;
+            settled[lane] = 0;
+            lanes.push_back(lane);
+        }
+        stepLanes(lanes);
+    }
+
+    lanes.clear();
+    for (uint32_t lane = 0; lane < instances; lane++) {
+        if (!failed[lane]) {
+            lanes.push_back(lane);
+        }
+    }
+    catchUp(lanes, SIZE_MAX);
+
+    BatchStats stats{};
+    stats.instances = instances;
+    for (size_t lane = 0; lane < instances; lane++) {
+        if (failed[lane]) {
+            stats.failed++;
+        } else {
+            stats.steps += laneSteps[lane];
+        }
+    }
+    stats.seconds = duration<double>(steady_clock::now() - start).count();
+    stats.threadSteps.assign(1, stats.steps);
+    stats.threadSeconds.assign(1, stats.seconds);
+    stats.firstError = firstError;
+    return stats;
+}
+
+/**
+ * @brief Gets the current state of a lane
+ *
+ * @param lane Index of the lane
+ * @return ID of the state
+ */
+const std::string& VectorSimulator::getState(size_t lane) const {
+    return states[laneStates[lane]].id;
+}
+
+/**
+ * @brief Gets an output value of a lane
+ *
+ * @param lane Index of the lane
+ * @param outputPtr The output pointer name
+ * @return Current value, or empty string if not set
+ */
+std::string VectorSimulator::getOutput(size_t lane, const std::string& outputPtr) const {
+    auto it = outputIndices.find(outputPtr);
+    if (it == outputIndices.end()) {
+        return "";
+    }
+
+    const Value& value = outputs[it->second * laneCount + lane];
+    char buffer[32];
+    switch (value.kind) {
+        case ValueKind::INT:
+            return std::to_string(value.intValue);
+        case ValueKind::FLOAT:
+            return std::string(floatText(value.floatValue, buffer));
+        case ValueKind::LITERAL:
+            return literals[value.intValue];
+        case ValueKind::NONE:
+            break;
+    }
+    return "";
+}
+
+/**
+ * @brief Gets a variable of a lane as text
+ *
+ * @param lane Index of the lane
+ * @param name Name of the variable
+ * @return The value as MachineVariable::getValueString() prints it, or empty string if not found
+ */
+std::string VectorSimulator::getVariable(size_t lane, const std::string& name) const {
+    auto it = variableIndices.find(name);
+    if (it == variableIndices.end()) {
+        return "";
+    }
+    char buffer[32];
+    return std::string(variableText(it->second, static_cast<uint32_t>(lane), buffer));
+}
+
+/**
+ * @brief Gets the number of steps a lane made
+ *
+ * @param lane Index of the lane
+ * @return Number of steps
+ */
+unsigned long long VectorSimulator::getSteps(size_t lane) const {
+    return laneSteps[lane];
+}
+
+/**
+ * @brief Checks whether a lane was stopped by an error
+ *
+ * @param lane Index of the lane
+ * @return True if it failed
+ */
+bool VectorSimulator::hasFailed(size_t lane) const {
+    return failed[lane];
+}
@@ -0,0 +1,228 @@
+/**
+ * @file wire_protocol.cpp
+ * @brief Implementation of the WireWriter and WireReader classes
+ * @author Hugo Bohácsek (xbohach00)
+ */
+
+#include "../headers/wire_protocol.h"
+#include <stdexcept>
+
+/**
+ * @brief Constructor, writes the datagram header
+ *
+ * @param instance ID of the automaton instance
+ * @param sequence Sequence number of the datagram
+ */
+WireWriter::WireWriter(uint32_t instance, uint32_t sequence) : recordStart(std::string::npos) {
+    data.reserve(WireProtocol::MAX_DATAGRAM);
+    data += WireProtocol::MAGIC;
+    data += static_cast<char>(WireProtocol::VERSION);
+    writeU32(instance);
+    writeU32(sequence);
+}
+
+/**
+ * @brief Starts a record, its payload follows
+ *
+ * @param type Type of the record
+ */
+void WireWriter::beginRecord(WireProtocol::RecordType type) {
+    recordStart = data.size();
+    data += static_cast<char>(type);
+    writeU16(0);
+}
+
+/**
+ * @brief Ends the open record and fills in its length
+ *
+ * @throw std::runtime_error If the payload does not fit a record
+ */
+void WireWriter::endRecord() {
+    size_t length = data.size() - recordStart - WireProtocol::RECORD_HEADER_SIZE;
+    if (length > 0xFFFF) {
+        throw std::runtime_error("Record too long: " + std::to_string(length) + " bytes");
+    }
+    data[recordStart + 1] = static_cast<char>(length >> 8);
+    data[recordStart + 2] = static_cast<char>(length & 0xFF);
+    recordStart = std::string::npos;
+}
+
+/**
+ * @brief Drops the open record
+ */
+void WireWriter::cancelRecord() {
+    if (recordStart != std::string::npos) {
+        data.resize(recordStart);
+        recordStart = std::string::npos;
+    }
+}
+
+/**
+ * @brief Appends a 16-bit integer
+ *
+ * @param value The integer
+ */
+void WireWriter::writeU16(uint16_t value) {
+    data += static_cast<char>(value >> 8);
+    data += static_cast<char>(value & 0xFF);
+}
+
+/**
+ * @brief Appends a 32-bit integer
+ *
+ * @param value The integer
+ */
+void WireWriter::writeU32(uint32_t value) {
+    writeU16(static_cast<uint16_t>(value >> 16));
+    writeU16(static_cast<uint16_t>(value & 0xFFFF));
+}
+
+/**
+ * @brief Appends a string with its length
+ *
+ * @param value The string, at most 65535 bytes
+ * @throw std::runtime_error If the string is too long
+ */
+void WireWriter::writeString(const std::string& value) {
+    if (value.size() > 0xFFFF) {
+        throw std::runtime_error("String too long: " + std::to_string(value.size()) + " bytes");
+    }
+    writeU16(static_cast<uint16_t>(value.size()));
+    data += value;
+}
+
+/**
+ * @brief Gets the size of the datagram
+ *
+ * @return Number of bytes written
+ */
+size_t WireWriter::size() const {
+    return data.size();
+}
+
+/**
+ * @brief Checks whether any record was written
+ *
+ * @return True if the datagram holds only the header
+ */
+bool WireWriter::empty() const {
+    return data.size() == WireProtocol::HEADER_SIZE;
+}
+
+/**
+ * @brief Gets the datagram
+ *
+ * @return Bytes to send
+ */
+const std::string& WireWriter::getData() const {
+    return data;
+}
+
+/**
+ * @brief Constructor, reads the datagram header
+ *
+ * @param data The datagram, must outlive the reader
+ * @throw std::runtime_error If the header is missing or of another version
+ */
+WireReader::WireReader(const std::string& data) : data(data), position(0), recordEnd(0), instance(0), sequence(0) {
+    if (data.size() < WireProtocol::HEADER_SIZE || data[0] != WireProtocol::MAGIC) {
+        throw std::runtime_error("Not a datagram of the automaton protocol");
+    }
+    if (static_cast<uint8_t>(data[1]) != WireProtocol::VERSION) {
+        throw std::runtime_error("Unsupported protocol version " + std::to_string(static_cast<uint8_t>(data[1])));
+    }
+    position = 2;
+    recordEnd = WireProtocol::HEADER_SIZE;
+    instance = readU32();
+    sequence = readU32();
+}
+
+/**
+ * @brief Checks that the current record has enough bytes left
+ *
+ * @param count Number of bytes about to be read
+ * @throw std::runtime_error If the record is shorter
+ */
+void WireReader::require(size_t count) const {
+    if (position + count > recordEnd) {
+        throw std::runtime_error("Truncated record");
+    }
+}
+
+/**
+ * @brief Gets the ID of the automaton instance of the datagram
+ *
+ * @return Instance ID from the header
+ */
+uint32_t WireReader::getInstance() const {
+    return instance;
+}
+
+/**
+ * @brief Gets the sequence number of the datagram
+ *
+ * @return Sequence number from the header
+ */
+uint32_t WireReader::getSequence() const {
+    return sequence;
+}
+
+/**
+ * @brief Moves to the next record, skipping what is left of the current one
+ *
+ * @param type Type of the record
+ * @return False when there are no more records
+ * @throw std::runtime_error If the record is truncated
+ */
+bool WireReader::nextRecord(WireProtocol::RecordType& type) {
+    position = recordEnd;
+    if (position == data.size()) {
+        return false;
+    }
+
+    recordEnd = data.size();
+    require(WireProtocol::RECORD_HEADER_SIZE);
+    type = static_cast<WireProtocol::RecordType>(static_cast<uint8_t>(data[position++]));
+    size_t length = readU16();
+    recordEnd = position + length;
+    if (recordEnd > data.size()) {
+        throw std::runtime_error("Truncated record");
+    }
+    return true;
+}
+
+/**
+ * @brief Reads a 16-bit integer
+ *
+ * @return The integer
+ */
+uint16_t WireReader::readU16() {
+    require(2);
+    uint16_t value = static_cast<uint16_t>((static_cast<uint8_t>(data[position]) << 8) |
+                                           static_cast<uint8_t>(data[position + 1]));
+    position += 2;
+    return value;
+}
+
+/**
+ * @brief Reads a 32-bit integer
+ *
+ * @return The integer
+ */
+uint32_t WireReader::readU32() {
+    uint32_t high = readU16();
+    return (high << 16) | readU16();
+}
+
+/**
+ * @brief Reads a string with its length
+ *
+ * @return The string
+ */
+std::string WireReader::readString() {
+    size_t length = readU16();
+    require(length);
+    std::string value = data.substr(position, length);
+    position += length;
+    return value;
+}